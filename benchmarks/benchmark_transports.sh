@@ -0,0 +1,101 @@
+#!/bin/bash
+# Feed Transport Benchmark Script
+#
+# Streams binary_mock_server ticks over each transport (tcp, unix, unixgram,
+# shm) to transport_benchmark, once paced (the mock server's default 10
+# msgs/ms, latency dominated by the transport) and once flat out (throughput,
+# latency dominated by queueing).
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_ROOT/build"
+
+echo "==================================================================="
+echo "Feed Transport Comparison"
+echo "==================================================================="
+echo ""
+
+for binary in transport_benchmark binary_mock_server; do
+    if [ ! -f "$BUILD_DIR/$binary" ]; then
+        echo "Error: $binary not found. Build first with:"
+        echo "  cd $PROJECT_ROOT"
+        echo "  make transport-benchmark"
+        exit 1
+    fi
+done
+
+# Test configurations
+PORT=9999
+SOCKET_PATH=/tmp/feed_bench.sock
+SHM_NAME=/feed_bench
+PACED_MESSAGES=${PACED_MESSAGES:-20000}
+FLAT_MESSAGES=${FLAT_MESSAGES:-1000000}
+RESULTS=/tmp/transport_results.csv
+
+echo "Configuration:"
+echo "  Paced:    $PACED_MESSAGES messages (10 msgs/ms)"
+echo "  Flat out: $FLAT_MESSAGES messages"
+echo ""
+
+echo "transport,mean_us,p50_us,p95_us,p99_us,messages,gaps,msgs_per_sec" > $RESULTS
+
+run_test() {
+    local transport=$1 mode=$2 messages=$3
+    local server_args=(--transport "$transport" --messages "$messages")
+    local client_args=(--transport "$transport" --messages "$messages")
+    case $transport in
+        tcp) client_args+=(--port $PORT) ;;
+        shm) server_args+=(--path $SHM_NAME); client_args+=(--path $SHM_NAME) ;;
+        *) server_args+=(--path $SOCKET_PATH); client_args+=(--path $SOCKET_PATH) ;;
+    esac
+    [ "$mode" = "flat" ] && server_args+=(--flat-out)
+
+    echo "==================================================================="
+    echo "$transport ($mode, $messages messages)"
+    echo "==================================================================="
+
+    "$BUILD_DIR/binary_mock_server" $PORT "${server_args[@]}" > /tmp/transport_server.log 2>&1 &
+    local server_pid=$!
+    sleep 1
+
+    "$BUILD_DIR/transport_benchmark" "${client_args[@]}" --label "$transport-$mode" --csv \
+        > /tmp/transport_${transport}_${mode}.log 2>&1
+    tail -n 1 /tmp/transport_${transport}_${mode}.log | tee -a $RESULTS
+
+    kill $server_pid 2>/dev/null
+    wait $server_pid 2>/dev/null
+    echo ""
+}
+
+for mode in paced flat; do
+    messages=$PACED_MESSAGES
+    [ "$mode" = "flat" ] && messages=$FLAT_MESSAGES
+    for transport in tcp unix unixgram shm; do
+        run_test $transport $mode $messages
+    done
+done
+
+echo "==================================================================="
+echo "Results"
+echo "==================================================================="
+column -t -s, $RESULTS 2>/dev/null || cat $RESULTS
+echo ""
+
+cat << 'NOTES'
+Reading the results:
+
+- Paced latency is mostly wake-up cost. The socket transports wake the
+  reader through the scheduler; the shm reader spins, so it is the lowest
+  and the steadiest, at the price of a busy core.
+- unix skips the TCP/IP stack (no checksums, no ACKs, no loopback device)
+  and is usually the cheapest socket option with no code change beyond
+  the address.
+- unixgram keeps message boundaries; on Linux local datagrams are
+  flow-controlled, so nothing is dropped, but each send is one frame batch
+  and a datagram larger than the reader's buffer would be truncated.
+- Flat-out latency is queueing in whichever buffer is slowest to drain;
+  compare msgs_per_sec there instead.
+
+NOTES
+
+echo "Results saved to $RESULTS"
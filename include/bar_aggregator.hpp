@@ -0,0 +1,710 @@
+#ifndef BAR_AGGREGATOR_HPP
+#define BAR_AGGREGATOR_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "net/feed.hpp"
+#include "transport.hpp"
+
+/**
+ * OHLCV Bar Aggregation
+ *
+ * Rolling open/high/low/close, volume, VWAP and trade count per symbol for
+ * several intervals at once (say 1 s and 1 min), built incrementally from
+ * the processor's tick batches so consumers stop rebuilding bars from raw
+ * ticks. Bars are aligned to multiples of their interval in tick
+ * (exchange) time.
+ *
+ * State is flat: symbols get dense slots on first sight (up to
+ * max_symbols) and each interval keeps an array of cache-line cells
+ * indexed by slot. A batch is handled a block at a time: the ticks are gathered into
+ * columns, a few branch-free kernels the compiler vectorizes compute
+ * notionals and check the block against the open windows, the block is
+ * reduced to one partial bar per symbol it touches, and the partials are
+ * folded into every interval. Per tick that is one scattered update
+ * however many intervals are kept.
+ *
+ * Bars close on a timer: advance(now) closes each interval whose window
+ * ended more than close_delay_ns ago, so a quiet symbol's bar still goes
+ * out on time. A tick past the end of a window that the timer has not
+ * closed yet closes it on the spot; a tick for a window already closed is
+ * late and only counted.
+ *
+ * BarAggregator is single-threaded. BarStage runs one behind a feed
+ * handler's batch callback with its own timer thread, and hands closed
+ * bars to sinks: BarJournal (BAR frames appended to a file, the capture
+ * format FeedReplay reads) and ShmBarPublisher (BAR frames into a ShmRing
+ * for a co-located reader, dropped rather than waited on when it lags).
+ *
+ * Usage:
+ *   BarStage bars(config);
+ *   auto journal = BarJournal::open("bars.bin");
+ *   bars.add_sink([&](const Bar* b, size_t n) { journal.value()->write(b, n); });
+ *   handler.set_batch_callback(bars.batch_callback());
+ *   bars.start();
+ *   handler.start();
+ *   ...
+ *   bars.stop();  // Closes the bars in progress
+ */
+
+struct Bar {
+  char symbol[8];
+  uint64_t interval_ns;
+  uint64_t start_ns;  // Covers [start_ns, start_ns + interval_ns)
+  double open;
+  double high;
+  double low;
+  double close;
+  int64_t volume;
+  double vwap;        // close if no volume traded
+  uint64_t trades;
+
+  BarPayload to_payload() const {
+    BarPayload payload;
+    memcpy(payload.symbol, symbol, 4);
+    payload.interval_ms = static_cast<uint32_t>(interval_ns / 1'000'000);
+    payload.start_ns = start_ns;
+    payload.open = static_cast<float>(open);
+    payload.high = static_cast<float>(high);
+    payload.low = static_cast<float>(low);
+    payload.close = static_cast<float>(close);
+    payload.volume = static_cast<uint64_t>(volume);
+    payload.vwap = static_cast<float>(vwap);
+    payload.trades = static_cast<uint32_t>(trades);
+    return payload;
+  }
+};
+
+using BarCallback = std::function<void(const Bar* bars, size_t count)>;
+
+struct BarAggregatorConfig {
+  std::vector<uint64_t> intervals_ns = {1'000'000'000ULL, 60'000'000'000ULL};
+  size_t max_symbols = 4096;
+  uint64_t close_delay_ns = 0;  // How long after its end the timer closes a window
+
+  bool is_valid() const {
+    return !intervals_ns.empty() && max_symbols > 0 &&
+           std::all_of(intervals_ns.begin(), intervals_ns.end(),
+                       [](uint64_t ns) { return ns >= 1'000'000 && ns % 1'000'000 == 0; });
+  }
+};
+
+struct BarAggregatorStats {
+  uint64_t ticks = 0;
+  uint64_t blocks = 0;           // Runs of ticks all inside the open windows
+  uint64_t late = 0;             // (tick, interval) pairs for a closed window
+  uint64_t unknown_symbols = 0;  // Ticks dropped: max_symbols already in use
+  uint64_t bars = 0;
+  uint64_t closed_by_timer = 0;  // Windows closed by advance()
+  uint64_t closed_by_tick = 0;   // Windows closed by a tick past their end
+};
+
+namespace bar_kernels {
+
+// Columns are __restrict and the loops branch-free so that -O2/-O3
+// vectorizes them
+
+inline void notional(const double* __restrict price, const double* __restrict volume,
+                     double* __restrict out, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = price[i] * volume[i];
+  }
+}
+
+// Timestamps outside [lo, hi): one unsigned compare each
+inline size_t count_outside(const uint64_t* __restrict ts, size_t n, uint64_t lo, uint64_t hi) {
+  const uint64_t span = hi - lo;
+  size_t outside = 0;
+  for (size_t i = 0; i < n; ++i) {
+    outside += (ts[i] - lo) >= span;
+  }
+  return outside;
+}
+
+inline size_t first_outside(const uint64_t* ts, size_t n, uint64_t lo, uint64_t hi) {
+  const uint64_t span = hi - lo;
+  for (size_t i = 0; i < n; ++i) {
+    if (ts[i] - lo >= span) {
+      return i;
+    }
+  }
+  return n;
+}
+
+} // namespace bar_kernels
+
+class BarAggregator {
+public:
+  static constexpr size_t BLOCK = 256;
+  static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+  explicit BarAggregator(const BarAggregatorConfig& config = {})
+      : config_(config), table_mask_(table_size(config.max_symbols) - 1),
+        table_keys_(table_mask_ + 1, 0), table_slots_(table_mask_ + 1, NO_SLOT),
+        partial_of_(config.max_symbols, NO_SLOT) {
+    symbols_.reserve(config.max_symbols);
+    for (uint64_t length : config.intervals_ns) {
+      Series series;
+      series.length = length;
+      series.cells.resize(config.max_symbols);
+      series.touched.reserve(config.max_symbols);
+      series_.push_back(std::move(series));
+    }
+    partials_.reserve(BLOCK);
+  }
+
+  void set_bar_callback(BarCallback callback) { callback_ = std::move(callback); }
+
+  // A run of ticks in arrival order
+  void add(const net::Tick* ticks, size_t count) {
+    if (count == 0) {
+      return;
+    }
+    if (!started_) {
+      start_windows(ticks[0].timestamp);
+    }
+    for (size_t offset = 0; offset < count; offset += BLOCK) {
+      add_block(ticks + offset, std::min(BLOCK, count - offset));
+    }
+    stats_.ticks += count;
+    emit();
+  }
+
+  // Close every window that ended at least close_delay_ns before now_ns.
+  // Returns the number of bars emitted.
+  size_t advance(uint64_t now_ns) {
+    if (!started_ || now_ns < config_.close_delay_ns) {
+      return 0;
+    }
+    uint64_t cutoff = now_ns - config_.close_delay_ns;
+    for (Series& series : series_) {
+      if (cutoff >= series.start + series.length) {
+        close_window(series);
+        series.start = cutoff - cutoff % series.length;
+        stats_.closed_by_timer++;
+      }
+    }
+    return emit();
+  }
+
+  // When advance() next has work; max() before the first tick
+  uint64_t next_close_ns() const {
+    if (!started_) {
+      return std::numeric_limits<uint64_t>::max();
+    }
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+    for (const Series& series : series_) {
+      next = std::min(next, series.start + series.length + config_.close_delay_ns);
+    }
+    return next;
+  }
+
+  // Close the bars in progress now (shutdown); returns bars emitted
+  size_t flush() {
+    for (Series& series : series_) {
+      close_window(series);
+    }
+    return emit();
+  }
+
+  // The bar in progress for symbol on interval i; false if it has no trades
+  bool current(const std::string& symbol, size_t interval, Bar& bar) const {
+    uint32_t slot = find_slot(name_key(symbol.c_str()));
+    if (slot == NO_SLOT || series_[interval].cells[slot].trades == 0) {
+      return false;
+    }
+    bar = make_bar(series_[interval], slot);
+    return true;
+  }
+
+  size_t symbols() const { return symbols_.size(); }
+  size_t intervals() const { return series_.size(); }
+  uint64_t window_start(size_t interval) const { return series_[interval].start; }
+  const BarAggregatorStats& stats() const { return stats_; }
+
+  // Bytes held by the flat arrays and the symbol table
+  size_t footprint_bytes() const {
+    size_t per_slot = sizeof(Cell) + sizeof(uint32_t);
+    return series_.size() * config_.max_symbols * per_slot +
+           table_keys_.size() * (sizeof(uint64_t) + sizeof(uint32_t)) +
+           config_.max_symbols * (sizeof(uint32_t) + sizeof(SymbolName));
+  }
+
+private:
+  // One symbol's bar in progress: a fold touches one cache line
+  struct alignas(64) Cell {
+    double open = 0, high = 0, low = 0, close = 0, notional = 0;
+    int64_t volume = 0;
+    uint32_t trades = 0;
+  };
+
+  struct Series {
+    uint64_t length = 0;
+    uint64_t start = 0;  // Open window: [start, start + length)
+    std::vector<Cell> cells;        // Indexed by symbol slot
+    std::vector<uint32_t> touched;  // Slots with trades in the window
+  };
+
+  // One block's reduction for one symbol
+  struct Partial {
+    uint32_t slot;
+    uint32_t trades;
+    double open, high, low, close, notional;
+    int64_t volume;
+  };
+
+  struct SymbolName {
+    char bytes[8];
+  };
+
+  static size_t table_size(size_t symbols) {
+    size_t size = 16;
+    while (size < symbols * 2) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  // Symbol bytes up to the first NUL as an integer (bytes past it are not
+  // always cleared in a Tick)
+  static uint64_t name_key(const char* symbol) {
+    uint64_t key = 0;
+    memcpy(&key, symbol, strnlen(symbol, 8));
+    return key;
+  }
+
+  // Same key from a full 8-byte Tick::symbol without a byte loop: the
+  // lowest flagged byte of the zero-byte test is the first NUL
+  static uint64_t tick_key(const char (&symbol)[8]) {
+    uint64_t word;
+    memcpy(&word, symbol, 8);
+    uint64_t zero = (word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL;
+    if (zero == 0) {
+      return word;
+    }
+    return word & ((1ULL << (__builtin_ctzll(zero) & ~7)) - 1);
+  }
+
+  static size_t hash(uint64_t key) { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32); }
+
+  uint32_t find_slot(uint64_t key) const {
+    for (size_t i = hash(key) & table_mask_;; i = (i + 1) & table_mask_) {
+      if (table_slots_[i] == NO_SLOT) return NO_SLOT;
+      if (table_keys_[i] == key) return table_slots_[i];
+    }
+  }
+
+  uint32_t slot_for(const char (&symbol)[8]) {
+    uint64_t key = tick_key(symbol);
+    if (key == last_key_ && last_slot_ != NO_SLOT) {
+      return last_slot_;
+    }
+    size_t i = hash(key) & table_mask_;
+    while (table_slots_[i] != NO_SLOT && table_keys_[i] != key) {
+      i = (i + 1) & table_mask_;
+    }
+    if (table_slots_[i] == NO_SLOT) {
+      if (symbols_.size() == config_.max_symbols) {
+        return NO_SLOT;
+      }
+      table_keys_[i] = key;
+      table_slots_[i] = static_cast<uint32_t>(symbols_.size());
+      SymbolName name{};
+      memcpy(name.bytes, &key, 8);
+      symbols_.push_back(name);
+    }
+    last_key_ = key;
+    last_slot_ = table_slots_[i];
+    return last_slot_;
+  }
+
+  void start_windows(uint64_t timestamp) {
+    for (Series& series : series_) {
+      series.start = timestamp - timestamp % series.length;
+    }
+    started_ = true;
+  }
+
+  // Intersection of the open windows
+  void open_range(uint64_t& lo, uint64_t& hi) const {
+    lo = 0;
+    hi = std::numeric_limits<uint64_t>::max();
+    for (const Series& series : series_) {
+      lo = std::max(lo, series.start);
+      hi = std::min(hi, series.start + series.length);
+    }
+  }
+
+  void add_block(const net::Tick* ticks, size_t n) {
+    // Gather into columns
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint32_t slot = slot_for(ticks[i].symbol);
+      slot_col_[kept] = slot;
+      ts_col_[kept] = ticks[i].timestamp;
+      price_col_[kept] = ticks[i].price;
+      volume_col_[kept] = static_cast<double>(ticks[i].volume);
+      kept += slot != NO_SLOT;
+    }
+    stats_.unknown_symbols += n - kept;
+    bar_kernels::notional(price_col_, volume_col_, notional_col_, kept);
+
+    uint64_t lo, hi;
+    open_range(lo, hi);
+    if (bar_kernels::count_outside(ts_col_, kept, lo, hi) == 0) {
+      fold_run(0, kept);  // The usual case: the whole block is in every window
+      return;
+    }
+    size_t i = 0;
+    while (i < kept) {
+      size_t end = i + bar_kernels::first_outside(ts_col_ + i, kept - i, lo, hi);
+      fold_run(i, end);
+      if (end < kept) {
+        add_outside(end);
+        open_range(lo, hi);
+        ++end;
+      }
+      i = end;
+    }
+  }
+
+  // Reduce columns [begin, end) to one partial per symbol, then fold the
+  // partials into every interval
+  void fold_run(size_t begin, size_t end) {
+    if (begin == end) {
+      return;
+    }
+    stats_.blocks++;
+    partials_.clear();
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t slot = slot_col_[i];
+      double price = price_col_[i];
+      uint32_t& index = partial_of_[slot];
+      if (index == NO_SLOT) {
+        index = static_cast<uint32_t>(partials_.size());
+        partials_.push_back({slot, 0, price, price, price, price, 0.0, 0});
+      }
+      Partial& p = partials_[index];
+      p.high = std::max(p.high, price);
+      p.low = std::min(p.low, price);
+      p.close = price;
+      p.notional += notional_col_[i];
+      p.volume += static_cast<int64_t>(volume_col_[i]);
+      p.trades++;
+    }
+    for (Series& series : series_) {
+      for (const Partial& p : partials_) {
+        fold(series, p);
+      }
+    }
+    for (const Partial& p : partials_) {
+      partial_of_[p.slot] = NO_SLOT;
+    }
+  }
+
+  static void fold(Series& series, const Partial& p) {
+    Cell& cell = series.cells[p.slot];
+    if (cell.trades == 0) {
+      series.touched.push_back(p.slot);
+      cell.open = p.open;
+      cell.high = p.high;
+      cell.low = p.low;
+    } else {
+      cell.high = std::max(cell.high, p.high);
+      cell.low = std::min(cell.low, p.low);
+    }
+    cell.close = p.close;
+    cell.notional += p.notional;
+    cell.volume += p.volume;
+    cell.trades += p.trades;
+  }
+
+  // A tick outside some open window: late for windows already past it,
+  // closes windows it is beyond
+  void add_outside(size_t i) {
+    uint64_t ts = ts_col_[i];
+    double price = price_col_[i];
+    Partial p{slot_col_[i], 1, price, price, price, price, notional_col_[i],
+              static_cast<int64_t>(volume_col_[i])};
+    for (Series& series : series_) {
+      if (ts < series.start) {
+        stats_.late++;
+        continue;
+      }
+      if (ts >= series.start + series.length) {
+        close_window(series);
+        series.start = ts - ts % series.length;
+        stats_.closed_by_tick++;
+      }
+      fold(series, p);
+    }
+  }
+
+  Bar make_bar(const Series& series, uint32_t slot) const {
+    Bar bar;
+    memcpy(bar.symbol, symbols_[slot].bytes, 8);
+    bar.interval_ns = series.length;
+    bar.start_ns = series.start;
+    const Cell& cell = series.cells[slot];
+    bar.open = cell.open;
+    bar.high = cell.high;
+    bar.low = cell.low;
+    bar.close = cell.close;
+    bar.volume = cell.volume;
+    bar.vwap = cell.volume != 0 ? cell.notional / cell.volume : cell.close;
+    bar.trades = cell.trades;
+    return bar;
+  }
+
+  void close_window(Series& series) {
+    for (uint32_t slot : series.touched) {
+      out_.push_back(make_bar(series, slot));
+      series.cells[slot] = Cell();
+    }
+    series.touched.clear();
+  }
+
+  size_t emit() {
+    size_t count = out_.size();
+    if (count > 0) {
+      if (callback_) {
+        callback_(out_.data(), count);
+      }
+      stats_.bars += count;
+      out_.clear();
+    }
+    return count;
+  }
+
+  BarAggregatorConfig config_;
+  std::vector<Series> series_;
+  bool started_ = false;
+
+  size_t table_mask_;
+  std::vector<uint64_t> table_keys_;
+  std::vector<uint32_t> table_slots_;
+  std::vector<SymbolName> symbols_;
+  uint64_t last_key_ = 0;
+  uint32_t last_slot_ = NO_SLOT;
+
+  // Block scratch
+  alignas(64) uint64_t ts_col_[BLOCK];
+  alignas(64) double price_col_[BLOCK];
+  alignas(64) double volume_col_[BLOCK];
+  alignas(64) double notional_col_[BLOCK];
+  uint32_t slot_col_[BLOCK];
+  std::vector<uint32_t> partial_of_;
+  std::vector<Partial> partials_;
+
+  std::vector<Bar> out_;
+  BarCallback callback_;
+  BarAggregatorStats stats_;
+};
+
+/**
+ * Closed bars appended to a file as BAR frames (sequence from 1 per open),
+ * one write() per batch of bars.
+ */
+class BarJournal {
+public:
+  ~BarJournal() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  BarJournal(const BarJournal&) = delete;
+  BarJournal& operator=(const BarJournal&) = delete;
+
+  static Result<std::unique_ptr<BarJournal>> open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+      return Result<std::unique_ptr<BarJournal>>::error("cannot open " + path + ": " +
+                                                        strerror(errno));
+    }
+    return Result<std::unique_ptr<BarJournal>>(std::unique_ptr<BarJournal>(new BarJournal(fd)));
+  }
+
+  bool write(const Bar* bars, size_t count) {
+    buffer_.clear();
+    for (size_t i = 0; i < count; ++i) {
+      append_bar(buffer_, ++sequence_, bars[i].to_payload());
+    }
+    size_t written = 0;
+    while (written < buffer_.size()) {
+      ssize_t n = ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        errors_++;
+        return false;
+      }
+      written += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  uint64_t bars_written() const { return sequence_; }
+  uint64_t errors() const { return errors_; }
+
+private:
+  explicit BarJournal(int fd) : fd_(fd) {}
+
+  int fd_;
+  std::string buffer_;
+  uint64_t sequence_ = 0;
+  uint64_t errors_ = 0;
+};
+
+/**
+ * Closed bars as BAR frames into a ShmRing. The aggregator never waits:
+ * a batch that does not fit, or arrives with no reader attached, is
+ * dropped and counted.
+ */
+class ShmBarPublisher {
+public:
+  static Result<std::unique_ptr<ShmBarPublisher>> create(const std::string& name,
+                                                         size_t capacity = 1 << 20) {
+    auto ring = ShmRing::create(name, capacity);
+    if (!ring) {
+      return Result<std::unique_ptr<ShmBarPublisher>>::error(ring.error());
+    }
+    return Result<std::unique_ptr<ShmBarPublisher>>(
+        std::unique_ptr<ShmBarPublisher>(new ShmBarPublisher(std::move(ring.value()))));
+  }
+
+  bool write(const Bar* bars, size_t count) {
+    buffer_.clear();
+    for (size_t i = 0; i < count; ++i) {
+      append_bar(buffer_, sequence_ + i + 1, bars[i].to_payload());
+    }
+    if (!ring_->try_write(buffer_.data(), buffer_.size())) {
+      dropped_ += count;
+      return false;
+    }
+    sequence_ += count;
+    return true;
+  }
+
+  uint64_t bars_published() const { return sequence_; }
+  uint64_t bars_dropped() const { return dropped_; }
+  const std::string& name() const { return ring_->name(); }
+
+private:
+  explicit ShmBarPublisher(std::unique_ptr<ShmRing> ring) : ring_(std::move(ring)) {}
+
+  std::unique_ptr<ShmRing> ring_;
+  std::string buffer_;
+  uint64_t sequence_ = 0;
+  uint64_t dropped_ = 0;
+};
+
+/**
+ * A BarAggregator fed from a feed handler's batch callback (the processor
+ * thread) and closed by its own timer thread, which sleeps until the next
+ * window is due. Sinks run under the stage's lock on whichever of the two
+ * threads closed the bars.
+ */
+class BarStage {
+public:
+  explicit BarStage(const BarAggregatorConfig& config = {}) : aggregator_(config) {
+    aggregator_.set_bar_callback([this](const Bar* bars, size_t count) {
+      for (auto& sink : sinks_) {
+        sink(bars, count);
+      }
+    });
+  }
+
+  ~BarStage() { stop(); }
+
+  // Before start()
+  void add_sink(BarCallback sink) { sinks_.push_back(std::move(sink)); }
+
+  void start() {
+    if (timer_.joinable()) {
+      return;
+    }
+    stopping_ = false;
+    timer_ = std::thread([this]() { run_timer(); });
+  }
+
+  // Stop the timer and close the bars in progress
+  void stop() {
+    if (!timer_.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    timer_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    aggregator_.flush();
+  }
+
+  void on_ticks(const net::Tick* ticks, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aggregator_.add(ticks, count);
+  }
+
+  net::BatchCallback batch_callback() {
+    return [this](const net::Tick* ticks, size_t count) { on_ticks(ticks, count); };
+  }
+
+  BarAggregatorStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aggregator_.stats();
+  }
+
+  size_t footprint_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aggregator_.footprint_bytes();
+  }
+
+private:
+  static constexpr auto IDLE_WAIT = std::chrono::milliseconds(100);
+
+  void run_timer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      uint64_t next = aggregator_.next_close_ns();
+      if (next == std::numeric_limits<uint64_t>::max()) {
+        wake_.wait_for(lock, IDLE_WAIT, [this]() { return stopping_; });
+      } else {
+        // Deadlines are in now_ns() time: system_clock
+        std::chrono::system_clock::time_point at(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(next)));
+        wake_.wait_until(lock, at, [this]() { return stopping_; });
+      }
+      if (!stopping_) {
+        aggregator_.advance(now_ns());
+      }
+    }
+  }
+
+  BarAggregator aggregator_;
+  std::vector<BarCallback> sinks_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread timer_;
+  bool stopping_ = false;
+};
+
+#endif // BAR_AGGREGATOR_HPP
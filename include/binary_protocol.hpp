@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Message types
@@ -13,6 +14,15 @@ enum class MessageType : uint8_t {
   HEARTBEAT = 0xFF,
   SNAPSHOT_REQUEST = 0x10,
   SNAPSHOT_RESPONSE = 0x11,
+  RESUME_REQUEST = 0x12,    // Replay from a sequence (restart from checkpoint)
+  BOOK_CHECKSUM = 0x13,     // Publisher's book checksum for one symbol
+  SNAPSHOT_BEGIN = 0x14,    // Chunked snapshot: start, replaces the book
+  SNAPSHOT_CHUNK = 0x15,    // Chunked snapshot: run of levels on one side
+  SNAPSHOT_END = 0x16,      // Chunked snapshot: complete, with book checksum
+  PARTITION_SNAPSHOT_REQUEST = 0x17, // Snapshots of one hash partition of all symbols
+  COMPACT_TICKS = 0x18,     // Delta/varint-encoded tick batch (compact_encoding.hpp)
+  BAR = 0x19,               // Closed OHLCV bar for one symbol and interval (bar_aggregator.hpp)
+  SUBSCRIBE_REJECT = 0x1A,  // Distribution request refused; payload is the reason text
   ORDER_BOOK_UPDATE = 0x02  // Incremental update
 };
 
@@ -23,8 +33,32 @@ struct MessageHeader {
   uint64_t sequence;    // Monotonically increasing sequence number
   
   static constexpr size_t HEADER_SIZE = 4 + 1 + 8; // 13 bytes
+  // Largest payload any message type produces (a full SNAPSHOT_CHUNK is
+  // ~8 KiB); anything longer is a corrupt length field
+  static constexpr uint32_t MAX_PAYLOAD_SIZE = 32 * 1024;
 };
 
+inline bool is_known_message_type(uint8_t type) {
+  switch (static_cast<MessageType>(type)) {
+    case MessageType::TICK:
+    case MessageType::HEARTBEAT:
+    case MessageType::SNAPSHOT_REQUEST:
+    case MessageType::SNAPSHOT_RESPONSE:
+    case MessageType::RESUME_REQUEST:
+    case MessageType::BOOK_CHECKSUM:
+    case MessageType::SNAPSHOT_BEGIN:
+    case MessageType::SNAPSHOT_CHUNK:
+    case MessageType::SNAPSHOT_END:
+    case MessageType::PARTITION_SNAPSHOT_REQUEST:
+    case MessageType::COMPACT_TICKS:
+    case MessageType::BAR:
+    case MessageType::SUBSCRIBE_REJECT:
+    case MessageType::ORDER_BOOK_UPDATE:
+      return true;
+  }
+  return false;
+}
+
 // Tick message payload
 struct TickPayload {
   uint64_t timestamp;
@@ -38,6 +72,14 @@ struct TickPayload {
 // Backward compatibility alias
 using BinaryTick = TickPayload;
 
+// The 4 symbol bytes as one integer, for hashing and comparing without a
+// string. Host byte order: only meaningful within one process.
+inline uint32_t symbol_key(const char symbol[4]) {
+  uint32_t key;
+  memcpy(&key, symbol, 4);
+  return key;
+}
+
 // Heartbeat message payload
 struct HeartbeatPayload {
   uint64_t timestamp;
@@ -52,6 +94,33 @@ struct SnapshotRequestPayload {
   static constexpr size_t PAYLOAD_SIZE = 4; // 4 bytes
 };
 
+// Partition snapshot request: snapshots of every symbol for which
+// symbol_partition(symbol, partitions) == partition. Lets a client split the
+// whole universe across several snapshot connections.
+struct PartitionSnapshotRequestPayload {
+  uint16_t partition;
+  uint16_t partitions;
+
+  static constexpr size_t PAYLOAD_SIZE = 2 + 2; // 4 bytes
+};
+
+// Resume request payload: replay everything after from_sequence
+struct ResumeRequestPayload {
+  char symbol[4];
+  uint64_t from_sequence;  // Last sequence already applied by the client
+
+  static constexpr size_t PAYLOAD_SIZE = 4 + 8; // 12 bytes
+};
+
+// Book checksum payload: expected OrderBook::checksum() of the symbol's
+// book once every message sent before this one has been applied
+struct BookChecksumPayload {
+  char symbol[4];
+  uint64_t checksum;
+
+  static constexpr size_t PAYLOAD_SIZE = 4 + 8; // 12 bytes
+};
+
 // Order book level (for snapshot)
 struct OrderBookLevel {
   float price;
@@ -70,6 +139,42 @@ struct SnapshotResponsePayload {
   static constexpr size_t HEADER_SIZE = 4 + 1 + 1; // 6 bytes (before levels)
 };
 
+// Chunked snapshots: SNAPSHOT_BEGIN, SNAPSHOT_CHUNK..., SNAPSHOT_END, sent
+// back to back. Unlike SNAPSHOT_RESPONSE there is no per-side level limit,
+// and a receiver can apply each chunk as it arrives. The snapshot reflects
+// the stream up to SNAPSHOT_BEGIN's sequence. On a snapshot channel (a
+// connection that carries only snapshots) the three messages aren't part of
+// the live stream: all of them carry the last live sequence reflected.
+struct SnapshotBeginPayload {
+  char symbol[4];
+  uint32_t snapshot_id;     // Ties chunks and end to this begin
+  uint32_t num_bid_levels;
+  uint32_t num_ask_levels;
+
+  static constexpr size_t PAYLOAD_SIZE = 4 + 4 + 4 + 4; // 16 bytes
+};
+
+struct SnapshotChunkPayload {
+  char symbol[4];
+  uint32_t snapshot_id;
+  uint32_t chunk_index;     // 0, 1, 2, ... (a gap means a lost chunk)
+  uint8_t side;             // 0 = bid, 1 = ask; best level first
+  uint16_t num_levels;
+  // Followed by: levels[num_levels]
+
+  static constexpr size_t HEADER_SIZE = 4 + 4 + 4 + 1 + 2; // 15 bytes (before levels)
+  static constexpr size_t MAX_LEVELS = 1024;
+};
+
+struct SnapshotEndPayload {
+  char symbol[4];
+  uint32_t snapshot_id;
+  uint32_t num_chunks;
+  uint64_t checksum;        // OrderBook::checksum() of the snapshotted book
+
+  static constexpr size_t PAYLOAD_SIZE = 4 + 4 + 4 + 8; // 20 bytes
+};
+
 // Order book update payload (incremental)
 struct OrderBookUpdatePayload {
   char symbol[4];
@@ -80,6 +185,23 @@ struct OrderBookUpdatePayload {
   static constexpr size_t PAYLOAD_SIZE = 4 + 1 + 4 + 8; // 17 bytes
 };
 
+// Closed bar: [4 symbol][4 interval_ms][8 start_ns][4 open][4 high][4 low]
+// [4 close][8 volume][4 vwap][4 trades]
+struct BarPayload {
+  char symbol[4];
+  uint32_t interval_ms;
+  uint64_t start_ns;     // Bar covers [start_ns, start_ns + interval)
+  float open;
+  float high;
+  float low;
+  float close;
+  uint64_t volume;
+  float vwap;
+  uint32_t trades;
+
+  static constexpr size_t PAYLOAD_SIZE = 4 + 4 + 8 + 4 * 4 + 8 + 4 + 4; // 48 bytes
+};
+
 // Helper to convert uint64_t to/from network byte order
 #ifndef htonll
 inline uint64_t htonll(uint64_t value) {
@@ -167,6 +289,55 @@ inline std::string serialize_snapshot_request(uint64_t sequence, const char symb
   return message;
 }
 
+// Serialize partition snapshot request
+inline std::string serialize_partition_snapshot_request(uint64_t sequence, uint16_t partition,
+                                                        uint16_t partitions) {
+  std::string message;
+  message.reserve(MessageHeader::HEADER_SIZE + PartitionSnapshotRequestPayload::PAYLOAD_SIZE);
+
+  serialize_header(message, MessageType::PARTITION_SNAPSHOT_REQUEST, sequence,
+                  PartitionSnapshotRequestPayload::PAYLOAD_SIZE);
+
+  uint16_t partition_net = htons(partition);
+  uint16_t partitions_net = htons(partitions);
+  message.append(reinterpret_cast<const char*>(&partition_net), 2);
+  message.append(reinterpret_cast<const char*>(&partitions_net), 2);
+
+  return message;
+}
+
+// Serialize resume request
+inline std::string serialize_resume_request(uint64_t sequence, const char symbol[4],
+                                           uint64_t from_sequence) {
+  std::string message;
+  message.reserve(MessageHeader::HEADER_SIZE + ResumeRequestPayload::PAYLOAD_SIZE);
+
+  serialize_header(message, MessageType::RESUME_REQUEST, sequence,
+                  ResumeRequestPayload::PAYLOAD_SIZE);
+
+  message.append(symbol, 4);
+  uint64_t from_net = htonll(from_sequence);
+  message.append(reinterpret_cast<const char*>(&from_net), 8);
+
+  return message;
+}
+
+// Serialize book checksum
+inline std::string serialize_book_checksum(uint64_t sequence, const char symbol[4],
+                                          uint64_t checksum) {
+  std::string message;
+  message.reserve(MessageHeader::HEADER_SIZE + BookChecksumPayload::PAYLOAD_SIZE);
+
+  serialize_header(message, MessageType::BOOK_CHECKSUM, sequence,
+                  BookChecksumPayload::PAYLOAD_SIZE);
+
+  message.append(symbol, 4);
+  uint64_t checksum_net = htonll(checksum);
+  message.append(reinterpret_cast<const char*>(&checksum_net), 8);
+
+  return message;
+}
+
 // Serialize snapshot response
 inline std::string serialize_snapshot_response(uint64_t sequence, const char symbol[4],
                                               const std::vector<OrderBookLevel>& bids,
@@ -210,6 +381,79 @@ inline std::string serialize_snapshot_response(uint64_t sequence, const char sym
   return message;
 }
 
+// Serialize chunked snapshot begin
+inline std::string serialize_snapshot_begin(uint64_t sequence, const char symbol[4],
+                                           uint32_t snapshot_id, uint32_t num_bids,
+                                           uint32_t num_asks) {
+  std::string message;
+  message.reserve(MessageHeader::HEADER_SIZE + SnapshotBeginPayload::PAYLOAD_SIZE);
+
+  serialize_header(message, MessageType::SNAPSHOT_BEGIN, sequence,
+                  SnapshotBeginPayload::PAYLOAD_SIZE);
+
+  message.append(symbol, 4);
+  for (uint32_t value : {snapshot_id, num_bids, num_asks}) {
+    uint32_t value_net = htonl(value);
+    message.append(reinterpret_cast<const char*>(&value_net), 4);
+  }
+
+  return message;
+}
+
+// Serialize one chunk of levels (count <= SnapshotChunkPayload::MAX_LEVELS)
+inline std::string serialize_snapshot_chunk(uint64_t sequence, const char symbol[4],
+                                           uint32_t snapshot_id, uint32_t chunk_index,
+                                           uint8_t side, const OrderBookLevel* levels,
+                                           uint16_t count) {
+  std::string message;
+  uint32_t payload_size = SnapshotChunkPayload::HEADER_SIZE + count * OrderBookLevel::SIZE;
+  message.reserve(MessageHeader::HEADER_SIZE + payload_size);
+
+  serialize_header(message, MessageType::SNAPSHOT_CHUNK, sequence, payload_size);
+
+  message.append(symbol, 4);
+  uint32_t id_net = htonl(snapshot_id);
+  message.append(reinterpret_cast<const char*>(&id_net), 4);
+  uint32_t index_net = htonl(chunk_index);
+  message.append(reinterpret_cast<const char*>(&index_net), 4);
+  message.append(reinterpret_cast<const char*>(&side), 1);
+  uint16_t count_net = htons(count);
+  message.append(reinterpret_cast<const char*>(&count_net), 2);
+
+  for (uint16_t i = 0; i < count; ++i) {
+    uint32_t price_bits;
+    memcpy(&price_bits, &levels[i].price, 4);
+    uint32_t price_net = htonl(price_bits);
+    message.append(reinterpret_cast<const char*>(&price_net), 4);
+
+    uint64_t qty_net = htonll(levels[i].quantity);
+    message.append(reinterpret_cast<const char*>(&qty_net), 8);
+  }
+
+  return message;
+}
+
+// Serialize chunked snapshot end
+inline std::string serialize_snapshot_end(uint64_t sequence, const char symbol[4],
+                                         uint32_t snapshot_id, uint32_t num_chunks,
+                                         uint64_t checksum) {
+  std::string message;
+  message.reserve(MessageHeader::HEADER_SIZE + SnapshotEndPayload::PAYLOAD_SIZE);
+
+  serialize_header(message, MessageType::SNAPSHOT_END, sequence,
+                  SnapshotEndPayload::PAYLOAD_SIZE);
+
+  message.append(symbol, 4);
+  uint32_t id_net = htonl(snapshot_id);
+  message.append(reinterpret_cast<const char*>(&id_net), 4);
+  uint32_t chunks_net = htonl(num_chunks);
+  message.append(reinterpret_cast<const char*>(&chunks_net), 4);
+  uint64_t checksum_net = htonll(checksum);
+  message.append(reinterpret_cast<const char*>(&checksum_net), 8);
+
+  return message;
+}
+
 // Serialize order book update
 inline std::string serialize_order_book_update(uint64_t sequence, const char symbol[4],
                                               uint8_t side, float price, int64_t quantity) {
@@ -302,6 +546,37 @@ inline SnapshotRequestPayload deserialize_snapshot_request(const char* payload)
   return request;
 }
 
+// Deserialize partition snapshot request
+inline PartitionSnapshotRequestPayload deserialize_partition_snapshot_request(const char* payload) {
+  PartitionSnapshotRequestPayload request;
+  uint16_t partition_net, partitions_net;
+  memcpy(&partition_net, payload, 2);
+  memcpy(&partitions_net, payload + 2, 2);
+  request.partition = ntohs(partition_net);
+  request.partitions = ntohs(partitions_net);
+  return request;
+}
+
+// Deserialize resume request
+inline ResumeRequestPayload deserialize_resume_request(const char* payload) {
+  ResumeRequestPayload request;
+  memcpy(request.symbol, payload, 4);
+  uint64_t from_net;
+  memcpy(&from_net, payload + 4, 8);
+  request.from_sequence = ntohll(from_net);
+  return request;
+}
+
+// Deserialize book checksum
+inline BookChecksumPayload deserialize_book_checksum(const char* payload) {
+  BookChecksumPayload msg;
+  memcpy(msg.symbol, payload, 4);
+  uint64_t checksum_net;
+  memcpy(&checksum_net, payload + 4, 8);
+  msg.checksum = ntohll(checksum_net);
+  return msg;
+}
+
 // Deserialize snapshot response
 inline void deserialize_snapshot_response(const char* payload, uint32_t /*payload_length*/,
                                          char symbol_out[4],
@@ -356,6 +631,157 @@ inline void deserialize_snapshot_response(const char* payload, uint32_t /*payloa
   }
 }
 
+// Deserialize chunked snapshot begin
+inline SnapshotBeginPayload deserialize_snapshot_begin(const char* payload) {
+  SnapshotBeginPayload begin;
+  memcpy(begin.symbol, payload, 4);
+  uint32_t values[3];
+  memcpy(values, payload + 4, 12);
+  begin.snapshot_id = ntohl(values[0]);
+  begin.num_bid_levels = ntohl(values[1]);
+  begin.num_ask_levels = ntohl(values[2]);
+  return begin;
+}
+
+// Deserialize a chunk's fixed fields; levels follow at
+// payload + SnapshotChunkPayload::HEADER_SIZE (see deserialize_snapshot_level)
+inline SnapshotChunkPayload deserialize_snapshot_chunk(const char* payload) {
+  SnapshotChunkPayload chunk;
+  memcpy(chunk.symbol, payload, 4);
+  uint32_t id_net, index_net;
+  memcpy(&id_net, payload + 4, 4);
+  memcpy(&index_net, payload + 8, 4);
+  chunk.snapshot_id = ntohl(id_net);
+  chunk.chunk_index = ntohl(index_net);
+  chunk.side = *reinterpret_cast<const uint8_t*>(payload + 12);
+  uint16_t count_net;
+  memcpy(&count_net, payload + 13, 2);
+  chunk.num_levels = ntohs(count_net);
+  return chunk;
+}
+
+// Decode level `index` of a chunk in place, without building a vector
+inline OrderBookLevel deserialize_snapshot_level(const char* chunk_payload, size_t index) {
+  const char* p = chunk_payload + SnapshotChunkPayload::HEADER_SIZE + index * OrderBookLevel::SIZE;
+  OrderBookLevel level;
+
+  uint32_t price_net;
+  memcpy(&price_net, p, 4);
+  uint32_t price_bits = ntohl(price_net);
+  memcpy(&level.price, &price_bits, 4);
+
+  uint64_t qty_net;
+  memcpy(&qty_net, p + 4, 8);
+  level.quantity = ntohll(qty_net);
+  return level;
+}
+
+// Bounds-checked chunk decode for data off the wire. False when the fixed
+// fields don't fit in `length`, the side is unknown, or num_levels exceeds
+// MAX_LEVELS or the payload; the fixed fields are still filled in whenever
+// they fit, so callers can tell which snapshot the bad chunk belonged to.
+inline bool decode_snapshot_chunk(const char* payload, size_t length, SnapshotChunkPayload& chunk) {
+  if (length < SnapshotChunkPayload::HEADER_SIZE) {
+    return false;
+  }
+  chunk = deserialize_snapshot_chunk(payload);
+  return chunk.side <= 1 && chunk.num_levels <= SnapshotChunkPayload::MAX_LEVELS &&
+         SnapshotChunkPayload::HEADER_SIZE +
+             static_cast<size_t>(chunk.num_levels) * OrderBookLevel::SIZE <= length;
+}
+
+// Deserialize chunked snapshot end
+inline SnapshotEndPayload deserialize_snapshot_end(const char* payload) {
+  SnapshotEndPayload end;
+  memcpy(end.symbol, payload, 4);
+  uint32_t id_net, chunks_net;
+  memcpy(&id_net, payload + 4, 4);
+  memcpy(&chunks_net, payload + 8, 4);
+  end.snapshot_id = ntohl(id_net);
+  end.num_chunks = ntohl(chunks_net);
+  uint64_t checksum_net;
+  memcpy(&checksum_net, payload + 12, 8);
+  end.checksum = ntohll(checksum_net);
+  return end;
+}
+
+// Serialize a closed bar
+inline void append_bar(std::string& message, uint64_t sequence, const BarPayload& bar) {
+  serialize_header(message, MessageType::BAR, sequence, BarPayload::PAYLOAD_SIZE);
+  message.append(bar.symbol, 4);
+  auto append_u32 = [&](uint32_t value) {
+    uint32_t net = htonl(value);
+    message.append(reinterpret_cast<const char*>(&net), 4);
+  };
+  auto append_u64 = [&](uint64_t value) {
+    uint64_t net = htonll(value);
+    message.append(reinterpret_cast<const char*>(&net), 8);
+  };
+  auto append_float = [&](float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    append_u32(bits);
+  };
+  append_u32(bar.interval_ms);
+  append_u64(bar.start_ns);
+  append_float(bar.open);
+  append_float(bar.high);
+  append_float(bar.low);
+  append_float(bar.close);
+  append_u64(bar.volume);
+  append_float(bar.vwap);
+  append_u32(bar.trades);
+}
+
+inline std::string serialize_bar(uint64_t sequence, const BarPayload& bar) {
+  std::string message;
+  message.reserve(MessageHeader::HEADER_SIZE + BarPayload::PAYLOAD_SIZE);
+  append_bar(message, sequence, bar);
+  return message;
+}
+
+// Serialize a refused distribution request; the payload is the reason text
+inline std::string serialize_subscribe_reject(uint64_t sequence, std::string_view reason) {
+  reason = reason.substr(0, MessageHeader::MAX_PAYLOAD_SIZE);
+  std::string message;
+  message.reserve(MessageHeader::HEADER_SIZE + reason.size());
+  serialize_header(message, MessageType::SUBSCRIBE_REJECT, sequence,
+                   static_cast<uint32_t>(reason.size()));
+  message.append(reason);
+  return message;
+}
+
+inline BarPayload deserialize_bar(const char* payload) {
+  BarPayload bar;
+  memcpy(bar.symbol, payload, 4);
+  auto u32 = [](const char* p) {
+    uint32_t net;
+    memcpy(&net, p, 4);
+    return ntohl(net);
+  };
+  auto u64 = [](const char* p) {
+    uint64_t net;
+    memcpy(&net, p, 8);
+    return ntohll(net);
+  };
+  auto f32 = [&](const char* p) {
+    uint32_t bits = u32(p);
+    float value;
+    memcpy(&value, &bits, 4);
+    return value;
+  };
+  bar.interval_ms = u32(payload + 4);
+  bar.start_ns = u64(payload + 8);
+  bar.open = f32(payload + 16);
+  bar.high = f32(payload + 20);
+  bar.low = f32(payload + 24);
+  bar.close = f32(payload + 28);
+  bar.volume = u64(payload + 32);
+  bar.vwap = f32(payload + 40);
+  bar.trades = u32(payload + 44);
+  return bar;
+}
+
 // Deserialize order book update
 inline OrderBookUpdatePayload deserialize_order_book_update(const char* payload) {
   OrderBookUpdatePayload update;
@@ -378,4 +804,44 @@ inline OrderBookUpdatePayload deserialize_order_book_update(const char* payload)
   return update;
 }
 
+// =============================================================================
+// Book Checksum
+// =============================================================================
+
+/**
+ * Contribution of one price level to a book checksum.
+ *
+ * A book's checksum is the sum (mod 2^64) of this over all of its levels, so
+ * it does not depend on the order levels were added and can be maintained
+ * in O(1) per update: subtract a level's old contribution, add the new one.
+ * Both ends compute it from the values on the wire (price bits, quantity).
+ */
+inline uint64_t book_level_checksum(uint8_t side, float price, uint64_t quantity) {
+  uint32_t price_bits;
+  memcpy(&price_bits, &price, 4);
+
+  // splitmix64 finalizer over (side, price), mixed again with quantity
+  auto mix = [](uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  };
+  uint64_t key = (static_cast<uint64_t>(side) << 32) | price_bits;
+  return mix(mix(key) + quantity);
+}
+
+/**
+ * Which of `partitions` groups a symbol belongs to (FNV-1a of the 4 wire
+ * bytes). Publisher and client must agree: it picks the snapshot connection
+ * in PARTITION_SNAPSHOT_REQUEST and can pick the thread that owns a book.
+ */
+inline uint32_t symbol_partition(const char symbol[4], uint32_t partitions) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < 4; ++i) {
+    hash ^= static_cast<uint8_t>(symbol[i]);
+    hash *= 16777619u;
+  }
+  return partitions > 1 ? hash % partitions : 0;
+}
+
 #endif // BINARY_PROTOCOL_HPP
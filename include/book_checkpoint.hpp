@@ -0,0 +1,445 @@
+#ifndef BOOK_CHECKPOINT_HPP
+#define BOOK_CHECKPOINT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "common.hpp"
+#include "order_book.hpp"
+
+/**
+ * Memory-Mapped Book Checkpoints
+ *
+ * Persists order books, per-book sequence positions and the symbol table to a
+ * file whose layout is used directly after mmap() - no parsing or
+ * deserialization on restart, just validate and read.
+ *
+ * File layout (host byte order; checkpoints are for restarting on the same
+ * machine, not for exchange between hosts):
+ *
+ *   [CheckpointFileHeader, padded to 4 KB]
+ *   [bank 0: max_symbols fixed-size book slots]
+ *   [bank 1: max_symbols fixed-size book slots]
+ *
+ *   book slot = CheckpointBook | bids[max_levels] | asks[max_levels]
+ *
+ * Writes alternate between the two banks. A bank is published by writing its
+ * commit record (sequence watermark, symbol count, checksum) last, with the
+ * generation bumped, so a crash mid-write leaves the previous bank intact and
+ * a torn commit record fails its checksum.
+ *
+ * Usage:
+ *   auto cp = BookCheckpoint::open("books.ckpt");
+ *   // periodically
+ *   cp.value()->begin();
+ *   cp.value()->add_book("AAPL", book, last_seq);
+ *   cp.value()->commit(watermark);
+ *   // on restart
+ *   if (auto view = cp.value()->load()) { ... view->sequence() ... }
+ */
+
+// =============================================================================
+// On-Disk Layout
+// =============================================================================
+
+struct CheckpointLevel {
+  float price;
+  uint32_t reserved;
+  uint64_t quantity;
+};
+static_assert(sizeof(CheckpointLevel) == 16, "CheckpointLevel layout changed");
+
+struct CheckpointBook {
+  static constexpr uint32_t FLAG_TRUNCATED = 1u << 0; // Depth exceeded max_levels
+
+  char symbol[8];           // NUL padded
+  uint64_t last_sequence;   // Sequence of last update applied to this book
+  uint32_t bid_count;
+  uint32_t ask_count;
+  uint32_t flags;
+  uint32_t reserved;
+  // Followed by: CheckpointLevel bids[max_levels], asks[max_levels]
+};
+static_assert(sizeof(CheckpointBook) == 32, "CheckpointBook layout changed");
+
+struct CheckpointBank {
+  uint64_t generation;      // 0 = never committed
+  uint64_t sequence;        // Watermark: every message <= sequence is applied
+  uint64_t written_at_ns;
+  uint32_t symbol_count;
+  uint32_t reserved;
+  uint64_t checksum;        // Over this record (checksum = 0) + used slot bytes
+};
+
+struct CheckpointFileHeader {
+  static constexpr uint32_t MAGIC = 0x50434B42; // "BKCP"
+  static constexpr uint16_t VERSION = 1;
+  static constexpr size_t RESERVED_SIZE = 4096;
+
+  uint32_t magic;
+  uint16_t version;
+  uint16_t header_size;
+  uint32_t max_symbols;
+  uint32_t max_levels;
+  uint64_t slot_size;
+  CheckpointBank banks[2];
+};
+static_assert(sizeof(CheckpointFileHeader) <= CheckpointFileHeader::RESERVED_SIZE,
+              "Checkpoint header must fit in its reserved page");
+
+// =============================================================================
+// Read-Only View of a Committed Bank
+// =============================================================================
+
+/**
+ * Points straight into the mapping. Valid until the owning BookCheckpoint
+ * commits twice more (the bank gets reused) or is destroyed.
+ */
+class CheckpointView {
+public:
+  CheckpointView(const CheckpointBank &bank, const char *slots, uint64_t slot_size,
+                 uint32_t max_levels)
+      : bank_(&bank), slots_(slots), slot_size_(slot_size), max_levels_(max_levels) {}
+
+  uint64_t sequence() const { return bank_->sequence; }
+  uint64_t generation() const { return bank_->generation; }
+  uint64_t written_at_ns() const { return bank_->written_at_ns; }
+  size_t size() const { return bank_->symbol_count; }
+
+  const CheckpointBook &book(size_t i) const {
+    return *reinterpret_cast<const CheckpointBook *>(slots_ + i * slot_size_);
+  }
+
+  std::string symbol(size_t i) const { return trim_symbol(book(i).symbol, 8); }
+
+  const CheckpointLevel *bids(size_t i) const {
+    return reinterpret_cast<const CheckpointLevel *>(slots_ + i * slot_size_ +
+                                                     sizeof(CheckpointBook));
+  }
+
+  const CheckpointLevel *asks(size_t i) const { return bids(i) + max_levels_; }
+
+  // Linear scan of the symbol table; returns size() if absent
+  size_t find(std::string_view symbol) const {
+    for (size_t i = 0; i < size(); ++i) {
+      const char *s = book(i).symbol;
+      if (strnlen(s, 8) == symbol.size() && memcmp(s, symbol.data(), symbol.size()) == 0) {
+        return i;
+      }
+    }
+    return size();
+  }
+
+  // Rebuild a heap OrderBook from slot i (best-first level order is kept)
+  void restore(size_t i, OrderBook &out) const {
+    const CheckpointBook &b = book(i);
+    std::vector<OrderBookLevel> bid_levels(b.bid_count), ask_levels(b.ask_count);
+    for (uint32_t j = 0; j < b.bid_count; ++j) {
+      bid_levels[j] = {bids(i)[j].price, bids(i)[j].quantity};
+    }
+    for (uint32_t j = 0; j < b.ask_count; ++j) {
+      ask_levels[j] = {asks(i)[j].price, asks(i)[j].quantity};
+    }
+    out.load_snapshot(bid_levels, ask_levels);
+  }
+
+private:
+  const CheckpointBank *bank_;
+  const char *slots_;
+  uint64_t slot_size_;
+  uint32_t max_levels_;
+};
+
+// =============================================================================
+// Checkpoint File
+// =============================================================================
+
+class BookCheckpoint {
+public:
+  static constexpr uint32_t DEFAULT_MAX_SYMBOLS = 4096;
+  static constexpr uint32_t DEFAULT_MAX_LEVELS = 64;
+
+  /**
+   * Map an existing checkpoint file, or create one.
+   *
+   * An existing file with a valid header keeps its own geometry (the
+   * max_symbols / max_levels arguments only apply to new files). A file
+   * with a bad header or wrong size is reinitialized.
+   */
+  static Result<std::unique_ptr<BookCheckpoint>>
+  open(const std::string &path, uint32_t max_symbols = DEFAULT_MAX_SYMBOLS,
+       uint32_t max_levels = DEFAULT_MAX_LEVELS) {
+    using R = Result<std::unique_ptr<BookCheckpoint>>;
+
+    if (max_symbols == 0 || max_levels == 0) {
+      return R::error("checkpoint geometry must be non-zero");
+    }
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      return R::error("open " + path + " failed: " + strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+      close(fd);
+      return R::error(std::string("fstat failed: ") + strerror(errno));
+    }
+
+    CheckpointFileHeader existing{};
+    bool reuse = false;
+    if (static_cast<size_t>(st.st_size) >= sizeof(existing) &&
+        pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+        existing.magic == CheckpointFileHeader::MAGIC &&
+        existing.version == CheckpointFileHeader::VERSION &&
+        existing.header_size == sizeof(CheckpointFileHeader) &&
+        existing.max_symbols > 0 && existing.max_levels > 0 &&
+        existing.slot_size == slot_size_for(existing.max_levels) &&
+        static_cast<uint64_t>(st.st_size) ==
+            file_size_for(existing.max_symbols, existing.slot_size)) {
+      reuse = true;
+      max_symbols = existing.max_symbols;
+      max_levels = existing.max_levels;
+    } else if (st.st_size > 0) {
+      LOG_WARN("Checkpoint", "%s has an invalid header or size, reinitializing",
+               path.c_str());
+    }
+
+    const uint64_t slot_size = slot_size_for(max_levels);
+    const uint64_t file_size = file_size_for(max_symbols, slot_size);
+
+    if (!reuse && ftruncate(fd, 0) < 0) {
+      close(fd);
+      return R::error(std::string("ftruncate failed: ") + strerror(errno));
+    }
+    if (!reuse && ftruncate(fd, static_cast<off_t>(file_size)) < 0) {
+      close(fd);
+      return R::error(std::string("ftruncate failed: ") + strerror(errno));
+    }
+
+    void *addr = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      return R::error(std::string("mmap failed: ") + strerror(errno));
+    }
+
+    auto *header = static_cast<CheckpointFileHeader *>(addr);
+    if (!reuse) {
+      std::memset(header, 0, sizeof(*header));
+      header->magic = CheckpointFileHeader::MAGIC;
+      header->version = CheckpointFileHeader::VERSION;
+      header->header_size = sizeof(CheckpointFileHeader);
+      header->max_symbols = max_symbols;
+      header->max_levels = max_levels;
+      header->slot_size = slot_size;
+      msync(addr, CheckpointFileHeader::RESERVED_SIZE, MS_SYNC);
+    }
+
+    return R(std::unique_ptr<BookCheckpoint>(
+        new BookCheckpoint(path, fd, static_cast<char *>(addr), file_size)));
+  }
+
+  ~BookCheckpoint() {
+    munmap(base_, file_size_);
+    close(fd_);
+  }
+
+  BookCheckpoint(const BookCheckpoint &) = delete;
+  BookCheckpoint &operator=(const BookCheckpoint &) = delete;
+
+  /**
+   * Latest committed bank whose checksum verifies, or nullopt if there is
+   * none (new file, or both banks damaged).
+   */
+  std::optional<CheckpointView> load() const {
+    int best = latest_valid_bank();
+    if (best < 0) {
+      return std::nullopt;
+    }
+    return CheckpointView(header()->banks[best], slots(best), header()->slot_size,
+                          header()->max_levels);
+  }
+
+  /**
+   * Start a new checkpoint in the bank not holding the latest valid commit.
+   */
+  void begin() {
+    if (last_committed_bank_ == UNKNOWN_BANK) {
+      last_committed_bank_ = latest_valid_bank();
+    }
+    write_bank_ = last_committed_bank_ == 0 ? 1 : 0;
+    write_count_ = 0;
+  }
+
+  /**
+   * Copy one book into the pending bank.
+   * Returns false if the symbol table is full. Books deeper than max_levels
+   * are stored truncated and flagged so a restore can request a snapshot.
+   */
+  bool add_book(std::string_view symbol, const OrderBook &book, uint64_t last_sequence) {
+    if (write_count_ >= header()->max_symbols) {
+      return false;
+    }
+
+    const uint32_t max_levels = header()->max_levels;
+    char *slot = slots(write_bank_) + write_count_ * header()->slot_size;
+    auto *b = reinterpret_cast<CheckpointBook *>(slot);
+    auto *bid_out = reinterpret_cast<CheckpointLevel *>(slot + sizeof(CheckpointBook));
+    auto *ask_out = bid_out + max_levels;
+
+    std::memset(b, 0, sizeof(*b));
+    std::memcpy(b->symbol, symbol.data(), std::min<size_t>(symbol.size(), sizeof(b->symbol)));
+    b->last_sequence = last_sequence;
+
+    auto bids = book.get_top_bids(max_levels);
+    auto asks = book.get_top_asks(max_levels);
+    for (size_t i = 0; i < bids.size(); ++i) {
+      bid_out[i] = {bids[i].price, 0, bids[i].quantity};
+    }
+    for (size_t i = 0; i < asks.size(); ++i) {
+      ask_out[i] = {asks[i].price, 0, asks[i].quantity};
+    }
+    b->bid_count = static_cast<uint32_t>(bids.size());
+    b->ask_count = static_cast<uint32_t>(asks.size());
+    if (book.bid_depth() > max_levels || book.ask_depth() > max_levels) {
+      b->flags |= CheckpointBook::FLAG_TRUNCATED;
+    }
+
+    write_count_++;
+    return true;
+  }
+
+  /**
+   * Publish the pending bank with its sequence watermark.
+   * durable = true also waits for the data to reach storage (survives power
+   * loss); otherwise the page cache is enough to survive a process crash.
+   */
+  Result<void> commit(uint64_t sequence, bool durable = false) {
+    CheckpointBank &bank = header()->banks[write_bank_];
+    const CheckpointBank &other = header()->banks[1 - write_bank_];
+
+    CheckpointBank record{};
+    record.generation = std::max(bank.generation, other.generation) + 1;
+    record.sequence = sequence;
+    record.written_at_ns = now_ns();
+    record.symbol_count = write_count_;
+    record.checksum = bank_checksum(write_bank_, record);
+
+    // Slots must be in place before the record that vouches for them
+    std::atomic_thread_fence(std::memory_order_release);
+    bank = record;
+    last_committed_bank_ = write_bank_;
+
+    if (durable && msync(base_, file_size_, MS_SYNC) < 0) {
+      return Result<void>::error(std::string("msync failed: ") + strerror(errno));
+    }
+
+    commits_++;
+    return Result<void>();
+  }
+
+  const std::string &path() const { return path_; }
+  uint32_t max_symbols() const { return header()->max_symbols; }
+  uint32_t max_levels() const { return header()->max_levels; }
+  uint64_t file_size() const { return file_size_; }
+  uint64_t commits() const { return commits_; }
+
+  static uint64_t slot_size_for(uint32_t max_levels) {
+    uint64_t raw = sizeof(CheckpointBook) + 2ULL * max_levels * sizeof(CheckpointLevel);
+    return (raw + 63) & ~63ULL;
+  }
+
+  static uint64_t file_size_for(uint32_t max_symbols, uint64_t slot_size) {
+    return CheckpointFileHeader::RESERVED_SIZE + 2ULL * max_symbols * slot_size;
+  }
+
+private:
+  BookCheckpoint(const std::string &path, int fd, char *base, uint64_t file_size)
+      : path_(path), fd_(fd), base_(base), file_size_(file_size) {}
+
+  CheckpointFileHeader *header() const {
+    return reinterpret_cast<CheckpointFileHeader *>(base_);
+  }
+
+  char *slots(int bank) const {
+    return base_ + CheckpointFileHeader::RESERVED_SIZE +
+           static_cast<uint64_t>(bank) * header()->max_symbols * header()->slot_size;
+  }
+
+  // Highest-generation bank that passes validation, or -1
+  int latest_valid_bank() const {
+    int best = -1;
+    for (int b = 0; b < 2; ++b) {
+      const CheckpointBank &bank = header()->banks[b];
+      if (bank.generation == 0 || bank.symbol_count > header()->max_symbols) {
+        continue;
+      }
+      if (bank_checksum(b, bank) != bank.checksum || !levels_in_bounds(b, bank)) {
+        LOG_WARN("Checkpoint", "bank %d (generation %lu) failed validation", b,
+                 static_cast<unsigned long>(bank.generation));
+        continue;
+      }
+      if (best < 0 || bank.generation > header()->banks[best].generation) {
+        best = b;
+      }
+    }
+    return best;
+  }
+
+  bool levels_in_bounds(int bank, const CheckpointBank &record) const {
+    const char *base = slots(bank);
+    for (uint32_t i = 0; i < record.symbol_count; ++i) {
+      const auto *b = reinterpret_cast<const CheckpointBook *>(base + i * header()->slot_size);
+      if (b->bid_count > header()->max_levels || b->ask_count > header()->max_levels) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint64_t bank_checksum(int bank, const CheckpointBank &record) const {
+    CheckpointBank copy = record;
+    copy.checksum = 0;
+    uint64_t hash = fnv1a_hash(&copy, sizeof(copy));
+
+    const uint64_t slot_size = header()->slot_size;
+    const uint32_t max_levels = header()->max_levels;
+    const char *base = slots(bank);
+    for (uint32_t i = 0; i < record.symbol_count; ++i) {
+      const char *slot = base + i * slot_size;
+      const auto *b = reinterpret_cast<const CheckpointBook *>(slot);
+      hash = fnv1a_hash(b, sizeof(*b), hash);
+      // Only used levels are hashed; counts are bounded by the slot
+      uint32_t bids = std::min(b->bid_count, max_levels);
+      uint32_t asks = std::min(b->ask_count, max_levels);
+      const char *levels = slot + sizeof(CheckpointBook);
+      hash = fnv1a_hash(levels, bids * sizeof(CheckpointLevel), hash);
+      hash = fnv1a_hash(levels + max_levels * sizeof(CheckpointLevel),
+                             asks * sizeof(CheckpointLevel), hash);
+    }
+    return hash;
+  }
+
+  std::string path_;
+  int fd_;
+  char *base_;
+  uint64_t file_size_;
+  static constexpr int UNKNOWN_BANK = -2;
+
+  int write_bank_ = 0;
+  int last_committed_bank_ = UNKNOWN_BANK;
+  uint32_t write_count_ = 0;
+  uint64_t commits_ = 0;
+};
+
+#endif // BOOK_CHECKPOINT_HPP
@@ -0,0 +1,578 @@
+#ifndef BOOK_REPLICATION_HPP
+#define BOOK_REPLICATION_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common.hpp"
+#include "order_book.hpp"
+
+/**
+ * Hot-Standby Book Replication
+ *
+ * The primary feed handler streams every book change it applies to a
+ * standby process over a local (AF_UNIX) stream socket. The standby applies
+ * the same changes to its own books, so when the primary dies it already
+ * holds identical books and the last applied feed sequence, and can take
+ * over the feed connection by resuming from that sequence.
+ *
+ * Records are fixed-size and in host byte order (both ends run on the same
+ * machine). A standby that connects first receives a full copy of every book
+ * (RESET + LEVEL records), then live changes.
+ *
+ * Recovery: when the primary requests a snapshot to rebuild a book (checksum
+ * mismatch, a gap it couldn't confirm, reconnect), it sends INVALIDATE. The
+ * standby clears that book and marks it recovering until the rebuilt copy
+ * arrives as a new RESET; a takeover in between requests a snapshot for it
+ * instead of serving it.
+ *
+ * Consistency: every `checksum_interval` book changes, and after every full
+ * book copy, the primary sends the book's checksum (OrderBook::checksum) at
+ * that point in the stream. Records arrive in order, so the standby compares
+ * against the same state; on a mismatch it drops the connection and
+ * reconnects for a fresh full copy.
+ *
+ * The primary never blocks on the standby: records are buffered and sent
+ * non-blocking, and a standby that falls more than MAX_PENDING_BYTES behind
+ * is disconnected (it reconnects and resyncs).
+ *
+ * Takeover: a closed connection or a silent one is not proof the primary is
+ * dead. The primary drops a lagging standby, replaces it with a newer one,
+ * and may stall. So the standby first reconnects: if the primary still
+ * accepts, the standby resyncs from a fresh full copy. It only reports the
+ * primary lost when nothing listens on the path any more (the process is
+ * gone), or when a fresh connection stays silent for the whole primary
+ * timeout (the process is hung). The timeout must exceed the longest stall
+ * the primary can have between heartbeats.
+ *
+ * Usage (primary):
+ *   ReplicationPublisher pub("/tmp/feed.repl");
+ *   pub.listen();
+ *   // main loop
+ *   if (pub.poll()) pub.publish_book("AAPL", book, book_seq);  // New standby
+ *   pub.publish_update("AAPL", book, side, price, qty, seq);
+ *   pub.publish_invalidate("AAPL", seq);                        // Resync started
+ *
+ * Usage (standby):
+ *   ReplicationStandby standby("/tmp/feed.repl");
+ *   standby.connect();
+ *   while (standby.poll(10)) {}   // Reconnects on its own; false once the primary is gone
+ *   standby.books().at("AAPL").book ...
+ */
+
+// =============================================================================
+// Wire Format
+// =============================================================================
+
+enum class ReplicationType : uint8_t {
+  RESET = 1,     // Clear book (start of a full copy)
+  LEVEL = 2,     // Set one level; quantity 0 deletes it
+  SEQUENCE = 3,  // Feed sequence advanced without a book change
+  CHECKSUM = 4,  // Book checksum at this point in the stream
+  HEARTBEAT = 5, // Primary alive, nothing else to send
+  INVALIDATE = 6 // Book is being recovered; no state until its next RESET
+};
+
+struct ReplicationRecord {
+  uint8_t type;
+  uint8_t side;          // LEVEL: 0 = bid, 1 = ask
+  uint16_t reserved;
+  float price;
+  char symbol[8];        // NUL padded
+  uint64_t quantity;
+  uint64_t sequence;     // Feed sequence the primary had applied
+  uint64_t checksum;     // CHECKSUM only
+};
+static_assert(sizeof(ReplicationRecord) == 40, "ReplicationRecord layout changed");
+
+namespace replication_detail {
+
+inline ReplicationRecord make_record(ReplicationType type, std::string_view symbol,
+                                     uint64_t sequence) {
+  ReplicationRecord rec{};
+  rec.type = static_cast<uint8_t>(type);
+  memcpy(rec.symbol, symbol.data(), std::min(symbol.size(), sizeof(rec.symbol)));
+  rec.sequence = sequence;
+  return rec;
+}
+
+} // namespace replication_detail
+
+// =============================================================================
+// Primary Side
+// =============================================================================
+
+class ReplicationPublisher {
+public:
+  static constexpr size_t MAX_PENDING_BYTES = 4 * 1024 * 1024;
+  static constexpr uint64_t DEFAULT_CHECKSUM_INTERVAL = 256;
+  static constexpr auto HEARTBEAT_INTERVAL = std::chrono::milliseconds(50);
+  // Room for a standby reconnecting while the old connection is still queued
+  static constexpr int LISTEN_BACKLOG = 4;
+
+  explicit ReplicationPublisher(std::string path,
+                                uint64_t checksum_interval = DEFAULT_CHECKSUM_INTERVAL)
+      : path_(std::move(path)), checksum_interval_(checksum_interval) {}
+
+  ~ReplicationPublisher() {
+    drop_standby();
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+      unlink(path_.c_str());
+    }
+  }
+
+  ReplicationPublisher(const ReplicationPublisher &) = delete;
+  ReplicationPublisher &operator=(const ReplicationPublisher &) = delete;
+
+  // Bind the socket path (a stale socket from a dead primary is replaced)
+  Result<void> listen() {
+    auto listening = unix_socket_listen(path_, SOCK_STREAM, LISTEN_BACKLOG);
+    if (!listening) {
+      return Result<void>::error(listening.error());
+    }
+    listen_fd_ = listening.value();
+    return socket_set_nonblocking(listen_fd_);
+  }
+
+  /**
+   * Accept a waiting standby, flush pending records, send a heartbeat when
+   * idle. Returns true when a new standby connected: the caller must then
+   * publish_book() every book so it starts from a full copy.
+   */
+  bool poll() {
+    bool new_standby = false;
+
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd >= 0) {
+      drop_standby(); // One standby at a time; newest wins
+      socket_set_nonblocking(fd);
+      socket_set_nosigpipe(fd);
+      standby_fd_ = fd;
+      standbys_connected_++;
+      new_standby = true;
+      LOG_INFO("Replication", "Standby connected on %s", path_.c_str());
+    }
+
+    if (standby_fd_ < 0) {
+      return new_standby;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (pending_.empty() && now - last_send_ >= HEARTBEAT_INTERVAL) {
+      append(replication_detail::make_record(ReplicationType::HEARTBEAT, "", last_sequence_));
+    }
+    flush();
+    return new_standby;
+  }
+
+  // Full copy of one book: RESET, every level, then its checksum
+  void publish_book(std::string_view symbol, const OrderBook &book, uint64_t sequence) {
+    if (standby_fd_ < 0) {
+      return;
+    }
+    last_sequence_ = std::max(last_sequence_, sequence);
+    append(replication_detail::make_record(ReplicationType::RESET, symbol, sequence));
+
+    for (uint8_t side = 0; side < 2; ++side) {
+      auto levels = side == 0 ? book.get_top_bids(book.bid_depth())
+                              : book.get_top_asks(book.ask_depth());
+      for (const auto &level : levels) {
+        auto rec = replication_detail::make_record(ReplicationType::LEVEL, symbol, sequence);
+        rec.side = side;
+        rec.price = level.price;
+        rec.quantity = level.quantity;
+        append(rec);
+      }
+    }
+    publish_checksum(symbol, book, sequence);
+  }
+
+  // One applied level change; `book` is the state after applying it
+  void publish_update(std::string_view symbol, const OrderBook &book, uint8_t side,
+                      float price, uint64_t quantity, uint64_t sequence) {
+    if (standby_fd_ < 0) {
+      return;
+    }
+    last_sequence_ = std::max(last_sequence_, sequence);
+    auto rec = replication_detail::make_record(ReplicationType::LEVEL, symbol, sequence);
+    rec.side = side;
+    rec.price = price;
+    rec.quantity = quantity;
+    append(rec);
+
+    if (++changes_since_checksum_ >= checksum_interval_) {
+      publish_checksum(symbol, book, sequence);
+    }
+  }
+
+  // The book stopped being usable (its snapshot was requested); the next
+  // publish_book for it makes it valid again
+  void publish_invalidate(std::string_view symbol, uint64_t sequence) {
+    if (standby_fd_ < 0) {
+      return;
+    }
+    last_sequence_ = std::max(last_sequence_, sequence);
+    append(replication_detail::make_record(ReplicationType::INVALIDATE, symbol, sequence));
+  }
+
+  // Feed sequence moved without a book change (heartbeat, tick, ...)
+  void publish_sequence(uint64_t sequence) {
+    if (standby_fd_ < 0) {
+      return;
+    }
+    last_sequence_ = std::max(last_sequence_, sequence);
+    append(replication_detail::make_record(ReplicationType::SEQUENCE, "", sequence));
+  }
+
+  void publish_checksum(std::string_view symbol, const OrderBook &book, uint64_t sequence) {
+    if (standby_fd_ < 0) {
+      return;
+    }
+    auto rec = replication_detail::make_record(ReplicationType::CHECKSUM, symbol, sequence);
+    rec.checksum = book.checksum();
+    append(rec);
+    changes_since_checksum_ = 0;
+    checksums_sent_++;
+  }
+
+  // Send as much as the socket takes without blocking
+  void flush() {
+    while (standby_fd_ >= 0 && sent_offset_ < pending_.size()) {
+      ssize_t n = send(standby_fd_, pending_.data() + sent_offset_,
+                       pending_.size() - sent_offset_, SOCKET_SEND_FLAGS);
+      if (n > 0) {
+        sent_offset_ += n;
+        last_send_ = std::chrono::steady_clock::now();
+      } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      } else {
+        LOG_WARN("Replication", "Standby disconnected");
+        drop_standby();
+        return;
+      }
+    }
+
+    if (sent_offset_ == pending_.size()) {
+      pending_.clear();
+      sent_offset_ = 0;
+    } else if (pending_.size() - sent_offset_ > MAX_PENDING_BYTES) {
+      LOG_WARN("Replication", "Standby fell %s behind, disconnecting",
+               format_bytes(pending_.size() - sent_offset_).c_str());
+      standby_drops_++;
+      drop_standby();
+    }
+  }
+
+  bool has_standby() const { return standby_fd_ >= 0; }
+  size_t pending_bytes() const { return pending_.size() - sent_offset_; }
+  uint64_t records_published() const { return records_published_; }
+  uint64_t checksums_sent() const { return checksums_sent_; }
+  uint64_t standbys_connected() const { return standbys_connected_; }
+  uint64_t standby_drops() const { return standby_drops_; }
+  const std::string &path() const { return path_; }
+
+private:
+  void append(const ReplicationRecord &rec) {
+    const char *bytes = reinterpret_cast<const char *>(&rec);
+    pending_.insert(pending_.end(), bytes, bytes + sizeof(rec));
+    records_published_++;
+  }
+
+  void drop_standby() {
+    if (standby_fd_ >= 0) {
+      close(standby_fd_);
+      standby_fd_ = -1;
+    }
+    pending_.clear();
+    sent_offset_ = 0;
+  }
+
+  std::string path_;
+  uint64_t checksum_interval_;
+  int listen_fd_ = -1;
+  int standby_fd_ = -1;
+
+  std::vector<char> pending_;
+  size_t sent_offset_ = 0;
+  std::chrono::steady_clock::time_point last_send_{};
+  uint64_t last_sequence_ = 0;
+  uint64_t changes_since_checksum_ = 0;
+
+  uint64_t records_published_ = 0;
+  uint64_t checksums_sent_ = 0;
+  uint64_t standbys_connected_ = 0;
+  uint64_t standby_drops_ = 0;
+};
+
+// =============================================================================
+// Standby Side
+// =============================================================================
+
+struct ReplicatedBook {
+  OrderBook book;
+  uint64_t last_sequence = 0; // Sequence of the last change to this book
+  bool recovering = false;    // Invalidated by the primary, no full copy since
+};
+
+class ReplicationStandby {
+public:
+  // Comfortably above the primary's heartbeat interval and its longest
+  // stall (the feed handler services replication while it reconnects)
+  static constexpr auto DEFAULT_PRIMARY_TIMEOUT = std::chrono::milliseconds(1000);
+
+  explicit ReplicationStandby(std::string path,
+                              std::chrono::milliseconds primary_timeout = DEFAULT_PRIMARY_TIMEOUT)
+      : path_(std::move(path)), primary_timeout_(primary_timeout) {
+    buffer_.resize(64 * 1024);
+  }
+
+  ~ReplicationStandby() { disconnect(); }
+
+  ReplicationStandby(const ReplicationStandby &) = delete;
+  ReplicationStandby &operator=(const ReplicationStandby &) = delete;
+
+  // One connection attempt to the primary
+  Result<void> connect() {
+    // Non-blocking so a primary whose accept queue is full (alive but not
+    // accepting) fails with EAGAIN instead of blocking the standby
+    SocketOptions opts;
+    opts.non_blocking = true;
+    auto connected = unix_socket_connect(path_, SOCK_STREAM, opts);
+    if (!connected) {
+      connect_errno_ = errno;
+      return Result<void>::error(connected.error());
+    }
+
+    disconnect();
+    fd_ = connected.value();
+    buffered_ = 0;
+    records_since_connect_ = false;
+    last_record_ = std::chrono::steady_clock::now();
+    return Result<void>();
+  }
+
+  /**
+   * Wait up to timeout_ms for records and apply them.
+   * A dropped or silent connection is retried first (see the header comment):
+   * poll() returns false only once the primary is gone, and
+   * primary_lost_at_ns() records when that was noticed. The books and
+   * sequence are kept until a new connection delivers its first record, so
+   * a takeover after a failed reconnect still starts from them.
+   */
+  bool poll(int timeout_ms) {
+    if (fd_ < 0) {
+      if (!reconnecting_) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(std::max(timeout_ms, 1)));
+      return reconnect("primary not accepting");
+    }
+
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, timeout_ms);
+    if (ready < 0 && errno != EINTR) {
+      return connection_lost("poll failed");
+    }
+
+    if (ready > 0) {
+      ssize_t n = recv(fd_, buffer_.data() + buffered_, buffer_.size() - buffered_, 0);
+      if (n == 0) {
+        return connection_lost("primary closed the connection");
+      }
+      if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          return true;
+        }
+        return connection_lost(strerror(errno));
+      }
+      if (!records_since_connect_ && discard_on_first_record_) {
+        books_.clear();  // The new connection starts with a full copy
+        discard_on_first_record_ = false;
+      }
+      records_since_connect_ = true;
+      buffered_ += n;
+      last_record_ = std::chrono::steady_clock::now();
+      if (!apply_buffered()) {
+        return resync();
+      }
+    } else if (std::chrono::steady_clock::now() - last_record_ > primary_timeout_) {
+      if (!records_since_connect_) {
+        // Accepted (or queued) but nothing sent for a whole timeout: hung
+        return primary_lost("primary silent");
+      }
+      return connection_lost("primary silent");
+    }
+    return true;
+  }
+
+  const std::map<std::string, ReplicatedBook> &books() const { return books_; }
+  std::optional<uint64_t> last_sequence() const {
+    return has_sequence_ ? std::optional<uint64_t>(last_sequence_) : std::nullopt;
+  }
+  bool connected() const { return fd_ >= 0; }
+  uint64_t primary_lost_at_ns() const { return primary_lost_at_ns_; }
+  uint64_t records_applied() const { return records_applied_; }
+  uint64_t checksums_verified() const { return checksums_verified_; }
+  uint64_t checksum_mismatches() const { return checksum_mismatches_; }
+  uint64_t resyncs() const { return resyncs_; }
+
+private:
+  // Applies whole records; false on a checksum mismatch
+  bool apply_buffered() {
+    constexpr size_t REC = sizeof(ReplicationRecord);
+    size_t offset = 0;
+    bool consistent = true;
+
+    while (consistent && buffered_ - offset >= REC) {
+      ReplicationRecord rec;
+      memcpy(&rec, buffer_.data() + offset, REC);
+      offset += REC;
+      consistent = apply(rec);
+    }
+
+    buffered_ -= offset;
+    if (buffered_ > 0) {
+      memmove(buffer_.data(), buffer_.data() + offset, buffered_);
+    }
+    return consistent;
+  }
+
+  bool apply(const ReplicationRecord &rec) {
+    records_applied_++;
+    if (rec.type != static_cast<uint8_t>(ReplicationType::HEARTBEAT) || has_sequence_) {
+      last_sequence_ = std::max(last_sequence_, rec.sequence);
+      has_sequence_ = true;
+    }
+
+    switch (static_cast<ReplicationType>(rec.type)) {
+    case ReplicationType::RESET: {
+      ReplicatedBook &rb = books_[trim_symbol(rec.symbol, sizeof(rec.symbol))];
+      rb.book.clear();
+      rb.last_sequence = rec.sequence;
+      rb.recovering = false;
+      break;
+    }
+    case ReplicationType::INVALIDATE: {
+      ReplicatedBook &rb = books_[trim_symbol(rec.symbol, sizeof(rec.symbol))];
+      rb.book.clear();
+      rb.last_sequence = rec.sequence;
+      rb.recovering = true;
+      break;
+    }
+    case ReplicationType::LEVEL: {
+      ReplicatedBook &rb = books_[trim_symbol(rec.symbol, sizeof(rec.symbol))];
+      rb.book.apply_update(rec.side, rec.price, static_cast<int64_t>(rec.quantity));
+      rb.last_sequence = rec.sequence;
+      break;
+    }
+    case ReplicationType::CHECKSUM: {
+      std::string symbol = trim_symbol(rec.symbol, sizeof(rec.symbol));
+      auto it = books_.find(symbol);
+      uint64_t ours = it == books_.end() ? 0 : it->second.book.checksum();
+      if (ours != rec.checksum) {
+        checksum_mismatches_++;
+        LOG_WARN("Replication", "Checksum mismatch for %s at seq=%lu, resyncing",
+                 symbol.c_str(), rec.sequence);
+        return false;
+      }
+      checksums_verified_++;
+      break;
+    }
+    case ReplicationType::SEQUENCE:
+    case ReplicationType::HEARTBEAT:
+      break;
+    default:
+      LOG_WARN("Replication", "Unknown record type %d", rec.type);
+    }
+    return true;
+  }
+
+  // Checksum mismatch: our books are wrong, so drop them and reconnect so
+  // the primary sends a fresh full copy
+  bool resync() {
+    resyncs_++;
+    books_.clear();
+    if (!connect()) {
+      return primary_lost("resync failed");
+    }
+    return true;
+  }
+
+  // The connection ended, but the primary may not have: try it again
+  bool connection_lost(const char *reason) {
+    LOG_WARN("Replication", "Connection to primary lost (%s), reconnecting", reason);
+    disconnect();
+    reconnect_deadline_ = std::chrono::steady_clock::now() + primary_timeout_;
+    return reconnect(reason);
+  }
+
+  // Connected again: resync. Nothing listening: the primary is gone. A full
+  // accept queue means alive but busy; retried until the deadline.
+  bool reconnect(const char *reason) {
+    if (connect()) {
+      reconnecting_ = false;
+      discard_on_first_record_ = true;
+      resyncs_++;
+      LOG_INFO("Replication", "Reconnected to primary, resyncing");
+      return true;
+    }
+    if ((connect_errno_ == EAGAIN || connect_errno_ == EWOULDBLOCK) &&
+        std::chrono::steady_clock::now() < reconnect_deadline_) {
+      reconnecting_ = true;
+      return true;
+    }
+    reconnecting_ = false;
+    return primary_lost(reason);
+  }
+
+  bool primary_lost(const char *reason) {
+    primary_lost_at_ns_ = now_ns();
+    LOG_WARN("Replication", "Primary lost: %s", reason);
+    disconnect();
+    return false;
+  }
+
+  void disconnect() {
+    if (fd_ >= 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  std::string path_;
+  std::chrono::milliseconds primary_timeout_;
+  int fd_ = -1;
+
+  std::vector<char> buffer_;
+  size_t buffered_ = 0;
+  std::chrono::steady_clock::time_point last_record_{};
+  bool records_since_connect_ = false;
+  bool discard_on_first_record_ = false;  // Reconnected: next record starts a full copy
+  bool reconnecting_ = false;              // Primary alive but not accepting yet
+  int connect_errno_ = 0;
+  std::chrono::steady_clock::time_point reconnect_deadline_{};
+
+  std::map<std::string, ReplicatedBook> books_;
+  uint64_t last_sequence_ = 0;
+  bool has_sequence_ = false;
+
+  uint64_t primary_lost_at_ns_ = 0;
+  uint64_t records_applied_ = 0;
+  uint64_t checksums_verified_ = 0;
+  uint64_t checksum_mismatches_ = 0;
+  uint64_t resyncs_ = 0;
+};
+
+#endif // BOOK_REPLICATION_HPP
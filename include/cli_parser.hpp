@@ -8,6 +8,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 /**
  * CLI Parser for Feed Handler
@@ -17,11 +18,31 @@
  *
  * Options:
  *   --host <hostname>     Server hostname or IP (default: 127.0.0.1)
- *   --port <port>         Server port (required)
+ *   --port <port>         Server port (required for tcp)
+ *   --transport <t>       tcp, unix, unixgram or shm (default: tcp)
+ *   --path <path>         Socket path or shm ring name (non-tcp transports)
  *   --threads=R,P,B       Thread counts: reader, parser, book-updater (default: 1,1,1)
  *   --protocol <type>     Protocol: text or binary (default: text)
  *   --queue-size <size>   Queue capacity (default: 1048576)
  *   --verbose             Enable verbose output
+ *   --watchdog            Enable stall watchdog with trace dumps
+ *   --stall-ms <ms>       Watchdog stall threshold (default: 200)
+ *   --watchdog-dump <p>   Watchdog dump file prefix (default: watchdog_dump)
+ *   --warmup              Prime caches/page tables before connecting
+ *   --warmup-ms <ms>      Warm-up time budget (default: 250)
+ *   --symbols A,B,C       Known symbol universe (preallocated books)
+ *   --crc                 Binary frames carry a CRC32C trailer
+ *   --subscribe A,B,C     Only pass these symbols downstream (default: all)
+ *   --distribute <path>   Serve local subscribers on a Unix socket
+ *   --republish <port>    Republish to remote consumers over TCP
+ *   --republish-policy p  Slow republish clients: disconnect or drop
+ *   --republish-delay-us <us>  Republish max batching delay (default: 200)
+ *   --republish-spin      Republisher thread spins instead of sleeping when idle
+ *   --bars 1s,1m          Aggregate OHLCV bars for these intervals (ms/s/m)
+ *   --bars-journal <p>    Append closed bars to a file as BAR frames
+ *   --bars-shm <name>     Publish closed bars on a shared memory ring
+ *   --plan-memory <n>     Print the memory needed for n symbols and exit
+ *   --depth <n>           Book levels per side for --plan-memory (default: 10)
  *   --help                Show help message
  */
 
@@ -43,14 +64,34 @@ enum class Protocol {
 struct FeedConfig {
   std::string host = "127.0.0.1";
   uint16_t port = 0;
+  std::string transport = "tcp";       // tcp, unix, unixgram, shm
+  std::string path;                    // Socket path / shm name when not tcp
   ThreadConfig threads;
   Protocol protocol = Protocol::TEXT;
   size_t queue_size = 1024 * 1024;  // 1M entries
   bool verbose = false;
+  bool watchdog = false;
+  int stall_ms = 200;
+  std::string watchdog_dump = "watchdog_dump";
+  bool warmup = false;
+  int warmup_ms = 250;
+  std::vector<std::string> symbols;
+  bool crc = false;
+  std::vector<std::string> subscribe;  // Empty = every symbol
+  std::string distribute;              // Empty = no local distribution
+  int republish_port = 0;              // 0 = no TCP republisher
+  std::string republish_policy = "disconnect";
+  int republish_delay_us = 200;
+  bool republish_spin = false;
+  std::vector<uint64_t> bar_intervals_ms;  // Empty = no bar aggregation
+  std::string bars_journal;
+  std::string bars_shm;
+  size_t plan_symbols = 0;  // Nonzero: print a memory plan instead of running
+  size_t plan_depth = 10;
   bool help_requested = false;
 
   bool is_valid() const {
-    return port != 0 &&
+    return (transport == "tcp" ? port != 0 : !path.empty()) &&
            threads.reader_threads > 0 &&
            threads.parser_threads > 0 &&
            threads.book_updater_threads > 0;
@@ -65,15 +106,38 @@ public:
               << "TCP Feed Handler - Receives and processes market data ticks\n"
               << "\n"
               << "Required:\n"
-              << "  --port <port>         Server port number\n"
+              << "  --port <port>         Server port number (or --transport/--path)\n"
               << "\n"
               << "Options:\n"
               << "  --host <hostname>     Server hostname or IP (default: 127.0.0.1)\n"
+              << "  --transport <t>       tcp, unix, unixgram or shm (default: tcp)\n"
+              << "  --path <path>         Socket path or shm ring name for non-tcp transports\n"
               << "  --threads=R,P,B       Thread counts: reader,parser,book-updater\n"
               << "                        (default: 1,1,1)\n"
               << "  --protocol <type>     Protocol type: text or binary (default: text)\n"
               << "  --queue-size <size>   Queue capacity in entries (default: 1048576)\n"
               << "  --verbose             Enable verbose output\n"
+              << "  --watchdog            Enable stall watchdog (dumps trace on stall)\n"
+              << "  --stall-ms <ms>       Watchdog stall threshold in ms (default: 200)\n"
+              << "  --watchdog-dump <p>   Watchdog dump file prefix (default: watchdog_dump)\n"
+              << "  --warmup              Warm up hot path with synthetic traffic first\n"
+              << "  --warmup-ms <ms>      Warm-up time budget in ms (default: 250)\n"
+              << "  --symbols A,B,C       Known symbol universe (books preallocated)\n"
+              << "  --crc                 Verify CRC32C trailers on binary frames\n"
+              << "  --subscribe A,B,C     Drop ticks for other symbols at the reader\n"
+              << "  --distribute <path>   Serve local subscribers on a Unix socket\n"
+              << "  --republish <port>    Republish to remote consumers over TCP\n"
+              << "  --republish-policy p  Slow republish clients: disconnect or drop\n"
+              << "                        (default: disconnect)\n"
+              << "  --republish-delay-us <us>\n"
+              << "                        Max time a frame waits to be batched (default: 200)\n"
+              << "  --republish-spin      Republisher thread spins instead of sleeping when idle\n"
+              << "  --bars 1s,1m          Aggregate OHLCV bars per symbol for these intervals\n"
+              << "                        (suffix ms, s or m; plain numbers are ms)\n"
+              << "  --bars-journal <p>    Append closed bars to a file as BAR frames\n"
+              << "  --bars-shm <name>     Publish closed bars on a shared memory ring\n"
+              << "  --plan-memory <n>     Print the memory n symbols would need, then exit\n"
+              << "  --depth <n>           Book levels per side for --plan-memory (default: 10)\n"
               << "  --help                Show this help message\n"
               << "\n"
               << "Examples:\n"
@@ -110,6 +174,18 @@ public:
       else if (arg == "--port" && i + 1 < argc) {
         config.port = static_cast<uint16_t>(std::atoi(argv[++i]));
       }
+      else if (arg == "--transport" && i + 1 < argc) {
+        config.transport = argv[++i];
+        if (config.transport != "tcp" && config.transport != "unix" &&
+            config.transport != "unixgram" && config.transport != "shm") {
+          std::cerr << "Error: Unknown transport: " << config.transport << "\n";
+          std::cerr << "Supported transports: tcp, unix, unixgram, shm\n";
+          return std::nullopt;
+        }
+      }
+      else if (arg == "--path" && i + 1 < argc) {
+        config.path = argv[++i];
+      }
       else if (arg.substr(0, 10) == "--threads=") {
         if (!parse_threads(arg.substr(10), config.threads)) {
           std::cerr << "Error: Invalid thread configuration: " << arg << "\n";
@@ -142,6 +218,69 @@ public:
       else if (arg == "--verbose" || arg == "-v") {
         config.verbose = true;
       }
+      else if (arg == "--watchdog") {
+        config.watchdog = true;
+      }
+      else if (arg == "--stall-ms" && i + 1 < argc) {
+        config.stall_ms = std::atoi(argv[++i]);
+      }
+      else if (arg == "--watchdog-dump" && i + 1 < argc) {
+        config.watchdog_dump = argv[++i];
+      }
+      else if (arg == "--crc") {
+        config.crc = true;
+      }
+      else if (arg == "--warmup") {
+        config.warmup = true;
+      }
+      else if (arg == "--warmup-ms" && i + 1 < argc) {
+        config.warmup_ms = std::atoi(argv[++i]);
+      }
+      else if (arg == "--symbols" && i + 1 < argc) {
+        config.symbols = parse_symbols(argv[++i]);
+      }
+      else if (arg == "--subscribe" && i + 1 < argc) {
+        config.subscribe = parse_symbols(argv[++i]);
+      }
+      else if (arg == "--distribute" && i + 1 < argc) {
+        config.distribute = argv[++i];
+      }
+      else if (arg == "--republish" && i + 1 < argc) {
+        config.republish_port = std::atoi(argv[++i]);
+      }
+      else if (arg == "--republish-policy" && i + 1 < argc) {
+        config.republish_policy = argv[++i];
+        if (config.republish_policy != "disconnect" && config.republish_policy != "drop") {
+          std::cerr << "Error: Invalid republish policy: " << config.republish_policy
+                    << " (use 'disconnect' or 'drop')\n";
+          return std::nullopt;
+        }
+      }
+      else if (arg == "--republish-delay-us" && i + 1 < argc) {
+        config.republish_delay_us = std::atoi(argv[++i]);
+      }
+      else if (arg == "--republish-spin") {
+        config.republish_spin = true;
+      }
+      else if (arg == "--bars" && i + 1 < argc) {
+        if (!parse_intervals(argv[++i], config.bar_intervals_ms)) {
+          std::cerr << "Error: Invalid bar intervals: " << argv[i]
+                    << " (e.g. --bars 1s,1m or --bars 500ms)\n";
+          return std::nullopt;
+        }
+      }
+      else if (arg == "--bars-journal" && i + 1 < argc) {
+        config.bars_journal = argv[++i];
+      }
+      else if (arg == "--bars-shm" && i + 1 < argc) {
+        config.bars_shm = argv[++i];
+      }
+      else if (arg == "--plan-memory" && i + 1 < argc) {
+        config.plan_symbols = static_cast<size_t>(std::atol(argv[++i]));
+      }
+      else if (arg == "--depth" && i + 1 < argc) {
+        config.plan_depth = static_cast<size_t>(std::atol(argv[++i]));
+      }
       else if (arg[0] == '-') {
         std::cerr << "Error: Unknown option: " << arg << "\n";
         return std::nullopt;
@@ -161,6 +300,8 @@ public:
     std::cout << "=== Feed Handler Configuration ===\n"
               << "Host:           " << config.host << "\n"
               << "Port:           " << config.port << "\n"
+              << "Transport:      " << config.transport
+              << (config.transport == "tcp" ? "" : " " + config.path) << "\n"
               << "Protocol:       " << (config.protocol == Protocol::TEXT ? "text" : "binary") << "\n"
               << "Threads:\n"
               << "  Reader:       " << config.threads.reader_threads << "\n"
@@ -168,11 +309,85 @@ public:
               << "  Book Updater: " << config.threads.book_updater_threads << "\n"
               << "Queue Size:     " << config.queue_size << "\n"
               << "Verbose:        " << (config.verbose ? "yes" : "no") << "\n"
+              << "Watchdog:       " << (config.watchdog ? "yes" : "no");
+    if (config.watchdog) {
+      std::cout << " (stall " << config.stall_ms << " ms, dump "
+                << config.watchdog_dump << ".N.txt)";
+    }
+    std::cout << "\n"
+              << "Warm-up:        " << (config.warmup ? "yes" : "no");
+    if (config.warmup) {
+      std::cout << " (budget " << config.warmup_ms << " ms)";
+    }
+    std::cout << "\n"
+              << "Symbols:        " << config.symbols.size() << " known\n"
+              << "Frame CRC:      " << (config.crc ? "yes" : "no") << "\n"
+              << "Subscribed:     "
+              << (config.subscribe.empty() ? std::string("all") : std::to_string(config.subscribe.size()))
+              << "\n"
+              << "Distribution:   " << (config.distribute.empty() ? "off" : config.distribute) << "\n"
+              << "Republish:      ";
+    if (config.republish_port > 0) {
+      std::cout << "port " << config.republish_port << " (" << config.republish_policy
+                << ", max delay " << config.republish_delay_us << " us"
+                << (config.republish_spin ? ", spinning" : "") << ")";
+    } else {
+      std::cout << "off";
+    }
+    std::cout << "\n"
+              << "Bars:           ";
+    if (config.bar_intervals_ms.empty()) {
+      std::cout << "off";
+    } else {
+      for (size_t i = 0; i < config.bar_intervals_ms.size(); ++i) {
+        std::cout << (i ? "," : "") << config.bar_intervals_ms[i] << "ms";
+      }
+      if (!config.bars_journal.empty()) std::cout << " journal " << config.bars_journal;
+      if (!config.bars_shm.empty()) std::cout << " shm " << config.bars_shm;
+    }
+    std::cout << "\n"
               << "==================================\n"
               << std::endl;
   }
 
 private:
+  static std::vector<std::string> parse_symbols(std::string_view spec) {
+    std::vector<std::string> symbols;
+    while (!spec.empty()) {
+      size_t comma = spec.find(',');
+      std::string_view sym = spec.substr(0, comma);
+      if (!sym.empty()) {
+        symbols.emplace_back(sym);
+      }
+      if (comma == std::string_view::npos) break;
+      spec.remove_prefix(comma + 1);
+    }
+    return symbols;
+  }
+
+  // "1s,1m,250ms" -> {1000, 60000, 250}; a bare number is milliseconds
+  static bool parse_intervals(std::string_view spec, std::vector<uint64_t>& intervals_ms) {
+    intervals_ms.clear();
+    for (const auto& item : parse_symbols(spec)) {
+      size_t digits = 0;
+      uint64_t value = 0;
+      while (digits < item.size() && item[digits] >= '0' && item[digits] <= '9') {
+        value = value * 10 + static_cast<uint64_t>(item[digits++] - '0');
+      }
+      std::string_view unit = std::string_view(item).substr(digits);
+      if (digits == 0 || value == 0) return false;
+      if (unit == "m") {
+        value *= 60'000;
+      } else if (unit == "s") {
+        value *= 1'000;
+      } else if (!unit.empty() && unit != "ms") {
+        return false;
+      }
+      intervals_ms.push_back(value);
+    }
+    return !intervals_ms.empty();
+  }
+
   static bool parse_threads(std::string_view spec, ThreadConfig& threads) {
     // Parse "R,P,B" format
     size_t pos1 = spec.find(',');
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <arpa/inet.h>
+#include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <cstring>
@@ -13,12 +14,19 @@
 #include <netinet/tcp.h>
 #include <numeric>
 #include <optional>
+#include <poll.h>
 #include <sstream>
 #include <string>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <vector>
 
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
 /**
  * Common Utilities Header
  *
@@ -230,6 +238,8 @@ public:
 
   size_t count() const { return latencies_.size(); }
 
+  size_t capacity() const { return latencies_.capacity(); }
+
   bool empty() const { return latencies_.empty(); }
 
   // Get percentile value (0-100)
@@ -446,27 +456,18 @@ inline Result<int> socket_connect(const std::string &host, int port,
         connect(sockfd, (struct sockaddr *)&server_addr, sizeof(server_addr));
 
     if (connect_result < 0 && errno == EINPROGRESS) {
-      // Wait for connection with timeout using select
-      fd_set write_fds, error_fds;
-      FD_ZERO(&write_fds);
-      FD_ZERO(&error_fds);
-      FD_SET(sockfd, &write_fds);
-      FD_SET(sockfd, &error_fds);
-
-      struct timeval select_tv;
-      select_tv.tv_sec = effective_timeout_ms / 1000;
-      select_tv.tv_usec = (effective_timeout_ms % 1000) * 1000;
-
-      int select_result =
-          select(sockfd + 1, nullptr, &write_fds, &error_fds, &select_tv);
+      // Wait for connection with timeout using poll (select cannot take
+      // descriptors at or above FD_SETSIZE)
+      struct pollfd pfd = {sockfd, POLLOUT, 0};
+      int poll_result = poll(&pfd, 1, effective_timeout_ms);
 
-      if (select_result <= 0) {
+      if (poll_result <= 0) {
         close(sockfd);
-        if (select_result == 0) {
+        if (poll_result == 0) {
           return Result<int>::error("connection timeout to " + host + ":" +
                                     std::to_string(port));
         }
-        return Result<int>::error(std::string("select failed: ") +
+        return Result<int>::error(std::string("poll failed: ") +
                                   strerror(errno));
       }
 
@@ -533,6 +534,235 @@ inline Result<void> socket_set_nonblocking(int sockfd) {
   return Result<void>();
 }
 
+// send() flags that keep a write to a closed peer from raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int SOCKET_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SOCKET_SEND_FLAGS = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+/**
+ * Where MSG_NOSIGNAL doesn't exist, stop the socket raising SIGPIPE instead
+ */
+inline void socket_set_nosigpipe(int sockfd) {
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  setsockopt(sockfd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+  (void)sockfd;
+#endif
+}
+
+/**
+ * Fill a sockaddr_un for `path`; false if the path doesn't fit sun_path
+ */
+inline bool unix_socket_address(const std::string &path, sockaddr_un &addr) {
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    return false;
+  }
+  memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+/**
+ * Connect an AF_UNIX socket to the socket bound at `path`
+ *
+ * non_blocking covers connect() too: a server whose accept queue is full
+ * fails it with EAGAIN instead of blocking the caller. On failure errno is
+ * left as connect() set it, so callers can tell a busy server (EAGAIN)
+ * from a missing one (ECONNREFUSED, ENOENT).
+ *
+ * @param path Server socket path
+ * @param type SOCK_STREAM or SOCK_DGRAM
+ * @param opts Buffer sizes and non_blocking apply; TCP-only options are ignored
+ * @return Result containing socket fd on success, error message on failure
+ */
+inline Result<int> unix_socket_connect(const std::string &path, int type = SOCK_STREAM,
+                                       const SocketOptions &opts = {}) {
+  sockaddr_un server_addr;
+  if (!unix_socket_address(path, server_addr)) {
+    errno = ENAMETOOLONG;
+    return Result<int>::error("socket path too long: " + path);
+  }
+
+  int sockfd = socket(AF_UNIX, type, 0);
+  if (sockfd < 0) {
+    return Result<int>::error(
+        std::string("socket creation failed: ") + strerror(errno));
+  }
+  if (opts.non_blocking) {
+    auto nonblocking = socket_set_nonblocking(sockfd);
+    if (!nonblocking) {
+      close(sockfd);
+      return Result<int>::error(nonblocking.error());
+    }
+  }
+
+  if (opts.recv_buffer_size > 0) {
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &opts.recv_buffer_size,
+               sizeof(opts.recv_buffer_size));
+  }
+  if (opts.send_buffer_size > 0) {
+    setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &opts.send_buffer_size,
+               sizeof(opts.send_buffer_size));
+  }
+
+  if (connect(sockfd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+    const int connect_errno = errno;
+    std::string err = "connection failed to " + path + ": " + strerror(connect_errno);
+    close(sockfd);
+    errno = connect_errno;
+    return Result<int>::error(err);
+  }
+  return Result<int>(sockfd);
+}
+
+/**
+ * Bind an AF_UNIX socket at `path` (replacing a stale one) and, for
+ * SOCK_STREAM, listen on it. A bound SOCK_DGRAM socket is also how a
+ * datagram client gets an address to be sent to.
+ */
+inline Result<int> unix_socket_listen(const std::string &path, int type = SOCK_STREAM,
+                                      int backlog = SOMAXCONN) {
+  sockaddr_un addr;
+  if (!unix_socket_address(path, addr)) {
+    return Result<int>::error("socket path too long: " + path);
+  }
+
+  int sockfd = socket(AF_UNIX, type, 0);
+  if (sockfd < 0) {
+    return Result<int>::error(
+        std::string("socket creation failed: ") + strerror(errno));
+  }
+
+  unlink(path.c_str());
+  if (bind(sockfd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      (type == SOCK_STREAM && listen(sockfd, backlog) < 0)) {
+    std::string err = "bind/listen " + path + " failed: " + strerror(errno);
+    close(sockfd);
+    return Result<int>::error(err);
+  }
+  return Result<int>(sockfd);
+}
+
+/**
+ * Wakes a consumer thread sleeping in poll()/epoll_wait() on fd() when a
+ * producer queues work: an eventfd on Linux, a non-blocking pipe elsewhere.
+ * notify() only makes a syscall when the consumer has announced it is about
+ * to sleep, so a producer can call it for every item.
+ *
+ *   Consumer:  wakeup.prepare_wait();
+ *              if (queue.empty()) poll(... wakeup.fd() ..., timeout);
+ *              wakeup.finish_wait();
+ *   Producer:  queue.push(item);
+ *              wakeup.notify();
+ */
+class ThreadWakeup {
+public:
+  ThreadWakeup() {
+#ifdef __linux__
+    read_fd_ = write_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+      for (int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+      }
+      read_fd_ = fds[0];
+      write_fd_ = fds[1];
+    }
+#endif
+  }
+
+  ~ThreadWakeup() {
+    if (write_fd_ >= 0 && write_fd_ != read_fd_) {
+      close(write_fd_);
+    }
+    if (read_fd_ >= 0) {
+      close(read_fd_);
+    }
+  }
+
+  ThreadWakeup(const ThreadWakeup &) = delete;
+  ThreadWakeup &operator=(const ThreadWakeup &) = delete;
+
+  bool ok() const { return read_fd_ >= 0; }
+  int fd() const { return read_fd_; }
+
+  // Consumer, before its last look at the queue. The fence pairs with the
+  // one in notify(): either the consumer sees the item or the producer
+  // sees it sleeping.
+  void prepare_wait() {
+    sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  // Consumer, once awake for whatever reason
+  void finish_wait() {
+    sleeping_.store(false, std::memory_order_relaxed);
+    uint64_t drained[8];
+    while (read(read_fd_, drained, sizeof(drained)) > 0) {
+    }
+  }
+
+  // Producer, after queueing
+  void notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) &&
+        sleeping_.exchange(false, std::memory_order_relaxed)) {
+      signal();
+    }
+  }
+
+  // Wake unconditionally (stop requests)
+  void signal() {
+    uint64_t one = 1;
+    if (write(write_fd_, &one, sizeof(one)) < 0) {
+      // Full pipe or counter: a wakeup is already pending
+    }
+  }
+
+private:
+  int read_fd_ = -1;
+  int write_fd_ = -1;
+  std::atomic<bool> sleeping_{false};
+};
+
+// =============================================================================
+// Memory Utilities
+// =============================================================================
+
+/**
+ * Fault in every page of [addr, addr + len) now instead of on the first
+ * message, optionally pinning the range with mlock() so it stays resident.
+ *
+ * Pages are written (not just read) so copy-on-write zero pages get real
+ * frames. Only call this before other threads touch the range.
+ *
+ * mlock() commonly fails under a low RLIMIT_MEMLOCK; the pages are still
+ * prefaulted in that case and the error says why locking failed.
+ */
+inline Result<void> prefault_memory(void *addr, size_t len, bool lock = false) {
+  if (addr == nullptr || len == 0) {
+    return Result<void>();
+  }
+
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  volatile char *p = static_cast<volatile char *>(addr);
+  for (size_t off = 0; off < len; off += page) {
+    p[off] = p[off];
+  }
+  p[len - 1] = p[len - 1];
+
+  if (lock && mlock(addr, len) != 0) {
+    return Result<void>::error(std::string("mlock failed: ") + strerror(errno));
+  }
+
+  return Result<void>();
+}
+
 // =============================================================================
 // Utility Functions
 // =============================================================================
@@ -570,6 +800,19 @@ inline std::string format_duration_ns(uint64_t ns) {
   }
 }
 
+/**
+ * FNV-1a hash; pass the previous result as `hash` to chain across ranges
+ */
+inline uint64_t fnv1a_hash(const void *data, size_t len,
+                           uint64_t hash = 0xcbf29ce484222325ULL) {
+  const auto *p = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
 /**
  * Trim null bytes from end of char array to create string
  */
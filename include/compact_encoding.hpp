@@ -0,0 +1,305 @@
+#ifndef COMPACT_ENCODING_HPP
+#define COMPACT_ENCODING_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "binary_protocol.hpp"
+
+// =============================================================================
+// Compact tick encoding
+//
+// A COMPACT_TICKS message carries a batch of ticks with consecutive sequences
+// (header sequence = first tick's):
+//
+//   [1-byte flags][varint count] count x record
+//
+//   record: varint  (slot << 1) | literal_price
+//           4 bytes symbol            (only when slot == symbols defined so far)
+//           zigzag  timestamp - previous tick's timestamp
+//           zigzag  price ticks - symbol's last price ticks  | 4-byte float
+//           zigzag  volume
+//
+// Prices are counted in COMPACT_PRICE_TICK units. A price that doesn't
+// round-trip through ticks exactly goes as a literal float, so decoding is
+// always bit-exact. Symbols are defined in-line the first time they appear.
+//
+// Everything is relative to the previous message, so a receiver that misses
+// one can't decode the next. A keyframe (flag bit 0) resets the state:
+// timestamps start from 0, prices from 0 ticks, the symbol table empties. It
+// needs nothing earlier, and a receiver resyncs on it.
+// =============================================================================
+
+constexpr double COMPACT_PRICE_TICK = 0.01;
+constexpr uint8_t COMPACT_FLAG_KEYFRAME = 0x01;
+constexpr size_t MAX_VARINT_SIZE = 10;
+
+inline uint64_t zigzag_encode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// LEB128: 7 bits per byte, low group first, high bit set on all but the last
+inline size_t encode_varint(uint64_t value, char* out) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = static_cast<char>(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = static_cast<char>(value);
+  return n;
+}
+
+inline void append_varint(std::string& out, uint64_t value) {
+  char buffer[MAX_VARINT_SIZE];
+  out.append(buffer, encode_varint(value, buffer));
+}
+
+// Byte-at-a-time decode: the reference, and the path for short tails and
+// values over 56 bits. Returns bytes consumed, 0 if truncated or overlong.
+inline size_t decode_varint_slow(const char* data, size_t size, uint64_t& value) {
+  uint64_t result = 0;
+  for (size_t i = 0; i < size && i < MAX_VARINT_SIZE; ++i) {
+    uint8_t byte = static_cast<uint8_t>(data[i]);
+    result |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      value = result;
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Decode one varint. With 8 readable bytes, values up to 56 bits decode
+ * without a per-byte branch: the terminating byte is the lowest clear high
+ * bit in a 64-bit load, and three mask-and-shift steps squeeze out the
+ * continuation bits.
+ */
+inline size_t decode_varint(const char* data, size_t size, uint64_t& value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (__builtin_expect(size >= 8, 1)) {
+    uint64_t word;
+    memcpy(&word, data, 8);
+    uint64_t stops = ~word & 0x8080808080808080ULL;
+    if (__builtin_expect(stops != 0, 1)) {
+      uint64_t last_bit = stops & (0 - stops);
+      uint64_t x = word & ((last_bit << 1) - 1) & 0x7f7f7f7f7f7f7f7fULL;
+      x = ((x & 0x7f007f007f007f00ULL) >> 1) | (x & 0x007f007f007f007fULL);
+      x = ((x & 0x3fff00003fff0000ULL) >> 2) | (x & 0x00003fff00003fffULL);
+      x = ((x & 0x0fffffff00000000ULL) >> 4) | (x & 0x000000000fffffffULL);
+      value = x;
+      return (__builtin_ctzll(stops) >> 3) + 1;
+    }
+  }
+#endif
+  return decode_varint_slow(data, size, value);
+}
+
+// Price in COMPACT_PRICE_TICK units. The encoder checks the round trip and
+// sends a literal when it isn't exact.
+inline int64_t price_to_ticks(float price) {
+  return std::llround(static_cast<double>(price) / COMPACT_PRICE_TICK);
+}
+
+inline float ticks_to_price(int64_t ticks) {
+  return static_cast<float>(static_cast<double>(ticks) * COMPACT_PRICE_TICK);
+}
+
+class CompactTickEncoder {
+public:
+  // A keyframe goes out once keyframe_interval ticks have been sent since
+  // the last one (and always first)
+  explicit CompactTickEncoder(uint64_t keyframe_interval = 1024)
+      : keyframe_interval_(keyframe_interval) {}
+
+  // Append ticks [first_sequence, first_sequence + count) to `out` as one
+  // COMPACT_TICKS message
+  void encode(std::string& out, uint64_t first_sequence, const TickPayload* ticks, size_t count) {
+    bool keyframe = force_keyframe_ || ticks_since_keyframe_ >= keyframe_interval_;
+    if (keyframe) {
+      reset();
+      keyframes_++;
+    }
+
+    size_t header_pos = out.size();
+    serialize_header(out, MessageType::COMPACT_TICKS, first_sequence, 0);
+    out.push_back(static_cast<char>(keyframe ? COMPACT_FLAG_KEYFRAME : 0));
+    append_varint(out, count);
+
+    for (size_t i = 0; i < count; ++i) {
+      const TickPayload& tick = ticks[i];
+      uint32_t key = symbol_key(tick.symbol);
+      auto [it, added] = slots_.try_emplace(key, static_cast<uint32_t>(last_ticks_.size()));
+      uint32_t slot = it->second;
+      if (added) {
+        last_ticks_.push_back(0);
+      }
+
+      int64_t price_ticks = price_to_ticks(tick.price);
+      float exact = ticks_to_price(price_ticks);
+      bool literal = memcmp(&exact, &tick.price, 4) != 0;
+
+      append_varint(out, (static_cast<uint64_t>(slot) << 1) | (literal ? 1 : 0));
+      if (added) {
+        out.append(tick.symbol, 4);
+      }
+      append_varint(out, zigzag_encode(static_cast<int64_t>(tick.timestamp - last_timestamp_)));
+      if (literal) {
+        uint32_t bits;
+        memcpy(&bits, &tick.price, 4);
+        uint32_t bits_net = htonl(bits);
+        out.append(reinterpret_cast<const char*>(&bits_net), 4);
+      } else {
+        append_varint(out, zigzag_encode(price_ticks - last_ticks_[slot]));
+      }
+      append_varint(out, zigzag_encode(tick.volume));
+
+      last_timestamp_ = tick.timestamp;
+      last_ticks_[slot] = price_ticks;
+    }
+
+    uint32_t length_net = htonl(static_cast<uint32_t>(out.size() - header_pos - MessageHeader::HEADER_SIZE));
+    memcpy(out.data() + header_pos, &length_net, 4);
+    ticks_since_keyframe_ += count;
+    ticks_encoded_ += count;
+  }
+
+  std::string encode(uint64_t first_sequence, const TickPayload* ticks, size_t count) {
+    std::string out;
+    encode(out, first_sequence, ticks, count);
+    return out;
+  }
+
+  // Next message is a keyframe (e.g. a new subscriber joined)
+  void force_keyframe() { force_keyframe_ = true; }
+
+  uint64_t keyframes() const { return keyframes_; }
+  uint64_t ticks_encoded() const { return ticks_encoded_; }
+
+private:
+  void reset() {
+    slots_.clear();
+    last_ticks_.clear();
+    last_timestamp_ = 0;
+    ticks_since_keyframe_ = 0;
+    force_keyframe_ = false;
+  }
+
+  uint64_t keyframe_interval_;
+  std::unordered_map<uint32_t, uint32_t> slots_;
+  std::vector<int64_t> last_ticks_;
+  uint64_t last_timestamp_ = 0;
+  uint64_t ticks_since_keyframe_ = 0;
+  bool force_keyframe_ = true;
+  uint64_t keyframes_ = 0;
+  uint64_t ticks_encoded_ = 0;
+};
+
+class CompactTickDecoder {
+public:
+  enum class Status {
+    DECODED,
+    SKIPPED,    // Delta message without the state it builds on: wait for a keyframe
+    MALFORMED   // Truncated or inconsistent; ticks before the fault were delivered
+  };
+
+  // Calls handler(sequence, const TickPayload&) for each tick in the payload
+  template <typename Handler>
+  Status decode(const MessageHeader& header, const char* payload, Handler&& handler) {
+    const char* end = payload + header.length;
+    if (header.length < 2) {
+      return fail();
+    }
+    bool keyframe = (static_cast<uint8_t>(payload[0]) & COMPACT_FLAG_KEYFRAME) != 0;
+    if (keyframe) {
+      symbols_.clear();
+      last_ticks_.clear();
+      last_timestamp_ = 0;
+      synced_ = true;
+    } else if (!synced_ || header.sequence != next_sequence_) {
+      synced_ = false;
+      skipped_++;
+      return Status::SKIPPED;
+    }
+
+    const char* p = payload + 1;
+    uint64_t count;
+    size_t n = decode_varint(p, end - p, count);
+    if (n == 0) return fail();
+    p += n;
+
+    TickPayload tick;
+    for (uint64_t i = 0; i < count; ++i) {
+      uint64_t tag, field;
+      if ((n = decode_varint(p, end - p, tag)) == 0) return fail();
+      p += n;
+
+      uint64_t slot = tag >> 1;
+      if (slot == symbols_.size()) {
+        if (end - p < 4) return fail();
+        symbols_.push_back(symbol_key(p));
+        last_ticks_.push_back(0);
+        p += 4;
+      } else if (slot > symbols_.size()) {
+        return fail();
+      }
+      memcpy(tick.symbol, &symbols_[slot], 4);
+
+      if ((n = decode_varint(p, end - p, field)) == 0) return fail();
+      p += n;
+      last_timestamp_ += static_cast<uint64_t>(zigzag_decode(field));
+      tick.timestamp = last_timestamp_;
+
+      if (tag & 1) {
+        if (end - p < 4) return fail();
+        uint32_t bits_net;
+        memcpy(&bits_net, p, 4);
+        uint32_t bits = ntohl(bits_net);
+        memcpy(&tick.price, &bits, 4);
+        last_ticks_[slot] = price_to_ticks(tick.price);
+        p += 4;
+      } else {
+        if ((n = decode_varint(p, end - p, field)) == 0) return fail();
+        p += n;
+        last_ticks_[slot] += zigzag_decode(field);
+        tick.price = ticks_to_price(last_ticks_[slot]);
+      }
+
+      if ((n = decode_varint(p, end - p, field)) == 0) return fail();
+      p += n;
+      tick.volume = static_cast<int32_t>(zigzag_decode(field));
+
+      handler(header.sequence + i, tick);
+    }
+    if (p != end) return fail();
+
+    next_sequence_ = header.sequence + count;
+    return Status::DECODED;
+  }
+
+  bool synced() const { return synced_; }
+  uint64_t skipped_messages() const { return skipped_; }
+
+private:
+  Status fail() {
+    synced_ = false;
+    return Status::MALFORMED;
+  }
+
+  std::vector<uint32_t> symbols_;
+  std::vector<int64_t> last_ticks_;
+  uint64_t last_timestamp_ = 0;
+  uint64_t next_sequence_ = 0;
+  bool synced_ = false;
+  uint64_t skipped_ = 0;
+};
+
+#endif // COMPACT_ENCODING_HPP
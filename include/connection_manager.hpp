@@ -11,6 +11,7 @@
 #include <unistd.h>
 
 #include "common.hpp"
+#include "tracepoints.hpp"
 
 class ConnectionManagerV2 {
 public:
@@ -78,6 +79,7 @@ public:
     
     reconnect_attempts_++;
     state_ = State::RECONNECTING;
+    FEED_TRACE(reconnect, reconnect_attempts_, current_backoff_.count() * 1000);
     
     std::cout << "[ConnectionManager] 🔄 Reconnecting... (attempt " << reconnect_attempts_ 
               << ", backoff " << current_backoff_.count() << "s)" << std::endl;
@@ -122,6 +124,15 @@ public:
     }
   }
   
+  // Book state was restored locally (checkpoint): skip the snapshot and
+  // go straight to incrementals replayed from the restored sequence
+  void transition_to_resume() {
+    if (state_ == State::CONNECTED) {
+      state_ = State::INCREMENTAL;
+      std::cout << "[ConnectionManager] ✅ State: CONNECTED → INCREMENTAL (resume)" << std::endl;
+    }
+  }
+
   void transition_to_incremental() {
     if (state_ == State::SNAPSHOT_REPLAY) {
       state_ = State::INCREMENTAL;
@@ -0,0 +1,584 @@
+#ifndef DISTRIBUTION_HPP
+#define DISTRIBUTION_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "frame_fanout.hpp"
+#include "symbol_filter.hpp"
+
+/**
+ * Local Topic-Routed Distribution
+ *
+ * One feed handler serves many local consumers that each want a different
+ * set of symbols, so they don't each need their own upstream connection
+ * and parser. Subscribers connect to an AF_UNIX stream socket and send a
+ * request line, and may send another at any time:
+ *
+ *   SUBSCRIBE AAPL,MSFT,TSLA\n     Replace the interest set
+ *   SUBSCRIBE *\n                  Everything
+ *
+ * They receive binary protocol frames (TICK and ORDER_BOOK_UPDATE, the
+ * exchange feed's layout) for their symbols only. Symbols are at most 4
+ * characters, the width of the feed's symbol field: a request naming a
+ * longer one is refused with a SUBSCRIBE_REJECT frame (payload: the
+ * reason) and the previous interest set stays. The header sequence is
+ * the distributor's event number, shared by all subscribers: each one sees
+ * it increase, with gaps where other symbols went by.
+ *
+ * Fan-out without per-subscriber copies (frame_fanout.hpp): an event is
+ * encoded once into a shared frame log. The symbol is looked up in a topic
+ * table (symbol -> subscribers) and a reference to the frame is appended to
+ * each interested subscriber's ring. Sends gather the referenced bytes
+ * straight from the log.
+ *
+ * Slow subscribers: sends are non-blocking, so a subscriber that stops
+ * reading only grows its own ring. It is disconnected when its ring fills
+ * or when the log is about to overwrite a frame it hasn't been sent yet;
+ * no other subscriber waits on it. It can reconnect and resubscribe.
+ *
+ * Single-threaded: publish_*() and poll() are called from one thread (the
+ * feed handler runs a distribution thread fed by the tick processor).
+ *
+ * Usage (server):
+ *   DistributionServer server("/tmp/feed.dist");
+ *   server.listen();
+ *   server.publish_tick(timestamp, "AAPL", 150.25f, 100);
+ *   server.poll();   // Accept, read requests, send what the sockets take
+ *   server.wait(100, wakeup.fd());   // Idle: sleep until there is work
+ *
+ * Usage (subscriber):
+ *   DistributionClient client("/tmp/feed.dist");
+ *   client.connect();
+ *   client.subscribe({"AAPL", "MSFT"});
+ *   while (client.poll(10, [](const MessageHeader& header, const char* payload) {
+ *     if (header.type == MessageType::TICK) on_tick(TickView(payload));
+ *   })) {}
+ */
+
+// One event handed to the distribution thread
+struct DistributionEvent {
+  MessageType type = MessageType::TICK;  // TICK or ORDER_BOOK_UPDATE
+  uint8_t side = 0;                      // ORDER_BOOK_UPDATE: 0 = bid, 1 = ask
+  char symbol[4] = {0, 0, 0, 0};
+  uint64_t timestamp = 0;                // TICK
+  float price = 0.0f;
+  int64_t quantity = 0;                  // TICK volume or level quantity
+};
+
+// =============================================================================
+// Server Side
+// =============================================================================
+
+class DistributionServer {
+public:
+  static constexpr size_t DEFAULT_LOG_BYTES = 8 * 1024 * 1024;
+  static constexpr size_t DEFAULT_RING_CAPACITY = 64 * 1024;  // Frames per subscriber
+  static constexpr size_t MAX_REQUEST_BYTES = 64 * 1024;      // Unterminated request line
+  // Accepting and reading requests costs a poll() over every subscriber,
+  // so it runs at most this often; sends happen on every call
+  static constexpr uint64_t CONTROL_INTERVAL_NS = 1'000'000;
+
+  explicit DistributionServer(std::string path, size_t log_bytes = DEFAULT_LOG_BYTES,
+                              size_t ring_capacity = DEFAULT_RING_CAPACITY)
+      : path_(std::move(path)), log_(log_bytes), ring_capacity_(ring_capacity) {}
+
+  ~DistributionServer() {
+    for (auto& sub : subscribers_) {
+      close(sub->fd);
+    }
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+      unlink(path_.c_str());
+    }
+  }
+
+  DistributionServer(const DistributionServer&) = delete;
+  DistributionServer& operator=(const DistributionServer&) = delete;
+
+  // Bind the socket path (a stale socket from a dead handler is replaced)
+  Result<void> listen() {
+    auto listening = unix_socket_listen(path_);
+    if (!listening) {
+      return Result<void>::error(listening.error());
+    }
+    listen_fd_ = listening.value();
+    return socket_set_nonblocking(listen_fd_);
+  }
+
+  void publish_tick(uint64_t timestamp, const char symbol[4], float price, int32_t volume) {
+    route(symbol_key(symbol), [&] {
+      return serialize_tick(sequence_ + 1, timestamp, symbol, price, volume);
+    });
+  }
+
+  void publish_book_update(const char symbol[4], uint8_t side, float price, int64_t quantity) {
+    route(symbol_key(symbol), [&] {
+      return serialize_order_book_update(sequence_ + 1, symbol, side, price, quantity);
+    });
+  }
+
+  void publish(const DistributionEvent& event) {
+    if (event.type == MessageType::ORDER_BOOK_UPDATE) {
+      publish_book_update(event.symbol, event.side, event.price, event.quantity);
+    } else {
+      publish_tick(event.timestamp, event.symbol, event.price,
+                   static_cast<int32_t>(event.quantity));
+    }
+  }
+
+  /**
+   * Send as much of every ring as the sockets take without blocking, drop
+   * subscribers that disconnected or were evicted, and (every
+   * CONTROL_INTERVAL_NS) accept new subscribers and apply their requests.
+   * Returns true while any frames are still queued.
+   */
+  bool poll() {
+    uint64_t now = now_ns();
+    if (now - last_control_ns_ >= CONTROL_INTERVAL_NS) {
+      accept_subscribers();
+      read_requests();
+      last_control_ns_ = now;
+    }
+
+    bool pending = false;
+    for (auto& sub : subscribers_) {
+      if (!sub->evicted && !sub->closed) {
+        flush(*sub);
+        pending |= !sub->queue.empty();
+      }
+    }
+
+    remove_dropped();
+    if (routes_dirty_) {
+      rebuild_routes();
+    }
+    return pending;
+  }
+
+  /**
+   * Sleep until poll() has something to do - a subscriber connecting or
+   * sending a request, room on a socket that has frames queued - or
+   * `wake_fd` (the producer's ThreadWakeup) is readable, for at most
+   * timeout_ms. A connect or request wakes the next poll()'s control pass
+   * instead of leaving it to CONTROL_INTERVAL_NS.
+   */
+  void wait(int timeout_ms, int wake_fd = -1) {
+    pollfds_.clear();
+    pollfds_.push_back({wake_fd, POLLIN, 0});  // poll() skips a negative fd
+    pollfds_.push_back({listen_fd_, POLLIN, 0});
+    for (auto& sub : subscribers_) {
+      short events = sub->queue.empty() ? POLLIN : POLLIN | POLLOUT;
+      pollfds_.push_back({sub->fd, events, 0});
+    }
+    if (::poll(pollfds_.data(), pollfds_.size(), timeout_ms) <= 0) {
+      return;
+    }
+    for (size_t i = 1; i < pollfds_.size(); ++i) {
+      if (pollfds_[i].revents & (POLLIN | POLLERR | POLLHUP)) {
+        last_control_ns_ = 0;
+        break;
+      }
+    }
+  }
+
+  size_t subscribers() const { return subscribers_.size(); }
+  uint64_t subscribers_connected() const { return subscribers_connected_; }
+  uint64_t events_published() const { return sequence_; }
+  uint64_t frames_routed() const { return frames_routed_; }
+  uint64_t frames_sent() const { return frames_sent_; }
+  uint64_t bytes_sent() const { return bytes_sent_; }
+  uint64_t slow_evictions() const { return slow_evictions_; }
+  const std::string& path() const { return path_; }
+  // Fixed at construction, so safe from any thread
+  size_t log_bytes() const { return log_.size(); }
+
+private:
+  struct Subscriber {
+    int fd;
+    FrameQueue queue;
+    bool all = false;               // SUBSCRIBE *
+    std::vector<uint32_t> keys;     // symbol_key() of each subscribed symbol
+    std::string requests;           // Partial request line
+    bool evicted = false;           // Too slow; closed on the next poll()
+    bool closed = false;            // Hung up or failed
+
+    Subscriber(int fd, size_t capacity) : fd(fd), queue(capacity) {}
+  };
+
+  // Encode the event once and queue a reference for everyone interested.
+  // Events nobody subscribes to never reach the log.
+  template <typename Encode>
+  void route(uint32_t key, Encode&& encode) {
+    auto it = routes_.find(key);
+    const std::vector<Subscriber*>* topic = it == routes_.end() ? nullptr : &it->second;
+    if (!topic && wildcard_.empty()) {
+      sequence_++;
+      return;
+    }
+
+    std::string frame = encode();
+    sequence_++;
+    const uint64_t pos = log_.append(frame, [this](uint64_t floor) { return evict_lapped(floor); });
+    const uint32_t len = static_cast<uint32_t>(frame.size());
+    if (topic) {
+      for (Subscriber* sub : *topic) enqueue(*sub, pos, len);
+    }
+    for (Subscriber* sub : wildcard_) enqueue(*sub, pos, len);
+  }
+
+  void enqueue(Subscriber& sub, uint64_t pos, uint32_t len) {
+    if (sub.evicted || sub.closed) {
+      return;
+    }
+    if (!sub.queue.push(log_, pos, len)) {
+      evict(sub, "ring full");
+      return;
+    }
+    frames_routed_++;
+  }
+
+  // Evict subscribers still holding frames below `floor`; returns the
+  // oldest frame anyone else holds
+  uint64_t evict_lapped(uint64_t floor) {
+    uint64_t live_floor = UINT64_MAX;
+    for (auto& sub : subscribers_) {
+      if (sub->evicted || sub->closed || sub->queue.empty()) {
+        continue;
+      }
+      if (sub->queue.oldest() < floor) {
+        evict(*sub, "lapped by the frame log");
+      } else {
+        live_floor = std::min(live_floor, sub->queue.oldest());
+      }
+    }
+    return live_floor;
+  }
+
+  void evict(Subscriber& sub, const char* reason) {
+    LOG_WARN("Distribution", "Subscriber fd %d too slow (%s, %lu frames queued), disconnecting",
+             sub.fd, reason, static_cast<unsigned long>(sub.queue.frames()));
+    sub.evicted = true;
+    sub.queue.clear();  // Holds nothing in the log any more
+    slow_evictions_++;
+  }
+
+  void flush(Subscriber& sub) {
+    if (sub.queue.send(sub.fd, log_, frames_sent_, bytes_sent_) == FrameQueue::SendResult::FAILED) {
+      sub.closed = true;
+    }
+  }
+
+  void accept_subscribers() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
+      socket_set_nonblocking(fd);
+      socket_set_nosigpipe(fd);
+
+      auto sub = std::make_unique<Subscriber>(fd, ring_capacity_);
+      subscribers_.push_back(std::move(sub));
+      subscribers_connected_++;
+      LOG_INFO("Distribution", "Subscriber connected on %s (fd %d)", path_.c_str(), fd);
+    }
+  }
+
+  void read_requests() {
+    if (subscribers_.empty()) {
+      return;
+    }
+    pollfds_.resize(subscribers_.size());
+    for (size_t i = 0; i < subscribers_.size(); ++i) {
+      pollfds_[i] = {subscribers_[i]->fd, POLLIN, 0};
+    }
+    if (::poll(pollfds_.data(), pollfds_.size(), 0) <= 0) {
+      return;
+    }
+
+    char buffer[4096];
+    for (size_t i = 0; i < subscribers_.size(); ++i) {
+      if (pollfds_[i].revents == 0) {
+        continue;
+      }
+      Subscriber& sub = *subscribers_[i];
+      ssize_t n = recv(sub.fd, buffer, sizeof(buffer), 0);
+      if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        sub.closed = true;
+        continue;
+      }
+      if (n < 0) {
+        continue;
+      }
+
+      sub.requests.append(buffer, n);
+      size_t newline;
+      while ((newline = sub.requests.find('\n')) != std::string::npos) {
+        apply_request(sub, std::string_view(sub.requests).substr(0, newline));
+        sub.requests.erase(0, newline + 1);
+      }
+      if (sub.requests.size() > MAX_REQUEST_BYTES) {
+        LOG_WARN("Distribution", "Subscriber fd %d sent an oversized request, disconnecting", sub.fd);
+        sub.closed = true;
+      }
+    }
+  }
+
+  void apply_request(Subscriber& sub, std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    constexpr std::string_view COMMAND = "SUBSCRIBE";
+    if (line.substr(0, COMMAND.size()) != COMMAND) {
+      LOG_WARN("Distribution", "Subscriber fd %d: unknown request '%.*s'", sub.fd,
+               static_cast<int>(std::min<size_t>(line.size(), 32)), line.data());
+      return;
+    }
+
+    std::string_view list = line.substr(COMMAND.size());
+    bool all = false;
+    std::vector<uint32_t> keys;
+    while (!list.empty()) {
+      size_t comma = list.find(',');
+      std::string_view symbol = list.substr(0, comma);
+      list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+      while (!symbol.empty() && symbol.front() == ' ') symbol.remove_prefix(1);
+      while (!symbol.empty() && symbol.back() == ' ') symbol.remove_suffix(1);
+      if (symbol == "*") {
+        all = true;
+      } else if (symbol.size() > sizeof(DistributionEvent::symbol)) {
+        // Truncated, it would match a different symbol
+        reject(sub, "symbol longer than 4 characters: " + std::string(symbol.substr(0, 32)));
+        return;
+      } else if (!symbol.empty()) {
+        keys.push_back(padded_symbol_key(symbol));
+      }
+    }
+    sub.all = all;
+    sub.keys = std::move(keys);
+    std::sort(sub.keys.begin(), sub.keys.end());
+    sub.keys.erase(std::unique(sub.keys.begin(), sub.keys.end()), sub.keys.end());
+    routes_dirty_ = true;
+  }
+
+  // Refuse a request; the reply goes through the log like any frame and
+  // doesn't advance the event sequence
+  void reject(Subscriber& sub, const std::string& reason) {
+    LOG_WARN("Distribution", "Subscriber fd %d: request rejected (%s)", sub.fd, reason.c_str());
+    std::string frame = serialize_subscribe_reject(sequence_, reason);
+    const uint64_t pos = log_.append(frame, [this](uint64_t floor) { return evict_lapped(floor); });
+    enqueue(sub, pos, static_cast<uint32_t>(frame.size()));
+  }
+
+  void remove_dropped() {
+    auto dropped = std::remove_if(subscribers_.begin(), subscribers_.end(), [&](const auto& sub) {
+      if (!sub->evicted && !sub->closed) {
+        return false;
+      }
+      if (sub->closed) {
+        LOG_INFO("Distribution", "Subscriber fd %d disconnected", sub->fd);
+      }
+      close(sub->fd);
+      return true;
+    });
+    if (dropped != subscribers_.end()) {
+      subscribers_.erase(dropped, subscribers_.end());
+      routes_dirty_ = true;
+    }
+  }
+
+  void rebuild_routes() {
+    routes_.clear();
+    wildcard_.clear();
+    for (auto& sub : subscribers_) {
+      if (sub->all) {
+        wildcard_.push_back(sub.get());
+      } else {
+        for (uint32_t key : sub->keys) {
+          routes_[key].push_back(sub.get());
+        }
+      }
+    }
+    routes_dirty_ = false;
+  }
+
+  std::string path_;
+  int listen_fd_ = -1;
+
+  FrameLog log_;
+  size_t ring_capacity_;
+
+  std::vector<std::unique_ptr<Subscriber>> subscribers_;
+  std::unordered_map<uint32_t, std::vector<Subscriber*>> routes_;
+  std::vector<Subscriber*> wildcard_;
+  bool routes_dirty_ = false;
+  std::vector<pollfd> pollfds_;
+  uint64_t last_control_ns_ = 0;
+
+  uint64_t sequence_ = 0;
+  uint64_t frames_routed_ = 0;
+  uint64_t frames_sent_ = 0;
+  uint64_t bytes_sent_ = 0;
+  uint64_t slow_evictions_ = 0;
+  uint64_t subscribers_connected_ = 0;
+};
+
+// =============================================================================
+// Subscriber Side
+// =============================================================================
+
+class DistributionClient {
+public:
+  explicit DistributionClient(std::string path) : path_(std::move(path)) {
+    buffer_.resize(64 * 1024);
+  }
+
+  ~DistributionClient() { disconnect(); }
+
+  DistributionClient(const DistributionClient&) = delete;
+  DistributionClient& operator=(const DistributionClient&) = delete;
+
+  Result<void> connect() {
+    auto connected = unix_socket_connect(path_);
+    if (!connected) {
+      return Result<void>::error(connected.error());
+    }
+    int fd = connected.value();
+    socket_set_nosigpipe(fd);
+
+    disconnect();
+    fd_ = fd;
+    buffered_ = 0;
+    return Result<void>();
+  }
+
+  // Replace the interest set; frames for it follow once the server reads it
+  Result<void> subscribe(const std::vector<std::string>& symbols) {
+    std::string request = "SUBSCRIBE ";
+    for (size_t i = 0; i < symbols.size(); ++i) {
+      if (symbols[i].size() > sizeof(DistributionEvent::symbol)) {
+        return Result<void>::error("symbol longer than 4 characters: " + symbols[i]);
+      }
+      if (i > 0) request += ',';
+      request += symbols[i];
+    }
+    return send_request(request + "\n");
+  }
+
+  Result<void> subscribe_all() { return send_request("SUBSCRIBE *\n"); }
+
+  /**
+   * Wait up to timeout_ms for frames and call handler(header, payload) for
+   * each complete one. A SUBSCRIBE_REJECT is kept in rejection() instead.
+   * Returns false once the server is gone (closed the connection, e.g.
+   * after evicting this subscriber) or sent garbage.
+   */
+  template <typename Handler>
+  bool poll(int timeout_ms, Handler&& handler) {
+    if (fd_ < 0) {
+      return false;
+    }
+
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, timeout_ms);
+    if (ready < 0 && errno != EINTR) {
+      disconnect();
+      return false;
+    }
+    if (ready <= 0) {
+      return true;
+    }
+
+    ssize_t n = recv(fd_, buffer_.data() + buffered_, buffer_.size() - buffered_, 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+      disconnect();
+      return false;
+    }
+    if (n < 0) {
+      return true;
+    }
+    buffered_ += n;
+
+    size_t offset = 0;
+    while (buffered_ - offset >= MessageHeader::HEADER_SIZE) {
+      MessageHeader header = deserialize_header(buffer_.data() + offset);
+      if (header.length > MessageHeader::MAX_PAYLOAD_SIZE) {
+        LOG_WARN("Distribution", "Bad frame length %u from %s", header.length, path_.c_str());
+        disconnect();
+        return false;
+      }
+      size_t frame = MessageHeader::HEADER_SIZE + header.length;
+      if (buffered_ - offset < frame) {
+        break;
+      }
+      const char* payload = buffer_.data() + offset + MessageHeader::HEADER_SIZE;
+      if (header.type == MessageType::SUBSCRIBE_REJECT) {
+        rejection_.assign(payload, header.length);
+        LOG_WARN("Distribution", "Request rejected by %s: %s", path_.c_str(), rejection_.c_str());
+      } else {
+        handler(static_cast<const MessageHeader&>(header), payload);
+        messages_received_++;
+      }
+      offset += frame;
+    }
+    if (offset > 0) {
+      memmove(buffer_.data(), buffer_.data() + offset, buffered_ - offset);
+      buffered_ -= offset;
+    }
+    return true;
+  }
+
+  void disconnect() {
+    if (fd_ >= 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  bool connected() const { return fd_ >= 0; }
+  int fd() const { return fd_; }
+  uint64_t messages_received() const { return messages_received_; }
+  // The server's reason for the last refused request (empty if none)
+  const std::string& rejection() const { return rejection_; }
+
+private:
+  Result<void> send_request(const std::string& request) {
+    if (fd_ < 0) {
+      return Result<void>::error("not connected");
+    }
+    size_t sent = 0;
+    while (sent < request.size()) {
+      ssize_t n = send(fd_, request.data() + sent, request.size() - sent,
+                       SOCKET_SEND_FLAGS);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return Result<void>::error(std::string("send failed: ") + strerror(errno));
+      }
+      sent += n;
+    }
+    return Result<void>();
+  }
+
+  std::string path_;
+  int fd_ = -1;
+  std::vector<char> buffer_;
+  size_t buffered_ = 0;
+  uint64_t messages_received_ = 0;
+  std::string rejection_;
+};
+
+#endif // DISTRIBUTION_HPP
@@ -0,0 +1,161 @@
+#ifndef FEED_CAPI_H
+#define FEED_CAPI_H
+
+/**
+ * Embeddable Feed Library - C ABI
+ *
+ * net::FeedHandler and net::BookUpdatingFeedHandler behind a C interface,
+ * built as build/libfeed.so, so a strategy can run inside the handler's
+ * process instead of consuming ticks over IPC:
+ *
+ *   Socket → Reader Thread → SPSC Queue → Processor Thread → your callback
+ *
+ * The batch callback runs directly on the processor thread with ticks that
+ * are still in the queue's storage: no copy, no extra thread, no queue hop.
+ * Book reads are only safe from inside that callback or once the handler
+ * has stopped; the processor thread owns the books while it runs.
+ *
+ * Stability: everything here is plain C. Structs that may grow start with
+ * struct_size, which callers set through feed_config_init(); fields are
+ * only ever appended. Functions are never removed, and FEED_ABI_VERSION
+ * changes only on an incompatible change.
+ *
+ * Usage:
+ *   static void on_ticks(const feed_tick *ticks, size_t count, void *user) { ... }
+ *
+ *   feed_config config;
+ *   feed_config_init(&config);
+ *   config.port = 9000;
+ *   config.protocol = FEED_PROTOCOL_BINARY;
+ *   config.books = 1;
+ *   feed_handler *feed = feed_create(&config);
+ *   feed_set_batch_callback(feed, on_ticks, state);
+ *   feed_start(feed);
+ *   ...
+ *   feed_stop(feed);
+ *   feed_destroy(feed);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(FEED_BUILDING_LIBRARY)
+#define FEED_API __attribute__((visibility("default")))
+#else
+#define FEED_API
+#endif
+
+#define FEED_ABI_VERSION 1
+
+/* Return codes */
+#define FEED_OK 0
+#define FEED_EINVAL (-1)    /* Null handle, bad argument or config */
+#define FEED_ESTATE (-2)    /* Not allowed while running (or stopped) */
+#define FEED_ECONNECT (-3)  /* Could not start: connect or listener failed */
+#define FEED_ENOTFOUND (-4) /* No book for that symbol, or books disabled */
+#define FEED_EINTERNAL (-5) /* Unexpected C++ exception, caught at the boundary */
+
+#define FEED_PROTOCOL_TEXT 0
+#define FEED_PROTOCOL_BINARY 1
+
+typedef struct feed_handler feed_handler;
+
+/* Same layout as net::Tick */
+typedef struct feed_tick {
+  uint64_t timestamp;
+  char symbol[8]; /* NUL-terminated */
+  double price;
+  int64_t volume;
+  uint64_t recv_timestamp_ns; /* When the reader took it off the socket */
+} feed_tick;
+
+/* Same layout as OrderBookLevel; prices are the wire's float */
+typedef struct feed_level {
+  float price;
+  uint32_t reserved;
+  uint64_t quantity;
+} feed_level;
+
+typedef struct feed_config {
+  uint32_t struct_size;
+  const char *host;          /* Default 127.0.0.1 */
+  uint16_t port;             /* Required for tcp */
+  int protocol;              /* FEED_PROTOCOL_TEXT (default) or FEED_PROTOCOL_BINARY */
+  size_t queue_size;         /* Ticks between reader and processor, default 1M */
+  const char *transport;     /* "tcp" (default), "unix", "unixgram" or "shm" */
+  const char *path;          /* Socket path or shm name for non-tcp transports */
+  int books;                 /* Non-zero: keep an order book per symbol */
+  int crc;                   /* Non-zero: binary frames carry a CRC32C trailer */
+  size_t max_batch;          /* Most ticks per callback, default 256 */
+  const char *const *symbols; /* Initial subscription; NULL or 0 count = all */
+  size_t symbol_count;
+} feed_config;
+
+typedef struct feed_metrics {
+  uint32_t struct_size;
+  uint64_t ticks_processed; /* Live */
+  uint64_t queue_depth;     /* Live */
+  int running;              /* Live */
+  /* Final once the handler has stopped */
+  uint64_t messages_parsed;
+  uint64_t parse_errors;
+  uint64_t messages_filtered;
+  /* Receive to callback, from the processor thread: safe inside the
+     callback or once stopped, 0 otherwise */
+  uint64_t latency_p50_ns;
+  uint64_t latency_p99_ns;
+  /* Live: estimated bytes allocated, and holding data, across the tick
+     queue, reader buffers, latency samples, books and forwarding queues */
+  uint64_t memory_reserved_bytes;
+  uint64_t memory_in_use_bytes;
+} feed_metrics;
+
+/* Called on the processor thread; ticks are valid until it returns */
+typedef void (*feed_batch_callback)(const feed_tick *ticks, size_t count, void *user_data);
+
+FEED_API uint32_t feed_abi_version(void);
+
+FEED_API void feed_config_init(feed_config *config);
+
+/* NULL on an invalid config */
+FEED_API feed_handler *feed_create(const feed_config *config);
+
+/* Stops the handler first if it is running. Not from the callback. */
+FEED_API void feed_destroy(feed_handler *feed);
+
+/* Before feed_start() */
+FEED_API int feed_set_batch_callback(feed_handler *feed, feed_batch_callback callback,
+                                     void *user_data);
+
+/* Connects and starts the reader and processor threads */
+FEED_API int feed_start(feed_handler *feed);
+
+/* Blocks until the server ends the stream and every tick is processed */
+FEED_API int feed_wait(feed_handler *feed);
+
+/* Disconnects, then processes what is already queued. Not from the callback. */
+FEED_API int feed_stop(feed_handler *feed);
+
+/* Replace the subscription; count 0 subscribes to everything. Any thread. */
+FEED_API int feed_subscribe(feed_handler *feed, const char *const *symbols, size_t count);
+
+/*
+ * Best levels of one book, best first. *bid_count and *ask_count give the
+ * room in each array and come back as the levels written. Only from the
+ * batch callback or once stopped.
+ */
+FEED_API int feed_read_book(const feed_handler *feed, const char *symbol, feed_level *bids,
+                            size_t *bid_count, feed_level *asks, size_t *ask_count);
+
+/* metrics->struct_size must be set; fields beyond it are left alone */
+FEED_API int feed_get_metrics(const feed_handler *feed, feed_metrics *metrics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FEED_CAPI_H */
@@ -0,0 +1,568 @@
+#ifndef FEED_MERGE_HPP
+#define FEED_MERGE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "compact_encoding.hpp"
+#include "message_views.hpp"
+#include "net/feed.hpp"
+#include "spsc_queue.hpp"
+
+/**
+ * Multi-Feed Merge
+ *
+ * One stream of ticks ordered by exchange timestamp out of N feeds, for
+ * logic that looks across venues. A TournamentTree over the N input heads
+ * picks the earliest; taking it and refilling its input costs log2(N)
+ * comparisons. Ties go to the lower input index, so a merge is
+ * reproducible.
+ *
+ * Live (FeedMerger, MergedFeedHandler): each feed's processor thread
+ * pushes into its own SPSC input queue and one merge thread polls. A tick
+ * can only go out once every open input has shown its next tick - an
+ * input that has gone quiet holds the merge up. The lateness bound caps
+ * that: a head that has waited lateness_ns since it was received goes out
+ * anyway. A tick that then turns up older than one already emitted is
+ * late; it is counted, and passed through or dropped (drop_late).
+ *
+ * Offline (FeedReplay): the same tree over capture files of
+ * binary-protocol frames - the bytes a feed sends, e.g. what
+ * `nc host port > venue.bin` records - read and decoded in place with no
+ * queues, threads or clock, as fast as the disk allows. Inputs end at end
+ * of file, so the merge is exact and nothing waits on a lateness bound.
+ *
+ * Output goes to a BatchCallback in runs of up to max_batch ticks.
+ *
+ * Usage:
+ *   net::MergedFeedHandler merged({venue_a_config, venue_b_config}, merge_config);
+ *   merged.set_batch_callback([](const net::Tick* ticks, size_t count) { ... });
+ *   merged.start();
+ *   merged.wait();
+ *
+ *   net::FeedReplay replay({"venue_a.bin", "venue_b.bin"});
+ *   auto stats = replay.run([](const net::Tick* ticks, size_t count) { ... });
+ */
+
+// Winner tree over `leaves` keys: the leaf with the smallest key (lowest
+// index on ties) in O(1), any key changed in O(log leaves)
+class TournamentTree {
+public:
+  static constexpr uint64_t EMPTY = std::numeric_limits<uint64_t>::max();
+
+  explicit TournamentTree(size_t leaves = 1)
+      : leaves_(std::max<size_t>(leaves, 1)), width_(round_up_pow2(leaves_)),
+        keys_(width_, EMPTY), nodes_(width_, 0) {
+    for (size_t node = width_ - 1; node >= 1; --node) {
+      nodes_[node] = play(child(2 * node), child(2 * node + 1));
+    }
+  }
+
+  size_t leaves() const { return leaves_; }
+  size_t winner() const { return width_ == 1 ? 0 : nodes_[1]; }
+  uint64_t winner_key() const { return keys_[winner()]; }
+  uint64_t key(size_t leaf) const { return keys_[leaf]; }
+
+  // EMPTY takes a leaf out of play
+  void set(size_t leaf, uint64_t key) {
+    keys_[leaf] = key;
+    for (size_t node = (leaf + width_) >> 1; node >= 1; node >>= 1) {
+      nodes_[node] = play(child(2 * node), child(2 * node + 1));
+    }
+  }
+
+private:
+  static size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  size_t child(size_t node) const { return node >= width_ ? node - width_ : nodes_[node]; }
+
+  // Left subtree leaves always have the lower indices
+  size_t play(size_t left, size_t right) const { return keys_[right] < keys_[left] ? right : left; }
+
+  size_t leaves_;
+  size_t width_;
+  std::vector<uint64_t> keys_;
+  std::vector<size_t> nodes_;  // Internal node i's winner; 1 is the root
+};
+
+namespace net {
+
+struct FeedMergeConfig {
+  size_t inputs = 2;
+  size_t queue_capacity = 64 * 1024;  // Per input
+  uint64_t lateness_ns = 1'000'000;   // Longest a head waits for a quiet input
+  size_t max_batch = TickProcessor::DEFAULT_MAX_BATCH;
+  bool drop_late = false;             // Late ticks: drop instead of pass through
+
+  bool is_valid() const { return inputs > 0 && queue_capacity >= 2 && max_batch > 0; }
+};
+
+struct FeedMergeStats {
+  uint64_t merged = 0;         // Ticks emitted
+  uint64_t batches = 0;
+  uint64_t late = 0;           // Older than a tick already emitted
+  uint64_t late_dropped = 0;
+  uint64_t forced = 0;         // Emitted on the lateness bound with an input quiet
+  uint64_t frames_skipped = 0; // Replay: frames that carry no ticks
+  uint64_t truncated = 0;      // Replay: files ending part-way through a frame
+};
+
+/**
+ * Live merge. push() and close() for input i come from one producer
+ * thread (feed i's processor); poll() and everything else from one merge
+ * thread.
+ */
+class FeedMerger {
+public:
+  explicit FeedMerger(const FeedMergeConfig &config)
+      : config_(config), tree_(config.inputs), heads_(config.inputs),
+        state_(config.inputs, WAITING), waiting_(config.inputs) {
+    inputs_.reserve(config.inputs);
+    for (size_t i = 0; i < config.inputs; ++i) {
+      inputs_.push_back(std::make_unique<Input>(config.queue_capacity));
+    }
+    out_.reserve(config.max_batch);
+  }
+
+  size_t inputs() const { return inputs_.size(); }
+
+  // Producer side: false if input's queue is full
+  bool push(size_t input, const Tick &tick) { return inputs_[input]->queue.push(tick); }
+
+  // Producer side: input sends nothing more; once drained it stops
+  // holding the merge up
+  void close(size_t input) { inputs_[input]->closed.store(true, std::memory_order_release); }
+
+  /**
+   * Emit up to one batch: everything due in timestamp order, as long as
+   * each open input has a tick queued or the earliest head has waited
+   * lateness_ns since recv_timestamp_ns. Returns ticks emitted.
+   */
+  template <typename Callback>
+  size_t poll(Callback &&callback, uint64_t now = now_ns()) {
+    if (waiting_ > 0) {
+      for (size_t i = 0; i < inputs_.size(); ++i) {
+        if (state_[i] == WAITING) {
+          refill(i);
+        }
+      }
+    }
+
+    size_t emitted = 0;
+    while (out_.size() < config_.max_batch) {
+      size_t input = tree_.winner();
+      if (tree_.winner_key() == TournamentTree::EMPTY) {
+        break;
+      }
+      const Tick &head = heads_[input];
+      if (waiting_ > 0) {
+        if (now < head.recv_timestamp_ns || now - head.recv_timestamp_ns < config_.lateness_ns) {
+          break;
+        }
+        stats_.forced++;
+      }
+      if (head.timestamp < watermark_) {
+        stats_.late++;
+        if (config_.drop_late) {
+          stats_.late_dropped++;
+        } else {
+          out_.push_back(head);
+          ++emitted;
+        }
+      } else {
+        watermark_ = head.timestamp;
+        out_.push_back(head);
+        ++emitted;
+      }
+      refill(input);
+    }
+    flush(callback);
+    return emitted;
+  }
+
+  // Every input closed and drained
+  bool finished() const { return finished_ == inputs_.size(); }
+
+  // Merge thread only (or once it has stopped)
+  const FeedMergeStats &stats() const { return stats_; }
+  uint64_t watermark() const { return watermark_; }
+
+private:
+  enum State : uint8_t { HEAD, WAITING, FINISHED };
+
+  struct Input {
+    explicit Input(size_t capacity) : queue(capacity) {}
+    SPSCQueue<Tick> queue;
+    std::atomic<bool> closed{false};
+  };
+
+  // Load input's next tick into the tree, or mark it waiting or finished
+  void refill(size_t input) {
+    Input &in = *inputs_[input];
+    auto next = in.queue.pop();
+    if (!next && in.closed.load(std::memory_order_acquire)) {
+      next = in.queue.pop();  // Pushed before the close
+      if (!next) {
+        set_state(input, FINISHED);
+        tree_.set(input, TournamentTree::EMPTY);
+        return;
+      }
+    }
+    if (next) {
+      heads_[input] = *next;
+      set_state(input, HEAD);
+      tree_.set(input, next->timestamp);
+    } else {
+      set_state(input, WAITING);
+      tree_.set(input, TournamentTree::EMPTY);
+    }
+  }
+
+  void set_state(size_t input, State state) {
+    State old = static_cast<State>(state_[input]);
+    if (old == state) {
+      return;
+    }
+    waiting_ += (state == WAITING) - (old == WAITING);
+    finished_ += (state == FINISHED);
+    state_[input] = state;
+  }
+
+  template <typename Callback>
+  void flush(Callback &callback) {
+    if (out_.empty()) {
+      return;
+    }
+    callback(out_.data(), out_.size());
+    stats_.merged += out_.size();
+    stats_.batches++;
+    out_.clear();
+  }
+
+  FeedMergeConfig config_;
+  std::vector<std::unique_ptr<Input>> inputs_;
+  TournamentTree tree_;
+  std::vector<Tick> heads_;
+  std::vector<uint8_t> state_;
+  size_t waiting_;
+  size_t finished_ = 0;
+  uint64_t watermark_ = 0;
+  std::vector<Tick> out_;
+  FeedMergeStats stats_;
+};
+
+/**
+ * N FeedHandlers merged onto one merge thread. Each handler's processor
+ * thread pushes its ticks into its input, waiting while that input is full
+ * (backpressure reaches the feed's own queue). The batch callback runs on
+ * the merge thread.
+ */
+class MergedFeedHandler {
+public:
+  MergedFeedHandler(const std::vector<FeedConfig> &feeds, FeedMergeConfig config = {})
+      : config_(with_inputs(config, feeds.size())), merger_(config_) {
+    for (size_t i = 0; i < feeds.size(); ++i) {
+      auto handler = std::make_unique<FeedHandler>(feeds[i]);
+      handler->set_tick_callback([this, i](const Tick &tick) {
+        while (!merger_.push(i, tick)) {
+          if (abort_.load(std::memory_order_relaxed)) {
+            return;
+          }
+          std::this_thread::yield();
+        }
+      });
+      handlers_.push_back(std::move(handler));
+    }
+  }
+
+  ~MergedFeedHandler() { stop(); }
+
+  // Set before start()
+  void set_batch_callback(BatchCallback callback) { callback_ = std::move(callback); }
+
+  bool start() {
+    if (running_) {
+      return true;
+    }
+    abort_ = false;
+    merge_thread_ = std::thread([this]() { run_merge(); });
+    for (size_t i = 0; i < handlers_.size(); ++i) {
+      if (!handlers_[i]->start()) {
+        LOG_ERROR("Merge", "Feed %zu failed to start", i);
+        stop_started(i);
+        return false;
+      }
+    }
+    running_ = true;
+    return true;
+  }
+
+  // Until every feed has ended and the merge has drained
+  void wait() {
+    for (size_t i = 0; i < handlers_.size(); ++i) {
+      handlers_[i]->wait();
+      merger_.close(i);
+    }
+    if (merge_thread_.joinable()) {
+      merge_thread_.join();
+    }
+    running_ = false;
+  }
+
+  // Stop the feeds; what they already queued is still merged and delivered
+  void stop() {
+    if (!running_) {
+      return;
+    }
+    stop_started(handlers_.size());
+    running_ = false;
+  }
+
+  size_t feed_count() const { return handlers_.size(); }
+  const FeedHandler &feed(size_t i) const { return *handlers_[i]; }
+
+  // Merge thread's; read once stopped or from the batch callback
+  const FeedMergeStats &stats() const { return merger_.stats(); }
+
+private:
+  static FeedMergeConfig with_inputs(FeedMergeConfig config, size_t inputs) {
+    config.inputs = std::max<size_t>(inputs, 1);
+    return config;
+  }
+
+  void run_merge() {
+    auto deliver = [this](const Tick *ticks, size_t count) {
+      if (callback_) {
+        callback_(ticks, count);
+      }
+    };
+    while (!merger_.finished()) {
+      if (merger_.poll(deliver) == 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    }
+  }
+
+  // Stop feeds [0, started) and close every input so the merge drains out
+  void stop_started(size_t started) {
+    for (size_t i = 0; i < started; ++i) {
+      handlers_[i]->stop();
+    }
+    abort_ = true;
+    for (size_t i = 0; i < handlers_.size(); ++i) {
+      merger_.close(i);
+    }
+    if (merge_thread_.joinable()) {
+      merge_thread_.join();
+    }
+  }
+
+  FeedMergeConfig config_;
+  FeedMerger merger_;
+  std::vector<std::unique_ptr<FeedHandler>> handlers_;
+  BatchCallback callback_;
+  std::thread merge_thread_;
+  std::atomic<bool> abort_{false};
+  bool running_ = false;
+};
+
+/**
+ * Offline merge of capture files at full speed. Frames are read in large
+ * blocks and decoded in place; TICK and COMPACT_TICKS frames yield ticks
+ * (recv_timestamp_ns 0), everything else is skipped. A file may end
+ * part-way through a frame (a capture cut off); a corrupt header fails the
+ * replay.
+ */
+class FeedReplay {
+public:
+  static constexpr size_t READ_BYTES = 1 << 20;
+
+  explicit FeedReplay(std::vector<std::string> paths,
+                      size_t max_batch = TickProcessor::DEFAULT_MAX_BATCH, bool drop_late = false)
+      : paths_(std::move(paths)), max_batch_(std::max<size_t>(max_batch, 1)),
+        drop_late_(drop_late) {}
+
+  template <typename Callback>
+  Result<FeedMergeStats> run(Callback &&callback) {
+    FeedMergeStats stats;
+    std::vector<Source> sources(paths_.size());
+    for (size_t i = 0; i < paths_.size(); ++i) {
+      sources[i].fd = open(paths_[i].c_str(), O_RDONLY);
+      if (sources[i].fd < 0) {
+        return Result<FeedMergeStats>::error("cannot open " + paths_[i] + ": " + strerror(errno));
+      }
+      sources[i].buffer.resize(READ_BYTES + MessageHeader::HEADER_SIZE + MessageHeader::MAX_PAYLOAD_SIZE);
+    }
+
+    TournamentTree tree(sources.size());
+    std::string error;
+    for (size_t i = 0; i < sources.size(); ++i) {
+      if (next(sources[i], stats, error)) {
+        tree.set(i, sources[i].head().timestamp);
+      } else if (!error.empty()) {
+        return Result<FeedMergeStats>::error(paths_[i] + ": " + error);
+      }
+    }
+
+    std::vector<Tick> out;
+    out.reserve(max_batch_);
+    uint64_t watermark = 0;
+    while (tree.winner_key() != TournamentTree::EMPTY) {
+      size_t input = tree.winner();
+      Source &source = sources[input];
+      const Tick &head = source.head();
+      if (head.timestamp < watermark) {
+        stats.late++;
+        if (drop_late_) {
+          stats.late_dropped++;
+        } else {
+          out.push_back(head);
+        }
+      } else {
+        watermark = head.timestamp;
+        out.push_back(head);
+      }
+      source.pending_next++;
+      if (next(source, stats, error)) {
+        tree.set(input, source.head().timestamp);
+      } else if (!error.empty()) {
+        return Result<FeedMergeStats>::error(paths_[input] + ": " + error);
+      } else {
+        tree.set(input, TournamentTree::EMPTY);
+      }
+      if (out.size() == max_batch_) {
+        callback(out.data(), out.size());
+        stats.merged += out.size();
+        stats.batches++;
+        out.clear();
+      }
+    }
+    if (!out.empty()) {
+      callback(out.data(), out.size());
+      stats.merged += out.size();
+      stats.batches++;
+    }
+    return stats;
+  }
+
+private:
+  struct Source {
+    int fd = -1;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    uint64_t offset = 0;  // File offset of buffer[0]
+    bool eof = false;
+    CompactTickDecoder compact;
+    std::vector<Tick> pending;  // Decoded from the current frame
+    size_t pending_next = 0;
+
+    Source() = default;
+    Source(Source &&other) noexcept { *this = std::move(other); }
+    Source &operator=(Source &&other) noexcept {
+      std::swap(fd, other.fd);
+      buffer.swap(other.buffer);
+      std::swap(begin, other.begin);
+      std::swap(end, other.end);
+      std::swap(offset, other.offset);
+      std::swap(eof, other.eof);
+      std::swap(compact, other.compact);
+      pending.swap(other.pending);
+      std::swap(pending_next, other.pending_next);
+      return *this;
+    }
+    ~Source() {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+
+    const Tick &head() const { return pending[pending_next]; }
+  };
+
+  // At least `need` bytes buffered, unless the file ends first
+  static bool fill(Source &source, size_t need, std::string &error) {
+    while (source.end - source.begin < need && !source.eof) {
+      if (source.begin > 0) {
+        std::memmove(source.buffer.data(), source.buffer.data() + source.begin,
+                     source.end - source.begin);
+        source.offset += source.begin;
+        source.end -= source.begin;
+        source.begin = 0;
+      }
+      ssize_t n = read(source.fd, source.buffer.data() + source.end,
+                       std::min(READ_BYTES, source.buffer.size() - source.end));
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        error = std::string("read failed: ") + strerror(errno);
+        return false;
+      }
+      source.eof = n == 0;
+      source.end += static_cast<size_t>(n);
+    }
+    return source.end - source.begin >= need;
+  }
+
+  // Make source.head() the next tick; false at end of file or on error
+  static bool next(Source &source, FeedMergeStats &stats, std::string &error) {
+    while (source.pending_next >= source.pending.size()) {
+      source.pending.clear();
+      source.pending_next = 0;
+      if (!fill(source, MessageHeader::HEADER_SIZE, error)) {
+        stats.truncated += source.end > source.begin;
+        return false;
+      }
+      const char *frame = source.buffer.data() + source.begin;
+      MessageHeader header = deserialize_header(frame);
+      if (header.length > MessageHeader::MAX_PAYLOAD_SIZE ||
+          !is_known_message_type(static_cast<uint8_t>(header.type))) {
+        error = "corrupt frame header at offset " + std::to_string(source.offset + source.begin);
+        return false;
+      }
+      size_t frame_bytes = MessageHeader::HEADER_SIZE + header.length;
+      if (!fill(source, frame_bytes, error)) {
+        stats.truncated += error.empty();
+        return false;
+      }
+      const char *payload = source.buffer.data() + source.begin + MessageHeader::HEADER_SIZE;
+      source.begin += frame_bytes;
+      if (header.type == MessageType::TICK && header.length >= TickPayload::PAYLOAD_SIZE) {
+        source.pending.emplace_back(TickView(payload), 0);
+      } else if (header.type == MessageType::COMPACT_TICKS) {
+        source.compact.decode(header, payload, [&](uint64_t, const TickPayload &tick) {
+          source.pending.emplace_back(tick, 0);
+        });
+      } else {
+        stats.frames_skipped++;
+      }
+    }
+    return true;
+  }
+
+  std::vector<std::string> paths_;
+  size_t max_batch_;
+  bool drop_late_;
+};
+
+} // namespace net
+
+#endif // FEED_MERGE_HPP
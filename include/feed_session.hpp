@@ -0,0 +1,1247 @@
+#ifndef FEED_SESSION_HPP
+#define FEED_SESSION_HPP
+
+#if __cplusplus < 202002L
+#error "feed_session.hpp needs C++20 coroutines (build with -std=c++20)"
+#endif
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "message_views.hpp"
+#include "sequence_tracker.hpp"
+#include "symbol_books.hpp"
+#include "tracepoints.hpp"
+
+/**
+ * Coroutine Feed Sessions
+ *
+ * The snapshot feed's connect -> request snapshots -> await snapshots ->
+ * stream incrementals cycle, written as straight-line C++20 coroutines
+ * instead of ConnectionManagerV2's polled state machine. FeedSession::run()
+ * reads top to bottom; every wait in it (connect handshake, bytes, the
+ * heartbeat timeout, reconnect backoff) is a co_await on a SessionReactor,
+ * so no thread blocks and nothing sleeps 1 ms to poll a socket.
+ *
+ * One SessionReactor (one thread, epoll; poll() elsewhere) runs any number
+ * of sessions. A suspended session costs its FeedSession object, its
+ * receive buffer (buffer_bytes, 4 KB by default, grown only for a larger
+ * frame) and two coroutine frames of a few hundred bytes - see
+ * footprint_bytes() and session_detail::frame_bytes. Its books are extra,
+ * as they are for any handler.
+ *
+ * Recovery matches the polling handler: every book is rebuilt from a
+ * snapshot on each connection, updates buffer per book until it arrives,
+ * a sequence gap marks books STALE until a checksum confirms them (or
+ * stale_timeout_ms passes) and a checksum mismatch resyncs one symbol.
+ * A lost connection is retried at once; failed connects back off.
+ *
+ * Time, sockets and readiness come from the reactor's SessionIo: by
+ * default SystemSessionIo (the real clock, BSD sockets, epoll), or a
+ * simulated network and clock (session_sim.hpp) that runs sessions,
+ * exchange and impairments deterministically in virtual time.
+ *
+ * Threading: sessions, their callbacks and the reactor all run on the
+ * thread calling SessionReactor::run(). Only SessionReactor::stop() may be
+ * called from another thread.
+ *
+ * Usage:
+ *   SessionReactor reactor;
+ *   FeedSessionConfig config;
+ *   config.port = 9999;
+ *   config.symbols = {"AAPL", "MSFT"};
+ *   FeedSession session(reactor, config);
+ *   session.set_live_callback([](FeedSession &s) { ... });
+ *   session.start();
+ *   reactor.run();   // Until stop() or no session is left waiting
+ */
+
+template <typename T = void> class SessionTask;
+
+namespace session_detail {
+
+// Bytes held by live session coroutine frames (all reactors)
+inline std::atomic<size_t> frame_bytes{0};
+
+struct FrameAllocation {
+  // Out of line: inlined, GCC pairs ::operator new with this class's
+  // operator delete and warns of a mismatch
+  __attribute__((noinline)) static void *operator new(size_t size) {
+    frame_bytes.fetch_add(size, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+
+  static void operator delete(void *ptr, size_t size) {
+    frame_bytes.fetch_sub(size, std::memory_order_relaxed);
+    ::operator delete(ptr);
+  }
+};
+
+struct PromiseBase : FrameAllocation {
+  std::coroutine_handle<> continuation = std::noop_coroutine();
+
+  // Lazy: nothing runs until the task is awaited or started
+  std::suspend_always initial_suspend() noexcept { return {}; }
+
+  // Finishing resumes the awaiting coroutine directly (symmetric transfer),
+  // so chains of co_await don't grow the stack
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+      return self.promise().continuation;
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  // Session code reports failure through return values; an exception
+  // escaping a coroutine is a bug
+  void unhandled_exception() noexcept { std::terminate(); }
+};
+
+template <typename T> struct Promise : PromiseBase {
+  std::optional<T> value;
+
+  SessionTask<T> get_return_object();
+  void return_value(T result) { value = std::move(result); }
+};
+
+template <> struct Promise<void> : PromiseBase {
+  SessionTask<void> get_return_object();
+  void return_void() {}
+};
+
+// Non-blocking TCP connect; returns the socket (handshake possibly still
+// in progress) or -1 with errno set
+inline int start_connect(const std::string &host, int port) {
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) <= 0) {
+    if (host != "localhost") {
+      errno = EINVAL;
+      return -1;
+    }
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  }
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int flag = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 &&
+      errno != EINPROGRESS) {
+    int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+  }
+  return fd;
+}
+
+} // namespace session_detail
+
+/**
+ * Everything a SessionReactor and its sessions take from the outside world:
+ * the clock, non-blocking sockets and their readiness. Calls mirror the
+ * system calls they stand for, errno included.
+ */
+class SessionIo {
+public:
+  static constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+  struct Event {
+    uint64_t tag;
+    bool in;   // Readable, or closed / failed
+    bool out;  // Writable, or failed
+  };
+
+  virtual ~SessionIo() = default;
+
+  virtual bool ok() const = 0;
+  virtual uint64_t now_ns() = 0;
+
+  // Non-blocking connect: the fd, handshake possibly still in progress, or
+  // -1 with errno set
+  virtual int connect(const std::string &host, int port) = 0;
+  // Handshake already over (either way): no need to wait for writable
+  virtual bool connect_done(int fd) = 0;
+  // Once it is over: 0, or the errno it failed with
+  virtual int connect_error(int fd) = 0;
+  virtual ssize_t recv(int fd, void *buffer, size_t len) = 0;
+  virtual ssize_t send(int fd, const void *data, size_t len) = 0;
+  virtual void close(int fd) = 0;
+
+  // Edge-triggered readiness of fd, both directions, reported with tag
+  virtual bool watch(int fd, uint64_t tag) = 0;
+  virtual void unwatch(int fd) = 0;
+  // What fd's waiter wants now; only level-triggered backends need it
+  virtual void interest(int /*fd*/, bool /*read*/, bool /*write*/) {}
+
+  // Append readiness to events, waiting until there is some, until the
+  // clock reaches deadline_ns, or until wake(). False if nothing can ever
+  // become ready (a simulation with no events left).
+  virtual bool wait(uint64_t deadline_ns, std::vector<Event> &events) = 0;
+  // From any thread: the current or next wait() returns
+  virtual void wake() = 0;
+};
+
+// The real thing: now_ns(), BSD sockets, epoll (poll() elsewhere)
+class SystemSessionIo : public SessionIo {
+public:
+  SystemSessionIo() {
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(0);
+#endif
+    if (pipe(wake_pipe_) == 0) {
+      for (int fd : wake_pipe_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+      }
+#ifdef __linux__
+      epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.u64 = WAKE_TAG;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_pipe_[0], &ev);
+#endif
+    }
+  }
+
+  ~SystemSessionIo() override {
+#ifdef __linux__
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+#endif
+    for (int fd : wake_pipe_) {
+      if (fd >= 0) ::close(fd);
+    }
+  }
+
+  SystemSessionIo(const SystemSessionIo &) = delete;
+  SystemSessionIo &operator=(const SystemSessionIo &) = delete;
+
+  bool ok() const override {
+#ifdef __linux__
+    if (epoll_fd_ < 0) return false;
+#endif
+    return wake_pipe_[0] >= 0;
+  }
+
+  uint64_t now_ns() override { return ::now_ns(); }
+
+  int connect(const std::string &host, int port) override {
+    return session_detail::start_connect(host, port);
+  }
+
+  bool connect_done(int fd) override {
+    pollfd check{fd, POLLOUT, 0};
+    return ::poll(&check, 1, 0) == 1;
+  }
+
+  int connect_error(int fd) override {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+    return error;
+  }
+
+  ssize_t recv(int fd, void *buffer, size_t len) override { return ::recv(fd, buffer, len, 0); }
+  ssize_t send(int fd, const void *data, size_t len) override {
+    return ::send(fd, data, len, SEND_FLAGS);
+  }
+  void close(int fd) override { ::close(fd); }
+
+  bool watch(int fd, uint64_t tag) override {
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.u64 = tag;
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+#else
+    watched_.push_back({fd, tag, 0});
+    return true;
+#endif
+  }
+
+  void unwatch(int fd) override {
+#ifdef __linux__
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    watched_.erase(std::remove_if(watched_.begin(), watched_.end(),
+                                  [fd](const Watched &w) { return w.fd == fd; }),
+                   watched_.end());
+#endif
+  }
+
+#ifndef __linux__
+  void interest(int fd, bool read, bool write) override {
+    for (auto &w : watched_) {
+      if (w.fd == fd) {
+        w.events = static_cast<short>((read ? POLLIN : 0) | (write ? POLLOUT : 0));
+      }
+    }
+  }
+#endif
+
+  bool wait(uint64_t deadline_ns, std::vector<Event> &events) override {
+    int timeout_ms = -1;
+    if (deadline_ns != NO_DEADLINE) {
+      uint64_t now = ::now_ns();
+      timeout_ms = deadline_ns <= now ? 0 : static_cast<int>((deadline_ns - now + 999'999) / 1'000'000);
+    }
+#ifdef __linux__
+    epoll_event ready[256];
+    int n = epoll_wait(epoll_fd_, ready, 256, timeout_ms);
+    for (int i = 0; i < n; ++i) {
+      uint64_t data = ready[i].data.u64;
+      if (data == WAKE_TAG) {
+        drain_wake_pipe();
+        continue;
+      }
+      uint32_t flags = ready[i].events;
+      events.push_back({data, (flags & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) != 0,
+                        (flags & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0});
+    }
+#else
+    // Level-triggered: only fds with a waiter are polled, for what it waits on
+    pollfds_.clear();
+    pollfds_.push_back({wake_pipe_[0], POLLIN, 0});
+    for (const auto &w : watched_) {
+      pollfds_.push_back({w.fd, w.events, 0});
+    }
+    if (::poll(pollfds_.data(), pollfds_.size(), timeout_ms) <= 0) {
+      return true;
+    }
+    if (pollfds_[0].revents != 0) {
+      drain_wake_pipe();
+    }
+    for (size_t i = 1; i < pollfds_.size(); ++i) {
+      short revents = pollfds_[i].revents;
+      if (revents != 0) {
+        events.push_back({watched_[i - 1].tag, (revents & (POLLIN | POLLERR | POLLHUP)) != 0,
+                          (revents & (POLLOUT | POLLERR | POLLHUP)) != 0});
+      }
+    }
+#endif
+    return true;
+  }
+
+  void wake() override {
+    if (wake_pipe_[1] >= 0) {
+      char byte = 1;
+      [[maybe_unused]] ssize_t n = write(wake_pipe_[1], &byte, 1);
+    }
+  }
+
+private:
+  static constexpr uint64_t WAKE_TAG = UINT64_MAX;
+
+#ifdef MSG_NOSIGNAL
+  static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+  static constexpr int SEND_FLAGS = 0;
+#endif
+
+  void drain_wake_pipe() {
+    char bytes[64];
+    while (read(wake_pipe_[0], bytes, sizeof(bytes)) > 0) {
+    }
+  }
+
+  int wake_pipe_[2] = {-1, -1};
+#ifdef __linux__
+  int epoll_fd_ = -1;
+#else
+  struct Watched {
+    int fd;
+    uint64_t tag;
+    short events;  // 0 = nobody waiting
+  };
+  std::vector<Watched> watched_;
+  std::vector<pollfd> pollfds_;
+#endif
+};
+
+/**
+ * A coroutine returning T to whoever co_awaits it. The task owns its frame;
+ * a top-level task (one nobody awaits) is run with start() and finishes
+ * suspended, its frame freed with the task.
+ */
+template <typename T> class [[nodiscard]] SessionTask {
+public:
+  using promise_type = session_detail::Promise<T>;
+
+  explicit SessionTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  SessionTask(SessionTask &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+  SessionTask &operator=(SessionTask &&other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+
+  SessionTask(const SessionTask &) = delete;
+  SessionTask &operator=(const SessionTask &) = delete;
+
+  ~SessionTask() {
+    if (handle_) handle_.destroy();
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+    handle_.promise().continuation = caller;
+    return handle_;
+  }
+
+  T await_resume() {
+    if constexpr (!std::is_void_v<T>) {
+      return std::move(*handle_.promise().value);
+    }
+  }
+
+  // Top-level task: run until its first suspension
+  void start() { handle_.resume(); }
+  bool done() const { return !handle_ || handle_.done(); }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace session_detail {
+
+template <typename T> SessionTask<T> Promise<T>::get_return_object() {
+  return SessionTask<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline SessionTask<void> Promise<void>::get_return_object() {
+  return SessionTask<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+} // namespace session_detail
+
+/**
+ * Readiness loop the sessions suspend on. Each session owns a slot: the fd
+ * it is using (if any), the one coroutine waiting on it and that wait's
+ * deadline.
+ *
+ * epoll is edge-triggered: an fd is registered once per connection, and
+ * readiness arriving while nobody waits is remembered in the slot instead
+ * of being reported again on every pass. Deadlines sit in a min-heap with
+ * at most a few entries per slot: pushing a later deadline (the heartbeat
+ * timeout, moved on by every read) is deferred until the earlier entry
+ * pops, so steady streaming doesn't touch the heap.
+ */
+class SessionReactor {
+public:
+  SessionReactor() : owned_io_(std::make_unique<SystemSessionIo>()), io_(*owned_io_) {}
+
+  // On another clock and network (a simulation); io must outlive the reactor
+  explicit SessionReactor(SessionIo &io) : io_(io) {}
+
+  SessionReactor(const SessionReactor &) = delete;
+  SessionReactor &operator=(const SessionReactor &) = delete;
+
+  bool ok() const { return io_.ok(); }
+
+  SessionIo &io() { return io_; }
+  uint64_t now_ns() { return io_.now_ns(); }
+
+  enum class WaitKind : uint8_t { READ, WRITE, SLEEP };
+
+  // co_await result: true when ready, false when the deadline passed first
+  // (a sleep always ends false)
+  class [[nodiscard]] Wait {
+  public:
+    Wait(SessionReactor &reactor, uint32_t slot, WaitKind kind, uint64_t timeout_ns)
+        : reactor_(reactor), slot_(slot), kind_(kind), timeout_ns_(timeout_ns) {}
+
+    bool await_ready() noexcept {
+      return kind_ == WaitKind::SLEEP ? timeout_ns_ == 0 : reactor_.take_ready(slot_, kind_);
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      reactor_.suspend(slot_, kind_, handle, timeout_ns_);
+    }
+
+    bool await_resume() noexcept { return !std::exchange(reactor_.slots_[slot_].timed_out, false); }
+
+  private:
+    SessionReactor &reactor_;
+    uint32_t slot_;
+    WaitKind kind_;
+    uint64_t timeout_ns_;
+  };
+
+  uint32_t open_slot() {
+    uint32_t id;
+    if (!free_slots_.empty()) {
+      id = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      id = static_cast<uint32_t>(slots_.size());
+      slots_.emplace_back();
+    }
+    slots_[id].open = true;
+    return id;
+  }
+
+  // The owner's coroutine must be destroyed (or finished) by now
+  void close_slot(uint32_t id) {
+    cancel(id);
+    unwatch(id);
+    Slot &slot = slots_[id];
+    slot.open = false;
+    slot.gen++;
+    free_slots_.push_back(id);
+  }
+
+  // Attach a connection's fd to a slot (edge-triggered, both directions)
+  bool watch(uint32_t id, int fd) {
+    Slot &slot = slots_[id];
+    reset_slot(slot);
+    slot.fd = fd;
+    return io_.watch(fd, tag(id, slot.gen));
+  }
+
+  // Detach before closing the fd; events already fetched for it are dropped
+  void unwatch(uint32_t id) {
+    Slot &slot = slots_[id];
+    if (slot.fd < 0) {
+      return;
+    }
+    io_.unwatch(slot.fd);
+    slot.fd = -1;
+    reset_slot(slot);
+  }
+
+  // Forget the slot's waiter without resuming it (its frame is going away)
+  void cancel(uint32_t id) {
+    Slot &slot = slots_[id];
+    if (slot.waiter) {
+      slot.waiter = {};
+      slot.deadline = 0;
+      waiting_--;
+      if (slot.fd >= 0) io_.interest(slot.fd, false, false);
+    }
+  }
+
+  // timeout_ns = 0: wait as long as it takes
+  Wait readable(uint32_t id, uint64_t timeout_ns = 0) { return Wait(*this, id, WaitKind::READ, timeout_ns); }
+  Wait writable(uint32_t id, uint64_t timeout_ns = 0) { return Wait(*this, id, WaitKind::WRITE, timeout_ns); }
+  Wait sleep(uint32_t id, uint64_t duration_ns) { return Wait(*this, id, WaitKind::SLEEP, duration_ns); }
+
+  // Resume sessions as their waits complete, until stop() or until no
+  // session is waiting on anything
+  void run() {
+    while (!stop_requested_.load(std::memory_order_relaxed) && waiting_ > 0) {
+      fire_timers(now_ns());
+      if (stop_requested_.load(std::memory_order_relaxed) || waiting_ == 0) {
+        break;
+      }
+
+      events_.clear();
+      if (!io_.wait(timers_.empty() ? SessionIo::NO_DEADLINE : timers_.front().deadline,
+                    events_)) {
+        break;
+      }
+      for (const auto &event : events_) {
+        dispatch(static_cast<uint32_t>(event.tag), static_cast<uint32_t>(event.tag >> 32),
+                 event.in, event.out);
+      }
+    }
+    stop_requested_.store(false, std::memory_order_relaxed);
+  }
+
+  // From any thread: run() returns once the current pass is done
+  void stop() {
+    stop_requested_.store(true, std::memory_order_relaxed);
+    io_.wake();
+  }
+
+  // Coroutines currently suspended on this reactor
+  size_t waiting() const { return waiting_; }
+
+private:
+  struct Slot {
+    int fd = -1;
+    uint32_t gen = 0;        // Bumped per connection: stale events and timers are ignored
+    bool open = false;
+    bool readable = false;   // Edge seen while nobody was waiting for it
+    bool writable = false;
+    bool timed_out = false;
+    WaitKind kind = WaitKind::READ;
+    std::coroutine_handle<> waiter;
+    uint64_t deadline = 0;            // Current wait's deadline (0 = none)
+    uint64_t queued = UINT64_MAX;     // Earliest of this slot's heap entries
+  };
+
+  struct Timer {
+    uint64_t deadline;
+    uint32_t slot;
+    uint32_t gen;
+
+    bool operator>(const Timer &other) const { return deadline > other.deadline; }
+  };
+
+  static uint64_t tag(uint32_t id, uint32_t gen) {
+    return (static_cast<uint64_t>(gen) << 32) | id;
+  }
+
+  static void reset_slot(Slot &slot) {
+    slot.gen++;
+    slot.readable = false;
+    slot.writable = false;
+    slot.queued = UINT64_MAX;
+  }
+
+  // Readiness remembered from an earlier edge is used up by this wait
+  bool take_ready(uint32_t id, WaitKind kind) {
+    Slot &slot = slots_[id];
+    bool &ready = kind == WaitKind::READ ? slot.readable : slot.writable;
+    return std::exchange(ready, false);
+  }
+
+  void suspend(uint32_t id, WaitKind kind, std::coroutine_handle<> handle, uint64_t timeout_ns) {
+    Slot &slot = slots_[id];
+    slot.waiter = handle;
+    slot.kind = kind;
+    waiting_++;
+    if (slot.fd >= 0 && kind != WaitKind::SLEEP) {
+      io_.interest(slot.fd, kind == WaitKind::READ, kind == WaitKind::WRITE);
+    }
+    if (timeout_ns > 0) {
+      arm(id, now_ns() + timeout_ns);
+    }
+  }
+
+  void arm(uint32_t id, uint64_t deadline) {
+    Slot &slot = slots_[id];
+    slot.deadline = deadline;
+    if (deadline < slot.queued) {
+      timers_.push_back({deadline, id, slot.gen});
+      std::push_heap(timers_.begin(), timers_.end(), std::greater<>());
+      slot.queued = deadline;
+    }
+  }
+
+  void wake(uint32_t id, bool timed_out) {
+    Slot &slot = slots_[id];
+    std::coroutine_handle<> waiter = std::exchange(slot.waiter, {});
+    slot.deadline = 0;
+    slot.timed_out = timed_out;
+    waiting_--;
+    if (slot.fd >= 0) io_.interest(slot.fd, false, false);
+    waiter.resume();  // May open slots: no Slot reference survives this
+  }
+
+  void fire_timers(uint64_t now) {
+    while (!timers_.empty() && timers_.front().deadline <= now) {
+      Timer timer = timers_.front();
+      std::pop_heap(timers_.begin(), timers_.end(), std::greater<>());
+      timers_.pop_back();
+
+      Slot &slot = slots_[timer.slot];
+      if (slot.gen != timer.gen) {
+        continue;
+      }
+      if (timer.deadline == slot.queued) {
+        slot.queued = UINT64_MAX;
+      }
+      if (!slot.waiter || slot.deadline == 0) {
+        continue;
+      }
+      if (slot.deadline > now) {
+        // Moved on since this entry was pushed
+        arm(timer.slot, slot.deadline);
+        continue;
+      }
+      wake(timer.slot, true);
+    }
+  }
+
+  void dispatch(uint32_t id, uint32_t gen, bool in, bool out) {
+    if (id >= slots_.size() || slots_[id].gen != gen) {
+      return;
+    }
+    Slot &slot = slots_[id];
+    slot.readable |= in;
+    slot.writable |= out;
+    if (!slot.waiter || slot.kind == WaitKind::SLEEP) {
+      return;
+    }
+    bool &ready = slot.kind == WaitKind::READ ? slot.readable : slot.writable;
+    if (ready) {
+      ready = false;
+      wake(id, false);
+    }
+  }
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  std::vector<Timer> timers_;  // Min-heap on deadline
+  size_t waiting_ = 0;
+  std::vector<SessionIo::Event> events_;
+  std::atomic<bool> stop_requested_{false};
+  std::unique_ptr<SessionIo> owned_io_;
+  SessionIo &io_;
+};
+
+struct FeedSessionConfig {
+  std::string host = "127.0.0.1";
+  int port = 9999;
+  std::vector<std::string> symbols;         // Books kept; each is snapshotted on every connection
+  size_t buffer_bytes = 4096;               // Receive buffer, grown only for a larger frame
+  uint64_t connect_timeout_ms = 2000;
+  uint64_t heartbeat_timeout_ms = 2000;     // Reconnect after this long without a byte
+  uint64_t stale_timeout_ms = 2000;         // STALE book no checksum confirmed: resync it
+  uint64_t initial_backoff_ms = 100;        // After a failed connect, doubling...
+  uint64_t max_backoff_ms = 30000;          // ...up to this
+  uint32_t max_connect_failures = 0;        // Consecutive failures before giving up (0 = never)
+};
+
+struct FeedSessionStats {
+  uint64_t connects = 0;
+  uint64_t connect_failures = 0;
+  uint64_t disconnects = 0;          // Established connections lost
+  uint64_t heartbeat_timeouts = 0;
+  uint64_t snapshots = 0;
+  uint64_t symbol_resyncs = 0;
+  uint64_t updates_applied = 0;
+  uint64_t updates_buffered = 0;
+  uint64_t updates_replayed = 0;
+  uint64_t ticks = 0;
+  uint64_t heartbeats = 0;
+  uint64_t gaps = 0;
+  uint64_t checksums_verified = 0;
+  uint64_t checksum_mismatches = 0;
+  uint64_t last_recovery_ns = 0;     // Connect started -> every book VALID, latest connection
+};
+
+class FeedSession {
+public:
+  enum class State : uint8_t { IDLE, CONNECTING, BACKOFF, SNAPSHOT, LIVE, STOPPED };
+
+  static const char *state_name(State state) {
+    switch (state) {
+    case State::IDLE:       return "IDLE";
+    case State::CONNECTING: return "CONNECTING";
+    case State::BACKOFF:    return "BACKOFF";
+    case State::SNAPSHOT:   return "SNAPSHOT";
+    case State::LIVE:       return "LIVE";
+    case State::STOPPED:    return "STOPPED";
+    }
+    return "UNKNOWN";
+  }
+
+  // Every book VALID on a new connection; stats().last_recovery_ns says how long it took
+  using LiveCallback = std::function<void(FeedSession &)>;
+  // An update applied to a book (not one buffered during recovery)
+  using UpdateCallback =
+      std::function<void(FeedSession &, const BookUpdateView &, uint64_t sequence)>;
+
+  FeedSession(SessionReactor &reactor, FeedSessionConfig config)
+      : reactor_(reactor), io_(reactor.io()), config_(std::move(config)),
+        slot_(reactor.open_slot()),
+        buffer_(std::max<size_t>(config_.buffer_bytes, MessageHeader::HEADER_SIZE)) {
+    for (const auto &symbol : config_.symbols) {
+      books_.add(symbol.substr(0, 4));
+    }
+  }
+
+  // Not from inside one of this session's own callbacks
+  ~FeedSession() {
+    stop();
+    reactor_.close_slot(slot_);
+  }
+
+  FeedSession(const FeedSession &) = delete;
+  FeedSession &operator=(const FeedSession &) = delete;
+
+  void set_live_callback(LiveCallback callback) { live_callback_ = std::move(callback); }
+  void set_update_callback(UpdateCallback callback) { update_callback_ = std::move(callback); }
+
+  // Starts connecting at once; the rest happens as the reactor runs
+  void start() {
+    if (task_ || stop_requested_) {
+      return;
+    }
+    task_.emplace(run());
+    task_->start();
+  }
+
+  // The coroutine is destroyed now, or - called from one of this session's
+  // callbacks - ends when the callback returns
+  void stop() {
+    stop_requested_ = true;
+    if (in_callback_) {
+      return;
+    }
+    reactor_.cancel(slot_);
+    task_.reset();
+    disconnect();
+    state_ = State::STOPPED;
+  }
+
+  State state() const { return state_; }
+  bool live() const { return state_ == State::LIVE; }
+  bool finished() const { return state_ == State::STOPPED; }
+  const FeedSessionStats &stats() const { return stats_; }
+  const SymbolBooks &books() const { return books_; }
+  const FeedSessionConfig &config() const { return config_; }
+
+  // The session's own memory, books and coroutine frames aside
+  size_t footprint_bytes() const {
+    return sizeof(*this) + buffer_.capacity() + outbox_.capacity() +
+           (bids_.capacity() + asks_.capacity()) * sizeof(OrderBookLevel);
+  }
+
+private:
+  // The whole session
+  SessionTask<void> run() {
+    uint64_t backoff_ms = config_.initial_backoff_ms;
+    uint32_t failures = 0;
+
+    while (!stop_requested_) {
+      state_ = State::CONNECTING;
+      connect_started_ns_ = reactor_.now_ns();
+      if (!co_await connect()) {
+        stats_.connect_failures++;
+        disconnect();
+        if (config_.max_connect_failures && ++failures >= config_.max_connect_failures) {
+          LOG_WARN("Session", "Giving up on %s:%d after %u failed connects",
+                   config_.host.c_str(), config_.port, failures);
+          break;
+        }
+        state_ = State::BACKOFF;
+        FEED_TRACE(reconnect, stats_.connect_failures, backoff_ms);
+        co_await reactor_.sleep(slot_, backoff_ms * 1'000'000);
+        backoff_ms = std::min(backoff_ms * 2, config_.max_backoff_ms);
+        continue;
+      }
+      stats_.connects++;
+      failures = 0;
+      backoff_ms = config_.initial_backoff_ms;
+
+      // A new connection is a new stream: every book is rebuilt from a
+      // snapshot taken on it, its updates buffering until then
+      state_ = State::SNAPSHOT;
+      sequence_tracker_.reset();
+      for (auto &[symbol, entry] : books_.books()) {
+        request_snapshot(symbol, entry);
+      }
+
+      if (co_await receive(true)) {
+        stats_.last_recovery_ns = reactor_.now_ns() - connect_started_ns_;
+        state_ = State::LIVE;
+        LOG_INFO("Session", "%s:%d live in %.2f ms (%zu books)", config_.host.c_str(),
+                 config_.port, stats_.last_recovery_ns / 1e6, books_.size());
+        if (live_callback_) {
+          in_callback_ = true;
+          live_callback_(*this);
+          in_callback_ = false;
+        }
+
+        // Incrementals until the connection ends
+        co_await receive(false);
+      }
+      if (!stop_requested_) {
+        stats_.disconnects++;
+        FEED_TRACE(reconnect, stats_.disconnects, 0);
+      }
+      disconnect();
+    }
+
+    disconnect();
+    state_ = State::STOPPED;
+  }
+
+  SessionTask<bool> connect() {
+    int fd = io_.connect(config_.host, config_.port);
+    if (fd < 0) {
+      co_return false;
+    }
+    fd_ = fd;
+    reactor_.watch(slot_, fd_);
+
+    // Writable once the handshake is over, however it went. Often it
+    // already is (loopback, a near host): then the requests go out now
+    // instead of after every other session's turn in the reactor.
+    if (!io_.connect_done(fd_) &&
+        !co_await reactor_.writable(slot_, config_.connect_timeout_ms * 1'000'000)) {
+      co_return false;
+    }
+    co_return io_.connect_error(fd_) == 0;
+  }
+
+  /**
+   * Read and apply frames until the connection ends (false) or, with
+   * until_live, until no book is waiting for its snapshot (true).
+   */
+  SessionTask<bool> receive(bool until_live) {
+    const uint64_t quiet_ns = config_.heartbeat_timeout_ms * 1'000'000;
+
+    while (!stop_requested_) {
+      if (!process_buffered(until_live)) {
+        co_return false;
+      }
+      if (stop_requested_) {
+        break;
+      }
+      // Includes requests queued by the frames just processed
+      if (!outbox_.empty() && !co_await flush()) {
+        co_return false;
+      }
+      if (until_live && books_.count(BookState::RECOVERING) == 0) {
+        co_return true;
+      }
+
+      ssize_t n = io_.recv(fd_, buffer_.data() + buffered_, buffer_.size() - buffered_);
+      if (n > 0) {
+        FEED_TRACE(recv, fd_, n);
+        buffered_ += n;
+        continue;
+      }
+      if (n == 0) {
+        LOG_INFO("Session", "%s:%d closed the connection", config_.host.c_str(), config_.port);
+        co_return false;
+      }
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        LOG_WARN("Session", "recv from %s:%d failed: %s", config_.host.c_str(), config_.port,
+                 strerror(errno));
+        co_return false;
+      }
+      if (!co_await reactor_.readable(slot_, quiet_ns)) {
+        stats_.heartbeat_timeouts++;
+        LOG_WARN("Session", "Nothing from %s:%d in %lu ms, reconnecting", config_.host.c_str(),
+                 config_.port, config_.heartbeat_timeout_ms);
+        co_return false;
+      }
+    }
+    co_return false;
+  }
+
+  // Queued snapshot requests out; waits only if the socket buffer is full
+  SessionTask<bool> flush() {
+    const uint64_t quiet_ns = config_.heartbeat_timeout_ms * 1'000'000;
+    size_t sent = 0;
+    while (sent < outbox_.size()) {
+      ssize_t n = io_.send(fd_, outbox_.data() + sent, outbox_.size() - sent);
+      if (n > 0) {
+        sent += n;
+      } else if (n < 0 && errno == EINTR) {
+        continue;
+      } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        if (!co_await reactor_.writable(slot_, quiet_ns)) {
+          co_return false;
+        }
+      } else {
+        LOG_WARN("Session", "send to %s:%d failed: %s", config_.host.c_str(), config_.port,
+                 strerror(errno));
+        co_return false;
+      }
+    }
+    outbox_.clear();
+    co_return true;
+  }
+
+  // Whole frames in the buffer; false on a corrupt stream. With until_live
+  // it stops after the snapshot that completes the last book, so the
+  // session goes live before the frames behind it are applied.
+  bool process_buffered(bool until_live) {
+    size_t offset = 0;
+    size_t needed = 0;
+    while (buffered_ - offset >= MessageHeader::HEADER_SIZE && !stop_requested_) {
+      MessageHeader header = deserialize_header(buffer_.data() + offset);
+      if (header.length > MessageHeader::MAX_PAYLOAD_SIZE) {
+        LOG_ERROR("Session", "Corrupt frame length %u from %s:%d, dropping the connection",
+                  header.length, config_.host.c_str(), config_.port);
+        return false;
+      }
+      size_t total = MessageHeader::HEADER_SIZE + header.length;
+      if (buffered_ - offset < total) {
+        needed = total;
+        break;
+      }
+      handle_message(header, buffer_.data() + offset + MessageHeader::HEADER_SIZE);
+      offset += total;
+      if (until_live && std::exchange(snapshot_completed_, false) &&
+          books_.count(BookState::RECOVERING) == 0) {
+        break;
+      }
+    }
+
+    if (offset > 0) {
+      memmove(buffer_.data(), buffer_.data() + offset, buffered_ - offset);
+      buffered_ -= offset;
+    }
+    if (needed > buffer_.size()) {
+      buffer_.resize(needed);
+    }
+    return true;
+  }
+
+  void handle_message(const MessageHeader &header, const char *payload) {
+    track_sequence(header.sequence);
+
+    switch (header.type) {
+    case MessageType::TICK:
+      stats_.ticks++;
+      break;
+    case MessageType::HEARTBEAT:
+      stats_.heartbeats++;
+      check_stale_books();
+      break;
+    case MessageType::SNAPSHOT_RESPONSE:
+      on_snapshot_response(header, payload);
+      break;
+    case MessageType::SNAPSHOT_BEGIN:
+      on_snapshot_begin(header, payload);
+      break;
+    case MessageType::SNAPSHOT_CHUNK:
+      on_snapshot_chunk(header, payload);
+      break;
+    case MessageType::SNAPSHOT_END:
+      on_snapshot_end(payload);
+      break;
+    case MessageType::ORDER_BOOK_UPDATE:
+      on_update(header, payload);
+      break;
+    case MessageType::BOOK_CHECKSUM:
+      on_checksum(payload);
+      break;
+    default:
+      LOG_ERROR("Session", "Unknown message type: %d", static_cast<int>(header.type));
+    }
+  }
+
+  void track_sequence(uint64_t sequence) {
+    if (!sequence_tracker_.process_sequence(sequence)) {
+      stats_.gaps++;
+      size_t marked = books_.mark_all_stale(reactor_.now_ns());
+      if (marked > 0) {
+        LOG_WARN("Session", "Sequence gap at seq=%lu: %zu books marked STALE", sequence, marked);
+      }
+    }
+  }
+
+  void on_snapshot_response(const MessageHeader &header, const char *payload) {
+    char symbol[4];
+    deserialize_snapshot_response(payload, header.length, symbol, bids_, asks_);
+    SymbolBook *entry = books_.find(trim_symbol(symbol, 4));
+    if (!entry) {
+      return;
+    }
+    books_.begin_snapshot(*entry, header.sequence, reactor_.now_ns());
+    for (const auto &level : bids_) books_.add_snapshot_level(*entry, 0, level.price, level.quantity);
+    for (const auto &level : asks_) books_.add_snapshot_level(*entry, 1, level.price, level.quantity);
+    complete_snapshot(trim_symbol(symbol, 4), *entry);
+  }
+
+  void on_snapshot_begin(const MessageHeader &header, const char *payload) {
+    SnapshotBeginPayload begin = deserialize_snapshot_begin(payload);
+    SymbolBook *entry = books_.find(trim_symbol(begin.symbol, 4));
+    if (!entry) {
+      return;
+    }
+    books_.begin_snapshot(*entry, header.sequence, reactor_.now_ns());
+    entry->snapshot.id = begin.snapshot_id;
+  }
+
+  void on_snapshot_chunk(const MessageHeader &header, const char *payload) {
+    SnapshotChunkPayload chunk;
+    bool valid = decode_snapshot_chunk(payload, header.length, chunk);
+    if (header.length < SnapshotChunkPayload::HEADER_SIZE) {
+      return;  // Whoever it belonged to retries at SNAPSHOT_END
+    }
+    std::string symbol = trim_symbol(chunk.symbol, 4);
+    SymbolBook *entry = books_.find(symbol);
+    if (!entry || !entry->snapshot.active) {
+      return;
+    }
+    if (!valid) {
+      retry_snapshot(symbol, *entry, "malformed chunk");
+      return;
+    }
+    if (chunk.snapshot_id != entry->snapshot.id ||
+        chunk.chunk_index != entry->snapshot.next_chunk) {
+      retry_snapshot(symbol, *entry, "chunk missing or out of order");
+      return;
+    }
+    for (uint16_t i = 0; i < chunk.num_levels; ++i) {
+      OrderBookLevel level = deserialize_snapshot_level(payload, i);
+      books_.add_snapshot_level(*entry, chunk.side, level.price, level.quantity);
+    }
+    entry->snapshot.next_chunk++;
+  }
+
+  void on_snapshot_end(const char *payload) {
+    SnapshotEndPayload end = deserialize_snapshot_end(payload);
+    std::string symbol = trim_symbol(end.symbol, 4);
+    SymbolBook *entry = books_.find(symbol);
+    if (!entry || !entry->snapshot.active) {
+      return;
+    }
+    if (end.snapshot_id != entry->snapshot.id || end.num_chunks != entry->snapshot.next_chunk) {
+      retry_snapshot(symbol, *entry, "chunk missing");
+      return;
+    }
+    if (entry->book.checksum() != end.checksum) {
+      retry_snapshot(symbol, *entry, "checksum mismatch");
+      return;
+    }
+    complete_snapshot(symbol, *entry);
+  }
+
+  void complete_snapshot(const std::string &symbol, SymbolBook &entry) {
+    size_t replayed = 0;
+    if (!books_.finish_snapshot(entry, &replayed)) {
+      LOG_WARN("Session", "Snapshot for %s predates dropped buffered updates, requesting again",
+               symbol.c_str());
+      request_snapshot(symbol, entry);
+      return;
+    }
+    stats_.snapshots++;
+    stats_.updates_replayed += replayed;
+    snapshot_completed_ = true;
+  }
+
+  void retry_snapshot(const std::string &symbol, SymbolBook &entry, const char *reason) {
+    LOG_WARN("Session", "Discarding %s snapshot (%s), requesting again", symbol.c_str(), reason);
+    books_.abort_snapshot(entry);
+    request_snapshot(symbol, entry);
+  }
+
+  void on_update(const MessageHeader &header, const char *payload) {
+    BookUpdateView update(payload);
+    auto result = books_.apply_update(header.sequence, update);
+    if (result == SymbolBooks::UpdateResult::BUFFERED) {
+      stats_.updates_buffered++;
+      return;
+    }
+    if (result != SymbolBooks::UpdateResult::APPLIED) {
+      return;
+    }
+    stats_.updates_applied++;
+    if (update_callback_) {
+      in_callback_ = true;
+      update_callback_(*this, update, header.sequence);
+      in_callback_ = false;
+    }
+  }
+
+  // A match confirms a STALE book, a mismatch resyncs that symbol
+  void on_checksum(const char *payload) {
+    BookChecksumPayload msg = deserialize_book_checksum(payload);
+    std::string symbol = trim_symbol(msg.symbol, 4);
+    SymbolBook *entry = books_.find(symbol);
+    if (!entry || entry->state == BookState::RECOVERING) {
+      return;
+    }
+    if (books_.verify_checksum(*entry, msg.checksum)) {
+      stats_.checksums_verified++;
+      return;
+    }
+    stats_.checksum_mismatches++;
+    resync_symbol(symbol, *entry, "checksum mismatch");
+  }
+
+  void check_stale_books() {
+    if (state_ != State::LIVE) {
+      return;
+    }
+    for (const auto &symbol :
+         books_.stale_longer_than(reactor_.now_ns(), config_.stale_timeout_ms * 1'000'000)) {
+      resync_symbol(symbol, *books_.find(symbol), "stale, no checksum to confirm it");
+    }
+  }
+
+  void resync_symbol(const std::string &symbol, SymbolBook &entry, const char *reason) {
+    LOG_INFO("Session", "Requesting %s snapshot to resync book (%s)", symbol.c_str(), reason);
+    request_snapshot(symbol, entry);
+    stats_.symbol_resyncs++;
+  }
+
+  // Queued; receive() sends it before its next read
+  void request_snapshot(const std::string &symbol, SymbolBook &entry) {
+    std::array<char, 4> wire{};
+    memcpy(wire.data(), symbol.data(), std::min<size_t>(symbol.size(), 4));
+    outbox_ += serialize_snapshot_request(client_sequence_++, wire.data());
+    books_.begin_recovery(entry, reactor_.now_ns());
+  }
+
+  void disconnect() {
+    if (fd_ >= 0) {
+      reactor_.unwatch(slot_);
+      io_.close(fd_);
+      fd_ = -1;
+    }
+    buffered_ = 0;
+    outbox_.clear();
+  }
+
+  SessionReactor &reactor_;
+  SessionIo &io_;
+  FeedSessionConfig config_;
+  uint32_t slot_;
+  int fd_ = -1;
+  State state_ = State::IDLE;
+  bool stop_requested_ = false;
+  bool in_callback_ = false;
+  bool snapshot_completed_ = false;
+
+  std::vector<char> buffer_;
+  size_t buffered_ = 0;
+  std::string outbox_;
+  std::vector<OrderBookLevel> bids_, asks_;  // Snapshot decode scratch
+
+  SymbolBooks books_;
+  SequenceTracker sequence_tracker_;
+  uint64_t client_sequence_ = 0;
+  uint64_t connect_started_ns_ = 0;
+  FeedSessionStats stats_;
+
+  LiveCallback live_callback_;
+  UpdateCallback update_callback_;
+  std::optional<SessionTask<void>> task_;
+};
+
+#endif // FEED_SESSION_HPP
@@ -0,0 +1,197 @@
+#ifndef FRAME_FANOUT_HPP
+#define FRAME_FANOUT_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+#include "common.hpp"
+
+/**
+ * Shared-Log Fan-Out
+ *
+ * Building blocks for sending one stream of frames to many sockets without
+ * a copy per receiver (DistributionServer, TcpRepublisher):
+ *
+ *   FrameLog    Circular byte log. Each frame is written once and addressed
+ *               by a position that grows forever (log index = pos % size).
+ *   FrameQueue  One receiver's bounded ring of {position, length}
+ *               references, sent with a gathering sendmsg() straight from
+ *               the log. References adjacent in the log share an iovec.
+ *
+ * A reference is valid until the log wraps over it. FrameLog tracks a lower
+ * bound on every queued position; when an append would overwrite it, the
+ * owner's on_lapped(floor) callback must drop every queue whose oldest()
+ * frame is below `floor` and return the new lowest oldest().
+ *
+ * Single-threaded: the log and its queues belong to one thread.
+ */
+
+class FrameLog {
+public:
+  explicit FrameLog(size_t bytes) : log_(std::max<size_t>(bytes, 4096)) {}
+
+  // Copy a frame in and return its position. Frames never straddle the
+  // end of the log; the tail gap is skipped.
+  template <typename OnLapped>
+  uint64_t append(std::string_view frame, OnLapped&& on_lapped) {
+    const size_t size = log_.size();
+    size_t offset = head_ % size;
+    if (offset + frame.size() > size) {
+      head_ += size - offset;
+      offset = 0;
+    }
+    const uint64_t pos = head_;
+    head_ += frame.size();
+
+    // Whatever sat below head_ - size is about to be overwritten
+    if (head_ > size && head_ - size > live_floor_) {
+      live_floor_ = on_lapped(head_ - size);
+    }
+    memcpy(log_.data() + offset, frame.data(), frame.size());
+    return pos;
+  }
+
+  // A queue now references `pos`
+  void hold(uint64_t pos) { live_floor_ = std::min(live_floor_, pos); }
+
+  char* at(uint64_t pos) { return log_.data() + pos % log_.size(); }
+  size_t size() const { return log_.size(); }
+  uint64_t head() const { return head_; }
+
+private:
+  std::vector<char> log_;
+  uint64_t head_ = 0;                 // Position of the next frame
+  uint64_t live_floor_ = UINT64_MAX;  // <= every queued position
+};
+
+class FrameQueue {
+public:
+  static constexpr size_t MAX_IOV = 64;
+
+  enum class SendResult {
+    DRAINED,  // Everything queued was sent
+    BLOCKED,  // The socket buffer is full
+    FAILED    // The peer is gone
+  };
+
+  explicit FrameQueue(size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    ring_.resize(rounded);
+  }
+
+  // False when the ring is full; the caller applies its slow-receiver policy
+  bool push(FrameLog& log, uint64_t pos, uint32_t len) {
+    if (tail_ - head_ == ring_.size()) {
+      return false;
+    }
+    if (head_ == tail_) {
+      log.hold(pos);
+    }
+    ring_[tail_ & (ring_.size() - 1)] = {pos, len};
+    tail_++;
+    bytes_ += len;
+    return true;
+  }
+
+  /**
+   * Send what the socket takes without blocking. Each sendmsg() gathers up
+   * to MAX_IOV runs of adjacent frames; adds the frames and bytes it
+   * completed to the counters.
+   */
+  SendResult send(int fd, FrameLog& log, uint64_t& frames_sent, uint64_t& bytes_sent) {
+    while (head_ != tail_) {
+      iovec iov[MAX_IOV];
+      size_t count = 0;
+      size_t total = 0;
+      for (uint64_t i = head_; i != tail_; ++i) {
+        const FrameRef& ref = ring_[i & (ring_.size() - 1)];
+        char* data = log.at(ref.pos);
+        size_t len = ref.len;
+        if (i == head_) {
+          data += front_sent_;
+          len -= front_sent_;
+        }
+        if (count > 0 && static_cast<char*>(iov[count - 1].iov_base) + iov[count - 1].iov_len == data) {
+          iov[count - 1].iov_len += len;
+        } else if (count < MAX_IOV) {
+          iov[count++] = {data, len};
+        } else {
+          break;
+        }
+        total += len;
+      }
+
+      msghdr msg{};
+      msg.msg_iov = iov;
+      msg.msg_iovlen = count;
+      ssize_t n = sendmsg(fd, &msg, SOCKET_SEND_FLAGS);
+      if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? SendResult::BLOCKED : SendResult::FAILED;
+      }
+      sends_++;
+      bytes_sent += n;
+      frames_sent += consume(static_cast<size_t>(n));
+      if (static_cast<size_t>(n) < total) {
+        return SendResult::BLOCKED;
+      }
+    }
+    return SendResult::DRAINED;
+  }
+
+  void clear() {
+    head_ = tail_;
+    front_sent_ = 0;
+    bytes_ = 0;
+  }
+
+  bool empty() const { return head_ == tail_; }
+  size_t frames() const { return tail_ - head_; }
+  size_t bytes() const { return bytes_ - front_sent_; }  // Not yet sent
+  uint64_t sends() const { return sends_; }              // sendmsg() calls that sent data
+
+  // Position of the oldest queued frame (queue must not be empty)
+  uint64_t oldest() const { return ring_[head_ & (ring_.size() - 1)].pos; }
+
+private:
+  struct FrameRef {
+    uint64_t pos;
+    uint32_t len;
+  };
+
+  // Drop `bytes` worth of sent frames from the front; returns whole frames
+  uint64_t consume(size_t bytes) {
+    uint64_t frames = 0;
+    while (bytes > 0) {
+      const FrameRef& ref = ring_[head_ & (ring_.size() - 1)];
+      size_t remaining = ref.len - front_sent_;
+      if (bytes < remaining) {
+        front_sent_ += static_cast<uint32_t>(bytes);
+        return frames;
+      }
+      bytes -= remaining;
+      bytes_ -= ref.len;
+      front_sent_ = 0;
+      head_++;
+      frames++;
+    }
+    return frames;
+  }
+
+  std::vector<FrameRef> ring_;
+  uint64_t head_ = 0;        // Next frame to send
+  uint64_t tail_ = 0;        // Next free slot
+  uint32_t front_sent_ = 0;  // Bytes of the head frame already sent
+  size_t bytes_ = 0;         // Queued frame bytes, head frame whole
+  uint64_t sends_ = 0;
+};
+
+#endif // FRAME_FANOUT_HPP
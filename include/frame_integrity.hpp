@@ -0,0 +1,300 @@
+#ifndef FRAME_INTEGRITY_HPP
+#define FRAME_INTEGRITY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define FRAME_CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define FRAME_CRC32C_ARM 1
+#endif
+
+#include "binary_protocol.hpp"
+
+// =============================================================================
+// Frame integrity
+//
+// deserialize_header() takes the length field on trust. Two defences, both
+// applied per frame by scan_frames():
+//
+//   - Bounds: a length over MessageHeader::MAX_PAYLOAD_SIZE, or an unknown
+//     type, is corruption. Without the check a flipped length byte stalls the
+//     reader waiting for gigabytes, or walks it into garbage.
+//   - CRC32C trailer (checksummed streams only): every frame ends with a
+//     4-byte CRC32C (network order) of its header and payload. The length
+//     field counts the trailer, so a reader that doesn't check it still
+//     frames the stream correctly.
+//
+// After a bad frame, find_next_frame() scans for the next plausible header.
+// =============================================================================
+
+constexpr size_t CRC_TRAILER_SIZE = 4;
+
+// -----------------------------------------------------------------------------
+// CRC32C (Castagnoli)
+// -----------------------------------------------------------------------------
+
+namespace crc32c_detail {
+
+constexpr uint32_t POLY = 0x82F63B78;  // Reflected
+
+struct Tables {
+  uint32_t t[8][256];
+};
+
+// Slicing-by-8 tables, built on first use
+inline const Tables& tables() {
+  static const Tables tables = [] {
+    Tables tb{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c >> 1) ^ (POLY & (0 - (c & 1)));
+      }
+      tb.t[0][i] = c;
+    }
+    for (int s = 1; s < 8; ++s) {
+      for (uint32_t i = 0; i < 256; ++i) {
+        tb.t[s][i] = (tb.t[s - 1][i] >> 8) ^ tb.t[0][tb.t[s - 1][i] & 0xff];
+      }
+    }
+    return tb;
+  }();
+  return tables;
+}
+
+} // namespace crc32c_detail
+
+// Portable path. `crc` is a previous result, to continue a running checksum.
+inline uint32_t crc32c_sw(const void* data, size_t len, uint32_t crc = 0) {
+  const auto& t = crc32c_detail::tables().t;
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, p, 8);
+    word ^= crc;
+    crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^
+          t[4][(word >> 24) & 0xff] ^ t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^
+          t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+    p += 8;
+    len -= 8;
+  }
+#endif
+  while (len--) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+  }
+  return ~crc;
+}
+
+#if FRAME_CRC32C_X86
+
+// SSE4.2 crc32 instruction, 8 bytes per step. Compiled for SSE4.2 regardless
+// of -m flags; only called once crc32c_hardware() says the CPU has it.
+__attribute__((target("sse4.2")))
+inline uint32_t crc32c_hw(const void* data, size_t len, uint32_t crc = 0) {
+  const char* p = static_cast<const char*>(data);
+  uint64_t c = static_cast<uint32_t>(~crc);
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, p, 8);
+    c = _mm_crc32_u64(c, word);
+    p += 8;
+    len -= 8;
+  }
+  uint32_t c32 = static_cast<uint32_t>(c);
+  while (len--) {
+    c32 = _mm_crc32_u8(c32, static_cast<uint8_t>(*p++));
+  }
+  return ~c32;
+}
+
+#elif FRAME_CRC32C_ARM
+
+inline uint32_t crc32c_hw(const void* data, size_t len, uint32_t crc = 0) {
+  const char* p = static_cast<const char*>(data);
+  uint32_t c = ~crc;
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, p, 8);
+    c = __crc32cd(c, word);
+    p += 8;
+    len -= 8;
+  }
+  while (len--) {
+    c = __crc32cb(c, static_cast<uint8_t>(*p++));
+  }
+  return ~c;
+}
+
+#else
+
+inline uint32_t crc32c_hw(const void* data, size_t len, uint32_t crc = 0) {
+  return crc32c_sw(data, len, crc);
+}
+
+#endif
+
+// True when crc32c_hw() runs on CRC hardware rather than the table fallback
+inline bool crc32c_hardware() {
+#if FRAME_CRC32C_X86
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+#elif FRAME_CRC32C_ARM
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline uint32_t crc32c(const void* data, size_t len, uint32_t crc = 0) {
+  return crc32c_hardware() ? crc32c_hw(data, len, crc) : crc32c_sw(data, len, crc);
+}
+
+// -----------------------------------------------------------------------------
+// Checksummed frames
+// -----------------------------------------------------------------------------
+
+// Add the trailer to the frame at out[frame_start..]: length grows by 4 and
+// the CRC covers the updated header
+inline void append_crc_trailer(std::string& out, size_t frame_start = 0) {
+  uint32_t length_net;
+  memcpy(&length_net, out.data() + frame_start, 4);
+  length_net = htonl(ntohl(length_net) + CRC_TRAILER_SIZE);
+  memcpy(out.data() + frame_start, &length_net, 4);
+
+  uint32_t crc_net = htonl(crc32c(out.data() + frame_start, out.size() - frame_start));
+  out.append(reinterpret_cast<const char*>(&crc_net), 4);
+}
+
+inline std::string with_crc_trailer(std::string frame) {
+  append_crc_trailer(frame);
+  return frame;
+}
+
+// Known type and a length the protocol can produce
+inline bool plausible_header(const MessageHeader& header, bool checksummed) {
+  if (!is_known_message_type(static_cast<uint8_t>(header.type))) {
+    return false;
+  }
+  uint32_t trailer = checksummed ? CRC_TRAILER_SIZE : 0;
+  if (header.length < trailer || header.length - trailer > MessageHeader::MAX_PAYLOAD_SIZE) {
+    return false;
+  }
+  if (header.type == MessageType::TICK) {
+    return header.length - trailer == TickPayload::PAYLOAD_SIZE;
+  }
+  return true;
+}
+
+inline bool frame_crc_matches(const char* frame, size_t frame_size) {
+  uint32_t expected_net;
+  memcpy(&expected_net, frame + frame_size - CRC_TRAILER_SIZE, 4);
+  return crc32c(frame, frame_size - CRC_TRAILER_SIZE) == ntohl(expected_net);
+}
+
+enum class FrameError : uint8_t {
+  NONE,        // Stopped at a partial frame or a full batch
+  BAD_HEADER,  // Unknown type or impossible length
+  BAD_CRC
+};
+
+/**
+ * Validated frames from the front of a receive chunk. headers[i].length is
+ * the payload length, trailer excluded; the payload starts at
+ * offsets[i] + HEADER_SIZE.
+ */
+struct FrameBatch {
+  static constexpr size_t MAX_FRAMES = 64;
+
+  MessageHeader headers[MAX_FRAMES];
+  uint32_t offsets[MAX_FRAMES];
+  size_t count = 0;
+  size_t end = 0;                      // Bytes covered by the valid frames
+  FrameError error = FrameError::NONE; // Why the scan stopped at `end`
+};
+
+/**
+ * Validate up to MAX_FRAMES complete frames from data[0, len) before any is
+ * dispatched; stops at the first bad one. Each CRC is checked as its frame
+ * is walked: the crc32 chain of one short frame overlaps with parsing the
+ * next, which measured faster than a separate interleaved CRC pass.
+ */
+inline void scan_frames(const char* data, size_t len, bool checksummed, FrameBatch& batch) {
+  batch.count = 0;
+  batch.error = FrameError::NONE;
+
+  size_t offset = 0;
+  while (batch.count < FrameBatch::MAX_FRAMES && offset + MessageHeader::HEADER_SIZE <= len) {
+    const char* frame = data + offset;
+    MessageHeader header = deserialize_header(frame);
+    if (!plausible_header(header, checksummed)) {
+      batch.error = FrameError::BAD_HEADER;
+      break;
+    }
+    size_t frame_size = MessageHeader::HEADER_SIZE + header.length;
+    if (offset + frame_size > len) {
+      break;
+    }
+    if (checksummed) {
+      if (!frame_crc_matches(frame, frame_size)) {
+        batch.error = FrameError::BAD_CRC;
+        break;
+      }
+      header.length -= CRC_TRAILER_SIZE;
+    }
+    batch.headers[batch.count] = header;
+    batch.offsets[batch.count] = static_cast<uint32_t>(offset);
+    batch.count++;
+    offset += frame_size;
+  }
+  batch.end = offset;
+}
+
+/**
+ * After a bad frame at data[0]: offset of the next plausible header, at
+ * least 1. A candidate is confirmed by its CRC on a checksummed stream, or
+ * by the header that follows it on a plain one, when those bytes are here;
+ * otherwise it's taken provisionally and the next scan judges it. With no
+ * candidate, everything but a possible header prefix at the end is skipped.
+ *
+ * Lengths are under 64 KiB, so every header starts with two zero bytes:
+ * memchr skips straight to the candidates.
+ */
+inline size_t find_next_frame(const char* data, size_t len, bool checksummed) {
+  size_t pos = 1;
+  while (pos + MessageHeader::HEADER_SIZE <= len) {
+    const void* zero = memchr(data + pos, 0, len - MessageHeader::HEADER_SIZE + 1 - pos);
+    if (zero == nullptr) {
+      break;
+    }
+    pos = static_cast<const char*>(zero) - data;
+
+    MessageHeader header = deserialize_header(data + pos);
+    if (plausible_header(header, checksummed)) {
+      size_t frame_size = MessageHeader::HEADER_SIZE + header.length;
+      size_t available = len - pos;
+      if (frame_size > available) {
+        return pos;
+      }
+      if (checksummed) {
+        if (frame_crc_matches(data + pos, frame_size)) {
+          return pos;
+        }
+      } else if (frame_size + MessageHeader::HEADER_SIZE > available ||
+                 plausible_header(deserialize_header(data + pos + frame_size), false)) {
+        return pos;
+      }
+    }
+    pos++;
+  }
+  return len >= MessageHeader::HEADER_SIZE ? len - MessageHeader::HEADER_SIZE + 1 : 1;
+}
+
+#endif // FRAME_INTEGRITY_HPP
@@ -0,0 +1,588 @@
+#ifndef HEARTBEAT_FLEET_HPP
+#define HEARTBEAT_FLEET_HPP
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/timerfd.h>
+#endif
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "multi_client.hpp"
+#include "timer_wheel.hpp"
+
+/**
+ * Heartbeat Fleet Server
+ *
+ * heartbeat_mock_server's high-connection-count mode: tens of thousands of
+ * client sessions heartbeating at once, to test a handler fleet rather
+ * than one handler. One reactor thread per core, each with its own
+ * SO_REUSEPORT listener (the kernel spreads connections across them), its
+ * own epoll set (poll() elsewhere) and its own TimerWheel holding one
+ * heartbeat timer per session. A reactor sleeps until the earliest
+ * heartbeat is due - on Linux a timerfd armed to the nanosecond - so
+ * sessions cost nothing between heartbeats.
+ *
+ * Per session, from the configuration:
+ *   - a heartbeat (plus ticks_per_heartbeat ticks) every interval_ms, each
+ *     interval moved by up to ±jitter_ms; first heartbeats at a random
+ *     phase so sessions that connect together do not beat together
+ *   - with probability stall_rate per heartbeat, a stall: the session goes
+ *     silent for stall_ms, long enough to trip a client's heartbeat timeout
+ *
+ * Lateness is when a heartbeat was sent minus when it was due, recorded in
+ * a histogram per reactor that stats() reads while running. If its p99
+ * stays small the server is not what a fleet test is measuring. Sends are
+ * non-blocking; bytes a client is not reading wait in its session (counted
+ * in send_blocked) and a client more than MAX_PENDING_BYTES behind is
+ * disconnected.
+ *
+ * Usage:
+ *   HeartbeatFleetConfig config;
+ *   config.port = 9999;
+ *   config.interval_ms = 1000;
+ *   config.jitter_ms = 50;
+ *   HeartbeatFleet fleet(config);
+ *   fleet.start();
+ *   ...
+ *   HeartbeatFleetStats stats = fleet.stats();
+ *   printf("p99 %lu ns\n", stats.lateness_percentile(99));
+ */
+
+struct HeartbeatFleetConfig {
+  uint16_t port = 9999;           // 0 = ephemeral, see HeartbeatFleet::port()
+  size_t reactors = 0;            // 0 = one per core
+  int interval_ms = 1000;
+  int jitter_ms = 0;              // Each interval moves by up to ± this
+  int ticks_per_heartbeat = 0;    // Ticks sent right after each heartbeat
+  double stall_rate = 0.0;        // Chance per heartbeat that a session stalls
+  int stall_ms = 0;               // Length of a stall
+  bool pin = false;               // Pin reactor i to core i (Linux)
+  uint32_t seed = 1;
+  uint64_t wheel_tick_ns = 1'000'000;
+  size_t wheel_slots = 4096;
+
+  bool is_valid() const {
+    return interval_ms > 0 && jitter_ms >= 0 && jitter_ms < interval_ms &&
+           ticks_per_heartbeat >= 0 && stall_rate >= 0.0 && stall_rate <= 1.0 &&
+           stall_ms >= 0 && (stall_rate == 0.0 || stall_ms > 0) && wheel_tick_ns > 0 &&
+           wheel_slots > 0;
+  }
+};
+
+// Log-linear histogram of nanosecond values: 16 buckets per power of two
+// (under 7% error), relaxed atomic counts so other threads can read it
+class LatencyHistogram {
+public:
+  static constexpr size_t SUB_BUCKETS = 16;
+  static constexpr size_t BUCKETS = (64 - 3) * SUB_BUCKETS;
+
+  using Counts = std::array<uint64_t, BUCKETS>;
+
+  void record(uint64_t value) {
+    counts_[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  void add_to(Counts &counts) const {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      counts[i] += counts_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  static size_t bucket(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    return static_cast<size_t>(msb - 3) * SUB_BUCKETS + ((value >> (msb - 4)) & (SUB_BUCKETS - 1));
+  }
+
+  // Largest value that lands in bucket i
+  static uint64_t bucket_ceiling(size_t i) {
+    if (i < SUB_BUCKETS) {
+      return i;
+    }
+    int shift = static_cast<int>(i / SUB_BUCKETS) - 1;
+    uint64_t lower = (SUB_BUCKETS + i % SUB_BUCKETS) << shift;
+    return lower + (1ULL << shift) - 1;
+  }
+
+  // p in [0, 100]; 0 for no samples
+  static uint64_t percentile(const Counts &counts, double p) {
+    uint64_t total = 0;
+    for (uint64_t c : counts) {
+      total += c;
+    }
+    if (total == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return bucket_ceiling(i);
+      }
+    }
+    return bucket_ceiling(BUCKETS - 1);
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+  std::atomic<uint64_t> max_{0};
+};
+
+struct HeartbeatFleetStats {
+  uint64_t sessions = 0;      // Connected now
+  uint64_t accepted = 0;
+  uint64_t closed = 0;
+  uint64_t heartbeats = 0;
+  uint64_t ticks = 0;
+  uint64_t stalls = 0;        // Induced stalls started
+  uint64_t send_blocked = 0;  // Heartbeats that could not all go out at once
+  uint64_t slow_disconnects = 0;
+  uint64_t lateness_max_ns = 0;
+  LatencyHistogram::Counts lateness{};
+
+  uint64_t lateness_percentile(double p) const {
+    return LatencyHistogram::percentile(lateness, p);
+  }
+
+  // Counts accumulated since `earlier` (sessions and max stay current)
+  HeartbeatFleetStats since(const HeartbeatFleetStats &earlier) const {
+    HeartbeatFleetStats diff = *this;
+    diff.accepted -= earlier.accepted;
+    diff.closed -= earlier.closed;
+    diff.heartbeats -= earlier.heartbeats;
+    diff.ticks -= earlier.ticks;
+    diff.stalls -= earlier.stalls;
+    diff.send_blocked -= earlier.send_blocked;
+    diff.slow_disconnects -= earlier.slow_disconnects;
+    for (size_t i = 0; i < lateness.size(); ++i) {
+      diff.lateness[i] -= earlier.lateness[i];
+    }
+    return diff;
+  }
+};
+
+namespace heartbeat_fleet_detail {
+
+inline const char *const SYMBOLS[] = {"AAPL", "MSFT", "GOOG", "AMZN",
+                                      "TSLA", "META", "NVDA", "JPM "};
+
+// Timer clock: steady, and the clock the Linux timerfd is armed on
+// (now_ns() is wall-clock time, which can step)
+inline uint64_t monotonic_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+inline Result<int> listen_reuseport(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return Result<int>::error(std::string("socket creation failed: ") + strerror(errno));
+  }
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(fd, 4096) < 0) {
+    std::string error = std::string("bind/listen failed: ") + strerror(errno);
+    close(fd);
+    return Result<int>::error(error);
+  }
+  socket_set_nonblocking(fd);
+  return fd;
+}
+
+// One reactor thread: its listener, its sessions, their heartbeat timers
+class Reactor {
+public:
+  static constexpr size_t MAX_PENDING_BYTES = 64 * 1024;
+
+  Reactor(const HeartbeatFleetConfig &config, size_t index, int listen_fd)
+      : config_(config),
+        index_(index),
+        listen_fd_(listen_fd),
+        wheel_(config.wheel_tick_ns, config.wheel_slots, monotonic_ns()),
+        rng_(config.seed + static_cast<uint32_t>(index)) {}
+
+  ~Reactor() {
+    stop();
+    for (auto &session : sessions_) {
+      if (session.fd >= 0) {
+        close(session.fd);
+      }
+    }
+    close(listen_fd_);
+#ifdef __linux__
+    if (timer_fd_ >= 0) {
+      close(timer_fd_);
+    }
+#endif
+  }
+
+  Reactor(const Reactor &) = delete;
+  Reactor &operator=(const Reactor &) = delete;
+
+  Result<void> start() {
+    if (!poller_.ok()) {
+      return Result<void>::error("epoll_create1 failed");
+    }
+    poller_.add(listen_fd_, LISTEN_TAG);
+#ifdef __linux__
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ < 0) {
+      return Result<void>::error(std::string("timerfd_create failed: ") + strerror(errno));
+    }
+    poller_.add(timer_fd_, TIMER_TAG);
+#endif
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+    return Result<void>();
+  }
+
+  void stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  void add_stats(HeartbeatFleetStats &stats) const {
+    stats.sessions += sessions_live_.load(std::memory_order_relaxed);
+    stats.accepted += accepted_.load(std::memory_order_relaxed);
+    stats.closed += closed_.load(std::memory_order_relaxed);
+    stats.heartbeats += heartbeats_.load(std::memory_order_relaxed);
+    stats.ticks += ticks_.load(std::memory_order_relaxed);
+    stats.stalls += stalls_.load(std::memory_order_relaxed);
+    stats.send_blocked += send_blocked_.load(std::memory_order_relaxed);
+    stats.slow_disconnects += slow_disconnects_.load(std::memory_order_relaxed);
+    stats.lateness_max_ns = std::max(stats.lateness_max_ns, lateness_.max());
+    lateness_.add_to(stats.lateness);
+  }
+
+private:
+  static constexpr uint64_t LISTEN_TAG = ~0ULL;
+  static constexpr uint64_t TIMER_TAG = ~0ULL - 1;
+  static constexpr size_t MAX_EVENTS = 256;
+
+  struct Session {
+    int fd = -1;
+    uint64_t sequence = 0;
+    bool stalled = false;
+    std::string pending;  // Unsent bytes of earlier heartbeats
+  };
+
+  void run() {
+#ifdef __linux__
+    if (config_.pin) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(index_ % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+      pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+#endif
+    uint64_t tags[MAX_EVENTS];
+    uint64_t armed = 0;
+    while (running_.load(std::memory_order_relaxed)) {
+      uint64_t now = monotonic_ns();
+      uint64_t wake = wheel_.next_deadline();
+      int timeout_ms = 100;  // Bounds how long stop() waits
+      if (wake <= now) {
+        timeout_ms = 0;
+      } else {
+#ifdef __linux__
+        if (wake != armed) {
+          itimerspec spec{};
+          spec.it_value.tv_sec = static_cast<time_t>(wake / 1'000'000'000ULL);
+          spec.it_value.tv_nsec = static_cast<long>(wake % 1'000'000'000ULL);
+          timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+          armed = wake;
+        }
+#else
+        timeout_ms = static_cast<int>(std::min<uint64_t>((wake - now + 999'999) / 1'000'000, 100));
+#endif
+      }
+
+      int n = poller_.wait(timeout_ms, tags, MAX_EVENTS);
+      for (int i = 0; i < n; ++i) {
+        if (tags[i] == LISTEN_TAG) {
+          accept_all();
+        } else if (tags[i] == TIMER_TAG) {
+#ifdef __linux__
+          uint64_t expirations;
+          if (read(timer_fd_, &expirations, sizeof(expirations)) < 0) {
+            // Already drained
+          }
+          armed = 0;
+#endif
+        } else {
+          drain(static_cast<uint32_t>(tags[i]));
+        }
+      }
+      wheel_.advance(monotonic_ns(), [this](uint32_t slot, uint64_t deadline) { beat(slot, deadline); });
+    }
+  }
+
+  void accept_all() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR) continue;
+        return;  // EAGAIN, or out of fds: try again on the next readiness
+      }
+      socket_set_nonblocking(fd);
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+      uint32_t slot;
+      if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+      } else {
+        slot = static_cast<uint32_t>(sessions_.size());
+        sessions_.emplace_back();
+      }
+      Session &session = sessions_[slot];
+      session.fd = fd;
+      session.sequence = 0;
+      session.stalled = false;
+      session.pending.clear();
+      poller_.add(fd, slot);
+
+      uint64_t interval_ns = static_cast<uint64_t>(config_.interval_ms) * 1'000'000ULL;
+      wheel_.schedule(slot, monotonic_ns() + rng_() % interval_ns);
+      accepted_.fetch_add(1, std::memory_order_relaxed);
+      sessions_live_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Clients may send (requests, their own heartbeats); the server only
+  // needs to notice when they leave
+  void drain(uint32_t slot) {
+    if (slot >= sessions_.size() || sessions_[slot].fd < 0) {
+      return;
+    }
+    char scratch[4096];
+    while (true) {
+      ssize_t got = recv(sessions_[slot].fd, scratch, sizeof(scratch), 0);
+      if (got > 0) continue;
+      if (got < 0 && errno == EINTR) continue;
+      if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+      shut(slot);
+      return;
+    }
+  }
+
+  void beat(uint32_t slot, uint64_t deadline) {
+    Session &session = sessions_[slot];
+    uint64_t now = monotonic_ns();
+    uint64_t interval_ns = static_cast<uint64_t>(config_.interval_ms) * 1'000'000ULL;
+    if (session.stalled) {
+      session.stalled = false;  // Stall over: back on the interval from now
+      wheel_.schedule(slot, now + interval_ns);
+      return;
+    }
+    lateness_.record(now - std::min(now, deadline));
+
+    if (config_.stall_rate > 0.0 && unit_(rng_) < config_.stall_rate) {
+      session.stalled = true;
+      stalls_.fetch_add(1, std::memory_order_relaxed);
+      wheel_.schedule(slot, now + static_cast<uint64_t>(config_.stall_ms) * 1'000'000ULL);
+      return;
+    }
+
+    std::string &out = session.pending;
+    bool was_blocked = !out.empty();
+    uint64_t timestamp = now_ns();
+    out += serialize_heartbeat(session.sequence++, timestamp);
+    for (int i = 0; i < config_.ticks_per_heartbeat; ++i) {
+      out += serialize_tick(session.sequence++, timestamp, SYMBOLS[rng_() % 8],
+                            100.0f + static_cast<float>(rng_() % 40000) / 100.0f,
+                            static_cast<int32_t>(100 + rng_() % 9900));
+    }
+    heartbeats_.fetch_add(1, std::memory_order_relaxed);
+    ticks_.fetch_add(config_.ticks_per_heartbeat, std::memory_order_relaxed);
+    if (!flush(slot) || was_blocked || !out.empty()) {
+      send_blocked_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (sessions_[slot].fd < 0) {
+      return;  // Closed while flushing
+    }
+
+    int64_t jitter = 0;
+    if (config_.jitter_ms > 0) {
+      int64_t span = static_cast<int64_t>(config_.jitter_ms) * 1'000'000LL;
+      jitter = static_cast<int64_t>(rng_() % static_cast<uint64_t>(2 * span + 1)) - span;
+    }
+    wheel_.schedule(slot, std::max(now, deadline + interval_ns + jitter));
+  }
+
+  // False if the session was closed
+  bool flush(uint32_t slot) {
+    Session &session = sessions_[slot];
+    size_t sent = 0;
+    while (sent < session.pending.size()) {
+      ssize_t n = send(session.fd, session.pending.data() + sent, session.pending.size() - sent,
+                       MSG_NOSIGNAL);
+      if (n > 0) {
+        sent += n;
+        continue;
+      }
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+      shut(slot);
+      return false;
+    }
+    session.pending.erase(0, sent);
+    if (session.pending.size() > MAX_PENDING_BYTES) {
+      slow_disconnects_.fetch_add(1, std::memory_order_relaxed);
+      shut(slot);
+      return false;
+    }
+    return true;
+  }
+
+  void shut(uint32_t slot) {
+    Session &session = sessions_[slot];
+    poller_.remove(session.fd);
+    close(session.fd);
+    session.fd = -1;
+    session.pending.clear();
+    session.pending.shrink_to_fit();
+    wheel_.cancel(slot);
+    free_slots_.push_back(slot);
+    closed_.fetch_add(1, std::memory_order_relaxed);
+    sessions_live_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  HeartbeatFleetConfig config_;
+  size_t index_;
+  int listen_fd_;
+#ifdef __linux__
+  int timer_fd_ = -1;
+#endif
+  multi_client_detail::Poller poller_;
+  TimerWheel wheel_;
+  std::vector<Session> sessions_;
+  std::vector<uint32_t> free_slots_;
+  std::mt19937_64 rng_;
+  std::uniform_real_distribution<double> unit_{0.0, 1.0};
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+
+  std::atomic<uint64_t> sessions_live_{0};
+  std::atomic<uint64_t> accepted_{0};
+  std::atomic<uint64_t> closed_{0};
+  std::atomic<uint64_t> heartbeats_{0};
+  std::atomic<uint64_t> ticks_{0};
+  std::atomic<uint64_t> stalls_{0};
+  std::atomic<uint64_t> send_blocked_{0};
+  std::atomic<uint64_t> slow_disconnects_{0};
+  LatencyHistogram lateness_;
+};
+
+} // namespace heartbeat_fleet_detail
+
+class HeartbeatFleet {
+public:
+  explicit HeartbeatFleet(const HeartbeatFleetConfig &config = {}) : config_(config) {}
+
+  ~HeartbeatFleet() { stop(); }
+
+  HeartbeatFleet(const HeartbeatFleet &) = delete;
+  HeartbeatFleet &operator=(const HeartbeatFleet &) = delete;
+
+  // Bind every reactor's listener, then start the reactor threads
+  Result<void> start() {
+    if (!config_.is_valid()) {
+      return Result<void>::error("invalid heartbeat fleet config");
+    }
+    if (!reactors_.empty()) {
+      return Result<void>::error("already started");
+    }
+    size_t count = config_.reactors > 0 ? config_.reactors
+                                        : std::max(1u, std::thread::hardware_concurrency());
+    port_ = config_.port;
+    std::vector<int> listeners;
+    for (size_t i = 0; i < count; ++i) {
+      auto fd = heartbeat_fleet_detail::listen_reuseport(port_);
+      if (!fd) {
+        for (int open_fd : listeners) close(open_fd);
+        return Result<void>::error(fd.error());
+      }
+      if (port_ == 0) {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        getsockname(fd.value(), reinterpret_cast<sockaddr *>(&addr), &len);
+        port_ = ntohs(addr.sin_port);  // The rest join the first one's port
+      }
+      listeners.push_back(fd.value());
+    }
+    for (size_t i = 0; i < count; ++i) {
+      reactors_.push_back(
+          std::make_unique<heartbeat_fleet_detail::Reactor>(config_, i, listeners[i]));
+    }
+    for (auto &reactor : reactors_) {
+      auto started = reactor->start();
+      if (!started) {
+        stop();
+        return started;
+      }
+    }
+    return Result<void>();
+  }
+
+  // Stops the reactors and closes every session
+  void stop() { reactors_.clear(); }
+
+  uint16_t port() const { return port_; }
+  size_t reactor_count() const { return reactors_.size(); }
+
+  // Safe from any thread while running
+  HeartbeatFleetStats stats() const {
+    HeartbeatFleetStats stats;
+    for (const auto &reactor : reactors_) {
+      reactor->add_stats(stats);
+    }
+    return stats;
+  }
+
+private:
+  HeartbeatFleetConfig config_;
+  uint16_t port_ = 0;
+  std::vector<std::unique_ptr<heartbeat_fleet_detail::Reactor>> reactors_;
+};
+
+#endif // HEARTBEAT_FLEET_HPP
@@ -0,0 +1,237 @@
+#ifndef MEMORY_ACCOUNTING_HPP
+#define MEMORY_ACCOUNTING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "order_book.hpp"
+
+/**
+ * Memory Accounting
+ *
+ * Each component of a handler reports two numbers:
+ *   reserved  bytes it has allocated (a queue's whole ring, a vector's
+ *             capacity), resident once touched
+ *   in_use    bytes holding live data right now (<= reserved)
+ *
+ * A component reports in one of two ways, depending on who may read its
+ * sizes:
+ *   - MemoryAccount: a pair of atomics its owning thread stores to
+ *     (relaxed, single writer), for sizes only that thread may read, such
+ *     as a vector it grows or books it updates. Same pattern as
+ *     StageMonitor.
+ *   - A sampler function, for sizes that are safe to read from any thread,
+ *     such as a queue's capacity and depth.
+ *
+ * MemoryRegistry holds both under component names. snapshot() and total()
+ * may be called from any thread, e.g. a metrics poller.
+ *
+ * Containers don't say what they cost, so the estimates below are
+ * libstdc++ node layouts rounded to glibc malloc chunks: an estimate of
+ * resident heap, not an exact count.
+ *
+ * Usage:
+ *   MemoryRegistry memory;
+ *   memory.add("tick_queue", [&] { return MemoryUsage{q.storage_bytes(), q.size() * sizeof(T)}; });
+ *   memory.add("books", books_account);          // owner: books_account.set(r, u)
+ *   print_memory_table(memory.snapshot());
+ */
+
+struct MemoryUsage {
+  uint64_t reserved = 0;
+  uint64_t in_use = 0;
+
+  MemoryUsage &operator+=(const MemoryUsage &other) {
+    reserved += other.reserved;
+    in_use += other.in_use;
+    return *this;
+  }
+};
+
+struct ComponentMemory {
+  std::string name;
+  MemoryUsage usage;
+};
+
+// Per-symbol book memory, largest first when reported
+struct SymbolMemory {
+  std::string symbol;
+  size_t levels = 0;
+  uint64_t bytes = 0;
+};
+
+// =============================================================================
+// Size Estimates
+// =============================================================================
+
+// A malloc(n) costs n plus an 8-byte header, in 16-byte steps, 32 at least
+constexpr uint64_t heap_block_bytes(uint64_t n) {
+  return n == 0 ? 0 : std::max<uint64_t>(32, (n + 8 + 15) & ~uint64_t{15});
+}
+
+// One std::map / std::set node: color and three links, then the value
+template <typename Value>
+constexpr uint64_t tree_node_bytes() {
+  return heap_block_bytes(4 * sizeof(void *) + sizeof(Value));
+}
+
+// One std::unordered_map node: next link, value and (string keys) cached hash
+template <typename Value>
+constexpr uint64_t hash_node_bytes() {
+  return heap_block_bytes(2 * sizeof(void *) + sizeof(Value));
+}
+
+template <typename K, typename V>
+uint64_t container_bytes(const std::map<K, V> &map) {
+  return map.size() * tree_node_bytes<std::pair<const K, V>>();
+}
+
+template <typename K, typename V>
+uint64_t container_bytes(const std::unordered_map<K, V> &map) {
+  return map.size() * hash_node_bytes<std::pair<const K, V>>() +
+         heap_block_bytes(map.bucket_count() * sizeof(void *));
+}
+
+template <typename T>
+uint64_t container_bytes(const std::vector<T> &vector) {
+  return heap_block_bytes(vector.capacity() * sizeof(T));
+}
+
+// An OrderBook: the object plus one tree node per level
+inline uint64_t book_bytes(const OrderBook &book) {
+  return sizeof(OrderBook) + book.level_count() * tree_node_bytes<OrderBook::Levels::value_type>();
+}
+
+// Top `limit` symbols by bytes (0 = all)
+inline std::vector<SymbolMemory> largest_symbols(std::vector<SymbolMemory> symbols,
+                                                 size_t limit = 0) {
+  std::sort(symbols.begin(), symbols.end(), [](const SymbolMemory &a, const SymbolMemory &b) {
+    return a.bytes != b.bytes ? a.bytes > b.bytes : a.symbol < b.symbol;
+  });
+  if (limit > 0 && symbols.size() > limit) {
+    symbols.resize(limit);
+  }
+  return symbols;
+}
+
+// =============================================================================
+// Accounts and Registry
+// =============================================================================
+
+// Written by exactly one thread, read by any
+class MemoryAccount {
+public:
+  MemoryAccount() = default;
+  MemoryAccount(const MemoryAccount &) = delete;
+  MemoryAccount &operator=(const MemoryAccount &) = delete;
+
+  inline void set(uint64_t reserved, uint64_t in_use) {
+    reserved_.store(reserved, std::memory_order_relaxed);
+    in_use_.store(in_use, std::memory_order_relaxed);
+  }
+
+  MemoryUsage usage() const {
+    return MemoryUsage{reserved_.load(std::memory_order_relaxed),
+                       in_use_.load(std::memory_order_relaxed)};
+  }
+
+private:
+  std::atomic<uint64_t> reserved_{0};
+  std::atomic<uint64_t> in_use_{0};
+};
+
+class MemoryRegistry {
+public:
+  using Sampler = std::function<MemoryUsage()>;
+
+  // Replaces a component already registered under the same name
+  void add(const std::string &name, Sampler sampler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &component : components_) {
+      if (component.first == name) {
+        component.second = std::move(sampler);
+        return;
+      }
+    }
+    components_.emplace_back(name, std::move(sampler));
+  }
+
+  // The account must outlive its registration
+  void add(const std::string &name, const MemoryAccount &account) {
+    add(name, [&account]() { return account.usage(); });
+  }
+
+  void remove(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    components_.erase(std::remove_if(components_.begin(), components_.end(),
+                                     [&](const auto &c) { return c.first == name; }),
+                      components_.end());
+  }
+
+  // Registration order
+  std::vector<ComponentMemory> snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ComponentMemory> out;
+    out.reserve(components_.size());
+    for (const auto &[name, sampler] : components_) {
+      out.push_back(ComponentMemory{name, sampler()});
+    }
+    return out;
+  }
+
+  MemoryUsage total() const {
+    MemoryUsage sum;
+    for (const auto &component : snapshot()) {
+      sum += component.usage;
+    }
+    return sum;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return components_.size();
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<std::pair<std::string, Sampler>> components_;
+};
+
+// =============================================================================
+// Reporting
+// =============================================================================
+
+inline void print_memory_table(const std::vector<ComponentMemory> &components,
+                               const char *title = "Memory") {
+  MemoryUsage total;
+  printf("\n=== %s ===\n", title);
+  printf("%-20s %14s %14s\n", "component", "reserved", "in use");
+  for (const auto &component : components) {
+    printf("%-20s %14s %14s\n", component.name.c_str(),
+           format_bytes(component.usage.reserved).c_str(),
+           format_bytes(component.usage.in_use).c_str());
+    total += component.usage;
+  }
+  printf("%-20s %14s %14s\n", "total", format_bytes(total.reserved).c_str(),
+         format_bytes(total.in_use).c_str());
+}
+
+inline void print_symbol_memory(const std::vector<SymbolMemory> &symbols, size_t total_symbols) {
+  printf("Largest books (%zu of %zu):\n", symbols.size(), total_symbols);
+  for (const auto &entry : symbols) {
+    printf("  %-10s %6zu levels %12s\n", entry.symbol.c_str(), entry.levels,
+           format_bytes(entry.bytes).c_str());
+  }
+}
+
+#endif // MEMORY_ACCOUNTING_HPP
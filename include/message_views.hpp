@@ -0,0 +1,140 @@
+#ifndef MESSAGE_VIEWS_HPP
+#define MESSAGE_VIEWS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "binary_protocol.hpp"
+
+// =============================================================================
+// Message views
+//
+// deserialize_tick_payload() and deserialize_order_book_update() byte-swap
+// every field into a struct before the caller looks at any of them. A view
+// wraps the payload where it sits in the receive buffer and decodes a field
+// only when its accessor is called, so a reader can check the symbol and
+// drop the message before decoding anything else:
+//
+//   TickView tick(payload);
+//   if (tick.symbol_key() != wanted) return;  // Nothing else decoded
+//   total += tick.price();
+//
+// A view is just the pointer: it is valid while the buffer holds the
+// message, and copying it copies no payload bytes. Field offsets are fixed
+// by the wire layout and checked against PAYLOAD_SIZE at compile time.
+// =============================================================================
+
+namespace wire_detail {
+
+inline uint32_t load_u32(const char* p) {
+  uint32_t net;
+  memcpy(&net, p, 4);
+  return ntohl(net);
+}
+
+inline uint64_t load_u64(const char* p) {
+  uint64_t net;
+  memcpy(&net, p, 8);
+  return ntohll(net);
+}
+
+inline float load_float(const char* p) {
+  uint32_t bits = load_u32(p);
+  float value;
+  memcpy(&value, &bits, 4);
+  return value;
+}
+
+} // namespace wire_detail
+
+// Symbol bytes up to the first NUL, like trim_symbol() without the copy
+inline std::string_view symbol_view(const char* symbol, size_t max_len) {
+  const void* nul = memchr(symbol, '\0', max_len);
+  return {symbol, nul ? static_cast<size_t>(static_cast<const char*>(nul) - symbol) : max_len};
+}
+
+/**
+ * TICK payload: [8 timestamp][4 symbol][4 price][4 volume]
+ */
+class TickView {
+public:
+  static constexpr size_t TIMESTAMP_OFFSET = 0;
+  static constexpr size_t SYMBOL_OFFSET = 8;
+  static constexpr size_t PRICE_OFFSET = 12;
+  static constexpr size_t VOLUME_OFFSET = 16;
+
+  explicit TickView(const char* payload) : payload_(payload) {}
+
+  // Symbol accessors read the bytes in place; no byte swap
+  uint32_t symbol_key() const { return ::symbol_key(payload_ + SYMBOL_OFFSET); }
+  std::string_view symbol() const { return symbol_view(payload_ + SYMBOL_OFFSET, 4); }
+  const char* symbol_bytes() const { return payload_ + SYMBOL_OFFSET; }
+
+  uint64_t timestamp() const { return wire_detail::load_u64(payload_ + TIMESTAMP_OFFSET); }
+  float price() const { return wire_detail::load_float(payload_ + PRICE_OFFSET); }
+  int32_t volume() const {
+    return static_cast<int32_t>(wire_detail::load_u32(payload_ + VOLUME_OFFSET));
+  }
+
+  // Every field, for callers that keep the tick past the buffer
+  TickPayload decode() const {
+    TickPayload tick;
+    tick.timestamp = timestamp();
+    memcpy(tick.symbol, symbol_bytes(), 4);
+    tick.price = price();
+    tick.volume = volume();
+    return tick;
+  }
+
+  const char* data() const { return payload_; }
+
+private:
+  const char* payload_;
+};
+
+static_assert(TickView::VOLUME_OFFSET + 4 == TickPayload::PAYLOAD_SIZE,
+              "TickView offsets must cover the TICK payload");
+
+/**
+ * ORDER_BOOK_UPDATE payload: [4 symbol][1 side][4 price][8 quantity]
+ */
+class BookUpdateView {
+public:
+  static constexpr size_t SYMBOL_OFFSET = 0;
+  static constexpr size_t SIDE_OFFSET = 4;
+  static constexpr size_t PRICE_OFFSET = 5;
+  static constexpr size_t QUANTITY_OFFSET = 9;
+
+  explicit BookUpdateView(const char* payload) : payload_(payload) {}
+
+  uint32_t symbol_key() const { return ::symbol_key(payload_ + SYMBOL_OFFSET); }
+  std::string_view symbol() const { return symbol_view(payload_ + SYMBOL_OFFSET, 4); }
+  const char* symbol_bytes() const { return payload_ + SYMBOL_OFFSET; }
+
+  uint8_t side() const { return static_cast<uint8_t>(payload_[SIDE_OFFSET]); }
+  float price() const { return wire_detail::load_float(payload_ + PRICE_OFFSET); }
+  int64_t quantity() const {
+    return static_cast<int64_t>(wire_detail::load_u64(payload_ + QUANTITY_OFFSET));
+  }
+
+  OrderBookUpdatePayload decode() const {
+    OrderBookUpdatePayload update;
+    memcpy(update.symbol, symbol_bytes(), 4);
+    update.side = side();
+    update.price = price();
+    update.quantity = quantity();
+    return update;
+  }
+
+  const char* data() const { return payload_; }
+
+private:
+  const char* payload_;
+};
+
+static_assert(BookUpdateView::QUANTITY_OFFSET + 8 == OrderBookUpdatePayload::PAYLOAD_SIZE,
+              "BookUpdateView offsets must cover the ORDER_BOOK_UPDATE payload");
+
+#endif // MESSAGE_VIEWS_HPP
@@ -0,0 +1,587 @@
+#ifndef MULTI_CLIENT_HPP
+#define MULTI_CLIENT_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+
+/**
+ * Pooled-Buffer Multi-Connection Client
+ *
+ * Reads binary protocol frames from many TCP connections on one thread.
+ * binary_client_zerocopy gives every connection its own 1 MB RingBuffer,
+ * so 1000 connections reserve 1 GB whether or not they ever send; here a
+ * connection owns only a small carry-over buffer and borrows a receive
+ * buffer from a shared pool for the duration of one wakeup, and only when
+ * it is ready to read:
+ *
+ *   epoll_wait → for each ready connection: borrow buffer, copy carry-over
+ *   to its front, recv() once → parse every buffer in place → frame
+ *   callbacks → leftover partial frame back to the carry → return buffers
+ *
+ * All reads of a wakeup happen back to back before any callback runs, so a
+ * slow callback does not age the data still waiting on the connections
+ * behind it. Each ready connection gets one recv() per wakeup (level
+ * triggered: one with more data is simply ready again), so a busy
+ * connection cannot starve the rest. If more connections are ready than
+ * the pool has buffers, the borrowed ones are parsed and returned mid-wakeup
+ * (a pool flush) and reading carries on.
+ *
+ * A frame split across reads is carried in the connection's inline buffer
+ * (CARRY_INLINE bytes, enough for any tick or book update); only a larger
+ * partial frame, such as part of a snapshot chunk, spills to the heap, and
+ * that allocation is freed as soon as the frame completes.
+ *
+ * The epoll batch (events taken per wakeup) adapts between min_batch and
+ * max_batch: it doubles when a wakeup fills it and halves when a wakeup
+ * uses under a quarter of it, so an idle client wakes for single events
+ * and a busy one drains thousands of ready connections per syscall.
+ *
+ * Threading: everything, callbacks included, runs on the thread calling
+ * poll(). Not thread-safe.
+ *
+ * Usage:
+ *   MultiClient client;
+ *   client.set_frame_callback([](MultiClient::ConnectionId id, const MessageHeader &header,
+ *                                const char *payload) { ... });
+ *   for (uint16_t port : ports) client.connect("127.0.0.1", port);
+ *   while (running) client.poll(100);
+ */
+
+struct MultiClientConfig {
+  // Each pooled receive buffer; must hold the largest frame
+  size_t buffer_bytes = 64 * 1024;
+  // Buffers in the pool, allocated on first use; bounds how many ready
+  // connections are read before a pool flush
+  size_t pool_buffers = 32;
+  // Bounds for the adaptive epoll batch
+  size_t min_batch = 8;
+  size_t max_batch = 4096;
+
+  bool is_valid() const {
+    return buffer_bytes >= MessageHeader::HEADER_SIZE + MessageHeader::MAX_PAYLOAD_SIZE &&
+           pool_buffers > 0 && min_batch > 0 && min_batch <= max_batch;
+  }
+};
+
+struct MultiClientStats {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  uint64_t wakeups = 0;          // epoll_wait calls that returned events
+  uint64_t events = 0;           // Ready connections, summed over wakeups
+  uint64_t recv_calls = 0;
+  uint64_t carries = 0;          // Reads that ended mid-frame
+  uint64_t carry_spills = 0;     // ... with a partial frame too large for the inline carry
+  uint64_t closed = 0;           // By the peer, an error or close()
+  uint64_t protocol_errors = 0;  // Frame length over MAX_PAYLOAD_SIZE
+  uint64_t pool_flushes = 0;     // Wakeups that ran out of pooled buffers
+  size_t pool_high_water = 0;    // Most buffers lent out at once
+};
+
+namespace multi_client_detail {
+
+// Fixed-size receive buffers, lent out for one wakeup at a time
+class BufferPool {
+public:
+  BufferPool(size_t buffer_bytes, size_t capacity)
+      : buffer_bytes_(buffer_bytes), capacity_(capacity) {}
+
+  size_t buffer_bytes() const { return buffer_bytes_; }
+  size_t in_use() const { return in_use_; }
+  size_t high_water() const { return high_water_; }
+  size_t allocated() const { return buffers_.size(); }
+  size_t footprint_bytes() const { return buffers_.size() * buffer_bytes_; }
+
+  // nullptr once capacity buffers are lent out
+  char *acquire() {
+    if (free_.empty()) {
+      if (buffers_.size() == capacity_) {
+        return nullptr;
+      }
+      buffers_.emplace_back(new char[buffer_bytes_]);
+      free_.push_back(buffers_.back().get());
+    }
+    char *buffer = free_.back();
+    free_.pop_back();
+    high_water_ = std::max(high_water_, ++in_use_);
+    return buffer;
+  }
+
+  void release(char *buffer) {
+    free_.push_back(buffer);
+    --in_use_;
+  }
+
+private:
+  size_t buffer_bytes_;
+  size_t capacity_;
+  std::vector<std::unique_ptr<char[]>> buffers_;
+  std::vector<char *> free_;
+  size_t in_use_ = 0;
+  size_t high_water_ = 0;
+};
+
+// The partial frame a connection's last read ended on
+class CarryBuffer {
+public:
+  static constexpr size_t INLINE_BYTES = 64;
+
+  size_t size() const { return size_; }
+  const char *data() const { return heap_ ? heap_.get() : inline_; }
+  size_t heap_bytes() const { return heap_ ? heap_capacity_ : 0; }
+
+  // Returns true if the bytes did not fit inline
+  bool assign(const char *data, size_t size) {
+    bool spilled = false;
+    if (size <= INLINE_BYTES) {
+      heap_.reset();
+      heap_capacity_ = 0;
+      std::memcpy(inline_, data, size);
+    } else {
+      if (size > heap_capacity_) {
+        heap_.reset(new char[size]);
+        heap_capacity_ = size;
+      }
+      std::memcpy(heap_.get(), data, size);
+      spilled = true;
+    }
+    size_ = size;
+    return spilled;
+  }
+
+  void clear() {
+    size_ = 0;
+    heap_.reset();
+    heap_capacity_ = 0;
+  }
+
+private:
+  char inline_[INLINE_BYTES];
+  size_t size_ = 0;
+  std::unique_ptr<char[]> heap_;
+  size_t heap_capacity_ = 0;
+};
+
+// Readiness for the client thread: epoll on Linux, poll() elsewhere.
+// wait() fills tags with at most max ready connections' tags.
+class Poller {
+public:
+  Poller() {
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(0);
+#endif
+  }
+
+  ~Poller() {
+#ifdef __linux__
+    if (epoll_fd_ >= 0) {
+      close(epoll_fd_);
+    }
+#endif
+  }
+
+  Poller(const Poller&) = delete;
+  Poller& operator=(const Poller&) = delete;
+
+  bool ok() const {
+#ifdef __linux__
+    return epoll_fd_ >= 0;
+#else
+    return true;
+#endif
+  }
+
+  bool add(int fd, uint64_t tag) {
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = tag;
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+#else
+    fds_.push_back({fd, POLLIN, 0});
+    tags_.push_back(tag);
+    return true;
+#endif
+  }
+
+  void remove(int fd) {
+#ifdef __linux__
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    for (size_t i = 0; i < fds_.size(); ++i) {
+      if (fds_[i].fd == fd) {
+        fds_[i] = fds_.back();
+        tags_[i] = tags_.back();
+        fds_.pop_back();
+        tags_.pop_back();
+        break;
+      }
+    }
+#endif
+  }
+
+  int wait(int timeout_ms, uint64_t *tags, size_t max) {
+#ifdef __linux__
+    if (events_.size() < max) {
+      events_.resize(max);
+    }
+    int n = epoll_wait(epoll_fd_, events_.data(), static_cast<int>(max), timeout_ms);
+    for (int i = 0; i < n; ++i) {
+      tags[i] = events_[i].data.u64;
+    }
+    return std::max(n, 0);
+#else
+    if (fds_.empty() || ::poll(fds_.data(), fds_.size(), timeout_ms) <= 0) {
+      return 0;
+    }
+    // Start where the last scan stopped, so low fds cannot starve the rest
+    size_t n = 0;
+    for (size_t i = 0; i < fds_.size() && n < max; ++i) {
+      size_t at = (cursor_ + i) % fds_.size();
+      if (fds_[at].revents != 0) {
+        tags[n++] = tags_[at];
+      }
+    }
+    cursor_ = (cursor_ + 1) % fds_.size();
+    return static_cast<int>(n);
+#endif
+  }
+
+  size_t footprint_bytes() const {
+#ifdef __linux__
+    return events_.capacity() * sizeof(epoll_event);
+#else
+    return fds_.capacity() * sizeof(pollfd) + tags_.capacity() * sizeof(uint64_t);
+#endif
+  }
+
+private:
+#ifdef __linux__
+  int epoll_fd_ = -1;
+  std::vector<epoll_event> events_;
+#else
+  std::vector<pollfd> fds_;
+  std::vector<uint64_t> tags_;
+  size_t cursor_ = 0;
+#endif
+};
+
+} // namespace multi_client_detail
+
+class MultiClient {
+public:
+  // Slot index in the low 32 bits, the slot's generation in the high 32,
+  // so an id stays invalid after its slot is reused
+  using ConnectionId = uint64_t;
+  using FrameCallback =
+      std::function<void(ConnectionId id, const MessageHeader &header, const char *payload)>;
+  using CloseCallback = std::function<void(ConnectionId id)>;
+
+  static constexpr size_t CARRY_INLINE = multi_client_detail::CarryBuffer::INLINE_BYTES;
+
+  explicit MultiClient(const MultiClientConfig &config = {})
+      : config_(config),
+        pool_(std::max(config.buffer_bytes,
+                       MessageHeader::HEADER_SIZE + MessageHeader::MAX_PAYLOAD_SIZE),
+              std::max<size_t>(config.pool_buffers, 1)),
+        batch_limit_(std::max<size_t>(config.min_batch, 1)) {
+    config_.min_batch = batch_limit_;
+    config_.max_batch = std::max(config_.max_batch, batch_limit_);
+  }
+
+  ~MultiClient() {
+    for (auto &session : sessions_) {
+      if (session.fd >= 0) {
+        ::close(session.fd);
+      }
+    }
+  }
+
+  MultiClient(const MultiClient &) = delete;
+  MultiClient &operator=(const MultiClient &) = delete;
+
+  void set_frame_callback(FrameCallback callback) { on_frame_ = std::move(callback); }
+  void set_close_callback(CloseCallback callback) { on_close_ = std::move(callback); }
+
+  // Take ownership of a connected socket; it is made non-blocking
+  Result<ConnectionId> add(int fd) {
+    if (!poller_.ok()) {
+      return Result<ConnectionId>::error("epoll_create1 failed");
+    }
+    auto nonblocking = socket_set_nonblocking(fd);
+    if (!nonblocking) {
+      ::close(fd);
+      return Result<ConnectionId>::error(nonblocking.error());
+    }
+
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      slot = static_cast<uint32_t>(sessions_.size());
+      sessions_.emplace_back();
+    }
+    Session &session = sessions_[slot];
+    session.fd = fd;
+    ConnectionId id = make_id(slot, session.generation);
+    if (!poller_.add(fd, id)) {
+      std::string error = std::string("epoll_ctl failed: ") + strerror(errno);
+      session.fd = -1;
+      ++session.generation;
+      free_slots_.push_back(slot);
+      ::close(fd);
+      return Result<ConnectionId>::error(error);
+    }
+    ++connections_;
+    return id;
+  }
+
+  Result<ConnectionId> connect(const std::string &host, uint16_t port) {
+    auto fd = socket_connect(host, port);
+    if (!fd) {
+      return Result<ConnectionId>::error(fd.error());
+    }
+    return add(fd.value());
+  }
+
+  // Close a connection; safe from inside the frame callback, including for
+  // the connection whose frame it is handling (its remaining frames are
+  // dropped). False for an unknown or already closed id.
+  bool close(ConnectionId id) {
+    Session *session = find(id);
+    if (session == nullptr) {
+      return false;
+    }
+    shut(slot_of(id));
+    return true;
+  }
+
+  // Wait up to timeout_ms for data, then read and dispatch everything ready
+  // (up to the current batch limit). Returns the frames delivered.
+  size_t poll(int timeout_ms) {
+    if (tags_.size() < config_.max_batch) {
+      tags_.resize(config_.max_batch);
+    }
+    int n = poller_.wait(timeout_ms, tags_.data(), batch_limit_);
+    if (n <= 0) {
+      return 0;
+    }
+    uint64_t frames_before = stats_.frames;
+    ++stats_.wakeups;
+    stats_.events += n;
+
+    // Phase 1: one read per ready connection into a borrowed buffer
+    bool flushed = false;
+    for (int i = 0; i < n; ++i) {
+      ConnectionId id = tags_[i];
+      Session *session = find(id);
+      if (session == nullptr) {
+        continue;  // Closed by a callback earlier in this wakeup
+      }
+      char *buffer = pool_.acquire();
+      if (buffer == nullptr) {
+        if (!flushed) {
+          ++stats_.pool_flushes;
+          flushed = true;
+        }
+        dispatch();
+        buffer = pool_.acquire();
+        if ((session = find(id)) == nullptr) {
+          pool_.release(buffer);
+          continue;
+        }
+      }
+      read_into(id, *session, buffer);
+    }
+
+    // Phase 2: parse in place, dispatch, keep the tails
+    dispatch();
+    stats_.pool_high_water = pool_.high_water();
+
+    if (static_cast<size_t>(n) == batch_limit_) {
+      batch_limit_ = std::min(batch_limit_ * 2, config_.max_batch);
+    } else if (static_cast<size_t>(n) < batch_limit_ / 4) {
+      batch_limit_ = std::max(batch_limit_ / 2, config_.min_batch);
+    }
+    return stats_.frames - frames_before;
+  }
+
+  size_t connections() const { return connections_; }
+  size_t batch_limit() const { return batch_limit_; }
+  size_t buffers_in_use() const { return pool_.in_use(); }
+  const MultiClientStats &stats() const { return stats_; }
+
+  // Bytes of partial frames currently carried (inline and heap)
+  size_t carried_bytes() const {
+    size_t total = 0;
+    for (const auto &session : sessions_) {
+      total += session.carry.size();
+    }
+    return total;
+  }
+
+  // Memory the client holds: pooled buffers, connection slots, spilled
+  // carries and the event array. Independent of connection count but for
+  // sizeof(Session) per slot.
+  size_t footprint_bytes() const {
+    size_t total = pool_.footprint_bytes() + poller_.footprint_bytes() +
+                   sessions_.capacity() * sizeof(Session) +
+                   free_slots_.capacity() * sizeof(uint32_t) +
+                   tags_.capacity() * sizeof(uint64_t) + pending_.capacity() * sizeof(Pending);
+    for (const auto &session : sessions_) {
+      total += session.carry.heap_bytes();
+    }
+    return total;
+  }
+
+  static constexpr size_t session_bytes() { return sizeof(Session); }
+
+private:
+  struct Session {
+    int fd = -1;
+    uint32_t generation = 0;
+    multi_client_detail::CarryBuffer carry;
+  };
+
+  // A borrowed buffer waiting to be parsed
+  struct Pending {
+    ConnectionId id;
+    char *buffer;
+    size_t size;
+  };
+
+  static ConnectionId make_id(uint32_t slot, uint32_t generation) {
+    return (static_cast<uint64_t>(generation) << 32) | slot;
+  }
+  static uint32_t slot_of(ConnectionId id) { return static_cast<uint32_t>(id); }
+
+  Session *find(ConnectionId id) {
+    uint32_t slot = slot_of(id);
+    if (slot >= sessions_.size()) {
+      return nullptr;
+    }
+    Session &session = sessions_[slot];
+    if (session.fd < 0 || session.generation != static_cast<uint32_t>(id >> 32)) {
+      return nullptr;
+    }
+    return &session;
+  }
+
+  void read_into(ConnectionId id, Session &session, char *buffer) {
+    size_t carried = session.carry.size();
+    std::memcpy(buffer, session.carry.data(), carried);
+    ssize_t got;
+    do {
+      got = recv(session.fd, buffer + carried, pool_.buffer_bytes() - carried, 0);
+    } while (got < 0 && errno == EINTR);
+    ++stats_.recv_calls;
+
+    if (got > 0) {
+      stats_.bytes += got;
+      pending_.push_back({id, buffer, carried + static_cast<size_t>(got)});
+      return;
+    }
+    pool_.release(buffer);
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return;
+    }
+    shut(slot_of(id));  // Peer closed, or a socket error
+  }
+
+  // Parse every pending buffer and hand its buffer back
+  void dispatch() {
+    for (size_t p = 0; p < pending_.size(); ++p) {
+      const Pending pending = pending_[p];
+      parse(pending);
+      pool_.release(pending.buffer);
+    }
+    pending_.clear();
+  }
+
+  void parse(const Pending &pending) {
+    if (find(pending.id) == nullptr) {
+      return;  // Closed by a callback since the read
+    }
+    const char *data = pending.buffer;
+    size_t offset = 0;
+    while (pending.size - offset >= MessageHeader::HEADER_SIZE) {
+      MessageHeader header = deserialize_header(data + offset);
+      if (header.length > MessageHeader::MAX_PAYLOAD_SIZE) {
+        ++stats_.protocol_errors;
+        LOG_WARN("MultiClient", "Frame length %u over limit, closing connection", header.length);
+        shut(slot_of(pending.id));
+        return;
+      }
+      size_t frame = MessageHeader::HEADER_SIZE + header.length;
+      if (pending.size - offset < frame) {
+        break;
+      }
+      ++stats_.frames;
+      if (on_frame_) {
+        on_frame_(pending.id, header, data + offset + MessageHeader::HEADER_SIZE);
+        if (find(pending.id) == nullptr) {
+          return;  // Closed from the callback
+        }
+      }
+      offset += frame;
+    }
+
+    Session &session = sessions_[slot_of(pending.id)];
+    if (offset == pending.size) {
+      session.carry.clear();
+      return;
+    }
+    ++stats_.carries;
+    if (session.carry.assign(data + offset, pending.size - offset)) {
+      ++stats_.carry_spills;
+    }
+  }
+
+  void shut(uint32_t slot) {
+    Session &session = sessions_[slot];
+    ConnectionId id = make_id(slot, session.generation);
+    poller_.remove(session.fd);
+    ::close(session.fd);
+    session.fd = -1;
+    session.carry.clear();
+    ++session.generation;
+    free_slots_.push_back(slot);
+    --connections_;
+    ++stats_.closed;
+    if (on_close_) {
+      on_close_(id);
+    }
+  }
+
+  MultiClientConfig config_;
+  multi_client_detail::Poller poller_;
+  multi_client_detail::BufferPool pool_;
+  std::vector<Session> sessions_;
+  std::vector<uint32_t> free_slots_;
+  std::vector<uint64_t> tags_;
+  std::vector<Pending> pending_;
+  size_t connections_ = 0;
+  size_t batch_limit_;
+  FrameCallback on_frame_;
+  CloseCallback on_close_;
+  MultiClientStats stats_;
+};
+
+#endif // MULTI_CLIENT_HPP
@@ -5,11 +5,17 @@
  * Consolidated Feed Handler Module
  *
  * This header provides a unified interface for building feed handlers that:
- * - Connect to market data servers (TCP)
+ * - Connect to market data servers (TCP, AF_UNIX or shared memory; transport.hpp)
  * - Parse both text and binary protocols
  * - Use lock-free queues for inter-thread communication
  * - Manage connection lifecycle with reconnection support
  * - Collect latency and throughput statistics
+ * - Optional stall watchdog with trace dumps (see watchdog.hpp)
+ * - Optional warm-up phase that primes the hot path before live data
+ * - Symbol subscriptions, applied by the reader before a tick is decoded
+ * - Optional local distribution to subscriber processes (distribution.hpp)
+ * - Optional TCP republishing to remote consumers (republisher.hpp)
+ * - Batch callbacks over ticks in place in the queue (C ABI: feed_capi.h)
  *
  * Architecture:
  *   Socket → Reader Thread → SPSC Queue → Processor Thread → Callback
@@ -42,14 +48,25 @@
 #include <thread>
 #include <unistd.h>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Include protocol parsers and common utilities
 #include "../binary_protocol.hpp"
+#include "../compact_encoding.hpp"
+#include "../distribution.hpp"
+#include "../frame_integrity.hpp"
+#include "../memory_accounting.hpp"
+#include "../message_views.hpp"
+#include "../republisher.hpp"
+#include "../symbol_filter.hpp"
 #include "../common.hpp"
 #include "../text_protocol.hpp"
+#include "../transport.hpp"
 #include "../spsc_queue.hpp"
 #include "../order_book.hpp"
+#include "../tracepoints.hpp"
+#include "../watchdog.hpp"
 
 namespace net {
 
@@ -65,6 +82,22 @@ enum class Protocol {
   BINARY
 };
 
+/**
+ * Warm-up settings
+ *
+ * Before connecting, the handler prefaults (and optionally mlocks) the tick
+ * queue and pushes synthetic frames through the real reader parse path, the
+ * queue and the processor callback, so page tables, caches, hash tables and
+ * branch predictors are primed when the first live message arrives. Anything
+ * the synthetic traffic produced is discarded afterwards.
+ */
+struct WarmupConfig {
+  std::chrono::milliseconds budget{250};  // Upper bound on synthetic traffic
+  size_t max_messages = 200'000;
+  bool lock_memory = true;                // mlock hot buffers (best effort)
+  std::vector<std::string> symbols;       // Known symbol universe
+};
+
 struct FeedConfig {
   std::string host = "127.0.0.1";
   uint16_t port = 0;
@@ -73,8 +106,23 @@ struct FeedConfig {
   bool verbose = false;
   std::chrono::seconds reconnect_timeout{5};
   int max_reconnect_attempts = 3;
-
-  bool is_valid() const { return port != 0; }
+  bool watchdog = false;
+  WatchdogConfig watchdog_config;
+  bool warmup = false;
+  WarmupConfig warmup_config;
+  bool crc = false;  // Binary frames carry a CRC32C trailer (frame_integrity.hpp)
+  std::vector<std::string> subscriptions;  // Symbols passed downstream (empty = all)
+  std::string distribution_path;  // Socket for local subscribers (empty = no distribution)
+  size_t distribution_queue_size = 64 * 1024;
+  bool republish = false;                 // Serve remote consumers over TCP
+  RepublisherConfig republish_config;
+
+  Transport transport = Transport::TCP;  // How to reach host:port, or transport_path
+  std::string transport_path;            // AF_UNIX socket path or shm ring name
+
+  bool is_valid() const {
+    return transport == Transport::TCP ? port != 0 : !transport_path.empty();
+  }
 };
 
 //=============================================================================
@@ -108,6 +156,16 @@ struct Tick {
     volume = tp.volume;
     recv_timestamp_ns = recv_ts;
   }
+
+  // Straight from the receive buffer, without an intermediate TickPayload
+  explicit Tick(const TickView& view, uint64_t recv_ts) {
+    timestamp = view.timestamp();
+    std::memcpy(symbol, view.symbol_bytes(), 4);
+    symbol[4] = '\0';
+    price = static_cast<double>(view.price());
+    volume = view.volume();
+    recv_timestamp_ns = recv_ts;
+  }
 };
 
 // Use LatencyStats from common.hpp
@@ -121,14 +179,17 @@ class Connection {
 public:
   Connection(const std::string& host, uint16_t port, bool verbose = false,
              int connect_timeout_sec = 5)
-      : host_(host), port_(port), verbose_(verbose)
-      , connect_timeout_sec_(connect_timeout_sec), sockfd_(-1) {}
+      : Connection(Endpoint{Transport::TCP, host, port, ""}, verbose, connect_timeout_sec) {}
+
+  Connection(Endpoint endpoint, bool verbose = false, int connect_timeout_sec = 5)
+      : endpoint_(std::move(endpoint)), verbose_(verbose)
+      , connect_timeout_sec_(connect_timeout_sec) {}
 
   ~Connection() { disconnect(); }
 
   bool connect() {
     if (verbose_) {
-      std::cout << "[Connection] Connecting to " << host_ << ":" << port_ << "...\n";
+      std::cout << "[Connection] Connecting to " << endpoint_.to_string() << "...\n";
     }
 
     SocketOptions opts;
@@ -137,38 +198,41 @@ public:
     opts.connect_timeout_ms = connect_timeout_sec_ * 1000;
     opts.non_blocking = false;  // Keep blocking mode after connect
 
-    auto result = socket_connect(host_, port_, opts);
+    auto result = transport_connect(endpoint_, opts);
     if (!result) {
       if (verbose_) {
         std::cerr << "[Connection] " << result.error() << "\n";
       }
-      sockfd_ = -1;
       return false;
     }
 
-    sockfd_ = result.value();
+    channel_ = std::move(result.value());
     if (verbose_) {
       std::cout << "[Connection] Connected!\n";
     }
     return true;
   }
 
+  // Safe while a reader is blocked on the connection: a shm ring is only
+  // detached here (the reader returns 0) and unmapped on destruction
   void disconnect() {
-    if (sockfd_ >= 0) {
-      close(sockfd_);
-      sockfd_ = -1;
+    if (channel_.ring()) {
+      channel_.ring()->close_reader();
+    } else {
+      channel_.close();
     }
   }
 
-  bool is_connected() const { return sockfd_ >= 0; }
-  int fd() const { return sockfd_; }
+  bool is_connected() const { return channel_.fd() >= 0 || channel_.ring() != nullptr; }
+  int fd() const { return channel_.fd(); }
+  ShmRing* ring() const { return channel_.ring(); }  // Non-null for Transport::SHM
+  const Endpoint& endpoint() const { return endpoint_; }
 
 private:
-  std::string host_;
-  uint16_t port_;
+  Endpoint endpoint_;
   bool verbose_;
   int connect_timeout_sec_;
-  int sockfd_;
+  TransportChannel channel_;
 };
 
 //=============================================================================
@@ -177,16 +241,24 @@ private:
 
 class TextProtocolReader {
 public:
+  static constexpr size_t RECV_BUFFER_BYTES = 16 * 1024;
+  // Receive buffer (stack) plus carried-over partial lines
+  static constexpr size_t BUFFER_BYTES = RECV_BUFFER_BYTES + TextLineBuffer::BUFFER_SIZE;
+
   TextProtocolReader(int sockfd, SPSCQueue<Tick>& queue,
-                     std::atomic<bool>& should_stop, bool verbose)
+                     std::atomic<bool>& should_stop, bool verbose,
+                     StageMonitor& monitor)
       : sockfd_(sockfd), queue_(queue), should_stop_(should_stop)
-      , verbose_(verbose), messages_parsed_(0), parse_errors_(0) {}
+      , verbose_(verbose), monitor_(monitor)
+      , messages_parsed_(0), parse_errors_(0) {}
 
   void run() {
-    char recv_buffer[16 * 1024];
+    char recv_buffer[RECV_BUFFER_BYTES];
 
     while (!should_stop_) {
-      ssize_t bytes_read = recv(sockfd_, recv_buffer, sizeof(recv_buffer), 0);
+      monitor_.set_state(StageState::IDLE);
+      ssize_t bytes_read = ring_ ? ring_->read(recv_buffer, sizeof(recv_buffer))
+                                 : recv(sockfd_, recv_buffer, sizeof(recv_buffer), 0);
       uint64_t recv_ts = now_ns();
 
       if (bytes_read <= 0) {
@@ -195,72 +267,129 @@ public:
         } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
           if (verbose_) perror("[Reader] recv");
         }
+        monitor_.record(TraceEvent::DISCONNECT, bytes_read == 0 ? 0 : errno);
         should_stop_ = true;
         break;
       }
 
-      if (!line_buffer_.append(recv_buffer, bytes_read)) {
+      monitor_.set_state(StageState::RUNNING);
+      monitor_.record(TraceEvent::RECV, static_cast<uint64_t>(bytes_read));
+      FEED_TRACE(recv, sockfd_, bytes_read);
+      uint64_t parsed_before = messages_parsed_;
+
+      if (!parse_chunk(recv_buffer, bytes_read, recv_ts)) {
         std::cerr << "[Reader] Buffer overflow!\n";
-        line_buffer_.reset();
         continue;
       }
 
-      std::string_view line;
-      while (line_buffer_.get_line(line)) {
-        auto tick_opt = parse_text_tick(line);
-        if (tick_opt) {
-          Tick unified(*tick_opt, recv_ts);
-          enqueue_with_backpressure(unified);
-          messages_parsed_++;
-        } else {
-          parse_errors_++;
-        }
-      }
+      monitor_.record(TraceEvent::PARSED, messages_parsed_ - parsed_before);
+      FEED_TRACE(decoded, messages_parsed_ - parsed_before, bytes_read);
+      monitor_.beat();
     }
 
+    monitor_.set_state(StageState::EXITED);
+
     if (verbose_) {
       std::cout << "[Reader] Exiting. Parsed: " << messages_parsed_
-                << ", Errors: " << parse_errors_ << std::endl;
+                << ", Errors: " << parse_errors_ << ", Filtered: " << messages_filtered_
+                << std::endl;
     }
   }
 
+  /**
+   * Parse a received chunk and enqueue every complete line.
+   * Partial lines are carried over to the next call.
+   * Returns false (and drops buffered data) on line buffer overflow.
+   */
+  bool parse_chunk(const char* data, size_t len, uint64_t recv_ts) {
+    if (!line_buffer_.append(data, len)) {
+      line_buffer_.reset();
+      return false;
+    }
+
+    const SymbolFilter* filter = subscription_ ? subscription_->read() : nullptr;
+    std::string_view line;
+    while (line_buffer_.get_line(line)) {
+      auto tick_opt = parse_text_tick(line);
+      if (!tick_opt) {
+        parse_errors_++;
+      } else if (filter && !filter->matches(std::string_view(tick_opt->symbol))) {
+        messages_filtered_++;
+      } else {
+        Tick unified(*tick_opt, recv_ts);
+        enqueue_with_backpressure(unified);
+        messages_parsed_++;
+      }
+    }
+    if (subscription_) subscription_->quiescent();
+    return true;
+  }
+
+  // Drop ticks for symbols outside the subscription (nullptr = keep all)
+  void set_subscription(Subscription* subscription) { subscription_ = subscription; }
+
+  // Read from a shared-memory ring instead of the socket
+  void set_ring(ShmRing* ring) { ring_ = ring; }
+
   uint64_t messages_parsed() const { return messages_parsed_; }
   uint64_t parse_errors() const { return parse_errors_; }
+  uint64_t messages_filtered() const { return messages_filtered_; }
 
 private:
   void enqueue_with_backpressure(const Tick& tick) {
+    if (__builtin_expect(queue_.push(tick), 1)) {
+      return;
+    }
+
+    FEED_TRACE(queue_full, queue_.capacity());
+    monitor_.set_state(StageState::BLOCKED);
+    uint64_t total_retries = 0;
     int retries = 0;
     while (!queue_.push(tick) && !should_stop_) {
+      total_retries++;
       if (++retries > 1000) {
         std::this_thread::yield();
         retries = 0;
       }
     }
+    monitor_.record(TraceEvent::QUEUE_FULL, total_retries);
+    FEED_TRACE(queue_resume, total_retries);
+    monitor_.set_state(StageState::RUNNING);
   }
 
   int sockfd_;
+  ShmRing* ring_ = nullptr;
   SPSCQueue<Tick>& queue_;
   std::atomic<bool>& should_stop_;
   bool verbose_;
+  StageMonitor& monitor_;
   TextLineBuffer line_buffer_;
+  Subscription* subscription_ = nullptr;
   uint64_t messages_parsed_;
   uint64_t parse_errors_;
+  uint64_t messages_filtered_ = 0;
 };
 
 class BinaryProtocolReader {
 public:
+  static constexpr size_t BUFFER_BYTES = 64 * 1024;  // Receive buffer (stack)
+
   BinaryProtocolReader(int sockfd, SPSCQueue<Tick>& queue,
-                       std::atomic<bool>& should_stop, bool verbose)
+                       std::atomic<bool>& should_stop, bool verbose,
+                       StageMonitor& monitor)
       : sockfd_(sockfd), queue_(queue), should_stop_(should_stop)
-      , verbose_(verbose), messages_parsed_(0), parse_errors_(0) {}
+      , verbose_(verbose), monitor_(monitor)
+      , messages_parsed_(0), parse_errors_(0) {}
 
   void run() {
-    char recv_buffer[64 * 1024];
+    char recv_buffer[BUFFER_BYTES];
     size_t buffer_pos = 0;
 
     while (!should_stop_) {
-      ssize_t bytes_read = recv(sockfd_, recv_buffer + buffer_pos,
-                                 sizeof(recv_buffer) - buffer_pos, 0);
+      monitor_.set_state(StageState::IDLE);
+      ssize_t bytes_read =
+          ring_ ? ring_->read(recv_buffer + buffer_pos, sizeof(recv_buffer) - buffer_pos)
+                : recv(sockfd_, recv_buffer + buffer_pos, sizeof(recv_buffer) - buffer_pos, 0);
       uint64_t recv_ts = now_ns();
 
       if (bytes_read <= 0) {
@@ -269,64 +398,174 @@ public:
         } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
           if (verbose_) perror("[Reader] recv");
         }
+        monitor_.record(TraceEvent::DISCONNECT, bytes_read == 0 ? 0 : errno);
         should_stop_ = true;
         break;
       }
 
+      monitor_.set_state(StageState::RUNNING);
+      monitor_.record(TraceEvent::RECV, static_cast<uint64_t>(bytes_read));
+      FEED_TRACE(recv, sockfd_, bytes_read);
+      uint64_t parsed_before = messages_parsed_;
       buffer_pos += bytes_read;
 
-      size_t consumed = 0;
-      while (consumed + MessageHeader::HEADER_SIZE <= buffer_pos) {
-        MessageHeader header = deserialize_header(recv_buffer + consumed);
-
-        size_t total_msg_size = MessageHeader::HEADER_SIZE + header.length;
-        if (consumed + total_msg_size > buffer_pos) {
-          break;
-        }
-
-        if (header.type == MessageType::TICK) {
-          TickPayload payload = deserialize_tick_payload(
-              recv_buffer + consumed + MessageHeader::HEADER_SIZE);
-          Tick unified(payload, recv_ts);
-          enqueue_with_backpressure(unified);
-          messages_parsed_++;
-        }
-
-        consumed += total_msg_size;
-      }
+      size_t consumed = parse_frames(recv_buffer, buffer_pos, recv_ts);
 
       if (consumed > 0) {
         memmove(recv_buffer, recv_buffer + consumed, buffer_pos - consumed);
         buffer_pos -= consumed;
       }
+
+      monitor_.record(TraceEvent::PARSED, messages_parsed_ - parsed_before);
+      FEED_TRACE(decoded, messages_parsed_ - parsed_before, bytes_read);
+      monitor_.beat();
     }
 
+    monitor_.set_state(StageState::EXITED);
+
     if (verbose_) {
       std::cout << "[Reader] Exiting. Parsed: " << messages_parsed_
-                << ", Errors: " << parse_errors_ << std::endl;
+                << ", Filtered: " << messages_filtered_
+                << ", Errors: " << parse_errors_ << " (CRC: " << crc_errors_
+                << ", header: " << header_errors_ << ", resync bytes: " << resync_bytes_
+                << ")" << std::endl;
     }
   }
 
+  // Expect a CRC32C trailer on every frame
+  void set_checksummed(bool checksummed) { checksummed_ = checksummed; }
+
+  // Drop ticks for symbols outside the subscription (nullptr = keep all).
+  // A dropped TICK is rejected on its symbol bytes: nothing else is decoded
+  // and nothing is queued.
+  void set_subscription(Subscription* subscription) { subscription_ = subscription; }
+
+  // Read from a shared-memory ring instead of the socket
+  void set_ring(ShmRing* ring) { ring_ = ring; }
+
+  /**
+   * Parse and enqueue every complete frame in data[0, len).
+   * Returns the number of bytes consumed; a trailing partial frame is left
+   * for the caller to carry over. Frames are validated a batch at a time
+   * (scan_frames); a bad one is counted and skipped up to the next
+   * plausible header.
+   */
+  size_t parse_frames(const char* data, size_t len, uint64_t recv_ts) {
+    filter_ = subscription_ ? subscription_->read() : nullptr;
+    size_t consumed = parse_batches(data, len, recv_ts);
+    filter_ = nullptr;
+    if (subscription_) subscription_->quiescent();
+    return consumed;
+  }
+
   uint64_t messages_parsed() const { return messages_parsed_; }
   uint64_t parse_errors() const { return parse_errors_; }
+  // Ticks dropped by the subscription filter
+  uint64_t messages_filtered() const { return messages_filtered_; }
+  // Compact batches dropped while waiting for a keyframe
+  uint64_t compact_skipped() const { return compact_decoder_.skipped_messages(); }
+  uint64_t crc_errors() const { return crc_errors_; }
+  // Impossible length or unknown type
+  uint64_t header_errors() const { return header_errors_; }
+  // Bytes skipped looking for the next frame after a bad one
+  uint64_t resync_bytes() const { return resync_bytes_; }
 
 private:
+  size_t parse_batches(const char* data, size_t len, uint64_t recv_ts) {
+    size_t consumed = 0;
+    while (true) {
+      scan_frames(data + consumed, len - consumed, checksummed_, frame_batch_);
+      for (size_t i = 0; i < frame_batch_.count; ++i) {
+        dispatch(frame_batch_.headers[i],
+                 data + consumed + frame_batch_.offsets[i] + MessageHeader::HEADER_SIZE, recv_ts);
+      }
+      consumed += frame_batch_.end;
+
+      if (frame_batch_.error != FrameError::NONE) {
+        if (frame_batch_.error == FrameError::BAD_CRC) {
+          crc_errors_++;
+        } else {
+          header_errors_++;
+        }
+        parse_errors_++;
+        size_t skip = find_next_frame(data + consumed, len - consumed, checksummed_);
+        resync_bytes_ += skip;
+        consumed += skip;
+        monitor_.record(TraceEvent::PARSE_ERROR, skip);
+        continue;
+      }
+      if (frame_batch_.count < FrameBatch::MAX_FRAMES) {
+        return consumed;
+      }
+    }
+  }
+
+  void dispatch(const MessageHeader& header, const char* payload, uint64_t recv_ts) {
+    if (header.type == MessageType::TICK) {
+      TickView tick(payload);
+      if (filter_ && !filter_->matches(tick.symbol_key())) {
+        messages_filtered_++;
+        return;
+      }
+      enqueue_with_backpressure(Tick(tick, recv_ts));
+      messages_parsed_++;
+    } else if (header.type == MessageType::COMPACT_TICKS) {
+      // Deltas chain through every tick, so the batch is decoded in full;
+      // only the push is filtered
+      auto status = compact_decoder_.decode(
+          header, payload,
+          [&](uint64_t, const TickPayload& tick) {
+            if (filter_ && !filter_->matches(symbol_key(tick.symbol))) {
+              messages_filtered_++;
+              return;
+            }
+            enqueue_with_backpressure(Tick(tick, recv_ts));
+            messages_parsed_++;
+          });
+      if (status == CompactTickDecoder::Status::MALFORMED) {
+        parse_errors_++;
+      }
+    }
+  }
+
   void enqueue_with_backpressure(const Tick& tick) {
+    if (__builtin_expect(queue_.push(tick), 1)) {
+      return;
+    }
+
+    FEED_TRACE(queue_full, queue_.capacity());
+    monitor_.set_state(StageState::BLOCKED);
+    uint64_t total_retries = 0;
     int retries = 0;
     while (!queue_.push(tick) && !should_stop_) {
+      total_retries++;
       if (++retries > 1000) {
         std::this_thread::yield();
         retries = 0;
       }
     }
+    monitor_.record(TraceEvent::QUEUE_FULL, total_retries);
+    FEED_TRACE(queue_resume, total_retries);
+    monitor_.set_state(StageState::RUNNING);
   }
 
   int sockfd_;
+  ShmRing* ring_ = nullptr;
   SPSCQueue<Tick>& queue_;
   std::atomic<bool>& should_stop_;
   bool verbose_;
+  StageMonitor& monitor_;
   uint64_t messages_parsed_;
   uint64_t parse_errors_;
+  uint64_t crc_errors_ = 0;
+  uint64_t header_errors_ = 0;
+  uint64_t resync_bytes_ = 0;
+  bool checksummed_ = false;
+  Subscription* subscription_ = nullptr;
+  const SymbolFilter* filter_ = nullptr;  // Held for one parse_frames() call
+  uint64_t messages_filtered_ = 0;
+  FrameBatch frame_batch_;
+  CompactTickDecoder compact_decoder_;
 };
 
 //=============================================================================
@@ -334,59 +573,175 @@ private:
 //=============================================================================
 
 using TickCallback = std::function<void(const Tick&)>;
+// Ticks still in the queue's storage, valid only for the duration of the call
+using BatchCallback = std::function<void(const Tick* ticks, size_t count)>;
 
 class TickProcessor {
 public:
+  static constexpr size_t DEFAULT_MAX_BATCH = 256;
+  static constexpr size_t LATENCY_RESERVE = 1'000'000;  // Samples before the vector grows
+
   TickProcessor(SPSCQueue<Tick>& queue, std::atomic<bool>& should_stop,
-                bool verbose, TickCallback callback = nullptr)
+                bool verbose, StageMonitor& monitor,
+                TickCallback callback = nullptr,
+                BatchCallback batch_callback = nullptr,
+                size_t max_batch = DEFAULT_MAX_BATCH)
       : queue_(queue), should_stop_(should_stop), verbose_(verbose)
-      , callback_(callback), messages_processed_(0) {
-    e2e_latency_.reserve(1'000'000);
+      , monitor_(monitor), callback_(callback), batch_callback_(batch_callback)
+      , max_batch_(std::max<size_t>(max_batch, 1)), messages_processed_(0) {
+    e2e_latency_.reserve(LATENCY_RESERVE);
   }
 
-  void run() {
-    while (!should_stop_ || !queue_.empty()) {
-      auto tick_opt = queue_.pop();
-      if (tick_opt) {
-        uint64_t process_ts = now_ns();
-        const auto& tick = *tick_opt;
-
-        e2e_latency_.add(process_ts - tick.recv_timestamp_ns);
-
-        if (callback_) {
-          callback_(tick);
-        }
+  // Report the latency samples' memory to `account` as they accumulate.
+  // Set before run().
+  void set_memory_account(MemoryAccount* account) {
+    memory_account_ = account;
+    update_memory_account();
+  }
 
-        messages_processed_++;
+  void run() {
+    bool idle = true;
+    monitor_.set_state(StageState::IDLE);
 
-        if (verbose_ && messages_processed_ % 100000 == 0) {
-          std::cout << "[Processor] Processed: " << messages_processed_
-                    << " | Last: " << tick.symbol << " @ " << tick.price << std::endl;
+    while (!should_stop_ || !queue_.empty()) {
+      size_t processed = batch_callback_ ? process_batch() : process_one();
+      if (processed > 0) {
+        if (idle) {
+          monitor_.set_state(StageState::RUNNING);
+          idle = false;
         }
+        monitor_.beat();
       } else {
+        if (!idle) {
+          monitor_.record(TraceEvent::PROCESSED,
+                          messages_processed_.load(std::memory_order_relaxed));
+          monitor_.set_state(StageState::IDLE);
+          idle = true;
+        }
         std::this_thread::yield();
       }
     }
 
+    monitor_.set_state(StageState::EXITED);
+
     if (verbose_) {
-      std::cout << "[Processor] Exiting. Processed: " << messages_processed_ << std::endl;
+      std::cout << "[Processor] Exiting. Processed: " << messages_processed() << std::endl;
     }
   }
 
-  uint64_t messages_processed() const { return messages_processed_; }
+  uint64_t messages_processed() const {
+    return messages_processed_.load(std::memory_order_acquire);
+  }
   const LatencyStats& latency_stats() const { return e2e_latency_; }
 
+  /**
+   * Forget everything processed so far (e.g. warm-up traffic).
+   * Only call while the queue is drained and no producer is running.
+   */
+  void reset_stats() {
+    messages_processed_.store(0, std::memory_order_relaxed);
+    e2e_latency_.clear();
+    update_memory_account();
+  }
+
+  // Latency of the first live message (0 if none yet)
+  uint64_t first_message_latency_ns() const {
+    return e2e_latency_.empty() ? 0 : e2e_latency_.data().front();
+  }
+
+  // Mean latency over the first n messages, where cold-start costs show up
+  double first_n_mean_ns(size_t n) const {
+    const auto& data = e2e_latency_.data();
+    n = std::min(n, data.size());
+    if (n == 0) return 0.0;
+    uint64_t sum = std::accumulate(data.begin(), data.begin() + n, 0ULL);
+    return static_cast<double>(sum) / n;
+  }
+
   void print_stats() const {
     std::cout << "\n=== End-to-End Latency ===" << std::endl;
     e2e_latency_.print("Recv → Process");
+    if (!e2e_latency_.empty()) {
+      std::cout << "  First: " << first_message_latency_ns() / 1000.0 << " us"
+                << " | First 1000 mean: " << first_n_mean_ns(1000) / 1000.0
+                << " us" << std::endl;
+    }
   }
 
 private:
+  size_t process_one() {
+    auto tick_opt = queue_.pop();
+    if (!tick_opt) {
+      return 0;
+    }
+    uint64_t process_ts = now_ns();
+    const auto& tick = *tick_opt;
+
+    e2e_latency_.add(process_ts - tick.recv_timestamp_ns);
+    FEED_TRACE(processed, size_t{1}, tick.recv_timestamp_ns, process_ts);
+
+    if (callback_) {
+      callback_(tick);
+    }
+    count_processed(1, tick);
+    return 1;
+  }
+
+  /**
+   * Up to max_batch_ ticks straight out of the queue's storage: the tick
+   * callback (if any) sees each one, then the batch callback sees them all
+   * together, before their slots go back to the reader.
+   */
+  size_t process_batch() {
+    const Tick* ticks = nullptr;
+    size_t count = queue_.peek_batch(&ticks, max_batch_);
+    if (count == 0) {
+      return 0;
+    }
+    uint64_t process_ts = now_ns();
+    FEED_TRACE(processed, count, ticks[0].recv_timestamp_ns, process_ts);
+    for (size_t i = 0; i < count; ++i) {
+      e2e_latency_.add(process_ts - ticks[i].recv_timestamp_ns);
+      if (callback_) {
+        callback_(ticks[i]);
+      }
+    }
+    batch_callback_(ticks, count);
+    count_processed(count, ticks[count - 1]);
+    queue_.consume(count);
+    return count;
+  }
+
+  void count_processed(uint64_t count, const Tick& last) {
+    // Release so a thread that observes the count also sees the
+    // callbacks' side effects (used to fence the warm-up phase)
+    uint64_t before = messages_processed_.load(std::memory_order_relaxed);
+    uint64_t processed = before + count;
+    messages_processed_.store(processed, std::memory_order_release);
+    update_memory_account();
+
+    if (verbose_ && processed / 100000 != before / 100000) {
+      std::cout << "[Processor] Processed: " << processed
+                << " | Last: " << last.symbol << " @ " << last.price << std::endl;
+    }
+  }
+
+  void update_memory_account() {
+    if (memory_account_) {
+      memory_account_->set(e2e_latency_.capacity() * sizeof(uint64_t),
+                           e2e_latency_.count() * sizeof(uint64_t));
+    }
+  }
+
   SPSCQueue<Tick>& queue_;
   std::atomic<bool>& should_stop_;
   bool verbose_;
+  StageMonitor& monitor_;
+  MemoryAccount* memory_account_ = nullptr;
   TickCallback callback_;
-  uint64_t messages_processed_;
+  BatchCallback batch_callback_;
+  size_t max_batch_;
+  std::atomic<uint64_t> messages_processed_;
   LatencyStats e2e_latency_;
 };
 
@@ -394,6 +749,13 @@ private:
 // High-Level Feed Handler
 //=============================================================================
 
+struct WarmupReport {
+  uint64_t messages = 0;          // Synthetic ticks the reader queued (rejects excluded)
+  uint64_t duration_ns = 0;       // Prefault + traffic + drain
+  bool budget_exhausted = false;  // Stopped on time rather than message count
+  bool memory_locked = false;     // mlock succeeded for the tick queue
+};
+
 class FeedHandler {
 public:
   explicit FeedHandler(const FeedConfig& config)
@@ -402,7 +764,14 @@ public:
       , should_stop_(false)
       , running_(false)
       , messages_parsed_(0)
-      , parse_errors_(0) {}
+      , parse_errors_(0) {
+    if (!config_.subscriptions.empty()) {
+      subscription_.subscribe(config_.subscriptions);
+    }
+    memory_.add("tick_queue", [this]() {
+      return MemoryUsage{queue_.storage_bytes(), queue_.size() * sizeof(Tick)};
+    });
+  }
 
   ~FeedHandler() {
     stop();
@@ -412,33 +781,118 @@ public:
     callback_ = callback;
   }
 
+  // Hand ticks over in runs of up to max_batch, in place in the queue, on
+  // the processor thread. The tick callback, if also set, sees each tick
+  // of a run first. Set before start().
+  void set_batch_callback(BatchCallback callback,
+                          size_t max_batch = TickProcessor::DEFAULT_MAX_BATCH) {
+    batch_callback_ = callback;
+    max_batch_ = max_batch;
+  }
+
+  // Replace the subscribed symbols; safe from any thread while running.
+  // The reader picks the new set up on its next receive.
+  void subscribe(const std::vector<std::string>& symbols) {
+    subscription_.subscribe(symbols);
+  }
+
+  void subscribe_all() { subscription_.subscribe_all(); }
+
+  // Send a book change to local subscribers interested in `symbol` and to
+  // republisher clients. Only from the tick callback (the processor thread
+  // feeds both queues); a no-op with neither configured.
+  void distribute_book_update(const char* symbol, uint8_t side, float price, int64_t quantity) {
+    if (!forwarding_live_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    DistributionEvent event;
+    event.type = MessageType::ORDER_BOOK_UPDATE;
+    memcpy(event.symbol, symbol, strnlen(symbol, sizeof(event.symbol)));
+    event.side = side;
+    event.price = price;
+    event.quantity = quantity;
+    forward(event);
+  }
+
+  // Invoked on the caller's thread once warm-up traffic is fully processed,
+  // with the processor idle - the place to throw away warm-up state
+  void set_warmup_complete_callback(std::function<void()> callback) {
+    warmup_complete_callback_ = callback;
+  }
+
   bool start() {
     if (running_) return true;
 
-    connection_ = std::make_unique<Connection>(config_.host, config_.port, config_.verbose);
+    should_stop_ = false;
+
+    if (!config_.distribution_path.empty() && !start_distribution()) {
+      return false;
+    }
+    if (config_.republish && !start_republisher()) {
+      stop_forwarding();
+      return false;
+    }
+
+    // Start processor thread
+    processor_ = std::make_unique<TickProcessor>(queue_, should_stop_, config_.verbose,
+                                                 processor_monitor_, processor_callback(),
+                                                 batch_callback_, max_batch_);
+    processor_->set_memory_account(&latency_memory_);
+    memory_.add("latency_samples", latency_memory_);
+    processor_thread_ = std::thread([this]() { processor_->run(); });
+
+    if (config_.warmup) {
+      run_warmup();
+    }
+    // Warm-up ticks stay local; subscribers only see live traffic
+    forwarding_live_.store(distribution_ != nullptr || republisher_ != nullptr,
+                           std::memory_order_release);
+
+    connection_ = std::make_unique<Connection>(
+        Endpoint{config_.transport, config_.host, config_.port, config_.transport_path},
+        config_.verbose);
     if (!connection_->connect()) {
+      should_stop_ = true;
+      processor_thread_.join();
+      stop_forwarding();
       return false;
     }
 
-    should_stop_ = false;
     running_ = true;
     start_time_ = std::chrono::steady_clock::now();
 
-    // Start processor thread
-    processor_ = std::make_unique<TickProcessor>(queue_, should_stop_, config_.verbose, callback_);
-    processor_thread_ = std::thread([this]() { processor_->run(); });
+    // Fixed-size, so all of it counts as in use while the reader runs
+    const uint64_t reader_bytes = config_.protocol == Protocol::TEXT
+                                      ? TextProtocolReader::BUFFER_BYTES
+                                      : BinaryProtocolReader::BUFFER_BYTES;
+    memory_.add("reader_buffers", [reader_bytes]() {
+      return MemoryUsage{reader_bytes, reader_bytes};
+    });
 
     // Start reader thread
     if (config_.protocol == Protocol::TEXT) {
       text_reader_ = std::make_unique<TextProtocolReader>(
-          connection_->fd(), queue_, should_stop_, config_.verbose);
+          connection_->fd(), queue_, should_stop_, config_.verbose, reader_monitor_);
+      text_reader_->set_subscription(&subscription_);
+      text_reader_->set_ring(connection_->ring());
       reader_thread_ = std::thread([this]() { text_reader_->run(); });
     } else {
       binary_reader_ = std::make_unique<BinaryProtocolReader>(
-          connection_->fd(), queue_, should_stop_, config_.verbose);
+          connection_->fd(), queue_, should_stop_, config_.verbose, reader_monitor_);
+      binary_reader_->set_checksummed(config_.crc);
+      binary_reader_->set_subscription(&subscription_);
+      binary_reader_->set_ring(connection_->ring());
       reader_thread_ = std::thread([this]() { binary_reader_->run(); });
     }
 
+    if (config_.watchdog) {
+      watchdog_ = std::make_unique<StallWatchdog>(config_.watchdog_config);
+      watchdog_->watch_stage("reader", reader_monitor_);
+      watchdog_->watch_stage("processor", processor_monitor_);
+      watchdog_->watch_queue("tick_queue", queue_);
+      watchdog_->start();
+    }
+
     return true;
   }
 
@@ -450,6 +904,10 @@ public:
     if (processor_thread_.joinable()) {
       processor_thread_.join();
     }
+    stop_forwarding();
+    if (watchdog_) {
+      watchdog_->stop();
+    }
     end_time_ = std::chrono::steady_clock::now();
     update_stats();
     running_ = false;
@@ -465,12 +923,23 @@ public:
 
   bool is_running() const { return running_; }
 
+  const WarmupReport& warmup_report() const { return warmup_report_; }
+  const TickProcessor* processor() const { return processor_.get(); }
+
+  // Reserved and in-use bytes per component; snapshot() from any thread.
+  // Owners of state built on top (books, bars) add their own entries.
+  MemoryRegistry& memory() { return memory_; }
+  const MemoryRegistry& memory() const { return memory_; }
+
   // Statistics
   uint64_t messages_parsed() const { return messages_parsed_; }
   uint64_t messages_processed() const {
     return processor_ ? processor_->messages_processed() : 0;
   }
   uint64_t parse_errors() const { return parse_errors_; }
+  uint64_t messages_filtered() const { return messages_filtered_; }
+  // Ticks parsed but not yet processed; safe from any thread
+  size_t queue_depth() const { return queue_.size(); }
 
   double duration_ms() const {
     auto duration = end_time_ - start_time_;
@@ -488,21 +957,280 @@ public:
     std::cout << "Messages parsed: " << messages_parsed_ << std::endl;
     std::cout << "Messages processed: " << messages_processed() << std::endl;
     std::cout << "Parse errors: " << parse_errors_ << std::endl;
+    if (messages_filtered_ > 0 || subscription_.read() != nullptr) {
+      std::cout << "Filtered (not subscribed): " << messages_filtered_ << std::endl;
+    }
     std::cout << "Throughput: " << throughput() << " msgs/sec" << std::endl;
 
+    if (config_.warmup) {
+      std::cout << "Warm-up: " << warmup_report_.messages << " synthetic msgs in "
+                << format_duration_ns(warmup_report_.duration_ns)
+                << (warmup_report_.budget_exhausted ? " (budget exhausted)" : "")
+                << ", memory " << (warmup_report_.memory_locked ? "locked" : "not locked")
+                << std::endl;
+    }
+
+    if (watchdog_) {
+      std::cout << "Watchdog: " << watchdog_->stalls_detected() << " stalls, "
+                << watchdog_->watermark_breaches() << " watermark breaches, "
+                << watchdog_->dumps_written() << " dumps" << std::endl;
+    }
+
+    if (distribution_) {
+      std::cout << "Distribution: " << distribution_->subscribers_connected() << " subscribers, "
+                << distribution_->frames_sent() << " frames sent, "
+                << distribution_->slow_evictions() << " slow evictions, "
+                << distribution_overruns_ << " queue overruns" << std::endl;
+    }
+
+    if (republisher_) {
+      std::cout << "Republisher: port " << republisher_->port() << ", "
+                << republisher_->clients_accepted() << " clients, "
+                << republisher_->frames_sent() << " frames in " << republisher_->batches()
+                << " sends, " << republisher_->frames_dropped() << " dropped, "
+                << republisher_->slow_disconnects() << " slow disconnects, "
+                << republisher_->overruns() << " queue overruns" << std::endl;
+    }
+
     if (processor_) {
       processor_->print_stats();
     }
+
+    print_memory_table(memory_.snapshot());
   }
 
 private:
+  // The user's callback, plus forwarding to local subscribers and
+  // republisher clients when enabled
+  TickCallback processor_callback() {
+    if (!distribution_ && !republisher_) {
+      return callback_;
+    }
+    return [this, user = callback_](const Tick& tick) {
+      if (forwarding_live_.load(std::memory_order_acquire)) {
+        DistributionEvent event;
+        memcpy(event.symbol, tick.symbol, strnlen(tick.symbol, sizeof(event.symbol)));
+        event.timestamp = tick.timestamp;
+        event.price = static_cast<float>(tick.price);
+        event.quantity = tick.volume;
+        forward(event);
+      }
+      if (user) {
+        user(tick);
+      }
+    };
+  }
+
+  // Processor thread. A full queue means the distribution or republisher
+  // thread is behind; the event is dropped rather than stalling the feed.
+  void forward(const DistributionEvent& event) {
+    if (distribution_) {
+      if (distribution_queue_->push(event)) {
+        distribution_wakeup_->notify();
+      } else {
+        distribution_overruns_++;
+      }
+    }
+    if (republisher_) {
+      republisher_->publish(event);
+    }
+  }
+
+  bool start_republisher() {
+    republisher_ = std::make_unique<TcpRepublisher>(config_.republish_config);
+    auto started = republisher_->start();
+    if (!started) {
+      LOG_ERROR("FeedHandler", "Republisher: %s", started.error().c_str());
+      republisher_.reset();
+      return false;
+    }
+    memory_.add("republisher", [this]() {
+      return MemoryUsage{republisher_->buffer_bytes(),
+                         republisher_->queued_events() * sizeof(DistributionEvent)};
+    });
+    LOG_INFO("FeedHandler", "Republishing on port %d (%s slow clients, max delay %lu us)",
+             republisher_->port(), slow_client_policy_name(config_.republish_config.policy),
+             static_cast<unsigned long>(config_.republish_config.max_delay_us));
+    return true;
+  }
+
+  // Once the processor has stopped: drain and stop both forwarding threads
+  void stop_forwarding() {
+    distribution_stop_ = true;
+    if (distribution_wakeup_) {
+      distribution_wakeup_->signal();
+    }
+    if (distribution_thread_.joinable()) {
+      distribution_thread_.join();
+    }
+    if (republisher_) {
+      republisher_->stop();
+    }
+  }
+
+  bool start_distribution() {
+    distribution_ = std::make_unique<DistributionServer>(config_.distribution_path);
+    auto listening = distribution_->listen();
+    if (!listening) {
+      LOG_ERROR("FeedHandler", "Distribution: %s", listening.error().c_str());
+      distribution_.reset();
+      return false;
+    }
+    distribution_queue_ = std::make_unique<SPSCQueue<DistributionEvent>>(
+        std::max<size_t>(config_.distribution_queue_size, 2));
+    distribution_wakeup_ = std::make_unique<ThreadWakeup>();
+    if (!distribution_wakeup_->ok()) {
+      LOG_ERROR("FeedHandler", "Distribution: wakeup fd failed: %s", strerror(errno));
+      distribution_.reset();
+      return false;
+    }
+    memory_.add("distribution", [this]() {
+      return MemoryUsage{distribution_queue_->storage_bytes() + distribution_->log_bytes(),
+                         distribution_queue_->size() * sizeof(DistributionEvent)};
+    });
+    distribution_stop_ = false;
+    distribution_thread_ = std::thread([this]() { run_distribution(); });
+    return true;
+  }
+
+  // Owns the DistributionServer: publishes queued events, accepts
+  // subscribers and flushes their rings, and sleeps when there is none of
+  // that to do (forward() wakes it). Exits once the processor has stopped
+  // and the queue is drained.
+  void run_distribution() {
+    constexpr size_t BATCH = 1024;
+    constexpr int IDLE_WAIT_MS = 100;  // Upper bound; events and sockets wake it sooner
+    while (true) {
+      bool stopping = distribution_stop_.load(std::memory_order_acquire);
+      size_t published = 0;
+      while (published < BATCH) {
+        auto event = distribution_queue_->pop();
+        if (!event) break;
+        distribution_->publish(*event);
+        published++;
+      }
+      distribution_->poll();
+      if (stopping && published == 0) {
+        break;
+      }
+      if (published == 0) {
+        distribution_wakeup_->prepare_wait();
+        if (distribution_queue_->empty() && !distribution_stop_.load(std::memory_order_acquire)) {
+          distribution_->wait(IDLE_WAIT_MS, distribution_wakeup_->fd());
+        }
+        distribution_wakeup_->finish_wait();
+      }
+    }
+  }
+
+  /**
+   * Prime the hot path before live data arrives.
+   *
+   * Runs on the caller's thread with the processor already running: the
+   * queue storage is prefaulted (and mlocked if configured), then synthetic
+   * frames in the configured wire format go through a throwaway reader's
+   * parse path, the real queue, and the real processor callback until the
+   * message count or time budget runs out. Once the processor has drained
+   * the queue the warm-up callback discards the results and processor stats
+   * are reset so they only describe live traffic.
+   */
+  void run_warmup() {
+    const WarmupConfig& wc = config_.warmup_config;
+    const uint64_t start = now_ns();
+    const uint64_t deadline = start + static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(wc.budget).count());
+
+    warmup_report_ = WarmupReport{};
+
+    auto locked = prefault_memory(queue_.storage(), queue_.storage_bytes(), wc.lock_memory);
+    warmup_report_.memory_locked = wc.lock_memory && locked.ok();
+    if (!locked) {
+      LOG_WARN("Warmup", "%s (queue prefaulted but not locked)", locked.error().c_str());
+    }
+
+    std::vector<std::string> symbols = wc.symbols;
+    if (symbols.empty()) {
+      symbols = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA"};
+    }
+
+    // Throwaway reader state, same code path as the live reader
+    std::atomic<bool> warmup_stop{false};
+    StageMonitor warmup_monitor;
+    TextProtocolReader text_reader(-1, queue_, warmup_stop, false, warmup_monitor);
+    BinaryProtocolReader binary_reader(-1, queue_, warmup_stop, false, warmup_monitor);
+
+    constexpr size_t BATCH = 256;
+    std::string frames;
+    frames.reserve(BATCH * 64);
+    uint64_t sequence = 0;
+    uint64_t generated = 0;
+
+    while (generated < wc.max_messages) {
+      if (now_ns() >= deadline) {
+        warmup_report_.budget_exhausted = true;
+        break;
+      }
+
+      frames.clear();
+      for (size_t i = 0; i < BATCH; ++i) {
+        const std::string& sym = symbols[sequence % symbols.size()];
+        // Walk prices around a level and send some zero-volume removals so
+        // both book branches get trained
+        float price = 100.0f + static_cast<float>(sequence % 64) * 0.01f;
+        int32_t volume = (sequence % 8 == 7) ? 0 : static_cast<int32_t>(100 + sequence % 900);
+
+        if (config_.protocol == Protocol::BINARY) {
+          char sym4[4] = {0, 0, 0, 0};
+          std::memcpy(sym4, sym.data(), std::min<size_t>(sym.size(), 4));
+          frames += serialize_tick(++sequence, now_ns(), sym4, price, volume);
+        } else {
+          frames += serialize_text_tick(now_ns(), sym.c_str(), price, volume);
+          ++sequence;
+        }
+      }
+
+      uint64_t recv_ts = now_ns();
+      if (config_.protocol == Protocol::BINARY) {
+        binary_reader.parse_frames(frames.data(), frames.size(), recv_ts);
+      } else {
+        text_reader.parse_chunk(frames.data(), frames.size(), recv_ts);
+      }
+      generated += BATCH;
+    }
+
+    // Only what the readers queued reaches the processor: lines they reject
+    // (parse errors, over-long symbols) never count
+    warmup_report_.messages = text_reader.messages_parsed() + binary_reader.messages_parsed();
+
+    // Wait until every synthetic tick has been through the callback. The
+    // acquire load pairs with the processor's release store, so the callback's
+    // writes are visible here. Rejected lines were never queued, so the count
+    // is reachable; the handler must not go live with synthetic book state.
+    while (processor_->messages_processed() < warmup_report_.messages) {
+      std::this_thread::yield();
+    }
+
+    if (warmup_complete_callback_) {
+      warmup_complete_callback_();
+    }
+    processor_->reset_stats();
+
+    warmup_report_.duration_ns = now_ns() - start;
+    if (config_.verbose) {
+      std::cout << "[Warmup] " << warmup_report_.messages << " synthetic msgs in "
+                << format_duration_ns(warmup_report_.duration_ns) << std::endl;
+    }
+  }
+
   void update_stats() {
     if (text_reader_) {
       messages_parsed_ = text_reader_->messages_parsed();
       parse_errors_ = text_reader_->parse_errors();
+      messages_filtered_ = text_reader_->messages_filtered();
     } else if (binary_reader_) {
       messages_parsed_ = binary_reader_->messages_parsed();
       parse_errors_ = binary_reader_->parse_errors();
+      messages_filtered_ = binary_reader_->messages_filtered();
     }
   }
 
@@ -511,21 +1239,42 @@ private:
   std::atomic<bool> should_stop_;
   std::atomic<bool> running_;
 
+  // Declared before the stages that reference them
+  StageMonitor reader_monitor_;
+  StageMonitor processor_monitor_;
+  Subscription subscription_;
+  MemoryRegistry memory_;
+  MemoryAccount latency_memory_;  // Written by the processor
+
   std::unique_ptr<Connection> connection_;
   std::unique_ptr<TextProtocolReader> text_reader_;
   std::unique_ptr<BinaryProtocolReader> binary_reader_;
   std::unique_ptr<TickProcessor> processor_;
+  std::unique_ptr<StallWatchdog> watchdog_;
+  std::unique_ptr<DistributionServer> distribution_;
+  std::unique_ptr<SPSCQueue<DistributionEvent>> distribution_queue_;
+  std::unique_ptr<ThreadWakeup> distribution_wakeup_;  // forward() -> distribution thread
+  std::atomic<bool> distribution_stop_{false};
+  uint64_t distribution_overruns_ = 0;  // Processor thread
+  std::unique_ptr<TcpRepublisher> republisher_;
+  std::atomic<bool> forwarding_live_{false};  // Distribution and republisher
 
   std::thread reader_thread_;
   std::thread processor_thread_;
+  std::thread distribution_thread_;
 
   TickCallback callback_;
+  BatchCallback batch_callback_;
+  size_t max_batch_ = TickProcessor::DEFAULT_MAX_BATCH;
+  std::function<void()> warmup_complete_callback_;
+  WarmupReport warmup_report_;
 
   std::chrono::steady_clock::time_point start_time_;
   std::chrono::steady_clock::time_point end_time_;
 
   uint64_t messages_parsed_;
   uint64_t parse_errors_;
+  uint64_t messages_filtered_ = 0;
 };
 
 //=============================================================================
@@ -539,6 +1288,20 @@ public:
     handler_.set_tick_callback([this](const Tick& tick) {
       on_tick(tick);
     });
+
+    // Preallocate books for the known universe so live ticks don't pay for
+    // hash table growth or node allocation on first sight of a symbol
+    const auto& universe = config_.warmup_config.symbols;
+    books_.reserve(std::max<size_t>(universe.size() * 2, 16));
+    for (const auto& symbol : universe) {
+      get_or_create_book(book_key(symbol));
+    }
+    update_books_memory();
+    handler_.memory().add("books", books_memory_);
+
+    if (config_.warmup) {
+      handler_.set_warmup_complete_callback([this]() { discard_warmup_books(); });
+    }
   }
 
   bool start() { return handler_.start(); }
@@ -546,8 +1309,19 @@ public:
   void stop() { handler_.stop(); }
   bool is_running() const { return handler_.is_running(); }
 
+  void subscribe(const std::vector<std::string>& symbols) { handler_.subscribe(symbols); }
+  void subscribe_all() { handler_.subscribe_all(); }
+
+  // Runs after the run's ticks are applied to the books, so book reads
+  // from inside it see them. Set before start().
+  void set_batch_callback(BatchCallback callback,
+                          size_t max_batch = TickProcessor::DEFAULT_MAX_BATCH) {
+    handler_.set_batch_callback(callback, max_batch);
+  }
+
   void print_stats() const {
     handler_.print_stats();
+    print_symbol_memory(largest_symbols(symbol_memory(), 10), books_.size());
     print_books();
   }
 
@@ -558,13 +1332,69 @@ public:
     }
   }
 
+  // Owned by the processor thread: read from its callbacks, or once stopped
   const std::unordered_map<std::string, OrderBook>& books() const { return books_; }
+  const OrderBook* book(const std::string& symbol) const {
+    auto it = books_.find(book_key(symbol));
+    return it == books_.end() ? nullptr : &it->second;
+  }
+  const FeedHandler& handler() const { return handler_; }
+  MemoryRegistry& memory() { return handler_.memory(); }
+
+  // Estimated heap behind each book; same threading rule as books()
+  std::vector<SymbolMemory> symbol_memory() const {
+    std::vector<SymbolMemory> out;
+    out.reserve(books_.size());
+    for (const auto& [symbol, book] : books_) {
+      out.push_back(SymbolMemory{symbol, book.level_count(), book_bytes(book)});
+    }
+    return out;
+  }
 
 private:
+  // Books are keyed the way ticks arrive: binary symbols are 4 bytes
+  std::string book_key(const std::string& symbol) const {
+    return config_.protocol == Protocol::BINARY ? symbol.substr(0, 4) : symbol;
+  }
+
+  // Every book touched during warm-up holds synthetic levels. Universe books
+  // are kept (emptied) so their hash slots stay allocated; anything else the
+  // warm-up created is dropped.
+  void discard_warmup_books() {
+    std::unordered_set<std::string> keep;
+    for (const auto& symbol : config_.warmup_config.symbols) {
+      keep.insert(book_key(symbol));
+    }
+    for (auto it = books_.begin(); it != books_.end();) {
+      if (keep.count(it->first)) {
+        it->second.clear();
+        ++it;
+      } else {
+        it = books_.erase(it);
+      }
+    }
+    book_levels_ = 0;
+    update_books_memory();
+  }
+
+  // Processor thread. The level count is kept as a running total so a tick
+  // costs two stores here, not a walk over every book.
+  void update_books_memory() {
+    using BookNode = std::pair<const std::string, OrderBook>;
+    uint64_t in_use = books_.size() * hash_node_bytes<BookNode>() +
+                      book_levels_ * tree_node_bytes<OrderBook::Levels::value_type>();
+    books_memory_.set(in_use + heap_block_bytes(books_.bucket_count() * sizeof(void*)), in_use);
+  }
+
   void on_tick(const Tick& tick) {
     std::string symbol(tick.symbol);
     auto& book = get_or_create_book(symbol);
+    const size_t levels_before = book.level_count();
     book.apply_update(0, static_cast<float>(tick.price), tick.volume);
+    book_levels_ += book.level_count() - levels_before;
+    update_books_memory();
+    FEED_TRACE(book_update, tick.symbol, symbol.size(), uint8_t{0}, tick.volume);
+    handler_.distribute_book_update(tick.symbol, 0, static_cast<float>(tick.price), tick.volume);
   }
 
   OrderBook& get_or_create_book(const std::string& symbol) {
@@ -576,10 +1406,59 @@ private:
   }
 
   FeedConfig config_;
+  MemoryAccount books_memory_;  // Registered with handler_, so declared first
   FeedHandler handler_;
   std::unordered_map<std::string, OrderBook> books_;
+  size_t book_levels_ = 0;  // Across all books
 };
 
+//=============================================================================
+// Memory Planning
+//=============================================================================
+
+/**
+ * Peak memory a handler with `config` will need once it tracks `symbols`
+ * books `depth` levels deep on each side, without connecting to anything.
+ * Each entry's reserved and in_use are both the peak: queues full, every
+ * level present. Latency samples are counted at their initial reserve;
+ * past that many messages the vector doubles.
+ */
+inline std::vector<ComponentMemory> plan_memory(const FeedConfig& config, size_t symbols,
+                                                size_t depth) {
+  std::vector<ComponentMemory> plan;
+  auto add = [&plan](const char* name, uint64_t bytes) {
+    plan.push_back(ComponentMemory{name, MemoryUsage{bytes, bytes}});
+  };
+
+  add("tick_queue", SPSCQueue<Tick>::storage_bytes_for(config.queue_size));
+  add("reader_buffers", config.protocol == Protocol::TEXT ? TextProtocolReader::BUFFER_BYTES
+                                                          : BinaryProtocolReader::BUFFER_BYTES);
+  add("latency_samples",
+      heap_block_bytes(TickProcessor::LATENCY_RESERVE * sizeof(uint64_t)));
+  if (!config.distribution_path.empty()) {
+    add("distribution",
+        SPSCQueue<DistributionEvent>::storage_bytes_for(
+            std::max<size_t>(config.distribution_queue_size, 2)) +
+            DistributionServer::DEFAULT_LOG_BYTES);
+  }
+  if (config.republish) {
+    const RepublisherConfig& rc = config.republish_config;
+    add("republisher",
+        SPSCQueue<DistributionEvent>::storage_bytes_for(std::max<size_t>(rc.event_queue_size, 2)) +
+            std::max<size_t>(std::max(rc.log_bytes, 2 * rc.client_queue_bytes), 4096));
+  }
+
+  // Same table BookUpdatingFeedHandler builds: buckets for the larger of
+  // the reserve and the symbol count, a node per symbol, a node per level
+  using BookNode = std::pair<const std::string, OrderBook>;
+  const size_t buckets =
+      std::max({symbols, config.warmup_config.symbols.size() * 2, size_t{16}});
+  add("books", heap_block_bytes(buckets * sizeof(void*)) +
+                   symbols * hash_node_bytes<BookNode>() +
+                   symbols * depth * 2 * tree_node_bytes<OrderBook::Levels::value_type>());
+  return plan;
+}
+
 } // namespace net
 
 #endif // NET_FEED_HPP
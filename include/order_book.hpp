@@ -10,12 +10,16 @@
 
 class OrderBook {
 public:
+  // Price -> quantity, one side
+  using Levels = std::map<float, uint64_t>;
+
   OrderBook() = default;
   
   // Clear the book (for snapshot replacement)
   void clear() {
     bids_.clear();
     asks_.clear();
+    checksum_ = 0;
   }
   
   // Load snapshot data
@@ -25,16 +29,23 @@ public:
     
     for (const auto& level : bids) {
       if (level.quantity > 0) {
-        bids_[level.price] = level.quantity;
+        set_level(0, bids_, level.price, level.quantity);
       }
     }
     
     for (const auto& level : asks) {
       if (level.quantity > 0) {
-        asks_[level.price] = level.quantity;
+        set_level(1, asks_, level.price, level.quantity);
       }
     }
   }
+
+  // Add one snapshot level (chunked snapshots load level by level after clear())
+  void add_level(uint8_t side, float price, uint64_t quantity) {
+    if (quantity > 0) {
+      set_level(side == 0 ? 0 : 1, side == 0 ? bids_ : asks_, price, quantity);
+    }
+  }
   
   // Apply incremental update
   void apply_update(uint8_t side, float price, int64_t quantity) {
@@ -42,10 +53,14 @@ public:
     
     if (quantity == 0) {
       // Delete level
-      book_side.erase(price);
+      auto it = book_side.find(price);
+      if (it != book_side.end()) {
+        checksum_ -= book_level_checksum(side == 0 ? 0 : 1, price, it->second);
+        book_side.erase(it);
+      }
     } else if (quantity > 0) {
       // Add or update level
-      book_side[price] = static_cast<uint64_t>(quantity);
+      set_level(side == 0 ? 0 : 1, book_side, price, static_cast<uint64_t>(quantity));
     } else {
       // Negative quantity is invalid
       std::cerr << "[OrderBook] Invalid quantity: " << quantity << std::endl;
@@ -96,9 +111,46 @@ public:
     return result;
   }
   
+  // Top N levels into caller storage, without allocating; returns the count
+  size_t copy_top_bids(OrderBookLevel* out, size_t n) const {
+    return for_each_top_bid(n, [&](size_t i, float price, uint64_t quantity) {
+      out[i] = {price, quantity};
+    });
+  }
+
+  size_t copy_top_asks(OrderBookLevel* out, size_t n) const {
+    return for_each_top_ask(n, [&](size_t i, float price, uint64_t quantity) {
+      out[i] = {price, quantity};
+    });
+  }
+
+  // f(index, price, quantity) for the top N levels, best first; returns the count
+  template <typename F>
+  size_t for_each_top_bid(size_t n, F&& f) const {
+    size_t count = 0;
+    for (auto it = bids_.rbegin(); count < n && it != bids_.rend(); ++it, ++count) {
+      f(count, it->first, it->second);
+    }
+    return count;
+  }
+
+  template <typename F>
+  size_t for_each_top_ask(size_t n, F&& f) const {
+    size_t count = 0;
+    for (auto it = asks_.begin(); count < n && it != asks_.end(); ++it, ++count) {
+      f(count, it->first, it->second);
+    }
+    return count;
+  }
+
+  // Order-independent checksum of all levels, maintained on every change
+  // (see book_level_checksum); 0 for an empty book
+  uint64_t checksum() const { return checksum_; }
+
   // Get depth
   size_t bid_depth() const { return bids_.size(); }
   size_t ask_depth() const { return asks_.size(); }
+  size_t level_count() const { return bids_.size() + asks_.size(); }
   bool empty() const { return bids_.empty() && asks_.empty(); }
   
   // Print top of book
@@ -157,11 +209,22 @@ public:
   }
   
 private:
+  void set_level(uint8_t side, Levels& book_side, float price,
+                 uint64_t quantity) {
+    auto [it, inserted] = book_side.try_emplace(price, quantity);
+    if (!inserted) {
+      checksum_ -= book_level_checksum(side, price, it->second);
+      it->second = quantity;
+    }
+    checksum_ += book_level_checksum(side, price, quantity);
+  }
+
   // Price -> Quantity
   // Bids: higher price is better (use reverse iterator)
   // Asks: lower price is better (use forward iterator)
-  std::map<float, uint64_t> bids_;
-  std::map<float, uint64_t> asks_;
+  Levels bids_;
+  Levels asks_;
+  uint64_t checksum_ = 0;
 };
 
 #endif // ORDER_BOOK_HPP
@@ -0,0 +1,400 @@
+#ifndef PARALLEL_RECOVERY_HPP
+#define PARALLEL_RECOVERY_HPP
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "order_book.hpp"
+#include "ring_buffer.hpp"
+#include "spsc_queue.hpp"
+
+/**
+ * Parallel Full-Universe Snapshot Recovery
+ *
+ * Rebuilds every book a publisher has as fast as the machine allows, e.g. on
+ * reconnect at market open. Snapshots come from a snapshot channel (a
+ * separate port that only serves snapshots and closes once it's done) over
+ * one or more connections, and are loaded by a set of book shard threads:
+ *
+ *   connection threads - one per connection; each asks for one partition of
+ *                        the universe (PARTITION_SNAPSHOT_REQUEST, or "ALL"
+ *                        over a single connection), frames messages and
+ *                        routes them by symbol. Nothing past the symbol is
+ *                        decoded here.
+ *   shard threads      - shard i owns every book with
+ *                        symbol_partition(symbol, shards) == i; it decodes the
+ *                        chunks, builds the book and checks SNAPSHOT_END's
+ *                        checksum.
+ *
+ * Each (connection, shard) pair has its own SPSC queue, so no queue has more
+ * than one producer. While recovery runs, the caller collects finished books
+ * with take_completed() and installs them in its own books, replaying any
+ * live updates it buffered since each snapshot's sequence. Books that failed
+ * (lost chunk, checksum mismatch) come back from take_failed() and need a
+ * snapshot of their own.
+ *
+ * Usage:
+ *   ParallelSnapshotRecovery recovery(4, 2);    // 4 shard threads, 2 connections
+ *   recovery.start("127.0.0.1", snapshot_port);
+ *   while (!recovery.finished()) {
+ *     for (auto &book : recovery.take_completed()) install(book);
+ *   }
+ *   for (auto &book : recovery.take_completed()) install(book);
+ *   recovery.join();
+ */
+
+struct RecoveredBook {
+  std::string symbol;
+  OrderBook book;
+  uint64_t sequence;  // Last live sequence the snapshot reflects
+};
+
+class ParallelSnapshotRecovery {
+public:
+  static constexpr size_t QUEUE_CAPACITY = 1024;  // Messages per (connection, shard)
+
+  ParallelSnapshotRecovery(size_t shards, size_t connections)
+      : shards_(std::max<size_t>(shards, 1)),
+        connections_(std::max<size_t>(connections, 1)) {
+    for (auto &shard : shards_) {
+      for (size_t c = 0; c < connections_.size(); ++c) {
+        shard.inbound.push_back(std::make_unique<SPSCQueue<std::string>>(QUEUE_CAPACITY));
+      }
+    }
+  }
+
+  ~ParallelSnapshotRecovery() {
+    stop_ = true;
+    for (auto &connection : connections_) {
+      if (connection.fd >= 0) shutdown(connection.fd, SHUT_RDWR);  // Unblock recv
+    }
+    join();
+  }
+
+  ParallelSnapshotRecovery(const ParallelSnapshotRecovery &) = delete;
+  ParallelSnapshotRecovery &operator=(const ParallelSnapshotRecovery &) = delete;
+
+  // Connect every snapshot connection and send its request, then start the
+  // threads. On error nothing is left running.
+  Result<void> start(const std::string &host, int port) {
+    started_ns_ = now_ns();
+
+    for (size_t c = 0; c < connections_.size(); ++c) {
+      auto fd = connect_to(host, port);
+      if (!fd) {
+        close_connections();
+        return Result<void>::error(fd.error());
+      }
+      connections_[c].fd = fd.value();
+
+      std::string request;
+      if (connections_.size() == 1) {
+        request = serialize_snapshot_request(0, "ALL");
+      } else {
+        request = serialize_partition_snapshot_request(0, static_cast<uint16_t>(c),
+                                                       static_cast<uint16_t>(connections_.size()));
+      }
+      if (send(connections_[c].fd, request.data(), request.size(), 0) !=
+          static_cast<ssize_t>(request.size())) {
+        std::string err = strerror(errno);
+        close_connections();
+        return Result<void>::error("snapshot request failed: " + err);
+      }
+    }
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      shards_[s].thread = std::thread([this, s] { run_shard(s); });
+    }
+    for (size_t c = 0; c < connections_.size(); ++c) {
+      connections_[c].thread = std::thread([this, c] { run_connection(c); });
+    }
+    return Result<void>();
+  }
+
+  // Every connection closed and every shard done with its queues
+  bool finished() const {
+    return shards_done_.load(std::memory_order_acquire) == shards_.size();
+  }
+
+  std::vector<RecoveredBook> take_completed() {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    std::vector<RecoveredBook> result;
+    result.swap(completed_);
+    return result;
+  }
+
+  std::vector<std::string> take_failed() {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    std::vector<std::string> result;
+    result.swap(failed_);
+    return result;
+  }
+
+  void join() {
+    for (auto &connection : connections_) {
+      if (connection.thread.joinable()) connection.thread.join();
+    }
+    for (auto &shard : shards_) {
+      if (shard.thread.joinable()) shard.thread.join();
+    }
+    close_connections();
+  }
+
+  size_t shard_count() const { return shards_.size(); }
+  size_t connection_count() const { return connections_.size(); }
+
+  // Statistics below are valid once finished()
+
+  // start() until the last shard finished
+  uint64_t elapsed_ns() const {
+    uint64_t last = started_ns_;
+    for (const auto &shard : shards_) last = std::max(last, shard.finished_ns);
+    return last - started_ns_;
+  }
+  size_t books_recovered() const {
+    size_t total = 0;
+    for (const auto &shard : shards_) total += shard.books_recovered;
+    return total;
+  }
+  size_t levels_recovered() const {
+    size_t total = 0;
+    for (const auto &shard : shards_) total += shard.levels_recovered;
+    return total;
+  }
+  size_t books_on_shard(size_t shard) const { return shards_[shard].books_recovered; }
+  uint64_t bytes_received() const {
+    uint64_t total = 0;
+    for (const auto &connection : connections_) total += connection.bytes_received;
+    return total;
+  }
+  // Connections that ended on a socket or framing error rather than the
+  // channel closing
+  size_t connection_errors() const { return connection_errors_.load(); }
+
+private:
+  // A book being loaded on a shard
+  struct PartialBook {
+    OrderBook book;
+    uint64_t sequence = 0;
+    uint32_t id = 0;
+    uint32_t next_chunk = 0;
+    size_t levels = 0;
+  };
+
+  struct Shard {
+    std::vector<std::unique_ptr<SPSCQueue<std::string>>> inbound; // One per connection
+    std::unordered_map<std::string, PartialBook> partial;
+    std::thread thread;
+    size_t books_recovered = 0;
+    size_t levels_recovered = 0;
+    uint64_t finished_ns = 0;
+  };
+
+  struct Connection {
+    int fd = -1;
+    std::thread thread;
+    uint64_t bytes_received = 0;
+  };
+
+  static Result<int> connect_to(const std::string &host, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return Result<int>::error(std::string("socket failed: ") + strerror(errno));
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+      close(fd);
+      return Result<int>::error("invalid address: " + host);
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+      std::string err = strerror(errno);
+      close(fd);
+      return Result<int>::error("snapshot channel " + host + ":" + std::to_string(port) +
+                                " connect failed: " + err);
+    }
+    return fd;
+  }
+
+  void close_connections() {
+    for (auto &connection : connections_) {
+      if (connection.fd >= 0) {
+        close(connection.fd);
+        connection.fd = -1;
+      }
+    }
+  }
+
+  // Frame messages and hand each to the shard that owns its symbol. Every
+  // snapshot message's payload starts with the symbol.
+  void run_connection(size_t index) {
+    Connection &connection = connections_[index];
+    auto buffer = std::make_unique<RingBuffer>();
+    bool stop_reading = false;
+
+    while (!stop_ && !stop_reading) {
+      auto [write_ptr, write_space] = buffer->get_write_ptr();
+      ssize_t n = recv(connection.fd, write_ptr, write_space, 0);
+      if (n <= 0) {
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) connection_errors_++;
+        break;  // Channel closes once our partition is sent
+      }
+      buffer->commit_write(n);
+      connection.bytes_received += n;
+
+      while (buffer->available() >= MessageHeader::HEADER_SIZE + 4) {
+        char header_bytes[MessageHeader::HEADER_SIZE + 4];
+        buffer->peek_bytes(header_bytes, sizeof(header_bytes));
+        MessageHeader header = deserialize_header(header_bytes);
+        if (header.length < 4 || header.length > MessageHeader::MAX_PAYLOAD_SIZE) {
+          // Framing is lost; books still loading from here fail in run_shard
+          connection_errors_++;
+          stop_reading = true;
+          break;
+        }
+        size_t total_size = MessageHeader::HEADER_SIZE + header.length;
+        if (buffer->available() < total_size) {
+          break;
+        }
+
+        std::string message(total_size, '\0');
+        buffer->read_bytes(message.data(), total_size);
+        uint32_t shard = symbol_partition(header_bytes + MessageHeader::HEADER_SIZE,
+                                          static_cast<uint32_t>(shards_.size()));
+        auto &queue = *shards_[shard].inbound[index];
+        while (!queue.push(std::move(message)) && !stop_) {
+          std::this_thread::yield();  // Shard is behind
+        }
+      }
+    }
+
+    // Release: everything pushed above is visible to a shard that sees this
+    connections_done_.fetch_add(1, std::memory_order_release);
+  }
+
+  void run_shard(size_t index) {
+    Shard &shard = shards_[index];
+
+    while (!stop_) {
+      bool producers_done =
+          connections_done_.load(std::memory_order_acquire) == connections_.size();
+      bool worked = false;
+      for (auto &queue : shard.inbound) {
+        while (auto message = queue->pop()) {
+          handle_message(shard, *message);
+          worked = true;
+        }
+      }
+      if (!worked) {
+        if (producers_done) break;  // Queues were drained after the last push
+        std::this_thread::yield();
+      }
+    }
+
+    // Books a connection never finished (it closed early) can't complete
+    for (auto &[symbol, partial] : shard.partial) {
+      fail(symbol);
+    }
+    shard.partial.clear();
+
+    shard.finished_ns = now_ns();
+    shards_done_.fetch_add(1, std::memory_order_release);
+  }
+
+  void handle_message(Shard &shard, const std::string &message) {
+    MessageHeader header = deserialize_header(message.data());
+    const char *payload = message.data() + MessageHeader::HEADER_SIZE;
+
+    switch (header.type) {
+    case MessageType::SNAPSHOT_BEGIN: {
+      SnapshotBeginPayload begin = deserialize_snapshot_begin(payload);
+      PartialBook &partial = shard.partial[trim_symbol(begin.symbol, 4)];
+      partial = PartialBook{};
+      partial.sequence = header.sequence;
+      partial.id = begin.snapshot_id;
+      break;
+    }
+    case MessageType::SNAPSHOT_CHUNK: {
+      SnapshotChunkPayload chunk;
+      bool valid = decode_snapshot_chunk(payload, header.length, chunk);
+      if (header.length < SnapshotChunkPayload::HEADER_SIZE) {
+        break;  // Whoever it belonged to fails at SNAPSHOT_END
+      }
+      auto it = shard.partial.find(trim_symbol(chunk.symbol, 4));
+      if (it == shard.partial.end()) {
+        break;
+      }
+      PartialBook &partial = it->second;
+      if (!valid || chunk.snapshot_id != partial.id || chunk.chunk_index != partial.next_chunk) {
+        fail(it->first);
+        shard.partial.erase(it);
+        break;
+      }
+      for (uint16_t i = 0; i < chunk.num_levels; ++i) {
+        OrderBookLevel level = deserialize_snapshot_level(payload, i);
+        partial.book.add_level(chunk.side, level.price, level.quantity);
+      }
+      partial.levels += chunk.num_levels;
+      partial.next_chunk++;
+      break;
+    }
+    case MessageType::SNAPSHOT_END: {
+      SnapshotEndPayload end = deserialize_snapshot_end(payload);
+      auto it = shard.partial.find(trim_symbol(end.symbol, 4));
+      if (it == shard.partial.end()) {
+        break;
+      }
+      PartialBook &partial = it->second;
+      if (end.snapshot_id != partial.id || end.num_chunks != partial.next_chunk ||
+          end.checksum != partial.book.checksum()) {
+        fail(it->first);
+      } else {
+        shard.books_recovered++;
+        shard.levels_recovered += partial.levels;
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        completed_.push_back({it->first, std::move(partial.book), partial.sequence});
+      }
+      shard.partial.erase(it);
+      break;
+    }
+    default:
+      break;  // The channel carries nothing else
+    }
+  }
+
+  void fail(const std::string &symbol) {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    failed_.push_back(symbol);
+  }
+
+  std::vector<Shard> shards_;
+  std::vector<Connection> connections_;
+  std::atomic<bool> stop_{false};
+  std::atomic<size_t> connections_done_{0};
+  std::atomic<size_t> shards_done_{0};
+  std::atomic<size_t> connection_errors_{0};
+  uint64_t started_ns_ = 0;
+
+  std::mutex results_mutex_;
+  std::vector<RecoveredBook> completed_;
+  std::vector<std::string> failed_;
+};
+
+#endif // PARALLEL_RECOVERY_HPP
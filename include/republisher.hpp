@@ -0,0 +1,620 @@
+#ifndef REPUBLISHER_HPP
+#define REPUBLISHER_HPP
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#else
+#include <poll.h>
+#endif
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "distribution.hpp"
+#include "frame_fanout.hpp"
+#include "spsc_queue.hpp"
+
+/**
+ * TCP Republisher
+ *
+ * Serves the feed handler's normalized stream to consumers on other hosts.
+ * Clients connect over TCP and receive every event as a binary protocol
+ * frame (TICK and ORDER_BOOK_UPDATE, the exchange feed's layout), so any
+ * binary protocol consumer - binary_client included - can read it. The
+ * header sequence is the republisher's event number, consecutive for a
+ * client that misses nothing.
+ *
+ * Threading: publish() only pushes onto an SPSC queue and never blocks; a
+ * full queue counts an overrun and drops the event. A dedicated thread
+ * owns the sockets: it encodes each event once into a shared frame log
+ * (frame_fanout.hpp), queues a reference per client, and runs an epoll
+ * loop for accepts, hangups and writability.
+ *
+ * Coalescing: a client's frames are held until it has batch_bytes queued
+ * or its oldest unsent frame is max_delay_us old, then go out in one
+ * gathering sendmsg() (writev-style, straight from the log). max_delay_us
+ * = 0 sends on every loop pass.
+ *
+ * Idle: with no events queued the thread sleeps in epoll_wait until the
+ * next client's max_delay_us deadline, a socket event, or publish() waking
+ * it (an eventfd, signalled only while the thread sleeps). busy_poll
+ * keeps it spinning instead, trading a core for the wake-up latency.
+ *
+ * Slow clients: each client may have at most client_queue_bytes unsent.
+ * Beyond that the policy decides:
+ *   DISCONNECT  Close the client; it reconnects and resyncs
+ *   DROP        Skip frames until it catches up; it sees sequence gaps
+ * Either way, a client whose oldest unsent frame is about to be overwritten
+ * in the log (it stopped reading altogether) is disconnected.
+ *
+ * Usage:
+ *   RepublisherConfig config;
+ *   config.port = 7000;
+ *   TcpRepublisher republisher(config);
+ *   republisher.start();
+ *   republisher.publish(event);   // From one producer thread
+ *   republisher.stop();           // Drains, then closes every client
+ */
+
+enum class SlowClientPolicy {
+  DISCONNECT,
+  DROP
+};
+
+inline const char* slow_client_policy_name(SlowClientPolicy policy) {
+  return policy == SlowClientPolicy::DROP ? "drop" : "disconnect";
+}
+
+struct RepublisherConfig {
+  int port = 0;                              // 0 = ephemeral (see port())
+  uint64_t max_delay_us = 200;               // Oldest unsent frame age before a flush
+  size_t batch_bytes = 64 * 1024;            // Flush as soon as this much is queued
+  size_t client_queue_bytes = 1024 * 1024;   // Unsent bytes allowed per client
+  SlowClientPolicy policy = SlowClientPolicy::DISCONNECT;
+  size_t log_bytes = 16 * 1024 * 1024;       // Shared frame log
+  size_t event_queue_size = 64 * 1024;       // publish() -> republisher thread
+  uint64_t drain_timeout_ms = 1000;          // stop(): time allowed to flush clients
+  bool busy_poll = false;                    // Spin instead of sleeping when idle
+};
+
+namespace republisher_detail {
+
+// Readiness for the republisher thread: epoll on Linux, poll() elsewhere.
+// `tag` is handed back with each event.
+class Poller {
+public:
+  Poller() {
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(0);
+    // epoll_wait counts in milliseconds; shorter sleeps go through a timer
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epoll_fd_ >= 0 && timer_fd_ >= 0) {
+      epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.ptr = &timer_fd_;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev);
+    }
+#endif
+  }
+
+  ~Poller() {
+#ifdef __linux__
+    if (timer_fd_ >= 0) {
+      close(timer_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+      close(epoll_fd_);
+    }
+#endif
+  }
+
+  Poller(const Poller&) = delete;
+  Poller& operator=(const Poller&) = delete;
+
+  bool ok() const {
+#ifdef __linux__
+    return epoll_fd_ >= 0 && timer_fd_ >= 0;
+#else
+    return true;
+#endif
+  }
+
+  void add(int fd, void* tag) {
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = tag;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+#else
+    fds_.push_back({fd, POLLIN, 0});
+    tags_.push_back(tag);
+#endif
+  }
+
+  // Also report writability (only while a client is blocked)
+  void set_writable(int fd, void* tag, bool writable) {
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = writable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.ptr = tag;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+#else
+    (void)tag;
+    for (auto& p : fds_) {
+      if (p.fd == fd) {
+        p.events = POLLIN | (writable ? POLLOUT : 0);
+      }
+    }
+#endif
+  }
+
+  void remove(int fd) {
+#ifdef __linux__
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    for (size_t i = 0; i < fds_.size(); ++i) {
+      if (fds_[i].fd == fd) {
+        fds_[i] = fds_.back();
+        tags_[i] = tags_.back();
+        fds_.pop_back();
+        tags_.pop_back();
+        break;
+      }
+    }
+#endif
+  }
+
+  // Wait up to timeout_us (-1 = until an event) and call
+  // handler(tag, readable, writable); errors and hangups count as readable
+  template <typename Handler>
+  void wait(int64_t timeout_us, Handler&& handler) {
+#ifdef __linux__
+    int timeout_ms = timeout_us < 0 ? -1 : static_cast<int>(timeout_us / 1000);
+    const bool timed = timeout_us > 0 && timeout_us % 1000 != 0;
+    if (timed) {
+      itimerspec spec{};
+      spec.it_value.tv_sec = timeout_us / 1'000'000;
+      spec.it_value.tv_nsec = (timeout_us % 1'000'000) * 1000;
+      timerfd_settime(timer_fd_, 0, &spec, nullptr);
+      timeout_ms = -1;
+    }
+    epoll_event events[64];
+    int n = epoll_wait(epoll_fd_, events, 64, timeout_ms);
+    if (timed) {
+      itimerspec disarm{};
+      timerfd_settime(timer_fd_, 0, &disarm, nullptr);
+      uint64_t expirations;
+      if (read(timer_fd_, &expirations, sizeof(expirations)) < 0) {
+        // Woken by something else first
+      }
+    }
+    for (int i = 0; i < n; ++i) {
+      if (events[i].data.ptr == &timer_fd_) {
+        continue;
+      }
+      handler(events[i].data.ptr, (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0,
+              (events[i].events & EPOLLOUT) != 0);
+    }
+#else
+    int timeout_ms = timeout_us < 0 ? -1 : static_cast<int>((timeout_us + 999) / 1000);
+    if (::poll(fds_.data(), fds_.size(), timeout_ms) <= 0) {
+      return;
+    }
+    // The handler may remove entries; walk a snapshot
+    std::vector<std::pair<void*, short>> ready;
+    for (size_t i = 0; i < fds_.size(); ++i) {
+      if (fds_[i].revents != 0) {
+        ready.emplace_back(tags_[i], fds_[i].revents);
+      }
+    }
+    for (auto& [tag, revents] : ready) {
+      handler(tag, (revents & (POLLIN | POLLERR | POLLHUP)) != 0, (revents & POLLOUT) != 0);
+    }
+#endif
+  }
+
+private:
+#ifdef __linux__
+  int epoll_fd_ = -1;
+  int timer_fd_ = -1;
+#else
+  std::vector<pollfd> fds_;
+  std::vector<void*> tags_;
+#endif
+};
+
+} // namespace republisher_detail
+
+class TcpRepublisher {
+public:
+  // Smallest frame the republisher emits; sizes each client's frame ring
+  static constexpr size_t MIN_FRAME_BYTES = 32;
+  static constexpr size_t BATCH = 1024;  // Events taken off the queue per loop pass
+  // Longest idle sleep with nothing due; events and sockets wake it sooner
+  static constexpr int64_t IDLE_WAIT_US = 100'000;
+
+  explicit TcpRepublisher(const RepublisherConfig& config = {})
+      : config_(config),
+        events_(std::max<size_t>(config.event_queue_size, 2)),
+        log_(std::max(config.log_bytes, 2 * config.client_queue_bytes)),
+        batch_bytes_(std::min(config.batch_bytes, config.client_queue_bytes / 2)) {}
+
+  ~TcpRepublisher() {
+    stop();
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+    }
+  }
+
+  TcpRepublisher(const TcpRepublisher&) = delete;
+  TcpRepublisher& operator=(const TcpRepublisher&) = delete;
+
+  // Bind the port and start the republisher thread
+  Result<void> start() {
+    if (!poller_.ok() || !wakeup_.ok()) {
+      return Result<void>::error(std::string("epoll/timerfd/eventfd setup failed: ") +
+                                 strerror(errno));
+    }
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+      return Result<void>::error(std::string("socket failed: ") + strerror(errno));
+    }
+    int opt = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.port));
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+      std::string err = strerror(errno);
+      close(listen_fd_);
+      listen_fd_ = -1;
+      return Result<void>::error("bind/listen port " + std::to_string(config_.port) +
+                                 " failed: " + err);
+    }
+    port_ = ntohs(addr.sin_port);
+
+    auto nonblocking = socket_set_nonblocking(listen_fd_);
+    if (!nonblocking) {
+      return nonblocking;
+    }
+    poller_.add(listen_fd_, nullptr);
+    poller_.add(wakeup_.fd(), &wakeup_);
+
+    stop_ = false;
+    thread_ = std::thread([this]() { run(); });
+    return Result<void>();
+  }
+
+  // Flush what the clients take within drain_timeout_ms, then close them
+  void stop() {
+    stop_ = true;
+    wakeup_.signal();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  // Producer thread only. Never blocks: a full queue drops the event.
+  bool publish(const DistributionEvent& event) {
+    if (!events_.push(event)) {
+      overruns_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (!config_.busy_poll) {
+      wakeup_.notify();
+    }
+    return true;
+  }
+
+  int port() const { return port_; }
+  const RepublisherConfig& config() const { return config_; }
+
+  // Statistics (any thread)
+  uint64_t clients() const { return clients_.load(std::memory_order_relaxed); }
+  uint64_t clients_accepted() const { return clients_accepted_.load(std::memory_order_relaxed); }
+  uint64_t events_published() const { return events_published_.load(std::memory_order_relaxed); }
+  uint64_t frames_sent() const { return frames_sent_.load(std::memory_order_relaxed); }
+  uint64_t bytes_sent() const { return bytes_sent_.load(std::memory_order_relaxed); }
+  uint64_t batches() const { return batches_.load(std::memory_order_relaxed); }  // sendmsg() calls
+  uint64_t frames_dropped() const { return frames_dropped_.load(std::memory_order_relaxed); }
+  uint64_t slow_disconnects() const { return slow_disconnects_.load(std::memory_order_relaxed); }
+  uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+  // Event queue plus frame log, allocated up front (any thread)
+  size_t buffer_bytes() const { return events_.storage_bytes() + log_.size(); }
+  size_t queued_events() const { return events_.size(); }
+
+private:
+  struct Client {
+    int fd;
+    FrameQueue queue;
+    uint64_t pending_since_ns = 0;  // When the oldest unsent frame was queued
+    bool blocked = false;           // Socket full; waiting for writability
+    bool closed = false;
+
+    Client(int fd, size_t capacity) : fd(fd), queue(capacity) {}
+  };
+
+  void run() {
+    while (true) {
+      bool stopping = stop_.load(std::memory_order_acquire);
+      size_t published = 0;
+      while (published < BATCH) {
+        auto event = events_.pop();
+        if (!event) break;
+        route(*event);
+        published++;
+      }
+      if (stopping && published == 0) {
+        break;
+      }
+
+      auto ready = [this](void* tag, bool readable, bool writable) {
+        if (tag != &wakeup_) on_ready(static_cast<Client*>(tag), readable, writable);
+      };
+      if (published > 0 || config_.busy_poll) {
+        poller_.wait(0, ready);
+      } else {
+        wakeup_.prepare_wait();
+        bool idle = events_.empty() && !stop_.load(std::memory_order_acquire);
+        poller_.wait(idle ? idle_wait_us(now_ns()) : 0, ready);
+        wakeup_.finish_wait();
+      }
+      flush_due(now_ns(), false);
+      remove_closed();
+      if (published == 0 && config_.busy_poll) {
+        std::this_thread::yield();
+      }
+    }
+    drain();
+  }
+
+  // Until the earliest max_delay_us deadline among clients that can send
+  int64_t idle_wait_us(uint64_t now) const {
+    const uint64_t max_delay_ns = config_.max_delay_us * 1000;
+    int64_t wait_us = IDLE_WAIT_US;
+    for (const auto& client : clients_list_) {
+      if (client->closed || client->blocked || client->queue.empty()) {
+        continue;
+      }
+      uint64_t due = client->pending_since_ns + max_delay_ns;
+      if (due <= now) {
+        return 0;
+      }
+      wait_us = std::min<int64_t>(wait_us, static_cast<int64_t>((due - now + 999) / 1000));
+    }
+    return wait_us;
+  }
+
+  void route(const DistributionEvent& event) {
+    sequence_++;
+    events_published_.fetch_add(1, std::memory_order_relaxed);
+    if (clients_list_.empty()) {
+      return;
+    }
+
+    std::string frame = event.type == MessageType::ORDER_BOOK_UPDATE
+        ? serialize_order_book_update(sequence_, event.symbol, event.side, event.price,
+                                      event.quantity)
+        : serialize_tick(sequence_, event.timestamp, event.symbol, event.price,
+                         static_cast<int32_t>(event.quantity));
+    const uint64_t pos = log_.append(frame, [this](uint64_t floor) { return evict_lapped(floor); });
+    const uint32_t len = static_cast<uint32_t>(frame.size());
+    const uint64_t now = now_ns();
+    for (auto& client : clients_list_) {
+      if (!client->closed) {
+        enqueue(*client, pos, len, now);
+      }
+    }
+  }
+
+  void enqueue(Client& client, uint64_t pos, uint32_t len, uint64_t now) {
+    if (client.queue.bytes() + len > config_.client_queue_bytes ||
+        !client.queue.push(log_, pos, len)) {
+      if (config_.policy == SlowClientPolicy::DROP) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        disconnect_slow(client, "send queue full");
+      }
+      return;
+    }
+    if (client.queue.frames() == 1) {
+      client.pending_since_ns = now;
+    }
+    if (client.queue.bytes() >= batch_bytes_ && !client.blocked) {
+      flush(client);  // A full batch doesn't wait for the delay
+    }
+  }
+
+  // Disconnect clients still holding frames below `floor`; returns the
+  // oldest frame anyone else holds
+  uint64_t evict_lapped(uint64_t floor) {
+    uint64_t live_floor = UINT64_MAX;
+    for (auto& client : clients_list_) {
+      if (client->closed || client->queue.empty()) {
+        continue;
+      }
+      if (client->queue.oldest() < floor) {
+        disconnect_slow(*client, "lapped by the frame log");
+      } else {
+        live_floor = std::min(live_floor, client->queue.oldest());
+      }
+    }
+    return live_floor;
+  }
+
+  void disconnect_slow(Client& client, const char* reason) {
+    LOG_WARN("Republisher", "Client fd %d too slow (%s, %lu bytes queued), disconnecting",
+             client.fd, reason, static_cast<unsigned long>(client.queue.bytes()));
+    client.closed = true;
+    client.queue.clear();  // Holds nothing in the log any more
+    slow_disconnects_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void on_ready(Client* client, bool readable, bool writable) {
+    if (!client) {
+      accept_clients();
+      return;
+    }
+    if (client->closed) {
+      return;
+    }
+    if (readable) {
+      // Clients have nothing to say; read only to notice hangups
+      char buffer[512];
+      ssize_t n = recv(client->fd, buffer, sizeof(buffer), 0);
+      if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        client->closed = true;
+        return;
+      }
+    }
+    if (writable && client->blocked) {
+      client->blocked = false;
+      poller_.set_writable(client->fd, client, false);
+      flush(*client);
+    }
+  }
+
+  void accept_clients() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+          LOG_WARN("Republisher", "accept failed: %s", strerror(errno));
+        }
+        return;
+      }
+      if (!socket_set_nonblocking(fd)) {
+        close(fd);
+        continue;
+      }
+      int opt = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));  // Batching is ours
+      socket_set_nosigpipe(fd);
+
+      auto client = std::make_unique<Client>(
+          fd, std::max<size_t>(config_.client_queue_bytes / MIN_FRAME_BYTES, 1024));
+      poller_.add(fd, client.get());
+      clients_list_.push_back(std::move(client));
+      clients_.store(clients_list_.size(), std::memory_order_relaxed);
+      clients_accepted_.fetch_add(1, std::memory_order_relaxed);
+      LOG_INFO("Republisher", "Client connected (fd %d, %zu total)", fd, clients_list_.size());
+    }
+  }
+
+  // Send for every client whose batch is big enough or old enough
+  // (everything when `force`). Returns true while anything is unsent.
+  bool flush_due(uint64_t now, bool force) {
+    const uint64_t max_delay_ns = config_.max_delay_us * 1000;
+    bool pending = false;
+    for (auto& client : clients_list_) {
+      if (client->closed || client->queue.empty()) {
+        continue;
+      }
+      if (!client->blocked &&
+          (force || client->queue.bytes() >= batch_bytes_ ||
+           now - client->pending_since_ns >= max_delay_ns)) {
+        flush(*client);
+      }
+      pending |= !client->closed && !client->queue.empty();
+    }
+    return pending;
+  }
+
+  void flush(Client& client) {
+    uint64_t frames = 0, bytes = 0;
+    const uint64_t sends = client.queue.sends();
+    auto result = client.queue.send(client.fd, log_, frames, bytes);
+    frames_sent_.fetch_add(frames, std::memory_order_relaxed);
+    bytes_sent_.fetch_add(bytes, std::memory_order_relaxed);
+    batches_.fetch_add(client.queue.sends() - sends, std::memory_order_relaxed);
+
+    if (result == FrameQueue::SendResult::FAILED) {
+      client.closed = true;
+    } else if (result == FrameQueue::SendResult::BLOCKED) {
+      client.blocked = true;
+      poller_.set_writable(client.fd, &client, true);
+    }
+  }
+
+  void remove_closed() {
+    auto dead = std::remove_if(clients_list_.begin(), clients_list_.end(), [this](auto& client) {
+      if (!client->closed) {
+        return false;
+      }
+      poller_.remove(client->fd);
+      close(client->fd);
+      return true;
+    });
+    if (dead != clients_list_.end()) {
+      clients_list_.erase(dead, clients_list_.end());
+      clients_.store(clients_list_.size(), std::memory_order_relaxed);
+    }
+  }
+
+  // Stopping: everything is published; give clients drain_timeout_ms to
+  // take what is queued, then close them all
+  void drain() {
+    const uint64_t deadline = now_ns() + config_.drain_timeout_ms * 1'000'000;
+    while (now_ns() < deadline) {
+      poller_.wait(1000, [this](void* tag, bool readable, bool writable) {
+        if (tag && tag != &wakeup_) on_ready(static_cast<Client*>(tag), readable, writable);
+      });
+      bool pending = flush_due(now_ns(), true);
+      remove_closed();
+      if (!pending) {
+        break;
+      }
+    }
+    for (auto& client : clients_list_) {
+      client->closed = true;
+    }
+    remove_closed();
+  }
+
+  RepublisherConfig config_;
+  SPSCQueue<DistributionEvent> events_;
+  FrameLog log_;
+  size_t batch_bytes_;  // Leaves room in the client queue for the next batch
+  republisher_detail::Poller poller_;
+  ThreadWakeup wakeup_;  // publish() and stop() -> republisher thread
+  std::vector<std::unique_ptr<Client>> clients_list_;  // Republisher thread
+  int listen_fd_ = -1;
+  int port_ = 0;
+  uint64_t sequence_ = 0;
+
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+
+  std::atomic<uint64_t> clients_{0};
+  std::atomic<uint64_t> clients_accepted_{0};
+  std::atomic<uint64_t> events_published_{0};
+  std::atomic<uint64_t> frames_sent_{0};
+  std::atomic<uint64_t> bytes_sent_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> frames_dropped_{0};
+  std::atomic<uint64_t> slow_disconnects_{0};
+  std::atomic<uint64_t> overruns_{0};
+};
+
+#endif // REPUBLISHER_HPP
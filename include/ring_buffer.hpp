@@ -83,6 +83,10 @@ public:
 
   size_t capacity() const { return BUFFER_SIZE; }
 
+  // Raw backing storage (for prefaulting / mlock before use)
+  void *storage() { return buffer_; }
+  size_t storage_bytes() const { return BUFFER_SIZE; }
+
   size_t free_space() const {
     return BUFFER_SIZE - size_ - 1;
   }
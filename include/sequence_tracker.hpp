@@ -5,6 +5,8 @@
 #include <iostream>
 #include <optional>
 
+#include "tracepoints.hpp"
+
 /**
  * Optimized Sequence Tracker
  *
@@ -52,6 +54,7 @@ public:
       // Gap detected
       const uint64_t gap_size = sequence - expected;
       gaps_detected_++;
+      FEED_TRACE(gap, expected, sequence);
 
       std::cout << "[SequenceTracker] Gap detected: expected seq=" << expected
                 << ", got seq=" << sequence << " (" << gap_size
@@ -76,6 +79,14 @@ public:
     std::cout << "[SequenceTracker] Sequence tracking reset" << std::endl;
   }
 
+  /**
+   * Continue tracking from a known position (e.g. a restored checkpoint),
+   * so the next expected sequence is last_sequence + 1
+   */
+  inline void resume_from(uint64_t last_sequence) {
+    last_sequence_ = last_sequence;
+  }
+
   // Getters - returns std::optional for backwards compatibility
   inline std::optional<uint64_t> last_sequence() const {
     if (last_sequence_ == UINT64_MAX) {
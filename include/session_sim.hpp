@@ -0,0 +1,715 @@
+#ifndef SESSION_SIM_HPP
+#define SESSION_SIM_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "feed_session.hpp"
+#include "order_book.hpp"
+
+/**
+ * Deterministic Session Simulation
+ *
+ * Runs FeedSessions, the exchange they talk to and the network between
+ * them in one thread under virtual time. Nothing sleeps: when every
+ * session is waiting, the clock jumps to the next event. A reconnect
+ * storm, a 2 s heartbeat timeout or a minute of market data takes
+ * milliseconds. Given the same seeds, every run makes the same calls in
+ * the same order, so the sessions' counters (recovery times included)
+ * are identical from run to run.
+ *
+ *   SimScheduler  virtual clock plus event queue; events due at the same
+ *                 instant run in the order they were scheduled
+ *   SimNetwork    a SessionIo of in-memory TCP-like connections: one-way
+ *                 latency, jitter (order kept), segmentation, refused
+ *                 connects and resets
+ *   SimExchange   snapshot exchange on a SimNetwork port: answers
+ *                 SNAPSHOT_REQUESTs and streams updates, heartbeats and
+ *                 checksums, with faults to inject (lost updates, going
+ *                 quiet, dropping connections, refusing connects)
+ *   Simulation    the three plus a SessionReactor on the virtual network
+ *
+ * Usage:
+ *   Simulation sim;
+ *   SimExchange &exchange = sim.add_exchange(exchange_config);
+ *   FeedSession session(sim.reactor(), session_config);
+ *   session.start();
+ *   sim.scheduler().after(5 * SEC, [&] { exchange.drop_connections(); });
+ *   sim.run_for(10 * SEC);
+ *   session.stats();   // The same on every run
+ */
+
+class SimScheduler {
+public:
+  static constexpr uint64_t NONE = UINT64_MAX;
+  using Task = std::function<void()>;
+
+  explicit SimScheduler(uint64_t start_ns = 1'000'000'000) : now_(start_ns) {}
+
+  uint64_t now() const { return now_; }
+
+  // A time already past runs at the next opportunity, still in order
+  void at(uint64_t time_ns, Task task) {
+    queue_.push_back({std::max(time_ns, now_), next_order_++, std::move(task)});
+    std::push_heap(queue_.begin(), queue_.end(), std::greater<>());
+  }
+
+  void after(uint64_t delay_ns, Task task) { at(now_ + delay_ns, std::move(task)); }
+
+  uint64_t next_time() const { return queue_.empty() ? NONE : queue_.front().time; }
+
+  // Move the clock to the earliest event and run it; false if none
+  bool run_next() {
+    if (queue_.empty()) {
+      return false;
+    }
+    std::pop_heap(queue_.begin(), queue_.end(), std::greater<>());
+    Event event = std::move(queue_.back());
+    queue_.pop_back();
+    now_ = event.time;
+    events_run_++;
+    event.task();  // May schedule more
+    return true;
+  }
+
+  // Everything due by time_ns, then the clock to time_ns
+  void run_until(uint64_t time_ns) {
+    while (next_time() <= time_ns) {
+      run_next();
+    }
+    advance_to(time_ns);
+  }
+
+  // Only forward, and only over an empty stretch of the queue
+  void advance_to(uint64_t time_ns) { now_ = std::max(now_, std::min(time_ns, next_time())); }
+
+  size_t pending() const { return queue_.size(); }
+  uint64_t events_run() const { return events_run_; }
+
+private:
+  struct Event {
+    uint64_t time;
+    uint64_t order;
+    Task task;
+
+    bool operator>(const Event &other) const {
+      return time != other.time ? time > other.time : order > other.order;
+    }
+  };
+
+  uint64_t now_;
+  uint64_t next_order_ = 0;
+  uint64_t events_run_ = 0;
+  std::vector<Event> queue_;  // Min-heap on (time, order)
+};
+
+struct SimNetworkConfig {
+  uint64_t latency_ns = 50'000;  // One way; a connect takes a round trip
+  uint64_t jitter_ns = 0;        // Up to this much more per segment, order kept
+  size_t segment_bytes = 0;      // Sends split into segments this big (0 = one per send)
+  uint64_t seed = 1;
+};
+
+struct SimNetworkStats {
+  uint64_t connects = 0;
+  uint64_t refused = 0;
+  uint64_t resets = 0;
+  uint64_t segments = 0;
+  uint64_t bytes = 0;
+};
+
+/**
+ * In-memory stream sockets. Client fds (the sessions') report readiness
+ * through the SessionIo interface; server fds (the exchange's) call their
+ * handlers as bytes and closes arrive. A send never blocks: every byte is
+ * delivered, latency (plus jitter) later, in order. fds are never reused.
+ */
+class SimNetwork : public SessionIo {
+public:
+  using AcceptHandler = std::function<void(int fd)>;
+  using DataHandler = std::function<void(int fd, const char *data, size_t len)>;
+  using CloseHandler = std::function<void(int fd)>;
+
+  explicit SimNetwork(SimScheduler &scheduler, SimNetworkConfig config = {})
+      : scheduler_(scheduler), config_(config), rng_(config.seed) {}
+
+  SimNetwork(const SimNetwork &) = delete;
+  SimNetwork &operator=(const SimNetwork &) = delete;
+
+  // Connects to port are accepted (on_accept gets the server's end) until
+  // unlisten(); without a listener they are refused
+  void listen(int port, AcceptHandler on_accept) { listeners_[port] = std::move(on_accept); }
+  void unlisten(int port) { listeners_.erase(port); }
+
+  // Server side of a connection: bytes and the peer's close go to these
+  void set_handlers(int fd, DataHandler on_data, CloseHandler on_close) {
+    if (Socket *socket = find(fd)) {
+      socket->on_data = std::move(on_data);
+      socket->on_close = std::move(on_close);
+    }
+  }
+
+  // Fault: both ends see the connection reset now; bytes in flight are lost
+  void reset(int fd) {
+    Socket *socket = find(fd);
+    if (!socket || socket->error) {
+      return;
+    }
+    stats_.resets++;
+    int peer = socket->peer;
+    fail(fd, ECONNRESET);
+    fail(peer, ECONNRESET);
+  }
+
+  const SimNetworkStats &stats() const { return stats_; }
+  size_t open_sockets() const { return sockets_.size(); }
+
+  // --- SessionIo ---
+
+  bool ok() const override { return true; }
+  uint64_t now_ns() override { return scheduler_.now(); }
+
+  int connect(const std::string & /*host*/, int port) override {
+    int fd = next_fd_++;
+    sockets_[fd].port = port;
+    scheduler_.after(2 * config_.latency_ns, [this, fd, port]() {
+      Socket *socket = find(fd);
+      if (!socket) {
+        return;  // Closed before the handshake finished
+      }
+      auto listener = listeners_.find(port);
+      if (listener == listeners_.end()) {
+        stats_.refused++;
+        socket->error = ECONNREFUSED;
+        raise(fd, true, true);
+        return;
+      }
+      int server_fd = next_fd_++;
+      Socket &server = sockets_[server_fd];
+      server.port = port;
+      server.peer = fd;
+      server.connected = true;
+      socket->peer = server_fd;
+      socket->connected = true;
+      stats_.connects++;
+      raise(fd, false, true);
+      AcceptHandler on_accept = listener->second;
+      on_accept(server_fd);
+    });
+    return fd;
+  }
+
+  bool connect_done(int fd) override {
+    Socket *socket = find(fd);
+    return !socket || socket->connected || socket->error;
+  }
+
+  int connect_error(int fd) override {
+    Socket *socket = find(fd);
+    return socket ? socket->error : EBADF;
+  }
+
+  ssize_t recv(int fd, void *buffer, size_t len) override {
+    Socket *socket = find(fd);
+    if (!socket) {
+      errno = EBADF;
+      return -1;
+    }
+    size_t available = socket->inbox.size() - socket->read_offset;
+    if (available > 0) {
+      size_t n = std::min(len, available);
+      memcpy(buffer, socket->inbox.data() + socket->read_offset, n);
+      socket->read_offset += n;
+      if (socket->read_offset == socket->inbox.size()) {
+        socket->inbox.clear();
+        socket->read_offset = 0;
+      }
+      return static_cast<ssize_t>(n);
+    }
+    if (socket->error) {
+      errno = socket->error;
+      return -1;
+    }
+    if (socket->eof) {
+      return 0;
+    }
+    errno = EAGAIN;
+    return -1;
+  }
+
+  ssize_t send(int fd, const void *data, size_t len) override {
+    Socket *socket = find(fd);
+    if (!socket) {
+      errno = EBADF;
+      return -1;
+    }
+    if (socket->error) {
+      errno = socket->error;
+      return -1;
+    }
+    if (!socket->connected || socket->peer_gone) {
+      errno = EPIPE;
+      return -1;
+    }
+    const char *bytes = static_cast<const char *>(data);
+    size_t step = config_.segment_bytes ? config_.segment_bytes : len;
+    for (size_t offset = 0; offset < len; offset += step) {
+      size_t n = std::min(step, len - offset);
+      uint64_t arrival = std::max(scheduler_.now() + config_.latency_ns + jitter(),
+                                  socket->last_arrival);
+      socket->last_arrival = arrival;
+      scheduler_.at(arrival, [this, peer = socket->peer, segment = std::string(bytes + offset, n)]() {
+        deliver(peer, segment);
+      });
+      stats_.segments++;
+      stats_.bytes += n;
+    }
+    return static_cast<ssize_t>(len);
+  }
+
+  // The peer reads what is in flight, then end of stream
+  void close(int fd) override {
+    Socket *socket = find(fd);
+    if (!socket) {
+      return;
+    }
+    if (socket->connected && !socket->error) {
+      uint64_t arrival = std::max(scheduler_.now() + config_.latency_ns, socket->last_arrival);
+      scheduler_.at(arrival, [this, peer = socket->peer]() { end_of_stream(peer); });
+      if (Socket *peer = find(socket->peer)) {
+        peer->peer_gone = true;
+      }
+    }
+    sockets_.erase(fd);
+  }
+
+  bool watch(int fd, uint64_t tag) override {
+    Socket *socket = find(fd);
+    if (!socket) {
+      return false;
+    }
+    socket->watched = true;
+    socket->tag = tag;
+    // As epoll does on EPOLL_CTL_ADD: report what is ready already
+    bool in = socket->inbox.size() > socket->read_offset || socket->eof || socket->error;
+    bool out = socket->connected || socket->error;
+    if (in || out) {
+      ready_.push_back({tag, in, out});
+    }
+    return true;
+  }
+
+  void unwatch(int fd) override {
+    if (Socket *socket = find(fd)) {
+      socket->watched = false;
+    }
+    // Events already raised for it carry a stale tag; the reactor drops them
+  }
+
+  // Run events until one makes a socket ready, the deadline comes or
+  // wake() is called; with nothing scheduled and no deadline, the
+  // simulation is over
+  bool wait(uint64_t deadline_ns, std::vector<Event> &events) override {
+    while (ready_.empty() && !woken_) {
+      uint64_t next = scheduler_.next_time();
+      if (next == SimScheduler::NONE && deadline_ns == NO_DEADLINE) {
+        return false;
+      }
+      if (next > deadline_ns) {
+        scheduler_.advance_to(deadline_ns);
+        break;
+      }
+      scheduler_.run_next();
+    }
+    woken_ = false;
+    events.insert(events.end(), ready_.begin(), ready_.end());
+    ready_.clear();
+    return true;
+  }
+
+  void wake() override { woken_ = true; }
+
+private:
+  struct Socket {
+    int port = 0;
+    int peer = -1;
+    bool connected = false;
+    bool eof = false;        // Peer closed and everything it sent has arrived
+    bool peer_gone = false;  // Peer closed: sends fail
+    int error = 0;
+    std::string inbox;
+    size_t read_offset = 0;
+    uint64_t last_arrival = 0;  // Of the last segment sent: keeps the stream in order
+    bool watched = false;
+    uint64_t tag = 0;
+    DataHandler on_data;
+    CloseHandler on_close;
+  };
+
+  Socket *find(int fd) {
+    auto it = sockets_.find(fd);
+    return it == sockets_.end() ? nullptr : &it->second;
+  }
+
+  uint64_t jitter() { return config_.jitter_ns ? rng_() % (config_.jitter_ns + 1) : 0; }
+
+  void raise(int fd, bool in, bool out) {
+    Socket *socket = find(fd);
+    if (socket && socket->watched) {
+      ready_.push_back({socket->tag, in, out});
+    }
+  }
+
+  void deliver(int fd, const std::string &segment) {
+    Socket *socket = find(fd);
+    if (!socket || socket->error) {
+      return;
+    }
+    if (socket->on_data) {
+      DataHandler on_data = socket->on_data;  // May close fd
+      on_data(fd, segment.data(), segment.size());
+      return;
+    }
+    socket->inbox += segment;
+    raise(fd, true, false);
+  }
+
+  void end_of_stream(int fd) {
+    Socket *socket = find(fd);
+    if (!socket || socket->error) {
+      return;
+    }
+    socket->eof = true;
+    socket->peer_gone = true;
+    if (socket->on_close) {
+      CloseHandler on_close = socket->on_close;
+      on_close(fd);
+      return;
+    }
+    raise(fd, true, false);
+  }
+
+  void fail(int fd, int error) {
+    Socket *socket = find(fd);
+    if (!socket) {
+      return;
+    }
+    socket->error = error;
+    socket->inbox.clear();
+    socket->read_offset = 0;
+    if (socket->on_close) {
+      CloseHandler on_close = socket->on_close;
+      on_close(fd);
+      return;
+    }
+    raise(fd, true, true);
+  }
+
+  SimScheduler &scheduler_;
+  SimNetworkConfig config_;
+  std::mt19937_64 rng_;
+  std::unordered_map<int, Socket> sockets_;  // Looked up, never iterated
+  std::map<int, AcceptHandler> listeners_;
+  std::vector<Event> ready_;
+  bool woken_ = false;
+  int next_fd_ = 1000;
+  SimNetworkStats stats_;
+};
+
+struct SimExchangeConfig {
+  int port = 9999;
+  std::vector<std::string> symbols = {"AAPL", "MSFT", "GOOG", "AMZN"};
+  size_t levels = 5;                             // Price levels per side
+  uint64_t update_interval_ns = 1'000'000;       // One book update (random symbol) this often
+  uint64_t heartbeat_interval_ns = 100'000'000;
+  uint64_t checksum_interval_ns = 500'000'000;   // BOOK_CHECKSUM for every symbol
+  uint64_t seed = 1;
+};
+
+struct SimExchangeStats {
+  uint64_t connections = 0;
+  uint64_t snapshot_requests = 0;
+  uint64_t updates = 0;          // Book changes made
+  uint64_t updates_dropped = 0;  // Of those, never sent (drop_updates)
+  uint64_t heartbeats = 0;
+  uint64_t checksums = 0;
+};
+
+/**
+ * The snapshot exchange of snapshot_mock_server, on a SimNetwork: one
+ * market (a book per symbol, random updates from a seeded generator) sent
+ * to every connection, each connection its own stream with sequence
+ * numbers from 1. A SNAPSHOT_REQUEST is answered with a SNAPSHOT_RESPONSE
+ * of the whole book, sequenced in the stream.
+ */
+class SimExchange {
+public:
+  SimExchange(SimScheduler &scheduler, SimNetwork &network, SimExchangeConfig config = {})
+      : scheduler_(scheduler), network_(network), config_(std::move(config)), rng_(config_.seed) {
+    for (size_t s = 0; s < config_.symbols.size(); ++s) {
+      OrderBook &book = books_[config_.symbols[s]];
+      for (size_t level = 1; level <= config_.levels; ++level) {
+        book.apply_update(0, price(s, 0, level), static_cast<int64_t>(100 * level));
+        book.apply_update(1, price(s, 1, level), static_cast<int64_t>(100 * level));
+      }
+    }
+  }
+
+  SimExchange(const SimExchange &) = delete;
+  SimExchange &operator=(const SimExchange &) = delete;
+
+  // Accept connections and start the market
+  void start() {
+    set_accepting(true);
+    every(config_.update_interval_ns, [this]() { update_market(); });
+    every(config_.heartbeat_interval_ns, [this]() { send_heartbeats(); });
+    every(config_.checksum_interval_ns, [this]() { send_checksums(); });
+  }
+
+  // --- Faults ---
+
+  // The next count updates change the books but are never sent: the
+  // client sees a sequence gap and books it can only repair by resyncing
+  void drop_updates(size_t count) { drop_remaining_ += count; }
+
+  // Send nothing for duration_ns, heartbeats included; the market stands
+  // still and snapshot requests wait
+  void go_quiet(uint64_t duration_ns) {
+    quiet_until_ = std::max(quiet_until_, scheduler_.now() + duration_ns);
+    scheduler_.at(quiet_until_, [this]() { answer_deferred(); });
+  }
+
+  // Close every connection from the exchange's end
+  void drop_connections() {
+    for (auto &[fd, connection] : connections_) {
+      network_.close(fd);
+    }
+    connections_.clear();
+  }
+
+  // Refused connects while false; established connections carry on
+  void set_accepting(bool accepting) {
+    if (accepting) {
+      network_.listen(config_.port, [this](int fd) { accept(fd); });
+    } else {
+      network_.unlisten(config_.port);
+    }
+  }
+
+  // Stop changing the books (heartbeats and checksums go on), so clients
+  // can be compared with the exchange
+  void freeze_market(bool frozen) { frozen_ = frozen; }
+
+  const OrderBook &book(const std::string &symbol) const { return books_.at(symbol); }
+  size_t connections() const { return connections_.size(); }
+  const SimExchangeStats &stats() const { return stats_; }
+
+private:
+  struct Connection {
+    uint64_t sequence = 0;
+    std::string inbox;
+    std::vector<std::string> deferred;  // Snapshot requests received while quiet
+  };
+
+  float price(size_t symbol, uint8_t side, size_t level) const {
+    float mid = 100.0f + 10.0f * static_cast<float>(symbol);
+    float offset = 0.01f * static_cast<float>(level);
+    return side == 0 ? mid - offset : mid + offset;
+  }
+
+  bool quiet() const { return scheduler_.now() < quiet_until_; }
+
+  void every(uint64_t interval_ns, std::function<void()> task) {
+    if (interval_ns == 0) {
+      return;
+    }
+    scheduler_.after(interval_ns, [this, interval_ns, task]() {
+      task();
+      every(interval_ns, task);
+    });
+  }
+
+  void accept(int fd) {
+    connections_[fd];
+    stats_.connections++;
+    network_.set_handlers(
+        fd, [this](int from, const char *data, size_t len) { receive(from, data, len); },
+        [this](int from) {
+          connections_.erase(from);
+          network_.close(from);
+        });
+  }
+
+  void receive(int fd, const char *data, size_t len) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+      return;
+    }
+    Connection &connection = it->second;
+    connection.inbox.append(data, len);
+    size_t offset = 0;
+    while (connection.inbox.size() - offset >= MessageHeader::HEADER_SIZE) {
+      MessageHeader header = deserialize_header(connection.inbox.data() + offset);
+      size_t total = MessageHeader::HEADER_SIZE + header.length;
+      if (connection.inbox.size() - offset < total) {
+        break;
+      }
+      if (header.type == MessageType::SNAPSHOT_REQUEST) {
+        SnapshotRequestPayload request = deserialize_snapshot_request(
+            connection.inbox.data() + offset + MessageHeader::HEADER_SIZE);
+        std::string symbol = trim_symbol(request.symbol, 4);
+        stats_.snapshot_requests++;
+        if (quiet()) {
+          connection.deferred.push_back(symbol);
+        } else {
+          send_snapshot(fd, connection, symbol);
+        }
+      }
+      offset += total;
+    }
+    connection.inbox.erase(0, offset);
+  }
+
+  void answer_deferred() {
+    if (quiet()) {
+      return;  // Extended since
+    }
+    for (auto &[fd, connection] : connections_) {
+      for (const auto &symbol : std::exchange(connection.deferred, {})) {
+        send_snapshot(fd, connection, symbol);
+      }
+    }
+  }
+
+  void send_snapshot(int fd, Connection &connection, const std::string &symbol) {
+    auto it = books_.find(symbol);
+    if (it == books_.end()) {
+      return;
+    }
+    char wire[4] = {};
+    memcpy(wire, symbol.data(), std::min<size_t>(symbol.size(), 4));
+    std::string frame = serialize_snapshot_response(++connection.sequence, wire,
+                                                    it->second.get_top_bids(SIZE_MAX),
+                                                    it->second.get_top_asks(SIZE_MAX));
+    network_.send(fd, frame.data(), frame.size());
+  }
+
+  void broadcast(const std::function<std::string(uint64_t sequence)> &frame) {
+    for (auto &[fd, connection] : connections_) {
+      std::string bytes = frame(++connection.sequence);
+      network_.send(fd, bytes.data(), bytes.size());
+    }
+  }
+
+  void update_market() {
+    if (quiet() || frozen_ || config_.symbols.empty()) {
+      return;
+    }
+    size_t symbol = rng_() % config_.symbols.size();
+    uint8_t side = static_cast<uint8_t>(rng_() % 2);
+    float level_price = price(symbol, side, 1 + rng_() % config_.levels);
+    int64_t quantity = rng_() % 4 == 0 ? 0 : static_cast<int64_t>(1 + rng_() % 1000);
+    books_[config_.symbols[symbol]].apply_update(side, level_price, quantity);
+    stats_.updates++;
+
+    if (drop_remaining_ > 0) {
+      drop_remaining_--;
+      stats_.updates_dropped++;
+      for (auto &[fd, connection] : connections_) {
+        connection.sequence++;  // Lost on the way: the next frame shows the gap
+      }
+      return;
+    }
+    const std::string &name = config_.symbols[symbol];
+    broadcast([&](uint64_t sequence) {
+      return serialize_order_book_update(sequence, name.c_str(), side, level_price, quantity);
+    });
+  }
+
+  void send_heartbeats() {
+    if (quiet()) {
+      return;
+    }
+    stats_.heartbeats++;
+    broadcast([&](uint64_t sequence) { return serialize_heartbeat(sequence, scheduler_.now()); });
+  }
+
+  void send_checksums() {
+    if (quiet()) {
+      return;
+    }
+    for (const auto &symbol : config_.symbols) {
+      char wire[4] = {};
+      memcpy(wire, symbol.data(), std::min<size_t>(symbol.size(), 4));
+      uint64_t checksum = books_[symbol].checksum();
+      stats_.checksums++;
+      broadcast([&](uint64_t sequence) { return serialize_book_checksum(sequence, wire, checksum); });
+    }
+  }
+
+  SimScheduler &scheduler_;
+  SimNetwork &network_;
+  SimExchangeConfig config_;
+  std::mt19937_64 rng_;
+  std::map<std::string, OrderBook> books_;
+  std::map<int, Connection> connections_;  // Ordered: fan-out order is fixed
+  size_t drop_remaining_ = 0;
+  uint64_t quiet_until_ = 0;
+  bool frozen_ = false;
+  SimExchangeStats stats_;
+};
+
+/**
+ * Scheduler, network and a SessionReactor on it, with any number of
+ * exchanges. Sessions are created on reactor() as usual.
+ */
+class Simulation {
+public:
+  explicit Simulation(SimNetworkConfig network = {}, uint64_t start_ns = 1'000'000'000)
+      : scheduler_(start_ns), network_(scheduler_, network), reactor_(network_) {}
+
+  Simulation(const Simulation &) = delete;
+  Simulation &operator=(const Simulation &) = delete;
+
+  SimExchange &add_exchange(SimExchangeConfig config = {}) {
+    exchanges_.push_back(std::make_unique<SimExchange>(scheduler_, network_, std::move(config)));
+    exchanges_.back()->start();
+    return *exchanges_.back();
+  }
+
+  // Run sessions and exchanges for duration_ns of virtual time
+  void run_for(uint64_t duration_ns) {
+    uint64_t end = scheduler_.now() + duration_ns;
+    uint64_t run = ++runs_;
+    scheduler_.at(end, [this, run]() {
+      if (run == runs_) reactor_.stop();
+    });
+    reactor_.run();
+    ++runs_;  // A stop still queued (run() returned early) must not end the next run
+    scheduler_.run_until(end);  // If no session was waiting, time still passes
+  }
+
+  uint64_t now_ns() const { return scheduler_.now(); }
+  SimScheduler &scheduler() { return scheduler_; }
+  SimNetwork &network() { return network_; }
+  SessionReactor &reactor() { return reactor_; }
+
+private:
+  SimScheduler scheduler_;
+  SimNetwork network_;
+  SessionReactor reactor_;
+  std::vector<std::unique_ptr<SimExchange>> exchanges_;
+  uint64_t runs_ = 0;
+};
+
+#endif // SESSION_SIM_HPP
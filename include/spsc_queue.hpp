@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <memory>
@@ -77,6 +78,26 @@ public:
     return item;
   }
 
+  /**
+   * Consumer-side: Up to max ready items in place, oldest first, without
+   * copying them out. Stops at the wrap point, so a full drain can take two
+   * calls. The items stay owned by the queue until consume().
+   */
+  size_t peek_batch(const T **first, size_t max) const {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    size_t ready = (head - tail) & mask_;
+    ready = std::min({ready, capacity_ - tail, max});
+    *first = &buffer_[tail];
+    return ready;
+  }
+
+  // Consumer-side: release the first count items returned by peek_batch()
+  void consume(size_t count) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    tail_.store((tail + count) & mask_, std::memory_order_release);
+  }
+
   /**
    * Check if queue is empty (consumer-side)
    * Note: This is a snapshot and may be stale immediately
@@ -97,6 +118,17 @@ public:
 
   size_t capacity() const { return capacity_; }
 
+  /**
+   * Raw slot storage (for prefaulting / mlock before use)
+   */
+  void *storage() { return buffer_.get(); }
+  size_t storage_bytes() const { return capacity_ * sizeof(T); }
+
+  // What a queue asked for `capacity` slots will allocate
+  static size_t storage_bytes_for(size_t capacity) {
+    return round_up_to_power_of_2(capacity) * sizeof(T);
+  }
+
 private:
   static size_t round_up_to_power_of_2(size_t n) {
     if (n == 0)
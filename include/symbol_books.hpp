@@ -0,0 +1,288 @@
+#ifndef SYMBOL_BOOKS_HPP
+#define SYMBOL_BOOKS_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "message_views.hpp"
+#include "order_book.hpp"
+#include "tracepoints.hpp"
+
+/**
+ * Per-Symbol Book State
+ *
+ * One OrderBook per subscribed symbol, each with its own recovery state:
+ *
+ *   VALID      - consistent with the feed; updates are applied
+ *   STALE      - may have missed updates (e.g. after a sequence gap, which
+ *                can't be attributed to a symbol); updates are still
+ *                applied until a checksum confirms the book or a snapshot
+ *                replaces it
+ *   RECOVERING - snapshot requested; updates are buffered until it arrives
+ *
+ * Recovery is per symbol: a book that goes bad pulls in only its own
+ * snapshot while every other symbol keeps updating. When the snapshot
+ * arrives, buffered updates newer than it are replayed on top; older ones
+ * are already reflected in it and are dropped.
+ *
+ * A snapshot can be loaded whole (load_snapshot), streamed level by level
+ * as chunks arrive (begin_snapshot / add_snapshot_level / finish_snapshot),
+ * or built on another thread and handed over (install_snapshot); updates
+ * keep buffering until it is finished.
+ *
+ * Usage:
+ *   SymbolBooks books;
+ *   books.add("AAPL");                           // starts RECOVERING
+ *   books.apply_update(seq, update);              // APPLIED / BUFFERED
+ *   books.load_snapshot("AAPL", seq, bids, asks); // -> VALID
+ */
+
+enum class BookState : uint8_t { VALID, STALE, RECOVERING };
+
+inline const char *book_state_name(BookState state) {
+  switch (state) {
+  case BookState::VALID:      return "VALID";
+  case BookState::STALE:      return "STALE";
+  case BookState::RECOVERING: return "RECOVERING";
+  }
+  return "UNKNOWN";
+}
+
+struct SymbolBook {
+  OrderBook book;
+  BookState state = BookState::RECOVERING;
+  uint64_t last_sequence = 0;   // Sequence of the last message applied to the book
+  uint64_t stale_since_ns = 0;
+  uint64_t recovery_started_ns = 0;
+
+  // Updates received while RECOVERING, in arrival order
+  std::vector<std::pair<uint64_t, OrderBookUpdatePayload>> pending;
+  uint64_t dropped_through = 0; // Newest sequence dropped from a full buffer (0 = none)
+
+  // Snapshot being loaded (a chunked snapshot spans several messages)
+  struct SnapshotProgress {
+    bool active = false;
+    bool replaces_book = false; // There was a book before it (a resync)
+    uint64_t sequence = 0;      // Stream position the snapshot reflects
+    uint32_t id = 0;
+    uint32_t next_chunk = 0;
+    uint64_t started_ns = 0;
+    uint64_t first_level_ns = 0;
+  } snapshot;
+};
+
+class SymbolBooks {
+public:
+  static constexpr size_t MAX_PENDING = 65536;
+
+  // ALREADY_APPLIED: no newer than the book, e.g. a snapshot from another
+  // connection got here before the update did
+  enum class UpdateResult { APPLIED, BUFFERED, ALREADY_APPLIED, UNKNOWN_SYMBOL };
+
+  // New books have no state yet, so they start RECOVERING
+  SymbolBook &add(const std::string &symbol) { return books_[symbol]; }
+
+  SymbolBook *find(const std::string &symbol) {
+    auto it = books_.find(symbol);
+    return it == books_.end() ? nullptr : &it->second;
+  }
+
+  std::map<std::string, SymbolBook> &books() { return books_; }
+  const std::map<std::string, SymbolBook> &books() const { return books_; }
+  size_t size() const { return books_.size(); }
+
+  size_t count(BookState state) const {
+    size_t n = 0;
+    for (const auto &[symbol, entry] : books_) {
+      n += entry.state == state;
+    }
+    return n;
+  }
+
+  UpdateResult apply_update(uint64_t sequence, const OrderBookUpdatePayload &update) {
+    SymbolBook *entry = find(trim_symbol(update.symbol, 4));
+    if (!entry) {
+      return UpdateResult::UNKNOWN_SYMBOL;
+    }
+    return apply_to(*entry, sequence, update);
+  }
+
+  // Straight from the receive buffer: updates for symbols with no book are
+  // rejected on the symbol bytes, before the rest is decoded
+  UpdateResult apply_update(uint64_t sequence, const BookUpdateView &update) {
+    SymbolBook *entry = find(std::string(update.symbol()));
+    if (!entry) {
+      return UpdateResult::UNKNOWN_SYMBOL;
+    }
+    return apply_to(*entry, sequence, update.decode());
+  }
+
+  /**
+   * Replace a book with a snapshot taken at `sequence` and replay buffered
+   * updates newer than it. Returns false (book stays RECOVERING, another
+   * snapshot is needed) if updates newer than the snapshot were dropped
+   * from a full buffer. `replayed` receives the number of updates replayed.
+   */
+  bool load_snapshot(const std::string &symbol, uint64_t sequence,
+                     const std::vector<OrderBookLevel> &bids,
+                     const std::vector<OrderBookLevel> &asks,
+                     size_t *replayed = nullptr) {
+    SymbolBook &entry = books_[symbol];
+    begin_snapshot(entry, sequence);
+    for (const auto &level : bids) add_snapshot_level(entry, 0, level.price, level.quantity);
+    for (const auto &level : asks) add_snapshot_level(entry, 1, level.price, level.quantity);
+    return finish_snapshot(entry, replayed);
+  }
+
+  // Start replacing a book with a snapshot reflecting the stream up to
+  // `sequence`. The book is cleared and updates buffer until it's finished.
+  void begin_snapshot(SymbolBook &entry, uint64_t sequence, uint64_t now = 0) {
+    if (entry.state != BookState::RECOVERING) {
+      begin_recovery(entry, now);
+    }
+    entry.snapshot = SymbolBook::SnapshotProgress{};
+    entry.snapshot.active = true;
+    entry.snapshot.replaces_book = entry.last_sequence != 0;
+    entry.snapshot.sequence = sequence;
+    entry.snapshot.started_ns = now;
+    entry.book.clear();
+  }
+
+  void add_snapshot_level(SymbolBook &entry, uint8_t side, float price, uint64_t quantity) {
+    entry.book.add_level(side, price, quantity);
+  }
+
+  // Counterpart of load_snapshot's return value for a streamed snapshot
+  bool finish_snapshot(SymbolBook &entry, size_t *replayed = nullptr) {
+    size_t count = 0;
+    uint64_t sequence = entry.snapshot.sequence;
+    entry.snapshot.active = false;
+
+    if (entry.dropped_through > sequence) {
+      entry.book.clear();
+      entry.pending.clear();
+      entry.dropped_through = 0;
+      if (replayed) *replayed = 0;
+      return false;
+    }
+
+    entry.last_sequence = sequence;
+    for (const auto &[seq, update] : entry.pending) {
+      if (seq <= sequence) continue;
+      entry.book.apply_update(update.side, update.price, update.quantity);
+      entry.last_sequence = seq;
+      count++;
+    }
+    entry.pending.clear();
+    entry.dropped_through = 0;
+    entry.state = BookState::VALID;
+
+    if (replayed) *replayed = count;
+    return true;
+  }
+
+  // Install a snapshot built elsewhere (e.g. on a recovery thread) as of
+  // `sequence`; buffered updates are replayed as by finish_snapshot
+  bool install_snapshot(SymbolBook &entry, OrderBook &&book, uint64_t sequence,
+                        size_t *replayed = nullptr) {
+    begin_snapshot(entry, sequence);
+    entry.book = std::move(book);
+    return finish_snapshot(entry, replayed);
+  }
+
+  // Give up on a partly loaded snapshot (lost chunk, bad checksum); the book
+  // stays RECOVERING with its buffered updates, waiting for another one
+  void abort_snapshot(SymbolBook &entry) {
+    entry.snapshot.active = false;
+    entry.book.clear();
+  }
+
+  // Install a book recovered out of band (checkpoint, standby mirror)
+  void adopt(const std::string &symbol, const OrderBook &book, uint64_t sequence) {
+    SymbolBook &entry = books_[symbol];
+    entry.book = book;
+    entry.last_sequence = sequence;
+    entry.pending.clear();
+    entry.dropped_through = 0;
+    entry.state = BookState::VALID;
+  }
+
+  // Snapshot requested: stop applying, start buffering
+  void begin_recovery(SymbolBook &entry, uint64_t now = 0) {
+    entry.state = BookState::RECOVERING;
+    entry.recovery_started_ns = now;
+    entry.pending.clear();
+    entry.dropped_through = 0;
+  }
+
+  // Every VALID book may have missed something; returns how many were marked
+  size_t mark_all_stale(uint64_t now) {
+    size_t marked = 0;
+    for (auto &[symbol, entry] : books_) {
+      if (entry.state == BookState::VALID) {
+        entry.state = BookState::STALE;
+        entry.stale_since_ns = now;
+        marked++;
+      }
+    }
+    return marked;
+  }
+
+  /**
+   * Compare a book with the publisher's checksum. A match confirms a STALE
+   * book (back to VALID); a mismatch leaves state alone for the caller to
+   * start recovery. RECOVERING books are never compared (returns true).
+   */
+  bool verify_checksum(SymbolBook &entry, uint64_t checksum) {
+    if (entry.state == BookState::RECOVERING) {
+      return true;
+    }
+    if (entry.book.checksum() != checksum) {
+      return false;
+    }
+    entry.state = BookState::VALID;
+    return true;
+  }
+
+  // STALE books nothing has confirmed within `timeout_ns`
+  std::vector<std::string> stale_longer_than(uint64_t now, uint64_t timeout_ns) const {
+    std::vector<std::string> result;
+    for (const auto &[symbol, entry] : books_) {
+      if (entry.state == BookState::STALE && now - entry.stale_since_ns >= timeout_ns) {
+        result.push_back(symbol);
+      }
+    }
+    return result;
+  }
+
+private:
+  UpdateResult apply_to(SymbolBook &entry, uint64_t sequence,
+                        const OrderBookUpdatePayload &update) {
+    if (entry.state == BookState::RECOVERING) {
+      if (entry.pending.size() >= MAX_PENDING) {
+        // Only matters if the snapshot turns out to be older than these
+        entry.dropped_through = entry.pending.back().first;
+        entry.pending.clear();
+      }
+      entry.pending.emplace_back(sequence, update);
+      return UpdateResult::BUFFERED;
+    }
+    if (sequence <= entry.last_sequence && entry.last_sequence != 0) {
+      return UpdateResult::ALREADY_APPLIED;
+    }
+
+    entry.book.apply_update(update.side, update.price, update.quantity);
+    entry.last_sequence = sequence;
+    FEED_TRACE(book_update, update.symbol, sizeof(update.symbol), update.side, update.quantity);
+    return UpdateResult::APPLIED;
+  }
+
+  std::map<std::string, SymbolBook> books_;
+};
+
+#endif // SYMBOL_BOOKS_HPP
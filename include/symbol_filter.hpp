@@ -0,0 +1,239 @@
+#ifndef SYMBOL_FILTER_HPP
+#define SYMBOL_FILTER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "binary_protocol.hpp"
+
+// =============================================================================
+// Symbol subscription filter
+//
+// Readers check a tick's symbol bytes against the subscribed set before
+// decoding anything else or pushing it downstream. Two lookups, picked by
+// set size:
+//
+//   - Few symbols: the 4-byte keys packed in an array and compared against
+//     the tick's key four at a time with SSE2.
+//   - Many symbols: one bit per possible symbol. A symbol of up to 4 chars
+//     from [A-Z0-9.] has a dense id (base 38, NUL padding = 0), so the set
+//     is a 255 KiB bitset and a lookup is one load. Keys outside that
+//     alphabet fall back to the packed compare.
+//
+// Subscription holds the current filter and swaps it at runtime (RCU): the
+// reader never locks, and a replaced filter is freed only once the reader
+// has finished with it.
+// =============================================================================
+
+namespace symbol_filter_detail {
+
+constexpr int32_t ID_BASE = 38;
+constexpr int32_t ID_SPACE = ID_BASE * ID_BASE * ID_BASE * ID_BASE;  // 2,085,136
+
+// Digit per symbol byte: NUL 0, A-Z 1-26, 0-9 27-36, '.' 37, otherwise -1
+inline const int8_t* digits() {
+  static const std::array<int8_t, 256> table = [] {
+    std::array<int8_t, 256> t;
+    t.fill(-1);
+    t[0] = 0;
+    for (int c = 'A'; c <= 'Z'; ++c) t[c] = static_cast<int8_t>(1 + c - 'A');
+    for (int c = '0'; c <= '9'; ++c) t[c] = static_cast<int8_t>(27 + c - '0');
+    t['.'] = 37;
+    return t;
+  }();
+  return table.data();
+}
+
+} // namespace symbol_filter_detail
+
+// Dense id in [0, ID_SPACE) of a symbol_key(), or -1 outside the alphabet
+inline int32_t symbol_id(uint32_t key) {
+  unsigned char b[4];
+  memcpy(b, &key, 4);
+  const int8_t* d = symbol_filter_detail::digits();
+  int32_t d0 = d[b[0]], d1 = d[b[1]], d2 = d[b[2]], d3 = d[b[3]];
+  if ((d0 | d1 | d2 | d3) < 0) {
+    return -1;
+  }
+  constexpr int32_t B = symbol_filter_detail::ID_BASE;
+  return ((d0 * B + d1) * B + d2) * B + d3;
+}
+
+// Key of a symbol as it appears on the binary wire (NUL-padded to 4 bytes)
+inline uint32_t padded_symbol_key(std::string_view symbol) {
+  char padded[4] = {0, 0, 0, 0};
+  memcpy(padded, symbol.data(), std::min<size_t>(symbol.size(), 4));
+  return symbol_key(padded);
+}
+
+/**
+ * Immutable set of subscribed symbols. Symbols longer than 4 chars can only
+ * arrive over the text protocol and are matched by string.
+ */
+class SymbolFilter {
+public:
+  // Sets up to this size use the packed compare; larger ones the bitset
+  static constexpr size_t PACKED_MAX = 32;
+
+  explicit SymbolFilter(const std::vector<std::string>& symbols, size_t packed_max = PACKED_MAX) {
+    std::vector<uint32_t> keys;
+    for (const auto& symbol : symbols) {
+      if (symbol.size() > 4) {
+        long_symbols_.push_back(symbol);
+      } else {
+        keys.push_back(padded_symbol_key(symbol));
+      }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    size_ = keys.size() + long_symbols_.size();
+
+    if (keys.size() > packed_max) {
+      bits_.assign((symbol_filter_detail::ID_SPACE + 63) / 64, 0);
+      for (uint32_t key : keys) {
+        int32_t id = symbol_id(key);
+        if (id >= 0) {
+          bits_[id >> 6] |= uint64_t{1} << (id & 63);
+        } else {
+          packed_.push_back(key);
+        }
+      }
+    } else {
+      packed_ = std::move(keys);
+    }
+    // Whole SIMD lanes; repeating a key adds no matches
+    while (packed_.size() % 4 != 0) {
+      packed_.push_back(packed_[0]);
+    }
+  }
+
+  // A binary tick's symbol_key()
+  bool matches(uint32_t key) const {
+    if (!bits_.empty()) {
+      int32_t id = symbol_id(key);
+      if (id >= 0) {
+        return (bits_[id >> 6] >> (id & 63)) & 1;
+      }
+    }
+    return packed_contains(key);
+  }
+
+  // A symbol of any length (text protocol)
+  bool matches(std::string_view symbol) const {
+    if (symbol.size() <= 4) {
+      return matches(padded_symbol_key(symbol));
+    }
+    return std::find(long_symbols_.begin(), long_symbols_.end(), symbol) != long_symbols_.end();
+  }
+
+  size_t size() const { return size_; }
+  bool uses_bitset() const { return !bits_.empty(); }
+
+private:
+  bool packed_contains(uint32_t key) const {
+#if defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi32(static_cast<int>(key));
+    __m128i hits = _mm_setzero_si128();
+    for (size_t i = 0; i < packed_.size(); i += 4) {
+      __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed_.data() + i));
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi32(lane, needle));
+    }
+    return _mm_movemask_epi8(hits) != 0;
+#else
+    bool hit = false;
+    for (uint32_t k : packed_) {
+      hit |= k == key;
+    }
+    return hit;
+#endif
+  }
+
+  std::vector<uint32_t> packed_;
+  std::vector<uint64_t> bits_;
+  std::vector<std::string> long_symbols_;
+  size_t size_ = 0;
+};
+
+/**
+ * The current subscription, replaceable while a reader uses it.
+ *
+ * The reader takes the filter once per receive chunk (read(), nullptr when
+ * everything is subscribed) and calls quiescent() when it no longer holds
+ * it: no lock, one atomic increment per chunk. subscribe() publishes a new
+ * filter with an atomic exchange and retires the old one, which is freed
+ * on a later subscribe() (or destruction) once the reader has passed a
+ * quiescent state since the swap. One reader thread per Subscription;
+ * any number of threads may subscribe.
+ */
+class Subscription {
+public:
+  Subscription() = default;
+  Subscription(const Subscription&) = delete;
+  Subscription& operator=(const Subscription&) = delete;
+
+  ~Subscription() {
+    delete current_.load();
+    for (const auto& r : retired_) {
+      delete r.filter;
+    }
+  }
+
+  void subscribe(const std::vector<std::string>& symbols) {
+    publish(new SymbolFilter(symbols));
+  }
+
+  void subscribe_all() { publish(nullptr); }
+
+  // Reader side. seq_cst on both: a reader that passed quiescent() after
+  // the writer read the epoch must see the new filter on its next read().
+  const SymbolFilter* read() const { return current_.load(); }
+  void quiescent() { reader_epoch_.fetch_add(1); }
+
+  // Swapped-out filters the reader may still hold
+  size_t retired() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+  }
+
+private:
+  struct Retired {
+    const SymbolFilter* filter;
+    uint64_t epoch;  // Reader epoch when it was swapped out
+  };
+
+  void publish(const SymbolFilter* next) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const SymbolFilter* old = current_.exchange(next);
+    if (old) {
+      retired_.push_back({old, reader_epoch_.load()});
+    }
+
+    uint64_t now = reader_epoch_.load();
+    auto freed = std::remove_if(retired_.begin(), retired_.end(), [&](const Retired& r) {
+      if (now > r.epoch) {
+        delete r.filter;
+        return true;
+      }
+      return false;
+    });
+    retired_.erase(freed, retired_.end());
+  }
+
+  std::atomic<const SymbolFilter*> current_{nullptr};
+  std::atomic<uint64_t> reader_epoch_{0};
+  mutable std::mutex mutex_;  // Writers only
+  std::vector<Retired> retired_;
+};
+
+#endif // SYMBOL_FILTER_HPP
@@ -0,0 +1,191 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * Hashed Timer Wheel
+ *
+ * One timer per id (ids are small dense integers, e.g. session slots),
+ * O(1) schedule and cancel, and an advance() that only looks at the slots
+ * the clock moved through. A timer lives in slot (deadline / tick) mod
+ * slots; one further out than the wheel's span shares a slot with nearer
+ * ones and is simply skipped until its own lap comes round, so any
+ * deadline is accepted.
+ *
+ * A timer fires on the first advance() whose `now` has reached its
+ * deadline, not at the tick boundary: tick_ns only sets how timers are
+ * bucketed. next_deadline() gives the earliest deadline in the next
+ * `max_slots` slots, to sleep until exactly then.
+ *
+ * Callbacks may schedule or cancel any timer, including the one firing.
+ * Not thread-safe.
+ *
+ * Usage:
+ *   TimerWheel wheel(1'000'000, 4096, now_ns());  // 1 ms ticks, 4.096 s span
+ *   wheel.schedule(session_id, now_ns() + interval_ns);
+ *   wheel.advance(now_ns(), [&](uint32_t id, uint64_t deadline_ns) {
+ *     send_heartbeat(id);
+ *     wheel.schedule(id, deadline_ns + interval_ns);
+ *   });
+ */
+class TimerWheel {
+public:
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  // slots is rounded up to a power of two
+  explicit TimerWheel(uint64_t tick_ns = 1'000'000, size_t slots = 4096, uint64_t start_ns = 0)
+      : tick_ns_(std::max<uint64_t>(tick_ns, 1)),
+        mask_(round_up_pow2(std::max<size_t>(slots, 1)) - 1),
+        heads_(mask_ + 1, NONE),
+        current_tick_(start_ns / tick_ns_) {}
+
+  uint64_t tick_ns() const { return tick_ns_; }
+  size_t slots() const { return mask_ + 1; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  bool scheduled(uint32_t id) const { return id < nodes_.size() && nodes_[id].slot != NONE; }
+
+  // (Re)arm id's timer; a deadline already past fires on the next advance()
+  void schedule(uint32_t id, uint64_t deadline_ns) {
+    if (id >= nodes_.size()) {
+      nodes_.resize(static_cast<size_t>(id) + 1);
+    }
+    cancel(id);
+    Node &node = nodes_[id];
+    node.deadline = deadline_ns;
+    link(id, static_cast<uint32_t>(std::max(deadline_ns / tick_ns_, current_tick_) & mask_));
+    ++size_;
+  }
+
+  bool cancel(uint32_t id) {
+    if (!scheduled(id)) {
+      return false;
+    }
+    Node &node = nodes_[id];
+    if (node.slot != FIRING) {
+      unlink(id);
+    }
+    node.slot = NONE;
+    --size_;
+    return true;
+  }
+
+  // Fire every timer with deadline <= now_ns as fire(id, deadline_ns), in
+  // slot order. Returns the number fired.
+  template <typename Fire>
+  size_t advance(uint64_t now_ns, Fire &&fire) {
+    uint64_t now_tick = std::max(now_ns / tick_ns_, current_tick_);
+    // Moving a full lap or more visits every slot once
+    uint64_t first = now_tick - current_tick_ > mask_ ? now_tick - mask_ : current_tick_;
+
+    due_.clear();
+    for (uint64_t tick = first; tick <= now_tick; ++tick) {
+      uint32_t slot = static_cast<uint32_t>(tick & mask_);
+      uint32_t id = heads_[slot];
+      heads_[slot] = NONE;
+      while (id != NONE) {
+        Node &node = nodes_[id];
+        uint32_t next = node.next;
+        if (node.deadline <= now_ns) {
+          node.slot = FIRING;
+          due_.push_back(id);
+        } else {
+          link(id, slot);
+        }
+        id = next;
+      }
+    }
+    current_tick_ = now_tick;
+
+    // Fired outside the walk, so callbacks can touch any timer
+    size_t fired = 0;
+    for (uint32_t id : due_) {
+      Node &node = nodes_[id];
+      if (node.slot != FIRING) {
+        continue;  // Cancelled or rescheduled by an earlier callback
+      }
+      node.slot = NONE;
+      --size_;
+      ++fired;
+      fire(id, node.deadline);
+    }
+    return fired;
+  }
+
+  // Earliest deadline among timers in the next max_slots slots, or the end
+  // of that window if there are none (callers sleep until the returned time)
+  uint64_t next_deadline(size_t max_slots = 64) const {
+    uint64_t window_end = (current_tick_ + max_slots) * tick_ns_;
+    if (size_ == 0) {
+      return window_end;
+    }
+    for (uint64_t tick = current_tick_; tick < current_tick_ + max_slots; ++tick) {
+      uint64_t tick_end = (tick + 1) * tick_ns_;
+      uint64_t earliest = std::numeric_limits<uint64_t>::max();
+      for (uint32_t id = heads_[tick & mask_]; id != NONE; id = nodes_[id].next) {
+        earliest = std::min(earliest, nodes_[id].deadline);
+      }
+      if (earliest < tick_end) {
+        return earliest;  // Anything due by the end of this tick
+      }
+    }
+    return window_end;
+  }
+
+private:
+  static constexpr uint32_t FIRING = NONE - 1;
+
+  struct Node {
+    uint64_t deadline = 0;
+    uint32_t prev = NONE;
+    uint32_t next = NONE;
+    uint32_t slot = NONE;
+  };
+
+  static size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  void link(uint32_t id, uint32_t slot) {
+    Node &node = nodes_[id];
+    node.slot = slot;
+    node.prev = NONE;
+    node.next = heads_[slot];
+    if (node.next != NONE) {
+      nodes_[node.next].prev = id;
+    }
+    heads_[slot] = id;
+  }
+
+  void unlink(uint32_t id) {
+    Node &node = nodes_[id];
+    if (node.prev != NONE) {
+      nodes_[node.prev].next = node.next;
+    } else {
+      heads_[node.slot] = node.next;
+    }
+    if (node.next != NONE) {
+      nodes_[node.next].prev = node.prev;
+    }
+  }
+
+  uint64_t tick_ns_;
+  size_t mask_;
+  std::vector<uint32_t> heads_;
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> due_;
+  uint64_t current_tick_;
+  size_t size_ = 0;
+};
+
+#endif // TIMER_WHEEL_HPP
@@ -0,0 +1,127 @@
+#ifndef TRACEPOINTS_HPP
+#define TRACEPOINTS_HPP
+
+#include <type_traits>
+
+/**
+ * Static Tracepoints (USDT)
+ *
+ * FEED_TRACE(name, args...) marks a point on the hot path that perf,
+ * bpftrace or SystemTap can attach to in a running, unmodified binary.
+ * Each use compiles to a single nop plus an ELF note in .note.stapsdt
+ * recording the nop's address and where each argument lives (register,
+ * stack slot or constant), the same layout <sys/sdt.h> emits, so no
+ * systemtap headers are needed to build. A tracer attaching replaces the
+ * nop with a breakpoint; until then nothing runs and nothing is read.
+ *
+ * The cost left is that argument values must exist in a register or in
+ * memory at the nop. Pass values the code already has at hand, never
+ * something computed for the probe alone (a clock read, a size() walk).
+ *
+ * Probes, all under provider "feed":
+ *   recv(fd, bytes)                       a read returned data
+ *   decoded(messages, bytes)              one read's frames decoded
+ *   queue_full(capacity)                  a tick push found the queue full
+ *   queue_resume(retries)                 ...and finally went in
+ *   processed(count, oldest_recv_ns, now_ns)  ticks popped and handled
+ *   gap(expected, received)               a sequence gap was detected
+ *   book_update(symbol, symbol_len, side, quantity)  a level was applied
+ *   reconnect(attempt, delay_ms)          a new connection is about to start
+ *
+ * Listing them and attaching:
+ *   readelf -n build/feed_handler | grep -A3 stapsdt
+ *   bpftrace -l 'usdt:build/feed_handler:feed:*'
+ *   bpftrace -p $(pidof feed_handler) profiling/stage_latency.bt
+ *
+ * Compiled out with -DFEED_NO_TRACEPOINTS, and where the target is not
+ * ELF (macOS) or the compiler lacks GNU inline asm.
+ */
+
+#if !defined(FEED_NO_TRACEPOINTS) && defined(__ELF__) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__aarch64__))
+#define FEED_TRACEPOINTS_ENABLED 1
+#else
+#define FEED_TRACEPOINTS_ENABLED 0
+#endif
+
+#define FEED_TRACE_PROVIDER "feed"
+
+#if FEED_TRACEPOINTS_ENABLED
+
+namespace trace_detail {
+
+// Arguments go in by value, so arrays arrive as pointers
+template <typename T>
+inline T decay(T value) {
+  return value;
+}
+
+// Argument size, negated: the template prints it with %n, which negates
+// again, so the note reads "-8@%rax" for a signed 64-bit argument
+template <typename T>
+constexpr int note_size() {
+  return std::is_signed<T>::value ? static_cast<int>(sizeof(T)) : -static_cast<int>(sizeof(T));
+}
+
+} // namespace trace_detail
+
+#define FEED_TRACE_ARG(n, x)                                                                      \
+  [s##n] "n"(trace_detail::note_size<decltype(trace_detail::decay(x))>()),                        \
+  [a##n] "nor"(trace_detail::decay(x))
+
+// The nop, its note, and once per object file the base symbol tracers use
+// to relocate note addresses in a PIE or shared library
+#define FEED_TRACE_NOTE(name, args)                                                               \
+  "990: nop\n"                                                                                    \
+  ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                                   \
+  ".balign 4\n"                                                                                   \
+  ".4byte 992f-991f, 994f-993f, 3\n"                                                              \
+  "991: .asciz \"stapsdt\"\n"                                                                     \
+  "992: .balign 4\n"                                                                              \
+  "993: .8byte 990b\n"                                                                            \
+  ".8byte _.stapsdt.base\n"                                                                       \
+  ".8byte 0\n"                                                                                    \
+  ".asciz \"" FEED_TRACE_PROVIDER "\"\n"                                                          \
+  ".asciz \"" #name "\"\n"                                                                        \
+  ".asciz \"" args "\"\n"                                                                         \
+  "994: .balign 4\n"                                                                              \
+  ".popsection\n"                                                                                 \
+  ".ifndef _.stapsdt.base\n"                                                                      \
+  ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"                         \
+  ".weak _.stapsdt.base\n"                                                                        \
+  ".hidden _.stapsdt.base\n"                                                                      \
+  "_.stapsdt.base: .space 1\n"                                                                    \
+  ".size _.stapsdt.base, 1\n"                                                                     \
+  ".popsection\n"                                                                                 \
+  ".endif\n"
+
+#define FEED_TRACE_0(name) __asm__ __volatile__(FEED_TRACE_NOTE(name, "") ::)
+#define FEED_TRACE_1(name, x1)                                                                    \
+  __asm__ __volatile__(FEED_TRACE_NOTE(name, "%n[s1]@%[a1]")                                      \
+                       :: FEED_TRACE_ARG(1, x1))
+#define FEED_TRACE_2(name, x1, x2)                                                                \
+  __asm__ __volatile__(FEED_TRACE_NOTE(name, "%n[s1]@%[a1] %n[s2]@%[a2]")                         \
+                       :: FEED_TRACE_ARG(1, x1), FEED_TRACE_ARG(2, x2))
+#define FEED_TRACE_3(name, x1, x2, x3)                                                            \
+  __asm__ __volatile__(FEED_TRACE_NOTE(name, "%n[s1]@%[a1] %n[s2]@%[a2] %n[s3]@%[a3]")            \
+                       :: FEED_TRACE_ARG(1, x1), FEED_TRACE_ARG(2, x2), FEED_TRACE_ARG(3, x3))
+#define FEED_TRACE_4(name, x1, x2, x3, x4)                                                        \
+  __asm__ __volatile__(FEED_TRACE_NOTE(name, "%n[s1]@%[a1] %n[s2]@%[a2] %n[s3]@%[a3] %n[s4]@%[a4]") \
+                       :: FEED_TRACE_ARG(1, x1), FEED_TRACE_ARG(2, x2), FEED_TRACE_ARG(3, x3),    \
+                       FEED_TRACE_ARG(4, x4))
+
+// The name counts as an argument: FEED_TRACE(name) picks FEED_TRACE_0
+#define FEED_TRACE_PICK(_0, _1, _2, _3, _4, macro, ...) macro
+#define FEED_TRACE(...)                                                                           \
+  FEED_TRACE_PICK(__VA_ARGS__, FEED_TRACE_4, FEED_TRACE_3, FEED_TRACE_2, FEED_TRACE_1,            \
+                  FEED_TRACE_0, )                                                                 \
+  (__VA_ARGS__)
+
+#else
+
+// Arguments are not evaluated, exactly as if the probe were not there
+#define FEED_TRACE(...) ((void)0)
+
+#endif
+
+#endif // TRACEPOINTS_HPP
@@ -0,0 +1,651 @@
+#ifndef TRANSPORT_HPP
+#define TRANSPORT_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <optional>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "common.hpp"
+
+/**
+ * Feed Transports
+ *
+ * A co-located gateway doesn't need TCP loopback. The same byte stream
+ * (binary or text protocol) can travel over:
+ *
+ *   tcp       TCP (socket_connect), the default
+ *   unix      AF_UNIX stream socket at a path
+ *   unixgram  AF_UNIX datagram socket at a path. The client binds its own
+ *             path and sends a hello datagram; the server then sends whole
+ *             frames per datagram and a zero-length datagram at the end.
+ *             Local datagrams are flow-controlled, not dropped.
+ *   shm       Shared-memory SPSC byte ring (ShmRing), no syscalls per read.
+ *             The reader spins (then yields) waiting for data, so it costs
+ *             a core while idle.
+ *
+ * Readers see recv() semantics on every transport: sockets are read with
+ * recv() on fd(); a shm channel has no fd and is read with ShmRing::read().
+ *
+ * Usage (server):
+ *   TransportListener listener({Transport::SHM, "", 0, "/feed"});
+ *   listener.listen();
+ *   auto channel = listener.accept(100);   // Error "timeout" if nobody came
+ *   channel.value().send_all(frame);
+ *
+ * Usage (client):
+ *   auto channel = transport_connect({Transport::UNIX_STREAM, "", 0, "/tmp/feed.sock"});
+ *   ssize_t n = channel.value().read(buffer, sizeof(buffer));
+ */
+
+enum class Transport {
+  TCP,
+  UNIX_STREAM,
+  UNIX_DGRAM,
+  SHM
+};
+
+inline const char* transport_name(Transport transport) {
+  switch (transport) {
+    case Transport::TCP: return "tcp";
+    case Transport::UNIX_STREAM: return "unix";
+    case Transport::UNIX_DGRAM: return "unixgram";
+    case Transport::SHM: return "shm";
+  }
+  return "?";
+}
+
+inline std::optional<Transport> parse_transport(std::string_view name) {
+  if (name == "tcp") return Transport::TCP;
+  if (name == "unix") return Transport::UNIX_STREAM;
+  if (name == "unixgram") return Transport::UNIX_DGRAM;
+  if (name == "shm") return Transport::SHM;
+  return std::nullopt;
+}
+
+struct Endpoint {
+  Transport transport = Transport::TCP;
+  std::string host = "127.0.0.1";  // TCP
+  int port = 0;                    // TCP
+  std::string path;                // Socket path, or shm object name ("/feed")
+
+  std::string to_string() const {
+    if (transport == Transport::TCP) {
+      return "tcp://" + host + ":" + std::to_string(port);
+    }
+    return std::string(transport_name(transport)) + ":" + path;
+  }
+};
+
+// =============================================================================
+// Shared-Memory Ring
+// =============================================================================
+
+/**
+ * Single-producer single-consumer byte ring in a POSIX shared memory
+ * object. The producer (server) creates it and waits for one reader to
+ * attach; the name is unlinked as soon as it does, so the next create()
+ * under the same name is a fresh ring.
+ *
+ * Positions grow forever; index = pos & (capacity - 1). The writer only
+ * advances write_pos and the reader only read_pos, each with release so
+ * the other side's acquire sees the bytes.
+ */
+class ShmRing {
+public:
+  static constexpr uint64_t MAGIC = 0x31474E49524D4853ULL;  // "SHMRING1"
+  static constexpr size_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+  static constexpr int SPINS_BEFORE_YIELD = 1024;
+  static constexpr int LIVENESS_CHECK_SPINS = 1 << 12;  // Waits between kill(pid, 0) probes
+
+  ~ShmRing() {
+    if (header_) {
+      munmap(header_, mapped_bytes_);
+    }
+    if (owner_ && !unlinked_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  // Producer: create (or replace) the ring `name`
+  static Result<std::unique_ptr<ShmRing>> create(const std::string& name,
+                                                 size_t capacity = DEFAULT_CAPACITY) {
+    size_t rounded = 4096;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return Result<std::unique_ptr<ShmRing>>::error("shm_open " + name + " failed: " +
+                                                     strerror(errno));
+    }
+    size_t bytes = sizeof(Header) + rounded;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) < 0) {
+      std::string err = strerror(errno);
+      close(fd);
+      shm_unlink(name.c_str());
+      return Result<std::unique_ptr<ShmRing>>::error("ftruncate " + name + " failed: " + err);
+    }
+    auto ring = map(fd, name, bytes);
+    if (!ring) {
+      shm_unlink(name.c_str());
+      return ring;
+    }
+    Header* header = new (ring.value()->header_) Header();
+    header->capacity = rounded;
+    header->writer_pid.store(getpid(), std::memory_order_relaxed);
+    header->magic.store(MAGIC, std::memory_order_release);  // Readers wait for this
+    ring.value()->owner_ = true;
+    return ring;
+  }
+
+  // Consumer: attach to `name`, retrying for up to timeout_ms while the
+  // producer hasn't created it yet
+  static Result<std::unique_ptr<ShmRing>> open(const std::string& name, int timeout_ms = 5000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+      int fd = shm_open(name.c_str(), O_RDWR, 0600);
+      if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > sizeof(Header)) {
+          auto ring = map(fd, name, static_cast<size_t>(st.st_size));
+          if (!ring) {
+            return ring;
+          }
+          Header* header = ring.value()->header_;
+          uint32_t expected = 0;
+          if (header->magic.load(std::memory_order_acquire) == MAGIC &&
+              header->reader_attached.compare_exchange_strong(expected, 1)) {
+            header->reader_pid.store(getpid(), std::memory_order_release);
+            return ring;
+          }
+          // Not initialized yet, or another reader has it
+        } else {
+          close(fd);
+        }
+      } else if (errno != ENOENT) {
+        return Result<std::unique_ptr<ShmRing>>::error("shm_open " + name + " failed: " +
+                                                       strerror(errno));
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return Result<std::unique_ptr<ShmRing>>::error("no shm ring " + name + " to attach to");
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  // Producer: wait up to timeout_ms (-1 = forever) for the reader
+  bool wait_for_reader(int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!header_->reader_attached.load(std::memory_order_acquire)) {
+      if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    shm_unlink(name_.c_str());
+    unlinked_ = true;
+    return true;
+  }
+
+  // Producer: copy all of `data` in, waiting while the ring is full.
+  // False once the reader has gone.
+  bool write(const void* data, size_t len) {
+    const char* src = static_cast<const char*>(data);
+    const uint64_t capacity = header_->capacity;
+    uint64_t pos = header_->write_pos.load(std::memory_order_relaxed);
+    int spins = 0;
+    while (len > 0) {
+      uint64_t free = capacity - (pos - header_->read_pos.load(std::memory_order_acquire));
+      if (free == 0) {
+        if (header_->reader_closed.load(std::memory_order_acquire) ||
+            (spins % LIVENESS_CHECK_SPINS == LIVENESS_CHECK_SPINS - 1 &&
+             !process_alive(header_->reader_pid.load(std::memory_order_relaxed)))) {
+          return false;
+        }
+        backoff(spins);
+        continue;
+      }
+      size_t n = std::min<uint64_t>(len, free);
+      size_t offset = pos & (capacity - 1);
+      size_t first = std::min<size_t>(n, capacity - offset);
+      memcpy(data_ + offset, src, first);
+      memcpy(data_, src + first, n - first);
+      pos += n;
+      src += n;
+      len -= n;
+      header_->write_pos.store(pos, std::memory_order_release);
+      spins = 0;
+    }
+    return !header_->reader_closed.load(std::memory_order_relaxed);
+  }
+
+  // Producer: all of `data` or nothing, without waiting. False while no
+  // reader is attached, once it has gone, or if the ring lacks the room.
+  bool try_write(const void* data, size_t len) {
+    if (!header_->reader_attached.load(std::memory_order_acquire) ||
+        header_->reader_closed.load(std::memory_order_acquire)) {
+      return false;
+    }
+    const uint64_t capacity = header_->capacity;
+    uint64_t pos = header_->write_pos.load(std::memory_order_relaxed);
+    if (capacity - (pos - header_->read_pos.load(std::memory_order_acquire)) < len) {
+      return false;
+    }
+    size_t offset = pos & (capacity - 1);
+    size_t first = std::min<size_t>(len, capacity - offset);
+    memcpy(data_ + offset, data, first);
+    memcpy(data_, static_cast<const char*>(data) + first, len - first);
+    header_->write_pos.store(pos + len, std::memory_order_release);
+    return true;
+  }
+
+  // Producer: no more data; the reader gets 0 once it has drained the ring
+  void close_writer() { header_->writer_closed.store(1, std::memory_order_release); }
+
+  /**
+   * Consumer: copy out up to `len` bytes, waiting until there are some.
+   * Returns 0 at end of stream or after close_reader().
+   */
+  ssize_t read(void* buffer, size_t len) {
+    const uint64_t capacity = header_->capacity;
+    uint64_t pos = header_->read_pos.load(std::memory_order_relaxed);
+    int spins = 0;
+    while (true) {
+      uint64_t available = header_->write_pos.load(std::memory_order_acquire) - pos;
+      if (available > 0) {
+        size_t n = std::min<uint64_t>(len, available);
+        size_t offset = pos & (capacity - 1);
+        size_t first = std::min<size_t>(n, capacity - offset);
+        memcpy(buffer, data_ + offset, first);
+        memcpy(static_cast<char*>(buffer) + first, data_, n - first);
+        header_->read_pos.store(pos + n, std::memory_order_release);
+        return static_cast<ssize_t>(n);
+      }
+      if (header_->writer_closed.load(std::memory_order_acquire)) {
+        // Bytes written just before the close
+        if (header_->write_pos.load(std::memory_order_acquire) != pos) continue;
+        return 0;
+      }
+      if (header_->reader_closed.load(std::memory_order_relaxed) ||
+          (spins % LIVENESS_CHECK_SPINS == LIVENESS_CHECK_SPINS - 1 &&
+           !process_alive(header_->writer_pid.load(std::memory_order_relaxed)))) {
+        return 0;  // A writer that died never closes the ring
+      }
+      backoff(spins);
+    }
+  }
+
+  // Consumer: detach; a read() in progress returns 0 and the writer fails.
+  // Safe from another thread.
+  void close_reader() { header_->reader_closed.store(1, std::memory_order_release); }
+
+  size_t capacity() const { return header_->capacity; }
+  const std::string& name() const { return name_; }
+
+private:
+  struct Header {
+    std::atomic<uint64_t> magic{0};
+    uint64_t capacity = 0;
+    std::atomic<uint32_t> reader_attached{0};
+    std::atomic<uint32_t> reader_closed{0};
+    std::atomic<uint32_t> writer_closed{0};
+    std::atomic<int32_t> writer_pid{0};
+    std::atomic<int32_t> reader_pid{0};
+    alignas(64) std::atomic<uint64_t> write_pos{0};
+    alignas(64) std::atomic<uint64_t> read_pos{0};
+    alignas(64) char pad[1];
+  };
+
+  ShmRing(std::string name, Header* header, size_t mapped_bytes)
+      : name_(std::move(name)), header_(header), mapped_bytes_(mapped_bytes),
+        data_(reinterpret_cast<char*>(header) + sizeof(Header)) {}
+
+  static Result<std::unique_ptr<ShmRing>> map(int fd, const std::string& name, size_t bytes) {
+    void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      return Result<std::unique_ptr<ShmRing>>::error("mmap " + name + " failed: " +
+                                                     strerror(errno));
+    }
+    return Result<std::unique_ptr<ShmRing>>(
+        std::unique_ptr<ShmRing>(new ShmRing(name, static_cast<Header*>(addr), bytes)));
+  }
+
+  static bool process_alive(int32_t pid) {
+    return pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH;
+  }
+
+  static void backoff(int& spins) {
+    if (++spins > SPINS_BEFORE_YIELD) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::string name_;
+  Header* header_;
+  size_t mapped_bytes_;
+  char* data_;
+  bool owner_ = false;
+  bool unlinked_ = false;
+};
+
+// =============================================================================
+// Channels
+// =============================================================================
+
+/**
+ * One end of a feed connection on any transport. Move-only; closes on
+ * destruction (a server-side unixgram or shm channel signals end of
+ * stream first).
+ */
+class TransportChannel {
+public:
+  static constexpr const char* HELLO = "HELLO";
+
+  TransportChannel() = default;
+  TransportChannel(Transport transport, int fd, std::string unlink_path = "")
+      : transport_(transport), fd_(fd), unlink_path_(std::move(unlink_path)) {}
+  TransportChannel(std::unique_ptr<ShmRing> ring, bool writer)
+      : transport_(Transport::SHM), ring_(std::move(ring)), writer_(writer) {}
+
+  TransportChannel(TransportChannel&& other) noexcept { *this = std::move(other); }
+  TransportChannel& operator=(TransportChannel&& other) noexcept {
+    if (this != &other) {
+      close();
+      transport_ = other.transport_;
+      fd_ = other.fd_;
+      ring_ = std::move(other.ring_);
+      writer_ = other.writer_;
+      unlink_path_ = std::move(other.unlink_path_);
+      other.fd_ = -1;
+      other.unlink_path_.clear();
+    }
+    return *this;
+  }
+
+  ~TransportChannel() { close(); }
+
+  Transport transport() const { return transport_; }
+  int fd() const { return fd_; }             // -1 for shm
+  ShmRing* ring() const { return ring_.get(); }
+  bool is_open() const { return fd_ >= 0 || ring_ != nullptr; }
+
+  // recv() semantics: bytes read, 0 at end of stream, -1 with errno
+  ssize_t read(void* buffer, size_t len) {
+    return ring_ ? ring_->read(buffer, len) : recv(fd_, buffer, len, 0);
+  }
+
+  // Send everything (a datagram per call on unixgram, so keep calls to
+  // whole frames under the reader's buffer size)
+  bool send_all(std::string_view data) {
+    if (ring_) {
+      return ring_->write(data.data(), data.size());
+    }
+    if (transport_ == Transport::UNIX_DGRAM) {
+      while (send(fd_, data.data(), data.size(), 0) < 0) {
+        if (errno != EINTR) return false;
+      }
+      return true;
+    }
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t n = send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL_COMPAT);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      sent += n;
+    }
+    return true;
+  }
+
+  // Wake a reader blocked in read() from another thread; close() later
+  void shutdown() {
+    if (ring_) {
+      ring_->close_reader();
+    } else if (fd_ >= 0) {
+      ::shutdown(fd_, SHUT_RDWR);
+    }
+  }
+
+  void close() {
+    if (ring_) {
+      if (writer_) ring_->close_writer();
+      ring_.reset();
+    }
+    if (fd_ >= 0) {
+      if (transport_ == Transport::UNIX_DGRAM && unlink_path_.empty()) {
+        send(fd_, "", 0, 0);  // Server side: end of stream
+      }
+      ::close(fd_);
+      fd_ = -1;
+    }
+    if (!unlink_path_.empty()) {
+      unlink(unlink_path_.c_str());
+      unlink_path_.clear();
+    }
+  }
+
+private:
+#ifdef MSG_NOSIGNAL
+  static constexpr int MSG_NOSIGNAL_COMPAT = MSG_NOSIGNAL;
+#else
+  static constexpr int MSG_NOSIGNAL_COMPAT = 0;  // SO_NOSIGPIPE on the socket instead
+#endif
+
+  Transport transport_ = Transport::TCP;
+  int fd_ = -1;
+  std::unique_ptr<ShmRing> ring_;
+  bool writer_ = false;
+  std::string unlink_path_;  // Client-side unixgram address
+};
+
+/**
+ * Connect to a feed on any transport. TCP uses socket_connect() with
+ * `opts`; AF_UNIX honours the buffer sizes; shm waits up to the connect
+ * timeout for the server to create the ring.
+ */
+inline Result<TransportChannel> transport_connect(const Endpoint& endpoint,
+                                                  const SocketOptions& opts = {}) {
+  const int timeout_ms = opts.connect_timeout_ms > 0 ? opts.connect_timeout_ms : 5000;
+  switch (endpoint.transport) {
+    case Transport::TCP: {
+      auto result = socket_connect(endpoint.host, endpoint.port, opts);
+      if (!result) return Result<TransportChannel>::error(result.error());
+      return Result<TransportChannel>(TransportChannel(Transport::TCP, result.value()));
+    }
+    case Transport::UNIX_STREAM: {
+      auto result = unix_socket_connect(endpoint.path, SOCK_STREAM, opts);
+      if (!result) return Result<TransportChannel>::error(result.error());
+      return Result<TransportChannel>(TransportChannel(Transport::UNIX_STREAM, result.value()));
+    }
+    case Transport::UNIX_DGRAM: {
+      // Bound but not connected: the server replies from a socket of its
+      // own, and Linux only lets that socket connect to an unconnected peer
+      static std::atomic<int> counter{0};
+      sockaddr_un server_addr;
+      if (!unix_socket_address(endpoint.path, server_addr)) {
+        return Result<TransportChannel>::error("socket path too long: " + endpoint.path);
+      }
+      std::string local = endpoint.path + "." + std::to_string(getpid()) + "." +
+                          std::to_string(counter.fetch_add(1));
+      auto result = unix_socket_listen(local, SOCK_DGRAM);
+      if (!result) return Result<TransportChannel>::error(result.error());
+      TransportChannel channel(Transport::UNIX_DGRAM, result.value(), local);
+      if (opts.recv_buffer_size > 0) {
+        setsockopt(channel.fd(), SOL_SOCKET, SO_RCVBUF, &opts.recv_buffer_size,
+                   sizeof(opts.recv_buffer_size));
+      }
+      if (sendto(channel.fd(), TransportChannel::HELLO, strlen(TransportChannel::HELLO), 0,
+                 (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        return Result<TransportChannel>::error("hello to " + endpoint.path + " failed: " +
+                                               strerror(errno));
+      }
+      return Result<TransportChannel>(std::move(channel));
+    }
+    case Transport::SHM: {
+      auto ring = ShmRing::open(endpoint.path, timeout_ms);
+      if (!ring) return Result<TransportChannel>::error(ring.error());
+      return Result<TransportChannel>(TransportChannel(std::move(ring.value()), false));
+    }
+  }
+  return Result<TransportChannel>::error("unknown transport");
+}
+
+// =============================================================================
+// Server Side
+// =============================================================================
+
+/**
+ * Accepts feed clients on any transport, one channel per client. A shm
+ * "accept" creates a fresh ring and waits for a reader to attach.
+ */
+class TransportListener {
+public:
+  explicit TransportListener(Endpoint endpoint, size_t shm_capacity = ShmRing::DEFAULT_CAPACITY)
+      : endpoint_(std::move(endpoint)), shm_capacity_(shm_capacity) {}
+
+  ~TransportListener() {
+    if (fd_ >= 0) {
+      close(fd_);
+      if (endpoint_.transport != Transport::TCP) {
+        unlink(endpoint_.path.c_str());
+      }
+    }
+  }
+
+  TransportListener(const TransportListener&) = delete;
+  TransportListener& operator=(const TransportListener&) = delete;
+
+  Result<void> listen() {
+    switch (endpoint_.transport) {
+      case Transport::TCP: {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) {
+          return Result<void>::error("socket creation failed: " + std::string(strerror(errno)));
+        }
+        int opt = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = INADDR_ANY;
+        addr.sin_port = htons(static_cast<uint16_t>(endpoint_.port));
+        if (bind(fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd_, 5) < 0) {
+          std::string err = strerror(errno);
+          close(fd_);
+          fd_ = -1;
+          return Result<void>::error("bind/listen failed: " + err);
+        }
+        return Result<void>();
+      }
+      case Transport::UNIX_STREAM:
+      case Transport::UNIX_DGRAM: {
+        auto result = unix_socket_listen(
+            endpoint_.path, endpoint_.transport == Transport::UNIX_STREAM ? SOCK_STREAM : SOCK_DGRAM);
+        if (!result) return Result<void>::error(result.error());
+        fd_ = result.value();
+        return Result<void>();
+      }
+      case Transport::SHM:
+        return Result<void>();  // The ring is created per accept()
+    }
+    return Result<void>::error("unknown transport");
+  }
+
+  /**
+   * Wait up to timeout_ms (-1 = forever) for the next client. The error
+   * is "timeout" when nobody came, so callers can check a stop flag and
+   * call again.
+   */
+  Result<TransportChannel> accept(int timeout_ms) {
+    if (endpoint_.transport == Transport::SHM) {
+      if (!pending_ring_) {
+        auto ring = ShmRing::create(endpoint_.path, shm_capacity_);
+        if (!ring) return Result<TransportChannel>::error(ring.error());
+        pending_ring_ = std::move(ring.value());
+      }
+      if (!pending_ring_->wait_for_reader(timeout_ms)) {
+        return Result<TransportChannel>::error("timeout");
+      }
+      return Result<TransportChannel>(TransportChannel(std::move(pending_ring_), true));
+    }
+
+    pollfd p{fd_, POLLIN, 0};
+    int ready = ::poll(&p, 1, timeout_ms);
+    if (ready == 0 || (ready < 0 && errno == EINTR)) {
+      return Result<TransportChannel>::error("timeout");
+    }
+    if (ready < 0) {
+      return Result<TransportChannel>::error(std::string("poll failed: ") + strerror(errno));
+    }
+
+    if (endpoint_.transport == Transport::UNIX_DGRAM) {
+      // A hello datagram names the client's address; reply from a socket
+      // connected to it so the listener stays free for the next client
+      char hello[64];
+      sockaddr_un client;
+      socklen_t len = sizeof(client);
+      ssize_t n = recvfrom(fd_, hello, sizeof(hello), 0, (struct sockaddr*)&client, &len);
+      if (n < 0 || len <= offsetof(sockaddr_un, sun_path)) {
+        return Result<TransportChannel>::error("timeout");  // Unnamed sender; ignore
+      }
+      int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+      if (fd < 0 || connect(fd, (struct sockaddr*)&client, len) < 0) {
+        std::string err = strerror(errno);
+        if (fd >= 0) close(fd);
+        return Result<TransportChannel>::error("connect to client failed: " + err);
+      }
+      peer_ = client.sun_path;
+      return Result<TransportChannel>(TransportChannel(Transport::UNIX_DGRAM, fd));
+    }
+
+    sockaddr_storage client;
+    socklen_t len = sizeof(client);
+    int fd = ::accept(fd_, (struct sockaddr*)&client, &len);
+    if (fd < 0) {
+      return Result<TransportChannel>::error(std::string("accept failed: ") + strerror(errno));
+    }
+    if (endpoint_.transport == Transport::TCP) {
+      auto* in = reinterpret_cast<sockaddr_in*>(&client);
+      char ip[INET_ADDRSTRLEN];
+      inet_ntop(AF_INET, &in->sin_addr, ip, sizeof(ip));
+      peer_ = std::string(ip) + ":" + std::to_string(ntohs(in->sin_port));
+    } else {
+      peer_ = "local";
+    }
+    return Result<TransportChannel>(TransportChannel(endpoint_.transport, fd));
+  }
+
+  const Endpoint& endpoint() const { return endpoint_; }
+  const std::string& last_peer() const { return peer_; }  // Of the last accept()
+
+private:
+  Endpoint endpoint_;
+  size_t shm_capacity_;
+  int fd_ = -1;
+  std::unique_ptr<ShmRing> pending_ring_;  // Created, waiting for a reader
+  std::string peer_;
+};
+
+#endif // TRANSPORT_HPP
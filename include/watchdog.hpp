@@ -0,0 +1,401 @@
+#ifndef WATCHDOG_HPP
+#define WATCHDOG_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+
+/**
+ * Stall Watchdog
+ *
+ * Detects pipeline stalls while they are happening instead of after the fact
+ * in exit summaries. Each pipeline stage owns a StageMonitor that it updates
+ * with relaxed atomic stores only (no locks, no syscalls on the hot path):
+ *   - heartbeat counter bumped on every unit of progress
+ *   - current stage state (IDLE / RUNNING / BLOCKED / EXITED)
+ *   - fixed-size ring of recent trace events
+ *
+ * A separate watchdog thread polls the monitors and registered queue depths.
+ * When a busy stage makes no progress for longer than the stall threshold, or
+ * a queue stays above its watermark for too long, it writes a trace dump
+ * (stage states, recent events, queue positions) to a file.
+ *
+ * Usage:
+ *   StageMonitor reader_mon;
+ *   StallWatchdog watchdog(WatchdogConfig{});
+ *   watchdog.watch_stage("reader", reader_mon);
+ *   watchdog.watch_queue("tick_queue", queue);
+ *   watchdog.start();
+ *   // reader thread: reader_mon.beat(); reader_mon.record(TraceEvent::RECV, n);
+ */
+
+// =============================================================================
+// Stage Monitor (written by exactly one stage thread)
+// =============================================================================
+
+enum class StageState : uint8_t { IDLE, RUNNING, BLOCKED, EXITED };
+
+inline const char *stage_state_name(StageState state) {
+  switch (state) {
+  case StageState::IDLE: return "IDLE";
+  case StageState::RUNNING: return "RUNNING";
+  case StageState::BLOCKED: return "BLOCKED";
+  case StageState::EXITED: return "EXITED";
+  default: return "UNKNOWN";
+  }
+}
+
+enum class TraceEvent : uint32_t {
+  RECV = 1,         // value = bytes received
+  PARSED = 2,       // value = messages parsed from one recv
+  QUEUE_FULL = 3,   // value = retries before push succeeded
+  PROCESSED = 4,    // value = sequence/count of processed message
+  DISCONNECT = 5,   // value = errno (0 = orderly close)
+  PARSE_ERROR = 6,  // value = bytes skipped to resync
+};
+
+inline const char *trace_event_name(uint32_t code) {
+  switch (static_cast<TraceEvent>(code)) {
+  case TraceEvent::RECV: return "RECV";
+  case TraceEvent::PARSED: return "PARSED";
+  case TraceEvent::QUEUE_FULL: return "QUEUE_FULL";
+  case TraceEvent::PROCESSED: return "PROCESSED";
+  case TraceEvent::DISCONNECT: return "DISCONNECT";
+  case TraceEvent::PARSE_ERROR: return "PARSE_ERROR";
+  default: return "UNKNOWN";
+  }
+}
+
+struct StageEventRecord {
+  uint64_t timestamp_ns;
+  uint32_t code;
+  uint64_t value;
+};
+
+class StageMonitor {
+public:
+  static constexpr size_t EVENT_RING_SIZE = 64; // Power of 2
+
+  StageMonitor() : heartbeat_(0), state_(StageState::IDLE), event_seq_(0) {
+    for (auto &slot : events_) {
+      slot.stamp.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  StageMonitor(const StageMonitor &) = delete;
+  StageMonitor &operator=(const StageMonitor &) = delete;
+
+  // Record one unit of progress (single writer: plain load + relaxed store)
+  inline void beat() {
+    heartbeat_.store(heartbeat_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+  }
+
+  inline void set_state(StageState state) {
+    state_.store(state, std::memory_order_relaxed);
+  }
+
+  /**
+   * Append an event to the ring. Each slot carries a stamp (event index + 1)
+   * written last with release ordering, so the watchdog can detect slots that
+   * were overwritten while it was reading them and drop them.
+   */
+  inline void record(TraceEvent event, uint64_t value) {
+    const uint64_t idx = event_seq_.load(std::memory_order_relaxed);
+    Slot &slot = events_[idx & (EVENT_RING_SIZE - 1)];
+    slot.stamp.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp_ns.store(now_ns(), std::memory_order_relaxed);
+    slot.code.store(static_cast<uint32_t>(event), std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.stamp.store(idx + 1, std::memory_order_release);
+    event_seq_.store(idx + 1, std::memory_order_release);
+  }
+
+  // Reader side (watchdog thread)
+  uint64_t heartbeat() const {
+    return heartbeat_.load(std::memory_order_relaxed);
+  }
+  StageState state() const { return state_.load(std::memory_order_relaxed); }
+  uint64_t events_recorded() const {
+    return event_seq_.load(std::memory_order_acquire);
+  }
+
+  // Consistent copy of the most recent events, oldest first
+  std::vector<StageEventRecord> recent_events() const {
+    std::vector<StageEventRecord> out;
+    const uint64_t end = event_seq_.load(std::memory_order_acquire);
+    const uint64_t begin = end > EVENT_RING_SIZE ? end - EVENT_RING_SIZE : 0;
+    out.reserve(end - begin);
+
+    for (uint64_t idx = begin; idx < end; ++idx) {
+      const Slot &slot = events_[idx & (EVENT_RING_SIZE - 1)];
+      if (slot.stamp.load(std::memory_order_acquire) != idx + 1) {
+        continue; // Overwritten by the writer
+      }
+      StageEventRecord rec;
+      rec.timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+      rec.code = slot.code.load(std::memory_order_relaxed);
+      rec.value = slot.value.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.stamp.load(std::memory_order_relaxed) != idx + 1) {
+        continue; // Torn read
+      }
+      out.push_back(rec);
+    }
+    return out;
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> stamp;
+    std::atomic<uint64_t> timestamp_ns{0};
+    std::atomic<uint32_t> code{0};
+    std::atomic<uint64_t> value{0};
+  };
+
+  // Heartbeat and state on their own cache line: they are the only fields the
+  // watchdog polls every interval.
+  alignas(64) std::atomic<uint64_t> heartbeat_;
+  std::atomic<StageState> state_;
+
+  alignas(64) std::atomic<uint64_t> event_seq_;
+  std::array<Slot, EVENT_RING_SIZE> events_;
+};
+
+// =============================================================================
+// Watchdog
+// =============================================================================
+
+struct WatchdogConfig {
+  std::chrono::milliseconds poll_interval{10};
+  std::chrono::milliseconds stall_threshold{200};  // Busy stage, no progress
+  double queue_watermark = 0.8;                     // Fraction of capacity
+  std::chrono::milliseconds watermark_duration{100}; // Time above watermark
+  std::chrono::milliseconds dump_cooldown{1000};     // Min gap between dumps
+  std::string dump_prefix = "watchdog_dump";
+  size_t max_dumps = 16;
+};
+
+class StallWatchdog {
+public:
+  explicit StallWatchdog(const WatchdogConfig &config = WatchdogConfig())
+      : config_(config), running_(false), dumps_written_(0),
+        stalls_detected_(0), watermark_breaches_(0), last_dump_ns_(0) {}
+
+  ~StallWatchdog() { stop(); }
+
+  StallWatchdog(const StallWatchdog &) = delete;
+  StallWatchdog &operator=(const StallWatchdog &) = delete;
+
+  // Register before start(); the monitor must outlive the watchdog thread
+  void watch_stage(const std::string &name, const StageMonitor &monitor) {
+    StageWatch w;
+    w.name = name;
+    w.monitor = &monitor;
+    stages_.push_back(std::move(w));
+  }
+
+  // Any queue exposing size() and capacity() (SPSCQueue, SPMCQueue)
+  template <typename Queue>
+  void watch_queue(const std::string &name, const Queue &queue) {
+    watch_queue(name, [&queue]() { return queue.size(); }, queue.capacity());
+  }
+
+  void watch_queue(const std::string &name, std::function<size_t()> depth,
+                   size_t capacity) {
+    QueueWatch w;
+    w.name = name;
+    w.depth = std::move(depth);
+    w.capacity = capacity;
+    queues_.push_back(std::move(w));
+  }
+
+  void start() {
+    if (running_.exchange(true)) {
+      return;
+    }
+    thread_ = std::thread([this]() {
+      while (running_.load(std::memory_order_acquire)) {
+        check_once(now_ns());
+        std::this_thread::sleep_for(config_.poll_interval);
+      }
+    });
+  }
+
+  void stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  /**
+   * Run one polling pass at time now (ns). Exposed so tests can drive the
+   * watchdog deterministically without the background thread.
+   * Returns true if a dump was written.
+   */
+  bool check_once(uint64_t now) {
+    std::string reason;
+
+    for (auto &w : stages_) {
+      const uint64_t hb = w.monitor->heartbeat();
+      const StageState state = w.monitor->state();
+
+      if (hb != w.last_heartbeat || w.last_progress_ns == 0) {
+        w.last_heartbeat = hb;
+        w.last_progress_ns = now;
+        w.stalled = false;
+        continue;
+      }
+
+      // Idle stages are waiting for input, not stalled
+      if (state == StageState::IDLE || state == StageState::EXITED) {
+        w.last_progress_ns = now;
+        w.stalled = false;
+        continue;
+      }
+
+      const uint64_t idle_ns = now - w.last_progress_ns;
+      if (!w.stalled && idle_ns >= to_ns(config_.stall_threshold)) {
+        w.stalled = true;
+        stalls_detected_++;
+        reason += "stage '" + w.name + "' no progress for " +
+                  format_duration_ns(idle_ns) + " (" +
+                  stage_state_name(state) + "); ";
+      }
+    }
+
+    for (auto &w : queues_) {
+      const size_t depth = w.depth();
+      const size_t mark =
+          static_cast<size_t>(static_cast<double>(w.capacity) * config_.queue_watermark);
+
+      if (depth < mark) {
+        w.above_since_ns = 0;
+        w.breached = false;
+        continue;
+      }
+      if (w.above_since_ns == 0) {
+        w.above_since_ns = now;
+      }
+      const uint64_t above_ns = now - w.above_since_ns;
+      if (!w.breached && above_ns >= to_ns(config_.watermark_duration)) {
+        w.breached = true;
+        watermark_breaches_++;
+        reason += "queue '" + w.name + "' depth " + std::to_string(depth) +
+                  "/" + std::to_string(w.capacity) + " above watermark for " +
+                  format_duration_ns(above_ns) + "; ";
+      }
+    }
+
+    if (reason.empty()) {
+      return false;
+    }
+    if (dumps_written_ >= config_.max_dumps) {
+      return false;
+    }
+    if (last_dump_ns_ != 0 &&
+        now - last_dump_ns_ < to_ns(config_.dump_cooldown)) {
+      return false;
+    }
+
+    last_dump_ns_ = now;
+    return write_dump(reason, now);
+  }
+
+  uint64_t dumps_written() const { return dumps_written_; }
+  uint64_t stalls_detected() const { return stalls_detected_; }
+  uint64_t watermark_breaches() const { return watermark_breaches_; }
+  const std::string &last_dump_path() const { return last_dump_path_; }
+
+private:
+  struct StageWatch {
+    std::string name;
+    const StageMonitor *monitor = nullptr;
+    uint64_t last_heartbeat = 0;
+    uint64_t last_progress_ns = 0;
+    bool stalled = false;
+  };
+
+  struct QueueWatch {
+    std::string name;
+    std::function<size_t()> depth;
+    size_t capacity = 0;
+    uint64_t above_since_ns = 0;
+    bool breached = false;
+  };
+
+  static uint64_t to_ns(std::chrono::milliseconds ms) {
+    return static_cast<uint64_t>(ms.count()) * 1'000'000ULL;
+  }
+
+  bool write_dump(const std::string &reason, uint64_t now) {
+    std::string path = config_.dump_prefix + "." +
+                       std::to_string(dumps_written_.load()) + ".txt";
+
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) {
+      LOG_PERROR("Watchdog", "Failed to open dump file");
+      return false;
+    }
+
+    fprintf(f, "=== Watchdog Trace Dump ===\n");
+    fprintf(f, "time_ns: %lu\n", static_cast<unsigned long>(now));
+    fprintf(f, "reason: %s\n\n", reason.c_str());
+
+    fprintf(f, "--- Stages ---\n");
+    for (const auto &w : stages_) {
+      fprintf(f, "[%s] state=%s heartbeat=%lu since_progress=%s\n",
+              w.name.c_str(), stage_state_name(w.monitor->state()),
+              static_cast<unsigned long>(w.monitor->heartbeat()),
+              format_duration_ns(now - w.last_progress_ns).c_str());
+
+      for (const auto &ev : w.monitor->recent_events()) {
+        fprintf(f, "    t-%-12s %-10s %lu\n",
+                format_duration_ns(now > ev.timestamp_ns ? now - ev.timestamp_ns : 0).c_str(),
+                trace_event_name(ev.code), static_cast<unsigned long>(ev.value));
+      }
+    }
+
+    fprintf(f, "\n--- Queues ---\n");
+    for (const auto &w : queues_) {
+      size_t depth = w.depth();
+      fprintf(f, "[%s] depth=%zu capacity=%zu fill=%.1f%%\n", w.name.c_str(),
+              depth, w.capacity,
+              w.capacity ? 100.0 * depth / w.capacity : 0.0);
+    }
+
+    fclose(f);
+
+    dumps_written_++;
+    last_dump_path_ = path;
+    LOG_WARN("Watchdog", "%s-> dump written to %s", reason.c_str(), path.c_str());
+    return true;
+  }
+
+  WatchdogConfig config_;
+  std::vector<StageWatch> stages_;
+  std::vector<QueueWatch> queues_;
+
+  std::thread thread_;
+  std::atomic<bool> running_;
+
+  // Written by the watchdog thread, read by anyone
+  std::atomic<uint64_t> dumps_written_;
+  std::atomic<uint64_t> stalls_detected_;
+  std::atomic<uint64_t> watermark_breaches_;
+  uint64_t last_dump_ns_;
+  std::string last_dump_path_;
+};
+
+#endif // WATCHDOG_HPP
@@ -0,0 +1,47 @@
+#!/bin/bash
+# Static Tracepoint Tracing
+# Attaches a bpftrace script to a running feed handler through its USDT
+# probes (include/tracepoints.hpp). Nothing is rebuilt or restarted.
+#
+# Usage:
+#   sudo ./profiling/trace_feed_handler.sh [stage_latency|feed_events] [pid]
+#   ./profiling/trace_feed_handler.sh --list [binary]
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_ROOT/build"
+
+if [ "$1" = "--list" ]; then
+    BINARY="${2:-$BUILD_DIR/feed_handler}"
+    if [ ! -f "$BINARY" ]; then
+        echo "❌ Binary not found: $BINARY"
+        exit 1
+    fi
+    echo "Probes in $BINARY:"
+    readelf -n "$BINARY" | awk '/Provider:/ {p=$2} /Name:/ {n=$2} /Arguments:/ {$1=""; print "  " p ":" n " " $0}' | sort | uniq -c
+    exit 0
+fi
+
+SCRIPT="${1:-stage_latency}"
+SCRIPT_PATH="$SCRIPT_DIR/$SCRIPT.bt"
+PID="${2:-$(pgrep -n feed_handler)}"
+
+if [ ! -f "$SCRIPT_PATH" ]; then
+    echo "❌ No such script: $SCRIPT_PATH"
+    echo "   Available: $(cd "$SCRIPT_DIR" && ls *.bt | sed 's/\.bt$//' | tr '\n' ' ')"
+    exit 1
+fi
+if ! command -v bpftrace &> /dev/null; then
+    echo "⚠️  bpftrace not found. Install with:"
+    echo "   sudo apt-get install bpftrace"
+    exit 1
+fi
+if [ -z "$PID" ]; then
+    echo "❌ No running feed_handler found (pass a pid)"
+    exit 1
+fi
+
+echo "==================================================================="
+echo "Tracing pid $PID with $SCRIPT.bt (Ctrl-C to stop)"
+echo "==================================================================="
+exec bpftrace -p "$PID" "$SCRIPT_PATH"
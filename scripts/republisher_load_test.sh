@@ -0,0 +1,59 @@
+#!/bin/bash
+# Republisher Load Test
+#
+# Runs republisher_load_test (the publisher) against N binary_client
+# consumers plus one consumer that is SIGSTOPped for the whole run, and
+# prints each side's totals. The stopped consumer exercises the slow-client
+# policy; the others should receive every frame.
+#
+# Usage: ./scripts/republisher_load_test.sh [clients] [events] [rate] [disconnect|drop] [max-delay-us]
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_ROOT/build"
+
+CLIENTS=${1:-20}
+EVENTS=${2:-2000000}
+RATE=${3:-500000}
+POLICY=${4:-disconnect}
+DELAY_US=${5:-200}
+PORT=${PORT:-7100}
+LOG_DIR=$(mktemp -d /tmp/republisher_load.XXXXXX)
+
+echo "=================================================================="
+echo "Republisher Load Test: $CLIENTS clients + 1 stalled, $EVENTS events at ${RATE}/s"
+echo "=================================================================="
+
+if [ ! -f "$BUILD_DIR/republisher_load_test" ] || [ ! -f "$BUILD_DIR/binary_client" ]; then
+    echo "Error: Binaries not found. Run 'make republisher_load_test binary_client' first!"
+    exit 1
+fi
+
+"$BUILD_DIR/republisher_load_test" "$PORT" $((CLIENTS + 1)) "$EVENTS" "$RATE" "$POLICY" "$DELAY_US" \
+    > "$LOG_DIR/publisher.log" 2>&1 &
+PUBLISHER_PID=$!
+sleep 0.5
+
+CLIENT_PIDS=()
+for i in $(seq 1 "$CLIENTS"); do
+    "$BUILD_DIR/binary_client" --quiet "$PORT" > "$LOG_DIR/client_$i.log" 2>&1 &
+    CLIENT_PIDS+=($!)
+done
+"$BUILD_DIR/binary_client" --quiet "$PORT" > "$LOG_DIR/stalled.log" 2>&1 &
+STALLED_PID=$!
+sleep 0.2
+kill -STOP $STALLED_PID
+
+wait $PUBLISHER_PID
+kill -CONT $STALLED_PID
+wait "${CLIENT_PIDS[@]}" $STALLED_PID 2>/dev/null
+
+cat "$LOG_DIR/publisher.log" | grep -v "^\[Republisher\] Client connected"
+echo ""
+echo "Consumers (binary_client):"
+for i in $(seq 1 "$CLIENTS"); do
+    echo "  client $i: $(grep '^Total:' "$LOG_DIR/client_$i.log")"
+done
+echo "  stalled:  $(grep '^Total:' "$LOG_DIR/stalled.log")"
+
+rm -rf "$LOG_DIR"
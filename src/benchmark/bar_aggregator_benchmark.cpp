@@ -0,0 +1,162 @@
+/**
+ * Bar Aggregator Benchmark
+ *
+ * Cost per tick of keeping OHLCV/VWAP bars for K intervals over S symbols.
+ * The same tick stream (timestamps 20 us apart, symbols drawn at random)
+ * goes through:
+ *   naive    per tick, per interval: hash the symbol name into an
+ *            unordered_map, close on window change, fold the tick in
+ *   block    BarAggregator::add() on 256-tick batches: column gather,
+ *            vector kernels for notional and window checks, one fold per
+ *            symbol run into every interval
+ * Both emit the same bars; the last column says whether they agree.
+ *
+ * Usage:
+ *   ./bar_aggregator_benchmark [ticks] [max_symbols]
+ *   ./bar_aggregator_benchmark 4000000 4096
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bar_aggregator.hpp"
+
+namespace {
+
+constexpr uint64_t MS = 1'000'000;
+
+std::vector<net::Tick> make_ticks(size_t count, size_t symbols, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::string> names;
+  for (size_t i = 0; i < symbols; ++i) names.push_back("S" + std::to_string(i));
+  std::vector<net::Tick> ticks(count);
+  uint64_t timestamp = 1'000'000 * MS;
+  for (auto &tick : ticks) {
+    timestamp += 20'000;
+    tick.timestamp = timestamp;
+    std::memset(tick.symbol, 0, sizeof(tick.symbol));
+    const std::string &name = names[rng() % symbols];
+    std::memcpy(tick.symbol, name.data(), std::min<size_t>(name.size(), 7));
+    tick.price = 100.0 + static_cast<double>(rng() % 10000) / 100.0;
+    tick.volume = 1 + static_cast<int64_t>(rng() % 1000);
+  }
+  return ticks;
+}
+
+// Bars emitted and total volume in them: equal for two correct aggregators
+struct Checksum {
+  uint64_t bars = 0;
+  int64_t volume = 0;
+  double notional = 0;
+};
+
+Checksum run_naive(const std::vector<net::Tick> &ticks, const std::vector<uint64_t> &intervals) {
+  struct State {
+    uint64_t start = 0;
+    double open = 0, high = 0, low = 0, close = 0, notional = 0;
+    int64_t volume = 0;
+    uint64_t trades = 0;
+  };
+  Checksum check;
+  std::unordered_map<std::string, std::vector<State>> books;
+  auto emit = [&](const State &s) {
+    ++check.bars;
+    check.volume += s.volume;
+    check.notional += s.notional;
+  };
+  for (const auto &tick : ticks) {
+    auto &states = books[std::string(tick.symbol, strnlen(tick.symbol, sizeof(tick.symbol)))];
+    states.resize(intervals.size());
+    for (size_t k = 0; k < intervals.size(); ++k) {
+      State &s = states[k];
+      uint64_t start = tick.timestamp - tick.timestamp % intervals[k];
+      if (s.trades > 0 && start != s.start) {
+        emit(s);
+        s = State();
+      }
+      if (s.trades == 0) {
+        s.start = start;
+        s.open = s.high = s.low = tick.price;
+      }
+      s.high = std::max(s.high, tick.price);
+      s.low = std::min(s.low, tick.price);
+      s.close = tick.price;
+      s.notional += tick.price * static_cast<double>(tick.volume);
+      s.volume += tick.volume;
+      ++s.trades;
+    }
+  }
+  for (const auto &book : books) {
+    for (const auto &s : book.second) {
+      if (s.trades > 0) emit(s);
+    }
+  }
+  return check;
+}
+
+Checksum run_block(const std::vector<net::Tick> &ticks, const std::vector<uint64_t> &intervals,
+                   size_t symbols) {
+  Checksum check;
+  BarAggregatorConfig config;
+  config.intervals_ns = intervals;
+  config.max_symbols = symbols;
+  BarAggregator aggregator(config);
+  aggregator.set_bar_callback([&](const Bar *bars, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      ++check.bars;
+      check.volume += bars[i].volume;
+      check.notional += bars[i].vwap * static_cast<double>(bars[i].volume);
+    }
+  });
+  for (size_t i = 0; i < ticks.size(); i += net::TickProcessor::DEFAULT_MAX_BATCH) {
+    aggregator.add(&ticks[i], std::min(net::TickProcessor::DEFAULT_MAX_BATCH, ticks.size() - i));
+  }
+  aggregator.flush();
+  return check;
+}
+
+template <typename Fn>
+double ns_per_tick(size_t total, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / total;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+  size_t max_symbols = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+  if (count == 0 || max_symbols == 0) {
+    fprintf(stderr, "Usage: %s [ticks] [max_symbols]\n", argv[0]);
+    return 1;
+  }
+
+  const std::vector<std::vector<uint64_t>> interval_sets = {
+      {1000 * MS}, {1000 * MS, 60'000 * MS}, {100 * MS, 1000 * MS, 10'000 * MS, 60'000 * MS}};
+
+  printf("=== Bar Aggregation: cost per tick ===\n");
+  printf("%zu ticks, 20 us apart, symbols drawn uniformly\n\n", count);
+  printf("%8s %10s %10s %10s %12s %8s\n", "symbols", "intervals", "naive", "block", "block rate",
+         "speedup");
+
+  for (size_t symbols = 16; symbols <= max_symbols; symbols *= 4) {
+    auto ticks = make_ticks(count, symbols, symbols);
+    for (const auto &intervals : interval_sets) {
+      Checksum naive, block;
+      double naive_ns = ns_per_tick(count, [&]() { naive = run_naive(ticks, intervals); });
+      double block_ns = ns_per_tick(count, [&]() { block = run_block(ticks, intervals, symbols); });
+      bool agree = naive.bars == block.bars && naive.volume == block.volume &&
+                   std::abs(naive.notional - block.notional) <= 1e-9 * naive.notional;
+      printf("%8zu %10zu %8.1fns %8.1fns %8.1fM/s %7.1fx%s\n", symbols, intervals.size(), naive_ns,
+             block_ns, 1000.0 / block_ns, naive_ns / block_ns, agree ? "" : "  (bars differ!)");
+    }
+  }
+  return 0;
+}
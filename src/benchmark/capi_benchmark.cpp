@@ -0,0 +1,285 @@
+/**
+ * C ABI Overhead Benchmark
+ *
+ * The same strategy run three ways inside the handler's process, against
+ * the same binary tick stream from a loopback server thread:
+ *   cpp-tick    net::FeedHandler::set_tick_callback (one std::function call per tick)
+ *   cpp-batch   net::FeedHandler::set_batch_callback (runs in place in the queue)
+ *   c-abi       libfeed.so through feed_capi.h (feed_set_batch_callback)
+ *
+ * The strategy keeps a notional per symbol and records receive → callback
+ * latency for every tick, identically in each mode. Rounds interleave the
+ * modes and the median round is reported:
+ *   flat    the server sends as fast as it can: ticks/s from the first
+ *           tick's receive to the last callback, and processor thread CPU
+ *           per tick over the same span
+ *   paced   a fixed tick rate: receive → callback latency percentiles
+ *
+ * Usage:
+ *   ./capi_benchmark [ticks] [paced_rate] [rounds]
+ *   ./capi_benchmark 1000000 100000 5
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "feed_capi.h"
+#include "net/feed.hpp"
+
+namespace {
+
+const char *SYMBOLS[] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA", "META", "NFLX"};
+constexpr size_t NUM_SYMBOLS = sizeof(SYMBOLS) / sizeof(SYMBOLS[0]);
+constexpr size_t SEND_CHUNK = 256;  // Frames per send()
+
+enum class Mode { CPP_TICK, CPP_BATCH, C_ABI };
+
+const char *mode_name(Mode mode) {
+  switch (mode) {
+  case Mode::CPP_TICK:  return "cpp-tick";
+  case Mode::CPP_BATCH: return "cpp-batch";
+  case Mode::C_ABI:     return "c-abi";
+  }
+  return "?";
+}
+
+uint64_t thread_cpu_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + ts.tv_nsec;
+}
+
+int listen_ephemeral(uint16_t &port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(fd, 1) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+    close(fd);
+    return -1;
+  }
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// Prebuilt chunks of SEND_CHUNK frames, so the server's cost per tick is a memcpy
+std::vector<std::string> build_stream(size_t ticks) {
+  std::vector<std::string> chunks;
+  std::string chunk;
+  for (size_t i = 0; i < ticks; ++i) {
+    float price = 100.0f + static_cast<float>(i % 50) * 0.01f;
+    chunk += serialize_tick(i + 1, i, SYMBOLS[i % NUM_SYMBOLS], price,
+                            static_cast<int32_t>(100 + i % 400));
+    if ((i + 1) % SEND_CHUNK == 0 || i + 1 == ticks) {
+      chunks.push_back(std::move(chunk));
+      chunk.clear();
+    }
+  }
+  return chunks;
+}
+
+// Accept one client, send every chunk (paced to rate ticks/s if non-zero), close
+void serve(int listen_fd, const std::vector<std::string> &chunks, uint64_t rate) {
+  int client = accept(listen_fd, nullptr, nullptr);
+  if (client < 0) return;
+  // Sleeps between chunks: a spinning sender would take the core from the
+  // reader and processor on small machines
+  const auto chunk_time = std::chrono::nanoseconds(rate ? SEND_CHUNK * 1'000'000'000ULL / rate : 0);
+  auto next_send = std::chrono::steady_clock::now();
+  for (const auto &chunk : chunks) {
+    if (rate) {
+      std::this_thread::sleep_until(next_send);
+      next_send += chunk_time;
+    }
+    size_t sent = 0;
+    while (sent < chunk.size()) {
+      ssize_t n = send(client, chunk.data() + sent, chunk.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        close(client);
+        return;
+      }
+      sent += n;
+    }
+  }
+  close(client);
+}
+
+// What every mode runs per tick
+struct Strategy {
+  double notional[NUM_SYMBOLS] = {};
+  std::vector<uint64_t> latency;
+  uint64_t ticks = 0;
+  uint64_t first_ns = 0, last_ns = 0;
+  uint64_t first_cpu = 0, last_cpu = 0;
+  uint64_t expected = 0;
+
+  explicit Strategy(size_t total) : expected(total) { latency.reserve(total); }
+
+  inline void on_tick(uint64_t now, const char *symbol, double price, int64_t volume,
+                      uint64_t recv_ns) {
+    notional[static_cast<unsigned char>(symbol[0] ^ symbol[1]) % NUM_SYMBOLS] += price * volume;
+    latency.push_back(now - recv_ns);
+  }
+
+  // Bracket the run on the processor thread: from the first tick's receive
+  inline void mark(size_t count, uint64_t first_recv_ns) {
+    if (ticks == 0) {
+      first_ns = first_recv_ns;
+      first_cpu = thread_cpu_ns();
+    }
+    ticks += count;
+    if (ticks == expected) {
+      last_ns = now_ns();
+      last_cpu = thread_cpu_ns();
+    }
+  }
+};
+
+extern "C" void c_on_ticks(const feed_tick *ticks, size_t count, void *user_data) {
+  Strategy &strategy = *static_cast<Strategy *>(user_data);
+  strategy.mark(count, ticks[0].recv_timestamp_ns);
+  uint64_t now = now_ns();
+  for (size_t i = 0; i < count; ++i) {
+    strategy.on_tick(now, ticks[i].symbol, ticks[i].price, ticks[i].volume,
+                     ticks[i].recv_timestamp_ns);
+  }
+}
+
+struct RunResult {
+  double ticks_per_sec = 0;
+  double cpu_ns_per_tick = 0;
+  uint64_t p50 = 0, p99 = 0, p999 = 0;
+  bool complete = false;
+};
+
+RunResult run(Mode mode, const std::vector<std::string> &chunks, size_t ticks, uint64_t rate) {
+  RunResult result;
+  uint16_t port = 0;
+  int listen_fd = listen_ephemeral(port);
+  if (listen_fd < 0) return result;
+  std::thread server([&]() { serve(listen_fd, chunks, rate); });
+
+  Strategy strategy(ticks);
+  if (mode == Mode::C_ABI) {
+    feed_config config;
+    feed_config_init(&config);
+    config.port = port;
+    config.protocol = FEED_PROTOCOL_BINARY;
+    feed_handler *feed = feed_create(&config);
+    feed_set_batch_callback(feed, c_on_ticks, &strategy);
+    if (feed_start(feed) == FEED_OK) feed_wait(feed);
+    feed_destroy(feed);
+  } else {
+    net::FeedConfig config;
+    config.port = port;
+    config.protocol = net::Protocol::BINARY;
+    net::FeedHandler handler(config);
+    if (mode == Mode::CPP_TICK) {
+      handler.set_tick_callback([&strategy](const net::Tick &tick) {
+        strategy.mark(1, tick.recv_timestamp_ns);
+        strategy.on_tick(now_ns(), tick.symbol, tick.price, tick.volume, tick.recv_timestamp_ns);
+      });
+    } else {
+      handler.set_batch_callback([&strategy](const net::Tick *batch, size_t count) {
+        strategy.mark(count, batch[0].recv_timestamp_ns);
+        uint64_t now = now_ns();
+        for (size_t i = 0; i < count; ++i) {
+          strategy.on_tick(now, batch[i].symbol, batch[i].price, batch[i].volume,
+                           batch[i].recv_timestamp_ns);
+        }
+      });
+    }
+    if (handler.start()) handler.wait();
+  }
+  server.join();
+  close(listen_fd);
+
+  if (strategy.ticks != ticks || strategy.last_ns <= strategy.first_ns) return result;
+  result.complete = true;
+  result.ticks_per_sec = ticks * 1e9 / (strategy.last_ns - strategy.first_ns);
+  result.cpu_ns_per_tick = static_cast<double>(strategy.last_cpu - strategy.first_cpu) / ticks;
+  auto &lat = strategy.latency;
+  std::sort(lat.begin(), lat.end());
+  result.p50 = lat[lat.size() * 50 / 100];
+  result.p99 = lat[lat.size() * 99 / 100];
+  result.p999 = lat[std::min(lat.size() - 1, lat.size() * 999 / 1000)];
+  return result;
+}
+
+template <typename T> T median(std::vector<T> values) {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  size_t ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  uint64_t rate = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100'000;
+  size_t rounds = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 5;
+  if (ticks == 0 || rate == 0 || rounds == 0) {
+    fprintf(stderr, "Usage: %s [ticks] [paced_rate] [rounds]\n", argv[0]);
+    return 1;
+  }
+  Logger::set_level(LogLevel::ERROR);
+
+  const size_t paced_ticks = std::max<size_t>(ticks / 10, SEND_CHUNK);
+  const auto flat_stream = build_stream(ticks);
+  const auto paced_stream = build_stream(paced_ticks);
+  const Mode modes[] = {Mode::CPP_TICK, Mode::CPP_BATCH, Mode::C_ABI};
+
+  printf("=== C ABI Overhead: cpp-tick vs cpp-batch vs c-abi (libfeed.so ABI v%u) ===\n",
+         feed_abi_version());
+  printf("flat: %zu ticks as fast as possible; paced: %zu ticks at %lu/s; median of %zu rounds\n\n",
+         ticks, paced_ticks, static_cast<unsigned long>(rate), rounds);
+
+  std::vector<std::vector<RunResult>> flat(3), paced(3);
+  for (size_t round = 0; round < rounds; ++round) {
+    for (size_t m = 0; m < 3; ++m) {
+      flat[m].push_back(run(modes[m], flat_stream, ticks, 0));
+      paced[m].push_back(run(modes[m], paced_stream, paced_ticks, rate));
+    }
+  }
+
+  printf("%-10s %12s %12s %10s %10s %10s\n", "mode", "flat Mtick/s", "proc ns/tick",
+         "paced p50", "p99", "p99.9");
+  for (size_t m = 0; m < 3; ++m) {
+    std::vector<double> tps, cpu;
+    std::vector<uint64_t> p50, p99, p999;
+    for (const auto &r : flat[m]) {
+      if (!r.complete) continue;
+      tps.push_back(r.ticks_per_sec);
+      cpu.push_back(r.cpu_ns_per_tick);
+    }
+    for (const auto &r : paced[m]) {
+      if (!r.complete) continue;
+      p50.push_back(r.p50);
+      p99.push_back(r.p99);
+      p999.push_back(r.p999);
+    }
+    if (tps.empty() || p50.empty()) {
+      printf("%-10s incomplete (connect failed or ticks lost)\n", mode_name(modes[m]));
+      continue;
+    }
+    printf("%-10s %12.2f %12.1f %8.2fus %8.2fus %8.2fus\n", mode_name(modes[m]),
+           median(tps) / 1e6, median(cpu), median(p50) / 1e3, median(p99) / 1e3,
+           median(p999) / 1e3);
+  }
+  return 0;
+}
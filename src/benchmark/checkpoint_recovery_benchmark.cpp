@@ -0,0 +1,273 @@
+/**
+ * Checkpoint Recovery Benchmark
+ *
+ * Compares restart time for two ways of rebuilding N order books:
+ *
+ *   snapshot   - connect to a loopback server and request a snapshot for
+ *                every symbol, one request/response at a time (what
+ *                feed_handler_snapshot does without a checkpoint)
+ *   checkpoint - open + validate a memory-mapped BookCheckpoint and rebuild
+ *                the books from it
+ *
+ * The checkpoint "view" column is the time until the mapped levels can be
+ * read directly (open + checksum), before any heap OrderBook is built.
+ *
+ * Usage:
+ *   ./checkpoint_recovery_benchmark [symbols] [levels] [trials]
+ *   ./checkpoint_recovery_benchmark 4096 20 5
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "book_checkpoint.hpp"
+
+namespace {
+
+struct SymbolBook {
+  char symbol[4];
+  std::vector<OrderBookLevel> bids;
+  std::vector<OrderBookLevel> asks;
+};
+
+// Four-character base-36 names: "A000", "A001", ...
+std::string symbol_name(size_t i) {
+  static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  std::string s = "A000";
+  for (int pos = 3; pos >= 1 && i > 0; --pos) {
+    s[pos] = digits[i % 36];
+    i /= 36;
+  }
+  s[0] = static_cast<char>('A' + i % 26);
+  return s;
+}
+
+std::vector<SymbolBook> make_universe(size_t symbols, size_t levels) {
+  std::vector<SymbolBook> universe(symbols);
+  for (size_t s = 0; s < symbols; ++s) {
+    std::string name = symbol_name(s);
+    memcpy(universe[s].symbol, name.data(), 4);
+    float mid = 50.0f + static_cast<float>(s % 500);
+    for (size_t l = 1; l <= levels; ++l) {
+      universe[s].bids.push_back({mid - l * 0.01f, 100 * l});
+      universe[s].asks.push_back({mid + l * 0.01f, 100 * l});
+    }
+  }
+  return universe;
+}
+
+bool read_exact(int fd, char *buf, size_t len) {
+  size_t got = 0;
+  while (got < len) {
+    ssize_t n = recv(fd, buf + got, len - got, 0);
+    if (n <= 0) return false;
+    got += n;
+  }
+  return true;
+}
+
+bool send_all(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, 0);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// Answers SNAPSHOT_REQUEST frames until the client disconnects
+void serve_snapshots(int listen_fd, const std::vector<SymbolBook> &universe) {
+  std::unordered_map<std::string, const SymbolBook *> index;
+  std::unordered_map<std::string, std::string> encoded;
+  for (const auto &book : universe) {
+    std::string key(book.symbol, 4);
+    index[key] = &book;
+    encoded[key] = serialize_snapshot_response(0, book.symbol, book.bids, book.asks);
+  }
+
+  int client = accept(listen_fd, nullptr, nullptr);
+  if (client < 0) return;
+  int flag = 1;
+  setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+  char header_buf[MessageHeader::HEADER_SIZE];
+  char payload[SnapshotRequestPayload::PAYLOAD_SIZE];
+  while (read_exact(client, header_buf, sizeof(header_buf))) {
+    MessageHeader header = deserialize_header(header_buf);
+    if (header.length != sizeof(payload) || !read_exact(client, payload, sizeof(payload))) {
+      break;
+    }
+    auto it = encoded.find(std::string(payload, 4));
+    if (it == encoded.end() || !send_all(client, it->second)) {
+      break;
+    }
+  }
+  close(client);
+}
+
+int listen_ephemeral(uint16_t &port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(fd, 1) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+    close(fd);
+    return -1;
+  }
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// Returns elapsed ns, or 0 on failure
+uint64_t snapshot_recovery(const std::vector<SymbolBook> &universe,
+                           std::unordered_map<std::string, OrderBook> &books) {
+  uint16_t port = 0;
+  int listen_fd = listen_ephemeral(port);
+  if (listen_fd < 0) return 0;
+  std::thread server(serve_snapshots, listen_fd, std::cref(universe));
+
+  uint64_t start = now_ns();
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bool ok = connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+  int flag = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+  std::vector<char> payload;
+  std::vector<OrderBookLevel> bids, asks;
+  char header_buf[MessageHeader::HEADER_SIZE];
+  char symbol[4];
+  for (size_t i = 0; ok && i < universe.size(); ++i) {
+    ok = send_all(fd, serialize_snapshot_request(i + 1, universe[i].symbol)) &&
+         read_exact(fd, header_buf, sizeof(header_buf));
+    if (!ok) break;
+    MessageHeader header = deserialize_header(header_buf);
+    payload.resize(header.length);
+    ok = read_exact(fd, payload.data(), header.length);
+    if (!ok) break;
+    deserialize_snapshot_response(payload.data(), header.length, symbol, bids, asks);
+    books[std::string(symbol, 4)].load_snapshot(bids, asks);
+  }
+  uint64_t elapsed = now_ns() - start;
+
+  close(fd);
+  server.join();
+  close(listen_fd);
+  return ok ? elapsed : 0;
+}
+
+struct CheckpointTiming {
+  uint64_t view_ns = 0;
+  uint64_t total_ns = 0;
+};
+
+CheckpointTiming checkpoint_recovery(const std::string &path, size_t levels,
+                                     std::unordered_map<std::string, OrderBook> &books) {
+  CheckpointTiming timing;
+  uint64_t start = now_ns();
+
+  // Geometry comes from the existing file's header
+  auto cp = BookCheckpoint::open(path, 1, static_cast<uint32_t>(levels));
+  if (!cp.ok()) return timing;
+  auto view = cp.value()->load();
+  if (!view) return timing;
+  timing.view_ns = now_ns() - start;
+
+  books.reserve(view->size());
+  for (size_t i = 0; i < view->size(); ++i) {
+    view->restore(i, books[view->symbol(i)]);
+  }
+  timing.total_ns = now_ns() - start;
+  return timing;
+}
+
+double median_ms(std::vector<uint64_t> samples) {
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2] / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t symbols = argc > 1 ? std::stoul(argv[1]) : 4096;
+  size_t levels = argc > 2 ? std::stoul(argv[2]) : 20;
+  int trials = argc > 3 ? std::atoi(argv[3]) : 5;
+  levels = std::min<size_t>(levels, 255); // Snapshot response count field is 8-bit
+
+  std::cout << "=== Checkpoint Recovery Benchmark ===" << std::endl;
+  std::cout << "Symbols: " << symbols << ", levels per side: " << levels
+            << ", trials: " << trials << "\n" << std::endl;
+
+  auto universe = make_universe(symbols, levels);
+
+  // Write the checkpoint once, as a running handler would have
+  std::string path = "/tmp/checkpoint_recovery_benchmark_" + std::to_string(getpid()) + ".ckpt";
+  {
+    auto cp = BookCheckpoint::open(path, static_cast<uint32_t>(symbols),
+                                   static_cast<uint32_t>(levels));
+    if (!cp.ok()) {
+      std::cerr << "Checkpoint open failed: " << cp.error() << std::endl;
+      return 1;
+    }
+    uint64_t start = now_ns();
+    cp.value()->begin();
+    for (const auto &sb : universe) {
+      OrderBook book;
+      book.load_snapshot(sb.bids, sb.asks);
+      cp.value()->add_book(std::string_view(sb.symbol, 4), book, 1);
+    }
+    cp.value()->commit(1, true);
+    std::cout << "Checkpoint write: " << format_duration_ns(now_ns() - start) << " ("
+              << cp.value()->file_size() / 1024 << " KB)\n" << std::endl;
+  }
+
+  std::vector<uint64_t> snapshot_ns, view_ns, checkpoint_ns;
+  for (int t = 0; t < trials; ++t) {
+    std::unordered_map<std::string, OrderBook> from_snapshot, from_checkpoint;
+
+    uint64_t s = snapshot_recovery(universe, from_snapshot);
+    if (s == 0) {
+      std::cerr << "Snapshot recovery failed" << std::endl;
+      return 1;
+    }
+    CheckpointTiming c = checkpoint_recovery(path, levels, from_checkpoint);
+    if (c.total_ns == 0 || from_checkpoint.size() != symbols) {
+      std::cerr << "Checkpoint recovery failed" << std::endl;
+      return 1;
+    }
+
+    snapshot_ns.push_back(s);
+    view_ns.push_back(c.view_ns);
+    checkpoint_ns.push_back(c.total_ns);
+  }
+  std::remove(path.c_str());
+
+  double snap = median_ms(snapshot_ns);
+  double ckpt = median_ms(checkpoint_ns);
+  printf("%-22s %12s\n", "method (median)", "startup ms");
+  printf("%-22s %12.2f\n", "snapshot requests", snap);
+  printf("%-22s %12.2f\n", "checkpoint view", median_ms(view_ns));
+  printf("%-22s %12.2f\n", "checkpoint + rebuild", ckpt);
+  printf("\nSpeedup (rebuild): %.1fx\n", ckpt > 0 ? snap / ckpt : 0.0);
+  return 0;
+}
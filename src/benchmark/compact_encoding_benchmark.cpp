@@ -0,0 +1,215 @@
+/**
+ * Compact Encoding Benchmark
+ *
+ * Bytes per tick and encode/decode CPU per tick for plain TICK messages vs
+ * COMPACT_TICKS batches of several sizes, on a synthetic stream: random-walk
+ * prices on a cent grid, microsecond-scale timestamp gaps. From the two it
+ * works out the link speed below which the compact encoding's extra CPU is
+ * paid for by the bytes it saves. Also times the branch-light varint decode
+ * against the byte-at-a-time loop.
+ *
+ * Usage:
+ *   ./compact_encoding_benchmark [ticks] [symbols]
+ *   ./compact_encoding_benchmark 1000000 64
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "compact_encoding.hpp"
+
+namespace {
+
+std::vector<TickPayload> make_stream(size_t count, size_t symbols) {
+  std::mt19937_64 rng(42);
+  std::exponential_distribution<double> gap_us(0.5);      // ~2 us between ticks
+  std::uniform_int_distribution<int> step(-3, 3);         // Cents per tick
+  std::uniform_int_distribution<int> lots(1, 20);
+  std::uniform_int_distribution<size_t> pick(0, symbols - 1);
+
+  std::vector<int64_t> cents(symbols);
+  for (size_t s = 0; s < symbols; ++s) cents[s] = 5000 + static_cast<int64_t>(s) * 137;
+
+  std::vector<TickPayload> stream(count);
+  uint64_t timestamp = 1'700'000'000'000'000'000ULL;
+  for (auto& tick : stream) {
+    size_t s = pick(rng);
+    timestamp += static_cast<uint64_t>(gap_us(rng) * 1000.0);
+    cents[s] = std::max<int64_t>(1, cents[s] + step(rng));
+
+    char name[24];
+    snprintf(name, sizeof(name), "S%03zu", s % 1000);
+    memcpy(tick.symbol, name, 4);
+    tick.timestamp = timestamp;
+    tick.price = ticks_to_price(cents[s]);
+    tick.volume = 100 * lots(rng);
+  }
+  return stream;
+}
+
+struct EncodingResult {
+  double bytes_per_tick;
+  double encode_ns;
+  double decode_ns;
+};
+
+template <typename Fn>
+uint64_t time_best(int trials, Fn&& fn) {
+  uint64_t best = UINT64_MAX;
+  for (int t = 0; t < trials; ++t) {
+    uint64_t start = now_ns();
+    fn();
+    best = std::min(best, now_ns() - start);
+  }
+  return best;
+}
+
+EncodingResult run_plain(const std::vector<TickPayload>& stream) {
+  std::string wire;
+  wire.reserve(stream.size() * 33);
+  uint64_t encode = time_best(3, [&] {
+    wire.clear();
+    uint64_t seq = 1;
+    for (const auto& tick : stream) {
+      serialize_header(wire, MessageType::TICK, seq++, TickPayload::PAYLOAD_SIZE);
+      uint64_t ts = htonll(tick.timestamp);
+      wire.append(reinterpret_cast<const char*>(&ts), 8);
+      wire.append(tick.symbol, 4);
+      uint32_t bits;
+      memcpy(&bits, &tick.price, 4);
+      bits = htonl(bits);
+      wire.append(reinterpret_cast<const char*>(&bits), 4);
+      uint32_t volume = htonl(static_cast<uint32_t>(tick.volume));
+      wire.append(reinterpret_cast<const char*>(&volume), 4);
+    }
+  });
+
+  volatile uint64_t sink = 0;
+  uint64_t decode = time_best(3, [&] {
+    uint64_t sum = 0;
+    for (size_t off = 0; off < wire.size();) {
+      MessageHeader header = deserialize_header(wire.data() + off);
+      TickPayload tick = deserialize_tick_payload(wire.data() + off + MessageHeader::HEADER_SIZE);
+      sum += tick.timestamp + tick.volume + static_cast<uint64_t>(tick.price);
+      off += MessageHeader::HEADER_SIZE + header.length;
+    }
+    sink = sum;
+  });
+  (void)sink;
+
+  double n = static_cast<double>(stream.size());
+  return {wire.size() / n, encode / n, decode / n};
+}
+
+EncodingResult run_compact(const std::vector<TickPayload>& stream, size_t batch) {
+  std::string wire;
+  wire.reserve(stream.size() * 16);
+  uint64_t encode = time_best(3, [&] {
+    wire.clear();
+    CompactTickEncoder encoder;
+    for (size_t i = 0; i < stream.size(); i += batch) {
+      size_t count = std::min(batch, stream.size() - i);
+      encoder.encode(wire, i + 1, stream.data() + i, count);
+    }
+  });
+
+  volatile uint64_t sink = 0;
+  size_t decoded = 0;
+  uint64_t decode = time_best(3, [&] {
+    CompactTickDecoder decoder;
+    uint64_t sum = 0;
+    decoded = 0;
+    for (size_t off = 0; off < wire.size();) {
+      MessageHeader header = deserialize_header(wire.data() + off);
+      decoder.decode(header, wire.data() + off + MessageHeader::HEADER_SIZE,
+                     [&](uint64_t, const TickPayload& tick) {
+                       sum += tick.timestamp + tick.volume + static_cast<uint64_t>(tick.price);
+                       decoded++;
+                     });
+      off += MessageHeader::HEADER_SIZE + header.length;
+    }
+    sink = sum;
+  });
+  (void)sink;
+  if (decoded != stream.size()) {
+    std::cerr << "Decoded " << decoded << " of " << stream.size() << " ticks" << std::endl;
+  }
+
+  double n = static_cast<double>(stream.size());
+  return {wire.size() / n, encode / n, decode / n};
+}
+
+void varint_decode_comparison() {
+  // Mix of sizes like a tick stream: mostly 1-3 bytes, some timestamps longer
+  std::mt19937_64 rng(7);
+  std::string buffer;
+  const size_t count = 4'000'000;
+  for (size_t i = 0; i < count; ++i) {
+    int bits = static_cast<int>(rng() % 100) < 80 ? 14 : 35;
+    append_varint(buffer, rng() & ((1ULL << bits) - 1));
+  }
+  buffer.append(8, '\0');  // Slack so the fast path can load 8 bytes at the end
+
+  auto run = [&](auto decode) {
+    volatile uint64_t sink = 0;
+    return time_best(3, [&] {
+      uint64_t sum = 0, value = 0;
+      const char* p = buffer.data();
+      const char* end = buffer.data() + buffer.size();
+      for (size_t i = 0; i < count; ++i) {
+        p += decode(p, end - p, value);
+        sum += value;
+      }
+      sink = sum;
+    }) / static_cast<double>(count);
+  };
+
+  double slow = run([](const char* p, size_t n, uint64_t& v) { return decode_varint_slow(p, n, v); });
+  double fast = run([](const char* p, size_t n, uint64_t& v) { return decode_varint(p, n, v); });
+  printf("\nVarint decode (80%% <= 14 bits, 20%% <= 35 bits)\n");
+  printf("  byte loop:     %6.2f ns/varint\n", slow);
+  printf("  branch-light:  %6.2f ns/varint (%.2fx)\n", fast, slow / fast);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t ticks = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+  size_t symbols = argc > 2 ? std::max<size_t>(1, std::stoul(argv[2])) : 64;
+
+  std::cout << "=== Compact Encoding Benchmark ===" << std::endl;
+  std::cout << "Ticks: " << ticks << ", symbols: " << symbols << std::endl << std::endl;
+
+  auto stream = make_stream(ticks, symbols);
+  EncodingResult plain = run_plain(stream);
+
+  printf("%-18s %12s %12s %12s %20s\n", "encoding", "bytes/tick", "encode ns", "decode ns",
+         "wins below (Gbps)");
+  printf("%-18s %12.1f %12.1f %12.1f %20s\n", "TICK", plain.bytes_per_tick, plain.encode_ns,
+         plain.decode_ns, "-");
+
+  for (size_t batch : {1, 8, 64, 512}) {
+    EncodingResult compact = run_compact(stream, batch);
+    // Extra CPU per tick vs time the saved bytes take on the wire: bits/ns = Gbps
+    double extra_ns = (compact.encode_ns + compact.decode_ns) - (plain.encode_ns + plain.decode_ns);
+    double saved_bits = (plain.bytes_per_tick - compact.bytes_per_tick) * 8;
+    char breakeven[32];
+    if (extra_ns <= 0) {
+      snprintf(breakeven, sizeof(breakeven), "any");
+    } else {
+      snprintf(breakeven, sizeof(breakeven), "%.1f", saved_bits / extra_ns);
+    }
+    std::string label = "COMPACT x" + std::to_string(batch);
+    printf("%-18s %12.1f %12.1f %12.1f %20s\n", label.c_str(), compact.bytes_per_tick,
+           compact.encode_ns, compact.decode_ns, breakeven);
+  }
+
+  varint_decode_comparison();
+  return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * Distribution Benchmark
+ *
+ * One DistributionServer fanning a tick stream out to local subscribers
+ * with overlapping interests: 48 subscribers each take a window of 50
+ * symbols (windows step by 10, so every symbol has ~5 of them) and 2 take
+ * everything. Each subscriber is a thread reading its socket; latency is
+ * publish to receive, from the timestamp carried in the tick.
+ *
+ * Each scenario runs flat out (throughput; latency is mostly queueing) and
+ * paced at 100k events/s (latency at a realistic load): all subscribers
+ * reading, then with one extra subscriber that subscribes to everything
+ * and never reads, to show it is evicted without slowing the others down.
+ *
+ * Usage:
+ *   ./distribution_benchmark [events] [subscribers]
+ *   ./distribution_benchmark 1000000 50
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common.hpp"
+#include "distribution.hpp"
+#include "message_views.hpp"
+
+namespace {
+
+constexpr size_t UNIVERSE = 500;
+constexpr size_t WINDOW = 50;
+constexpr size_t WINDOW_STEP = 10;
+constexpr size_t WILDCARDS = 2;
+
+std::string symbol_name(size_t i) {
+  std::string s(4, 'A');
+  for (int c = 3; c >= 0; --c) {
+    s[c] = static_cast<char>('A' + i % 26);
+    i /= 26;
+  }
+  return s;
+}
+
+struct SubscriberThread {
+  DistributionClient client;
+  LatencyStats latency;
+  uint64_t frames = 0;
+  std::thread thread;
+
+  explicit SubscriberThread(const std::string& path) : client(path) { latency.reserve(1 << 20); }
+};
+
+struct RunResult {
+  double publish_ns_per_event;
+  uint64_t frames_sent;
+  uint64_t evictions;
+  LatencyStats latency;
+  double wall_ms;
+};
+
+// rate = 0: publish as fast as possible, 256 events between polls
+RunResult run(size_t events, size_t subscribers, bool stalled, uint64_t rate) {
+  std::string path = "/tmp/distribution_benchmark_" + std::to_string(getpid());
+  auto server = std::make_unique<DistributionServer>(path);
+  auto listening = server->listen();
+  if (!listening) {
+    std::cerr << listening.error() << std::endl;
+    exit(1);
+  }
+
+  std::vector<std::unique_ptr<SubscriberThread>> subs;
+  for (size_t s = 0; s < subscribers; ++s) {
+    auto sub = std::make_unique<SubscriberThread>(path);
+    if (!sub->client.connect()) exit(1);
+    if (s < WILDCARDS) {
+      sub->client.subscribe_all();
+    } else {
+      std::vector<std::string> window;
+      for (size_t k = 0; k < WINDOW; ++k) {
+        window.push_back(symbol_name(((s - WILDCARDS) * WINDOW_STEP + k) % UNIVERSE));
+      }
+      sub->client.subscribe(window);
+    }
+    subs.push_back(std::move(sub));
+  }
+  DistributionClient stalled_client(path);
+  if (stalled) {
+    stalled_client.connect();
+    stalled_client.subscribe_all();
+  }
+
+  size_t expected = subscribers + (stalled ? 1 : 0);
+  while (server->subscribers() < expected) server->poll();
+  for (int i = 0; i < 50; ++i) {  // Requests
+    server->poll();
+    usleep(1000);
+  }
+
+  for (auto& sub : subs) {
+    SubscriberThread* s = sub.get();
+    s->thread = std::thread([s] {
+      while (s->client.poll(50, [s](const MessageHeader& header, const char* payload) {
+        if (header.type == MessageType::TICK) {
+          s->latency.add(now_ns() - TickView(payload).timestamp());
+        }
+        s->frames++;
+      })) {
+      }
+    });
+  }
+
+  std::mt19937_64 rng(11);
+  std::vector<std::string> names;
+  for (size_t i = 0; i < UNIVERSE; ++i) names.push_back(symbol_name(i));
+
+  uint64_t publish_ns = 0;
+  uint64_t start = now_ns();
+  for (size_t e = 0; e < events;) {
+    // Everything due by now (paced) or the next 256 events, then one poll
+    size_t due = rate ? std::min<size_t>(events, (now_ns() - start) * rate / 1'000'000'000ULL + 1)
+                      : std::min<size_t>(events, e + 256);
+    uint64_t t0 = now_ns();
+    for (; e < due; ++e) {
+      server->publish_tick(now_ns(), names[rng() % UNIVERSE].c_str(), 100.0f, 100);
+    }
+    publish_ns += now_ns() - t0;
+    server->poll();
+  }
+  while (server->poll()) {
+  }
+  uint64_t wall = now_ns() - start;
+
+  RunResult result;
+  result.publish_ns_per_event = static_cast<double>(publish_ns) / events;
+  result.frames_sent = server->frames_sent();
+  result.evictions = server->slow_evictions();
+  result.wall_ms = wall / 1e6;
+
+  // Closing the server ends every subscriber's loop once it has drained
+  server.reset();
+  for (auto& sub : subs) {
+    sub->thread.join();
+    for (uint64_t v : sub->latency.data()) result.latency.add(v);
+  }
+  return result;
+}
+
+void print(const char* label, size_t events, const RunResult& r) {
+  printf("%-28s %8.0f %10.2f %10.1f %10.1f %10.1f %6lu\n", label, events / (r.wall_ms / 1000.0),
+         r.publish_ns_per_event, static_cast<double>(r.frames_sent) / events,
+         r.latency.percentile(50) / 1000.0, r.latency.percentile(99) / 1000.0,
+         static_cast<unsigned long>(r.evictions));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t events = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+  size_t subscribers = argc > 2 ? std::max<size_t>(WILDCARDS + 1, std::stoul(argv[2])) : 50;
+
+  std::cout << "=== Distribution Benchmark ===" << std::endl;
+  std::cout << "Events: " << events << ", subscribers: " << subscribers << " (" << WILDCARDS
+            << " take everything, the rest " << WINDOW << " of " << UNIVERSE << " symbols)"
+            << std::endl
+            << std::endl;
+
+  printf("%-28s %8s %10s %10s %10s %10s %6s\n", "", "events/s", "publish ns", "frames/evt",
+         "p50 us", "p99 us", "evict");
+  const uint64_t rate = 100'000;
+  const size_t paced = std::min<size_t>(events, 2 * rate);
+  print("flat out", events, run(events, subscribers, false, 0));
+  print("flat out, +1 stalled", events, run(events, subscribers, true, 0));
+  print("100k/s", paced, run(paced, subscribers, false, rate));
+  print("100k/s, +1 stalled", paced, run(paced, subscribers, true, rate));
+  return 0;
+}
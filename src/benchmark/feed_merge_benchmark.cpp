@@ -0,0 +1,194 @@
+/**
+ * Multi-Feed Merge Benchmark
+ *
+ * Cost per tick of merging N timestamp-ordered inputs into one stream,
+ * N = 1, 2, 4, ... up to max_inputs. The same ticks (a fixed total, each
+ * assigned to a random input, so every input stays in order) go through:
+ *   tree     TournamentTree over in-memory inputs: the bare merge
+ *   heap     std::priority_queue over the same, for comparison
+ *   merger   FeedMerger: ticks pushed through its SPSC input queues and
+ *            polled out in batches, on one thread (the live path's work
+ *            without the cross-thread traffic)
+ *   replay   FeedReplay over one capture file per input: read, decode
+ *            and merge (page cache warm)
+ *
+ * Usage:
+ *   ./feed_merge_benchmark [total_ticks] [max_inputs]
+ *   ./feed_merge_benchmark 2000000 128
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "feed_merge.hpp"
+
+namespace {
+
+using Inputs = std::vector<std::vector<net::Tick>>;
+
+Inputs make_inputs(size_t inputs, size_t total, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  Inputs result(inputs);
+  uint64_t timestamp = 0;
+  for (size_t i = 0; i < total; ++i) {
+    timestamp += rng() % 4;  // Some ties
+    net::Tick tick;
+    tick.timestamp = timestamp;
+    std::memcpy(tick.symbol, "AAPL", 5);
+    tick.price = 100.0;
+    tick.volume = static_cast<int64_t>(i);
+    tick.recv_timestamp_ns = ~0ULL;  // Never "waited long enough": exact merge
+    result[rng() % inputs].push_back(tick);
+  }
+  return result;
+}
+
+template <typename Fn>
+double ns_per_tick(size_t total, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / total;
+}
+
+// Sum of timestamps, in output order weighted by position: same for every
+// correct merge (up to the order of ties, which carry equal timestamps)
+struct Checksum {
+  uint64_t position = 0;
+  uint64_t sum = 0;
+  void add(const net::Tick &tick) { sum += tick.timestamp * ++position; }
+};
+
+uint64_t merge_tree(const Inputs &inputs) {
+  Checksum check;
+  TournamentTree tree(inputs.size());
+  std::vector<size_t> next(inputs.size(), 0);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!inputs[i].empty()) tree.set(i, inputs[i][0].timestamp);
+  }
+  while (tree.winner_key() != TournamentTree::EMPTY) {
+    size_t i = tree.winner();
+    check.add(inputs[i][next[i]]);
+    ++next[i];
+    tree.set(i, next[i] < inputs[i].size() ? inputs[i][next[i]].timestamp : TournamentTree::EMPTY);
+  }
+  return check.sum;
+}
+
+uint64_t merge_heap(const Inputs &inputs) {
+  Checksum check;
+  using Entry = std::pair<uint64_t, size_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  std::vector<size_t> next(inputs.size(), 0);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!inputs[i].empty()) heap.emplace(inputs[i][0].timestamp, i);
+  }
+  while (!heap.empty()) {
+    size_t i = heap.top().second;
+    heap.pop();
+    check.add(inputs[i][next[i]]);
+    if (++next[i] < inputs[i].size()) heap.emplace(inputs[i][next[i]].timestamp, i);
+  }
+  return check.sum;
+}
+
+uint64_t merge_queues(const Inputs &inputs) {
+  Checksum check;
+  net::FeedMergeConfig config;
+  config.inputs = inputs.size();
+  config.queue_capacity = 4096;
+  net::FeedMerger merger(config);
+  std::vector<size_t> next(inputs.size(), 0);
+  auto deliver = [&](const net::Tick *ticks, size_t count) {
+    for (size_t k = 0; k < count; ++k) check.add(ticks[k]);
+  };
+  while (!merger.finished()) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      while (next[i] < inputs[i].size() && merger.push(i, inputs[i][next[i]])) {
+        ++next[i];
+      }
+      if (next[i] == inputs[i].size()) merger.close(i);
+    }
+    while (merger.poll(deliver) > 0) {
+    }
+  }
+  return check.sum;
+}
+
+struct Capture {
+  std::vector<std::string> paths;
+  ~Capture() {
+    for (const auto &path : paths) unlink(path.c_str());
+  }
+};
+
+bool write_capture(const Inputs &inputs, Capture &capture) {
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    char name[] = "/tmp/feed_merge_benchXXXXXX";
+    int fd = mkstemp(name);
+    if (fd < 0) return false;
+    capture.paths.push_back(name);
+    std::string frames;
+    uint64_t sequence = 0;
+    for (const auto &tick : inputs[i]) {
+      frames += serialize_tick(++sequence, tick.timestamp, "AAPL", 100.0f,
+                               static_cast<int32_t>(tick.volume));
+    }
+    bool ok = write(fd, frames.data(), frames.size()) == static_cast<ssize_t>(frames.size());
+    close(fd);
+    if (!ok) return false;
+  }
+  return true;
+}
+
+uint64_t merge_replay(const Capture &capture) {
+  Checksum check;
+  auto stats = net::FeedReplay(capture.paths).run([&](const net::Tick *ticks, size_t count) {
+    for (size_t k = 0; k < count; ++k) check.add(ticks[k]);
+  });
+  return stats.ok() ? check.sum : 0;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+  size_t max_inputs = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 128;
+  if (total == 0 || max_inputs == 0) {
+    fprintf(stderr, "Usage: %s [total_ticks] [max_inputs]\n", argv[0]);
+    return 1;
+  }
+
+  printf("=== Multi-Feed Merge: cost per tick vs inputs ===\n");
+  printf("%zu ticks in total, spread at random over N in-order inputs\n\n", total);
+  printf("%7s %10s %10s %10s %10s %14s\n", "inputs", "tree", "heap", "merger", "replay",
+         "replay rate");
+
+  for (size_t inputs = 1; inputs <= max_inputs; inputs *= 2) {
+    Inputs data = make_inputs(inputs, total, inputs);
+    uint64_t expected = 0, heap_sum = 0, queue_sum = 0, replay_sum = 0;
+    double tree_ns = ns_per_tick(total, [&]() { expected = merge_tree(data); });
+    double heap_ns = ns_per_tick(total, [&]() { heap_sum = merge_heap(data); });
+    double queue_ns = ns_per_tick(total, [&]() { queue_sum = merge_queues(data); });
+
+    Capture capture;
+    double replay_ns = 0;
+    if (write_capture(data, capture)) {
+      merge_replay(capture);  // Warm the page cache
+      replay_ns = ns_per_tick(total, [&]() { replay_sum = merge_replay(capture); });
+    }
+    bool agree = heap_sum == expected && queue_sum == expected && replay_sum == expected;
+    printf("%7zu %8.1fns %8.1fns %8.1fns %8.1fns %9.1fM/s%s\n", inputs, tree_ns, heap_ns,
+           queue_ns, replay_ns, replay_ns > 0 ? 1000.0 / replay_ns : 0.0,
+           agree ? "" : "  (outputs differ!)");
+  }
+  return 0;
+}
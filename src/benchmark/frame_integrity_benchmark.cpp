@@ -0,0 +1,203 @@
+/**
+ * Frame Integrity Benchmark
+ *
+ * Cost per frame of the reader's integrity checks on a stream of TICK
+ * frames: the old unchecked walk, the length/type bounds check, and the
+ * CRC32C trailer with the table fallback and the crc32 instruction, each
+ * inline and through scan_frames() as BinaryProtocolReader runs it. Then
+ * CRC32C throughput on snapshot-sized buffers, and the resync scan over
+ * garbage.
+ *
+ * Usage:
+ *   ./frame_integrity_benchmark [frames]
+ *   ./frame_integrity_benchmark 1000000
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "frame_integrity.hpp"
+
+namespace {
+
+template <typename Fn>
+uint64_t time_best(int trials, Fn&& fn) {
+  uint64_t best = UINT64_MAX;
+  for (int t = 0; t < trials; ++t) {
+    uint64_t start = now_ns();
+    fn();
+    best = std::min(best, now_ns() - start);
+  }
+  return best;
+}
+
+std::string make_stream(size_t frames, bool checksummed) {
+  const char* symbols[] = {"AAPL", "MSFT", "GOOG", "AMZN"};
+  std::string wire;
+  wire.reserve(frames * 40);
+  for (size_t i = 0; i < frames; ++i) {
+    size_t start = wire.size();
+    wire += serialize_tick(i + 1, 1'700'000'000'000'000'000ULL + i * 1000, symbols[i % 4],
+                           100.0f + (i % 500) * 0.01f, 100 + i % 900);
+    if (checksummed) append_crc_trailer(wire, start);
+  }
+  return wire;
+}
+
+inline uint64_t consume(const char* payload) {
+  TickPayload tick = deserialize_tick_payload(payload);
+  return tick.timestamp + static_cast<uint64_t>(tick.volume);
+}
+
+// The reader before: trust the length field
+uint64_t walk_unchecked(const std::string& wire) {
+  uint64_t sum = 0;
+  for (size_t off = 0; off + MessageHeader::HEADER_SIZE <= wire.size();) {
+    MessageHeader header = deserialize_header(wire.data() + off);
+    if (header.type == MessageType::TICK) sum += consume(wire.data() + off + MessageHeader::HEADER_SIZE);
+    off += MessageHeader::HEADER_SIZE + header.length;
+  }
+  return sum;
+}
+
+// Bounds check plus a per-frame CRC with the given function
+template <typename Crc>
+uint64_t walk_each(const std::string& wire, bool checksummed, Crc&& crc) {
+  uint64_t sum = 0;
+  for (size_t off = 0; off + MessageHeader::HEADER_SIZE <= wire.size();) {
+    const char* frame = wire.data() + off;
+    MessageHeader header = deserialize_header(frame);
+    if (!plausible_header(header, checksummed)) return 0;
+    size_t size = MessageHeader::HEADER_SIZE + header.length;
+    if (checksummed) {
+      uint32_t expected;
+      memcpy(&expected, frame + size - CRC_TRAILER_SIZE, 4);
+      if (crc(frame, size - CRC_TRAILER_SIZE) != ntohl(expected)) return 0;
+    }
+    sum += consume(frame + MessageHeader::HEADER_SIZE);
+    off += size;
+  }
+  return sum;
+}
+
+// What BinaryProtocolReader does: validate a batch, then dispatch it
+uint64_t walk_batched(const std::string& wire, bool checksummed) {
+  uint64_t sum = 0;
+  FrameBatch batch;
+  size_t off = 0;
+  do {
+    scan_frames(wire.data() + off, wire.size() - off, checksummed, batch);
+    for (size_t i = 0; i < batch.count; ++i) {
+      sum += consume(wire.data() + off + batch.offsets[i] + MessageHeader::HEADER_SIZE);
+    }
+    off += batch.end;
+  } while (batch.count == FrameBatch::MAX_FRAMES && batch.error == FrameError::NONE);
+  return sum;
+}
+
+void frame_costs(size_t frames) {
+  std::string plain = make_stream(frames, false);
+  std::string checked = make_stream(frames, true);
+  uint64_t expected = walk_unchecked(plain);
+  volatile uint64_t sink = 0;
+
+  printf("%-28s %12s %12s %10s\n", "check", "bytes/frame", "ns/frame", "vs none");
+  double base = 0;
+  auto row = [&](const char* name, const std::string& wire, auto&& walk) {
+    uint64_t sum = 0;
+    uint64_t ns = time_best(5, [&] { sum = walk(); });
+    sink = sum;
+    double per = static_cast<double>(ns) / frames;
+    if (base == 0) base = per;
+    printf("%-28s %12.1f %12.2f %+9.2f%s\n", name, static_cast<double>(wire.size()) / frames, per,
+           per - base, sum == expected ? "" : "  (MISMATCH)");
+  };
+
+  row("none (trust length)", plain, [&] { return walk_unchecked(plain); });
+  row("bounds", plain, [&] {
+    return walk_each(plain, false, [](const char*, size_t) { return 0u; });
+  });
+  row("bounds (scan_frames)", plain, [&] { return walk_batched(plain, false); });
+  row("crc32c table", checked, [&] {
+    return walk_each(checked, true, [](const char* p, size_t n) { return crc32c_sw(p, n); });
+  });
+  if (crc32c_hardware()) {
+    row("crc32c instruction", checked, [&] {
+      return walk_each(checked, true, [](const char* p, size_t n) { return crc32c_hw(p, n); });
+    });
+  } else {
+    printf("(no CRC32C instruction on this CPU: hardware row skipped)\n");
+  }
+  row("crc32c (scan_frames)", checked, [&] { return walk_batched(checked, true); });
+  (void)sink;
+}
+
+void throughput() {
+  std::mt19937_64 rng(11);
+  std::string buffer(8 * 1024 + 7, '\0');  // One full SNAPSHOT_CHUNK
+  for (auto& c : buffer) c = static_cast<char>(rng());
+  const int reps = 2000;
+  volatile uint32_t sink = 0;
+
+  auto gbps = [&](auto crc) {
+    uint64_t ns = time_best(3, [&] {
+      uint32_t c = 0;
+      for (int r = 0; r < reps; ++r) c = crc(buffer.data(), buffer.size(), c);  // Chained
+      sink = c;
+    });
+    return static_cast<double>(buffer.size()) * reps / ns;
+  };
+
+  printf("\nCRC32C throughput, %zu-byte buffers\n", buffer.size());
+  printf("  table:        %6.2f GB/s\n", gbps([](const char* p, size_t n, uint32_t c) { return crc32c_sw(p, n, c); }));
+  if (crc32c_hardware()) {
+    printf("  instruction:  %6.2f GB/s\n", gbps([](const char* p, size_t n, uint32_t c) { return crc32c_hw(p, n, c); }));
+  }
+  (void)sink;
+}
+
+void resync_scan() {
+  std::mt19937_64 rng(13);
+  std::string garbage(1 << 20, '\0');
+  for (auto& c : garbage) c = static_cast<char>(rng());
+
+  for (bool checksummed : {true, false}) {
+    std::string wire = garbage + make_stream(1, checksummed);
+    size_t found = 0, stops = 0;
+    uint64_t ns = time_best(3, [&] {
+      size_t off = 0;
+      stops = 0;
+      while (off < garbage.size()) {
+        off += find_next_frame(wire.data() + off, wire.size() - off, checksummed);
+        stops++;
+      }
+      found = off;
+    });
+    printf("  %-12s %6.2f ns/byte, %zu false candidates in 1 MiB, %s\n",
+           checksummed ? "checksummed" : "plain", static_cast<double>(ns) / garbage.size(),
+           stops - 1, found == garbage.size() ? "landed on the frame" : "overshot");
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t frames = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+
+  std::cout << "=== Frame Integrity Benchmark ===" << std::endl;
+  std::cout << "Frames: " << frames << " TICK, CRC32C "
+            << (crc32c_hardware() ? "hardware" : "software only") << std::endl << std::endl;
+
+  frame_costs(frames);
+  throughput();
+
+  printf("\nResync scan over random bytes\n");
+  resync_scan();
+  return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * Heartbeat Fleet Scaling Benchmark
+ *
+ * HeartbeatFleet (heartbeat_fleet.hpp) with N sessions, N = 1000, 5000,
+ * 10000, 15000 up to max_sessions. The sessions' clients run in a forked
+ * child (each side then has its own fd limit): one MultiClient thread that
+ * connects all N and reads everything the fleet sends.
+ *
+ * Once every session is connected the fleet runs for `seconds`; over that
+ * window, per N:
+ *   hb/s       heartbeats sent per second
+ *   p50..max   heartbeat send lateness (sent minus due)
+ *   cpu        server process CPU (user + sys), all reactors together
+ *   blocked    heartbeats that did not all go out in one send
+ *
+ * Usage:
+ *   ./heartbeat_fleet_benchmark [interval_ms] [seconds] [max_sessions] [jitter_ms]
+ *   ./heartbeat_fleet_benchmark 1000 5 15000 50
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "heartbeat_fleet.hpp"
+#include "multi_client.hpp"
+
+namespace {
+
+uint64_t process_cpu_ns() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  auto ns = [](const timeval &tv) {
+    return static_cast<uint64_t>(tv.tv_sec) * 1'000'000'000ULL + tv.tv_usec * 1000ULL;
+  };
+  return ns(usage.ru_utime) + ns(usage.ru_stime);
+}
+
+// Child: connect `sessions` clients and read until killed
+[[noreturn]] void run_clients(uint16_t port, size_t sessions) {
+  MultiClient client;
+  client.set_frame_callback([](MultiClient::ConnectionId, const MessageHeader &, const char *) {});
+  for (size_t i = 0; i < sessions; ++i) {
+    if (!client.connect("127.0.0.1", port).ok()) {
+      _exit(1);
+    }
+  }
+  for (;;) {
+    client.poll(100);
+  }
+}
+
+struct RunResult {
+  bool ok = false;
+  HeartbeatFleetStats stats;
+  double seconds = 0;
+  double cpu_pct = 0;
+};
+
+RunResult run(const HeartbeatFleetConfig &base, size_t sessions, double seconds) {
+  RunResult result;
+  HeartbeatFleetConfig config = base;
+  config.port = 0;
+  HeartbeatFleet fleet(config);
+  if (!fleet.start().ok()) {
+    return result;
+  }
+
+  pid_t child = fork();
+  if (child < 0) {
+    return result;
+  }
+  if (child == 0) {
+    run_clients(fleet.port(), sessions);
+  }
+
+  // Wait for every session (or the child giving up)
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (fleet.stats().sessions < sessions && std::chrono::steady_clock::now() < deadline &&
+         waitpid(child, nullptr, WNOHANG) == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  if (fleet.stats().sessions == sessions) {
+    // One interval so every session is past its random first phase
+    std::this_thread::sleep_for(std::chrono::milliseconds(config.interval_ms));
+    HeartbeatFleetStats before = fleet.stats();
+    uint64_t cpu_start = process_cpu_ns();
+    uint64_t start = now_ns();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    result.stats = fleet.stats().since(before);
+    uint64_t elapsed = now_ns() - start;
+    result.seconds = elapsed / 1e9;
+    result.cpu_pct = 100.0 * (process_cpu_ns() - cpu_start) / elapsed;
+    result.ok = true;
+  }
+
+  kill(child, SIGKILL);
+  waitpid(child, nullptr, 0);
+  fleet.stop();
+  return result;
+}
+
+void print_row(size_t sessions, const RunResult &r) {
+  if (!r.ok) {
+    printf("%8zu  failed (connect or fork; raise the fd limit?)\n", sessions);
+    return;
+  }
+  auto us = [](uint64_t ns) { return ns / 1000.0; };
+  printf("%8zu %10.0f %9.1fus %9.1fus %9.1fus %9.1fus %7.1f%% %8lu\n", sessions,
+         r.stats.heartbeats / r.seconds, us(r.stats.lateness_percentile(50)),
+         us(r.stats.lateness_percentile(99)), us(r.stats.lateness_percentile(99.9)),
+         us(r.stats.lateness_max_ns), r.cpu_pct, static_cast<unsigned long>(r.stats.send_blocked));
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  HeartbeatFleetConfig config;
+  config.interval_ms = argc > 1 ? std::atoi(argv[1]) : 1000;
+  double seconds = argc > 2 ? std::atof(argv[2]) : 5.0;
+  size_t max_sessions = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 15'000;
+  config.jitter_ms = argc > 4 ? std::atoi(argv[4]) : 50;
+  if (!config.is_valid() || seconds <= 0 || max_sessions == 0) {
+    fprintf(stderr, "Usage: %s [interval_ms] [seconds] [max_sessions] [jitter_ms]\n", argv[0]);
+    return 1;
+  }
+  Logger::set_level(LogLevel::ERROR);
+
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  printf("=== Heartbeat Fleet: send lateness vs session count ===\n");
+  printf("%d ms +/- %d ms heartbeats, %u reactor(s), %.1fs per run\n\n", config.interval_ms,
+         config.jitter_ms, cores, seconds);
+  printf("%8s %10s %11s %11s %11s %11s %8s %8s\n", "sessions", "hb/s", "p50", "p99", "p99.9",
+         "max", "cpu", "blocked");
+
+  for (size_t sessions : {1'000, 5'000, 10'000, 15'000}) {
+    if (sessions > max_sessions) {
+      break;
+    }
+    print_row(sessions, run(config, sessions, seconds));
+  }
+  return 0;
+}
@@ -0,0 +1,214 @@
+/**
+ * Message View Benchmark
+ *
+ * Cost per message of decoding TICK and ORDER_BOOK_UPDATE payloads into
+ * structs (deserialize_*) against reading them through TickView and
+ * BookUpdateView, for consumers that use every field, only symbol and
+ * price, or filter on the symbol first, with the decode inlined and behind
+ * a call. Each row walks the same buffer of framed messages.
+ *
+ * Usage:
+ *   ./message_view_benchmark [messages] [symbols]
+ *   ./message_view_benchmark 1000000 64
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "message_views.hpp"
+#include "net/feed.hpp"
+#include "symbol_books.hpp"
+
+namespace {
+
+template <typename Fn>
+uint64_t time_best(int trials, Fn&& fn) {
+  uint64_t best = UINT64_MAX;
+  for (int t = 0; t < trials; ++t) {
+    uint64_t start = now_ns();
+    fn();
+    best = std::min(best, now_ns() - start);
+  }
+  return best;
+}
+
+std::string symbol_name(size_t s) {
+  char name[24];
+  snprintf(name, sizeof(name), "S%03zu", s % 1000);
+  return std::string(name, 4);
+}
+
+std::string make_ticks(size_t count, size_t symbols) {
+  std::mt19937_64 rng(5);
+  std::string wire;
+  wire.reserve(count * (MessageHeader::HEADER_SIZE + TickPayload::PAYLOAD_SIZE));
+  for (size_t i = 0; i < count; ++i) {
+    wire += serialize_tick(i + 1, 1'700'000'000'000'000'000ULL + i * 1000,
+                           symbol_name(rng() % symbols).c_str(), 100.0f + (rng() % 5000) * 0.01f,
+                           static_cast<int32_t>(100 + rng() % 900));
+  }
+  return wire;
+}
+
+std::string make_updates(size_t count, size_t symbols) {
+  std::mt19937_64 rng(6);
+  std::string wire;
+  wire.reserve(count * (MessageHeader::HEADER_SIZE + OrderBookUpdatePayload::PAYLOAD_SIZE));
+  for (size_t i = 0; i < count; ++i) {
+    wire += serialize_order_book_update(i + 1, symbol_name(rng() % symbols).c_str(), rng() % 2,
+                                        100.0f + (rng() % 200) * 0.01f,
+                                        static_cast<int64_t>(rng() % 10) * 100);
+  }
+  return wire;
+}
+
+__attribute__((noinline)) TickPayload decode_out_of_line(const char* payload) {
+  return deserialize_tick_payload(payload);
+}
+
+// Walk every frame, handing the payload to `fn`
+template <typename Fn>
+void for_each_payload(const std::string& wire, size_t payload_size, Fn&& fn) {
+  const size_t frame = MessageHeader::HEADER_SIZE + payload_size;
+  for (size_t off = 0; off + frame <= wire.size(); off += frame) {
+    fn(wire.data() + off + MessageHeader::HEADER_SIZE);
+  }
+}
+
+struct Row {
+  const char* name;
+  double ns;
+  uint64_t check;
+};
+
+void print_rows(const char* title, const std::vector<Row>& rows) {
+  printf("%s\n", title);
+  for (size_t i = 0; i < rows.size(); i += 2) {
+    const Row& full = rows[i];
+    const Row& view = rows[i + 1];
+    printf("  %-26s struct %6.2f ns   view %6.2f ns   (%.2fx)%s\n", full.name, full.ns, view.ns,
+           full.ns / view.ns, full.check == view.check ? "" : "  (MISMATCH)");
+  }
+}
+
+void tick_rows(size_t count, size_t symbols) {
+  std::string wire = make_ticks(count, symbols);
+  const uint32_t wanted = symbol_key(symbol_name(0).c_str());
+  volatile uint64_t sink = 0;
+  std::vector<Row> rows;
+
+  auto run = [&](const char* name, auto&& per_message) {
+    uint64_t check = 0;
+    uint64_t ns = time_best(5, [&] {
+      uint64_t sum = 0;
+      for_each_payload(wire, TickPayload::PAYLOAD_SIZE, [&](const char* p) { sum += per_message(p); });
+      check = sum;
+      sink = sum;
+    });
+    rows.push_back({name, static_cast<double>(ns) / count, check});
+  };
+
+  // The reader's net::Tick: via a TickPayload, or straight from the buffer
+  run("net::Tick", [](const char* p) {
+    net::Tick tick(deserialize_tick_payload(p), 0);
+    return tick.timestamp + static_cast<uint64_t>(tick.volume) + tick.symbol[0];
+  });
+  run("net::Tick", [](const char* p) {
+    net::Tick tick(TickView(p), 0);
+    return tick.timestamp + static_cast<uint64_t>(tick.volume) + tick.symbol[0];
+  });
+
+  run("symbol + price", [](const char* p) {
+    TickPayload tick = deserialize_tick_payload(p);
+    return symbol_key(tick.symbol) + static_cast<uint64_t>(tick.price);
+  });
+  run("symbol + price", [](const char* p) {
+    TickView tick(p);
+    return tick.symbol_key() + static_cast<uint64_t>(tick.price());
+  });
+
+  // One symbol of `symbols` wanted; the rest dropped
+  run("filter on symbol", [&](const char* p) -> uint64_t {
+    TickPayload tick = deserialize_tick_payload(p);
+    if (symbol_key(tick.symbol) != wanted) return 0;
+    return tick.timestamp + static_cast<uint64_t>(tick.price) + tick.volume;
+  });
+  run("filter on symbol", [&](const char* p) -> uint64_t {
+    TickView tick(p);
+    if (tick.symbol_key() != wanted) return 0;
+    return tick.timestamp() + static_cast<uint64_t>(tick.price()) + tick.volume();
+  });
+
+  // Decode behind a call the compiler can't see through (another TU, a
+  // callback): the struct path pays for every field of every tick
+  run("filter, out-of-line decode", [&](const char* p) -> uint64_t {
+    TickPayload tick = decode_out_of_line(p);
+    if (symbol_key(tick.symbol) != wanted) return 0;
+    return tick.timestamp + static_cast<uint64_t>(tick.price) + tick.volume;
+  });
+  run("filter, out-of-line decode", [&](const char* p) -> uint64_t {
+    TickView tick(p);
+    if (tick.symbol_key() != wanted) return 0;
+    TickPayload full = decode_out_of_line(p);
+    return full.timestamp + static_cast<uint64_t>(full.price) + full.volume;
+  });
+  (void)sink;
+
+  print_rows("TICK", rows);
+}
+
+void update_rows(size_t count, size_t symbols) {
+  std::string wire = make_updates(count, symbols);
+  std::vector<Row> rows;
+
+  // A book for one symbol in eight, as a handler subscribed to part of the feed
+  auto make_books = [&] {
+    SymbolBooks books;
+    for (size_t s = 0; s < symbols; s += 8) {
+      books.add(symbol_name(s)).state = BookState::VALID;
+    }
+    return books;
+  };
+
+  auto run = [&](const char* name, auto&& apply) {
+    uint64_t applied = 0;
+    uint64_t ns = time_best(5, [&] {
+      SymbolBooks books = make_books();
+      uint64_t seq = 0, n = 0;
+      for_each_payload(wire, OrderBookUpdatePayload::PAYLOAD_SIZE, [&](const char* p) {
+        n += apply(books, ++seq, p) == SymbolBooks::UpdateResult::APPLIED;
+      });
+      applied = n;
+    });
+    rows.push_back({name, static_cast<double>(ns) / count, applied});
+  };
+
+  run("SymbolBooks (1/8 symbols)", [](SymbolBooks& books, uint64_t seq, const char* p) {
+    return books.apply_update(seq, deserialize_order_book_update(p));
+  });
+  run("SymbolBooks (1/8 symbols)", [](SymbolBooks& books, uint64_t seq, const char* p) {
+    return books.apply_update(seq, BookUpdateView(p));
+  });
+
+  print_rows("\nORDER_BOOK_UPDATE", rows);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t messages = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+  size_t symbols = argc > 2 ? std::max<size_t>(1, std::stoul(argv[2])) : 64;
+
+  std::cout << "=== Message View Benchmark ===" << std::endl;
+  std::cout << "Messages: " << messages << ", symbols: " << symbols << std::endl << std::endl;
+
+  tick_rows(messages, symbols);
+  update_rows(messages, symbols);
+  return 0;
+}
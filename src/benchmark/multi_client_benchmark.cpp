@@ -0,0 +1,425 @@
+/**
+ * Multi-Connection Client Scaling Benchmark
+ *
+ * One client thread reading binary ticks from N loopback TCP connections,
+ * N = 10, 100, 1000, 10000, two ways:
+ *   ring     binary_client_zerocopy's model: a 1 MB RingBuffer per
+ *            connection, edge-triggered epoll, 10 events per wakeup,
+ *            each ready socket drained to EAGAIN
+ *   pooled   MultiClient (multi_client.hpp): shared receive buffer pool,
+ *            per-connection carry-over, adaptive epoll batch
+ *
+ * The exchange runs in a forked child (each side then has its own fd
+ * limit) and spreads a fixed total tick rate over the connections, so the
+ * per-connection rate falls as N grows - the mostly-idle case. Every write
+ * stops a few bytes short of a frame boundary, so every read the client
+ * makes ends mid-frame and has to carry the tail.
+ *
+ * Reported per model and N:
+ *   reserved   receive memory the model allocates (virtual for the rings)
+ *   rss        resident growth of the client process from before the
+ *              client state is built to the end of the run
+ *   cpu        client process CPU (user + sys) over the streaming window
+ *   events/wakeup, final epoll batch, frames received per second
+ *
+ * Usage:
+ *   ./multi_client_benchmark [rate] [seconds] [max_connections]
+ *   ./multi_client_benchmark 200000 3 10000
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "multi_client.hpp"
+#include "ring_buffer.hpp"
+
+namespace {
+
+const char *SYMBOLS[] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA", "META", "NFLX"};
+constexpr size_t NUM_SYMBOLS = sizeof(SYMBOLS) / sizeof(SYMBOLS[0]);
+constexpr size_t HELD_BYTES = 7;  // Each write stops this far short of a frame boundary
+
+size_t resident_bytes() {
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (!statm) {
+    return 0;
+  }
+  unsigned long size = 0, resident = 0;
+  if (fscanf(statm, "%lu %lu", &size, &resident) != 2) {
+    resident = 0;
+  }
+  fclose(statm);
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+uint64_t process_cpu_ns() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  auto ns = [](const timeval &tv) {
+    return static_cast<uint64_t>(tv.tv_sec) * 1'000'000'000ULL + tv.tv_usec * 1000ULL;
+  };
+  return ns(usage.ru_utime) + ns(usage.ru_stime);
+}
+
+int listen_ephemeral(uint16_t &port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(fd, 4096) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+    close(fd);
+    return -1;
+  }
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// =============================================================================
+// Exchange (child process)
+// =============================================================================
+
+// Accept `connections`, then on 'S' stream for `seconds` and answer 'D'; exit on 'Q'
+[[noreturn]] void run_exchange(int listen_fd, size_t connections, uint64_t rate, double seconds,
+                               int command_fd, int reply_fd) {
+  std::vector<int> clients;
+  clients.reserve(connections);
+  while (clients.size() < connections) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) _exit(1);
+    clients.push_back(fd);
+  }
+
+  std::vector<std::string> held(connections);
+  std::vector<std::string> out(connections);
+  std::vector<size_t> touched;
+  uint64_t sequence = 0;
+  size_t cursor = 0;
+  char command;
+  while (read(command_fd, &command, 1) == 1 && command == 'S') {
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration<double>(seconds);
+    auto next = start;
+    double owed = 0;
+    while (next < end) {
+      std::this_thread::sleep_until(next);
+      next += std::chrono::milliseconds(1);
+      owed += rate / 1000.0;
+      for (; owed >= 1.0; owed -= 1.0) {
+        size_t c = cursor++ % connections;
+        if (out[c].empty()) {
+          touched.push_back(c);
+          out[c].swap(held[c]);
+        }
+        ++sequence;
+        out[c] += serialize_tick(sequence, sequence, SYMBOLS[sequence % NUM_SYMBOLS],
+                                 100.0f + static_cast<float>(sequence % 50) * 0.01f,
+                                 static_cast<int32_t>(100 + sequence % 400));
+      }
+      for (size_t c : touched) {
+        std::string &bytes = out[c];
+        size_t len = bytes.size() - HELD_BYTES;
+        held[c].assign(bytes, len, HELD_BYTES);
+        // Blocking: a short write would tear the stream
+        for (size_t sent = 0; sent < len;) {
+          ssize_t n = send(clients[c], bytes.data() + sent, len - sent, MSG_NOSIGNAL);
+          if (n <= 0) _exit(1);
+          sent += n;
+        }
+        bytes.clear();
+      }
+      touched.clear();
+    }
+    if (write(reply_fd, "D", 1) != 1) break;
+  }
+  for (int fd : clients) close(fd);
+  _exit(0);
+}
+
+// =============================================================================
+// Client models
+// =============================================================================
+
+struct Counters {
+  uint64_t frames = 0;
+  int64_t volume = 0;
+  uint64_t wakeups = 0;
+  uint64_t events = 0;
+};
+
+inline void consume_tick(Counters &counters, const MessageHeader &header, const char *payload) {
+  ++counters.frames;
+  if (header.type == MessageType::TICK) {
+    int32_t volume_net;
+    memcpy(&volume_net, payload + 16, 4);
+    counters.volume += static_cast<int32_t>(ntohl(volume_net));
+  }
+}
+
+class RingModel {
+public:
+  explicit RingModel(const std::vector<int> &fds) : epoll_fd_(epoll_create1(0)) {
+    connections_.reserve(fds.size());
+    for (int fd : fds) {
+      socket_set_nonblocking(fd);
+      connections_.push_back({fd, std::make_unique<RingBuffer>()});
+      epoll_event ev{};
+      ev.events = EPOLLIN | EPOLLET;
+      ev.data.ptr = &connections_.back();
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+  }
+
+  ~RingModel() {
+    close(epoll_fd_);
+    for (auto &conn : connections_) close(conn.fd);
+  }
+
+  size_t reserved_bytes() const { return connections_.size() * sizeof(RingBuffer); }
+
+  void poll(int timeout_ms, Counters &counters) {
+    epoll_event events[10];
+    int n = epoll_wait(epoll_fd_, events, 10, timeout_ms);
+    if (n <= 0) return;
+    ++counters.wakeups;
+    counters.events += n;
+    for (int i = 0; i < n; ++i) {
+      drain(*static_cast<Connection *>(events[i].data.ptr), counters);
+    }
+  }
+
+private:
+  struct Connection {
+    int fd;
+    std::unique_ptr<RingBuffer> ring;
+  };
+
+  static void drain(Connection &conn, Counters &counters) {
+    RingBuffer &ring = *conn.ring;
+    while (true) {
+      auto [write_ptr, space] = ring.get_write_ptr();
+      if (space == 0) return;
+      ssize_t got = recv(conn.fd, write_ptr, space, 0);
+      if (got <= 0) return;
+      ring.commit_write(got);
+
+      char message[MessageHeader::HEADER_SIZE + 256];
+      while (ring.available() >= MessageHeader::HEADER_SIZE) {
+        ring.peek_bytes(message, MessageHeader::HEADER_SIZE);
+        MessageHeader header = deserialize_header(message);
+        size_t total = MessageHeader::HEADER_SIZE + header.length;
+        if (header.length > 256 || ring.available() < total) break;
+        ring.read_bytes(message, total);
+        consume_tick(counters, header, message + MessageHeader::HEADER_SIZE);
+      }
+    }
+  }
+
+  int epoll_fd_;
+  std::vector<Connection> connections_;
+};
+
+class PooledModel {
+public:
+  PooledModel(const std::vector<int> &fds, Counters &counters) {
+    client_.set_frame_callback(
+        [&counters](MultiClient::ConnectionId, const MessageHeader &header, const char *payload) {
+          consume_tick(counters, header, payload);
+        });
+    for (int fd : fds) {
+      client_.add(fd);
+    }
+  }
+
+  size_t reserved_bytes() const { return client_.footprint_bytes(); }
+  size_t batch_limit() const { return client_.batch_limit(); }
+
+  void poll(int timeout_ms, Counters &counters) {
+    uint64_t wakeups = client_.stats().wakeups;
+    client_.poll(timeout_ms);
+    if (client_.stats().wakeups != wakeups) {
+      ++counters.wakeups;
+    }
+    counters.events = client_.stats().events;
+  }
+
+private:
+  MultiClient client_;
+};
+
+// =============================================================================
+// Runs
+// =============================================================================
+
+struct RunResult {
+  bool ok = false;
+  size_t reserved = 0;
+  size_t rss_growth = 0;
+  double cpu_pct = 0;
+  double frames_per_sec = 0;
+  double events_per_wakeup = 0;
+  size_t batch = 0;
+};
+
+std::vector<int> connect_all(uint16_t port, size_t count) {
+  std::vector<int> fds;
+  fds.reserve(count);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  for (size_t i = 0; i < count; ++i) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+      if (fd >= 0) close(fd);
+      break;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fds.push_back(fd);
+  }
+  return fds;
+}
+
+template <typename Model>
+RunResult run(size_t connections, uint64_t rate, double seconds) {
+  RunResult result;
+  uint16_t port = 0;
+  int listen_fd = listen_ephemeral(port);
+  int command[2], reply[2];
+  if (listen_fd < 0 || pipe(command) < 0 || pipe(reply) < 0) return result;
+
+  pid_t child = fork();
+  if (child < 0) return result;
+  if (child == 0) {
+    close(command[1]);
+    close(reply[0]);
+    run_exchange(listen_fd, connections, rate, seconds, command[0], reply[1]);
+  }
+  close(listen_fd);
+  close(command[0]);
+  close(reply[1]);
+
+  std::vector<int> fds = connect_all(port, connections);
+  if (fds.size() == connections) {
+    size_t rss_before = resident_bytes();
+    Counters counters;
+    std::unique_ptr<Model> model;
+    if constexpr (std::is_same<Model, PooledModel>::value) {
+      model = std::make_unique<Model>(fds, counters);
+    } else {
+      model = std::make_unique<Model>(fds);
+    }
+
+    std::atomic<bool> running{true};
+    std::thread reader([&]() {
+      while (running.load(std::memory_order_relaxed)) {
+        model->poll(10, counters);
+      }
+    });
+
+    uint64_t cpu_start = process_cpu_ns();
+    uint64_t start = now_ns();
+    char done = 0;
+    if (write(command[1], "S", 1) == 1 && read(reply[0], &done, 1) == 1) {
+      uint64_t elapsed = now_ns() - start;
+      uint64_t cpu = process_cpu_ns() - cpu_start;
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Let the tail arrive
+      running = false;
+      reader.join();
+
+      result.ok = true;
+      result.reserved = model->reserved_bytes();
+      size_t rss_after = resident_bytes();
+      result.rss_growth = rss_after > rss_before ? rss_after - rss_before : 0;
+      result.cpu_pct = 100.0 * cpu / elapsed;
+      result.frames_per_sec = counters.frames * 1e9 / elapsed;
+      result.events_per_wakeup =
+          counters.wakeups ? static_cast<double>(counters.events) / counters.wakeups : 0;
+      if constexpr (std::is_same<Model, PooledModel>::value) {
+        result.batch = model->batch_limit();
+      } else {
+        result.batch = 10;
+      }
+    } else {
+      running = false;
+      reader.join();
+    }
+    model.reset();  // Closes the sockets
+  } else {
+    for (int fd : fds) close(fd);
+  }
+
+  if (write(command[1], "Q", 1) != 1) {
+    kill(child, SIGKILL);
+  }
+  waitpid(child, nullptr, 0);
+  close(command[1]);
+  close(reply[0]);
+  return result;
+}
+
+void print_row(const char *model, size_t connections, const RunResult &r) {
+  if (!r.ok) {
+    printf("%-7s %7zu  failed (connect or fork; raise the fd limit?)\n", model, connections);
+    return;
+  }
+  printf("%-7s %7zu %11.1fMB %9.1fMB %9.2fKB %7.1f%% %12.0f %9.1f %7zu\n", model, connections,
+         r.reserved / 1048576.0, r.rss_growth / 1048576.0,
+         r.rss_growth / 1024.0 / connections, r.cpu_pct, r.frames_per_sec, r.events_per_wakeup,
+         r.batch);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  uint64_t rate = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200'000;
+  double seconds = argc > 2 ? std::atof(argv[2]) : 3.0;
+  size_t max_connections = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10'000;
+  if (rate == 0 || seconds <= 0 || max_connections == 0) {
+    fprintf(stderr, "Usage: %s [rate] [seconds] [max_connections]\n", argv[0]);
+    return 1;
+  }
+  Logger::set_level(LogLevel::ERROR);
+
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  printf("=== Multi-Connection Client: 1 MB ring per connection vs pooled buffers ===\n");
+  printf("%lu ticks/s spread over N connections for %.1fs; every read ends mid-frame\n\n",
+         static_cast<unsigned long>(rate), seconds);
+  printf("%-7s %7s %13s %11s %11s %8s %12s %9s %7s\n", "model", "conns", "reserved", "rss",
+         "rss/conn", "cpu", "frames/s", "ev/wake", "batch");
+
+  for (size_t connections = 10; connections <= max_connections; connections *= 10) {
+    print_row("ring", connections, run<RingModel>(connections, rate, seconds));
+    print_row("pooled", connections, run<PooledModel>(connections, rate, seconds));
+  }
+  return 0;
+}
@@ -0,0 +1,268 @@
+/**
+ * Packet Batching Benchmark
+ *
+ * Sends the same paced tick stream over loopback UDP and TCP, once with one
+ * message per datagram / send() and then with multi-message packets
+ * (PacketBatcher) and coalesced writes (WriteBatcher) at several max-latency
+ * settings. Reports packets/s, ticks per packet, wire bytes per tick, time
+ * spent in send calls, and the delay batching added.
+ *
+ * Usage:
+ *   ./packet_batching_benchmark [ticks] [ticks_per_sec]
+ *   ./packet_batching_benchmark 200000 200000
+ *   ./packet_batching_benchmark 200000 0        # Unpaced: as fast as possible
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "packet_framing.hpp"
+
+namespace {
+
+constexpr size_t UDP_IP_OVERHEAD = 28;  // IPv4 + UDP headers per datagram
+
+struct RunResult {
+  uint64_t ticks_sent = 0;
+  uint64_t ticks_received = 0;
+  uint64_t packets = 0;          // Datagrams or send() calls
+  uint64_t payload_bytes = 0;
+  uint64_t send_ns = 0;          // Time inside sendto()/send()
+  uint64_t elapsed_ns = 0;
+  uint64_t batching_delay_ns = 0; // Summed over ticks: append to send
+};
+
+const char kSymbols[][5] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "META", "NVDA", "JPM "};
+
+std::string make_tick(uint64_t sequence) {
+  return serialize_tick(sequence, now_ns(), kSymbols[sequence % 8],
+                        100.0f + static_cast<float>(sequence % 400), 100 + sequence % 9900);
+}
+
+// Bound loopback socket on an ephemeral port
+int bind_loopback(int type, uint16_t& port) {
+  int fd = socket(AF_INET, type, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  int rcvbuf = 8 * 1024 * 1024;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+    close(fd);
+    return -1;
+  }
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// Paced send loop shared by both transports. Batch is PacketBatcher or
+// WriteBatcher; latency 0 sends every message on its own.
+template <typename Batch, typename Send, typename Payload>
+void send_stream(RunResult& result, uint64_t ticks, uint64_t rate, uint64_t latency_ns,
+                 Batch& batch, Send&& send_bytes, Payload&& batch_bytes) {
+  uint64_t pending_append_sum = 0;
+  auto flush = [&]() {
+    if (batch.empty()) return;
+    uint64_t now = now_ns();
+    result.batching_delay_ns += now * batch.count() - pending_append_sum;
+    pending_append_sum = 0;
+    send_bytes(batch_bytes(batch));
+    batch.clear();
+  };
+
+  uint64_t start = now_ns();
+  for (uint64_t seq = 1; seq <= ticks; ++seq) {
+    if (rate > 0) {
+      uint64_t target = start + (seq - 1) * 1'000'000'000ULL / rate;
+      uint64_t now;
+      while ((now = now_ns()) < target) {
+        if (batch.due(now)) flush();
+        std::this_thread::yield();  // Lets the receiver run on a busy core
+      }
+    }
+
+    std::string message = make_tick(seq);
+    if (latency_ns == 0) {
+      send_bytes(message);
+    } else {
+      uint64_t now = now_ns();
+      if (!batch.append(message, now)) {
+        flush();
+        now = now_ns();
+        batch.append(message, now);
+      }
+      pending_append_sum += now;
+      if (batch.due(now)) flush();
+    }
+    result.ticks_sent++;
+  }
+  flush();
+  result.elapsed_ns = now_ns() - start;
+}
+
+RunResult run_udp(uint64_t ticks, uint64_t rate, uint64_t latency_ns) {
+  RunResult result;
+  uint16_t port = 0;
+  int rx = bind_loopback(SOCK_DGRAM, port);
+  int tx = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in dest{};
+  dest.sin_family = AF_INET;
+  dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  dest.sin_port = htons(port);
+
+  std::atomic<bool> sender_done{false};
+  std::thread receiver([&] {
+    char buffer[2048];
+    pollfd pfd{rx, POLLIN, 0};
+    while (true) {
+      if (poll(&pfd, 1, 100) <= 0) {
+        if (sender_done) break;
+        continue;
+      }
+      ssize_t n = recv(rx, buffer, sizeof(buffer), 0);
+      if (n <= 0) continue;
+      if (latency_ns == 0) {
+        if (deserialize_header(buffer).type == MessageType::TICK) result.ticks_received++;
+      } else {
+        decode_packet(buffer, n, [&](const MessageHeader& header, const char*) {
+          if (header.type == MessageType::TICK) result.ticks_received++;
+        });
+      }
+    }
+  });
+
+  PacketBatcher batcher("BENCH", MAX_PACKET_SIZE, latency_ns);
+  send_stream(
+      result, ticks, rate, latency_ns, batcher,
+      [&](std::string_view bytes) {
+        uint64_t before = now_ns();
+        sendto(tx, bytes.data(), bytes.size(), 0, reinterpret_cast<sockaddr*>(&dest), sizeof(dest));
+        result.send_ns += now_ns() - before;
+        result.packets++;
+        result.payload_bytes += bytes.size();
+      },
+      [](PacketBatcher& b) { return b.packet(); });
+
+  sender_done = true;
+  receiver.join();
+  close(tx);
+  close(rx);
+  return result;
+}
+
+RunResult run_tcp(uint64_t ticks, uint64_t rate, uint64_t latency_ns) {
+  RunResult result;
+  uint16_t port = 0;
+  int listen_fd = bind_loopback(SOCK_STREAM, port);
+  listen(listen_fd, 1);
+
+  std::thread receiver([&] {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    std::vector<char> buffer(1 << 16);
+    size_t have = 0;
+    while (true) {
+      ssize_t n = recv(fd, buffer.data() + have, buffer.size() - have, 0);
+      if (n <= 0) break;
+      have += n;
+      size_t offset = 0;
+      while (have - offset >= MessageHeader::HEADER_SIZE) {
+        MessageHeader header = deserialize_header(buffer.data() + offset);
+        size_t total = MessageHeader::HEADER_SIZE + header.length;
+        if (have - offset < total) break;
+        if (header.type == MessageType::TICK) result.ticks_received++;
+        offset += total;
+      }
+      memmove(buffer.data(), buffer.data() + offset, have - offset);
+      have -= offset;
+    }
+    close(fd);
+  });
+
+  int tx = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in dest{};
+  dest.sin_family = AF_INET;
+  dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  dest.sin_port = htons(port);
+  connect(tx, reinterpret_cast<sockaddr*>(&dest), sizeof(dest));
+  int nodelay = 1;
+  setsockopt(tx, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+  WriteBatcher batcher(16384, latency_ns);
+  send_stream(
+      result, ticks, rate, latency_ns, batcher,
+      [&](std::string_view bytes) {
+        uint64_t before = now_ns();
+        size_t sent = 0;
+        while (sent < bytes.size()) {
+          ssize_t n = send(tx, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+          if (n <= 0) break;
+          sent += n;
+        }
+        result.send_ns += now_ns() - before;
+        result.packets++;
+        result.payload_bytes += bytes.size();
+      },
+      [](WriteBatcher& b) { return b.data(); });
+
+  close(tx);
+  receiver.join();
+  close(listen_fd);
+  return result;
+}
+
+void print_row(const char* framing, const RunResult& r, size_t per_packet_overhead) {
+  double seconds = r.elapsed_ns / 1e9;
+  printf("%-14s %10lu %12.0f %10.1f %12.1f %12.3f %12.1f %10lu\n", framing, r.packets,
+         r.packets / seconds, static_cast<double>(r.ticks_sent) / r.packets,
+         static_cast<double>(r.payload_bytes + r.packets * per_packet_overhead) / r.ticks_sent,
+         r.send_ns / 1e3 / r.ticks_sent, r.batching_delay_ns / 1e3 / r.ticks_sent,
+         r.ticks_received);
+}
+
+void print_header(const char* title) {
+  printf("\n%s\n", title);
+  printf("%-14s %10s %12s %10s %12s %12s %12s %10s\n", "framing", "packets", "packets/s",
+         "ticks/pkt", "bytes/tick", "send us/tick", "delay us", "received");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  uint64_t ticks = argc > 1 ? std::stoull(argv[1]) : 200000;
+  uint64_t rate = argc > 2 ? std::stoull(argv[2]) : 200000;
+  const uint64_t latencies_us[] = {0, 10, 50, 200, 1000};
+
+  std::cout << "=== Packet Batching Benchmark ===" << std::endl;
+  std::cout << "Ticks: " << ticks << ", offered rate: "
+            << (rate > 0 ? std::to_string(rate) + " ticks/s" : std::string("unpaced")) << std::endl;
+  std::cout << "Per-message framing: " << MessageHeader::HEADER_SIZE + TickPayload::PAYLOAD_SIZE
+            << " bytes/tick; packed: " << PacketHeader::BLOCK_HEADER_SIZE + TickPayload::PAYLOAD_SIZE
+            << " bytes/tick + " << PacketHeader::HEADER_SIZE << " per packet" << std::endl;
+
+  print_header("UDP (bytes/tick includes 28 B IP/UDP header per datagram)");
+  for (uint64_t us : latencies_us) {
+    std::string label = us == 0 ? "per-message" : "batch " + std::to_string(us) + "us";
+    print_row(label.c_str(), run_udp(ticks, rate, us * 1000), UDP_IP_OVERHEAD);
+  }
+
+  print_header("TCP (packets = send() calls; bytes/tick excludes TCP/IP headers)");
+  for (uint64_t us : latencies_us) {
+    std::string label = us == 0 ? "per-message" : "coalesce " + std::to_string(us) + "us";
+    print_row(label.c_str(), run_tcp(ticks, rate, us * 1000), 0);
+  }
+  return 0;
+}
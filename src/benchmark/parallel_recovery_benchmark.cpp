@@ -0,0 +1,221 @@
+/**
+ * Parallel Recovery Benchmark
+ *
+ * Time to rebuild every book in a universe from a loopback snapshot channel
+ * with ParallelSnapshotRecovery, as a function of the number of book shard
+ * threads. The channel serves pre-encoded chunked snapshots, one partition
+ * per connection (or "ALL" over a single connection), so the time measured
+ * is the client's: receive, frame, route, decode, build, verify.
+ *
+ * Usage:
+ *   ./parallel_recovery_benchmark [symbols] [levels] [max_threads] [connections] [trials]
+ *   ./parallel_recovery_benchmark 4096 100 8 2 5
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <iostream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "parallel_recovery.hpp"
+
+namespace {
+
+// Chunked snapshot of one book, as snapshot_mock_server's channel sends it
+struct EncodedBook {
+  char symbol[4];
+  std::string messages;
+};
+
+// Four-character base-36 names: "A000", "A001", ...
+std::string symbol_name(size_t i) {
+  static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  std::string s = "A000";
+  for (int pos = 3; pos >= 1 && i > 0; --pos) {
+    s[pos] = digits[i % 36];
+    i /= 36;
+  }
+  s[0] = static_cast<char>('A' + i % 26);
+  return s;
+}
+
+std::vector<EncodedBook> make_universe(size_t symbols, size_t levels) {
+  constexpr size_t CHUNK_LEVELS = 512;
+  std::vector<EncodedBook> universe(symbols);
+  for (size_t s = 0; s < symbols; ++s) {
+    EncodedBook &encoded = universe[s];
+    memcpy(encoded.symbol, symbol_name(s).data(), 4);
+
+    OrderBook book;
+    std::vector<OrderBookLevel> bids, asks;
+    float mid = 50.0f + static_cast<float>(s % 500);
+    for (size_t l = 1; l <= levels; ++l) {
+      bids.push_back({mid - l * 0.01f, 100 * l});
+      asks.push_back({mid + l * 0.01f, 100 * l});
+    }
+    book.load_snapshot(bids, asks);
+
+    uint32_t id = static_cast<uint32_t>(s + 1);
+    encoded.messages = serialize_snapshot_begin(1, encoded.symbol, id, levels, levels);
+    uint32_t chunks = 0;
+    for (uint8_t side = 0; side < 2; ++side) {
+      const auto &side_levels = side == 0 ? bids : asks;
+      for (size_t offset = 0; offset < side_levels.size(); offset += CHUNK_LEVELS) {
+        uint16_t count = static_cast<uint16_t>(std::min(CHUNK_LEVELS, side_levels.size() - offset));
+        encoded.messages += serialize_snapshot_chunk(1, encoded.symbol, id, chunks++, side,
+                                                     side_levels.data() + offset, count);
+      }
+    }
+    encoded.messages += serialize_snapshot_end(1, encoded.symbol, id, chunks, book.checksum());
+  }
+  return universe;
+}
+
+bool send_all(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, 0);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// One channel connection: read the request, send its books, close
+void serve_connection(int client, const std::vector<EncodedBook> &universe) {
+  char request[MessageHeader::HEADER_SIZE + 4];
+  if (recv(client, request, sizeof(request), MSG_WAITALL) != sizeof(request)) {
+    close(client);
+    return;
+  }
+  MessageHeader header = deserialize_header(request);
+  uint32_t partition = 0, partitions = 1;
+  if (header.type == MessageType::PARTITION_SNAPSHOT_REQUEST) {
+    auto p = deserialize_partition_snapshot_request(request + MessageHeader::HEADER_SIZE);
+    partition = p.partition;
+    partitions = p.partitions;
+  }
+
+  for (const auto &book : universe) {
+    if (symbol_partition(book.symbol, partitions) == partition && !send_all(client, book.messages)) {
+      break;
+    }
+  }
+  close(client);
+}
+
+void serve_channel(int listen_fd, size_t connections, const std::vector<EncodedBook> &universe) {
+  std::vector<std::thread> sessions;
+  for (size_t c = 0; c < connections; ++c) {
+    int client = accept(listen_fd, nullptr, nullptr);
+    if (client < 0) break;
+    sessions.emplace_back(serve_connection, client, std::cref(universe));
+  }
+  for (auto &session : sessions) session.join();
+}
+
+int listen_ephemeral(uint16_t &port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(fd, 64) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+    close(fd);
+    return -1;
+  }
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+struct Trial {
+  uint64_t elapsed_ns = 0;
+  size_t books = 0;
+};
+
+// One full recovery; elapsed 0 on failure
+Trial recover(const std::vector<EncodedBook> &universe, size_t shards, size_t connections) {
+  Trial trial;
+  uint16_t port = 0;
+  int listen_fd = listen_ephemeral(port);
+  if (listen_fd < 0) return trial;
+  std::thread server(serve_channel, listen_fd, connections, std::cref(universe));
+
+  {
+    ParallelSnapshotRecovery recovery(shards, connections);
+    if (recovery.start("127.0.0.1", port)) {
+      // A feed handler installs books as they finish; here they're discarded
+      while (!recovery.finished()) {
+        recovery.take_completed();
+        std::this_thread::yield();
+      }
+      recovery.take_completed();
+      recovery.join();
+      if (recovery.take_failed().empty()) {
+        trial.elapsed_ns = recovery.elapsed_ns();
+        trial.books = recovery.books_recovered();
+      }
+    }
+  }
+
+  server.join();
+  close(listen_fd);
+  return trial;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t symbols = argc > 1 ? std::stoul(argv[1]) : 4096;
+  size_t levels = argc > 2 ? std::stoul(argv[2]) : 100;
+  size_t max_threads = argc > 3 ? std::stoul(argv[3])
+                                : std::max(1u, std::thread::hardware_concurrency());
+  size_t connections = argc > 4 ? std::max<size_t>(1, std::stoul(argv[4])) : 2;
+  int trials = argc > 5 ? std::max(1, std::atoi(argv[5])) : 5;
+
+  std::cout << "=== Parallel Recovery Benchmark ===" << std::endl;
+  std::cout << "Symbols: " << symbols << ", levels per side: " << levels
+            << ", snapshot connections: " << connections << ", trials: " << trials
+            << ", cores: " << std::thread::hardware_concurrency() << "\n" << std::endl;
+
+  auto universe = make_universe(symbols, levels);
+  size_t bytes = 0;
+  for (const auto &book : universe) bytes += book.messages.size();
+  printf("Universe: %.1f MB of chunked snapshots\n\n", bytes / 1e6);
+
+  printf("%8s %12s %14s %14s %9s\n", "shards", "best ms", "books/s", "levels/s (M)", "speedup");
+  // 1, 2, 4, ... and always max_threads itself
+  std::vector<size_t> thread_counts;
+  for (size_t n = 1; n < max_threads; n *= 2) thread_counts.push_back(n);
+  thread_counts.push_back(max_threads);
+
+  double baseline_ms = 0;
+  for (size_t shards : thread_counts) {
+    uint64_t best = 0;
+    for (int t = 0; t < trials; ++t) {
+      Trial trial = recover(universe, shards, connections);
+      if (trial.elapsed_ns == 0 || trial.books != symbols) {
+        std::cerr << "Recovery failed with " << shards << " shards" << std::endl;
+        return 1;
+      }
+      best = best == 0 ? trial.elapsed_ns : std::min(best, trial.elapsed_ns);
+    }
+
+    double ms = best / 1e6;
+    if (baseline_ms == 0) baseline_ms = ms;
+    printf("%8zu %12.2f %14.0f %14.2f %8.2fx\n", shards, ms, symbols / (ms / 1e3),
+           symbols * levels * 2 / (ms / 1e3) / 1e6, baseline_ms / ms);
+  }
+  return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * Republisher Load Test Driver
+ *
+ * Publisher side of the republisher load test: starts a TcpRepublisher,
+ * waits for the expected number of consumers (binary_client processes,
+ * see scripts/republisher_load_test.sh), publishes a tick stream at a
+ * fixed rate and reports what the republisher did with it. The main
+ * thread stands in for the book thread, so publish() latency shows what
+ * republishing costs it.
+ *
+ * Usage:
+ *   ./republisher_load_test <port> <clients> [events] [rate/s, 0 = flat out]
+ *                           [disconnect|drop] [max-delay-us]
+ *   ./republisher_load_test 7000 20 2000000 500000 disconnect 200
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common.hpp"
+#include "republisher.hpp"
+
+namespace {
+
+constexpr size_t UNIVERSE = 500;
+
+std::string symbol_name(size_t i) {
+  std::string s(4, 'A');
+  for (int c = 3; c >= 0; --c) {
+    s[c] = static_cast<char>('A' + i % 26);
+    i /= 26;
+  }
+  return s;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <port> <clients> [events] [rate] [disconnect|drop] [max-delay-us]" << std::endl;
+    return 1;
+  }
+  RepublisherConfig config;
+  config.port = std::stoi(argv[1]);
+  size_t clients = std::stoul(argv[2]);
+  size_t events = argc > 3 ? std::stoul(argv[3]) : 2'000'000;
+  uint64_t rate = argc > 4 ? std::stoull(argv[4]) : 500'000;
+  config.policy = (argc > 5 && std::string(argv[5]) == "drop") ? SlowClientPolicy::DROP
+                                                               : SlowClientPolicy::DISCONNECT;
+  config.max_delay_us = argc > 6 ? std::stoull(argv[6]) : config.max_delay_us;
+
+  TcpRepublisher republisher(config);
+  auto started = republisher.start();
+  if (!started) {
+    std::cerr << started.error() << std::endl;
+    return 1;
+  }
+
+  std::cout << "=== Republisher Load Test ===" << std::endl;
+  std::cout << "Port " << republisher.port() << ", waiting for " << clients << " clients..."
+            << std::endl;
+  uint64_t deadline = now_ns() + 30'000'000'000ULL;
+  while (republisher.clients() < clients && now_ns() < deadline) {
+    usleep(1000);
+  }
+  if (republisher.clients() < clients) {
+    std::cerr << "Only " << republisher.clients() << " clients connected" << std::endl;
+    return 1;
+  }
+
+  std::mt19937_64 rng(7);
+  std::vector<std::string> names;
+  for (size_t i = 0; i < UNIVERSE; ++i) names.push_back(symbol_name(i));
+
+  // One publish() in 16 is timed; timing every call would dominate at full rate
+  LatencyStats publish_latency;
+  publish_latency.reserve(events / 16 + 1);
+  uint64_t start = now_ns();
+  for (size_t e = 0; e < events;) {
+    size_t due = rate ? std::min<size_t>(events, (now_ns() - start) * rate / 1'000'000'000ULL + 1)
+                      : std::min<size_t>(events, e + 256);
+    for (; e < due; ++e) {
+      DistributionEvent event;
+      memcpy(event.symbol, names[rng() % UNIVERSE].data(), 4);
+      event.timestamp = now_ns();
+      event.price = 100.0f + static_cast<float>(e % 100);
+      event.quantity = 100;
+      if (e % 16 == 0) {
+        uint64_t t0 = now_ns();
+        republisher.publish(event);
+        publish_latency.add(now_ns() - t0);
+      } else {
+        republisher.publish(event);
+      }
+    }
+    if (rate && e == due) {
+      std::this_thread::yield();
+    }
+  }
+  uint64_t publish_wall = now_ns() - start;
+
+  republisher.stop();  // Drains, then closes every client
+  uint64_t wall = now_ns() - start;
+
+  double batches = std::max<double>(1.0, static_cast<double>(republisher.batches()));
+  printf("\nClients:            %lu (policy %s, max delay %lu us)\n",
+         static_cast<unsigned long>(republisher.clients_accepted()),
+         slow_client_policy_name(config.policy), static_cast<unsigned long>(config.max_delay_us));
+  printf("Events:             %lu in %.0f ms (%.0f events/s offered)\n",
+         static_cast<unsigned long>(republisher.events_published()), publish_wall / 1e6,
+         events / (publish_wall / 1e9));
+  printf("publish() ns:       p50 %lu  p99 %lu  max %lu\n",
+         static_cast<unsigned long>(publish_latency.percentile(50)),
+         static_cast<unsigned long>(publish_latency.percentile(99)),
+         static_cast<unsigned long>(publish_latency.max()));
+  printf("Frames sent:        %lu (%.0f frames/s incl. drain)\n",
+         static_cast<unsigned long>(republisher.frames_sent()),
+         republisher.frames_sent() / (wall / 1e9));
+  printf("Sends:              %lu (%.1f frames, %.0f bytes each)\n",
+         static_cast<unsigned long>(republisher.batches()), republisher.frames_sent() / batches,
+         republisher.bytes_sent() / batches);
+  printf("Frames dropped:     %lu\n", static_cast<unsigned long>(republisher.frames_dropped()));
+  printf("Slow disconnects:   %lu\n", static_cast<unsigned long>(republisher.slow_disconnects()));
+  printf("Queue overruns:     %lu\n", static_cast<unsigned long>(republisher.overruns()));
+  return 0;
+}
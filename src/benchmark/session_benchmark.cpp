@@ -0,0 +1,695 @@
+/**
+ * Session Benchmark
+ *
+ * Coroutine feed sessions (feed_session.hpp, every session on one reactor
+ * thread) against the polling model of feed_handler_snapshot: a thread per
+ * connection driving ConnectionManagerV2 and sleeping 1 ms whenever recv()
+ * has nothing. Both decode frames into SymbolBooks the same way; only how
+ * they wait differs. An in-process exchange serves every connection:
+ * snapshots on request, then the same book update stream to all of them
+ * and a heartbeat every 100 ms.
+ *
+ * For each session count and model:
+ *   recovery    connect started -> every book VALID, first connection
+ *   reconnect   exchange drops every connection -> every book VALID again
+ *   CPU         client CPU (process minus the exchange thread) in % of one
+ *               core, while streaming and with heartbeats only
+ *   RSS         resident memory added per session
+ *
+ * The polling model reconnects at once, as the sessions do;
+ * ConnectionManagerV2::reconnect() would sleep its 1 s backoff first.
+ *
+ * Usage:
+ *   ./session_benchmark [--sessions 10,100,1000] [--symbols 4] [--rate 200]
+ *                       [--seconds 2] [--csv]
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "connection_manager.hpp"
+#include "feed_session.hpp"
+#include "message_views.hpp"
+#include "order_book.hpp"
+#include "sequence_tracker.hpp"
+#include "symbol_books.hpp"
+
+namespace {
+
+const char *const SYMBOLS[] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "META", "NVDA", "JPM "};
+constexpr size_t MAX_SYMBOLS = sizeof(SYMBOLS) / sizeof(SYMBOLS[0]);
+constexpr size_t BOOK_LEVELS = 10;
+constexpr uint64_t HEARTBEAT_INTERVAL_NS = 100'000'000;
+constexpr uint64_t LIVE_TIMEOUT_NS = 60'000'000'000ULL;
+
+struct BenchConfig {
+  std::vector<size_t> sessions = {10, 100, 1000};
+  size_t symbols = 4;
+  uint64_t rate = 200;  // Book updates per second, each sent to every session
+  double seconds = 2.0;
+  bool csv = false;
+};
+
+uint64_t process_cpu_ns() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  auto ns = [](const timeval &tv) { return tv.tv_sec * 1'000'000'000ULL + tv.tv_usec * 1000ULL; };
+  return ns(usage.ru_utime) + ns(usage.ru_stime);
+}
+
+size_t resident_bytes() {
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (!statm) {
+    return 0;
+  }
+  unsigned long size = 0, resident = 0;
+  if (fscanf(statm, "%lu %lu", &size, &resident) != 2) {
+    resident = 0;
+  }
+  fclose(statm);
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+void sleep_seconds(double seconds) {
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
+
+/**
+ * Single-threaded epoll exchange. Every connection gets every update from
+ * the moment it connects, numbered with its own sequence, so a snapshot
+ * (taken from the shared books) lines up with what that connection has
+ * already been sent.
+ */
+class Exchange {
+public:
+  explicit Exchange(size_t symbols) {
+    for (size_t i = 0; i < symbols; ++i) {
+      symbols_.push_back(SYMBOLS[i]);
+      OrderBook book;
+      float mid = 100.0f + 50.0f * i;
+      for (size_t level = 0; level < BOOK_LEVELS; ++level) {
+        book.add_level(0, mid - 0.05f * (level + 1), 100 + level);
+        book.add_level(1, mid + 0.05f * (level + 1), 100 + level);
+      }
+      books_.push_back(std::move(book));
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    listen(listen_fd_, 4096);
+    fcntl(listen_fd_, F_SETFL, O_NONBLOCK);
+
+    epoll_fd_ = epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+  }
+
+  ~Exchange() {
+    stop();
+    close(listen_fd_);
+    close(epoll_fd_);
+  }
+
+  int port() const { return port_; }
+
+  void start(uint64_t rate) {
+    rate_ = rate;
+    running_ = true;
+    thread_ = std::thread([this]() { loop(); });
+  }
+
+  void stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+  }
+
+  void set_rate(uint64_t rate) { rate_ = rate; }
+
+  // Close every connection; returns when done, with the time it happened
+  uint64_t drop_all() {
+    uint64_t before = drops_.load();
+    drop_requested_ = true;
+    while (drops_.load() == before) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return drop_ns_.load();
+  }
+
+  uint64_t cpu_ns() {
+    clockid_t clock;
+    timespec ts{};
+    if (pthread_getcpuclockid(thread_.native_handle(), &clock) != 0 ||
+        clock_gettime(clock, &ts) != 0) {
+      return 0;
+    }
+    return ts.tv_sec * 1'000'000'000ULL + ts.tv_nsec;
+  }
+
+private:
+  struct Client {
+    int fd;
+    uint64_t sequence = 0;
+    std::string in;
+    std::string out;
+    bool want_write = false;
+    bool closed = false;
+  };
+
+  void loop() {
+    std::mt19937 rng(42);
+    uint64_t last_ns = now_ns();
+    uint64_t next_heartbeat = last_ns + HEARTBEAT_INTERVAL_NS;
+    double owed = 0;
+    epoll_event events[256];
+
+    while (running_) {
+      int n = epoll_wait(epoll_fd_, events, 256, 1);
+      for (int i = 0; i < n; ++i) {
+        Client *client = static_cast<Client *>(events[i].data.ptr);
+        if (!client) {
+          accept_clients();
+          continue;
+        }
+        if (client->closed) {
+          continue;
+        }
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+          read_requests(*client);
+        }
+        if (!client->closed && (events[i].events & EPOLLOUT)) {
+          flush(*client);
+        }
+      }
+
+      if (drop_requested_) {
+        for (auto &client : clients_) close_client(*client);
+        drop_requested_ = false;
+        drop_ns_ = now_ns();
+        drops_++;
+      }
+
+      uint64_t now = now_ns();
+      owed += rate_.load() * (now - last_ns) / 1e9;
+      last_ns = now;
+      for (; owed >= 1.0; owed -= 1.0) {
+        broadcast_update(rng);
+      }
+      if (now >= next_heartbeat) {
+        std::string heartbeat = serialize_heartbeat(0, now);
+        for (auto &client : clients_) append(*client, heartbeat);
+        next_heartbeat = now + HEARTBEAT_INTERVAL_NS;
+      }
+
+      for (auto &client : clients_) {
+        if (!client->closed && !client->out.empty() && !client->want_write) flush(*client);
+      }
+      clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                    [](const auto &client) { return client->closed; }),
+                     clients_.end());
+    }
+
+    for (auto &client : clients_) close_client(*client);
+    clients_.clear();
+  }
+
+  void accept_clients() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
+      int flag = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+      fcntl(fd, F_SETFL, O_NONBLOCK);
+      clients_.push_back(std::make_unique<Client>());
+      Client &client = *clients_.back();
+      client.fd = fd;
+      epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.ptr = &client;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+  }
+
+  void read_requests(Client &client) {
+    char buffer[4096];
+    while (true) {
+      ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+      if (n > 0) {
+        client.in.append(buffer, n);
+        continue;
+      }
+      if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        close_client(client);
+        return;
+      }
+      break;
+    }
+
+    constexpr size_t REQUEST = MessageHeader::HEADER_SIZE + SnapshotRequestPayload::PAYLOAD_SIZE;
+    size_t offset = 0;
+    for (; client.in.size() - offset >= REQUEST; offset += REQUEST) {
+      std::string symbol = trim_symbol(client.in.data() + offset + MessageHeader::HEADER_SIZE, 4);
+      for (size_t i = 0; i < symbols_.size(); ++i) {
+        if (trim_symbol(symbols_[i].c_str(), 4) == symbol) {
+          const OrderBook &book = books_[i];
+          append(client, serialize_snapshot_response(0, symbols_[i].c_str(),
+                                                     book.get_top_bids(book.bid_depth()),
+                                                     book.get_top_asks(book.ask_depth())));
+        }
+      }
+    }
+    client.in.erase(0, offset);
+    flush(client);
+  }
+
+  void broadcast_update(std::mt19937 &rng) {
+    size_t index = rng() % symbols_.size();
+    uint8_t side = rng() % 2;
+    size_t level = rng() % BOOK_LEVELS;
+    float mid = 100.0f + 50.0f * index;
+    float price = side == 0 ? mid - 0.05f * (level + 1) : mid + 0.05f * (level + 1);
+    int64_t quantity = rng() % 10 == 0 ? 0 : 1 + rng() % 500;
+    books_[index].apply_update(side, price, quantity);
+
+    std::string frame = serialize_order_book_update(0, symbols_[index].c_str(), side, price, quantity);
+    for (auto &client : clients_) append(*client, frame);
+  }
+
+  // Frame with this connection's next sequence number
+  static void append(Client &client, const std::string &frame) {
+    if (client.closed) {
+      return;
+    }
+    size_t at = client.out.size();
+    client.out += frame;
+    uint64_t sequence = htonll(++client.sequence);
+    memcpy(&client.out[at + 5], &sequence, sizeof(sequence));
+  }
+
+  void flush(Client &client) {
+    size_t sent = 0;
+    while (sent < client.out.size()) {
+      ssize_t n = send(client.fd, client.out.data() + sent, client.out.size() - sent, MSG_NOSIGNAL);
+      if (n > 0) {
+        sent += n;
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      }
+      close_client(client);
+      return;
+    }
+    client.out.erase(0, sent);
+
+    bool want_write = !client.out.empty();
+    if (want_write != client.want_write) {
+      epoll_event ev{};
+      ev.events = want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+      ev.data.ptr = &client;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, client.fd, &ev);
+      client.want_write = want_write;
+    }
+  }
+
+  void close_client(Client &client) {
+    if (client.closed) {
+      return;
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client.fd, nullptr);
+    close(client.fd);
+    client.closed = true;
+  }
+
+  std::vector<std::string> symbols_;
+  std::vector<OrderBook> books_;
+  std::vector<std::unique_ptr<Client>> clients_;
+  int listen_fd_ = -1;
+  int epoll_fd_ = -1;
+  int port_ = 0;
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> rate_{0};
+  std::atomic<bool> drop_requested_{false};
+  std::atomic<uint64_t> drop_ns_{0};
+  std::atomic<uint64_t> drops_{0};
+};
+
+// Live events from either model: when each session last went live, and
+// how long its recovery took
+struct Probe {
+  explicit Probe(size_t sessions) : live_at(sessions), recovery(sessions) {}
+
+  void record(size_t index, uint64_t recovery_ns) {
+    live_at[index] = now_ns();
+    recovery[index] = recovery_ns;
+    live_events.fetch_add(1, std::memory_order_release);
+  }
+
+  bool wait_for(size_t events) const {
+    uint64_t deadline = now_ns() + LIVE_TIMEOUT_NS;
+    while (live_events.load(std::memory_order_acquire) < events) {
+      if (now_ns() > deadline) return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  std::vector<uint64_t> live_at;
+  std::vector<uint64_t> recovery;
+  std::atomic<size_t> live_events{0};
+};
+
+struct ModelResult {
+  LatencyStats recovery;
+  LatencyStats reconnect;
+  double cpu_stream_pct = 0;
+  double cpu_idle_pct = 0;
+  double kb_per_session = 0;
+  size_t threads = 0;
+  size_t session_bytes = 0;  // Coroutine model: FeedSession object and buffers
+  size_t frame_bytes = 0;    // Coroutine model: suspended frames per session
+  size_t went_live = 0;
+  bool complete = false;
+};
+
+double client_cpu_pct(Exchange &exchange, double seconds) {
+  uint64_t wall = now_ns();
+  uint64_t process = process_cpu_ns();
+  uint64_t server = exchange.cpu_ns();
+  sleep_seconds(seconds);
+  uint64_t client = (process_cpu_ns() - process) - (exchange.cpu_ns() - server);
+  return 100.0 * client / (now_ns() - wall);
+}
+
+// The phases both models go through once their sessions are started
+void measure(Exchange &exchange, Probe &probe, size_t sessions, const BenchConfig &config,
+             size_t rss_before, ModelResult &result) {
+  bool all_live = probe.wait_for(sessions);
+  result.went_live = probe.live_events.load();
+  if (!all_live) {
+    return;
+  }
+  for (uint64_t ns : probe.recovery) result.recovery.add(ns);
+  result.kb_per_session = (resident_bytes() - rss_before) / 1024.0 / sessions;
+
+  sleep_seconds(0.2);
+  result.cpu_stream_pct = client_cpu_pct(exchange, config.seconds);
+
+  exchange.set_rate(0);
+  sleep_seconds(0.2);
+  result.cpu_idle_pct = client_cpu_pct(exchange, config.seconds);
+  exchange.set_rate(config.rate);
+
+  uint64_t dropped_ns = exchange.drop_all();
+  if (!probe.wait_for(2 * sessions)) {
+    return;
+  }
+  for (uint64_t live_ns : probe.live_at) result.reconnect.add(live_ns - dropped_ns);
+  result.complete = true;
+}
+
+ModelResult run_coroutines(size_t sessions, const BenchConfig &config) {
+  ModelResult result;
+  result.threads = 1;
+  Exchange exchange(config.symbols);
+  exchange.start(config.rate);
+  Probe probe(sessions);
+  size_t rss_before = resident_bytes();
+  size_t frames_before = session_detail::frame_bytes.load();
+
+  // SequenceTracker logs every resync to stdout
+  std::streambuf *out = std::cout.rdbuf(nullptr);
+
+  // Sessions are created on the reactor thread, as an application would
+  // from inside its event loop, so the first ones are not held up behind
+  // a reactor that has not started yet.
+  SessionReactor reactor;
+  std::vector<std::unique_ptr<FeedSession>> clients;
+  std::thread loop([&]() {
+    for (size_t i = 0; i < sessions; ++i) {
+      FeedSessionConfig session_config;
+      session_config.port = exchange.port();
+      session_config.symbols.assign(SYMBOLS, SYMBOLS + config.symbols);
+      clients.push_back(std::make_unique<FeedSession>(reactor, session_config));
+      clients.back()->set_live_callback([&probe, &result, i](FeedSession &session) {
+        if (i == 0 && result.session_bytes == 0) result.session_bytes = session.footprint_bytes();
+        probe.record(i, session.stats().last_recovery_ns);
+      });
+      clients.back()->start();
+    }
+    reactor.run();
+  });
+
+  measure(exchange, probe, sessions, config, rss_before, result);
+  result.frame_bytes = (session_detail::frame_bytes.load() - frames_before) / sessions;
+
+  reactor.stop();
+  loop.join();
+  std::cout.rdbuf(out);
+  std::cout.clear();
+  clients.clear();
+  exchange.stop();
+  return result;
+}
+
+/**
+ * One polling session: feed_handler_snapshot's main loop with its
+ * ConnectionManagerV2 transitions, decoding into SymbolBooks as the
+ * coroutine session does.
+ */
+void polling_session(int port, const BenchConfig &config, size_t index, Probe &probe,
+                     const std::atomic<bool> &stop) {
+  ConnectionManagerV2 conn("127.0.0.1", port);
+  SymbolBooks books;
+  for (size_t i = 0; i < config.symbols; ++i) books.add(trim_symbol(SYMBOLS[i], 4));
+  SequenceTracker tracker;
+  std::vector<char> buffer(4096);
+  size_t buffered = 0;
+  std::vector<OrderBookLevel> bids, asks;
+  uint64_t client_sequence = 0;
+  bool live = false;
+
+  uint64_t started = now_ns();
+  while (!conn.connect()) {
+    if (stop) return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  conn.transition_to_snapshot_request();
+
+  while (!stop.load(std::memory_order_relaxed)) {
+    if (conn.needs_snapshot_request()) {
+      std::string requests;
+      for (auto &[symbol, entry] : books.books()) {
+        char wire[4] = {};
+        memcpy(wire, symbol.data(), std::min<size_t>(symbol.size(), 4));
+        requests += serialize_snapshot_request(client_sequence++, wire);
+        books.begin_recovery(entry, now_ns());
+      }
+      send(conn.sockfd(), requests.data(), requests.size(), MSG_NOSIGNAL);
+      conn.mark_snapshot_requested();
+    }
+
+    ssize_t n = recv(conn.sockfd(), buffer.data() + buffered, buffer.size() - buffered, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // As read_and_process(): nothing there yet
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    if (n <= 0) {
+      conn.disconnect();
+      live = false;
+      buffered = 0;
+      tracker.reset();
+      started = now_ns();
+      while (!stop && !conn.connect()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      conn.transition_to_snapshot_request();
+      continue;
+    }
+    conn.update_last_message_time();
+    buffered += n;
+
+    size_t offset = 0;
+    while (buffered - offset >= MessageHeader::HEADER_SIZE) {
+      MessageHeader header = deserialize_header(buffer.data() + offset);
+      size_t total = MessageHeader::HEADER_SIZE + header.length;
+      if (buffered - offset < total) {
+        if (total > buffer.size()) buffer.resize(total);
+        break;
+      }
+      const char *payload = buffer.data() + offset + MessageHeader::HEADER_SIZE;
+      if (!tracker.process_sequence(header.sequence)) {
+        books.mark_all_stale(now_ns());
+      }
+      if (header.type == MessageType::SNAPSHOT_RESPONSE) {
+        char symbol[4];
+        deserialize_snapshot_response(payload, header.length, symbol, bids, asks);
+        if (SymbolBook *entry = books.find(trim_symbol(symbol, 4))) {
+          books.begin_snapshot(*entry, header.sequence, now_ns());
+          for (const auto &level : bids) books.add_snapshot_level(*entry, 0, level.price, level.quantity);
+          for (const auto &level : asks) books.add_snapshot_level(*entry, 1, level.price, level.quantity);
+          books.finish_snapshot(*entry);
+        }
+      } else if (header.type == MessageType::ORDER_BOOK_UPDATE) {
+        books.apply_update(header.sequence, BookUpdateView(payload));
+      }
+      offset += total;
+    }
+    memmove(buffer.data(), buffer.data() + offset, buffered - offset);
+    buffered -= offset;
+
+    if (!live && books.count(BookState::RECOVERING) == 0) {
+      live = true;
+      conn.transition_to_snapshot_replay();
+      conn.transition_to_incremental();
+      probe.record(index, now_ns() - started);
+    }
+  }
+}
+
+ModelResult run_polling(size_t sessions, const BenchConfig &config) {
+  ModelResult result;
+  result.threads = sessions;
+  Exchange exchange(config.symbols);
+  exchange.start(config.rate);
+  Probe probe(sessions);
+  size_t rss_before = resident_bytes();
+
+  // ConnectionManagerV2 reports every transition on stdout/stderr
+  std::streambuf *out = std::cout.rdbuf(nullptr);
+  std::streambuf *err = std::cerr.rdbuf(nullptr);
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < sessions; ++i) {
+    threads.emplace_back(polling_session, exchange.port(), std::cref(config), i,
+                         std::ref(probe), std::cref(stop));
+  }
+
+  measure(exchange, probe, sessions, config, rss_before, result);
+
+  stop = true;
+  for (auto &thread : threads) thread.join();
+  std::cout.rdbuf(out);
+  std::cerr.rdbuf(err);
+  std::cout.clear();
+  std::cerr.clear();
+  exchange.stop();
+  return result;
+}
+
+void print_result(const char *model, size_t sessions, const ModelResult &r, bool csv) {
+  if (csv) {
+    printf("%s,%zu,%lu,%lu,%lu,%lu,%.2f,%.2f,%zu,%.1f\n", model, sessions,
+           r.recovery.percentile(50) / 1000, r.recovery.percentile(99) / 1000,
+           r.reconnect.percentile(50) / 1000, r.reconnect.percentile(99) / 1000,
+           r.cpu_stream_pct, r.cpu_idle_pct, r.threads, r.kb_per_session);
+    return;
+  }
+  if (!r.complete) {
+    printf("%-10s %zu of %zu sessions live after %.0f s\n", model, std::min(r.went_live, sessions),
+           sessions, LIVE_TIMEOUT_NS / 1e9);
+    return;
+  }
+  printf("%-10s %8.2f %8.2f %9.2f %8.2f %9.1f %8.1f %8zu %9.1f\n", model,
+         r.recovery.percentile(50) / 1e6, r.recovery.percentile(99) / 1e6,
+         r.reconnect.percentile(50) / 1e6, r.reconnect.percentile(99) / 1e6, r.cpu_stream_pct,
+         r.cpu_idle_pct, r.threads, r.kb_per_session);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--sessions" && i + 1 < argc) {
+      config.sessions.clear();
+      std::string list = argv[++i];
+      for (size_t start = 0; start < list.size();) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        config.sessions.push_back(std::stoul(list.substr(start, comma - start)));
+        start = comma + 1;
+      }
+    } else if (arg == "--symbols" && i + 1 < argc) {
+      config.symbols = std::clamp<size_t>(std::stoul(argv[++i]), 1, MAX_SYMBOLS);
+    } else if (arg == "--rate" && i + 1 < argc) {
+      config.rate = std::stoull(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      config.seconds = std::stod(argv[++i]);
+    } else if (arg == "--csv") {
+      config.csv = true;
+    }
+  }
+
+  // Two descriptors per session (both ends are in this process)
+  rlimit files{};
+  getrlimit(RLIMIT_NOFILE, &files);
+  files.rlim_cur = files.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &files);
+  Logger::set_level(LogLevel::ERROR);
+
+  if (config.csv) {
+    printf("model,sessions,recovery_p50_us,recovery_p99_us,reconnect_p50_us,reconnect_p99_us,"
+           "cpu_stream_pct,cpu_idle_pct,threads,kb_per_session\n");
+  } else {
+    printf("=== Coroutine Sessions vs Polling Threads ===\n");
+    printf("%zu symbols per session, %lu book updates/s to every session, heartbeat every %lu ms, "
+           "%.1f s CPU windows\n",
+           config.symbols, config.rate, HEARTBEAT_INTERVAL_NS / 1'000'000, config.seconds);
+  }
+
+  for (size_t sessions : config.sessions) {
+    if (!config.csv) {
+      printf("\n--- %zu sessions ---\n", sessions);
+      printf("%-10s %17s %18s %18s %8s %9s\n", "", "recovery ms", "reconnect ms", "client CPU %",
+             "threads", "KB/sess");
+      printf("%-10s %8s %8s %9s %8s %9s %8s\n", "model", "p50", "p99", "p50", "p99", "stream",
+             "idle");
+    }
+    ModelResult coroutine = run_coroutines(sessions, config);
+    print_result("coroutine", sessions, coroutine, config.csv);
+    if (!config.csv) {
+      printf("%-10s (each session: %zu B object and buffers, %zu B coroutine frames)\n", "",
+             coroutine.session_bytes, coroutine.frame_bytes);
+    }
+    ModelResult polling = run_polling(sessions, config);
+    print_result("polling", sessions, polling, config.csv);
+  }
+  return 0;
+}
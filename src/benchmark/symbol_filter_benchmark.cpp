@@ -0,0 +1,155 @@
+/**
+ * Symbol Filter Benchmark
+ *
+ * Two measurements:
+ *
+ *   1. Lookup cost per tick for subscription sets of several sizes: the
+ *      packed SIMD compare, the symbol-id bitset and an unordered_set.
+ *   2. Reader CPU as a function of selectivity: BinaryProtocolReader parsing
+ *      a TICK stream over a symbol universe in 64 KiB receive chunks, with
+ *      no subscription and with subscriptions to a shrinking share of it.
+ *
+ * Usage:
+ *   ./symbol_filter_benchmark [ticks] [universe]
+ *   ./symbol_filter_benchmark 1000000 4096
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "net/feed.hpp"
+#include "symbol_filter.hpp"
+
+namespace {
+
+template <typename Fn>
+uint64_t time_best(int trials, Fn&& fn) {
+  uint64_t best = UINT64_MAX;
+  for (int t = 0; t < trials; ++t) {
+    uint64_t start = now_ns();
+    fn();
+    best = std::min(best, now_ns() - start);
+  }
+  return best;
+}
+
+// Distinct 4-letter symbols
+std::vector<std::string> make_universe(size_t count) {
+  std::vector<std::string> symbols;
+  for (size_t i = 0; i < count; ++i) {
+    std::string s(4, 'A');
+    size_t n = i;
+    for (int c = 3; c >= 0; --c) {
+      s[c] = static_cast<char>('A' + n % 26);
+      n /= 26;
+    }
+    symbols.push_back(s);
+  }
+  return symbols;
+}
+
+void lookup_costs(const std::vector<std::string>& universe) {
+  std::mt19937_64 rng(3);
+  const size_t lookups = 1 << 22;
+  std::vector<uint32_t> keys(lookups);
+  for (auto& key : keys) key = padded_symbol_key(universe[rng() % universe.size()]);
+
+  printf("Lookup cost, ns per tick (universe %zu symbols)\n", universe.size());
+  printf("%8s %12s %12s %14s\n", "set size", "packed", "bitset", "unordered_set");
+
+  for (size_t size : {1, 4, 16, 32, 64, 256, 4096}) {
+    if (size > universe.size()) break;
+    std::vector<std::string> subscribed(universe.begin(), universe.begin() + size);
+    SymbolFilter packed(subscribed, std::numeric_limits<size_t>::max());
+    SymbolFilter bitset(subscribed, 0);
+    std::unordered_set<uint32_t> hashed;
+    for (const auto& s : subscribed) hashed.insert(padded_symbol_key(s));
+
+    volatile size_t sink = 0;
+    auto per_lookup = [&](auto&& matches) {
+      return time_best(3, [&] {
+        size_t hits = 0;
+        for (uint32_t key : keys) hits += matches(key);
+        sink = hits;
+      }) / static_cast<double>(lookups);
+    };
+    double p = per_lookup([&](uint32_t k) { return packed.matches(k); });
+    double b = per_lookup([&](uint32_t k) { return bitset.matches(k); });
+    double h = per_lookup([&](uint32_t k) { return hashed.count(k) != 0; });
+    (void)sink;
+    printf("%8zu %12.2f %12.2f %14.2f%s\n", size, p, b, h,
+           size > SymbolFilter::PACKED_MAX ? "" : "   <- packed by default");
+  }
+}
+
+void reader_selectivity(const std::vector<std::string>& universe, size_t ticks) {
+  std::mt19937_64 rng(4);
+  std::string wire;
+  wire.reserve(ticks * (MessageHeader::HEADER_SIZE + TickPayload::PAYLOAD_SIZE));
+  for (size_t i = 0; i < ticks; ++i) {
+    wire += serialize_tick(i + 1, 1'700'000'000'000'000'000ULL + i, universe[rng() % universe.size()].c_str(),
+                           100.0f + (i % 500) * 0.01f, 100);
+  }
+  const size_t frame = MessageHeader::HEADER_SIZE + TickPayload::PAYLOAD_SIZE;
+  const size_t chunk = (64 * 1024 / frame) * frame;
+
+  SPSCQueue<net::Tick> queue(ticks);
+  std::atomic<bool> stop{false};
+  StageMonitor monitor;
+  Subscription subscription;
+
+  printf("\nReader CPU vs selectivity (%zu ticks, 64 KiB chunks)\n", ticks);
+  printf("%-18s %10s %10s %12s\n", "subscribed", "queued", "ns/tick", "vs no filter");
+
+  double base = 0;
+  auto row = [&](const char* label, bool filtered) {
+    uint64_t queued = 0;
+    uint64_t ns = UINT64_MAX;
+    for (int trial = 0; trial < 5; ++trial) {
+      net::BinaryProtocolReader reader(-1, queue, stop, false, monitor);
+      if (filtered) reader.set_subscription(&subscription);
+      uint64_t start = now_ns();
+      for (size_t off = 0; off < wire.size(); off += chunk) {
+        reader.parse_frames(wire.data() + off, std::min(chunk, wire.size() - off), 0);
+      }
+      ns = std::min(ns, now_ns() - start);
+      queued = reader.messages_parsed();
+      while (queue.pop()) {  // Untimed: the processor's side
+      }
+    }
+    double per = static_cast<double>(ns) / ticks;
+    if (base == 0) base = per;
+    printf("%-18s %10lu %10.2f %11.0f%%\n", label, queued, per, 100.0 * per / base);
+  };
+
+  row("no subscription", false);
+  for (double share : {1.0, 0.5, 0.1, 0.01, 0.001}) {
+    size_t count = std::max<size_t>(1, static_cast<size_t>(universe.size() * share));
+    subscription.subscribe(std::vector<std::string>(universe.begin(), universe.begin() + count));
+    char label[48];
+    snprintf(label, sizeof(label), "%.1f%% (%zu)", share * 100, count);
+    row(label, true);
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  size_t ticks = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+  size_t universe_size = argc > 2 ? std::max<size_t>(1, std::stoul(argv[2])) : 4096;
+
+  std::cout << "=== Symbol Filter Benchmark ===" << std::endl << std::endl;
+
+  auto universe = make_universe(universe_size);
+  lookup_costs(universe);
+  reader_selectivity(universe, ticks);
+  return 0;
+}
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "common.hpp"
+#include "message_views.hpp"
+#include "transport.hpp"
+#include "udp_protocol.hpp"
+
+/**
+ * Transport Benchmark
+ *
+ * Receives the binary_mock_server tick stream over one transport and
+ * reports one-way latency (receive time minus the tick's send timestamp,
+ * both taken from the host clock) and throughput. Run once per transport
+ * against a server listening on it; benchmarks/benchmark_transports.sh
+ * does that for tcp, unix, unixgram and shm, paced and flat out.
+ *
+ * Usage:
+ *   ./transport_benchmark --transport shm --path /feed_bench --messages 50000 [--csv]
+ *   ./transport_benchmark --transport tcp --port 9999
+ */
+
+// Per-transport statistics using consolidated LatencyStats from common.hpp
+struct ProtocolLatencyStats {
+  LatencyStats latency;
+  uint64_t messages_received = 0;
+  uint64_t gaps_detected = 0;
+  uint64_t bytes_received = 0;
+  uint64_t reads = 0;
+  uint64_t elapsed_ns = 0;  // First to last message
+
+  void reserve(size_t n) { latency.reserve(n); }
+
+  void add(uint64_t latency_ns) { latency.add(latency_ns); }
+
+  double messages_per_sec() const {
+    return elapsed_ns ? messages_received * 1e9 / elapsed_ns : 0.0;
+  }
+
+  void print_summary(const std::string &transport) const {
+    if (latency.empty()) {
+      std::cout << transport << ": No data" << std::endl;
+      return;
+    }
+
+    std::vector<uint64_t> sorted = latency.data();
+    std::sort(sorted.begin(), sorted.end());
+
+    uint64_t sum = std::accumulate(sorted.begin(), sorted.end(), 0ULL);
+    double mean_ns = static_cast<double>(sum) / sorted.size();
+
+    uint64_t p50 = sorted[sorted.size() * 50 / 100];
+    uint64_t p95 = sorted[sorted.size() * 95 / 100];
+    uint64_t p99 = sorted[sorted.size() * 99 / 100];
+    uint64_t max = sorted.back();
+
+    std::cout << transport << ":" << std::endl;
+    std::cout << "  Messages: " << messages_received;
+    if (gaps_detected > 0) {
+      std::cout << " (gaps: " << gaps_detected << ")";
+    }
+    std::cout << std::endl;
+    std::cout << "  Mean: " << mean_ns / 1000.0 << " µs" << std::endl;
+    std::cout << "  p50:  " << p50 / 1000.0 << " µs" << std::endl;
+    std::cout << "  p95:  " << p95 / 1000.0 << " µs" << std::endl;
+    std::cout << "  p99:  " << p99 / 1000.0 << " µs" << std::endl;
+    std::cout << "  Max:  " << max / 1000.0 << " µs" << std::endl;
+    std::cout << "  Throughput: " << static_cast<uint64_t>(messages_per_sec()) << " msgs/sec, "
+              << bytes_received * 1e3 / std::max<uint64_t>(elapsed_ns, 1) << " MB/s" << std::endl;
+    std::cout << "  Reads: " << reads << " ("
+              << static_cast<double>(messages_received) / std::max<uint64_t>(reads, 1)
+              << " msgs/read)" << std::endl;
+  }
+
+  void to_csv_line(const std::string &transport) const {
+    if (latency.empty())
+      return;
+
+    std::vector<uint64_t> sorted = latency.data();
+    std::sort(sorted.begin(), sorted.end());
+
+    uint64_t sum = std::accumulate(sorted.begin(), sorted.end(), 0ULL);
+    double mean_ns = static_cast<double>(sum) / sorted.size();
+    uint64_t p50 = sorted[sorted.size() * 50 / 100];
+    uint64_t p95 = sorted[sorted.size() * 95 / 100];
+    uint64_t p99 = sorted[sorted.size() * 99 / 100];
+
+    std::cout << transport << "," << mean_ns / 1000.0 << "," << p50 / 1000.0
+              << "," << p95 / 1000.0 << "," << p99 / 1000.0 << ","
+              << messages_received << "," << gaps_detected << ","
+              << static_cast<uint64_t>(messages_per_sec()) << std::endl;
+  }
+};
+
+ProtocolLatencyStats run_transport_benchmark(const Endpoint &endpoint, size_t num_messages) {
+  std::cout << "\n=== " << transport_name(endpoint.transport) << " Benchmark ===" << std::endl;
+  std::cout << "Endpoint: " << endpoint.to_string() << std::endl;
+
+  ProtocolLatencyStats stats;
+  stats.reserve(num_messages);
+
+  SocketOptions opts;
+  opts.tcp_nodelay = true;
+  opts.recv_buffer_size = 256 * 1024;
+  opts.connect_timeout_ms = 5000;
+
+  auto result = transport_connect(endpoint, opts);
+  if (!result) {
+    LOG_ERROR("Transport", "%s", result.error().c_str());
+    return stats;
+  }
+  TransportChannel &channel = result.value();
+
+  std::cout << "Connected" << std::endl;
+
+  // Carry-over buffer as in the feed handler's BinaryProtocolReader
+  char buffer[64 * 1024];
+  size_t buffered = 0;
+  SequenceGapTracker gap_tracker;
+  uint64_t first_ns = 0;
+  uint64_t last_ns = 0;
+
+  while (stats.messages_received < num_messages) {
+    ssize_t bytes_read = channel.read(buffer + buffered, sizeof(buffer) - buffered);
+    if (bytes_read < 0) {
+      if (errno == EINTR) continue;
+      LOG_PERROR("Transport", "read failed");
+      break;
+    } else if (bytes_read == 0) {
+      std::cout << "Connection closed" << std::endl;
+      break;
+    }
+    uint64_t recv_ns = now_ns();
+    stats.reads++;
+    stats.bytes_received += bytes_read;
+    buffered += bytes_read;
+
+    size_t offset = 0;
+    while (buffered - offset >= MessageHeader::HEADER_SIZE) {
+      MessageHeader header = deserialize_header(buffer + offset);
+      if (header.length != TickPayload::PAYLOAD_SIZE) {
+        LOG_ERROR("Transport", "Invalid message length: %u (expected %zu)", header.length,
+                  TickPayload::PAYLOAD_SIZE);
+        return stats;
+      }
+      size_t total_size = MessageHeader::HEADER_SIZE + header.length;
+      if (buffered - offset < total_size) {
+        break;
+      }
+
+      gap_tracker.process_sequence(header.sequence);
+      uint64_t sent_ns = TickView(buffer + offset + MessageHeader::HEADER_SIZE).timestamp();
+      stats.add(recv_ns > sent_ns ? recv_ns - sent_ns : 0);
+      if (stats.messages_received++ == 0) {
+        first_ns = recv_ns;
+      }
+      last_ns = recv_ns;
+      offset += total_size;
+
+      if (stats.messages_received % 10000 == 0) {
+        std::cout << "  Received " << stats.messages_received << " messages\r" << std::flush;
+      }
+    }
+    memmove(buffer, buffer + offset, buffered - offset);
+    buffered -= offset;
+  }
+
+  stats.gaps_detected = gap_tracker.total_gaps_detected();
+  stats.elapsed_ns = last_ns - first_ns;
+
+  std::cout << "\n" << transport_name(endpoint.transport) << " test completed in "
+            << stats.elapsed_ns / 1e9 << "s" << std::endl;
+  return stats;
+}
+
+int main(int argc, char *argv[]) {
+  Endpoint endpoint;
+  endpoint.port = 9999;
+  size_t num_messages = 50000;
+  bool csv_output = false;
+  std::string label;
+
+  // Parse arguments
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--transport" && i + 1 < argc) {
+      auto transport = parse_transport(argv[++i]);
+      if (!transport) {
+        LOG_ERROR("Main", "Unknown transport %s (tcp, unix, unixgram, shm)", argv[i]);
+        return 1;
+      }
+      endpoint.transport = *transport;
+    } else if (arg == "--path" && i + 1 < argc) {
+      endpoint.path = argv[++i];
+    } else if (arg == "--port" && i + 1 < argc) {
+      endpoint.port = std::atoi(argv[++i]);
+    } else if (arg == "--messages" && i + 1 < argc) {
+      num_messages = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--label" && i + 1 < argc) {
+      label = argv[++i];
+    } else if (arg == "--csv") {
+      csv_output = true;
+    }
+  }
+  if (endpoint.transport != Transport::TCP && endpoint.path.empty()) {
+    LOG_ERROR("Main", "--transport %s needs --path", transport_name(endpoint.transport));
+    return 1;
+  }
+  if (label.empty()) {
+    label = transport_name(endpoint.transport);
+  }
+
+  std::cout << "=== Transport Benchmark ===" << std::endl;
+  std::cout << "Messages per test: " << num_messages << std::endl;
+
+  ProtocolLatencyStats stats = run_transport_benchmark(endpoint, num_messages);
+
+  if (csv_output) {
+    std::cout << "\ntransport,mean_us,p50_us,p95_us,p99_us,messages,gaps,msgs_per_sec"
+              << std::endl;
+    stats.to_csv_line(label);
+  } else {
+    stats.print_summary(label);
+  }
+
+  return stats.messages_received == num_messages ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/**
+ * Warm-up Benchmark
+ *
+ * Measures how slow the first messages after startup are, with and without
+ * the feed handler warm-up phase (net::FeedConfig::warmup).
+ *
+ * Each trial runs in a freshly forked process so nothing is warm from the
+ * previous one. Inside the child, a server thread streams paced binary ticks
+ * whose timestamp field carries the send time; the handler's callback applies
+ * each tick to an order book and records send → book-updated latency.
+ *
+ * Usage:
+ *   ./warmup_benchmark [messages] [trials] [warmup_ms]
+ *   ./warmup_benchmark 5000 3 250
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <iostream>
+#include <netinet/in.h>
+#include <numeric>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "net/feed.hpp"
+
+namespace {
+
+const char *SYMBOLS[] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA", "META", "NFLX"};
+constexpr size_t NUM_SYMBOLS = sizeof(SYMBOLS) / sizeof(SYMBOLS[0]);
+constexpr uint64_t PACE_NS = 20'000; // One tick every 20us
+
+int listen_ephemeral(uint16_t &port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(fd, 1) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+    close(fd);
+    return -1;
+  }
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+void serve_ticks(int listen_fd, size_t messages) {
+  int client = accept(listen_fd, nullptr, nullptr);
+  if (client < 0) return;
+
+  uint64_t next_send = now_ns();
+  for (size_t i = 0; i < messages; ++i) {
+    while (now_ns() < next_send) {
+    }
+    next_send += PACE_NS;
+
+    const char *sym = SYMBOLS[i % NUM_SYMBOLS];
+    float price = 100.0f + static_cast<float>(i % 50) * 0.01f;
+    std::string frame = serialize_tick(i + 1, now_ns(), sym, price,
+                                       static_cast<int32_t>(100 + i % 400));
+    if (send(client, frame.data(), frame.size(), 0) <= 0) break;
+  }
+  close(client);
+}
+
+// Runs in a forked child; prints one result row
+int run_trial(bool warmup, size_t messages, int warmup_ms) {
+  uint16_t port = 0;
+  int listen_fd = listen_ephemeral(port);
+  if (listen_fd < 0) {
+    perror("listen");
+    return 1;
+  }
+  std::thread server(serve_ticks, listen_fd, messages);
+
+  net::FeedConfig config;
+  config.port = port;
+  config.protocol = net::Protocol::BINARY;
+  config.warmup = warmup;
+  config.warmup_config.budget = std::chrono::milliseconds(warmup_ms);
+  config.warmup_config.symbols.assign(SYMBOLS, SYMBOLS + NUM_SYMBOLS);
+
+  // Same work as BookUpdatingFeedHandler, plus wire-to-book timing
+  std::unordered_map<std::string, OrderBook> books;
+  LatencyStats latency;
+  latency.reserve(messages);
+
+  net::FeedHandler handler(config);
+  handler.set_tick_callback([&](const net::Tick &tick) {
+    auto it = books.find(tick.symbol);
+    if (it == books.end()) {
+      it = books.emplace(tick.symbol, OrderBook()).first;
+    }
+    it->second.apply_update(0, static_cast<float>(tick.price), tick.volume);
+    latency.add(now_ns() - tick.timestamp);
+  });
+  handler.set_warmup_complete_callback([&]() {
+    books.clear();
+    latency.clear();
+  });
+
+  if (!handler.start()) {
+    std::cerr << "Failed to start handler" << std::endl;
+    return 1;
+  }
+  handler.wait();
+  server.join();
+  close(listen_fd);
+
+  const auto &data = latency.data();
+  if (data.empty()) {
+    std::cerr << "No messages received" << std::endl;
+    return 1;
+  }
+
+  auto mean_of = [&](size_t begin, size_t end) {
+    end = std::min(end, data.size());
+    if (begin >= end) return 0.0;
+    uint64_t sum = std::accumulate(data.begin() + begin, data.begin() + end, 0ULL);
+    return static_cast<double>(sum) / (end - begin) / 1000.0;
+  };
+
+  std::vector<uint64_t> first(data.begin(), data.begin() + std::min<size_t>(1000, data.size()));
+  std::sort(first.begin(), first.end());
+  double p99_first = first[first.size() * 99 / 100] / 1000.0;
+
+  printf("%-8s %10.2f %12.2f %13.2f %13.2f %12.2f %10s\n",
+         warmup ? "warm" : "cold", data.front() / 1000.0, mean_of(0, 100),
+         mean_of(0, 1000), p99_first, mean_of(data.size() / 2, data.size()),
+         warmup ? format_duration_ns(handler.warmup_report().duration_ns).c_str() : "-");
+  fflush(stdout);
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t messages = argc > 1 ? std::stoul(argv[1]) : 5000;
+  int trials = argc > 2 ? std::atoi(argv[2]) : 3;
+  int warmup_ms = argc > 3 ? std::atoi(argv[3]) : 250;
+
+  std::cout << "=== Warm-up Benchmark ===" << std::endl;
+  std::cout << "Messages per trial: " << messages << " (paced " << PACE_NS / 1000
+            << " us apart), trials: " << trials << ", warm-up budget: " << warmup_ms
+            << " ms" << std::endl;
+  std::cout << "Latency = tick send → order book updated (us)\n" << std::endl;
+  printf("%-8s %10s %12s %13s %13s %12s %10s\n", "mode", "first", "first100",
+         "first1000", "p99(1000)", "steady", "warm-up");
+  fflush(stdout); // Don't let forked children inherit buffered output
+
+  for (int t = 0; t < trials; ++t) {
+    for (bool warmup : {false, true}) {
+      pid_t pid = fork();
+      if (pid < 0) {
+        perror("fork");
+        return 1;
+      }
+      if (pid == 0) {
+        _exit(run_trial(warmup, messages, warmup_ms));
+      }
+      int status = 0;
+      waitpid(pid, &status, 0);
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "Trial failed" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  std::cout << "\nsteady = mean over the second half of the trial" << std::endl;
+  return 0;
+}
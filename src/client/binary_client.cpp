@@ -1,6 +1,7 @@
 #include <arpa/inet.h>
 #include <cerrno>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
@@ -32,17 +33,22 @@ struct Connection {
   int port;
   std::string buffer; // Accumulation buffer for partial messages
   uint64_t message_count;
+  bool quiet; // Count messages without printing them
 
-  Connection(int fd, int p) : sockfd(fd), port(p), message_count(0) {}
+  Connection(int fd, int p, bool q = false)
+      : sockfd(fd), port(p), message_count(0), quiet(q) {}
 };
 
 void process_message(const BinaryTick &tick, Connection &conn) {
+  conn.message_count++;
+  if (conn.quiet) {
+    return;
+  }
+
   std::string symbol = trim_symbol(tick.symbol, 4);
 
   std::cout << "[Exchange " << conn.port << "] [" << symbol << "] $"
             << tick.price << " @ " << tick.volume << std::endl;
-
-  conn.message_count++;
 }
 
 Result<int> connect_to_exchange(int port) {
@@ -119,7 +125,21 @@ bool drain_socket(Connection &conn) {
   return true; // Connection still alive
 }
 
-int main() {
+// Usage: ./binary_client [--quiet] [port ...]   (default ports: 9999 10000 10001)
+int main(int argc, char *argv[]) {
+  bool quiet = false;
+  std::vector<int> ports;
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--quiet") {
+      quiet = true;
+    } else {
+      ports.push_back(std::atoi(argv[i]));
+    }
+  }
+  if (ports.empty()) {
+    ports = {9999, 10000, 10001};
+  }
+
   // Create platform-specific event mechanism
 #ifdef USE_EPOLL
   int event_fd = epoll_create1(0);
@@ -137,8 +157,7 @@ int main() {
   LOG_INFO("Client", "Using kqueue (macOS/BSD)");
 #endif
 
-  // Connect to 3 exchanges
-  std::vector<int> ports = {9999, 10000, 10001};
+  // Connect to every exchange
   std::map<int, Connection> connections; // Map fd -> Connection
 
   for (int port : ports) {
@@ -171,7 +190,7 @@ int main() {
 #endif
 
     // Store connection
-    connections.emplace(sockfd, Connection(sockfd, port));
+    connections.emplace(sockfd, Connection(sockfd, port, quiet));
   }
 
   if (connections.empty()) {
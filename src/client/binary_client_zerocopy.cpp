@@ -26,6 +26,7 @@
 
 #include "binary_protocol.hpp"
 #include "common.hpp"
+#include "message_views.hpp"
 #include "ring_buffer.hpp"
 
 struct Connection {
@@ -41,11 +42,9 @@ struct Connection {
         buffer_shifts_avoided(0) {}
 };
 
-void process_message(const BinaryTick &tick, Connection &conn) {
-  std::string symbol = trim_symbol(tick.symbol, 4);
-
-  std::cout << "[Exchange " << conn.port << "] [" << symbol << "] $"
-            << tick.price << " @ " << tick.volume << std::endl;
+void process_message(const TickView &tick, Connection &conn) {
+  std::cout << "[Exchange " << conn.port << "] [" << tick.symbol() << "] $"
+            << tick.price() << " @ " << tick.volume() << std::endl;
 
   conn.message_count++;
 }
@@ -130,8 +129,7 @@ bool drain_socket(Connection &conn) {
       const char *payload = message_bytes + MessageHeader::HEADER_SIZE;
 
       if (header.type == MessageType::TICK) {
-        TickPayload tick = deserialize_tick_payload(payload);
-        process_message(tick, conn);
+        process_message(TickView(payload), conn);
       }
       // Ignore other message types (heartbeat, etc.)
 
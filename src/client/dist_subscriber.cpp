@@ -0,0 +1,79 @@
+/**
+ * Distribution Subscriber
+ *
+ * Connects to a feed handler's local distribution socket (feed_handler
+ * --distribute <path>), subscribes to a set of symbols and prints the ticks
+ * and book updates it receives. Runs until the feed handler goes away.
+ *
+ * Usage:
+ *   ./dist_subscriber <path> <SYMBOLS|*> [--quiet]
+ *   ./dist_subscriber /tmp/feed.dist AAPL,MSFT
+ */
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "distribution.hpp"
+#include "message_views.hpp"
+
+static std::vector<std::string> split_symbols(const std::string &list) {
+  std::vector<std::string> symbols;
+  std::stringstream ss(list);
+  std::string symbol;
+  while (std::getline(ss, symbol, ',')) {
+    if (!symbol.empty()) symbols.push_back(symbol);
+  }
+  return symbols;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <path> <SYMBOLS|*> [--quiet]" << std::endl;
+    return 1;
+  }
+  std::string path = argv[1];
+  std::string symbols = argv[2];
+  bool quiet = argc > 3 && strcmp(argv[3], "--quiet") == 0;
+
+  DistributionClient client(path);
+  auto connected = client.connect();
+  if (!connected) {
+    LOG_ERROR("Subscriber", "%s", connected.error().c_str());
+    return 1;
+  }
+
+  auto subscribed = symbols == "*" ? client.subscribe_all() : client.subscribe(split_symbols(symbols));
+  if (!subscribed) {
+    LOG_ERROR("Subscriber", "%s", subscribed.error().c_str());
+    return 1;
+  }
+  std::cout << "Subscribed to " << symbols << " on " << path << std::endl;
+
+  uint64_t ticks = 0, updates = 0;
+  while (client.poll(100, [&](const MessageHeader &header, const char *payload) {
+    if (header.type == MessageType::TICK) {
+      TickView tick(payload);
+      ticks++;
+      if (!quiet) {
+        std::cout << "#" << header.sequence << " [" << tick.symbol() << "] $" << tick.price()
+                  << " @ " << tick.volume() << std::endl;
+      }
+    } else if (header.type == MessageType::ORDER_BOOK_UPDATE) {
+      BookUpdateView update(payload);
+      updates++;
+      if (!quiet) {
+        std::cout << "#" << header.sequence << " [" << update.symbol() << "] "
+                  << (update.side() == 0 ? "BID" : "ASK") << " $" << update.price() << " x "
+                  << update.quantity() << std::endl;
+      }
+    }
+  })) {
+  }
+
+  std::cout << "Disconnected. Ticks: " << ticks << ", book updates: " << updates << std::endl;
+  return 0;
+}
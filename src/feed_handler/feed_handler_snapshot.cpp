@@ -1,19 +1,31 @@
+#include <algorithm>
 #include <arpa/inet.h>
+#include <array>
+#include <atomic>
 #include <cerrno>
+#include <csignal>
 #include <chrono>
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <sstream>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "binary_protocol.hpp"
+#include "book_checkpoint.hpp"
+#include "book_replication.hpp"
 #include "common.hpp"
 #include "connection_manager.hpp"
+#include "message_views.hpp"
 #include "order_book.hpp"
+#include "parallel_recovery.hpp"
 #include "ring_buffer.hpp"
 #include "sequence_tracker.hpp"
+#include "symbol_books.hpp"
 
 // Statistics
 struct FeedStatsV2 {
@@ -23,6 +35,13 @@ struct FeedStatsV2 {
   uint64_t incremental_updates = 0;
   uint64_t reconnections = 0;
   uint64_t gaps_detected = 0;
+  uint64_t checkpoints_written = 0;
+  uint64_t replication_records = 0;
+  uint64_t checksums_verified = 0;
+  uint64_t checksum_mismatches = 0;
+  uint64_t symbol_resyncs = 0;
+  uint64_t updates_buffered = 0;
+  uint64_t updates_replayed = 0;
 
   void print() const {
     std::cout << "\n=== Feed Handler Statistics ===" << std::endl;
@@ -32,34 +51,93 @@ struct FeedStatsV2 {
     std::cout << "Incremental updates:    " << incremental_updates << std::endl;
     std::cout << "Reconnections:          " << reconnections << std::endl;
     std::cout << "Sequence gaps:          " << gaps_detected << std::endl;
+    std::cout << "Checkpoints written:    " << checkpoints_written << std::endl;
+    std::cout << "Replication records:    " << replication_records << std::endl;
+    std::cout << "Checksums verified:     " << checksums_verified << std::endl;
+    std::cout << "Checksum mismatches:    " << checksum_mismatches << std::endl;
+    std::cout << "Symbol resyncs:         " << symbol_resyncs << std::endl;
+    std::cout << "Updates buffered:       " << updates_buffered << std::endl;
+    std::cout << "Buffered replayed:      " << updates_replayed << std::endl;
   }
 };
 
+// Full-universe recovery over the exchange's snapshot channel
+struct ParallelRecoveryConfig {
+  int snapshot_port = 0;       // 0 = off: snapshots come over the feed connection
+  size_t shards = 4;           // Book shard threads decoding and loading snapshots
+  size_t connections = 2;      // Snapshot channel connections
+};
+
 class SnapshotFeedHandler {
 public:
+  // A STALE book nothing has confirmed within this long gets a snapshot
+  static constexpr uint64_t STALE_TIMEOUT_NS = 2'000'000'000ULL;
+
   SnapshotFeedHandler(const std::string &host, int port,
-                      const std::string &symbol)
+                      const std::vector<std::string> &symbols,
+                      const std::string &checkpoint_path = "",
+                      int checkpoint_interval_ms = 1000,
+                      const std::string &replicate_path = "",
+                      const std::string &standby_path = "",
+                      const ParallelRecoveryConfig &recovery = {})
       : conn_manager_(host, port), should_stop_(false), stats_(),
-        symbol_(symbol), client_sequence_(0) {
-    // Pad symbol to 4 chars
-    while (symbol_.size() < 4)
-      symbol_.push_back('\0');
-    symbol_.resize(4);
+        client_sequence_(0),
+        checkpoint_path_(checkpoint_path),
+        checkpoint_interval_(checkpoint_interval_ms),
+        replicate_path_(replicate_path), standby_path_(standby_path),
+        host_(host), recovery_config_(recovery) {
+    // "ALL": every symbol the exchange publishes, books created as they appear
+    all_symbols_ = symbols.size() == 1 && symbols[0] == "ALL";
+    if (!all_symbols_) {
+      for (const auto &symbol : symbols) {
+        books_.add(symbol.substr(0, 4));
+      }
+    }
   }
 
   void run() {
     LOG_INFO("FeedHandler", "=== Snapshot Recovery Feed Handler ===");
-    LOG_INFO("FeedHandler", "Symbol: %s", symbol_.substr(0, 4).c_str());
+    std::string symbol_list = all_symbols_ ? "ALL" : "";
+    for (const auto &[symbol, entry] : books_.books()) {
+      symbol_list += symbol + " ";
+    }
+    LOG_INFO("FeedHandler", "Symbols: %s", symbol_list.c_str());
+    if (recovery_config_.snapshot_port > 0) {
+      LOG_INFO("FeedHandler", "Parallel recovery: snapshot channel port %d, %zu shard threads, %zu connections",
+               recovery_config_.snapshot_port, recovery_config_.shards,
+               recovery_config_.connections);
+    }
     LOG_INFO("FeedHandler", "State Machine: CONNECTING -> SNAPSHOT_REQUEST -> SNAPSHOT_REPLAY -> INCREMENTAL");
 
+    // Fault in the receive buffer now so the first snapshot doesn't pay for it
+    prefault_memory(buffer_.storage(), buffer_.storage_bytes());
+
+    if (!checkpoint_path_.empty()) {
+      restore_checkpoint();
+    }
+
+    // Hot standby: mirror the primary until it dies, then take over
+    if (!standby_path_.empty() && !run_standby()) {
+      return;
+    }
+
+    if (!replicate_path_.empty()) {
+      start_replication();
+    }
+
     // Initial connection
-    if (!conn_manager_.connect()) {
+    if (!keep_standby_alive([this] { return conn_manager_.connect(); })) {
       LOG_ERROR("FeedHandler", "Failed to connect to exchange");
       return;
     }
 
-    // Transition to snapshot request state
-    conn_manager_.transition_to_snapshot_request();
+    // Resume from the checkpoint / standby state, or request a snapshot
+    begin_session();
+
+    if (takeover_started_ns_ != 0) {
+      LOG_INFO("Standby", "Took over feed in %.2f ms (primary lost -> resume request sent)",
+               (now_ns() - takeover_started_ns_) / 1e6);
+    }
 
     // Main loop
     while (!should_stop_) {
@@ -69,10 +147,10 @@ public:
                  conn_manager_.seconds_since_last_message());
 
         // Attempt reconnection
-        if (conn_manager_.reconnect()) {
+        if (keep_standby_alive([this] { return conn_manager_.reconnect(); })) {
           stats_.reconnections++;
-          sequence_tracker_.reset();
-          conn_manager_.transition_to_snapshot_request(); // Need new snapshot
+          prepare_reconnect();
+          begin_session();
         } else {
           LOG_ERROR("FeedHandler", "Reconnection failed, retrying...");
           continue;
@@ -91,41 +169,456 @@ public:
 
         if (!should_stop_) {
           // Try to reconnect
-          if (conn_manager_.reconnect()) {
+          if (keep_standby_alive([this] { return conn_manager_.reconnect(); })) {
             stats_.reconnections++;
-            sequence_tracker_.reset();
-            conn_manager_.transition_to_snapshot_request(); // Need new snapshot
+            prepare_reconnect();
+            begin_session();
           }
         }
       }
+
+      service_recovery();
+      check_stale_books();
+      maybe_checkpoint();
+      service_replication();
+    }
+
+    // Final checkpoint on orderly shutdown
+    if (checkpoint_ && conn_manager_.is_incremental_mode()) {
+      write_checkpoint();
     }
 
     stats_.print();
 
-    // Print final order book
-    if (!order_book_.empty()) {
-      order_book_.print_depth(symbol_.substr(0, 4), 10);
+    // Print final order books
+    for (const auto &[symbol, entry] : books_.books()) {
+      LOG_INFO("FeedHandler", "%s: %s (%zu bid / %zu ask levels)", symbol.c_str(),
+               book_state_name(entry.state), entry.book.bid_depth(), entry.book.ask_depth());
+      if (!entry.book.empty()) {
+        entry.book.print_depth(symbol, 10);
+      }
     }
   }
 
   void stop() { should_stop_ = true; }
 
 private:
+  /**
+   * Standby mode: apply the primary's replicated book changes until it goes
+   * away, then adopt its books and sequence position so the feed connection
+   * resumes where the primary stopped. Symbols the primary had no book for,
+   * or was still recovering, are requested by snapshot after the resume.
+   * Returns false if stopped first.
+   */
+  bool run_standby() {
+    LOG_INFO("Standby", "Mirroring primary via %s", standby_path_.c_str());
+    ReplicationStandby standby(standby_path_);
+
+    // Wait for the primary to come up; after that poll() reconnects itself
+    // and returns false only once the primary is gone
+    while (!should_stop_ && !standby.connect()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    if (!should_stop_) {
+      LOG_INFO("Standby", "Connected to primary");
+    }
+    while (!should_stop_ && standby.poll(10)) {
+    }
+    if (should_stop_) {
+      return false;
+    }
+
+    takeover_started_ns_ = standby.primary_lost_at_ns();
+    LOG_INFO("Standby", "Taking over (records applied: %lu, checksums verified: %lu, mismatches: %lu)",
+             standby.records_applied(), standby.checksums_verified(),
+             standby.checksum_mismatches());
+
+    if (!standby.last_sequence()) {
+      LOG_WARN("Standby", "Nothing replicated yet, starting from snapshots");
+      return true;
+    }
+
+    size_t adopted = 0;
+    for (auto &[symbol, entry] : books_.books()) {
+      auto it = standby.books().find(symbol);
+      if (it == standby.books().end()) {
+        LOG_WARN("Standby", "No replicated book for %s, will request a snapshot", symbol.c_str());
+        continue;
+      }
+      if (it->second.recovering) {
+        // The primary had thrown this book away; it stays RECOVERING
+        LOG_WARN("Standby", "Primary was recovering %s, will request a snapshot", symbol.c_str());
+        books_.begin_recovery(entry, now_ns());
+        continue;
+      }
+      books_.adopt(symbol, it->second.book, it->second.last_sequence);
+      adopted++;
+      LOG_INFO("Standby", "Adopted %s book at seq=%lu (%zu bid / %zu ask levels)",
+               symbol.c_str(), *standby.last_sequence(), entry.book.bid_depth(),
+               entry.book.ask_depth());
+    }
+    if (adopted > 0) {
+      sequence_tracker_.resume_from(*standby.last_sequence());
+      resume_pending_ = true;
+    }
+    return true;
+  }
+
+  void start_replication() {
+    publisher_ = std::make_unique<ReplicationPublisher>(replicate_path_);
+    auto result = publisher_->listen();
+    if (!result) {
+      LOG_WARN("Replication", "%s (continuing without a standby)", result.error().c_str());
+      publisher_.reset();
+      return;
+    }
+    LOG_INFO("Replication", "Publishing book changes on %s", replicate_path_.c_str());
+  }
+
+  /**
+   * Runs a blocking connect/reconnect (backoff sleeps of up to a minute)
+   * while a helper thread keeps servicing replication, so the standby keeps
+   * getting heartbeats and doesn't mistake the stall for a dead primary.
+   * The main thread touches neither the books nor the publisher meanwhile.
+   */
+  template <typename Connect>
+  bool keep_standby_alive(Connect &&blocking_connect) {
+    if (!publisher_) {
+      return blocking_connect();
+    }
+    std::atomic<bool> done{false};
+    std::thread heartbeat([this, &done]() {
+      while (!done.load(std::memory_order_acquire)) {
+        service_replication();
+        std::this_thread::sleep_for(ReplicationPublisher::HEARTBEAT_INTERVAL / 2);
+      }
+    });
+    bool connected = blocking_connect();
+    done.store(true, std::memory_order_release);
+    heartbeat.join();
+    return connected;
+  }
+
+  void service_replication() {
+    if (!publisher_) {
+      return;
+    }
+    if (publisher_->poll() && sequence_tracker_.has_received_message()) {
+      // New standby: full copy of every usable book, then our sequence position
+      for (const auto &[symbol, entry] : books_.books()) {
+        if (entry.state != BookState::RECOVERING) {
+          publisher_->publish_book(symbol, entry.book, entry.last_sequence);
+        }
+      }
+      publisher_->publish_sequence(*sequence_tracker_.last_sequence());
+      publisher_->flush();
+    }
+    stats_.replication_records = publisher_->records_published();
+  }
+
+  // Book state and sequence position from the last checkpoint, if usable
+  void restore_checkpoint() {
+    uint64_t start = now_ns();
+
+    auto opened = BookCheckpoint::open(checkpoint_path_);
+    if (!opened) {
+      LOG_WARN("Checkpoint", "%s (continuing without checkpoints)", opened.error().c_str());
+      return;
+    }
+    checkpoint_ = std::move(opened.value());
+
+    auto view = checkpoint_->load();
+    if (!view) {
+      LOG_INFO("Checkpoint", "No valid checkpoint in %s, starting from snapshot",
+               checkpoint_path_.c_str());
+      return;
+    }
+
+    // Books missing or truncated in the checkpoint get a snapshot after the
+    // resume; the rest pick up where they left off
+    size_t restored = 0;
+    for (auto &[symbol, entry] : books_.books()) {
+      size_t idx = view->find(symbol);
+      if (idx == view->size()) {
+        LOG_INFO("Checkpoint", "Checkpoint has no book for %s, will request a snapshot",
+                 symbol.c_str());
+        continue;
+      }
+      if (view->book(idx).flags & CheckpointBook::FLAG_TRUNCATED) {
+        LOG_WARN("Checkpoint", "Checkpointed %s book was truncated, will request a snapshot",
+                 symbol.c_str());
+        continue;
+      }
+
+      OrderBook book;
+      view->restore(idx, book);
+      books_.adopt(symbol, book, view->book(idx).last_sequence);
+      restored++;
+      LOG_INFO("Checkpoint", "Restored %s from checkpoint (seq=%lu, generation %lu, %zu bid / %zu ask levels)",
+               symbol.c_str(), view->sequence(), view->generation(),
+               entry.book.bid_depth(), entry.book.ask_depth());
+    }
+    if (restored == 0) {
+      return;
+    }
+
+    sequence_tracker_.resume_from(view->sequence());
+    resume_pending_ = true;
+    LOG_INFO("Checkpoint", "Restored %zu of %zu books in %.1f us", restored, books_.size(),
+             (now_ns() - start) / 1000.0);
+  }
+
+  // Choose how a fresh connection rebuilds state. When resuming, books we
+  // couldn't restore (or that were mid-recovery) are requested individually.
+  void begin_session() {
+    if (resume_pending_) {
+      send_resume_request();
+      for (auto &[symbol, entry] : books_.books()) {
+        if (entry.state == BookState::RECOVERING) {
+          request_snapshot(symbol, entry);
+        }
+      }
+    } else {
+      conn_manager_.transition_to_snapshot_request();
+    }
+  }
+
+  // With checkpoints enabled, a reconnect resumes from what we've applied;
+  // otherwise every book starts over from a snapshot
+  void prepare_reconnect() {
+    recovery_.reset();  // Snapshots in flight belong to the old session
+    resume_pending_ = checkpoint_ && sequence_tracker_.has_received_message() &&
+                      books_.count(BookState::RECOVERING) < books_.size();
+    if (!resume_pending_) {
+      sequence_tracker_.reset();
+      for (auto &[symbol, entry] : books_.books()) {
+        begin_recovery(symbol, entry);
+      }
+    }
+  }
+
+  void send_resume_request() {
+    uint64_t from = sequence_tracker_.last_sequence().value_or(0);
+    LOG_INFO("FeedHandler", "Resuming from sequence %lu (skipping snapshot)", from);
+
+    // Name a restored book, so a refusal's fallback snapshot is told apart
+    // from snapshots requested for books still recovering
+    auto restored = std::find_if(books_.books().begin(), books_.books().end(),
+                                 [](const auto &b) { return b.second.state != BookState::RECOVERING; });
+    std::string request = serialize_resume_request(
+        client_sequence_++, wire_symbol(restored->first).data(), from);
+    if (send(conn_manager_.sockfd(), request.data(), request.length(), 0) < 0) {
+      LOG_PERROR("FeedHandler", "Failed to send resume request");
+      return;
+    }
+
+    conn_manager_.transition_to_resume();
+  }
+
+  void maybe_checkpoint() {
+    if (!checkpoint_ || !conn_manager_.is_incremental_mode()) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_checkpoint_ >= checkpoint_interval_) {
+      write_checkpoint();
+      last_checkpoint_ = now;
+    }
+  }
+
+  void write_checkpoint() {
+    if (!sequence_tracker_.has_received_message()) {
+      return;
+    }
+    checkpoint_->begin();
+    for (const auto &[symbol, entry] : books_.books()) {
+      if (entry.state != BookState::RECOVERING) {
+        checkpoint_->add_book(symbol, entry.book, entry.last_sequence);
+      }
+    }
+    auto result = checkpoint_->commit(*sequence_tracker_.last_sequence());
+    if (!result) {
+      LOG_WARN("Checkpoint", "%s", result.error().c_str());
+      return;
+    }
+    stats_.checkpoints_written++;
+  }
+
+  // Fresh connection: every book needs a snapshot
   void send_snapshot_request() {
-    LOG_INFO("FeedHandler", "Sending snapshot request for symbol: %s", symbol_.substr(0, 4).c_str());
+    if (recovery_config_.snapshot_port > 0) {
+      start_parallel_recovery();
+      conn_manager_.mark_snapshot_requested();
+      return;
+    }
+
+    if (all_symbols_) {
+      LOG_INFO("FeedHandler", "Sending snapshot request for symbol: ALL");
+      std::string request = serialize_snapshot_request(client_sequence_++, "ALL");
+      if (send(conn_manager_.sockfd(), request.data(), request.length(), 0) < 0) {
+        LOG_PERROR("FeedHandler", "Failed to send snapshot request");
+        return;
+      }
+    }
+
+    for (auto &[symbol, entry] : books_.books()) {
+      LOG_INFO("FeedHandler", "Sending snapshot request for symbol: %s", symbol.c_str());
+      if (!request_snapshot(symbol, entry)) {
+        return;
+      }
+    }
+
+    conn_manager_.mark_snapshot_requested();
+    LOG_INFO("FeedHandler", "Waiting for snapshot response...");
+  }
 
+  // Ask for one symbol's snapshot; its updates are buffered until it arrives
+  bool request_snapshot(const std::string &symbol, SymbolBook &entry) {
     std::string request =
-        serialize_snapshot_request(client_sequence_++, symbol_.data());
+        serialize_snapshot_request(client_sequence_++, wire_symbol(symbol).data());
 
     ssize_t bytes_sent =
         send(conn_manager_.sockfd(), request.data(), request.length(), 0);
     if (bytes_sent < 0) {
       LOG_PERROR("FeedHandler", "Failed to send snapshot request");
+      return false;
+    }
+
+    begin_recovery(symbol, entry);
+    return true;
+  }
+
+  // The book stops being served until its snapshot is in. A standby is
+  // told as well, so a takeover meanwhile doesn't adopt the old copy.
+  void begin_recovery(const std::string &symbol, SymbolBook &entry) {
+    if (publisher_ && entry.state != BookState::RECOVERING) {
+      publisher_->publish_invalidate(symbol, entry.last_sequence);
+    }
+    books_.begin_recovery(entry, now_ns());
+  }
+
+  /**
+   * Rebuild every book from the snapshot channel: several connections, each
+   * carrying one partition of the universe, decoded and loaded by book shard
+   * threads. Live updates keep arriving here and buffer per book until its
+   * snapshot is installed (service_recovery).
+   */
+  void start_parallel_recovery() {
+    for (auto &[symbol, entry] : books_.books()) {
+      begin_recovery(symbol, entry);
+    }
+    recovery_replayed_ = 0;
+    recovery_ = std::make_unique<ParallelSnapshotRecovery>(recovery_config_.shards,
+                                                           recovery_config_.connections);
+    auto started = recovery_->start(host_, recovery_config_.snapshot_port);
+    if (!started) {
+      LOG_WARN("Recovery", "%s, requesting snapshots over the feed connection instead",
+               started.error().c_str());
+      recovery_.reset();
+      recovery_config_.snapshot_port = 0;
+      send_snapshot_request();
       return;
     }
+    LOG_INFO("Recovery", "Requested all books over %zu snapshot connections (%zu shard threads)",
+             recovery_->connection_count(), recovery_->shard_count());
+  }
 
-    conn_manager_.mark_snapshot_requested();
-    LOG_INFO("FeedHandler", "Waiting for snapshot response...");
+  // Install books as the shard threads finish them. Once every snapshot
+  // connection is done, books still RECOVERING (failed, or not on the
+  // channel) get a snapshot of their own.
+  void service_recovery() {
+    if (!recovery_) {
+      return;
+    }
+    bool finished = recovery_->finished();
+    for (auto &recovered : recovery_->take_completed()) {
+      install_recovered(recovered);
+    }
+    for (const auto &symbol : recovery_->take_failed()) {
+      LOG_WARN("Recovery", "Snapshot for %s failed (chunk lost or checksum mismatch)", symbol.c_str());
+    }
+    if (!finished) {
+      return;
+    }
+
+    recovery_->join();
+    LOG_INFO("Recovery", "Recovered %zu books (%zu levels, %.1f MB) in %.2f ms with %zu shard threads over %zu snapshot connections",
+             recovery_->books_recovered(), recovery_->levels_recovered(),
+             recovery_->bytes_received() / 1e6, recovery_->elapsed_ns() / 1e6,
+             recovery_->shard_count(), recovery_->connection_count());
+    for (size_t shard = 0; shard < recovery_->shard_count(); ++shard) {
+      LOG_INFO("Recovery", "  Shard %zu: %zu books", shard, recovery_->books_on_shard(shard));
+    }
+    LOG_INFO("Recovery", "  %zu buffered updates replayed", recovery_replayed_);
+    recovery_.reset();
+
+    size_t missing = books_.count(BookState::RECOVERING);
+    if (missing > 0) {
+      LOG_WARN("Recovery", "%zu books not recovered, requesting snapshots individually", missing);
+      for (auto &[symbol, entry] : books_.books()) {
+        if (entry.state == BookState::RECOVERING) {
+          request_snapshot(symbol, entry);
+        }
+      }
+    }
+  }
+
+  void install_recovered(RecoveredBook &recovered) {
+    SymbolBook *entry = book_for(recovered.symbol);
+    if (!entry) {
+      return;  // Not subscribed
+    }
+    size_t replayed = 0;
+    if (!books_.install_snapshot(*entry, std::move(recovered.book), recovered.sequence, &replayed)) {
+      return;  // Older than dropped buffered updates; requested again at the end
+    }
+    stats_.snapshots_received++;
+    stats_.updates_replayed += replayed;
+    recovery_replayed_ += replayed;
+    if (publisher_) {
+      publisher_->publish_book(recovered.symbol, entry->book, entry->last_sequence);
+    }
+
+    // First book in: go live, the rest keep buffering until theirs arrive
+    if (!conn_manager_.is_incremental_mode()) {
+      conn_manager_.transition_to_snapshot_replay();
+      conn_manager_.transition_to_incremental();
+    }
+  }
+
+  // A subscribed book, or with "ALL" any symbol (new ones start RECOVERING)
+  SymbolBook *book_for(const std::string &symbol) {
+    SymbolBook *entry = books_.find(symbol);
+    if (!entry && all_symbols_) {
+      entry = &books_.add(symbol);
+    }
+    return entry;
+  }
+
+  // Targeted recovery of one book over the live connection; every other
+  // symbol keeps updating and sequence tracking carries on
+  void resync_symbol(const std::string &symbol, SymbolBook &entry, const char *reason) {
+    LOG_INFO("FeedHandler", "Requesting %s snapshot to resync book (%s)", symbol.c_str(), reason);
+    if (request_snapshot(symbol, entry)) {
+      stats_.symbol_resyncs++;
+    }
+  }
+
+  // A gap can't be pinned on one symbol, so it marks every book STALE; a
+  // matching checksum clears that, otherwise the book is resynced
+  void check_stale_books() {
+    if (!conn_manager_.is_incremental_mode()) {
+      return;
+    }
+    for (const auto &symbol : books_.stale_longer_than(now_ns(), STALE_TIMEOUT_NS)) {
+      resync_symbol(symbol, *books_.find(symbol), "stale, no checksum to confirm it");
+    }
+  }
+
+  static std::array<char, 4> wire_symbol(const std::string &symbol) {
+    std::array<char, 4> padded{};
+    memcpy(padded.data(), symbol.data(), std::min<size_t>(symbol.size(), 4));
+    return padded;
   }
 
   bool read_and_process() {
@@ -191,12 +684,13 @@ private:
       // Update heartbeat timer (we received a message)
       conn_manager_.update_last_message_time();
 
-      // Check sequence number (only for non-snapshot messages)
-      if (header.type != MessageType::SNAPSHOT_RESPONSE) {
-        bool sequence_ok = sequence_tracker_.process_sequence(header.sequence);
-        if (!sequence_ok) {
-          stats_.gaps_detected++;
-        }
+      // Check sequence number. Snapshots are sequenced too, but one that
+      // starts while resuming may be the server refusing the resume, so
+      // start_snapshot decides.
+      bool starts_snapshot = header.type == MessageType::SNAPSHOT_RESPONSE ||
+                             header.type == MessageType::SNAPSHOT_BEGIN;
+      if (!starts_snapshot || !resume_pending_) {
+        track_sequence(header.sequence);
       }
 
       // Process based on type
@@ -205,32 +699,61 @@ private:
       switch (header.type) {
       case MessageType::TICK:
         process_tick(header, payload);
+        if (publisher_) publisher_->publish_sequence(header.sequence);
         break;
       case MessageType::HEARTBEAT:
         process_heartbeat(header, payload);
+        if (publisher_) publisher_->publish_sequence(header.sequence);
         break;
       case MessageType::SNAPSHOT_RESPONSE:
         process_snapshot_response(header, payload);
         break;
+      case MessageType::SNAPSHOT_BEGIN:
+        process_snapshot_begin(header, payload);
+        break;
+      case MessageType::SNAPSHOT_CHUNK:
+        process_snapshot_chunk(header, payload);
+        break;
+      case MessageType::SNAPSHOT_END:
+        process_snapshot_end(header, payload);
+        break;
       case MessageType::ORDER_BOOK_UPDATE:
         process_order_book_update(header, payload);
         break;
+      case MessageType::BOOK_CHECKSUM:
+        process_book_checksum(header, payload);
+        if (publisher_) publisher_->publish_sequence(header.sequence);
+        break;
       default:
         LOG_ERROR("FeedHandler", "Unknown message type: %d", static_cast<int>(header.type));
       }
     }
   }
 
-  void process_tick(const MessageHeader &header, const char *payload) {
-    TickPayload tick = deserialize_tick_payload(payload);
+  void track_sequence(uint64_t sequence) {
+    bool sequence_ok = sequence_tracker_.process_sequence(sequence);
+    if (!sequence_ok) {
+      stats_.gaps_detected++;
+      size_t marked = books_.mark_all_stale(now_ns());
+      if (marked > 0) {
+        LOG_WARN("FeedHandler", "Sequence gap at seq=%lu: %zu books marked STALE",
+                 sequence, marked);
+      }
+    } else if (resume_pending_) {
+      resume_pending_ = false;
+      LOG_INFO("FeedHandler", "Resumed incrementally at seq=%lu", sequence);
+    }
+  }
 
+  void process_tick(const MessageHeader &header, const char *payload) {
     stats_.ticks_received++;
 
-    // Print periodically
+    // Print periodically; other ticks are counted without being decoded
     if (stats_.ticks_received % 10000 == 0) {
-      std::string symbol = trim_symbol(tick.symbol, 4);
+      TickView tick(payload);
+      std::string symbol(tick.symbol());
 
-      LOG_INFO("Tick", "seq=%lu [%s] $%.2f @ %d", header.sequence, symbol.c_str(), tick.price, tick.volume);
+      LOG_INFO("Tick", "seq=%lu [%s] $%.2f @ %d", header.sequence, symbol.c_str(), tick.price(), tick.volume());
     }
   }
 
@@ -258,77 +781,326 @@ private:
     LOG_INFO("Snapshot", "  Bid levels: %zu", bids.size());
     LOG_INFO("Snapshot", "  Ask levels: %zu", asks.size());
 
-    // Load snapshot into order book
-    order_book_.load_snapshot(bids, asks);
+    SymbolBook *entry = start_snapshot(header, symbol_str);
+    if (!entry) {
+      return;
+    }
+    for (const auto &level : bids) books_.add_snapshot_level(*entry, 0, level.price, level.quantity);
+    for (const auto &level : asks) books_.add_snapshot_level(*entry, 1, level.price, level.quantity);
+    complete_snapshot(header, symbol_str, *entry);
+  }
+
+  // Chunked snapshot: levels go straight from each chunk into the book
+  void process_snapshot_begin(const MessageHeader &header, const char *payload) {
+    SnapshotBeginPayload begin = deserialize_snapshot_begin(payload);
+    std::string symbol_str = trim_symbol(begin.symbol, 4);
+
+    SymbolBook *entry = start_snapshot(header, symbol_str);
+    if (entry) {
+      entry->snapshot.id = begin.snapshot_id;
+    }
+  }
+
+  void process_snapshot_chunk(const MessageHeader &header, const char *payload) {
+    SnapshotChunkPayload chunk;
+    bool valid = decode_snapshot_chunk(payload, header.length, chunk);
+    if (header.length < SnapshotChunkPayload::HEADER_SIZE) {
+      // Can't tell whose chunk it was; SNAPSHOT_END will find it missing
+      LOG_WARN("FeedHandler", "Dropping truncated snapshot chunk seq=%lu", header.sequence);
+      return;
+    }
+    std::string symbol_str = trim_symbol(chunk.symbol, 4);
+    SymbolBook *entry = books_.find(symbol_str);
+    if (!entry || !entry->snapshot.active) {
+      return;
+    }
+    if (!valid) {
+      retry_snapshot(symbol_str, *entry, "malformed chunk");
+      return;
+    }
+    if (chunk.snapshot_id != entry->snapshot.id ||
+        chunk.chunk_index != entry->snapshot.next_chunk) {
+      retry_snapshot(symbol_str, *entry, "chunk missing or out of order");
+      return;
+    }
+
+    for (uint16_t i = 0; i < chunk.num_levels; ++i) {
+      OrderBookLevel level = deserialize_snapshot_level(payload, i);
+      books_.add_snapshot_level(*entry, chunk.side, level.price, level.quantity);
+    }
+    if (entry->snapshot.next_chunk++ == 0) {
+      entry->snapshot.first_level_ns = now_ns();
+    }
+  }
+
+  void process_snapshot_end(const MessageHeader &header, const char *payload) {
+    SnapshotEndPayload end = deserialize_snapshot_end(payload);
+    std::string symbol_str = trim_symbol(end.symbol, 4);
+    SymbolBook *entry = books_.find(symbol_str);
+    if (!entry || !entry->snapshot.active) {
+      return;
+    }
+    if (end.snapshot_id != entry->snapshot.id || end.num_chunks != entry->snapshot.next_chunk) {
+      retry_snapshot(symbol_str, *entry, "chunk missing");
+      return;
+    }
+    if (entry->book.checksum() != end.checksum) {
+      retry_snapshot(symbol_str, *entry, "checksum mismatch");
+      return;
+    }
+
+    stats_.snapshots_received++;
+    const auto &progress = entry->snapshot;
+    LOG_INFO("Snapshot", "seq=%lu Received snapshot for %s", progress.sequence, symbol_str.c_str());
+    LOG_INFO("Snapshot", "  Bid levels: %zu", entry->book.bid_depth());
+    LOG_INFO("Snapshot", "  Ask levels: %zu", entry->book.ask_depth());
+    LOG_INFO("Snapshot", "  Streamed in %u chunks: first level after %.1f us, complete after %.2f ms",
+             end.num_chunks,
+             progress.first_level_ns ? (progress.first_level_ns - progress.started_ns) / 1000.0 : 0.0,
+             (now_ns() - progress.started_ns) / 1e6);
+
+    complete_snapshot(header, symbol_str, *entry);
+  }
+
+  void retry_snapshot(const std::string &symbol, SymbolBook &entry, const char *reason) {
+    LOG_WARN("FeedHandler", "Discarding %s snapshot (%s), requesting again", symbol.c_str(), reason);
+    books_.abort_snapshot(entry);
+    request_snapshot(symbol, entry);
+  }
+
+  // Common start of a snapshot (SNAPSHOT_RESPONSE or SNAPSHOT_BEGIN). The
+  // book is cleared; updates for it buffer until complete_snapshot.
+  SymbolBook *start_snapshot(const MessageHeader &header, const std::string &symbol_str) {
+    SymbolBook *entry = book_for(symbol_str);
+    if (!entry) {
+      LOG_WARN("FeedHandler", "Ignoring snapshot for unsubscribed symbol %s", symbol_str.c_str());
+      return nullptr;
+    }
+    bool was_recovering = entry->state == BookState::RECOVERING;
+
+    // While resuming, a snapshot we asked for is just the next message; one
+    // for a book we restored means the server couldn't replay from our
+    // position. The snapshot is then the new baseline for sequence tracking,
+    // and every other restored book has to be rebuilt from its own snapshot.
+    if (resume_pending_ && was_recovering) {
+      track_sequence(header.sequence);
+    } else if (resume_pending_) {
+      LOG_WARN("FeedHandler", "Resume refused, recovered from snapshot instead");
+      sequence_tracker_.resume_from(header.sequence);
+      resume_pending_ = false;
+      for (auto &[other, other_entry] : books_.books()) {
+        if (other != symbol_str && other_entry.state != BookState::RECOVERING) {
+          request_snapshot(other, other_entry);
+        }
+      }
+    }
+
+    books_.begin_snapshot(*entry, header.sequence, now_ns());
+    return entry;
+  }
+
+  void complete_snapshot(const MessageHeader &header, const std::string &symbol_str,
+                         SymbolBook &entry) {
+    bool resync = entry.snapshot.replaces_book;
+    uint64_t started_ns = entry.recovery_started_ns;
+
+    // Replay what was buffered while the snapshot was outstanding
+    size_t replayed = 0;
+    if (!books_.finish_snapshot(entry, &replayed)) {
+      LOG_WARN("FeedHandler", "Snapshot for %s predates dropped buffered updates, requesting again",
+               symbol_str.c_str());
+      request_snapshot(symbol_str, entry);
+      return;
+    }
+    stats_.updates_replayed += replayed;
+    if (publisher_) {
+      publisher_->publish_book(symbol_str, entry.book, entry.last_sequence);
+    }
+
+    if (conn_manager_.is_incremental_mode()) {
+      if (resync) {
+        LOG_INFO("FeedHandler", "Resynced %s from snapshot at seq=%lu in %.2f ms (%zu bid / %zu ask levels, %zu buffered updates replayed)",
+                 symbol_str.c_str(), header.sequence, (now_ns() - started_ns) / 1e6,
+                 entry.book.bid_depth(), entry.book.ask_depth(), replayed);
+      }
+      return;
+    }
 
     // Print the snapshot
-    order_book_.print_depth(symbol_str, 5);
+    entry.book.print_depth(symbol_str, 5);
 
-    // Transition to snapshot replay
+    // First snapshot on this connection: go live. Books whose snapshots are
+    // still in flight keep buffering.
     conn_manager_.transition_to_snapshot_replay();
-
-    // Immediately transition to incremental (snapshot is complete)
     conn_manager_.transition_to_incremental();
   }
 
   void process_order_book_update(const MessageHeader &header,
                                  const char *payload) {
-    // Only process incremental updates if we're in INCREMENTAL mode
-    if (!conn_manager_.is_incremental_mode()) {
-      // Buffer updates during snapshot replay (in production, you'd queue
-      // these)
-      LOG_WARN("FeedHandler", "Ignoring incremental update (not in INCREMENTAL mode yet)");
+    BookUpdateView update(payload);
+
+    // Apply to the symbol's book, or hold it while the book is recovering.
+    // A standby mirroring a recovering book is corrected by the next
+    // checksum after it takes over. Updates for symbols we don't follow are
+    // dropped on the symbol bytes alone.
+    if (all_symbols_) {
+      book_for(std::string(update.symbol()));
+    }
+    auto result = books_.apply_update(header.sequence, update);
+    if (result != SymbolBooks::UpdateResult::APPLIED) {
+      if (result == SymbolBooks::UpdateResult::BUFFERED) {
+        stats_.updates_buffered++;
+      }
+      if (publisher_) publisher_->publish_sequence(header.sequence);
       return;
     }
 
-    OrderBookUpdatePayload update = deserialize_order_book_update(payload);
-
     stats_.incremental_updates++;
 
-    std::string symbol_str = trim_symbol(update.symbol, 4);
-
-    // Apply update to order book
-    order_book_.apply_update(update.side, update.price, update.quantity);
+    std::string symbol_str(update.symbol());
+    const OrderBook &book = books_.find(symbol_str)->book;
+    if (publisher_ && update.quantity() >= 0) {
+      publisher_->publish_update(symbol_str, book, update.side(), update.price(),
+                                 update.quantity(), header.sequence);
+    }
 
     // Print update and current top of book
-    const char *side_str = (update.side == 0) ? "BID" : "ASK";
-    const char *action_str = (update.quantity == 0)  ? "DELETE"
-                             : (update.quantity > 0) ? "UPDATE"
-                                                     : "INVALID";
-
     if (stats_.incremental_updates % 100 == 0) {
+      const char *side_str = (update.side() == 0) ? "BID" : "ASK";
+      const char *action_str = (update.quantity() == 0)  ? "DELETE"
+                               : (update.quantity() > 0) ? "UPDATE"
+                                                         : "INVALID";
+
       std::cout << "[Update seq=" << header.sequence << "] [" << symbol_str
-                << "] " << side_str << " " << action_str << " $" << update.price
-                << " @ " << update.quantity << std::endl;
+                << "] " << side_str << " " << action_str << " $" << update.price()
+                << " @ " << update.quantity() << std::endl;
 
       // Print current top of book
-      order_book_.print_top_of_book(symbol_str);
+      book.print_top_of_book(symbol_str);
     }
   }
 
+  // Compare a book against the publisher's; a mismatch resyncs just that
+  // symbol, a match confirms a STALE book
+  void process_book_checksum(const MessageHeader &header, const char *payload) {
+    BookChecksumPayload msg = deserialize_book_checksum(payload);
+    std::string symbol_str = trim_symbol(msg.symbol, 4);
+    SymbolBook *entry = books_.find(symbol_str);
+    if (!entry || entry->state == BookState::RECOVERING) {
+      return;
+    }
+
+    bool was_stale = entry->state == BookState::STALE;
+    if (books_.verify_checksum(*entry, msg.checksum)) {
+      stats_.checksums_verified++;
+      if (was_stale) {
+        LOG_INFO("FeedHandler", "Checksum confirmed STALE %s book at seq=%lu",
+                 symbol_str.c_str(), header.sequence);
+      }
+      return;
+    }
+
+    stats_.checksum_mismatches++;
+    LOG_WARN("FeedHandler", "Checksum mismatch for %s at seq=%lu (ours %016lx, exchange %016lx)",
+             symbol_str.c_str(), header.sequence, entry->book.checksum(), msg.checksum);
+    resync_symbol(symbol_str, *entry, "checksum mismatch");
+  }
+
   ConnectionManagerV2 conn_manager_;
   SequenceTracker sequence_tracker_;
   RingBuffer buffer_;
-  OrderBook order_book_;
+  SymbolBooks books_;
   std::atomic<bool> should_stop_;
   FeedStatsV2 stats_;
-  std::string symbol_;
   uint64_t client_sequence_;
+
+  // Checkpoint / resume
+  std::string checkpoint_path_;
+  std::chrono::milliseconds checkpoint_interval_;
+  std::unique_ptr<BookCheckpoint> checkpoint_;
+  std::chrono::steady_clock::time_point last_checkpoint_;
+  bool resume_pending_ = false;
+
+  // Hot-standby replication
+  std::string replicate_path_;
+  std::string standby_path_;
+  std::unique_ptr<ReplicationPublisher> publisher_;
+  uint64_t takeover_started_ns_ = 0;
+
+  // Parallel full-universe recovery
+  std::string host_;
+  ParallelRecoveryConfig recovery_config_;
+  std::unique_ptr<ParallelSnapshotRecovery> recovery_;
+  size_t recovery_replayed_ = 0;
+  bool all_symbols_ = false;
 };
 
 int main(int argc, char *argv[]) {
   std::string host = "127.0.0.1";
   int port = 9999;
-  std::string symbol = "AAPL";
+  std::vector<std::string> symbols = {"AAPL"};
+
+  // Flags may appear anywhere; the rest are positional
+  //   --replicate <socket>  stream book changes to a hot standby
+  //   --standby <socket>    mirror a primary, take over when it dies
+  //   --recover-all <port>  rebuild books from the snapshot channel on <port>
+  //   --shards <n>          book shard threads for --recover-all (default 4)
+  //   --snapshot-connections <n>  snapshot channel connections (default 2)
+  std::string replicate_path;
+  std::string standby_path;
+  ParallelRecoveryConfig recovery;
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--replicate" && i + 1 < argc) {
+      replicate_path = argv[++i];
+    } else if (arg == "--standby" && i + 1 < argc) {
+      standby_path = argv[++i];
+    } else if (arg == "--recover-all" && i + 1 < argc) {
+      recovery.snapshot_port = std::atoi(argv[++i]);
+    } else if (arg == "--shards" && i + 1 < argc) {
+      recovery.shards = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--snapshot-connections" && i + 1 < argc) {
+      recovery.connections = std::max(1, std::atoi(argv[++i]));
+    } else {
+      args.push_back(arg);
+    }
+  }
 
-  if (argc > 1) {
-    port = std::atoi(argv[1]);
+  if (args.size() > 0) {
+    port = std::atoi(args[0].c_str());
   }
-  if (argc > 2) {
-    symbol = argv[2];
+  // Comma-separated list, e.g. AAPL,MSFT,GOOG, or ALL
+  if (args.size() > 1) {
+    symbols.clear();
+    std::stringstream list(args[1]);
+    std::string symbol;
+    while (std::getline(list, symbol, ',')) {
+      if (!symbol.empty()) {
+        symbols.push_back(symbol);
+      }
+    }
+    if (symbols.empty()) {
+      LOG_ERROR("FeedHandler", "No symbols given");
+      return 1;
+    }
   }
 
-  SnapshotFeedHandler handler(host, port, symbol);
+  // Optional: checkpoint file for fast restart, and how often to write it
+  std::string checkpoint_path;
+  int checkpoint_interval_ms = 1000;
+  if (args.size() > 2) {
+    checkpoint_path = args[2];
+  }
+  if (args.size() > 3) {
+    checkpoint_interval_ms = std::max(1, std::atoi(args[3].c_str()));
+  }
+
+  // A standby going away must not kill the primary
+  signal(SIGPIPE, SIG_IGN);
+
+  SnapshotFeedHandler handler(host, port, symbols, checkpoint_path,
+                              checkpoint_interval_ms, replicate_path, standby_path, recovery);
 
   // Run for a while then stop (or wait for Ctrl+C)
   std::thread handler_thread([&]() { handler.run(); });
@@ -1,5 +1,6 @@
 #include <iostream>
 
+#include "bar_aggregator.hpp"
 #include "cli_parser.hpp"
 #include "net/feed.hpp"
 
@@ -27,29 +28,95 @@ int main(int argc, char* argv[]) {
     return 0;
   }
 
-  if (!cli_config.is_valid()) {
-    LOG_ERROR("Main", "--port is required");
-    CLIParser::print_usage(argv[0]);
-    return 1;
-  }
-
-  if (cli_config.verbose) {
-    CLIParser::print_config(cli_config);
-  }
-
   // Convert CLI config to net::FeedConfig
   net::FeedConfig feed_config;
   feed_config.host = cli_config.host;
   feed_config.port = cli_config.port;
+  feed_config.transport = parse_transport(cli_config.transport).value_or(Transport::TCP);
+  feed_config.transport_path = cli_config.path;
   feed_config.protocol = (cli_config.protocol == Protocol::TEXT)
                           ? net::Protocol::TEXT
                           : net::Protocol::BINARY;
   feed_config.queue_size = cli_config.queue_size;
   feed_config.verbose = cli_config.verbose;
+  feed_config.watchdog = cli_config.watchdog;
+  feed_config.watchdog_config.stall_threshold =
+      std::chrono::milliseconds(std::max(cli_config.stall_ms, 1));
+  feed_config.watchdog_config.dump_prefix = cli_config.watchdog_dump;
+  feed_config.warmup = cli_config.warmup;
+  feed_config.warmup_config.budget =
+      std::chrono::milliseconds(std::max(cli_config.warmup_ms, 1));
+  feed_config.warmup_config.symbols = cli_config.symbols;
+  feed_config.crc = cli_config.crc;
+  feed_config.subscriptions = cli_config.subscribe;
+  feed_config.distribution_path = cli_config.distribute;
+  feed_config.republish = cli_config.republish_port > 0;
+  feed_config.republish_config.port = cli_config.republish_port;
+  feed_config.republish_config.policy = cli_config.republish_policy == "drop"
+                                            ? SlowClientPolicy::DROP
+                                            : SlowClientPolicy::DISCONNECT;
+  feed_config.republish_config.max_delay_us =
+      static_cast<uint64_t>(std::max(cli_config.republish_delay_us, 0));
+  feed_config.republish_config.busy_poll = cli_config.republish_spin;
+
+  // Sizing only: nothing is allocated or connected
+  if (cli_config.plan_symbols > 0) {
+    print_memory_table(net::plan_memory(feed_config, cli_config.plan_symbols,
+                                        cli_config.plan_depth),
+                       "Memory Plan (peak)");
+    return 0;
+  }
+
+  if (!cli_config.is_valid()) {
+    LOG_ERROR("Main", "--port (or --transport with --path) is required");
+    CLIParser::print_usage(argv[0]);
+    return 1;
+  }
+
+  if (cli_config.verbose) {
+    CLIParser::print_config(cli_config);
+  }
 
   // Create and run feed handler with order book integration
   net::BookUpdatingFeedHandler handler(feed_config);
 
+  // Optional bar aggregation downstream of the book updaters
+  std::unique_ptr<BarStage> bars;
+  std::unique_ptr<BarJournal> bar_journal;
+  std::unique_ptr<ShmBarPublisher> bar_shm;
+  if (!cli_config.bar_intervals_ms.empty()) {
+    BarAggregatorConfig bar_config;
+    bar_config.intervals_ns.clear();
+    for (uint64_t ms : cli_config.bar_intervals_ms) {
+      bar_config.intervals_ns.push_back(ms * 1'000'000);
+    }
+    bars = std::make_unique<BarStage>(bar_config);
+    if (!cli_config.bars_journal.empty()) {
+      auto journal = BarJournal::open(cli_config.bars_journal);
+      if (!journal.ok()) {
+        LOG_ERROR("Main", "Bar journal: %s", journal.error().c_str());
+        return 1;
+      }
+      bar_journal = std::move(journal.value());
+      bars->add_sink([&](const Bar* b, size_t n) { bar_journal->write(b, n); });
+    }
+    if (!cli_config.bars_shm.empty()) {
+      auto shm = ShmBarPublisher::create(cli_config.bars_shm);
+      if (!shm.ok()) {
+        LOG_ERROR("Main", "Bar shared memory: %s", shm.error().c_str());
+        return 1;
+      }
+      bar_shm = std::move(shm.value());
+      bars->add_sink([&](const Bar* b, size_t n) { bar_shm->write(b, n); });
+    }
+    bars->start();
+    handler.set_batch_callback(bars->batch_callback());
+    handler.memory().add("bars", [&bars]() {
+      uint64_t bytes = bars->footprint_bytes();
+      return MemoryUsage{bytes, bytes};
+    });
+  }
+
   if (!handler.start()) {
     LOG_ERROR("Main", "Failed to start feed handler");
     return 1;
@@ -60,6 +127,20 @@ int main(int argc, char* argv[]) {
 
   // Print statistics
   handler.print_stats();
+  if (bars) {
+    bars->stop();  // Closes the bars still open
+    auto stats = bars->stats();
+    LOG_INFO("Main", "Bars: %lu closed (%lu by timer), %lu ticks, %lu late, %lu unknown symbols",
+             stats.bars, stats.closed_by_timer, stats.ticks, stats.late, stats.unknown_symbols);
+    if (bar_journal) {
+      LOG_INFO("Main", "Bar journal: %lu bars written, %lu errors", bar_journal->bars_written(),
+               bar_journal->errors());
+    }
+    if (bar_shm) {
+      LOG_INFO("Main", "Bar shm %s: %lu published, %lu dropped", bar_shm->name().c_str(),
+               bar_shm->bars_published(), bar_shm->bars_dropped());
+    }
+  }
 
   return 0;
 }
@@ -13,11 +13,17 @@
 
 #include "binary_protocol.hpp"
 #include "common.hpp"
+#include "memory_accounting.hpp"
+#include "message_views.hpp"
+#include "packet_framing.hpp"
 #include "udp_protocol.hpp"
 
 // Statistics
 struct UDPFeedStats {
   uint64_t messages_received = 0;
+  uint64_t packets_received = 0;
+  uint64_t bytes_received = 0;
+  uint64_t malformed_packets = 0;
   uint64_t gaps_detected = 0;
   uint64_t retransmit_requests_sent = 0;
   uint64_t gaps_filled = 0;
@@ -40,6 +46,14 @@ struct UDPFeedStats {
     std::cout << "Gaps filled (retransmit): " << gaps_filled << std::endl;
     std::cout << "Duplicate messages:       " << duplicates << std::endl;
     std::cout << "Retransmit requests sent: " << retransmit_requests_sent << std::endl;
+    if (packets_received > 0) {
+      std::cout << "Packets received:         " << packets_received << " ("
+                << static_cast<double>(bytes_received) / packets_received << " bytes/packet)"
+                << std::endl;
+      if (malformed_packets > 0) {
+        std::cout << "Malformed packets:        " << malformed_packets << std::endl;
+      }
+    }
     
     double loss_rate = 100.0 * gaps_detected / (messages_received + gaps_detected);
     std::cout << "Effective packet loss:    " << loss_rate << "%" << std::endl;
@@ -66,10 +80,11 @@ struct UDPFeedStats {
 
 class UDPFeedHandler {
 public:
-  UDPFeedHandler(const std::string& host, int udp_port, int tcp_port)
+  UDPFeedHandler(const std::string& host, int udp_port, int tcp_port, bool packet_framing = false)
     : host_(host)
     , udp_port_(udp_port)
     , tcp_port_(tcp_port)
+    , packet_framing_(packet_framing)
     , udp_fd_(-1)
     , tcp_fd_(-1)
     , should_stop_(false)
@@ -118,6 +133,7 @@ public:
     LOG_INFO("UDPFeed", "UDP Feed Handler started");
     LOG_INFO("UDPFeed", "  UDP feed: %s:%d", host_.c_str(), udp_port_);
     LOG_INFO("UDPFeed", "  TCP control: %s:%d", host_.c_str(), tcp_port_);
+    LOG_INFO("UDPFeed", "  Framing: %s", packet_framing_ ? "multi-message packets" : "one message per datagram");
 
     return Result<void>();
   }
@@ -163,6 +179,18 @@ public:
     }
     
     stats_.print();
+    print_memory_table(memory_usage());
+  }
+
+  // Single-threaded, so read straight from the containers
+  std::vector<ComponentMemory> memory_usage() const {
+    const auto& latencies = stats_.latencies_ns;
+    const uint64_t gap_bytes = gap_tracker_.active_gaps() * tree_node_bytes<uint64_t>();
+    return {
+        {"latency_samples", {container_bytes(latencies), latencies.size() * sizeof(uint64_t)}},
+        {"gap_set", {gap_bytes, gap_bytes}},
+        {"retransmit_buffer", {container_bytes(tcp_buffer_), tcp_buffer_.size()}},
+    };
   }
   
   void stop() {
@@ -197,6 +225,22 @@ private:
         }
       }
 
+      stats_.packets_received++;
+      stats_.bytes_received += bytes_read;
+
+      if (packet_framing_) {
+        // Sequence range comes from the packet header: first + index
+        bool ok = decode_packet(buffer, bytes_read,
+                                [&](const MessageHeader& header, const char* payload) {
+                                  process_message(header, payload, recv_timestamp);
+                                });
+        if (!ok) {
+          stats_.malformed_packets++;
+          LOG_ERROR("UDPFeed", "Malformed packet (%zd bytes)", bytes_read);
+        }
+        continue;
+      }
+
       // Parse message
       if (bytes_read < static_cast<ssize_t>(MessageHeader::HEADER_SIZE)) {
         LOG_ERROR("UDPFeed", "Incomplete message received");
@@ -204,41 +248,45 @@ private:
       }
       
       MessageHeader header = deserialize_header(buffer);
-      
-      if (header.type == MessageType::TICK) {
-        // Process sequence number
-        bool expected = gap_tracker_.process_sequence(header.sequence);
-        
-        if (!expected) {
-          // This could be a gap or a late arrival
-          if (header.sequence < gap_tracker_.last_sequence()) {
-            // Late arrival or retransmit - might fill a gap
-            stats_.gaps_filled++;
-          } else {
-            // New gap detected
-            stats_.gaps_detected += (header.sequence - gap_tracker_.last_sequence() - 1);
-          }
-        }
-        
-        // Deserialize tick
-        const char* payload = buffer + MessageHeader::HEADER_SIZE;
-        TickPayload tick = deserialize_tick_payload(payload);
-        
-        // Record latency
-        uint64_t process_timestamp = now_ns();
-        stats_.add_latency(process_timestamp - recv_timestamp);
-        
-        stats_.messages_received++;
-        
-        // Print periodically
-        if (stats_.messages_received % 10000 == 0) {
-          std::string symbol = trim_symbol(tick.symbol, 4);
+      process_message(header, buffer + MessageHeader::HEADER_SIZE, recv_timestamp);
+    }
+  }
 
-          LOG_INFO("UDP", "seq=%lu [%s] $%.2f @ %d | Active gaps: %zu",
-                   header.sequence, symbol.c_str(), tick.price, tick.volume, gap_tracker_.active_gaps());
-        }
+  void process_message(const MessageHeader& header, const char* payload, uint64_t recv_timestamp) {
+    if (header.type != MessageType::TICK) {
+      return;
+    }
+
+    // Process sequence number (the tracker advances past a gap, so measure
+    // it against the sequence before this one)
+    uint64_t previous = gap_tracker_.last_sequence();
+    bool expected = gap_tracker_.process_sequence(header.sequence);
+
+    if (!expected) {
+      // This could be a gap or a late arrival
+      if (header.sequence < previous) {
+        // Late arrival or retransmit - might fill a gap
+        stats_.gaps_filled++;
+      } else if (header.sequence > previous) {
+        // New gap detected
+        stats_.gaps_detected += (header.sequence - previous - 1);
       }
     }
+
+    // Record latency
+    uint64_t process_timestamp = now_ns();
+    stats_.add_latency(process_timestamp - recv_timestamp);
+
+    stats_.messages_received++;
+
+    // Print periodically; only these ticks are decoded
+    if (stats_.messages_received % 10000 == 0) {
+      TickView tick(payload);
+      std::string symbol(tick.symbol());
+
+      LOG_INFO("UDP", "seq=%lu [%s] $%.2f @ %d | Active gaps: %zu",
+               header.sequence, symbol.c_str(), tick.price(), tick.volume(), gap_tracker_.active_gaps());
+    }
   }
   
   void receive_tcp_retransmits() {
@@ -273,11 +321,8 @@ private:
         }
         
         if (header.type == MessageType::TICK) {
-          // This is a retransmitted tick
-          const char* payload = tcp_buffer_.data() + MessageHeader::HEADER_SIZE;
-          TickPayload tick = deserialize_tick_payload(payload);
-          
-          // Process sequence (should fill a gap)
+          // A retransmitted tick: only its sequence matters here, so the
+          // payload isn't decoded. Process sequence (should fill a gap)
           bool filled_gap = gap_tracker_.process_sequence(header.sequence);
           
           if (filled_gap) {
@@ -319,7 +364,7 @@ private:
 
       std::string request = serialize_retransmit_request(start, end);
 
-      ssize_t sent = send(tcp_fd_, request.data(), request.length(), 0);
+      ssize_t sent = send(tcp_fd_, request.data(), request.length(), MSG_NOSIGNAL);
       if (sent < 0) {
         LOG_PERROR("Retransmit", "Failed to send retransmit request");
         break;
@@ -333,6 +378,7 @@ private:
   std::string host_;
   int udp_port_;
   int tcp_port_;
+  bool packet_framing_;
   int udp_fd_;
   int tcp_fd_;
   
@@ -358,8 +404,9 @@ int main(int argc, char* argv[]) {
   if (argc > 3) {
     duration_seconds = std::atoi(argv[3]);
   }
+  bool packet_framing = argc > 4 && std::string(argv[4]) == "packet";
   
-  UDPFeedHandler handler(host, udp_port, tcp_port);
+  UDPFeedHandler handler(host, udp_port, tcp_port, packet_framing);
   
   auto start_result = handler.start();
   if (!start_result) {
@@ -0,0 +1,313 @@
+/**
+ * Embeddable Feed Library
+ *
+ * The C ABI in feed_capi.h over net::FeedHandler / BookUpdatingFeedHandler,
+ * built as build/libfeed.so with only the feed_* functions exported.
+ * Nothing here sits between the processor and the strategy beyond one
+ * indirect call per batch: the ticks handed to the C callback are the
+ * queue's own net::Tick slots, reinterpreted as feed_tick.
+ */
+
+#define FEED_BUILDING_LIBRARY
+#include "feed_capi.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "net/feed.hpp"
+
+static_assert(std::is_standard_layout<net::Tick>::value, "net::Tick must stay standard layout");
+static_assert(sizeof(feed_tick) == sizeof(net::Tick), "feed_tick must match net::Tick");
+static_assert(offsetof(feed_tick, timestamp) == offsetof(net::Tick, timestamp), "feed_tick layout");
+static_assert(offsetof(feed_tick, symbol) == offsetof(net::Tick, symbol), "feed_tick layout");
+static_assert(offsetof(feed_tick, price) == offsetof(net::Tick, price), "feed_tick layout");
+static_assert(offsetof(feed_tick, volume) == offsetof(net::Tick, volume), "feed_tick layout");
+static_assert(offsetof(feed_tick, recv_timestamp_ns) == offsetof(net::Tick, recv_timestamp_ns),
+              "feed_tick layout");
+static_assert(sizeof(feed_level) == sizeof(OrderBookLevel), "feed_level must match OrderBookLevel");
+static_assert(offsetof(feed_level, price) == offsetof(OrderBookLevel, price), "feed_level layout");
+static_assert(offsetof(feed_level, quantity) == offsetof(OrderBookLevel, quantity),
+              "feed_level layout");
+
+struct feed_handler {
+  std::unique_ptr<net::FeedHandler> plain;
+  std::unique_ptr<net::BookUpdatingFeedHandler> books;
+  feed_batch_callback callback = nullptr;
+  void *user_data = nullptr;
+  size_t max_batch = net::TickProcessor::DEFAULT_MAX_BATCH;
+  bool started = false;
+
+  template <typename Fn> auto with(Fn fn) { return books ? fn(*books) : fn(*plain); }
+
+  const net::FeedHandler &handler() const { return books ? books->handler() : *plain; }
+};
+
+namespace {
+
+// The handle whose callback is running on this thread, if any: the
+// processor thread owns the books and latency samples only then
+thread_local const feed_handler *dispatching = nullptr;
+
+bool owns_processor_state(const feed_handler *feed) {
+  return dispatching == feed || !feed->handler().is_running();
+}
+
+// No C++ exception may cross into a C caller
+template <typename Fn> int guarded(Fn fn) {
+  try {
+    return fn();
+  } catch (...) {
+    return FEED_EINTERNAL;
+  }
+}
+
+std::vector<std::string> symbol_list(const char *const *symbols, size_t count) {
+  std::vector<std::string> list;
+  list.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (symbols[i] != nullptr) {
+      list.emplace_back(symbols[i]);
+    }
+  }
+  return list;
+}
+
+}  // namespace
+
+extern "C" {
+
+uint32_t feed_abi_version(void) { return FEED_ABI_VERSION; }
+
+void feed_config_init(feed_config *config) {
+  if (config == nullptr) {
+    return;
+  }
+  std::memset(config, 0, sizeof(*config));
+  config->struct_size = sizeof(*config);
+  config->host = "127.0.0.1";
+  config->protocol = FEED_PROTOCOL_TEXT;
+  config->queue_size = 1024 * 1024;
+  config->transport = "tcp";
+  config->max_batch = net::TickProcessor::DEFAULT_MAX_BATCH;
+}
+
+feed_handler *feed_create(const feed_config *config) {
+  if (config == nullptr || config->struct_size == 0) {
+    return nullptr;
+  }
+  try {
+    // Fields a caller built against an older, shorter struct keep their defaults
+    feed_config c;
+    feed_config_init(&c);
+    std::memcpy(&c, config, std::min<size_t>(config->struct_size, sizeof(c)));
+
+    net::FeedConfig fc;
+    if (c.host != nullptr) fc.host = c.host;
+    fc.port = c.port;
+    if (c.protocol != FEED_PROTOCOL_TEXT && c.protocol != FEED_PROTOCOL_BINARY) {
+      return nullptr;
+    }
+    fc.protocol = c.protocol == FEED_PROTOCOL_BINARY ? net::Protocol::BINARY : net::Protocol::TEXT;
+    if (c.queue_size > 0) fc.queue_size = c.queue_size;
+    if (c.transport != nullptr) {
+      auto transport = parse_transport(c.transport);
+      if (!transport) {
+        return nullptr;
+      }
+      fc.transport = *transport;
+    }
+    if (c.path != nullptr) fc.transport_path = c.path;
+    fc.crc = c.crc != 0;
+    if (c.symbols != nullptr) {
+      fc.subscriptions = symbol_list(c.symbols, c.symbol_count);
+    }
+    if (!fc.is_valid()) {
+      return nullptr;
+    }
+
+    auto feed = std::make_unique<feed_handler>();
+    if (c.books) {
+      feed->books = std::make_unique<net::BookUpdatingFeedHandler>(fc);
+    } else {
+      feed->plain = std::make_unique<net::FeedHandler>(fc);
+    }
+    if (c.max_batch > 0) feed->max_batch = c.max_batch;
+    return feed.release();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void feed_destroy(feed_handler *feed) {
+  if (feed == nullptr) {
+    return;
+  }
+  try {
+    feed_stop(feed);
+  } catch (...) {
+  }
+  delete feed;
+}
+
+int feed_set_batch_callback(feed_handler *feed, feed_batch_callback callback, void *user_data) {
+  if (feed == nullptr) {
+    return FEED_EINVAL;
+  }
+  if (feed->started) {
+    return FEED_ESTATE;
+  }
+  feed->callback = callback;
+  feed->user_data = user_data;
+  return FEED_OK;
+}
+
+int feed_start(feed_handler *feed) {
+  if (feed == nullptr) {
+    return FEED_EINVAL;
+  }
+  if (feed->started) {
+    return FEED_ESTATE;
+  }
+  return guarded([&]() {
+    if (feed->callback != nullptr) {
+      feed_batch_callback callback = feed->callback;
+      void *user_data = feed->user_data;
+      net::BatchCallback batch = [feed, callback, user_data](const net::Tick *ticks, size_t count) {
+        dispatching = feed;
+        callback(reinterpret_cast<const feed_tick *>(ticks), count, user_data);
+        dispatching = nullptr;
+      };
+      feed->with([&](auto &h) {
+        h.set_batch_callback(batch, feed->max_batch);
+        return 0;
+      });
+    }
+    if (!feed->with([](auto &h) { return h.start(); })) {
+      return FEED_ECONNECT;
+    }
+    feed->started = true;
+    return FEED_OK;
+  });
+}
+
+int feed_wait(feed_handler *feed) {
+  if (feed == nullptr) {
+    return FEED_EINVAL;
+  }
+  if (dispatching == feed) {
+    return FEED_ESTATE;
+  }
+  return guarded([&]() {
+    feed->with([](auto &h) {
+      h.wait();
+      return 0;
+    });
+    return FEED_OK;
+  });
+}
+
+int feed_stop(feed_handler *feed) {
+  if (feed == nullptr) {
+    return FEED_EINVAL;
+  }
+  if (dispatching == feed) {
+    return FEED_ESTATE;  // Would join the thread it is running on
+  }
+  return guarded([&]() {
+    feed->with([](auto &h) {
+      h.stop();
+      return 0;
+    });
+    return FEED_OK;
+  });
+}
+
+int feed_subscribe(feed_handler *feed, const char *const *symbols, size_t count) {
+  if (feed == nullptr || (count > 0 && symbols == nullptr)) {
+    return FEED_EINVAL;
+  }
+  return guarded([&]() {
+    if (count == 0) {
+      feed->with([](auto &h) {
+        h.subscribe_all();
+        return 0;
+      });
+    } else {
+      auto list = symbol_list(symbols, count);
+      feed->with([&](auto &h) {
+        h.subscribe(list);
+        return 0;
+      });
+    }
+    return FEED_OK;
+  });
+}
+
+int feed_read_book(const feed_handler *feed, const char *symbol, feed_level *bids,
+                   size_t *bid_count, feed_level *asks, size_t *ask_count) {
+  if (feed == nullptr || symbol == nullptr || bid_count == nullptr || ask_count == nullptr ||
+      (*bid_count > 0 && bids == nullptr) || (*ask_count > 0 && asks == nullptr)) {
+    return FEED_EINVAL;
+  }
+  if (!feed->books) {
+    return FEED_ENOTFOUND;
+  }
+  if (!owns_processor_state(feed)) {
+    return FEED_ESTATE;
+  }
+  return guarded([&]() {
+    const OrderBook *book = feed->books->book(symbol);
+    if (book == nullptr) {
+      return FEED_ENOTFOUND;
+    }
+    // Built field by field from a zeroed level: `reserved` is padding in
+    // OrderBookLevel, and must not hand the caller stale stack bytes
+    auto fill = [](feed_level *out) {
+      return [out](size_t i, float price, uint64_t quantity) {
+        feed_level level{};
+        level.price = price;
+        level.quantity = quantity;
+        out[i] = level;
+      };
+    };
+    *bid_count = book->for_each_top_bid(*bid_count, fill(bids));
+    *ask_count = book->for_each_top_ask(*ask_count, fill(asks));
+    return FEED_OK;
+  });
+}
+
+int feed_get_metrics(const feed_handler *feed, feed_metrics *metrics) {
+  if (feed == nullptr || metrics == nullptr || metrics->struct_size == 0) {
+    return FEED_EINVAL;
+  }
+  return guarded([&]() {
+    const net::FeedHandler &h = feed->handler();
+    feed_metrics m{};
+    m.struct_size = metrics->struct_size;
+    m.ticks_processed = h.messages_processed();
+    m.queue_depth = h.queue_depth();
+    m.running = h.is_running() ? 1 : 0;
+    m.messages_parsed = h.messages_parsed();
+    m.parse_errors = h.parse_errors();
+    m.messages_filtered = h.messages_filtered();
+    if (owns_processor_state(feed) && h.processor() != nullptr) {
+      const LatencyStats &latency = h.processor()->latency_stats();
+      if (!latency.empty()) {
+        m.latency_p50_ns = latency.percentile(50);
+        m.latency_p99_ns = latency.percentile(99);
+      }
+    }
+    MemoryUsage memory = h.memory().total();
+    m.memory_reserved_bytes = memory.reserved;
+    m.memory_in_use_bytes = memory.in_use;
+    std::memcpy(metrics, &m, std::min<size_t>(metrics->struct_size, sizeof(m)));
+    return FEED_OK;
+  });
+}
+
+}  // extern "C"
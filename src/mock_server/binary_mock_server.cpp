@@ -1,8 +1,6 @@
-#include <arpa/inet.h>
 #include <chrono>
 #include <csignal>
 #include <cstring>
-#include <netinet/in.h>
 #include <random>
 #include <string>
 #include <sys/socket.h>
@@ -12,6 +10,10 @@
 
 #include "binary_protocol.hpp"
 #include "common.hpp"
+#include "compact_encoding.hpp"
+#include "frame_integrity.hpp"
+#include "packet_framing.hpp"
+#include "transport.hpp"
 
 // Global flag for graceful shutdown
 volatile sig_atomic_t keep_running = 1;
@@ -20,54 +22,47 @@ void signal_handler(int) { keep_running = 0; }
 
 class BinaryMockExchangeServer {
 private:
-  int server_fd;
-  int port;
+  TransportListener listener;
   std::vector<std::string> symbols;
   std::mt19937 rng;
+  uint64_t batch_latency_ns;  // 0 = one send() per message
+  bool compact;               // COMPACT_TICKS instead of TICK
+  bool crc;                   // CRC32C trailer on every frame
+  uint64_t message_limit;     // Messages per client
+  bool paced;                 // 10 messages per ms; false = as fast as the transport takes them
+
+  static constexpr size_t COMPACT_BATCH_TICKS = 64;
 
 public:
-  BinaryMockExchangeServer(int port) : port(port), rng(std::random_device{}()) {
+  BinaryMockExchangeServer(Endpoint endpoint, uint64_t batch_latency_ns = 0, bool compact = false,
+                           bool crc = false, uint64_t message_limit = 50000, bool paced = true)
+      : listener(std::move(endpoint)), rng(std::random_device{}()),
+        batch_latency_ns(batch_latency_ns), compact(compact), crc(crc),
+        message_limit(message_limit), paced(paced) {
     // Initialize some stock symbols (truncated/padded to 4 chars)
     symbols = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "META", "NVDA", "JPM "};
   }
 
   Result<void> start() {
-    // 1. Create socket
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0) {
-      return Result<void>::error("socket creation failed: " + std::string(strerror(errno)));
+    auto listening = listener.listen();
+    if (!listening) {
+      return listening;
     }
 
-    // 2. Set socket options to reuse address
-    int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) <
-        0) {
-      close(server_fd);
-      return Result<void>::error("setsockopt failed: " + std::string(strerror(errno)));
+    LOG_INFO("Server", "Binary mock exchange server listening on %s",
+             listener.endpoint().to_string().c_str());
+    if (batch_latency_ns > 0) {
+      LOG_INFO("Server", "Coalescing writes, flushed after %.0f us", batch_latency_ns / 1000.0);
     }
-
-    // 3. Set up server address
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(port);
-
-    // 4. Bind socket to address
-    if (bind(server_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) <
-        0) {
-      close(server_fd);
-      return Result<void>::error("bind failed: " + std::string(strerror(errno)));
+    if (compact) {
+      LOG_INFO("Server", "Compact tick encoding (delta/varint, keyframe every 1024 ticks)");
     }
-
-    // 5. Listen for connections
-    if (listen(server_fd, 5) < 0) {
-      close(server_fd);
-      return Result<void>::error("listen failed: " + std::string(strerror(errno)));
+    if (crc) {
+      LOG_INFO("Server", "CRC32C frame trailers (%s)", crc32c_hardware() ? "hardware" : "software");
+    }
+    if (!paced) {
+      LOG_INFO("Server", "Flat out: %lu messages, no pacing", message_limit);
     }
-
-    LOG_INFO("Server", "Binary mock exchange server listening on port %d", port);
     return Result<void>();
   }
 
@@ -75,62 +70,134 @@ public:
     while (keep_running) {
       LOG_INFO("Server", "Waiting for client connection...");
 
-      // Accept a client connection
-      struct sockaddr_in client_addr;
-      socklen_t client_len = sizeof(client_addr);
-
-      int client_fd =
-          accept(server_fd, (struct sockaddr *)&client_addr, &client_len);
-      if (client_fd < 0) {
+      // Accept a client connection (short timeouts so Ctrl+C is noticed)
+      auto accepted = listener.accept(200);
+      while (keep_running && !accepted && accepted.error() == "timeout") {
+        accepted = listener.accept(200);
+      }
+      if (!accepted) {
         if (keep_running) {
-          LOG_PERROR("Server", "accept failed");
+          LOG_ERROR("Server", "%s", accepted.error().c_str());
         }
         continue;
       }
 
-      LOG_INFO("Server", "Client connected from %s:%d", inet_ntoa(client_addr.sin_addr),
-               ntohs(client_addr.sin_port));
+      LOG_INFO("Server", "Client connected from %s", listener.last_peer().c_str());
 
       // Handle this client
-      handle_client(client_fd);
+      handle_client(accepted.value());
 
       LOG_INFO("Server", "Client disconnected");
     }
   }
 
-  void handle_client(int client_fd) {
+  void handle_client(TransportChannel &client) {
     uint64_t message_count = 0;
+    uint64_t write_count = 0;
+    uint64_t bytes_sent = 0;
+    WriteBatcher batcher(16384, batch_latency_ns);
     auto start_time = std::chrono::steady_clock::now();
 
+    // Compact mode batches ticks, not frames: one COMPACT_TICKS message per
+    // flush. Sequences are this connection's, so the first batch is a keyframe.
+    CompactTickEncoder encoder;
+    std::vector<BinaryTick> compact_ticks;
+    uint64_t compact_sequence = 0;
+    uint64_t compact_started_ns = 0;
+
+    auto send_counted = [&](std::string_view data) {
+      write_count++;
+      bytes_sent += data.size();
+      if (!client.send_all(data)) {
+        LOG_PERROR("Server", "send failed");
+        return false;
+      }
+      return true;
+    };
+
+    auto flush = [&]() {
+      if (!compact_ticks.empty()) {
+        std::string message;
+        encoder.encode(message, compact_sequence - compact_ticks.size() + 1,
+                       compact_ticks.data(), compact_ticks.size());
+        compact_ticks.clear();
+        if (crc) append_crc_trailer(message);
+        return send_counted(message);
+      }
+      if (batcher.empty()) {
+        return true;
+      }
+      bool ok = send_counted(batcher.data());
+      batcher.clear();
+      return ok;
+    };
+    auto pending = [&]() { return !compact_ticks.empty() || !batcher.empty(); };
+    auto deadline = [&]() {
+      return compact_ticks.empty() ? batcher.deadline() : compact_started_ns + batch_latency_ns;
+    };
+
     // Generate and send binary messages
-    while (keep_running && message_count < 50000) {
+    while (keep_running && message_count < message_limit) {
       BinaryTick tick = generate_tick();
-      std::string message = serialize_tick(tick);
 
-      ssize_t bytes_sent = send(client_fd, message.data(), message.length(), 0);
-      if (bytes_sent < 0) {
-        LOG_PERROR("Server", "send failed");
-        break;
+      if (compact) {
+        uint64_t now = now_ns();
+        if (compact_ticks.empty()) {
+          compact_started_ns = now;
+        }
+        compact_ticks.push_back(tick);
+        compact_sequence++;
+        if ((batch_latency_ns == 0 || compact_ticks.size() == COMPACT_BATCH_TICKS ||
+             now >= deadline()) && !flush()) {
+          break;
+        }
+      } else if (batch_latency_ns > 0) {
+        std::string message = serialize_tick(tick);
+        if (crc) append_crc_trailer(message);
+        uint64_t now = now_ns();
+        if (!batcher.append(message, now)) {
+          if (!flush()) break;
+          batcher.append(message, now);
+        }
+        if (batcher.due(now) && !flush()) break;
+      } else {
+        std::string message = serialize_tick(tick);
+        if (crc) append_crc_trailer(message);
+        if (!send_counted(message)) break;
       }
 
       message_count++;
 
       // Optional: Add small delay to simulate realistic feed rate
       // Uncomment to slow down the feed
-      if (message_count % 10 == 0) {
-        std::this_thread::sleep_for(std::chrono::microseconds(1000));
+      if (paced && message_count % 10 == 0) {
+        // A pending write goes out by its deadline, not after the sleep
+        uint64_t wake = now_ns() + 1'000'000;
+        if (pending() && deadline() < wake) {
+          uint64_t now = now_ns();
+          if (deadline() > now) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(deadline() - now));
+          }
+          if (!flush()) break;
+        }
+        uint64_t now = now_ns();
+        if (wake > now) {
+          std::this_thread::sleep_for(std::chrono::nanoseconds(wake - now));
+        }
       }
     }
+    flush();
 
     auto end_time = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         end_time - start_time);
     double seconds = duration.count() / 1000.0;
 
-    LOG_INFO("Server", "Sent %lu messages in %.2fs (%d msgs/sec)",
-             message_count, seconds, static_cast<int>(message_count / seconds));
+    LOG_INFO("Server", "Sent %lu messages in %lu writes in %.2fs (%d msgs/sec, %.1f bytes/msg)",
+             message_count, write_count, seconds, static_cast<int>(message_count / seconds),
+             static_cast<double>(bytes_sent) / message_count);
 
-    close(client_fd);
+    client.close();
   }
 
   BinaryTick generate_tick() {
@@ -157,12 +224,7 @@ public:
     return tick;
   }
 
-  void stop() {
-    keep_running = 0;
-    if (server_fd >= 0) {
-      close(server_fd);
-    }
-  }
+  void stop() { keep_running = 0; }
 
   ~BinaryMockExchangeServer() { stop(); }
 };
@@ -171,12 +233,46 @@ int main(int argc, char *argv[]) {
   // Set up signal handler for graceful shutdown (Ctrl+C)
   signal(SIGINT, signal_handler);
 
-  int port = 9999;
+  Endpoint endpoint;
+  endpoint.port = 9999;
+  uint64_t batch_latency_us = 0;  // 0 = one send() per message
+  bool compact = false;
+  bool crc = false;
+  uint64_t messages = 50000;
+  bool paced = true;
   if (argc > 1) {
-    port = std::atoi(argv[1]);
+    endpoint.port = std::atoi(argv[1]);
+  }
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--batch-us" && i + 1 < argc) {
+      batch_latency_us = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--compact") {
+      compact = true;
+    } else if (arg == "--crc") {
+      crc = true;
+    } else if (arg == "--messages" && i + 1 < argc) {
+      messages = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--flat-out") {
+      paced = false;
+    } else if (arg == "--transport" && i + 1 < argc) {
+      auto transport = parse_transport(argv[++i]);
+      if (!transport) {
+        LOG_ERROR("Server", "Unknown transport %s (tcp, unix, unixgram, shm)", argv[i]);
+        return 1;
+      }
+      endpoint.transport = *transport;
+    } else if (arg == "--path" && i + 1 < argc) {
+      endpoint.path = argv[++i];
+    }
+  }
+  if (endpoint.transport != Transport::TCP && endpoint.path.empty()) {
+    LOG_ERROR("Server", "--transport %s needs --path", transport_name(endpoint.transport));
+    return 1;
   }
 
-  BinaryMockExchangeServer server(port);
+  BinaryMockExchangeServer server(endpoint, batch_latency_us * 1000, compact, crc, messages,
+                                  paced);
 
   auto start_result = server.start();
   if (!start_result) {
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <arpa/inet.h>
 #include <chrono>
 #include <csignal>
+#include <cstdlib>
 #include <cstring>
 #include <netinet/in.h>
 #include <random>
@@ -12,6 +14,7 @@
 
 #include "binary_protocol.hpp"
 #include "common.hpp"
+#include "heartbeat_fleet.hpp"
 
 // Global flag for graceful shutdown
 volatile sig_atomic_t keep_running = 1;
@@ -212,6 +215,51 @@ public:
   ~HeartbeatMockServer() { stop(); }
 };
 
+// --fleet: every session on reactor threads, lateness reported every report_sec
+int run_fleet(const HeartbeatFleetConfig &config, int report_sec) {
+  HeartbeatFleet fleet(config);
+  auto start_result = fleet.start();
+  if (!start_result) {
+    LOG_ERROR("Server", "%s", start_result.error().c_str());
+    return 1;
+  }
+  LOG_INFO("Server", "Heartbeat fleet listening on port %u with %zu reactor(s)", fleet.port(),
+           fleet.reactor_count());
+  LOG_INFO("Server", "  Heartbeat interval: %dms +/- %dms, %d tick(s) per heartbeat",
+           config.interval_ms, config.jitter_ms, config.ticks_per_heartbeat);
+  if (config.stall_rate > 0) {
+    LOG_INFO("Server", "  Stalls: %.4f per heartbeat, %dms each", config.stall_rate,
+             config.stall_ms);
+  }
+
+  auto report = [](const char *label, const HeartbeatFleetStats &s, double seconds) {
+    LOG_INFO("Server",
+             "%s: %lu sessions, %.0f heartbeats/s, %.0f ticks/s, lateness p50 %.1fus "
+             "p99 %.1fus p99.9 %.1fus max %.1fus, %lu stalls, %lu blocked, %lu slow",
+             label, s.sessions, s.heartbeats / seconds, s.ticks / seconds,
+             s.lateness_percentile(50) / 1e3, s.lateness_percentile(99) / 1e3,
+             s.lateness_percentile(99.9) / 1e3, s.lateness_max_ns / 1e3, s.stalls,
+             s.send_blocked, s.slow_disconnects);
+  };
+
+  const uint64_t start = now_ns();
+  uint64_t last_report = start;
+  HeartbeatFleetStats last = fleet.stats();
+  while (keep_running) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t now = now_ns();
+    if (now - last_report >= static_cast<uint64_t>(report_sec) * 1'000'000'000ULL) {
+      HeartbeatFleetStats current = fleet.stats();
+      report("Interval", current.since(last), (now - last_report) / 1e9);
+      last = current;
+      last_report = now;
+    }
+  }
+  report("Total", fleet.stats(), (now_ns() - start) / 1e9);
+  fleet.stop();
+  return 0;
+}
+
 int main(int argc, char* argv[]) {
   signal(SIGINT, signal_handler);
 
@@ -219,14 +267,51 @@ int main(int argc, char* argv[]) {
   int heartbeat_interval_ms = 1000;  // 1 second
   int messages_per_heartbeat = 10;
   
-  if (argc > 1) {
-    port = std::atoi(argv[1]);
+  int positional = 1;
+  if (argc > positional && argv[positional][0] != '-') {
+    port = std::atoi(argv[positional++]);
+  }
+  if (argc > positional && argv[positional][0] != '-') {
+    heartbeat_interval_ms = std::atoi(argv[positional++]);
+  }
+  if (argc > positional && argv[positional][0] != '-') {
+    messages_per_heartbeat = std::atoi(argv[positional++]);
   }
-  if (argc > 2) {
-    heartbeat_interval_ms = std::atoi(argv[2]);
+
+  bool fleet = false;
+  int report_sec = 5;
+  HeartbeatFleetConfig fleet_config;
+  for (int i = positional; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--fleet") {
+      fleet = true;
+    } else if (arg == "--reactors" && i + 1 < argc) {
+      fleet_config.reactors = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--jitter-ms" && i + 1 < argc) {
+      fleet_config.jitter_ms = std::atoi(argv[++i]);
+    } else if (arg == "--stall-rate" && i + 1 < argc) {
+      fleet_config.stall_rate = std::atof(argv[++i]);
+    } else if (arg == "--stall-ms" && i + 1 < argc) {
+      fleet_config.stall_ms = std::atoi(argv[++i]);
+    } else if (arg == "--pin") {
+      fleet_config.pin = true;
+    } else if (arg == "--seed" && i + 1 < argc) {
+      fleet_config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--report-sec" && i + 1 < argc) {
+      report_sec = std::max(1, std::atoi(argv[++i]));
+    }
   }
-  if (argc > 3) {
-    messages_per_heartbeat = std::atoi(argv[3]);
+
+  if (fleet) {
+    fleet_config.port = static_cast<uint16_t>(port);
+    fleet_config.interval_ms = heartbeat_interval_ms;
+    fleet_config.ticks_per_heartbeat = messages_per_heartbeat;
+    if (!fleet_config.is_valid()) {
+      LOG_ERROR("Server", "Invalid fleet options (jitter must be under the interval, "
+                          "stalls need --stall-ms)");
+      return 1;
+    }
+    return run_fleet(fleet_config, report_sec);
   }
 
   HeartbeatMockServer server(port, heartbeat_interval_ms, messages_per_heartbeat);
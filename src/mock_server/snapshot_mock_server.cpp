@@ -1,11 +1,18 @@
+#include <algorithm>
 #include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <csignal>
 #include <cstring>
+#include <deque>
 #include <fcntl.h>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <netinet/in.h>
+#include <poll.h>
 #include <random>
 #include <string>
 #include <sys/socket.h>
@@ -26,20 +33,20 @@ struct SimulatedOrderBook {
   std::map<float, uint64_t> bids;
   std::map<float, uint64_t> asks;
   
-  void initialize(const std::string& /*symbol*/, std::mt19937& rng) {
+  void initialize(const std::string& /*symbol*/, std::mt19937& rng, int depth = 10) {
     // Generate initial order book around a base price
     std::uniform_real_distribution<float> base_price_dist(100.0f, 200.0f);
     float mid_price = base_price_dist(rng);
     
     // Generate bid levels (below mid)
-    for (int i = 0; i < 10; ++i) {
+    for (int i = 0; i < depth; ++i) {
       float price = mid_price - (i + 1) * 0.01f;
       uint64_t quantity = 1000 + rng() % 9000;
       bids[price] = quantity;
     }
     
     // Generate ask levels (above mid)
-    for (int i = 0; i < 10; ++i) {
+    for (int i = 0; i < depth; ++i) {
       float price = mid_price + (i + 1) * 0.01f;
       uint64_t quantity = 1000 + rng() % 9000;
       asks[price] = quantity;
@@ -63,6 +70,14 @@ struct SimulatedOrderBook {
     }
     return result;
   }
+
+  // Same value OrderBook::checksum() gives for this state
+  uint64_t checksum() const {
+    uint64_t sum = 0;
+    for (const auto& [price, qty] : bids) sum += book_level_checksum(0, price, qty);
+    for (const auto& [price, qty] : asks) sum += book_level_checksum(1, price, qty);
+    return sum;
+  }
   
   // Apply a random update and return the update message
   std::pair<uint8_t, float> apply_random_update(std::mt19937& rng, int64_t& quantity_out) {
@@ -112,35 +127,82 @@ struct SimulatedOrderBook {
   }
 };
 
+// Four-character base-36 names for a synthetic universe: "A000", "A001", ...
+std::string symbol_name(size_t i) {
+  static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  std::string s = "A000";
+  for (int pos = 3; pos >= 1 && i > 0; --pos) {
+    s[pos] = digits[i % 36];
+    i /= 36;
+  }
+  s[0] = static_cast<char>('A' + i % 26);
+  return s;
+}
+
 class SnapshotMockServer {
 private:
   int server_fd;
   int port;
   std::mt19937 rng;
-  uint64_t sequence_number_;
+  uint64_t sequence_number_;  // Next to send; starts at 1 so 0 means "nothing yet"
   
   // Configuration
   int heartbeat_interval_ms_;
   int updates_per_second_;
+  int checksum_interval_ms_;  // 0 = no periodic BOOK_CHECKSUM
+  int corrupt_every_;         // Drop every Nth update unsent (0 = never)
+  int book_depth_;            // Initial levels per side
+  int snapshot_port_;         // Snapshot channel (0 = none)
+  uint64_t updates_generated_ = 0;
+  std::atomic<uint32_t> snapshot_id_{0};
+
+  // Snapshot channel: a separate listener serving only snapshots, one
+  // thread per connection. The books, sequence numbers and history are
+  // shared with the live feed under state_mutex_.
+  int snapshot_fd_ = -1;
+  std::thread snapshot_acceptor_;
+  std::vector<std::thread> snapshot_sessions_;
+  std::mutex state_mutex_;
+  std::atomic<bool> channel_requested_{false};  // Start live updates without a feed request
+
+  // Levels per SNAPSHOT_CHUNK
+  static constexpr size_t CHUNK_LEVELS = 512;
   
   // Simulated order books
   std::map<std::string, SimulatedOrderBook> order_books_;
 
+  // Client requests not yet parsed (one recv may hold several, or part of one)
+  std::string request_buffer_;
+
+  // Recently sent sequenced messages (everything but replays) for RESUME_REQUEST
+  static constexpr size_t MAX_HISTORY = 100000;
+  std::deque<std::pair<uint64_t, std::string>> history_;
+
 public:
-  SnapshotMockServer(int port, int heartbeat_interval_ms = 1000, int updates_per_second = 10)
-    : port(port), rng(std::random_device{}()), sequence_number_(0)
+  SnapshotMockServer(int port, int heartbeat_interval_ms = 1000, int updates_per_second = 10,
+                     int checksum_interval_ms = 1000, int corrupt_every = 0,
+                     int book_depth = 10, int universe = 3, int snapshot_port = 0)
+    : port(port), rng(std::random_device{}()), sequence_number_(1)
     , heartbeat_interval_ms_(heartbeat_interval_ms)
-    , updates_per_second_(updates_per_second) {
+    , updates_per_second_(updates_per_second)
+    , checksum_interval_ms_(checksum_interval_ms)
+    , corrupt_every_(corrupt_every)
+    , book_depth_(book_depth)
+    , snapshot_port_(snapshot_port) {
     
-    // Initialize order books for a few symbols
+    // Initialize order books for a few symbols, plus synthetic ones up to
+    // the universe size
     initialize_symbol("AAPL");
     initialize_symbol("MSFT");
     initialize_symbol("GOOG");
+    for (size_t i = 0; order_books_.size() < static_cast<size_t>(universe); ++i) {
+      initialize_symbol(symbol_name(i));
+    }
   }
   
   void initialize_symbol(const std::string& symbol_str) {
     SimulatedOrderBook book;
-    book.initialize(symbol_str, rng);
+    book.initialize(symbol_str, rng, book_depth_);
     order_books_[symbol_str] = book;
   }
 
@@ -175,14 +237,142 @@ public:
     LOG_INFO("Server", "Snapshot-enabled mock server listening on port %d", port);
     LOG_INFO("Server", "  Heartbeat interval: %dms", heartbeat_interval_ms_);
     LOG_INFO("Server", "  Updates per second: %d", updates_per_second_);
-    std::cout << "[Server] Symbols: ";
-    for (const auto& [symbol, book] : order_books_) {
-      std::cout << symbol << " ";
+    LOG_INFO("Server", "  Checksum interval: %dms", checksum_interval_ms_);
+    LOG_INFO("Server", "  Book depth: %d levels per side", book_depth_);
+    if (corrupt_every_ > 0) {
+      LOG_INFO("Server", "  Dropping every %d updates (simulated divergence)", corrupt_every_);
+    }
+    if (order_books_.size() <= 10) {
+      std::cout << "[Server] Symbols: ";
+      for (const auto& [symbol, book] : order_books_) {
+        std::cout << symbol << " ";
+      }
+      std::cout << std::endl;
+    } else {
+      LOG_INFO("Server", "Symbols: %zu (%s ... %s)", order_books_.size(),
+               order_books_.begin()->first.c_str(), order_books_.rbegin()->first.c_str());
+    }
+
+    if (snapshot_port_ > 0) {
+      return start_snapshot_channel();
     }
-    std::cout << std::endl;
     return Result<void>();
   }
 
+  Result<void> start_snapshot_channel() {
+    snapshot_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (snapshot_fd_ < 0) {
+      return Result<void>::error("snapshot channel socket failed: " + std::string(strerror(errno)));
+    }
+    int opt = 1;
+    setsockopt(snapshot_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(snapshot_port_);
+    if (bind(snapshot_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(snapshot_fd_, 64) < 0) {
+      std::string err = strerror(errno);
+      close(snapshot_fd_);
+      snapshot_fd_ = -1;
+      return Result<void>::error("snapshot channel bind/listen failed: " + err);
+    }
+
+    LOG_INFO("Server", "Snapshot channel listening on port %d", snapshot_port_);
+    snapshot_acceptor_ = std::thread([this] {
+      while (keep_running) {
+        int fd = accept(snapshot_fd_, nullptr, nullptr);
+        if (fd < 0) {
+          break;  // Closed by stop()
+        }
+        snapshot_sessions_.emplace_back([this, fd] { serve_snapshot_channel(fd); });
+      }
+    });
+    return Result<void>();
+  }
+
+  /**
+   * One snapshot channel connection: read one request (a symbol, "ALL", or
+   * a partition), send the snapshots, close. Each book is copied under the
+   * lock together with the last live sequence it reflects; the messages are
+   * not part of the live stream, so all three carry that sequence.
+   */
+  void serve_snapshot_channel(int fd) {
+    char header_bytes[MessageHeader::HEADER_SIZE];
+    char payload[16];
+    MessageHeader header{};
+    bool ok = recv(fd, header_bytes, sizeof(header_bytes), MSG_WAITALL) ==
+              static_cast<ssize_t>(sizeof(header_bytes));
+    if (ok) {
+      header = deserialize_header(header_bytes);
+      ok = header.length <= sizeof(payload) &&
+           recv(fd, payload, header.length, MSG_WAITALL) == static_cast<ssize_t>(header.length);
+    }
+    if (!ok) {
+      close(fd);
+      return;
+    }
+    channel_requested_ = true;
+
+    uint32_t partition = 0, partitions = 1;
+    std::string only;
+    if (header.type == MessageType::PARTITION_SNAPSHOT_REQUEST) {
+      PartitionSnapshotRequestPayload request = deserialize_partition_snapshot_request(payload);
+      partition = request.partition;
+      partitions = std::max<uint16_t>(request.partitions, 1);
+    } else if (header.type == MessageType::SNAPSHOT_REQUEST) {
+      only = trim_symbol(deserialize_snapshot_request(payload).symbol, 4);
+      if (only == "ALL") only.clear();
+    } else {
+      close(fd);
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t books = 0;
+    std::vector<std::string> symbols;
+    {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      for (const auto& [symbol_str, book] : order_books_) {
+        if ((only.empty() || only == symbol_str) &&
+            symbol_partition(wire_symbol(symbol_str).data(), partitions) == partition) {
+          symbols.push_back(symbol_str);
+        }
+      }
+    }
+
+    for (const auto& symbol_str : symbols) {
+      std::vector<std::pair<uint64_t, std::string>> messages;
+      {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        uint64_t reflected = sequence_number_ - 1;
+        messages = encode_snapshot(symbol_str, [reflected] { return reflected; });
+      }
+      bool sent = true;
+      for (const auto& [seq, message] : messages) {
+        sent = sent && send_message(fd, message);
+      }
+      if (!sent) {
+        LOG_PERROR("Server", "snapshot channel send failed");
+        break;
+      }
+      books++;
+    }
+
+    LOG_INFO("Server", "Snapshot channel: sent %zu books (partition %u of %u) in %.2f ms", books,
+             partition, partitions,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    close(fd);
+  }
+
+  static std::array<char, 4> wire_symbol(const std::string& symbol_str) {
+    std::array<char, 4> symbol{};
+    memcpy(symbol.data(), symbol_str.data(), std::min(symbol_str.size(), size_t(4)));
+    return symbol;
+  }
+
   void run() {
     while (keep_running) {
       LOG_INFO("Server", "Waiting for client connection...");
@@ -201,8 +391,8 @@ public:
       LOG_INFO("Server", "Client connected from %s:%d", inet_ntoa(client_addr.sin_addr),
                ntohs(client_addr.sin_port));
 
-      // Reset sequence number for new connection
-      sequence_number_ = 0;
+      // Sequence numbers continue across sessions so a restarted client can
+      // resume from its checkpoint with RESUME_REQUEST
 
       handle_client(client_fd);
 
@@ -217,13 +407,17 @@ public:
     
     auto last_heartbeat = std::chrono::steady_clock::now();
     auto last_update = std::chrono::steady_clock::now();
+    auto last_checksum = std::chrono::steady_clock::now();
     
     uint64_t update_count = 0;
     uint64_t heartbeat_count = 0;
+    uint64_t checksum_count = 0;
     bool snapshot_sent = false;
+    request_buffer_.clear();
     
     while (keep_running) {
       auto now = std::chrono::steady_clock::now();
+      std::unique_lock<std::mutex> lock(state_mutex_);  // Snapshot channel reads the books
       
       // Check for snapshot requests from client
       check_for_snapshot_request(client_fd, snapshot_sent);
@@ -241,8 +435,9 @@ public:
         last_heartbeat = now;
       }
       
-      // Send incremental updates (only after snapshot has been sent)
-      if (snapshot_sent) {
+      // Send incremental updates (only after snapshot has been sent, here or
+      // on the snapshot channel)
+      if (snapshot_sent || channel_requested_) {
         auto elapsed_since_update = std::chrono::duration_cast<std::chrono::milliseconds>(
           now - last_update
         );
@@ -256,9 +451,24 @@ public:
           update_count++;
           last_update = now;
         }
+
+        // Periodic checksums let the client verify every book it maintains
+        if (checksum_interval_ms_ > 0 &&
+            now - last_checksum >= std::chrono::milliseconds(checksum_interval_ms_)) {
+          bool sent = true;
+          for (const auto& [symbol_str, book] : order_books_) {
+            sent = sent && send_checksum(client_fd, symbol_str);
+          }
+          if (!sent) {
+            break;
+          }
+          checksum_count++;
+          last_checksum = now;
+        }
       }
       
       // Small sleep to avoid busy loop
+      lock.unlock();
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
       
       // Stop after sending enough data
@@ -267,8 +477,8 @@ public:
       }
     }
     
-    LOG_INFO("Server", "Session stats: %lu heartbeats, %lu updates sent",
-             heartbeat_count, update_count);
+    LOG_INFO("Server", "Session stats: %lu heartbeats, %lu updates, %lu checksum rounds sent",
+             heartbeat_count, update_count, checksum_count);
 
     close(client_fd);
   }
@@ -280,57 +490,193 @@ public:
     if (bytes_read <= 0) {
       return;  // No data or error (expected with non-blocking)
     }
-    
-    // Parse message
-    if (bytes_read < static_cast<ssize_t>(MessageHeader::HEADER_SIZE)) {
+    request_buffer_.append(buffer, bytes_read);
+
+    // A client recovering several books sends its requests back to back
+    size_t offset = 0;
+    while (request_buffer_.size() - offset >= MessageHeader::HEADER_SIZE) {
+      MessageHeader header = deserialize_header(request_buffer_.data() + offset);
+      size_t total_size = MessageHeader::HEADER_SIZE + header.length;
+      if (request_buffer_.size() - offset < total_size) {
+        break;
+      }
+      handle_request(client_fd, header,
+                     request_buffer_.data() + offset + MessageHeader::HEADER_SIZE,
+                     snapshot_sent);
+      offset += total_size;
+    }
+    request_buffer_.erase(0, offset);
+  }
+
+  void handle_request(int client_fd, const MessageHeader& header, const char* payload,
+                      bool& snapshot_sent) {
+    if (header.type == MessageType::RESUME_REQUEST) {
+      ResumeRequestPayload request = deserialize_resume_request(payload);
+      std::string symbol_str = trim_symbol(request.symbol, 4);
+
+      if (replay_from(client_fd, request.from_sequence)) {
+        snapshot_sent = true;
+      } else {
+        // Can't bridge the gap (history too short, or client is ahead of us
+        // e.g. after a server restart): fall back to a snapshot
+        LOG_WARN("Server", "Cannot resume %s from seq=%lu, sending snapshot",
+                 symbol_str.c_str(), request.from_sequence);
+        send_snapshot(client_fd, symbol_str);
+        snapshot_sent = true;
+      }
       return;
     }
-    
-    MessageHeader header = deserialize_header(buffer);
-    
+
     if (header.type == MessageType::SNAPSHOT_REQUEST) {
-      SnapshotRequestPayload request = deserialize_snapshot_request(
-        buffer + MessageHeader::HEADER_SIZE
-      );
+      SnapshotRequestPayload request = deserialize_snapshot_request(payload);
       
       std::string symbol_str = trim_symbol(request.symbol, 4);
       
       LOG_INFO("Server", "Received snapshot request for symbol: %s", symbol_str.c_str());
 
-      // Send snapshot
-      send_snapshot(client_fd, symbol_str);
+      // Send snapshot ("ALL": every book, one after another)
+      if (symbol_str == "ALL") {
+        for (const auto& [symbol, book] : order_books_) {
+          if (!send_snapshot(client_fd, symbol)) break;
+        }
+      } else {
+        send_snapshot(client_fd, symbol_str);
+      }
       snapshot_sent = true;
     }
   }
   
-  bool send_snapshot(int client_fd, const std::string& symbol_str) {
+  // Resend every sequenced message after from_sequence; false if history
+  // doesn't cover the range. Sequences here are scoped to the server process;
+  // a real venue would also scope them to a session/trading day.
+  bool replay_from(int client_fd, uint64_t from_sequence) {
+    if (from_sequence >= sequence_number_) {
+      return false;
+    }
+    if (from_sequence + 1 < sequence_number_ &&
+        (history_.empty() || history_.front().first > from_sequence + 1)) {
+      return false;
+    }
+
+    size_t replayed = 0;
+    for (const auto& [seq, message] : history_) {
+      if (seq <= from_sequence) continue;
+      if (!send_message(client_fd, message)) {
+        LOG_PERROR("Server", "send replay failed");
+        return false;
+      }
+      replayed++;
+    }
+
+    LOG_INFO("Server", "Resumed client from seq=%lu (%zu messages replayed)",
+             from_sequence, replayed);
+    return true;
+  }
+
+  void remember(uint64_t sequence, const std::string& message) {
+    history_.emplace_back(sequence, message);
+    if (history_.size() > MAX_HISTORY) {
+      history_.pop_front();
+    }
+  }
+
+  // Chunked snapshot of the whole book: begin, level chunks (best first),
+  // end with the book checksum. `next_sequence()` gives each message's
+  // header sequence. Empty if the symbol is unknown.
+  template <typename NextSequence>
+  std::vector<std::pair<uint64_t, std::string>> encode_snapshot(const std::string& symbol_str,
+                                                                NextSequence next_sequence) {
+    std::vector<std::pair<uint64_t, std::string>> messages;
     auto it = order_books_.find(symbol_str);
     if (it == order_books_.end()) {
+      return messages;
+    }
+
+    const auto& book = it->second;
+    auto bids = book.get_top_bids(book.bids.size());
+    auto asks = book.get_top_asks(book.asks.size());
+    auto symbol = wire_symbol(symbol_str);
+    uint32_t snapshot_id = ++snapshot_id_;
+
+    uint64_t seq = next_sequence();
+    messages.emplace_back(seq, serialize_snapshot_begin(seq, symbol.data(), snapshot_id,
+                                                        bids.size(), asks.size()));
+    uint32_t chunks = 0;
+    for (uint8_t side = 0; side < 2; ++side) {
+      const auto& levels = side == 0 ? bids : asks;
+      for (size_t offset = 0; offset < levels.size(); offset += CHUNK_LEVELS) {
+        uint16_t count = static_cast<uint16_t>(std::min(CHUNK_LEVELS, levels.size() - offset));
+        seq = next_sequence();
+        messages.emplace_back(seq, serialize_snapshot_chunk(seq, symbol.data(), snapshot_id,
+                                                            chunks++, side,
+                                                            levels.data() + offset, count));
+      }
+    }
+    seq = next_sequence();
+    messages.emplace_back(seq, serialize_snapshot_end(seq, symbol.data(), snapshot_id, chunks,
+                                                      book.checksum()));
+    return messages;
+  }
+
+  // Snapshot on the live feed: every part is sequenced and remembered, so a
+  // replay that crosses a snapshot doesn't look like a gap
+  bool send_snapshot(int client_fd, const std::string& symbol_str) {
+    auto messages = encode_snapshot(symbol_str, [this] { return sequence_number_++; });
+    if (messages.empty()) {
       LOG_ERROR("Server", "Unknown symbol: %s", symbol_str.c_str());
       return false;
     }
 
-    const auto& book = it->second;
+    for (const auto& [seq, message] : messages) {
+      remember(seq, message);
+      if (!send_message(client_fd, message)) {
+        LOG_PERROR("Server", "send snapshot failed");
+        return false;
+      }
+    }
+
+    const auto& book = order_books_.at(symbol_str);
+    LOG_INFO("Server", "Sent snapshot (seq=%lu) for %s: %zu bids, %zu asks in %zu chunks",
+             messages.front().first, symbol_str.c_str(), book.bids.size(), book.asks.size(),
+             messages.size() - 2);
+    return true;
+  }
 
-    // Get top 10 levels
-    auto bids = book.get_top_bids(10);
-    auto asks = book.get_top_asks(10);
+  // The client socket is non-blocking; large snapshots can fill its buffer,
+  // so wait for room rather than dropping the rest of a message
+  bool send_message(int client_fd, const std::string& message) {
+    size_t sent = 0;
+    while (sent < message.size()) {
+      ssize_t n = send(client_fd, message.data() + sent, message.size() - sent, 0);
+      if (n > 0) {
+        sent += n;
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        pollfd pfd{client_fd, POLLOUT, 0};
+        if (poll(&pfd, 1, 1000) > 0) {
+          continue;
+        }
+      }
+      return false;
+    }
+    return true;
+  }
 
+  bool send_checksum(int client_fd, const std::string& symbol_str) {
     char symbol[4];
     memset(symbol, 0, 4);
     memcpy(symbol, symbol_str.c_str(), std::min(symbol_str.size(), size_t(4)));
 
-    std::string message = serialize_snapshot_response(sequence_number_++, symbol, bids, asks);
+    std::string message = serialize_book_checksum(
+      sequence_number_, symbol, order_books_.at(symbol_str).checksum()
+    );
+    remember(sequence_number_++, message);
 
-    ssize_t bytes_sent = send(client_fd, message.data(), message.length(), 0);
-    if (bytes_sent < 0) {
-      LOG_PERROR("Server", "send snapshot failed");
+    if (!send_message(client_fd, message)) {
+      LOG_PERROR("Server", "send checksum failed");
       return false;
     }
-
-    LOG_INFO("Server", "Sent snapshot (seq=%lu) for %s: %zu bids, %zu asks",
-             sequence_number_ - 1, symbol_str.c_str(), bids.size(), asks.size());
-
     return true;
   }
   
@@ -346,17 +692,23 @@ public:
     // Apply random update
     int64_t quantity;
     auto [side, price] = book.apply_random_update(rng, quantity);
+
+    // Simulate a lost/misapplied update: our book changes, the client's won't
+    if (corrupt_every_ > 0 && ++updates_generated_ % corrupt_every_ == 0) {
+      LOG_INFO("Server", "Dropped %s update (simulated divergence)", symbol_str.c_str());
+      return true;
+    }
     
     char symbol[4];
     memset(symbol, 0, 4);
     memcpy(symbol, symbol_str.c_str(), std::min(symbol_str.size(), size_t(4)));
     
     std::string message = serialize_order_book_update(
-      sequence_number_++, symbol, side, price, quantity
+      sequence_number_, symbol, side, price, quantity
     );
+    remember(sequence_number_++, message);
     
-    ssize_t bytes_sent = send(client_fd, message.data(), message.length(), 0);
-    if (bytes_sent < 0) {
+    if (!send_message(client_fd, message)) {
       LOG_PERROR("Server", "send update failed");
       return false;
     }
@@ -366,10 +718,10 @@ public:
   
   bool send_heartbeat(int client_fd) {
     uint64_t timestamp = now_ns();
-    std::string message = serialize_heartbeat(sequence_number_++, timestamp);
+    std::string message = serialize_heartbeat(sequence_number_, timestamp);
+    remember(sequence_number_++, message);
 
-    ssize_t bytes_sent = send(client_fd, message.data(), message.length(), 0);
-    if (bytes_sent < 0) {
+    if (!send_message(client_fd, message)) {
       LOG_PERROR("Server", "send heartbeat failed");
       return false;
     }
@@ -383,7 +735,20 @@ public:
     keep_running = 0;
     if (server_fd >= 0) {
       close(server_fd);
+      server_fd = -1;
+    }
+    if (snapshot_fd_ >= 0) {
+      shutdown(snapshot_fd_, SHUT_RDWR);  // Wakes the acceptor
+      close(snapshot_fd_);
+      snapshot_fd_ = -1;
     }
+    if (snapshot_acceptor_.joinable()) {
+      snapshot_acceptor_.join();
+    }
+    for (auto& session : snapshot_sessions_) {
+      session.join();
+    }
+    snapshot_sessions_.clear();
   }
 
   ~SnapshotMockServer() { stop(); }
@@ -391,10 +756,16 @@ public:
 
 int main(int argc, char* argv[]) {
   signal(SIGINT, signal_handler);
+  signal(SIGPIPE, SIG_IGN);  // A client vanishing mid-send ends its session, not the server
 
   int port = 9999;
   int heartbeat_interval_ms = 1000;
   int updates_per_second = 10;
+  int checksum_interval_ms = 1000;
+  int corrupt_every = 0;
+  int book_depth = 10;
+  int universe = 3;
+  int snapshot_port = 0;
   
   if (argc > 1) {
     port = std::atoi(argv[1]);
@@ -405,8 +776,25 @@ int main(int argc, char* argv[]) {
   if (argc > 3) {
     updates_per_second = std::atoi(argv[3]);
   }
+  if (argc > 4) {
+    checksum_interval_ms = std::atoi(argv[4]);
+  }
+  if (argc > 5) {
+    corrupt_every = std::atoi(argv[5]);
+  }
+  if (argc > 6) {
+    book_depth = std::max(1, std::atoi(argv[6]));
+  }
+  if (argc > 7) {
+    universe = std::atoi(argv[7]);  // AAPL, MSFT, GOOG plus synthetic symbols
+  }
+  if (argc > 8) {
+    snapshot_port = std::atoi(argv[8]);
+  }
 
-  SnapshotMockServer server(port, heartbeat_interval_ms, updates_per_second);
+  SnapshotMockServer server(port, heartbeat_interval_ms, updates_per_second,
+                            checksum_interval_ms, corrupt_every, book_depth, universe,
+                            snapshot_port);
 
   auto start_result = server.start();
   if (!start_result) {
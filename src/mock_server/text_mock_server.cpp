@@ -1,8 +1,6 @@
-#include <arpa/inet.h>
 #include <chrono>
 #include <cstring>
 #include <iostream>
-#include <netinet/in.h>
 #include <random>
 #include <signal.h>
 #include <sys/socket.h>
@@ -12,6 +10,7 @@
 
 #include "common.hpp"
 #include "text_protocol.hpp"
+#include "transport.hpp"
 
 /**
  * Text Mock Server
@@ -20,6 +19,7 @@
  *   timestamp symbol price volume\n
  *
  * Usage: text_mock_server <port> [msgs_per_sec] [duration_sec]
+ *                         [--transport tcp|unix|unixgram|shm --path <path>]
  */
 
 static volatile sig_atomic_t running = 1;
@@ -30,45 +30,19 @@ void signal_handler(int) {
 
 class TextMockServer {
 public:
-  TextMockServer(int port, int msgs_per_sec, int duration_sec)
-      : port_(port)
+  TextMockServer(Endpoint endpoint, int msgs_per_sec, int duration_sec)
+      : listener_(std::move(endpoint))
       , msgs_per_sec_(msgs_per_sec)
       , duration_sec_(duration_sec)
-      , server_fd_(-1)
       , rng_(42) {}
 
-  ~TextMockServer() {
-    if (server_fd_ >= 0) {
-      close(server_fd_);
-    }
-  }
-
   Result<void> start() {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0) {
-      return Result<void>::error("socket creation failed: " + std::string(strerror(errno)));
-    }
-
-    int opt = 1;
-    setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port_);
-
-    if (bind(server_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-      close(server_fd_);
-      return Result<void>::error("bind failed: " + std::string(strerror(errno)));
-    }
-
-    if (listen(server_fd_, 5) < 0) {
-      close(server_fd_);
-      return Result<void>::error("listen failed: " + std::string(strerror(errno)));
+    auto listening = listener_.listen();
+    if (!listening) {
+      return listening;
     }
 
-    LOG_INFO("Server", "Text Mock Server listening on port %d", port_);
+    LOG_INFO("Server", "Text Mock Server listening on %s", listener_.endpoint().to_string().c_str());
     LOG_INFO("Server", "Sending %d msgs/sec for %d seconds", msgs_per_sec_, duration_sec_);
     LOG_INFO("Server", "Format: timestamp symbol price volume\\n");
 
@@ -79,30 +53,28 @@ public:
     while (running) {
       LOG_INFO("Server", "Waiting for connection...");
 
-      struct sockaddr_in client_addr;
-      socklen_t client_len = sizeof(client_addr);
-      int client_fd = accept(server_fd_, (struct sockaddr*)&client_addr, &client_len);
-
-      if (client_fd < 0) {
+      auto accepted = listener_.accept(200);
+      while (running && !accepted && accepted.error() == "timeout") {
+        accepted = listener_.accept(200);
+      }
+      if (!accepted) {
         if (running) {
-          LOG_PERROR("Server", "accept");
+          LOG_ERROR("Server", "%s", accepted.error().c_str());
         }
         continue;
       }
 
-      char client_ip[INET_ADDRSTRLEN];
-      inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
-      LOG_INFO("Server", "Client connected from %s", client_ip);
+      LOG_INFO("Server", "Client connected from %s", listener_.last_peer().c_str());
 
-      handle_client(client_fd);
+      handle_client(accepted.value());
 
-      close(client_fd);
+      accepted.value().close();
       LOG_INFO("Server", "Client disconnected");
     }
   }
 
 private:
-  void handle_client(int client_fd) {
+  void handle_client(TransportChannel& client) {
     const char* symbols[] = {"AAPL", "GOOG", "MSFT", "AMZN", "TSLA", "META", "NVDA", "AMD"};
     const int num_symbols = sizeof(symbols) / sizeof(symbols[0]);
 
@@ -123,7 +95,9 @@ private:
     // Buffer for batching small writes
     std::string batch_buffer;
     batch_buffer.reserve(64 * 1024);
-    const size_t batch_threshold = 32 * 1024;
+    // A unixgram datagram must fit the reader's 16 KB receive buffer
+    const size_t batch_threshold =
+        client.transport() == Transport::UNIX_DGRAM ? 8 * 1024 : 32 * 1024;
 
     while (running && std::chrono::steady_clock::now() < end_time) {
       // Generate tick
@@ -139,7 +113,7 @@ private:
 
       // Send batch when buffer is large enough or rate limiting kicks in
       if (batch_buffer.size() >= batch_threshold) {
-        if (send(client_fd, batch_buffer.data(), batch_buffer.size(), 0) < 0) {
+        if (!client.send_all(batch_buffer)) {
           LOG_PERROR("Server", "send");
           break;
         }
@@ -164,7 +138,7 @@ private:
 
     // Send remaining data
     if (!batch_buffer.empty()) {
-      send(client_fd, batch_buffer.data(), batch_buffer.size(), 0);
+      client.send_all(batch_buffer);
     }
 
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -177,16 +151,16 @@ private:
     LOG_INFO("Server", "Actual rate: %.1f msgs/sec", messages_sent * 1000.0 / elapsed);
   }
 
-  int port_;
+  TransportListener listener_;
   int msgs_per_sec_;
   int duration_sec_;
-  int server_fd_;
   std::mt19937_64 rng_;
 };
 
 int main(int argc, char* argv[]) {
   if (argc < 2) {
-    LOG_ERROR("Main", "Usage: %s <port> [msgs_per_sec] [duration_sec]", argv[0]);
+    LOG_ERROR("Main", "Usage: %s <port> [msgs_per_sec] [duration_sec] [--transport t --path p]",
+              argv[0]);
     LOG_ERROR("Main", "Example: %s 9999 10000 10", argv[0]);
     LOG_ERROR("Main", "  Sends 10,000 text ticks/sec for 10 seconds");
     LOG_ERROR("Main", "Message format: timestamp symbol price volume\\n");
@@ -194,15 +168,37 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  int port = std::atoi(argv[1]);
-  int msgs_per_sec = (argc > 2) ? std::atoi(argv[2]) : 1000;
-  int duration_sec = (argc > 3) ? std::atoi(argv[3]) : 10;
+  Endpoint endpoint;
+  std::vector<const char*> positional;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--transport" && i + 1 < argc) {
+      auto transport = parse_transport(argv[++i]);
+      if (!transport) {
+        LOG_ERROR("Main", "Unknown transport %s (tcp, unix, unixgram, shm)", argv[i]);
+        return 1;
+      }
+      endpoint.transport = *transport;
+    } else if (arg == "--path" && i + 1 < argc) {
+      endpoint.path = argv[++i];
+    } else {
+      positional.push_back(argv[i]);
+    }
+  }
+  if (endpoint.transport != Transport::TCP && endpoint.path.empty()) {
+    LOG_ERROR("Main", "--transport %s needs --path", transport_name(endpoint.transport));
+    return 1;
+  }
+
+  endpoint.port = positional.size() > 0 ? std::atoi(positional[0]) : 9999;
+  int msgs_per_sec = (positional.size() > 1) ? std::atoi(positional[1]) : 1000;
+  int duration_sec = (positional.size() > 2) ? std::atoi(positional[2]) : 10;
 
   signal(SIGINT, signal_handler);
   signal(SIGTERM, signal_handler);
   signal(SIGPIPE, SIG_IGN);
 
-  TextMockServer server(port, msgs_per_sec, duration_sec);
+  TextMockServer server(endpoint, msgs_per_sec, duration_sec);
 
   auto start_result = server.start();
   if (!start_result) {
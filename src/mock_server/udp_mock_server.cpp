@@ -4,6 +4,7 @@
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <netinet/in.h>
 #include <random>
 #include <sys/socket.h>
@@ -13,6 +14,7 @@
 
 #include "binary_protocol.hpp"
 #include "common.hpp"
+#include "packet_framing.hpp"
 #include "udp_protocol.hpp"
 
 volatile sig_atomic_t keep_running = 1;
@@ -30,27 +32,40 @@ private:
   
   // Message cache for retransmits (sequence -> serialized message)
   std::map<uint64_t, std::string> message_cache_;
+  std::mutex cache_mutex_;  // Feed thread writes, control thread retransmits
   uint64_t sequence_number_;
   
   // Packet loss simulation
   PacketLossConfig loss_config_;
   uint32_t burst_counter_;
-  
+
+  // Multi-message packets (0 = one datagram per message)
+  uint64_t batch_latency_ns_;
+  PacketBatcher batcher_;
+  struct sockaddr_in client_addr_;
+
   // Statistics
   uint64_t messages_sent_;
+  uint64_t packets_sent_;
   uint64_t packets_dropped_;
+  uint64_t bytes_sent_;
   uint64_t retransmits_sent_;
   
 public:
-  UDPMockServer(int udp_port, int tcp_port, const PacketLossConfig& loss_config = PacketLossConfig())
+  UDPMockServer(int udp_port, int tcp_port, const PacketLossConfig& loss_config = PacketLossConfig(),
+                uint64_t batch_latency_ns = 0)
     : udp_port_(udp_port)
     , tcp_port_(tcp_port)
     , rng_(std::random_device{}())
     , sequence_number_(0)
     , loss_config_(loss_config)
     , burst_counter_(0)
+    , batch_latency_ns_(batch_latency_ns)
+    , batcher_("UDPMOCK", MAX_PACKET_SIZE, batch_latency_ns)
     , messages_sent_(0)
+    , packets_sent_(0)
     , packets_dropped_(0)
+    , bytes_sent_(0)
     , retransmits_sent_(0)
   {
     symbols_ = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "META", "NVDA", "JPM "};
@@ -101,6 +116,10 @@ public:
       LOG_INFO("Server", "  Burst loss: %d packets @ %.1f%% probability",
                loss_config_.burst_size, loss_config_.burst_probability * 100.0);
     }
+    if (batch_latency_ns_ > 0) {
+      LOG_INFO("Server", "  Packet framing: up to %zu bytes, flushed after %.0f us",
+               MAX_PACKET_SIZE, batch_latency_ns_ / 1000.0);
+    }
 
     return Result<void>();
   }
@@ -128,11 +147,10 @@ private:
 
     // Client address (will be set when client connects to TCP)
     // For simplicity, we'll broadcast to localhost:udp_port
-    struct sockaddr_in client_addr;
-    memset(&client_addr, 0, sizeof(client_addr));
-    client_addr.sin_family = AF_INET;
-    client_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
-    client_addr.sin_port = htons(udp_port_);
+    memset(&client_addr_, 0, sizeof(client_addr_));
+    client_addr_.sin_family = AF_INET;
+    client_addr_.sin_addr.s_addr = inet_addr("127.0.0.1");
+    client_addr_.sin_port = htons(udp_port_);
 
     auto start_time = std::chrono::steady_clock::now();
 
@@ -143,37 +161,34 @@ private:
                                           tick.symbol, tick.price, tick.volume);
 
       // Cache for retransmits (keep last 10k messages)
-      message_cache_[sequence_number_] = message;
-      if (message_cache_.size() > 10000) {
-        message_cache_.erase(message_cache_.begin());
-      }
-
-      // Simulate packet loss
-      if (should_drop_packet()) {
-        packets_dropped_++;
-
-        if (messages_sent_ % 1000 == 0) {
-          LOG_INFO("UDP", "Dropped packet seq=%lu", sequence_number_);
+      {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        message_cache_[sequence_number_] = message;
+        if (message_cache_.size() > 10000) {
+          message_cache_.erase(message_cache_.begin());
         }
-      } else {
-        // Send UDP packet
-        ssize_t sent = sendto(udp_fd_, message.data(), message.length(), 0,
-                             (struct sockaddr*)&client_addr, sizeof(client_addr));
+      }
 
-        if (sent < 0) {
-          LOG_PERROR("UDP", "sendto failed");
-          break;
+      if (batch_latency_ns_ > 0) {
+        uint64_t now = now_ns();
+        if (!batcher_.append(message, now)) {
+          if (!flush_packet()) break;
+          batcher_.append(message, now);
         }
+        if (batcher_.due(now) && !flush_packet()) break;
+      } else if (!send_packet(message)) {
+        break;
       }
 
       sequence_number_++;
       messages_sent_++;
 
       // Throttle to ~10k msgs/sec
-      if (messages_sent_ % 100 == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if (messages_sent_ % 100 == 0 && !sleep_with_flush(std::chrono::milliseconds(10))) {
+        break;
       }
     }
+    flush_packet();
 
     auto end_time = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -181,8 +196,58 @@ private:
     );
     double seconds = duration.count() / 1000.0;
 
-    LOG_INFO("UDP", "Sent %lu messages in %.2fs (%d msgs/sec)",
-             messages_sent_, seconds, static_cast<int>(messages_sent_ / seconds));
+    LOG_INFO("UDP", "Sent %lu messages in %lu packets in %.2fs (%d msgs/sec, %.1f bytes/msg)",
+             messages_sent_, packets_sent_ + packets_dropped_, seconds,
+             static_cast<int>(messages_sent_ / seconds),
+             static_cast<double>(bytes_sent_) / messages_sent_);
+  }
+
+  // One datagram, subject to simulated loss. False if sendto failed.
+  bool send_packet(std::string_view packet) {
+    if (should_drop_packet()) {
+      packets_dropped_++;
+
+      if (packets_dropped_ % 100 == 0) {
+        LOG_INFO("UDP", "Dropped packet seq=%lu", sequence_number_);
+      }
+      return true;
+    }
+
+    ssize_t sent = sendto(udp_fd_, packet.data(), packet.length(), 0,
+                         (struct sockaddr*)&client_addr_, sizeof(client_addr_));
+    if (sent < 0) {
+      LOG_PERROR("UDP", "sendto failed");
+      return false;
+    }
+    packets_sent_++;
+    bytes_sent_ += sent;
+    return true;
+  }
+
+  bool flush_packet() {
+    if (batcher_.empty()) {
+      return true;
+    }
+    bool ok = send_packet(batcher_.packet());
+    batcher_.clear();
+    return ok;
+  }
+
+  // Sleep, but wake to send a pending packet when its latency budget runs out
+  bool sleep_with_flush(std::chrono::nanoseconds duration) {
+    uint64_t wake = now_ns() + duration.count();
+    if (!batcher_.empty() && batcher_.deadline() < wake) {
+      uint64_t now = now_ns();
+      if (batcher_.deadline() > now) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(batcher_.deadline() - now));
+      }
+      if (!flush_packet()) return false;
+    }
+    uint64_t now = now_ns();
+    if (wake > now) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(wake - now));
+    }
+    return true;
   }
   
   void handle_control_connections() {
@@ -209,6 +274,7 @@ private:
   
   void handle_retransmit_requests(int client_fd) {
     char buffer[1024];
+    std::string pending;  // Requests arrive back to back; frame them all
     
     while (keep_running) {
       ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer), 0);
@@ -216,34 +282,39 @@ private:
       if (bytes_read <= 0) {
         break;  // Client disconnected
       }
+      pending.append(buffer, bytes_read);
       
-      // Parse header
-      if (bytes_read < static_cast<ssize_t>(MessageHeader::HEADER_SIZE)) {
-        continue;
-      }
-      
-      MessageHeader header = deserialize_header(buffer);
-      
-      if (static_cast<UDPMessageType>(header.type) == UDPMessageType::RETRANSMIT_REQUEST) {
-        RetransmitRequest request = deserialize_retransmit_request(
-          buffer + MessageHeader::HEADER_SIZE
-        );
-
-        LOG_INFO("TCP", "Retransmit request: seq %lu to %lu",
-                 request.start_sequence, request.end_sequence);
-
-        // Send requested messages
-        for (uint64_t seq = request.start_sequence; seq <= request.end_sequence; ++seq) {
-          auto it = message_cache_.find(seq);
-          if (it != message_cache_.end()) {
-            ssize_t sent = send(client_fd, it->second.data(), it->second.length(), 0);
-            if (sent < 0) {
-              LOG_PERROR("TCP", "retransmit send failed");
-              return;
+      while (pending.size() >= MessageHeader::HEADER_SIZE) {
+        MessageHeader header = deserialize_header(pending.data());
+        size_t total_size = MessageHeader::HEADER_SIZE + header.length;
+        if (pending.size() < total_size) {
+          break;
+        }
+
+        if (static_cast<UDPMessageType>(header.type) == UDPMessageType::RETRANSMIT_REQUEST &&
+            header.length >= RetransmitRequest::PAYLOAD_SIZE) {
+          RetransmitRequest request = deserialize_retransmit_request(
+            pending.data() + MessageHeader::HEADER_SIZE
+          );
+
+          LOG_INFO("TCP", "Retransmit request: seq %lu to %lu",
+                   request.start_sequence, request.end_sequence);
+
+          // Send requested messages
+          std::lock_guard<std::mutex> lock(cache_mutex_);
+          for (uint64_t seq = request.start_sequence; seq <= request.end_sequence; ++seq) {
+            auto it = message_cache_.find(seq);
+            if (it != message_cache_.end()) {
+              ssize_t sent = send(client_fd, it->second.data(), it->second.length(), MSG_NOSIGNAL);
+              if (sent < 0) {
+                LOG_PERROR("TCP", "retransmit send failed");
+                return;
+              }
+              retransmits_sent_++;
             }
-            retransmits_sent_++;
           }
         }
+        pending.erase(0, total_size);
       }
     }
   }
@@ -290,8 +361,10 @@ private:
   void print_statistics() {
     LOG_INFO("Stats", "=== UDP Server Statistics ===");
     LOG_INFO("Stats", "Messages sent: %lu", messages_sent_);
-    LOG_INFO("Stats", "Packets dropped: %lu (%.1f%%)",
-             packets_dropped_, 100.0 * packets_dropped_ / messages_sent_);
+    LOG_INFO("Stats", "Packets sent: %lu (%.1f messages/packet)", packets_sent_,
+             static_cast<double>(messages_sent_) / (packets_sent_ + packets_dropped_));
+    LOG_INFO("Stats", "Packets dropped: %lu (%.1f%%)", packets_dropped_,
+             100.0 * packets_dropped_ / (packets_sent_ + packets_dropped_));
     LOG_INFO("Stats", "Retransmits sent: %lu", retransmits_sent_);
   }
 };
@@ -302,6 +375,7 @@ int main(int argc, char* argv[]) {
   int udp_port = 9998;
   int tcp_port = 9999;
   double loss_rate = 0.01;  // 1% packet loss
+  uint64_t batch_latency_us = 0;  // 0 = one datagram per message
   
   if (argc > 1) {
     udp_port = std::atoi(argv[1]);
@@ -312,10 +386,13 @@ int main(int argc, char* argv[]) {
   if (argc > 3) {
     loss_rate = std::atof(argv[3]);
   }
+  if (argc > 4) {
+    batch_latency_us = std::strtoull(argv[4], nullptr, 10);
+  }
   
   PacketLossConfig loss_config(loss_rate, 3, 0.002);  // 1% random + occasional 3-packet bursts
   
-  UDPMockServer server(udp_port, tcp_port, loss_config);
+  UDPMockServer server(udp_port, tcp_port, loss_config, batch_latency_us * 1000);
   
   auto start_result = server.start();
   if (!start_result) {
@@ -0,0 +1,292 @@
+/**
+ * Bar Aggregator Tests
+ *
+ * Covers:
+ *   - OHLCV, VWAP and trade counts for two intervals match a brute-force
+ *     rebuild, with batches of every size crossing window boundaries
+ *   - Timer closes (with close_delay_ns), next_close_ns(), late ticks
+ *   - Symbols beyond max_symbols are counted, not aggregated
+ *   - BAR frames: journal file round trip (FeedReplay skips them), shared
+ *     memory publishing with and without a reader
+ *   - BarStage closes live bars on its timer thread
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+#include "bar_aggregator.hpp"
+#include "feed_merge.hpp"
+
+namespace {
+
+constexpr uint64_t MS = 1'000'000;
+constexpr uint64_t SEC = 1'000 * MS;
+
+net::Tick tick(const char *symbol, uint64_t timestamp, double price, int64_t volume) {
+  net::Tick t;
+  std::strncpy(t.symbol, symbol, sizeof(t.symbol) - 1);
+  t.timestamp = timestamp;
+  t.price = price;
+  t.volume = volume;
+  return t;
+}
+
+struct Expected {
+  double open = 0, high = 0, low = 0, close = 0, notional = 0;
+  int64_t volume = 0;
+  uint64_t trades = 0;
+
+  void add(double price, int64_t qty) {
+    if (trades == 0) {
+      open = high = low = price;
+    }
+    high = std::max(high, price);
+    low = std::min(low, price);
+    close = price;
+    notional += price * qty;
+    volume += qty;
+    ++trades;
+  }
+};
+
+using BarKey = std::tuple<uint64_t, std::string, uint64_t>;  // interval, symbol, start
+
+} // namespace
+
+TEST(BarAggregatorTest, MatchesBruteForceAcrossBlocksAndIntervals) {
+  BarAggregatorConfig config;
+  config.intervals_ns = {100 * MS, SEC};
+  BarAggregator aggregator(config);
+  std::vector<Bar> bars;
+  aggregator.set_bar_callback([&](const Bar *b, size_t n) { bars.insert(bars.end(), b, b + n); });
+
+  const char *symbols[] = {"AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA", "BRK.B", "X"};
+  std::mt19937_64 rng(42);
+  std::vector<net::Tick> ticks;
+  std::map<BarKey, Expected> expected;
+  uint64_t ts = 1000 * SEC + 37 * MS;
+  for (int i = 0; i < 50000; ++i) {
+    ts += rng() % (2 * MS);
+    const char *symbol = symbols[rng() % 8];
+    double price = 100.0 + static_cast<double>(rng() % 1000) / 100.0;
+    int64_t volume = 1 + rng() % 500;
+    ticks.push_back(tick(symbol, ts, price, volume));
+    for (uint64_t length : config.intervals_ns) {
+      expected[{length, symbol, ts - ts % length}].add(price, volume);
+    }
+  }
+  for (size_t i = 0; i < ticks.size();) {
+    size_t n = std::min<size_t>(1 + rng() % 700, ticks.size() - i);
+    aggregator.add(&ticks[i], n);
+    i += n;
+  }
+  aggregator.flush();
+
+  ASSERT_EQ(bars.size(), expected.size());
+  for (const Bar &bar : bars) {
+    auto it = expected.find({bar.interval_ns, bar.symbol, bar.start_ns});
+    ASSERT_NE(it, expected.end()) << bar.symbol << " " << bar.start_ns;
+    const Expected &e = it->second;
+    EXPECT_EQ(bar.open, e.open);
+    EXPECT_EQ(bar.high, e.high);
+    EXPECT_EQ(bar.low, e.low);
+    EXPECT_EQ(bar.close, e.close);
+    EXPECT_EQ(bar.volume, e.volume);
+    EXPECT_EQ(bar.trades, e.trades);
+    EXPECT_NEAR(bar.vwap, e.notional / e.volume, 1e-9);
+  }
+  const auto &stats = aggregator.stats();
+  EXPECT_EQ(stats.ticks, ticks.size());
+  EXPECT_EQ(stats.late, 0u);
+  EXPECT_GT(stats.closed_by_tick, 0u);
+  EXPECT_LT(stats.blocks, ticks.size() / 10);  // Mostly whole blocks
+  EXPECT_EQ(aggregator.symbols(), 8u);
+}
+
+TEST(BarAggregatorTest, TimerClosesQuietWindowsAndLateTicksAreCounted) {
+  BarAggregatorConfig config;
+  config.intervals_ns = {SEC};
+  config.close_delay_ns = 200 * MS;
+  BarAggregator aggregator(config);
+  std::vector<Bar> bars;
+  aggregator.set_bar_callback([&](const Bar *b, size_t n) { bars.insert(bars.end(), b, b + n); });
+  EXPECT_EQ(aggregator.next_close_ns(), std::numeric_limits<uint64_t>::max());
+
+  std::vector<net::Tick> ticks = {tick("AAPL", 10 * SEC + 200 * MS, 10.0, 100),
+                                  tick("AAPL", 10 * SEC + 300 * MS, 12.0, 300),
+                                  tick("MSFT", 10 * SEC + 400 * MS, 50.0, 10)};
+  aggregator.add(ticks.data(), ticks.size());
+  Bar partial;
+  ASSERT_TRUE(aggregator.current("AAPL", 0, partial));
+  EXPECT_EQ(partial.trades, 2u);
+  EXPECT_FALSE(aggregator.current("GOOG", 0, partial));
+
+  EXPECT_EQ(aggregator.next_close_ns(), 11 * SEC + 200 * MS);
+  EXPECT_EQ(aggregator.advance(11 * SEC + 199 * MS), 0u);
+  EXPECT_EQ(aggregator.advance(11 * SEC + 200 * MS), 2u);
+  ASSERT_EQ(bars.size(), 2u);
+  EXPECT_STREQ(bars[0].symbol, "AAPL");
+  EXPECT_EQ(bars[0].start_ns, 10 * SEC);
+  EXPECT_EQ(bars[0].open, 10.0);
+  EXPECT_EQ(bars[0].close, 12.0);
+  EXPECT_EQ(bars[0].volume, 400);
+  EXPECT_DOUBLE_EQ(bars[0].vwap, (10.0 * 100 + 12.0 * 300) / 400);
+  EXPECT_EQ(aggregator.window_start(0), 11 * SEC);
+
+  // A straggler for the closed window is late; the next window is quiet
+  net::Tick straggler = tick("AAPL", 10 * SEC + 900 * MS, 11.0, 1);
+  aggregator.add(&straggler, 1);
+  EXPECT_EQ(aggregator.stats().late, 1u);
+  EXPECT_EQ(aggregator.advance(15 * SEC), 0u);
+  EXPECT_EQ(aggregator.window_start(0), 14 * SEC);
+  EXPECT_EQ(aggregator.stats().closed_by_timer, 2u);
+  EXPECT_EQ(bars.size(), 2u);
+}
+
+TEST(BarAggregatorTest, SymbolsBeyondMaxAreCounted) {
+  BarAggregatorConfig config;
+  config.intervals_ns = {SEC};
+  config.max_symbols = 2;
+  BarAggregator aggregator(config);
+  std::vector<net::Tick> ticks = {tick("A", SEC, 1, 1), tick("B", SEC, 1, 1), tick("C", SEC, 1, 1),
+                                  tick("A", SEC, 2, 1)};
+  std::memcpy(ticks[3].symbol, "A\0xyzzy", 8);  // Bytes past the NUL are not the name
+  aggregator.add(ticks.data(), ticks.size());
+  EXPECT_EQ(aggregator.symbols(), 2u);
+  EXPECT_EQ(aggregator.stats().unknown_symbols, 1u);
+  Bar bar;
+  ASSERT_TRUE(aggregator.current("A", 0, bar));
+  EXPECT_EQ(bar.trades, 2u);
+  EXPECT_FALSE(aggregator.current("C", 0, bar));
+  EXPECT_GT(aggregator.footprint_bytes(), 0u);
+}
+
+TEST(BarPublishTest, JournalAndSharedMemoryCarryBarFrames) {
+  std::vector<Bar> bars(3);
+  for (size_t i = 0; i < bars.size(); ++i) {
+    Bar &bar = bars[i];
+    std::memset(&bar, 0, sizeof(bar));
+    std::memcpy(bar.symbol, i == 1 ? "MSFT" : "AAPL", 4);
+    bar.interval_ns = SEC;
+    bar.start_ns = (100 + i) * SEC;
+    bar.open = 10.5;
+    bar.high = 11.25;
+    bar.low = 9.75;
+    bar.close = 10.0 + i;
+    bar.volume = 1000 + i;
+    bar.vwap = 10.125;
+    bar.trades = 7 + i;
+  }
+
+  char path[] = "/tmp/bar_journal_testXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  {
+    auto journal = BarJournal::open(path);
+    ASSERT_TRUE(journal.ok());
+    EXPECT_TRUE(journal.value()->write(bars.data(), 2));
+    EXPECT_TRUE(journal.value()->write(bars.data() + 2, 1));
+    EXPECT_EQ(journal.value()->bars_written(), 3u);
+  }
+  std::string bytes;
+  {
+    std::FILE *f = std::fopen(path, "rb");
+    ASSERT_NE(f, nullptr);
+    char chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) bytes.append(chunk, n);
+    std::fclose(f);
+  }
+  const size_t frame = MessageHeader::HEADER_SIZE + BarPayload::PAYLOAD_SIZE;
+  ASSERT_EQ(bytes.size(), 3 * frame);
+  for (size_t i = 0; i < 3; ++i) {
+    MessageHeader header = deserialize_header(bytes.data() + i * frame);
+    EXPECT_EQ(header.type, MessageType::BAR);
+    EXPECT_EQ(header.sequence, i + 1);
+    BarPayload bar = deserialize_bar(bytes.data() + i * frame + MessageHeader::HEADER_SIZE);
+    EXPECT_EQ(std::string(bar.symbol, 4), i == 1 ? "MSFT" : "AAPL");
+    EXPECT_EQ(bar.interval_ms, 1000u);
+    EXPECT_EQ(bar.start_ns, (100 + i) * SEC);
+    EXPECT_EQ(bar.open, 10.5f);
+    EXPECT_EQ(bar.high, 11.25f);
+    EXPECT_EQ(bar.low, 9.75f);
+    EXPECT_EQ(bar.close, 10.0f + i);
+    EXPECT_EQ(bar.volume, 1000u + i);
+    EXPECT_EQ(bar.vwap, 10.125f);
+    EXPECT_EQ(bar.trades, 7u + i);
+  }
+  // A bar journal is a capture FeedReplay can read past: no ticks in it
+  auto replayed = net::FeedReplay({path}).run([](const net::Tick *, size_t) {});
+  ASSERT_TRUE(replayed.ok());
+  EXPECT_EQ(replayed.value().merged, 0u);
+  EXPECT_EQ(replayed.value().frames_skipped, 3u);
+  unlink(path);
+
+  std::string name = "/bar_publish_test_" + std::to_string(getpid());
+  auto publisher = ShmBarPublisher::create(name, 4096);
+  ASSERT_TRUE(publisher.ok()) << publisher.error();
+  EXPECT_FALSE(publisher.value()->write(bars.data(), 3));  // Nobody attached
+  EXPECT_EQ(publisher.value()->bars_dropped(), 3u);
+
+  auto reader = ShmRing::open(name, 1000);
+  ASSERT_TRUE(reader.ok()) << reader.error();
+  EXPECT_TRUE(publisher.value()->write(bars.data(), 3));
+  std::string received(3 * frame, '\0');
+  size_t got = 0;
+  while (got < received.size()) {
+    ssize_t n = reader.value()->read(&received[got], received.size() - got);
+    ASSERT_GT(n, 0);
+    got += n;
+  }
+  EXPECT_EQ(received, bytes);
+
+  // The ring holds 4096 bytes: a batch that does not fit is dropped whole
+  std::vector<Bar> many(100, bars[0]);
+  EXPECT_FALSE(publisher.value()->write(many.data(), many.size()));
+  EXPECT_EQ(publisher.value()->bars_published(), 3u);
+  EXPECT_EQ(publisher.value()->bars_dropped(), 103u);
+}
+
+TEST(BarStageTest, TimerThreadClosesLiveBars) {
+  BarAggregatorConfig config;
+  config.intervals_ns = {50 * MS};
+  BarStage stage(config);
+  std::mutex mutex;
+  std::vector<Bar> bars;
+  stage.add_sink([&](const Bar *b, size_t n) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bars.insert(bars.end(), b, b + n);
+  });
+  stage.start();
+
+  auto callback = stage.batch_callback();
+  net::Tick live = tick("AAPL", now_ns(), 100.0, 5);
+  callback(&live, 1);
+  // No more ticks: only the timer can close the bar
+  for (int i = 0; i < 50; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!bars.empty()) break;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(bars.size(), 1u);
+    EXPECT_EQ(bars[0].volume, 5);
+  }
+  EXPECT_GE(stage.stats().closed_by_timer, 1u);
+
+  live = tick("MSFT", now_ns(), 50.0, 1);
+  callback(&live, 1);
+  stage.stop();  // Closes the bar in progress
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(bars.size(), 2u);
+  EXPECT_STREQ(bars[1].symbol, "MSFT");
+}
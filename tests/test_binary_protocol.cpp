@@ -27,6 +27,11 @@ TEST_F(BinaryProtocolTest, SizeConstants) {
   EXPECT_EQ(TickPayload::PAYLOAD_SIZE, 20);
   EXPECT_EQ(HeartbeatPayload::PAYLOAD_SIZE, 8);
   EXPECT_EQ(SnapshotRequestPayload::PAYLOAD_SIZE, 4);
+  EXPECT_EQ(BookChecksumPayload::PAYLOAD_SIZE, 12);
+  EXPECT_EQ(SnapshotBeginPayload::PAYLOAD_SIZE, 16);
+  EXPECT_EQ(SnapshotChunkPayload::HEADER_SIZE, 15);
+  EXPECT_EQ(SnapshotEndPayload::PAYLOAD_SIZE, 20);
+  EXPECT_EQ(PartitionSnapshotRequestPayload::PAYLOAD_SIZE, 4);
   EXPECT_EQ(SnapshotResponsePayload::HEADER_SIZE, 6);
   EXPECT_EQ(OrderBookLevel::SIZE, 12);
   EXPECT_EQ(OrderBookUpdatePayload::PAYLOAD_SIZE, 17);
@@ -112,6 +117,39 @@ TEST_F(BinaryProtocolTest, SerializeDeserializeSnapshotRequest) {
   EXPECT_EQ(memcmp(request.symbol, symbol, 4), 0);
 }
 
+TEST_F(BinaryProtocolTest, SerializeDeserializeResumeRequest) {
+  char symbol[4] = {'A', 'A', 'P', 'L'};
+  uint64_t from = 0x0102030405060708ULL;
+
+  std::string message = serialize_resume_request(7, symbol, from);
+  EXPECT_EQ(message.size(), MessageHeader::HEADER_SIZE + ResumeRequestPayload::PAYLOAD_SIZE);
+
+  MessageHeader header = deserialize_header(message.data());
+  EXPECT_EQ(header.length, ResumeRequestPayload::PAYLOAD_SIZE);
+  EXPECT_EQ(header.type, MessageType::RESUME_REQUEST);
+
+  ResumeRequestPayload request = deserialize_resume_request(message.data() + MessageHeader::HEADER_SIZE);
+  EXPECT_EQ(memcmp(request.symbol, symbol, 4), 0);
+  EXPECT_EQ(request.from_sequence, from);
+}
+
+TEST_F(BinaryProtocolTest, SerializeDeserializeBookChecksum) {
+  char symbol[4] = {'M', 'S', 'F', 'T'};
+  uint64_t checksum = 0xfedcba9876543210ULL;
+
+  std::string message = serialize_book_checksum(55, symbol, checksum);
+  EXPECT_EQ(message.size(), MessageHeader::HEADER_SIZE + BookChecksumPayload::PAYLOAD_SIZE);
+
+  MessageHeader header = deserialize_header(message.data());
+  EXPECT_EQ(header.length, BookChecksumPayload::PAYLOAD_SIZE);
+  EXPECT_EQ(header.type, MessageType::BOOK_CHECKSUM);
+  EXPECT_EQ(header.sequence, 55u);
+
+  BookChecksumPayload msg = deserialize_book_checksum(message.data() + MessageHeader::HEADER_SIZE);
+  EXPECT_EQ(memcmp(msg.symbol, symbol, 4), 0);
+  EXPECT_EQ(msg.checksum, checksum);
+}
+
 // Snapshot response serialization/deserialization tests
 TEST_F(BinaryProtocolTest, SerializeDeserializeSnapshotResponse) {
   uint64_t sequence = 300;
@@ -174,6 +212,76 @@ TEST_F(BinaryProtocolTest, SnapshotResponseEmptyBook) {
   EXPECT_TRUE(asks_out.empty());
 }
 
+// Chunked snapshot tests
+TEST_F(BinaryProtocolTest, SerializeDeserializeChunkedSnapshot) {
+  char symbol[4] = {'G', 'O', 'O', 'G'};
+
+  std::string begin = serialize_snapshot_begin(10, symbol, 7, 3000, 2);
+  MessageHeader header = deserialize_header(begin.data());
+  EXPECT_EQ(header.type, MessageType::SNAPSHOT_BEGIN);
+  EXPECT_EQ(header.length, SnapshotBeginPayload::PAYLOAD_SIZE);
+  SnapshotBeginPayload b = deserialize_snapshot_begin(begin.data() + MessageHeader::HEADER_SIZE);
+  EXPECT_EQ(memcmp(b.symbol, symbol, 4), 0);
+  EXPECT_EQ(b.snapshot_id, 7u);
+  EXPECT_EQ(b.num_bid_levels, 3000u);  // Beyond SNAPSHOT_RESPONSE's 255
+  EXPECT_EQ(b.num_ask_levels, 2u);
+
+  std::vector<OrderBookLevel> levels = {{99.5f, 100}, {99.25f, 0x0102030405ULL}, {99.0f, 7}};
+  std::string chunk = serialize_snapshot_chunk(11, symbol, 7, 4, 1, levels.data(), 3);
+  header = deserialize_header(chunk.data());
+  EXPECT_EQ(header.type, MessageType::SNAPSHOT_CHUNK);
+  EXPECT_EQ(header.length, SnapshotChunkPayload::HEADER_SIZE + 3 * OrderBookLevel::SIZE);
+  const char *payload = chunk.data() + MessageHeader::HEADER_SIZE;
+  SnapshotChunkPayload c = deserialize_snapshot_chunk(payload);
+  EXPECT_EQ(c.snapshot_id, 7u);
+  EXPECT_EQ(c.chunk_index, 4u);
+  EXPECT_EQ(c.side, 1);
+  EXPECT_EQ(c.num_levels, 3);
+  for (size_t i = 0; i < levels.size(); ++i) {
+    OrderBookLevel level = deserialize_snapshot_level(payload, i);
+    EXPECT_FLOAT_EQ(level.price, levels[i].price);
+    EXPECT_EQ(level.quantity, levels[i].quantity);
+  }
+
+  std::string end = serialize_snapshot_end(12, symbol, 7, 5, 0xdeadbeefcafef00dULL);
+  header = deserialize_header(end.data());
+  EXPECT_EQ(header.type, MessageType::SNAPSHOT_END);
+  SnapshotEndPayload e = deserialize_snapshot_end(end.data() + MessageHeader::HEADER_SIZE);
+  EXPECT_EQ(e.snapshot_id, 7u);
+  EXPECT_EQ(e.num_chunks, 5u);
+  EXPECT_EQ(e.checksum, 0xdeadbeefcafef00dULL);
+}
+
+TEST_F(BinaryProtocolTest, SerializeDeserializePartitionSnapshotRequest) {
+  std::string message = serialize_partition_snapshot_request(3, 2, 5);
+  MessageHeader header = deserialize_header(message.data());
+  EXPECT_EQ(header.type, MessageType::PARTITION_SNAPSHOT_REQUEST);
+  EXPECT_EQ(header.length, PartitionSnapshotRequestPayload::PAYLOAD_SIZE);
+
+  auto request = deserialize_partition_snapshot_request(message.data() + MessageHeader::HEADER_SIZE);
+  EXPECT_EQ(request.partition, 2);
+  EXPECT_EQ(request.partitions, 5);
+}
+
+TEST_F(BinaryProtocolTest, SymbolPartitionIsStableAndInRange) {
+  const char aapl[4] = {'A', 'A', 'P', 'L'};
+  EXPECT_EQ(symbol_partition(aapl, 1), 0u);
+  EXPECT_EQ(symbol_partition(aapl, 8), symbol_partition(aapl, 8));
+
+  // Spreads a universe over every partition
+  std::vector<size_t> counts(8);
+  for (int i = 0; i < 1000; ++i) {
+    char symbol[4] = {'S', static_cast<char>('0' + i / 100), static_cast<char>('0' + i / 10 % 10),
+                      static_cast<char>('0' + i % 10)};
+    uint32_t partition = symbol_partition(symbol, 8);
+    ASSERT_LT(partition, 8u);
+    counts[partition]++;
+  }
+  for (size_t count : counts) {
+    EXPECT_GT(count, 60u);
+  }
+}
+
 // Order book update serialization/deserialization tests
 TEST_F(BinaryProtocolTest, SerializeDeserializeOrderBookUpdate) {
   uint64_t sequence = 400;
@@ -0,0 +1,257 @@
+/**
+ * Book Checkpoint Tests
+ *
+ * Covers:
+ *   - Empty / new file has no checkpoint
+ *   - Round trip of books, per-book sequences and the sequence watermark
+ *   - Reopening the file (process restart) sees the same data
+ *   - Direct access to mapped levels without rebuilding books
+ *   - Bank alternation and fallback when the latest bank is damaged
+ *   - Invalid headers are reinitialized, capacity and truncation limits
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "book_checkpoint.hpp"
+
+namespace {
+
+std::string temp_path(const char *name) {
+  return "/tmp/test_checkpoint_" + std::string(name) + "_" + std::to_string(getpid());
+}
+
+OrderBook make_book(float mid, int levels) {
+  OrderBook book;
+  for (int i = 1; i <= levels; ++i) {
+    book.apply_update(0, mid - i * 0.01f, 100 * i);
+    book.apply_update(1, mid + i * 0.01f, 200 * i);
+  }
+  return book;
+}
+
+void expect_same_book(const OrderBook &a, const OrderBook &b) {
+  auto a_bids = a.get_top_bids(1000), b_bids = b.get_top_bids(1000);
+  auto a_asks = a.get_top_asks(1000), b_asks = b.get_top_asks(1000);
+  ASSERT_EQ(a_bids.size(), b_bids.size());
+  ASSERT_EQ(a_asks.size(), b_asks.size());
+  for (size_t i = 0; i < a_bids.size(); ++i) {
+    EXPECT_FLOAT_EQ(a_bids[i].price, b_bids[i].price);
+    EXPECT_EQ(a_bids[i].quantity, b_bids[i].quantity);
+  }
+  for (size_t i = 0; i < a_asks.size(); ++i) {
+    EXPECT_FLOAT_EQ(a_asks[i].price, b_asks[i].price);
+    EXPECT_EQ(a_asks[i].quantity, b_asks[i].quantity);
+  }
+}
+
+class BookCheckpointTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = temp_path(::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::remove(path_.c_str());
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  std::unique_ptr<BookCheckpoint> open(uint32_t max_symbols = 8, uint32_t max_levels = 16) {
+    auto result = BookCheckpoint::open(path_, max_symbols, max_levels);
+    EXPECT_TRUE(result.ok()) << result.error();
+    return result.ok() ? std::move(result.value()) : nullptr;
+  }
+
+  std::string path_;
+};
+
+} // namespace
+
+// =============================================================================
+// Basic Round Trip
+// =============================================================================
+
+TEST_F(BookCheckpointTest, NewFileHasNoCheckpoint) {
+  auto cp = open();
+  ASSERT_NE(cp, nullptr);
+  EXPECT_FALSE(cp->load().has_value());
+  EXPECT_EQ(cp->file_size(), BookCheckpoint::file_size_for(8, BookCheckpoint::slot_size_for(16)));
+}
+
+TEST_F(BookCheckpointTest, RoundTripBooksAndSequences) {
+  auto cp = open();
+  OrderBook aapl = make_book(150.0f, 10);
+  OrderBook msft = make_book(300.0f, 3);
+
+  cp->begin();
+  ASSERT_TRUE(cp->add_book("AAPL", aapl, 1001));
+  ASSERT_TRUE(cp->add_book("MSFT", msft, 998));
+  ASSERT_TRUE(cp->commit(1005).ok());
+
+  auto view = cp->load();
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->sequence(), 1005u);
+  ASSERT_EQ(view->size(), 2u);
+  EXPECT_EQ(view->symbol(0), "AAPL");
+  EXPECT_EQ(view->book(0).last_sequence, 1001u);
+  EXPECT_EQ(view->book(1).last_sequence, 998u);
+
+  OrderBook restored;
+  view->restore(view->find("MSFT"), restored);
+  expect_same_book(msft, restored);
+}
+
+TEST_F(BookCheckpointTest, ReopenSeesCommittedData) {
+  OrderBook book = make_book(42.0f, 12);
+  {
+    auto cp = open();
+    cp->begin();
+    cp->add_book("GOOG", book, 77);
+    ASSERT_TRUE(cp->commit(80, true).ok());
+  }
+
+  // Geometry arguments are ignored for an existing file
+  auto result = BookCheckpoint::open(path_, 1, 1);
+  ASSERT_TRUE(result.ok()) << result.error();
+  auto &cp = result.value();
+  EXPECT_EQ(cp->max_symbols(), 8u);
+  EXPECT_EQ(cp->max_levels(), 16u);
+
+  auto view = cp->load();
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->sequence(), 80u);
+
+  OrderBook restored;
+  view->restore(view->find("GOOG"), restored);
+  expect_same_book(book, restored);
+}
+
+TEST_F(BookCheckpointTest, MappedLevelsReadDirectly) {
+  auto cp = open();
+  OrderBook book = make_book(10.0f, 4);
+  cp->begin();
+  cp->add_book("TSLA", book, 5);
+  cp->commit(5);
+
+  auto view = cp->load();
+  ASSERT_TRUE(view.has_value());
+  size_t i = view->find("TSLA");
+  ASSERT_LT(i, view->size());
+  EXPECT_EQ(view->book(i).bid_count, 4u);
+  EXPECT_FLOAT_EQ(view->bids(i)[0].price, 9.99f);   // Best bid first
+  EXPECT_FLOAT_EQ(view->asks(i)[0].price, 10.01f);  // Best ask first
+  EXPECT_EQ(view->asks(i)[0].quantity, 200u);
+  EXPECT_EQ(view->find("NONE"), view->size());
+}
+
+// =============================================================================
+// Banks and Crash Safety
+// =============================================================================
+
+TEST_F(BookCheckpointTest, LatestCommitWins) {
+  auto cp = open();
+  OrderBook book = make_book(1.0f, 2);
+
+  for (uint64_t seq = 10; seq <= 50; seq += 10) {
+    cp->begin();
+    cp->add_book("AAPL", book, seq);
+    ASSERT_TRUE(cp->commit(seq).ok());
+  }
+
+  auto view = cp->load();
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->sequence(), 50u);
+  EXPECT_EQ(view->generation(), 5u);
+  EXPECT_EQ(cp->commits(), 5u);
+}
+
+TEST_F(BookCheckpointTest, DamagedLatestBankFallsBackToPrevious) {
+  {
+    auto cp = open();
+    OrderBook book = make_book(1.0f, 2);
+    cp->begin();
+    cp->add_book("AAPL", book, 10);
+    cp->commit(10);                      // Bank 0, generation 1
+    cp->begin();
+    cp->add_book("AAPL", book, 20);
+    cp->commit(20);                      // Bank 1, generation 2
+  }
+
+  // Flip a byte in bank 1's first slot (simulates a torn write)
+  {
+    std::fstream f(path_, std::ios::in | std::ios::out | std::ios::binary);
+    auto offset = CheckpointFileHeader::RESERVED_SIZE + 8 * BookCheckpoint::slot_size_for(16) +
+                  sizeof(CheckpointBook) + 4;
+    f.seekg(offset);
+    char c = 0;
+    f.read(&c, 1);
+    c ^= 0x5A;
+    f.seekp(offset);
+    f.write(&c, 1);
+  }
+
+  auto cp = open();
+  auto view = cp->load();
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->sequence(), 10u);
+
+  // Next write must not overwrite the only good bank
+  OrderBook book = make_book(2.0f, 1);
+  cp->begin();
+  cp->add_book("AAPL", book, 30);
+  cp->commit(30);
+  view = cp->load();
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->sequence(), 30u);
+}
+
+TEST_F(BookCheckpointTest, InvalidHeaderIsReinitialized) {
+  {
+    std::ofstream f(path_, std::ios::binary);
+    f << "definitely not a checkpoint";
+  }
+
+  auto cp = open();
+  ASSERT_NE(cp, nullptr);
+  EXPECT_FALSE(cp->load().has_value());
+  EXPECT_EQ(cp->max_symbols(), 8u);
+}
+
+// =============================================================================
+// Limits
+// =============================================================================
+
+TEST_F(BookCheckpointTest, SymbolTableCapacity) {
+  auto cp = open(2, 4);
+  OrderBook book = make_book(1.0f, 1);
+  cp->begin();
+  EXPECT_TRUE(cp->add_book("A", book, 1));
+  EXPECT_TRUE(cp->add_book("B", book, 1));
+  EXPECT_FALSE(cp->add_book("C", book, 1));
+  ASSERT_TRUE(cp->commit(1).ok());
+  EXPECT_EQ(cp->load()->size(), 2u);
+}
+
+TEST_F(BookCheckpointTest, DeepBookIsTruncatedAndFlagged) {
+  auto cp = open(2, 4);
+  OrderBook deep = make_book(100.0f, 10);
+  OrderBook shallow = make_book(100.0f, 3);
+
+  cp->begin();
+  cp->add_book("DEEP", deep, 1);
+  cp->add_book("SHLW", shallow, 1);
+  cp->commit(1);
+
+  auto view = cp->load();
+  ASSERT_TRUE(view.has_value());
+  EXPECT_TRUE(view->book(0).flags & CheckpointBook::FLAG_TRUNCATED);
+  EXPECT_EQ(view->book(0).bid_count, 4u);
+  EXPECT_FALSE(view->book(1).flags & CheckpointBook::FLAG_TRUNCATED);
+}
+
+TEST_F(BookCheckpointTest, ZeroGeometryRejected) {
+  EXPECT_FALSE(BookCheckpoint::open(path_, 0, 4).ok());
+  EXPECT_FALSE(BookCheckpoint::open(path_, 4, 0).ok());
+}
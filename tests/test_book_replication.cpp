@@ -0,0 +1,291 @@
+/**
+ * Book Replication Tests
+ *
+ * Covers:
+ *   - New standby receives a full copy, then live changes
+ *   - Periodic checksums verify; a mismatch makes the standby resync
+ *   - A book the primary is recovering is held invalid until its next full copy
+ *   - Primary crash / silence detection time (takeover trigger)
+ *   - Slow standby is dropped instead of blocking the primary
+ *   - A live primary dropping or pausing the standby means resync, not takeover
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+#include "book_replication.hpp"
+
+namespace {
+
+std::string socket_path(const char *name) {
+  return "/tmp/test_repl_" + std::string(name) + "_" + std::to_string(getpid());
+}
+
+// Drive both ends until pred() holds or the deadline passes
+template <typename Pred>
+bool pump(ReplicationPublisher &pub, ReplicationStandby &standby, Pred pred,
+          int timeout_ms = 2000) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  while (std::chrono::steady_clock::now() < deadline) {
+    pub.poll();
+    standby.poll(1);
+    if (pred()) return true;
+  }
+  return false;
+}
+
+OrderBook sample_book() {
+  OrderBook book;
+  for (int i = 1; i <= 5; ++i) {
+    book.apply_update(0, 100.0f - i * 0.01f, 100 * i);
+    book.apply_update(1, 100.0f + i * 0.01f, 50 * i);
+  }
+  return book;
+}
+
+class BookReplicationTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = socket_path(::testing::UnitTest::GetInstance()->current_test_info()->name());
+    pub_ = std::make_unique<ReplicationPublisher>(path_, 16);
+    ASSERT_TRUE(pub_->listen().ok());
+  }
+
+  // Connect a standby and deliver a full copy of `book`
+  void connect_and_sync(ReplicationStandby &standby, const OrderBook &book, uint64_t seq) {
+    ASSERT_TRUE(standby.connect().ok());
+    ASSERT_TRUE(pump(*pub_, standby, [&] { return pub_->has_standby(); }));
+    pub_->publish_book("AAPL", book, seq);
+    ASSERT_TRUE(pump(*pub_, standby, [&] { return standby.checksums_verified() >= 1; }));
+  }
+
+  std::string path_;
+  std::unique_ptr<ReplicationPublisher> pub_;
+};
+
+} // namespace
+
+// =============================================================================
+// Streaming
+// =============================================================================
+
+TEST_F(BookReplicationTest, NewStandbyGetsFullCopy) {
+  OrderBook book = sample_book();
+  ReplicationStandby standby(path_);
+  connect_and_sync(standby, book, 42);
+
+  const auto &books = standby.books();
+  ASSERT_EQ(books.count("AAPL"), 1u);
+  EXPECT_EQ(books.at("AAPL").book.checksum(), book.checksum());
+  EXPECT_EQ(books.at("AAPL").last_sequence, 42u);
+  EXPECT_EQ(standby.last_sequence(), 42u);
+  EXPECT_EQ(standby.checksum_mismatches(), 0u);
+}
+
+TEST_F(BookReplicationTest, LiveChangesAreMirrored) {
+  OrderBook book = sample_book();
+  ReplicationStandby standby(path_);
+  connect_and_sync(standby, book, 10);
+
+  uint64_t seq = 10;
+  for (int i = 0; i < 100; ++i) {
+    uint8_t side = i % 2;
+    float price = 100.0f + (side ? 1 : -1) * (i % 7) * 0.01f;
+    uint64_t qty = (i % 5 == 0) ? 0 : 10 + i;
+    book.apply_update(side, price, static_cast<int64_t>(qty));
+    pub_->publish_update("AAPL", book, side, price, qty, ++seq);
+    if (i % 10 == 0) pub_->publish_sequence(++seq); // e.g. heartbeats
+  }
+
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return standby.last_sequence() == seq; }));
+  EXPECT_EQ(standby.books().at("AAPL").book.checksum(), book.checksum());
+  EXPECT_GE(standby.checksums_verified(), 100u / 16);
+  EXPECT_EQ(standby.checksum_mismatches(), 0u);
+}
+
+TEST_F(BookReplicationTest, InvalidatedBookHeldUntilNextFullCopy) {
+  OrderBook book = sample_book();
+  ReplicationStandby standby(path_);
+  connect_and_sync(standby, book, 5);
+  EXPECT_FALSE(standby.books().at("AAPL").recovering);
+
+  // Primary requested a snapshot: the standby must not keep the old copy
+  pub_->publish_invalidate("AAPL", 5);
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return standby.books().at("AAPL").recovering; }));
+  EXPECT_TRUE(standby.books().at("AAPL").book.empty());
+
+  // Rebuilt book arrives as a full copy
+  OrderBook rebuilt = sample_book();
+  rebuilt.apply_update(0, 99.0f, 7);
+  pub_->publish_book("AAPL", rebuilt, 9);
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return !standby.books().at("AAPL").recovering; }));
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return standby.checksums_verified() >= 2; }));
+  EXPECT_EQ(standby.books().at("AAPL").book.checksum(), rebuilt.checksum());
+  EXPECT_EQ(standby.books().at("AAPL").last_sequence, 9u);
+  EXPECT_EQ(standby.checksum_mismatches(), 0u);
+}
+
+TEST_F(BookReplicationTest, ChecksumMismatchTriggersResync) {
+  OrderBook book = sample_book();
+  ReplicationStandby standby(path_);
+  connect_and_sync(standby, book, 1);
+
+  // Primary claims a state the standby doesn't have
+  OrderBook diverged = book;
+  diverged.apply_update(0, 1.0f, 1);
+  pub_->publish_checksum("AAPL", diverged, 2);
+
+  bool reconnected = false;
+  ASSERT_TRUE(pump(*pub_, standby, [&] {
+    reconnected = reconnected || (pub_->standbys_connected() == 2);
+    return reconnected;
+  }));
+  EXPECT_EQ(standby.checksum_mismatches(), 1u);
+  EXPECT_EQ(standby.resyncs(), 1u);
+  EXPECT_TRUE(standby.books().empty()); // Waiting for the fresh copy
+
+  pub_->publish_book("AAPL", book, 3);
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return standby.books().count("AAPL") == 1 &&
+                                                 standby.checksums_verified() >= 2; }));
+  EXPECT_EQ(standby.books().at("AAPL").book.checksum(), book.checksum());
+}
+
+// =============================================================================
+// Takeover Trigger
+// =============================================================================
+
+TEST_F(BookReplicationTest, PrimaryCrashDetectedImmediately) {
+  OrderBook book = sample_book();
+  ReplicationStandby standby(path_);
+  connect_and_sync(standby, book, 77);
+
+  uint64_t crashed_at = now_ns();
+  pub_.reset(); // Kernel closes the socket, as on a crash
+
+  while (standby.poll(5)) {
+    ASSERT_LT(now_ns() - crashed_at, 1'000'000'000ULL);
+  }
+  uint64_t detect_ns = standby.primary_lost_at_ns() - crashed_at;
+  std::cout << "  Crash detected after " << detect_ns / 1000.0 << " us" << std::endl;
+  EXPECT_LT(detect_ns, 50'000'000ULL);
+
+  // State survives for the takeover
+  EXPECT_EQ(standby.last_sequence(), 77u);
+  EXPECT_EQ(standby.books().at("AAPL").book.checksum(), book.checksum());
+}
+
+TEST_F(BookReplicationTest, SilentPrimaryTimesOut) {
+  ReplicationStandby standby(path_, std::chrono::milliseconds(50));
+  ASSERT_TRUE(standby.connect().ok());
+  pub_->poll(); // Accept, then never poll again (hung primary)
+
+  auto start = std::chrono::steady_clock::now();
+  while (standby.poll(5)) {
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+  }
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+  EXPECT_FALSE(standby.connected());
+}
+
+TEST_F(BookReplicationTest, SlowStandbyIsDroppedNotWaitedFor) {
+  ReplicationStandby standby(path_);
+  ASSERT_TRUE(standby.connect().ok());
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return pub_->has_standby(); }));
+
+  // Standby stops reading; the primary keeps publishing without blocking
+  uint64_t start = now_ns();
+  size_t records = 2 * ReplicationPublisher::MAX_PENDING_BYTES / sizeof(ReplicationRecord);
+  for (size_t i = 0; i < records && pub_->has_standby(); ++i) {
+    pub_->publish_sequence(i + 1);
+    if (i % 1024 == 0) pub_->flush();
+  }
+  pub_->flush();
+
+  EXPECT_FALSE(pub_->has_standby());
+  EXPECT_EQ(pub_->standby_drops(), 1u);
+  EXPECT_EQ(pub_->pending_bytes(), 0u);
+  EXPECT_LT(now_ns() - start, 2'000'000'000ULL);
+}
+
+TEST_F(BookReplicationTest, DroppedLaggingStandbyResyncsInsteadOfTakingOver) {
+  OrderBook book = sample_book();
+  ReplicationStandby standby(path_);
+  connect_and_sync(standby, book, 1);
+
+  // Standby stops reading until the primary gives up on it
+  size_t records = 2 * ReplicationPublisher::MAX_PENDING_BYTES / sizeof(ReplicationRecord);
+  for (size_t i = 0; i < records && pub_->has_standby(); ++i) {
+    pub_->publish_sequence(i + 2);
+    if (i % 1024 == 0) pub_->flush();
+  }
+  pub_->flush();
+  ASSERT_EQ(pub_->standby_drops(), 1u);
+
+  // Reading again it finds the connection closed, but the primary is alive
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (pub_->standbys_connected() < 2) {
+    ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+    pub_->poll();
+    ASSERT_TRUE(standby.poll(1)) << "Standby took over from a live primary";
+  }
+  EXPECT_EQ(standby.primary_lost_at_ns(), 0u);
+  EXPECT_GE(standby.resyncs(), 1u);
+
+  pub_->publish_book("AAPL", book, records + 2);
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return standby.checksums_verified() >= 2; }));
+  EXPECT_TRUE(standby.connected());
+  EXPECT_EQ(standby.books().at("AAPL").book.checksum(), book.checksum());
+}
+
+TEST_F(BookReplicationTest, DisplacedStandbyDoesNotTakeOver) {
+  ReplicationStandby first(path_);
+  ASSERT_TRUE(first.connect().ok());
+  ASSERT_TRUE(pump(*pub_, first, [&] { return pub_->has_standby(); }));
+
+  // Newest wins: the primary closes the first standby's connection
+  ReplicationStandby second(path_);
+  ASSERT_TRUE(second.connect().ok());
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+  while (std::chrono::steady_clock::now() < deadline) {
+    pub_->poll();
+    ASSERT_TRUE(first.poll(1));
+    ASSERT_TRUE(second.poll(1));
+  }
+  EXPECT_EQ(first.primary_lost_at_ns(), 0u);
+  EXPECT_EQ(second.primary_lost_at_ns(), 0u);
+}
+
+TEST_F(BookReplicationTest, StalledPrimaryIsReconnectedNotTakenOver) {
+  // Timeout comfortably above the heartbeat, as in production
+  ReplicationStandby standby(path_, 3 * ReplicationPublisher::HEARTBEAT_INTERVAL);
+  ASSERT_TRUE(standby.connect().ok());
+  ASSERT_TRUE(pump(*pub_, standby, [&] { return standby.records_applied() >= 1; }));
+
+  // Primary pauses past the timeout once, then carries on polling
+  auto resume_at = std::chrono::steady_clock::now() + 4 * ReplicationPublisher::HEARTBEAT_INTERVAL;
+  while (std::chrono::steady_clock::now() < resume_at) {
+    ASSERT_TRUE(standby.poll(5));
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+  while (std::chrono::steady_clock::now() < deadline) {
+    pub_->poll();
+    ASSERT_TRUE(standby.poll(1)) << "Standby took over from a stalled primary";
+  }
+  EXPECT_TRUE(standby.connected());
+  EXPECT_EQ(pub_->standbys_connected(), 2u);
+}
+
+TEST_F(BookReplicationTest, StalePathFromDeadPrimaryIsReplaced) {
+  pub_.reset();
+  { std::ofstream stale(path_); }
+
+  ReplicationPublisher pub(path_);
+  EXPECT_TRUE(pub.listen().ok());
+  ReplicationStandby standby(path_);
+  EXPECT_TRUE(standby.connect().ok());
+}
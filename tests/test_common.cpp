@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <poll.h>
 #include <thread>
 #include <chrono>
 
@@ -198,6 +199,62 @@ TEST(SocketTest, SocketOptionsDefault) {
   EXPECT_EQ(opts.send_buffer_size, 0);
 }
 
+TEST(SocketTest, UnixConnectTellsBusyFromMissing) {
+  const std::string path = "/tmp/test_common_unix_" + std::to_string(getpid());
+  unlink(path.c_str());
+  SocketOptions opts;
+  opts.non_blocking = true;
+
+  auto missing = unix_socket_connect(path, SOCK_STREAM, opts);
+  EXPECT_FALSE(missing.ok());
+  EXPECT_EQ(errno, ENOENT);
+
+  // Nobody accepts: once the queue is full a non-blocking connect fails
+  // with EAGAIN instead of waiting
+  auto listening = unix_socket_listen(path, SOCK_STREAM, 1);
+  ASSERT_TRUE(listening.ok());
+  std::vector<int> queued;
+  int last_errno = 0;
+  for (int i = 0; i < 16; ++i) {
+    auto connected = unix_socket_connect(path, SOCK_STREAM, opts);
+    if (!connected) {
+      last_errno = errno;
+      break;
+    }
+    queued.push_back(connected.value());
+  }
+  EXPECT_EQ(last_errno, EAGAIN);
+  for (int fd : queued) close(fd);
+  close(listening.value());
+  unlink(path.c_str());
+}
+
+TEST(ThreadWakeupTest, NotifyWakesOnlyASleepingConsumer) {
+  ThreadWakeup wakeup;
+  ASSERT_TRUE(wakeup.ok());
+  pollfd pfd{wakeup.fd(), POLLIN, 0};
+
+  // Nobody asleep: notify() costs nothing and leaves the fd quiet
+  wakeup.notify();
+  EXPECT_EQ(poll(&pfd, 1, 0), 0);
+
+  wakeup.prepare_wait();
+  std::thread producer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    wakeup.notify();
+  });
+  uint64_t start = now_ns();
+  EXPECT_EQ(poll(&pfd, 1, 5000), 1);
+  EXPECT_LT(now_ns() - start, 2'000'000'000ULL);
+  producer.join();
+
+  wakeup.finish_wait();
+  EXPECT_EQ(poll(&pfd, 1, 0), 0);  // Drained
+
+  wakeup.signal();  // Unconditional
+  EXPECT_EQ(poll(&pfd, 1, 0), 1);
+}
+
 // =============================================================================
 // Utility Function Tests
 // =============================================================================
@@ -0,0 +1,253 @@
+/**
+ * Compact Tick Encoding Tests
+ *
+ * Covers:
+ *   - Varint and zigzag round trips, fast path against the byte loop
+ *   - Tick batches decode bit-exact, including off-grid prices
+ *   - Symbols defined in-line; keyframes reset and resync
+ *   - A missed message skips deltas until the next keyframe
+ *   - Truncated payloads are rejected
+ *   - BinaryProtocolReader turns COMPACT_TICKS into ticks
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "compact_encoding.hpp"
+#include "net/feed.hpp"
+
+namespace {
+
+TickPayload make_tick(const char* symbol, uint64_t timestamp, float price, int32_t volume) {
+  TickPayload tick;
+  memcpy(tick.symbol, symbol, 4);
+  tick.timestamp = timestamp;
+  tick.price = price;
+  tick.volume = volume;
+  return tick;
+}
+
+std::vector<TickPayload> sample_ticks() {
+  return {
+      make_tick("AAPL", 1'700'000'000'000'000'000ULL, 150.25f, 100),
+      make_tick("MSFT", 1'700'000'000'000'001'500ULL, 310.10f, 200),
+      make_tick("AAPL", 1'700'000'000'000'002'000ULL, 150.26f, 300),
+      make_tick("AAPL", 1'700'000'000'000'001'900ULL, 150.20f, 0),    // Timestamp goes back
+      make_tick("GOOG", 1'700'000'000'000'003'000ULL, 123.4567f, -5), // Off the cent grid
+      make_tick("MSFT", 1'700'000'000'000'003'000ULL, 310.05f, 50),
+  };
+}
+
+struct Decoded {
+  uint64_t sequence;
+  TickPayload tick;
+};
+
+CompactTickDecoder::Status decode(CompactTickDecoder& decoder, const std::string& message,
+                                  std::vector<Decoded>& out) {
+  MessageHeader header = deserialize_header(message.data());
+  EXPECT_EQ(header.type, MessageType::COMPACT_TICKS);
+  EXPECT_EQ(MessageHeader::HEADER_SIZE + header.length, message.size());
+  return decoder.decode(header, message.data() + MessageHeader::HEADER_SIZE,
+                        [&](uint64_t seq, const TickPayload& tick) { out.push_back({seq, tick}); });
+}
+
+void expect_same(const TickPayload& a, const TickPayload& b) {
+  EXPECT_EQ(std::string(a.symbol, 4), std::string(b.symbol, 4));
+  EXPECT_EQ(a.timestamp, b.timestamp);
+  EXPECT_EQ(memcmp(&a.price, &b.price, 4), 0) << a.price << " vs " << b.price;
+  EXPECT_EQ(a.volume, b.volume);
+}
+
+} // namespace
+
+// =============================================================================
+// Varints
+// =============================================================================
+
+TEST(VarintTest, RoundTripEdgeValues) {
+  const uint64_t values[] = {0, 1, 127, 128, 16383, 16384, (1ULL << 56) - 1, 1ULL << 56,
+                             std::numeric_limits<uint64_t>::max()};
+  for (uint64_t value : values) {
+    char buffer[MAX_VARINT_SIZE + 8] = {};
+    size_t n = encode_varint(value, buffer);
+
+    uint64_t fast = 0, slow = 0;
+    EXPECT_EQ(decode_varint(buffer, sizeof(buffer), fast), n) << value;
+    EXPECT_EQ(decode_varint_slow(buffer, n, slow), n) << value;
+    EXPECT_EQ(fast, value);
+    EXPECT_EQ(slow, value);
+  }
+}
+
+TEST(VarintTest, FastPathMatchesByteLoop) {
+  std::mt19937_64 rng(1);
+  std::string buffer;
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t value = rng() >> (rng() % 64);
+    values.push_back(value);
+    append_varint(buffer, value);
+  }
+
+  const char* p = buffer.data();
+  const char* end = p + buffer.size();
+  for (uint64_t expected : values) {
+    uint64_t value = 0;
+    size_t n = decode_varint(p, end - p, value);  // Tail falls back to the loop
+    ASSERT_GT(n, 0u);
+    ASSERT_EQ(value, expected);
+    p += n;
+  }
+  EXPECT_EQ(p, end);
+}
+
+TEST(VarintTest, TruncatedAndOverlongRejected) {
+  char buffer[12];
+  memset(buffer, 0x80, sizeof(buffer));
+  uint64_t value;
+  EXPECT_EQ(decode_varint(buffer, 3, value), 0u);               // Ends mid-varint
+  EXPECT_EQ(decode_varint(buffer, sizeof(buffer), value), 0u);  // Never terminates
+}
+
+TEST(VarintTest, ZigzagKeepsSmallMagnitudesSmall) {
+  EXPECT_EQ(zigzag_encode(0), 0u);
+  EXPECT_EQ(zigzag_encode(-1), 1u);
+  EXPECT_EQ(zigzag_encode(1), 2u);
+  for (int64_t v : {int64_t{-3}, int64_t{12345}, std::numeric_limits<int64_t>::min(),
+                    std::numeric_limits<int64_t>::max()}) {
+    EXPECT_EQ(zigzag_decode(zigzag_encode(v)), v);
+  }
+}
+
+// =============================================================================
+// Tick Batches
+// =============================================================================
+
+TEST(CompactTicksTest, BatchRoundTripsBitExact) {
+  auto ticks = sample_ticks();
+  CompactTickEncoder encoder;
+  std::string message = encoder.encode(100, ticks.data(), ticks.size());
+  EXPECT_LT(message.size(), ticks.size() * (MessageHeader::HEADER_SIZE + TickPayload::PAYLOAD_SIZE) / 2);
+
+  CompactTickDecoder decoder;
+  std::vector<Decoded> out;
+  ASSERT_EQ(decode(decoder, message, out), CompactTickDecoder::Status::DECODED);
+  ASSERT_EQ(out.size(), ticks.size());
+  for (size_t i = 0; i < ticks.size(); ++i) {
+    EXPECT_EQ(out[i].sequence, 100 + i);
+    expect_same(out[i].tick, ticks[i]);
+  }
+}
+
+TEST(CompactTicksTest, DeltasCarryAcrossMessages) {
+  auto ticks = sample_ticks();
+  CompactTickEncoder encoder;
+  std::string first = encoder.encode(1, ticks.data(), 3);
+  std::string second = encoder.encode(4, ticks.data() + 3, 3);
+  EXPECT_EQ(encoder.keyframes(), 1u);
+
+  CompactTickDecoder decoder;
+  std::vector<Decoded> out;
+  ASSERT_EQ(decode(decoder, first, out), CompactTickDecoder::Status::DECODED);
+  ASSERT_EQ(decode(decoder, second, out), CompactTickDecoder::Status::DECODED);
+  ASSERT_EQ(out.size(), 6u);
+  for (size_t i = 0; i < ticks.size(); ++i) {
+    expect_same(out[i].tick, ticks[i]);
+  }
+}
+
+TEST(CompactTicksTest, MissedMessageSkipsUntilKeyframe) {
+  auto ticks = sample_ticks();
+  CompactTickEncoder encoder(4);  // Keyframe once 4 ticks have gone out
+  std::string m1 = encoder.encode(1, ticks.data(), 2);      // Keyframe
+  std::string m2 = encoder.encode(3, ticks.data() + 2, 2);  // Delta (lost)
+  std::string m3 = encoder.encode(5, ticks.data() + 4, 1);  // Keyframe
+  std::string m4 = encoder.encode(6, ticks.data() + 5, 1);  // Delta
+  EXPECT_EQ(encoder.keyframes(), 2u);
+
+  CompactTickDecoder decoder;
+  std::vector<Decoded> out;
+  ASSERT_EQ(decode(decoder, m1, out), CompactTickDecoder::Status::DECODED);
+  // m2 never arrives; m4 alone can't be decoded
+  EXPECT_EQ(decode(decoder, m4, out), CompactTickDecoder::Status::SKIPPED);
+  EXPECT_FALSE(decoder.synced());
+  EXPECT_EQ(out.size(), 2u);
+
+  ASSERT_EQ(decode(decoder, m3, out), CompactTickDecoder::Status::DECODED);
+  ASSERT_EQ(decode(decoder, m4, out), CompactTickDecoder::Status::DECODED);
+  ASSERT_EQ(out.size(), 4u);
+  expect_same(out[2].tick, ticks[4]);
+  expect_same(out[3].tick, ticks[5]);  // MSFT redefined after the keyframe
+  EXPECT_EQ(decoder.skipped_messages(), 1u);
+}
+
+TEST(CompactTicksTest, LateJoinerWaitsForKeyframe) {
+  auto ticks = sample_ticks();
+  CompactTickEncoder encoder;
+  encoder.encode(1, ticks.data(), 3);
+  std::string delta = encoder.encode(4, ticks.data() + 3, 3);
+
+  CompactTickDecoder decoder;
+  std::vector<Decoded> out;
+  EXPECT_EQ(decode(decoder, delta, out), CompactTickDecoder::Status::SKIPPED);
+
+  encoder.force_keyframe();
+  std::string keyframe = encoder.encode(7, ticks.data(), 1);
+  EXPECT_EQ(decode(decoder, keyframe, out), CompactTickDecoder::Status::DECODED);
+  ASSERT_EQ(out.size(), 1u);
+  expect_same(out[0].tick, ticks[0]);
+}
+
+TEST(CompactTicksTest, TruncatedPayloadIsMalformed) {
+  auto ticks = sample_ticks();
+  CompactTickEncoder encoder;
+  std::string message = encoder.encode(1, ticks.data(), ticks.size());
+
+  for (size_t cut : {size_t{1}, size_t{5}, size_t{12}}) {
+    MessageHeader header = deserialize_header(message.data());
+    header.length -= static_cast<uint32_t>(cut);
+    CompactTickDecoder decoder;
+    size_t delivered = 0;
+    EXPECT_EQ(decoder.decode(header, message.data() + MessageHeader::HEADER_SIZE,
+                             [&](uint64_t, const TickPayload&) { delivered++; }),
+              CompactTickDecoder::Status::MALFORMED)
+        << "cut " << cut;
+    EXPECT_LT(delivered, ticks.size());
+    EXPECT_FALSE(decoder.synced());
+  }
+}
+
+// =============================================================================
+// Reader Integration
+// =============================================================================
+
+TEST(CompactTicksTest, BinaryReaderDecodesCompactFrames) {
+  SPSCQueue<net::Tick> queue(64);
+  std::atomic<bool> stop{false};
+  StageMonitor monitor;
+  net::BinaryProtocolReader reader(-1, queue, stop, false, monitor);
+
+  auto ticks = sample_ticks();
+  CompactTickEncoder encoder;
+  std::string frames = serialize_tick(1, 10, "TSLA", 200.0f, 1) +
+                       encoder.encode(2, ticks.data(), ticks.size());
+  EXPECT_EQ(reader.parse_frames(frames.data(), frames.size(), 42), frames.size());
+  EXPECT_EQ(reader.messages_parsed(), 1 + ticks.size());
+  EXPECT_EQ(reader.parse_errors(), 0u);
+
+  ASSERT_TRUE(queue.pop().has_value());  // The plain TICK
+  for (const auto& expected : ticks) {
+    auto tick = queue.pop();
+    ASSERT_TRUE(tick.has_value());
+    EXPECT_EQ(std::string(tick->symbol), trim_symbol(expected.symbol, 4));
+    EXPECT_EQ(tick->timestamp, expected.timestamp);
+    EXPECT_EQ(tick->price, static_cast<double>(expected.price));
+    EXPECT_EQ(tick->volume, expected.volume);
+    EXPECT_EQ(tick->recv_timestamp_ns, 42u);
+  }
+}
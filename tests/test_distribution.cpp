@@ -0,0 +1,311 @@
+/**
+ * Local Distribution Tests
+ *
+ * Covers:
+ *   - Each subscriber receives exactly its symbols, in publish order, with
+ *     the shared event sequence
+ *   - Resubscribing and SUBSCRIBE * change routing on the fly
+ *   - Ticks and book updates arrive as regular binary protocol frames
+ *   - Events nobody wants never reach the frame log
+ *   - A subscriber that stops reading is evicted (ring full, or lapped by
+ *     the log) while the others keep receiving everything
+ *   - Symbols too long for the feed are refused, not truncated into a match
+ *   - An idle server sleeps in wait() until a wakeup or a subscriber
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "distribution.hpp"
+#include "message_views.hpp"
+
+namespace {
+
+std::string socket_path(const char* name) {
+  return "/tmp/dist_test_" + std::to_string(getpid()) + "_" + name;
+}
+
+struct Received {
+  std::vector<std::string> symbols;
+  std::vector<uint64_t> sequences;
+  std::vector<MessageType> types;
+};
+
+struct TestSubscriber {
+  DistributionClient client;
+  Received got;
+  bool alive = true;
+
+  explicit TestSubscriber(const std::string& path) : client(path) {
+    EXPECT_TRUE(client.connect().ok());
+  }
+
+  void poll() {
+    if (!alive) return;
+    alive = client.poll(0, [&](const MessageHeader& header, const char* payload) {
+      got.sequences.push_back(header.sequence);
+      got.types.push_back(header.type);
+      got.symbols.emplace_back(header.type == MessageType::TICK
+                                   ? TickView(payload).symbol()
+                                   : BookUpdateView(payload).symbol());
+    });
+  }
+};
+
+// Run the server and the subscribers until `done` or 2 seconds
+template <typename Done>
+bool pump(DistributionServer& server, std::vector<TestSubscriber*> subs, Done&& done) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (std::chrono::steady_clock::now() < deadline) {
+    server.poll();
+    for (auto* sub : subs) sub->poll();
+    if (done()) return true;
+  }
+  return false;
+}
+
+// Let the server see the connections and the requests
+void settle(DistributionServer& server, size_t subscribers) {
+  pump(server, {}, [&] { return server.subscribers() == subscribers; });
+  for (int i = 0; i < 20; ++i) {
+    server.poll();
+    usleep(1000);
+  }
+}
+
+} // namespace
+
+TEST(DistributionTest, RoutesEachSubscriberItsSymbols) {
+  DistributionServer server(socket_path("route"));
+  ASSERT_TRUE(server.listen().ok());
+
+  TestSubscriber a(server.path()), b(server.path()), c(server.path());
+  ASSERT_TRUE(a.client.subscribe({"AAPL", "MSFT"}).ok());
+  ASSERT_TRUE(b.client.subscribe({"MSFT", "TSLA"}).ok());  // Overlaps a
+  ASSERT_TRUE(c.client.subscribe({"IBM"}).ok());
+  settle(server, 3);
+
+  const char* stream[] = {"AAPL", "MSFT", "GOOG", "TSLA", "MSFT", "AAPL", "TSLA"};
+  for (const char* symbol : stream) {
+    server.publish_tick(1, symbol, 1.0f, 1);
+  }
+  ASSERT_TRUE(pump(server, {&a, &b, &c}, [&] {
+    return a.got.symbols.size() == 4 && b.got.symbols.size() == 4;
+  }));
+
+  EXPECT_EQ(a.got.symbols, (std::vector<std::string>{"AAPL", "MSFT", "MSFT", "AAPL"}));
+  EXPECT_EQ(a.got.sequences, (std::vector<uint64_t>{1, 2, 5, 6}));
+  EXPECT_EQ(b.got.symbols, (std::vector<std::string>{"MSFT", "TSLA", "MSFT", "TSLA"}));
+  EXPECT_EQ(b.got.sequences, (std::vector<uint64_t>{2, 4, 5, 7}));
+  EXPECT_TRUE(c.got.symbols.empty());
+
+  EXPECT_EQ(server.events_published(), 7u);
+  EXPECT_EQ(server.frames_routed(), 8u);  // Shared frames referenced twice
+  EXPECT_EQ(server.slow_evictions(), 0u);
+}
+
+TEST(DistributionTest, ResubscribeAndWildcard) {
+  DistributionServer server(socket_path("resub"));
+  ASSERT_TRUE(server.listen().ok());
+
+  TestSubscriber sub(server.path());
+  ASSERT_TRUE(sub.client.subscribe({"AAPL"}).ok());
+  settle(server, 1);
+  server.publish_tick(1, "AAPL", 1.0f, 1);
+  server.publish_tick(1, "MSFT", 1.0f, 1);
+
+  ASSERT_TRUE(sub.client.subscribe({"MSFT"}).ok());
+  settle(server, 1);
+  server.publish_tick(1, "AAPL", 1.0f, 1);
+  server.publish_tick(1, "MSFT", 1.0f, 1);
+
+  ASSERT_TRUE(sub.client.subscribe_all().ok());
+  settle(server, 1);
+  server.publish_tick(1, "AAPL", 1.0f, 1);
+  server.publish_book_update("GOOG", 1, 2.0f, 300);
+
+  ASSERT_TRUE(pump(server, {&sub}, [&] { return sub.got.symbols.size() == 4; }));
+  EXPECT_EQ(sub.got.symbols, (std::vector<std::string>{"AAPL", "MSFT", "AAPL", "GOOG"}));
+  EXPECT_EQ(sub.got.types.back(), MessageType::ORDER_BOOK_UPDATE);
+  EXPECT_EQ(sub.got.sequences, (std::vector<uint64_t>{1, 4, 5, 6}));
+}
+
+TEST(DistributionTest, FramesMatchTheWireFormat) {
+  DistributionServer server(socket_path("wire"));
+  ASSERT_TRUE(server.listen().ok());
+
+  DistributionClient client(server.path());
+  ASSERT_TRUE(client.connect().ok());
+  ASSERT_TRUE(client.subscribe({"MSFT"}).ok());
+  settle(server, 1);
+
+  DistributionEvent tick;
+  memcpy(tick.symbol, "MSFT", 4);
+  tick.timestamp = 123456789;
+  tick.price = 410.5f;
+  tick.quantity = 250;
+  server.publish(tick);
+  server.publish_book_update("MSFT", 1, 411.0f, -7);
+
+  std::vector<std::string> frames;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (frames.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+    server.poll();
+    client.poll(1, [&](const MessageHeader& header, const char* payload) {
+      frames.emplace_back(payload - MessageHeader::HEADER_SIZE,
+                          MessageHeader::HEADER_SIZE + header.length);
+    });
+  }
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0], serialize_tick(1, 123456789, "MSFT", 410.5f, 250));
+  EXPECT_EQ(frames[1], serialize_order_book_update(2, "MSFT", 1, 411.0f, -7));
+}
+
+TEST(DistributionTest, UnwantedEventsSkipTheLog) {
+  DistributionServer server(socket_path("skip"));
+  ASSERT_TRUE(server.listen().ok());
+  for (int i = 0; i < 1000; ++i) {
+    server.publish_tick(i, "AAPL", 1.0f, 1);  // No subscribers yet
+  }
+  EXPECT_EQ(server.events_published(), 1000u);
+  EXPECT_EQ(server.frames_routed(), 0u);
+  EXPECT_FALSE(server.poll());
+}
+
+TEST(DistributionTest, FullRingEvictsOnlyTheSlowSubscriber) {
+  DistributionServer server(socket_path("ring"), DistributionServer::DEFAULT_LOG_BYTES, 1024);
+  ASSERT_TRUE(server.listen().ok());
+
+  TestSubscriber fast(server.path());
+  DistributionClient slow(server.path());  // Never reads
+  ASSERT_TRUE(slow.connect().ok());
+  ASSERT_TRUE(fast.client.subscribe({"AAPL"}).ok());
+  ASSERT_TRUE(slow.subscribe({"AAPL"}).ok());
+  settle(server, 2);
+
+  // Far more than the slow subscriber's socket buffer plus its 1024-frame ring
+  const size_t total = 200000;
+  size_t published = 0;
+  ASSERT_TRUE(pump(server, {&fast}, [&] {
+    for (int i = 0; i < 256 && published < total; ++i, ++published) {
+      server.publish_tick(published, "AAPL", 1.0f, 1);
+    }
+    return fast.got.symbols.size() == total;
+  }));
+
+  EXPECT_EQ(server.slow_evictions(), 1u);
+  EXPECT_EQ(server.subscribers(), 1u);
+  EXPECT_TRUE(fast.alive);
+  for (size_t i = 1; i < fast.got.sequences.size(); ++i) {
+    ASSERT_EQ(fast.got.sequences[i], fast.got.sequences[i - 1] + 1);  // Nothing lost
+  }
+
+  // The slow subscriber drains what the kernel held, then sees the close
+  uint64_t drained = 0;
+  while (slow.poll(100, [&](const MessageHeader&, const char*) { drained++; })) {
+  }
+  EXPECT_GT(drained, 0u);
+  EXPECT_LT(drained, total);
+}
+
+TEST(DistributionTest, LogWrapEvictsLaggingSubscriber) {
+  // 64 KiB log: a few thousand frames. The lagging subscriber's ring is big
+  // enough, so the log catching up with its oldest frame is what evicts it.
+  DistributionServer server(socket_path("wrap"), 64 * 1024, 1 << 20);
+  ASSERT_TRUE(server.listen().ok());
+
+  TestSubscriber fast(server.path());
+  DistributionClient slow(server.path());
+  ASSERT_TRUE(slow.connect().ok());
+  ASSERT_TRUE(fast.client.subscribe_all().ok());
+  ASSERT_TRUE(slow.subscribe({"MSFT"}).ok());
+  settle(server, 2);
+
+  const size_t total = 100000;
+  size_t published = 0;
+  ASSERT_TRUE(pump(server, {&fast}, [&] {
+    for (int i = 0; i < 64 && published < total; ++i, ++published) {
+      server.publish_tick(published, (published % 4 == 0) ? "MSFT" : "AAPL", 1.0f, 1);
+    }
+    return fast.got.symbols.size() == total;
+  }));
+
+  EXPECT_EQ(server.slow_evictions(), 1u);
+  EXPECT_TRUE(fast.alive);
+
+  // Whatever the slow subscriber did get is intact and in order
+  uint64_t last = 0;
+  bool ordered = true;
+  while (slow.poll(100, [&](const MessageHeader& header, const char* payload) {
+    ordered &= header.sequence > last && TickView(payload).symbol() == "MSFT";
+    last = header.sequence;
+  })) {
+  }
+  EXPECT_TRUE(ordered);
+}
+
+TEST(DistributionTest, OverlongSymbolIsRejectedNotTruncated) {
+  const std::string path = socket_path("overlong");
+  DistributionServer server(path);
+  ASSERT_TRUE(server.listen().ok());
+
+  TestSubscriber sub(path);
+  ASSERT_TRUE(sub.client.subscribe({"GOOG"}).ok());
+  settle(server, 1);
+  EXPECT_FALSE(sub.client.subscribe({"GOOGL"}).ok());  // Caught before sending
+
+  // A raw request gets a SUBSCRIBE_REJECT and changes nothing
+  const std::string request = "SUBSCRIBE GOOGL,MSFT\n";
+  ASSERT_EQ(send(sub.client.fd(), request.data(), request.size(), 0),
+            static_cast<ssize_t>(request.size()));
+  ASSERT_TRUE(pump(server, {&sub}, [&] { return !sub.client.rejection().empty(); }));
+  EXPECT_NE(sub.client.rejection().find("GOOGL"), std::string::npos);
+  EXPECT_EQ(sub.client.messages_received(), 0u);
+
+  server.publish_tick(1, "MSFT", 1.0f, 1);
+  server.publish_tick(1, "GOOG", 1.0f, 1);
+  ASSERT_TRUE(pump(server, {&sub}, [&] { return sub.got.symbols.size() == 1; }));
+  EXPECT_EQ(sub.got.symbols[0], "GOOG");
+}
+
+TEST(DistributionTest, IdleWaitSleepsUntilThereIsWork) {
+  const std::string path = socket_path("wait");
+  DistributionServer server(path);
+  ASSERT_TRUE(server.listen().ok());
+  ThreadWakeup wakeup;
+  ASSERT_TRUE(wakeup.ok());
+
+  // Nothing to do: the whole timeout passes
+  uint64_t start = now_ns();
+  server.wait(50, wakeup.fd());
+  EXPECT_GE(now_ns() - start, 40'000'000ULL);
+
+  // Producer wakeup
+  wakeup.prepare_wait();
+  wakeup.notify();
+  start = now_ns();
+  server.wait(5000, wakeup.fd());
+  EXPECT_LT(now_ns() - start, 1'000'000'000ULL);
+  wakeup.finish_wait();
+
+  // A connecting subscriber wakes it, and the next poll() accepts it
+  server.poll();
+  TestSubscriber sub(path);
+  start = now_ns();
+  server.wait(5000, wakeup.fd());
+  EXPECT_LT(now_ns() - start, 1'000'000'000ULL);
+  server.poll();
+  EXPECT_EQ(server.subscribers(), 1u);
+
+  // Its request does too
+  ASSERT_TRUE(sub.client.subscribe({"AAPL"}).ok());
+  server.wait(5000, wakeup.fd());
+  server.poll();
+  server.publish_tick(1, "AAPL", 150.0f, 100);
+  server.poll();
+  EXPECT_TRUE(pump(server, {&sub}, [&] { return sub.got.symbols.size() == 1; }));
+}
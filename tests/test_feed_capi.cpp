@@ -0,0 +1,258 @@
+/**
+ * Embeddable Feed Library Tests
+ *
+ * Covers, through libfeed.so and nothing but feed_capi.h:
+ *   - Config defaults, validation, and callers built against a shorter struct
+ *   - Batch callbacks on the processor thread: every tick, in order, in runs
+ *     no longer than max_batch
+ *   - Book reads: refused from other threads while running, allowed from
+ *     the callback and once stopped
+ *   - Subscriptions and metrics, including a truncated metrics struct
+ *   - Start failures and stop from inside the callback
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "feed_capi.h"
+#include "tick_server.hpp"
+
+namespace {
+
+// Tick i carries timestamp i, so order is checkable on the far side
+std::string ticks(size_t count, const char *const *symbols, size_t symbol_count) {
+  std::string frames;
+  for (size_t i = 0; i < count; ++i) {
+    frames += serialize_tick(i + 1, i, symbols[i % symbol_count],
+                             100.0f + static_cast<float>(i % 10), static_cast<int32_t>(i + 1));
+  }
+  return frames;
+}
+
+feed_config binary_config(uint16_t port) {
+  feed_config config;
+  feed_config_init(&config);
+  config.port = port;
+  config.protocol = FEED_PROTOCOL_BINARY;
+  config.queue_size = 1 << 16;
+  return config;
+}
+
+struct Seen {
+  std::vector<uint64_t> timestamps;
+  std::vector<std::string> symbols;
+  size_t largest_batch = 0;
+  std::thread::id thread;
+  feed_handler *feed = nullptr;
+  int book_read = FEED_EINVAL;
+  int stop_from_callback = FEED_OK;
+};
+
+void record(const feed_tick *ticks, size_t count, void *user_data) {
+  Seen &seen = *static_cast<Seen *>(user_data);
+  seen.thread = std::this_thread::get_id();
+  seen.largest_batch = std::max(seen.largest_batch, count);
+  for (size_t i = 0; i < count; ++i) {
+    seen.timestamps.push_back(ticks[i].timestamp);
+    seen.symbols.emplace_back(ticks[i].symbol);
+  }
+}
+
+} // namespace
+
+TEST(FeedCapiTest, ConfigDefaultsAndValidation) {
+  EXPECT_EQ(feed_abi_version(), static_cast<uint32_t>(FEED_ABI_VERSION));
+
+  feed_config config;
+  feed_config_init(&config);
+  EXPECT_EQ(config.struct_size, sizeof(feed_config));
+  EXPECT_STREQ(config.host, "127.0.0.1");
+  EXPECT_STREQ(config.transport, "tcp");
+  EXPECT_EQ(config.max_batch, 256u);
+
+  EXPECT_EQ(feed_create(nullptr), nullptr);
+  EXPECT_EQ(feed_create(&config), nullptr);  // tcp needs a port
+
+  config.port = 9;
+  config.transport = "carrier-pigeon";
+  EXPECT_EQ(feed_create(&config), nullptr);
+  config.transport = "unix";
+  EXPECT_EQ(feed_create(&config), nullptr);  // ... and unix a path
+  config.path = "/tmp/feed.sock";
+  feed_handler *feed = feed_create(&config);
+  EXPECT_NE(feed, nullptr);
+  feed_destroy(feed);
+
+  // A caller built before the later fields existed gets their defaults
+  feed_config old_caller;
+  std::memset(&old_caller, 0xff, sizeof(old_caller));
+  old_caller.struct_size = offsetof(feed_config, queue_size);
+  old_caller.host = "127.0.0.1";
+  old_caller.port = 9;
+  old_caller.protocol = FEED_PROTOCOL_BINARY;
+  feed = feed_create(&old_caller);
+  EXPECT_NE(feed, nullptr);
+  feed_destroy(feed);
+
+  EXPECT_EQ(feed_start(nullptr), FEED_EINVAL);
+  EXPECT_EQ(feed_stop(nullptr), FEED_EINVAL);
+  feed_destroy(nullptr);
+}
+
+TEST(FeedCapiTest, BatchesArriveInOrderOnProcessorThread) {
+  const char *symbols[] = {"AAPL", "MSFT", "GOOG"};
+  TickServer server;
+  server.serve(ticks(5000, symbols, 3));
+
+  feed_config config = binary_config(server.port());
+  config.max_batch = 64;
+  feed_handler *feed = feed_create(&config);
+  ASSERT_NE(feed, nullptr);
+  Seen seen;
+  ASSERT_EQ(feed_set_batch_callback(feed, record, &seen), FEED_OK);
+  ASSERT_EQ(feed_start(feed), FEED_OK);
+  EXPECT_EQ(feed_set_batch_callback(feed, record, &seen), FEED_ESTATE);
+  EXPECT_EQ(feed_start(feed), FEED_ESTATE);
+  ASSERT_EQ(feed_wait(feed), FEED_OK);
+
+  ASSERT_EQ(seen.timestamps.size(), 5000u);
+  for (size_t i = 0; i < seen.timestamps.size(); ++i) {
+    ASSERT_EQ(seen.timestamps[i], i);
+  }
+  EXPECT_EQ(seen.symbols[4], "MSFT");
+  EXPECT_LE(seen.largest_batch, 64u);
+  EXPECT_NE(seen.thread, std::this_thread::get_id());
+  feed_destroy(feed);
+}
+
+TEST(FeedCapiTest, BookReadsOnlyWhileProcessorStateIsOwned) {
+  const char *symbols[] = {"AAPL", "MSFT"};
+  TickServer server;
+  server.serve(ticks(100, symbols, 2));
+
+  feed_config config = binary_config(server.port());
+  config.books = 1;
+  feed_handler *feed = feed_create(&config);
+  ASSERT_NE(feed, nullptr);
+  Seen seen;
+  seen.feed = feed;
+  feed_set_batch_callback(
+      feed,
+      [](const feed_tick *, size_t, void *user_data) {
+        Seen &s = *static_cast<Seen *>(user_data);
+        feed_level bids[4];
+        size_t bid_count = 4, ask_count = 0;
+        s.book_read = feed_read_book(s.feed, "AAPL", bids, &bid_count, nullptr, &ask_count);
+        s.stop_from_callback = feed_stop(s.feed);
+      },
+      &seen);
+  ASSERT_EQ(feed_start(feed), FEED_OK);
+
+  // Running until feed_wait(): the processor thread owns the books
+  feed_level bids[16];
+  size_t bid_count = 16, ask_count = 0;
+  EXPECT_EQ(feed_read_book(feed, "AAPL", bids, &bid_count, nullptr, &ask_count), FEED_ESTATE);
+  ASSERT_EQ(feed_wait(feed), FEED_OK);
+
+  EXPECT_EQ(seen.book_read, FEED_OK);
+  EXPECT_EQ(seen.stop_from_callback, FEED_ESTATE);
+
+  // AAPL got the even ticks: prices 100, 102, ..., 108, best bid first
+  bid_count = 16;
+  memset(bids, 0xAB, sizeof(bids));
+  ASSERT_EQ(feed_read_book(feed, "AAPL", bids, &bid_count, nullptr, &ask_count), FEED_OK);
+  ASSERT_EQ(bid_count, 5u);
+  EXPECT_EQ(ask_count, 0u);
+  EXPECT_FLOAT_EQ(bids[0].price, 108.0f);
+  EXPECT_EQ(bids[0].quantity, 99u);  // Tick 98 was the last at 108
+  EXPECT_FLOAT_EQ(bids[4].price, 100.0f);
+  for (size_t i = 0; i < bid_count; ++i) {
+    EXPECT_EQ(bids[i].reserved, 0u) << i;  // Never whatever the caller's buffer held
+  }
+
+  bid_count = 2;
+  ASSERT_EQ(feed_read_book(feed, "AAPL", bids, &bid_count, nullptr, &ask_count), FEED_OK);
+  EXPECT_EQ(bid_count, 2u);
+  EXPECT_EQ(feed_read_book(feed, "TSLA", bids, &bid_count, nullptr, &ask_count), FEED_ENOTFOUND);
+  feed_destroy(feed);
+
+  // No books kept
+  feed_config plain = binary_config(9);
+  feed = feed_create(&plain);
+  EXPECT_EQ(feed_read_book(feed, "AAPL", bids, &bid_count, nullptr, &ask_count), FEED_ENOTFOUND);
+  feed_destroy(feed);
+}
+
+TEST(FeedCapiTest, SubscriptionAndMetrics) {
+  const char *symbols[] = {"AAPL", "MSFT", "GOOG", "AMZN"};
+  TickServer server;
+  server.serve(ticks(400, symbols, 4));
+
+  const char *wanted[] = {"MSFT"};
+  feed_config config = binary_config(server.port());
+  config.symbols = wanted;
+  config.symbol_count = 1;
+  feed_handler *feed = feed_create(&config);
+  ASSERT_NE(feed, nullptr);
+  Seen seen;
+  feed_set_batch_callback(feed, record, &seen);
+  ASSERT_EQ(feed_start(feed), FEED_OK);
+
+  feed_metrics running{};
+  running.struct_size = sizeof(running);
+  ASSERT_EQ(feed_get_metrics(feed, &running), FEED_OK);
+  EXPECT_EQ(running.running, 1);
+  EXPECT_EQ(running.latency_p50_ns, 0u);  // Not this thread's to read yet
+  ASSERT_EQ(feed_wait(feed), FEED_OK);
+
+  ASSERT_EQ(seen.symbols.size(), 100u);
+  for (const auto &symbol : seen.symbols) {
+    ASSERT_EQ(symbol, "MSFT");
+  }
+
+  feed_metrics metrics{};
+  metrics.struct_size = sizeof(metrics);
+  ASSERT_EQ(feed_get_metrics(feed, &metrics), FEED_OK);
+  EXPECT_EQ(metrics.running, 0);
+  EXPECT_EQ(metrics.ticks_processed, 100u);
+  EXPECT_EQ(metrics.queue_depth, 0u);
+  EXPECT_EQ(metrics.messages_parsed, 100u);
+  EXPECT_EQ(metrics.messages_filtered, 300u);
+  EXPECT_GT(metrics.latency_p50_ns, 0u);
+  EXPECT_GE(metrics.latency_p99_ns, metrics.latency_p50_ns);
+  EXPECT_GE(metrics.memory_reserved_bytes, metrics.memory_in_use_bytes);
+  EXPECT_GT(metrics.memory_in_use_bytes, 0u);  // Latency samples
+
+  // A caller that only knows the first fields gets only those written
+  feed_metrics old_caller;
+  std::memset(&old_caller, 0xab, sizeof(old_caller));
+  old_caller.struct_size = offsetof(feed_metrics, running);
+  ASSERT_EQ(feed_get_metrics(feed, &old_caller), FEED_OK);
+  EXPECT_EQ(old_caller.ticks_processed, 100u);
+  EXPECT_EQ(old_caller.messages_parsed, 0xababababababababULL);
+
+  EXPECT_EQ(feed_subscribe(feed, nullptr, 0), FEED_OK);
+  EXPECT_EQ(feed_subscribe(feed, nullptr, 1), FEED_EINVAL);
+  feed_destroy(feed);
+}
+
+TEST(FeedCapiTest, StartFailsWithoutServer) {
+  uint16_t port;
+  {
+    TickServer closed;  // Grab a free port, then release it
+    port = closed.port();
+  }
+  feed_config config = binary_config(port);
+  feed_handler *feed = feed_create(&config);
+  ASSERT_NE(feed, nullptr);
+  EXPECT_EQ(feed_start(feed), FEED_ECONNECT);
+  feed_destroy(feed);
+}
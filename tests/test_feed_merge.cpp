@@ -0,0 +1,274 @@
+/**
+ * Multi-Feed Merge Tests
+ *
+ * Covers:
+ *   - TournamentTree: winner is the smallest key (lowest index on ties)
+ *     through random updates, leaves going empty, non-power-of-two sizes
+ *   - FeedMerger: interleaved inputs come out in timestamp order in
+ *     batches; a quiet open input holds the merge until the lateness bound;
+ *     late ticks passed through or dropped; closed inputs finish
+ *   - FeedReplay: capture files (TICK and COMPACT_TICKS frames, non-tick
+ *     frames, a truncated tail) merged exactly; unreadable and corrupt files
+ *   - MergedFeedHandler: two live feeds merged into one ordered stream
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "compact_encoding.hpp"
+#include "feed_merge.hpp"
+#include "tick_server.hpp"
+
+namespace {
+
+net::Tick tick(uint64_t timestamp, uint64_t recv_ns = 0, const char *symbol = "AAPL") {
+  net::Tick t;
+  t.timestamp = timestamp;
+  std::strncpy(t.symbol, symbol, sizeof(t.symbol) - 1);
+  t.recv_timestamp_ns = recv_ns;
+  return t;
+}
+
+struct Collected {
+  std::vector<uint64_t> timestamps;
+  std::vector<std::string> symbols;
+  size_t batches = 0;
+  size_t largest_batch = 0;
+
+  void operator()(const net::Tick *ticks, size_t count) {
+    ++batches;
+    largest_batch = std::max(largest_batch, count);
+    for (size_t i = 0; i < count; ++i) {
+      timestamps.push_back(ticks[i].timestamp);
+      symbols.emplace_back(ticks[i].symbol);
+    }
+  }
+};
+
+// Temporary capture file, removed on destruction
+class TempFile {
+public:
+  explicit TempFile(const std::string &bytes) {
+    char name[] = "/tmp/feed_merge_testXXXXXX";
+    int fd = mkstemp(name);
+    path_ = name;
+    if (fd >= 0) {
+      EXPECT_EQ(write(fd, bytes.data(), bytes.size()), static_cast<ssize_t>(bytes.size()));
+      close(fd);
+    }
+  }
+  ~TempFile() { unlink(path_.c_str()); }
+  const std::string &path() const { return path_; }
+
+private:
+  std::string path_;
+};
+
+// Ticks at timestamps first, first + step, ... as binary TICK frames
+std::string tick_frames(uint64_t first, uint64_t step, size_t count, const char *symbol) {
+  std::string frames;
+  for (size_t i = 0; i < count; ++i) {
+    frames += serialize_tick(i + 1, first + i * step, symbol, 100.0f, static_cast<int32_t>(i));
+  }
+  return frames;
+}
+
+} // namespace
+
+TEST(TournamentTreeTest, WinnerIsSmallestKeyLowestIndexOnTies) {
+  std::mt19937_64 rng(7);
+  for (size_t leaves : {1u, 2u, 5u, 16u, 33u}) {
+    TournamentTree tree(leaves);
+    std::vector<uint64_t> keys(leaves, TournamentTree::EMPTY);
+    EXPECT_EQ(tree.winner_key(), TournamentTree::EMPTY);
+    for (int step = 0; step < 2000; ++step) {
+      size_t leaf = rng() % leaves;
+      uint64_t key = rng() % 5 == 0 ? TournamentTree::EMPTY : rng() % 50;  // Plenty of ties
+      keys[leaf] = key;
+      tree.set(leaf, key);
+      size_t expected = std::min_element(keys.begin(), keys.end()) - keys.begin();
+      ASSERT_EQ(tree.winner(), expected) << leaves << " leaves, step " << step;
+      ASSERT_EQ(tree.winner_key(), keys[expected]);
+    }
+  }
+}
+
+TEST(FeedMergerTest, InterleavedInputsMergeInOrderInBatches) {
+  net::FeedMergeConfig config;
+  config.inputs = 3;
+  config.max_batch = 16;
+  net::FeedMerger merger(config);
+
+  // Input i carries timestamps i, i + 3, i + 6, ... plus a tie on input 2
+  for (uint64_t ts = 0; ts < 300; ++ts) {
+    ASSERT_TRUE(merger.push(ts % 3, tick(ts, 0, ts % 3 == 0 ? "A" : ts % 3 == 1 ? "B" : "C")));
+  }
+  ASSERT_TRUE(merger.push(2, tick(299, 0, "T")));
+  Collected out;
+  while (merger.poll(std::ref(out)) > 0) {
+  }
+  // Input 2 is open and drained: nothing past it may go out, and with
+  // recv time 0 the lateness bound has long passed, so it is forced
+  EXPECT_GT(merger.stats().forced, 0u);
+  for (size_t i = 0; i < 3; ++i) {
+    merger.close(i);
+  }
+  while (!merger.finished()) {
+    merger.poll(std::ref(out));
+  }
+
+  ASSERT_EQ(out.timestamps.size(), 301u);
+  for (size_t i = 0; i + 1 < out.timestamps.size(); ++i) {
+    ASSERT_LE(out.timestamps[i], out.timestamps[i + 1]);
+  }
+  EXPECT_EQ(out.symbols[299], "C");  // Tie at 299: queue order within input 2
+  EXPECT_EQ(out.symbols[300], "T");
+  EXPECT_EQ(out.largest_batch, 16u);
+  EXPECT_EQ(merger.stats().merged, 301u);
+  EXPECT_EQ(merger.stats().late, 0u);
+}
+
+TEST(FeedMergerTest, QuietInputHoldsMergeUntilLatenessBound) {
+  net::FeedMergeConfig config;
+  config.inputs = 2;
+  config.lateness_ns = 5'000'000;
+  net::FeedMerger merger(config);
+  Collected out;
+
+  const uint64_t now = 1'000'000'000;
+  merger.push(0, tick(100, now));
+  merger.push(0, tick(200, now));
+  EXPECT_EQ(merger.poll(std::ref(out), now + 4'000'000), 0u);  // Input 1 might still send < 100
+
+  merger.push(1, tick(150, now + 4'500'000));
+  EXPECT_EQ(merger.poll(std::ref(out), now + 4'600'000), 2u);  // 100, 150: then input 1 is quiet
+  EXPECT_EQ(merger.stats().forced, 0u);
+
+  EXPECT_EQ(merger.poll(std::ref(out), now + 5'000'000), 1u);  // 200 waited 5 ms
+  EXPECT_EQ(merger.stats().forced, 1u);
+  EXPECT_EQ(out.timestamps, (std::vector<uint64_t>{100, 150, 200}));
+
+  // Older than 200, already emitted: late, passed through. Input 1 then
+  // closes, so 300 no longer waits for it
+  merger.push(1, tick(180, now + 6'000'000));
+  merger.push(0, tick(300, now + 6'000'000));
+  merger.close(1);
+  EXPECT_EQ(merger.poll(std::ref(out), now + 6'000'000), 2u);
+  EXPECT_EQ(merger.stats().late, 1u);
+  EXPECT_EQ(out.timestamps.back(), 300u);
+  EXPECT_FALSE(merger.finished());
+
+  merger.close(0);
+  merger.poll(std::ref(out));
+  EXPECT_TRUE(merger.finished());
+
+  // Dropped instead
+  config.drop_late = true;
+  net::FeedMerger dropping(config);
+  Collected kept;
+  dropping.push(0, tick(500));
+  dropping.close(0);
+  dropping.poll(std::ref(kept));
+  dropping.push(1, tick(400));
+  dropping.close(1);
+  dropping.poll(std::ref(kept));
+  EXPECT_EQ(kept.timestamps, std::vector<uint64_t>{500});
+  EXPECT_EQ(dropping.stats().late_dropped, 1u);
+  EXPECT_TRUE(dropping.finished());
+}
+
+TEST(FeedReplayTest, CaptureFilesMergeExactly) {
+  // Venue A: plain ticks at even timestamps, with heartbeats in between
+  std::string a;
+  for (uint64_t i = 0; i < 5000; ++i) {
+    a += serialize_tick(i + 1, 2 * i, "AAPL", 1.0f, 1);
+    if (i % 100 == 0) a += serialize_heartbeat(i + 1, 0);
+  }
+  // Venue B: compact batches at odd timestamps, cut off mid-frame
+  std::string b;
+  CompactTickEncoder encoder;
+  std::vector<TickPayload> batch;
+  for (uint64_t i = 0; i < 5000; ++i) {
+    TickPayload p{};
+    p.timestamp = 2 * i + 1;
+    std::memcpy(p.symbol, "MSFT", 4);
+    p.price = 2.0f;
+    p.volume = 2;
+    batch.push_back(p);
+    if (batch.size() == 50) {
+      encoder.encode(b, i - 49, batch.data(), batch.size());
+      batch.clear();
+    }
+  }
+  b += serialize_tick(9, 20000, "MSFT", 2.0f, 2).substr(0, 10);
+  // Venue C: empty
+  TempFile fa(a), fb(b), fc("");
+
+  net::FeedReplay replay({fa.path(), fb.path(), fc.path()}, 100);
+  Collected out;
+  auto stats = replay.run(std::ref(out));
+  ASSERT_TRUE(stats.ok()) << stats.error();
+  ASSERT_EQ(out.timestamps.size(), 10000u);
+  for (uint64_t i = 0; i < 10000; ++i) {
+    ASSERT_EQ(out.timestamps[i], i);
+    ASSERT_EQ(out.symbols[i], i % 2 == 0 ? "AAPL" : "MSFT");
+  }
+  EXPECT_EQ(stats.value().merged, 10000u);
+  EXPECT_EQ(stats.value().batches, 100u);
+  EXPECT_EQ(stats.value().frames_skipped, 50u);
+  EXPECT_EQ(stats.value().truncated, 1u);
+  EXPECT_EQ(stats.value().late, 0u);
+
+  // Missing and corrupt files fail the replay
+  EXPECT_FALSE(net::FeedReplay({"/nonexistent/feed.bin"}).run(std::ref(out)).ok());
+  std::string corrupt = a.substr(0, 318) + std::string(13, '\xff') + a.substr(318);  // After 9 ticks and a heartbeat
+  TempFile fbad(corrupt);
+  auto bad = net::FeedReplay({fa.path(), fbad.path()}).run([](const net::Tick *, size_t) {});
+  ASSERT_FALSE(bad.ok());
+  EXPECT_NE(bad.error().find("offset 318"), std::string::npos);
+}
+
+TEST(MergedFeedHandlerTest, LiveFeedsMergeIntoOneOrderedStream) {
+  TickServer venue_a, venue_b;
+  venue_a.serve(tick_frames(0, 2, 20000, "AAPL"));
+  venue_b.serve(tick_frames(1, 2, 20000, "MSFT"));
+
+  std::vector<net::FeedConfig> feeds(2);
+  feeds[0].port = venue_a.port();
+  feeds[1].port = venue_b.port();
+  for (auto &feed : feeds) {
+    feed.protocol = net::Protocol::BINARY;
+    feed.queue_size = 1 << 12;
+  }
+  net::FeedMergeConfig config;
+  config.queue_capacity = 1 << 10;  // Small: backpressure into the feeds
+  config.lateness_ns = 5'000'000'000;  // Both feeds run to the end: exact order
+  net::MergedFeedHandler merged(feeds, config);
+  Collected out;
+  std::thread::id merge_thread;
+  merged.set_batch_callback([&](const net::Tick *ticks, size_t count) {
+    merge_thread = std::this_thread::get_id();
+    out(ticks, count);
+  });
+  ASSERT_TRUE(merged.start());
+  merged.wait();
+
+  ASSERT_EQ(out.timestamps.size(), 40000u);
+  for (uint64_t i = 0; i < 40000; ++i) {
+    ASSERT_EQ(out.timestamps[i], i);
+  }
+  EXPECT_NE(merge_thread, std::this_thread::get_id());
+  EXPECT_EQ(merged.stats().late, 0u);
+  EXPECT_LE(out.largest_batch, net::TickProcessor::DEFAULT_MAX_BATCH);
+
+  net::MergedFeedHandler unreachable(std::vector<net::FeedConfig>(1), config);
+  EXPECT_FALSE(unreachable.start());
+}
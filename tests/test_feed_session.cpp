@@ -0,0 +1,410 @@
+/**
+ * Coroutine Feed Session Tests
+ *
+ * Covers:
+ *   - SessionReactor: sleeps finish in deadline order, a readable wait
+ *     times out or completes on data, run() returns when nothing waits
+ *   - FeedSession: snapshot -> live -> incrementals against a scripted
+ *     exchange, including updates buffered before the snapshot
+ *   - A chunk whose levels overrun its payload discards the snapshot and
+ *     requests it again
+ *   - Reconnect and re-snapshot after the exchange drops the connection
+ *     or goes quiet past the heartbeat timeout
+ *   - Giving up after consecutive failed connects
+ *   - Hundreds of sessions on one reactor thread, and stop() freeing
+ *     suspended coroutine frames
+ */
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "feed_session.hpp"
+
+namespace {
+
+// Accepts on an ephemeral port; each connection runs `script` on its own thread
+class ScriptedExchange {
+public:
+  using Script = std::function<void(int fd, int connection)>;
+
+  explicit ScriptedExchange(Script script) : script_(std::move(script)) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    listen(listen_fd_, 1024);
+
+    acceptor_ = std::thread([this]() {
+      int connection = 0;
+      while (true) {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+          break;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        handlers_.emplace_back([this, fd, connection]() {
+          script_(fd, connection);
+          close(fd);
+        });
+        connection++;
+      }
+    });
+  }
+
+  ~ScriptedExchange() {
+    shutdown(listen_fd_, SHUT_RDWR);
+    close(listen_fd_);
+    acceptor_.join();
+    for (auto &handler : handlers_) {
+      handler.join();
+    }
+  }
+
+  int port() const { return port_; }
+
+private:
+  Script script_;
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::thread acceptor_;
+  std::mutex mutex_;
+  std::vector<std::thread> handlers_;
+};
+
+bool write_all(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// Symbols of the next `count` SNAPSHOT_REQUESTs
+std::vector<std::string> read_requests(int fd, size_t count) {
+  std::vector<std::string> symbols;
+  char frame[MessageHeader::HEADER_SIZE + SnapshotRequestPayload::PAYLOAD_SIZE];
+  while (symbols.size() < count) {
+    size_t got = 0;
+    while (got < sizeof(frame)) {
+      ssize_t n = recv(fd, frame + got, sizeof(frame) - got, 0);
+      if (n <= 0) return symbols;
+      got += n;
+    }
+    MessageHeader header = deserialize_header(frame);
+    EXPECT_EQ(header.type, MessageType::SNAPSHOT_REQUEST);
+    symbols.push_back(trim_symbol(frame + MessageHeader::HEADER_SIZE, 4));
+  }
+  return symbols;
+}
+
+std::string snapshot(uint64_t sequence, const std::string &symbol, float bid, float ask) {
+  char wire[4] = {};
+  memcpy(wire, symbol.data(), std::min<size_t>(symbol.size(), 4));
+  return serialize_snapshot_response(sequence, wire, {{bid, 100}}, {{ask, 200}});
+}
+
+std::string update(uint64_t sequence, const std::string &symbol, float price, int64_t quantity) {
+  return serialize_order_book_update(sequence, symbol.c_str(), 0, price, quantity);
+}
+
+// Answer every request with a one-level snapshot, then `updates` AAPL updates
+void serve_snapshots(int fd, size_t symbols, int updates) {
+  uint64_t sequence = 0;
+  std::string out;
+  for (const auto &symbol : read_requests(fd, symbols)) {
+    out += snapshot(++sequence, symbol, 99.0f, 101.0f);
+  }
+  for (int i = 0; i < updates; ++i) {
+    out += update(++sequence, "AAPL", 98.0f - i, 10 + i);
+  }
+  write_all(fd, out);
+}
+
+FeedSessionConfig session_config(int port) {
+  FeedSessionConfig config;
+  config.port = port;
+  config.symbols = {"AAPL", "MSFT"};
+  config.initial_backoff_ms = 10;
+  return config;
+}
+
+SessionTask<void> sleeper(SessionReactor &reactor, uint32_t slot, uint64_t ms,
+                          std::vector<int> &order, int id) {
+  co_await reactor.sleep(slot, ms * 1'000'000);
+  order.push_back(id);
+}
+
+SessionTask<void> read_with_timeout(SessionReactor &reactor, uint32_t slot, uint64_t ms,
+                                    std::vector<bool> &results) {
+  results.push_back(co_await reactor.readable(slot, ms * 1'000'000));
+}
+
+} // namespace
+
+TEST(SessionReactorTest, SleepsFinishInDeadlineOrder) {
+  SessionReactor reactor;
+  ASSERT_TRUE(reactor.ok());
+  std::vector<int> order;
+  std::vector<uint32_t> slots;
+  std::vector<SessionTask<void>> tasks;
+  const uint64_t durations_ms[] = {30, 10, 20};
+  for (int i = 0; i < 3; ++i) {
+    slots.push_back(reactor.open_slot());
+    tasks.push_back(sleeper(reactor, slots.back(), durations_ms[i], order, i));
+    tasks.back().start();
+  }
+  EXPECT_EQ(reactor.waiting(), 3u);
+
+  uint64_t started = now_ns();
+  reactor.run();
+  EXPECT_GE(now_ns() - started, 30'000'000u);
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 0}));
+  EXPECT_EQ(reactor.waiting(), 0u);
+  for (auto &task : tasks) EXPECT_TRUE(task.done());
+}
+
+TEST(SessionReactorTest, ReadableTimesOutThenCompletesOnData) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  SessionReactor reactor;
+  uint32_t slot = reactor.open_slot();
+  ASSERT_TRUE(reactor.watch(slot, fds[0]));
+
+  std::vector<bool> results;
+  auto quiet = read_with_timeout(reactor, slot, 20, results);
+  quiet.start();
+  reactor.run();
+  ASSERT_EQ(results, (std::vector<bool>{false}));
+
+  auto fed = read_with_timeout(reactor, slot, 5000, results);
+  fed.start();
+  std::thread writer([&]() {
+    usleep(10000);
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+  });
+  uint64_t started = now_ns();
+  reactor.run();
+  writer.join();
+  EXPECT_EQ(results, (std::vector<bool>{false, true}));
+  EXPECT_LT(now_ns() - started, 1'000'000'000u);
+
+  reactor.unwatch(slot);
+  reactor.close_slot(slot);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(FeedSessionTest, SnapshotThenIncrementals) {
+  ScriptedExchange exchange([](int fd, int) {
+    auto requested = read_requests(fd, 2);
+    EXPECT_EQ(requested, (std::vector<std::string>{"AAPL", "MSFT"}));
+    // An update before its book's snapshot is buffered, and dropped since
+    // the snapshot (seq 3) already covers it
+    std::string out = update(1, "AAPL", 50.0f, 1);
+    out += snapshot(2, "MSFT", 300.0f, 301.0f);
+    out += snapshot(3, "AAPL", 99.0f, 101.0f);
+    out += update(4, "AAPL", 98.0f, 7);
+    out += update(5, "MSFT", 299.0f, 3);
+    write_all(fd, out);
+    char byte;
+    recv(fd, &byte, 1, 0);  // Until the session closes
+  });
+
+  SessionReactor reactor;
+  FeedSession session(reactor, session_config(exchange.port()));
+  int live_calls = 0;
+  std::vector<uint64_t> applied;
+  session.set_live_callback([&](FeedSession &s) {
+    live_calls++;
+    EXPECT_EQ(s.books().count(BookState::VALID), 2u);
+    EXPECT_GT(s.stats().last_recovery_ns, 0u);
+  });
+  session.set_update_callback([&](FeedSession &s, const BookUpdateView &, uint64_t sequence) {
+    applied.push_back(sequence);
+    if (applied.size() == 2) s.stop();
+  });
+  session.start();
+  // A loopback connect can finish, and even reach the snapshots, inside start()
+  EXPECT_NE(session.state(), FeedSession::State::IDLE);
+  reactor.run();
+
+  EXPECT_EQ(live_calls, 1);
+  EXPECT_EQ(applied, (std::vector<uint64_t>{4, 5}));
+  EXPECT_TRUE(session.finished());
+  const auto &stats = session.stats();
+  EXPECT_EQ(stats.connects, 1u);
+  EXPECT_EQ(stats.snapshots, 2u);
+  EXPECT_EQ(stats.updates_buffered, 1u);
+  EXPECT_EQ(stats.updates_replayed, 0u);
+  EXPECT_EQ(stats.gaps, 0u);
+
+  const OrderBook &aapl = session.books().books().at("AAPL").book;
+  float price;
+  uint64_t quantity;
+  ASSERT_TRUE(aapl.get_best_bid(price, quantity));
+  EXPECT_FLOAT_EQ(price, 99.0f);
+  EXPECT_EQ(aapl.bid_depth(), 2u);
+}
+
+TEST(FeedSessionTest, MalformedChunkRequestsSnapshotAgain) {
+  ScriptedExchange exchange([](int fd, int) {
+    read_requests(fd, 2);
+    std::vector<OrderBookLevel> bids = {{99.0f, 100}};
+    std::string chunk = serialize_snapshot_chunk(3, "AAPL", 1, 0, 0, bids.data(), bids.size());
+    uint16_t count_net = htons(SnapshotChunkPayload::MAX_LEVELS);  // Far past the payload
+    memcpy(&chunk[MessageHeader::HEADER_SIZE + 13], &count_net, 2);
+
+    std::string out = snapshot(1, "MSFT", 300.0f, 301.0f);
+    out += serialize_snapshot_begin(2, "AAPL", 1, 1, 0);
+    out += chunk;
+    write_all(fd, out);
+
+    auto again = read_requests(fd, 1);
+    EXPECT_EQ(again, (std::vector<std::string>{"AAPL"}));
+    write_all(fd, snapshot(4, "AAPL", 99.0f, 101.0f));
+    char byte;
+    recv(fd, &byte, 1, 0);
+  });
+
+  SessionReactor reactor;
+  FeedSession session(reactor, session_config(exchange.port()));
+  session.set_live_callback([](FeedSession &s) { s.stop(); });
+  session.start();
+  reactor.run();
+
+  EXPECT_EQ(session.stats().snapshots, 2u);
+  EXPECT_EQ(session.stats().gaps, 0u);
+  const OrderBook &aapl = session.books().books().at("AAPL").book;
+  EXPECT_EQ(aapl.bid_depth(), 1u);
+  EXPECT_EQ(aapl.ask_depth(), 1u);
+}
+
+TEST(FeedSessionTest, ReconnectsAndResnapshotsAfterDrop) {
+  ScriptedExchange exchange([](int fd, int connection) {
+    serve_snapshots(fd, 2, 3);
+    if (connection > 0) {
+      char byte;
+      recv(fd, &byte, 1, 0);
+    }
+    // First connection: dropped right after the updates
+  });
+
+  SessionReactor reactor;
+  FeedSession session(reactor, session_config(exchange.port()));
+  int live_calls = 0;
+  session.set_live_callback([&](FeedSession &s) {
+    if (++live_calls == 2) s.stop();
+  });
+  session.start();
+  reactor.run();
+
+  EXPECT_EQ(live_calls, 2);
+  EXPECT_EQ(session.stats().connects, 2u);
+  EXPECT_EQ(session.stats().disconnects, 1u);
+  EXPECT_EQ(session.stats().snapshots, 4u);
+  EXPECT_EQ(session.stats().gaps, 0u);
+}
+
+TEST(FeedSessionTest, HeartbeatTimeoutReconnects) {
+  std::atomic<int> connections{0};
+  ScriptedExchange exchange([&](int fd, int) {
+    connections++;
+    serve_snapshots(fd, 2, 0);
+    char byte;
+    recv(fd, &byte, 1, 0);  // Silent until the session gives up on us
+  });
+
+  SessionReactor reactor;
+  FeedSessionConfig config = session_config(exchange.port());
+  config.heartbeat_timeout_ms = 50;
+  FeedSession session(reactor, config);
+  session.set_live_callback([&](FeedSession &s) {
+    if (s.stats().connects == 2) s.stop();
+  });
+  session.start();
+  reactor.run();
+
+  EXPECT_EQ(session.stats().heartbeat_timeouts, 1u);
+  EXPECT_EQ(session.stats().connects, 2u);
+  EXPECT_EQ(connections.load(), 2);
+}
+
+TEST(FeedSessionTest, GivesUpAfterConsecutiveConnectFailures) {
+  // A port nothing listens on
+  int probe = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(probe, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  socklen_t len = sizeof(addr);
+  getsockname(probe, reinterpret_cast<sockaddr *>(&addr), &len);
+  close(probe);
+
+  SessionReactor reactor;
+  FeedSessionConfig config = session_config(ntohs(addr.sin_port));
+  config.initial_backoff_ms = 5;
+  config.max_connect_failures = 3;
+  FeedSession session(reactor, config);
+  session.start();
+  reactor.run();
+
+  EXPECT_TRUE(session.finished());
+  EXPECT_EQ(session.stats().connect_failures, 3u);
+  EXPECT_EQ(session.stats().connects, 0u);
+}
+
+TEST(FeedSessionTest, HundredsOfSessionsOnOneReactor) {
+  constexpr size_t SESSIONS = 200;
+  ScriptedExchange exchange([](int fd, int) {
+    serve_snapshots(fd, 2, 5);
+    char byte;
+    recv(fd, &byte, 1, 0);
+  });
+
+  const size_t frames_before = session_detail::frame_bytes.load();
+  SessionReactor reactor;
+  std::vector<std::unique_ptr<FeedSession>> sessions;
+  size_t live = 0;
+  for (size_t i = 0; i < SESSIONS; ++i) {
+    sessions.push_back(std::make_unique<FeedSession>(reactor, session_config(exchange.port())));
+    sessions.back()->set_update_callback([&](FeedSession &s, const BookUpdateView &, uint64_t) {
+      if (s.stats().updates_applied == 5 && ++live == SESSIONS) reactor.stop();
+    });
+    sessions.back()->start();
+  }
+  reactor.run();
+  ASSERT_EQ(live, SESSIONS);
+
+  // Every session is suspended mid-stream: its frames are all it holds
+  size_t frames = session_detail::frame_bytes.load() - frames_before;
+  EXPECT_LT(frames / SESSIONS, 2048u);
+  EXPECT_LT(sessions[0]->footprint_bytes(), 8192u);
+  for (const auto &session : sessions) {
+    EXPECT_TRUE(session->live());
+    EXPECT_EQ(session->stats().updates_applied, 5u);
+  }
+
+  // stop() destroys the suspended frames; the exchange sees every close
+  sessions.clear();
+  EXPECT_EQ(session_detail::frame_bytes.load(), frames_before);
+  EXPECT_EQ(reactor.waiting(), 0u);
+}
@@ -0,0 +1,235 @@
+/**
+ * Heartbeat Fleet Tests
+ *
+ * Covers:
+ *   - TimerWheel: nothing fires early, timers laps beyond the wheel's span,
+ *     cancel and reschedule (also from inside a callback), big clock jumps,
+ *     next_deadline()
+ *   - LatencyHistogram bucket bounds and percentiles
+ *   - HeartbeatFleet: hundreds of sessions over several reactors, each
+ *     heartbeating on its interval with its ticks, consecutive sequences
+ *   - Induced stalls silence a session for stall_ms; client closes are seen
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "heartbeat_fleet.hpp"
+#include "multi_client.hpp"
+#include "timer_wheel.hpp"
+
+namespace {
+
+constexpr uint64_t MS = 1'000'000;
+
+struct SessionLog {
+  uint64_t heartbeats = 0;
+  uint64_t ticks = 0;
+  uint64_t next_sequence = 0;
+  bool in_order = true;
+  uint64_t last_heartbeat_ns = 0;
+  uint64_t longest_gap_ns = 0;
+};
+
+// Connect `count` clients to the fleet and read for `duration`
+std::map<MultiClient::ConnectionId, SessionLog> read_fleet(uint16_t port, size_t count,
+                                                           std::chrono::milliseconds duration,
+                                                           size_t close_after = 0) {
+  MultiClient client;
+  std::map<MultiClient::ConnectionId, SessionLog> logs;
+  client.set_frame_callback([&](MultiClient::ConnectionId id, const MessageHeader &header,
+                                const char *) {
+    SessionLog &log = logs[id];
+    log.in_order = log.in_order && header.sequence == log.next_sequence;
+    log.next_sequence = header.sequence + 1;
+    if (header.type == MessageType::HEARTBEAT) {
+      uint64_t now = now_ns();
+      if (log.last_heartbeat_ns != 0) {
+        log.longest_gap_ns = std::max(log.longest_gap_ns, now - log.last_heartbeat_ns);
+      }
+      log.last_heartbeat_ns = now;
+      ++log.heartbeats;
+    } else if (header.type == MessageType::TICK) {
+      ++log.ticks;
+    }
+  });
+  std::vector<MultiClient::ConnectionId> ids;
+  for (size_t i = 0; i < count; ++i) {
+    auto id = client.connect("127.0.0.1", port);
+    EXPECT_TRUE(id.ok());
+    if (id.ok()) ids.push_back(id.value());
+  }
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+    client.poll(5);
+  }
+  for (size_t i = 0; i < close_after && i < ids.size(); ++i) {
+    client.close(ids[i]);
+  }
+  return logs;
+}
+
+} // namespace
+
+TEST(TimerWheelTest, FiresOnlyOnceDue) {
+  TimerWheel wheel(MS, 8, 0);  // 8 ms span
+  wheel.schedule(1, 3 * MS + 500);
+  wheel.schedule(2, 5 * MS);
+  wheel.schedule(3, 30 * MS);  // Almost four laps out
+  EXPECT_EQ(wheel.size(), 3u);
+  EXPECT_EQ(wheel.next_deadline(8), 3 * MS + 500);
+
+  std::vector<std::pair<uint32_t, uint64_t>> fired;
+  auto record = [&](uint32_t id, uint64_t deadline) { fired.emplace_back(id, deadline); };
+  EXPECT_EQ(wheel.advance(3 * MS + 499, record), 0u);  // Same tick, not yet due
+  EXPECT_EQ(wheel.advance(3 * MS + 500, record), 1u);
+  EXPECT_EQ(wheel.advance(29 * MS, record), 1u);
+  EXPECT_EQ(wheel.advance(30 * MS, record), 1u);
+  ASSERT_EQ(fired.size(), 3u);
+  EXPECT_EQ(fired[0], std::make_pair(1u, 3 * MS + 500));
+  EXPECT_EQ(fired[1], std::make_pair(2u, 5 * MS));
+  EXPECT_EQ(fired[2], std::make_pair(3u, 30 * MS));
+  EXPECT_TRUE(wheel.empty());
+
+  // A deadline already past fires on the next advance
+  wheel.schedule(4, 1 * MS);
+  EXPECT_FALSE(wheel.scheduled(5));
+  EXPECT_EQ(wheel.advance(30 * MS, record), 1u);
+}
+
+TEST(TimerWheelTest, CancelAndRescheduleFromCallbacks) {
+  TimerWheel wheel(MS, 64, 0);
+  for (uint32_t id = 0; id < 10; ++id) {
+    wheel.schedule(id, 10 * MS);
+  }
+  wheel.schedule(3, 20 * MS);  // Moved
+  EXPECT_TRUE(wheel.cancel(7));
+  EXPECT_FALSE(wheel.cancel(7));
+  EXPECT_EQ(wheel.size(), 9u);
+
+  std::vector<uint32_t> fired;
+  wheel.advance(10 * MS, [&](uint32_t id, uint64_t deadline) {
+    fired.push_back(id);
+    if (id == 0 || id == 9) {
+      wheel.cancel(id == 0 ? 9 : 0);  // Whichever fires first cancels the other
+    }
+    wheel.schedule(id, deadline + 5 * MS);  // Periodic
+  });
+  // Eight were due; whichever of 0 and 9 fired first cancelled the other
+  EXPECT_EQ(fired.size(), 7u);
+  EXPECT_NE(std::count(fired.begin(), fired.end(), 0u) + std::count(fired.begin(), fired.end(), 9u), 2);
+  EXPECT_EQ(std::count(fired.begin(), fired.end(), 3u), 0);
+  EXPECT_EQ(wheel.size(), 8u);  // Seven periodic + id 3
+
+  size_t count = wheel.advance(15 * MS, [](uint32_t, uint64_t) {});
+  EXPECT_EQ(count, 7u);
+}
+
+TEST(TimerWheelTest, LargeClockJumpFiresEverythingDue) {
+  TimerWheel wheel(MS, 16, 0);
+  for (uint32_t id = 0; id < 100; ++id) {
+    wheel.schedule(id, (id + 1) * MS);  // Spread over six laps
+  }
+  std::vector<uint32_t> fired;
+  EXPECT_EQ(wheel.advance(1000 * MS, [&](uint32_t id, uint64_t) { fired.push_back(id); }), 100u);
+  std::sort(fired.begin(), fired.end());
+  for (uint32_t id = 0; id < 100; ++id) {
+    ASSERT_EQ(fired[id], id);
+  }
+  EXPECT_EQ(wheel.next_deadline(4), 1004 * MS);  // Nothing left: end of the window
+}
+
+TEST(LatencyHistogramTest, BucketsBoundValuesWithinOneSixteenth) {
+  for (uint64_t v : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 1000ULL, 123456789ULL, ~0ULL >> 1}) {
+    size_t b = LatencyHistogram::bucket(v);
+    ASSERT_LT(b, LatencyHistogram::BUCKETS);
+    EXPECT_GE(LatencyHistogram::bucket_ceiling(b), v);
+    EXPECT_LE(LatencyHistogram::bucket_ceiling(b) - v, v / 16);
+    if (b > 0) {
+      EXPECT_LT(LatencyHistogram::bucket_ceiling(b - 1), v);
+    }
+  }
+
+  LatencyHistogram histogram;
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    histogram.record(v * 1000);
+  }
+  LatencyHistogram::Counts counts{};
+  histogram.add_to(counts);
+  uint64_t p50 = LatencyHistogram::percentile(counts, 50);
+  uint64_t p99 = LatencyHistogram::percentile(counts, 99);
+  EXPECT_NEAR(static_cast<double>(p50), 500'000.0, 500'000.0 / 16);
+  EXPECT_NEAR(static_cast<double>(p99), 990'000.0, 990'000.0 / 16);
+  EXPECT_EQ(histogram.max(), 1'000'000u);
+}
+
+TEST(HeartbeatFleetTest, SessionsHeartbeatAcrossReactors) {
+  HeartbeatFleetConfig config;
+  config.port = 0;
+  config.reactors = 2;
+  config.interval_ms = 50;
+  config.jitter_ms = 10;
+  config.ticks_per_heartbeat = 2;
+  HeartbeatFleet fleet(config);
+  ASSERT_TRUE(fleet.start().ok());
+  EXPECT_EQ(fleet.reactor_count(), 2u);
+
+  auto logs = read_fleet(fleet.port(), 300, std::chrono::milliseconds(800));
+  ASSERT_EQ(logs.size(), 300u);
+  uint64_t heartbeats = 0;
+  for (const auto &[id, log] : logs) {
+    EXPECT_TRUE(log.in_order);
+    EXPECT_GE(log.heartbeats, 8u);   // ~15 at 50 ms ± 10 ms over 0.8 s
+    EXPECT_LE(log.heartbeats, 22u);
+    EXPECT_EQ(log.ticks, 2 * log.heartbeats);
+    heartbeats += log.heartbeats;
+  }
+
+  auto stats = fleet.stats();
+  EXPECT_EQ(stats.accepted, 300u);
+  EXPECT_GE(stats.heartbeats, heartbeats);
+  EXPECT_EQ(stats.ticks, 2 * stats.heartbeats);
+  EXPECT_EQ(stats.stalls, 0u);
+  EXPECT_GT(stats.lateness_percentile(50), 0u);
+  EXPECT_LT(stats.lateness_percentile(50), 20 * MS);
+}
+
+TEST(HeartbeatFleetTest, StallsSilenceSessionsAndClosesAreSeen) {
+  HeartbeatFleetConfig config;
+  config.port = 0;
+  config.reactors = 1;
+  config.interval_ms = 20;
+  config.stall_rate = 0.1;
+  config.stall_ms = 200;
+  HeartbeatFleet fleet(config);
+  ASSERT_TRUE(fleet.start().ok());
+
+  auto logs = read_fleet(fleet.port(), 50, std::chrono::milliseconds(1000), 50);
+  size_t stalled = 0;
+  for (const auto &[id, log] : logs) {
+    EXPECT_TRUE(log.in_order);
+    if (log.longest_gap_ns >= 180 * MS) ++stalled;
+  }
+  EXPECT_GT(stalled, 10u);  // Most sessions hit a 10% stall in ~40 heartbeats
+
+  auto stats = fleet.stats();
+  EXPECT_GE(stats.stalls, stalled);
+  // Closed on our side: the reactor notices on its next read
+  for (int i = 0; i < 100 && fleet.stats().closed < 50; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  stats = fleet.stats();
+  EXPECT_EQ(stats.closed, 50u);
+  EXPECT_EQ(stats.sessions, 0u);
+
+  HeartbeatFleetConfig bad = config;
+  bad.jitter_ms = config.interval_ms;
+  HeartbeatFleet invalid(bad);
+  EXPECT_FALSE(invalid.start().ok());
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "text_protocol.hpp"
 #include "binary_protocol.hpp"
+#include "frame_integrity.hpp"
 #include "ring_buffer.hpp"
 #include <cstring>
 #include <limits>
@@ -281,6 +282,7 @@ TEST_F(BinaryProtocolMalformedTest, UnknownMessageType) {
   EXPECT_EQ(static_cast<uint8_t>(header.type), 0x99);
   // The parser doesn't validate type - this is by design for extensibility
   // But handlers should check and reject unknown types
+  EXPECT_FALSE(plausible_header(header, false));
 }
 
 TEST_F(BinaryProtocolMalformedTest, ZeroMessageType) {
@@ -289,6 +291,7 @@ TEST_F(BinaryProtocolMalformedTest, ZeroMessageType) {
 
   EXPECT_EQ(static_cast<uint8_t>(header.type), 0x00);
   // Type 0 is not a valid MessageType
+  EXPECT_FALSE(plausible_header(header, false));
 }
 
 TEST_F(BinaryProtocolMalformedTest, ValidMessageTypes) {
@@ -305,6 +308,7 @@ TEST_F(BinaryProtocolMalformedTest, ValidMessageTypes) {
     auto header_data = create_raw_header(20, static_cast<uint8_t>(type), 1);
     MessageHeader header = deserialize_header(header_data.c_str());
     EXPECT_EQ(header.type, type);
+    EXPECT_TRUE(is_known_message_type(static_cast<uint8_t>(type)));
   }
 }
 
@@ -331,6 +335,7 @@ TEST_F(BinaryProtocolMalformedTest, PayloadSizeTooLarge) {
 
   EXPECT_EQ(header.length, 1000u);
   // Handler should check if buffer contains enough bytes before parsing payload
+  EXPECT_FALSE(plausible_header(header, false));  // A TICK is always 20 bytes
 }
 
 TEST_F(BinaryProtocolMalformedTest, PayloadSizeZero) {
@@ -339,6 +344,7 @@ TEST_F(BinaryProtocolMalformedTest, PayloadSizeZero) {
 
   EXPECT_EQ(header.length, 0u);
   // Zero-length tick payload is invalid - handler should reject
+  EXPECT_FALSE(plausible_header(header, false));
 }
 
 TEST_F(BinaryProtocolMalformedTest, PayloadSizeMaxUint32) {
@@ -347,6 +353,9 @@ TEST_F(BinaryProtocolMalformedTest, PayloadSizeMaxUint32) {
 
   EXPECT_EQ(header.length, 0xFFFFFFFFu);
   // Handler should reject impossibly large payload
+  EXPECT_FALSE(plausible_header(header, false));
+  header.type = MessageType::SNAPSHOT_CHUNK;
+  EXPECT_FALSE(plausible_header(header, false));
 }
 
 // --- Corrupted Tick Payload Tests ---
@@ -476,6 +485,56 @@ TEST_F(BinaryProtocolMalformedTest, SnapshotResponseMaxLevels) {
   EXPECT_EQ(asks.size(), 255u);
 }
 
+// --- Snapshot Chunk Malformed Tests ---
+
+TEST_F(BinaryProtocolMalformedTest, SnapshotChunkWithinPayload) {
+  std::vector<OrderBookLevel> levels = {{99.5f, 100}, {99.25f, 200}};
+  std::string msg = serialize_snapshot_chunk(1, "AAPL", 3, 0, 0, levels.data(), levels.size());
+  MessageHeader header = deserialize_header(msg.data());
+
+  SnapshotChunkPayload chunk{};
+  EXPECT_TRUE(decode_snapshot_chunk(msg.data() + MessageHeader::HEADER_SIZE, header.length, chunk));
+  EXPECT_EQ(chunk.num_levels, 2);
+  EXPECT_EQ(chunk.snapshot_id, 3u);
+}
+
+TEST_F(BinaryProtocolMalformedTest, SnapshotChunkLevelsPastPayload) {
+  std::vector<OrderBookLevel> levels = {{99.5f, 100}, {99.25f, 200}};
+  std::string msg = serialize_snapshot_chunk(1, "AAPL", 3, 0, 0, levels.data(), levels.size());
+  MessageHeader header = deserialize_header(msg.data());
+  const char *payload = msg.data() + MessageHeader::HEADER_SIZE;
+
+  SnapshotChunkPayload chunk{};
+  EXPECT_FALSE(decode_snapshot_chunk(payload, header.length - 1, chunk));
+  // Fixed fields still identify the snapshot
+  EXPECT_EQ(memcmp(chunk.symbol, "AAPL", 4), 0);
+  EXPECT_EQ(chunk.snapshot_id, 3u);
+
+  EXPECT_FALSE(decode_snapshot_chunk(payload, SnapshotChunkPayload::HEADER_SIZE - 1, chunk));
+}
+
+TEST_F(BinaryProtocolMalformedTest, SnapshotChunkLevelCountOverMax) {
+  std::string msg = serialize_snapshot_chunk(1, "AAPL", 3, 0, 0, nullptr, 0);
+  std::string payload = msg.substr(MessageHeader::HEADER_SIZE);
+  uint16_t count_net = htons(SnapshotChunkPayload::MAX_LEVELS + 1);
+  memcpy(&payload[13], &count_net, 2);
+  payload.resize(SnapshotChunkPayload::HEADER_SIZE +
+                 (SnapshotChunkPayload::MAX_LEVELS + 1) * OrderBookLevel::SIZE);
+
+  SnapshotChunkPayload chunk{};
+  EXPECT_FALSE(decode_snapshot_chunk(payload.data(), payload.size(), chunk));
+}
+
+TEST_F(BinaryProtocolMalformedTest, SnapshotChunkInvalidSide) {
+  std::vector<OrderBookLevel> levels = {{99.5f, 100}};
+  std::string msg = serialize_snapshot_chunk(1, "AAPL", 3, 0, 2, levels.data(), levels.size());
+  MessageHeader header = deserialize_header(msg.data());
+
+  SnapshotChunkPayload chunk{};
+  EXPECT_FALSE(decode_snapshot_chunk(msg.data() + MessageHeader::HEADER_SIZE, header.length, chunk));
+  EXPECT_EQ(chunk.side, 2);
+}
+
 // --- Order Book Update Malformed Tests ---
 
 TEST_F(BinaryProtocolMalformedTest, OrderBookUpdateInvalidSide) {
@@ -0,0 +1,251 @@
+/**
+ * Memory Accounting Tests
+ *
+ * Covers:
+ *   - Registry: accounts and samplers under names, replacement, removal
+ *   - Size estimates against what glibc malloc actually hands out
+ *   - Latency samples, tick queue and books reported by the feed handler
+ *   - The planner agreeing with the books a real feed builds
+ */
+
+#include <gtest/gtest.h>
+
+#include <malloc.h>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_accounting.hpp"
+#include "net/feed.hpp"
+#include "tick_server.hpp"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define MEMORY_TEST_SANITIZED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MEMORY_TEST_SANITIZED 1
+#endif
+#endif
+
+namespace {
+
+#if !defined(MEMORY_TEST_SANITIZED)
+// Bytes glibc has handed out, main arena plus mmapped blocks
+uint64_t heap_in_use() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+#endif
+
+const MemoryUsage* find(const std::vector<ComponentMemory>& components, const std::string& name) {
+  for (const auto& component : components) {
+    if (component.name == name) {
+      return &component.usage;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+TEST(MemoryAccountingTest, RegistryReportsAccountsAndSamplers) {
+  MemoryRegistry registry;
+  MemoryAccount account;
+  account.set(4096, 1024);
+  uint64_t sampled = 100;
+
+  registry.add("account", account);
+  registry.add("sampler", [&]() { return MemoryUsage{sampled * 2, sampled}; });
+  ASSERT_EQ(registry.size(), 2u);
+
+  auto snapshot = registry.snapshot();
+  ASSERT_EQ(snapshot.size(), 2u);
+  EXPECT_EQ(snapshot[0].name, "account");  // Registration order
+  EXPECT_EQ(snapshot[0].usage.reserved, 4096u);
+  EXPECT_EQ(snapshot[1].usage.in_use, 100u);
+
+  // Both kinds are read at snapshot time, not at registration
+  account.set(8192, 2048);
+  sampled = 200;
+  MemoryUsage total = registry.total();
+  EXPECT_EQ(total.reserved, 8192u + 400u);
+  EXPECT_EQ(total.in_use, 2048u + 200u);
+
+  registry.add("sampler", []() { return MemoryUsage{1, 1}; });  // Replaces
+  EXPECT_EQ(registry.size(), 2u);
+  EXPECT_EQ(registry.total().reserved, 8193u);
+
+  registry.remove("account");
+  ASSERT_EQ(registry.size(), 1u);
+  EXPECT_EQ(registry.snapshot()[0].name, "sampler");
+}
+
+TEST(MemoryAccountingTest, LargestSymbolsComeFirst) {
+  std::vector<SymbolMemory> symbols = {
+      {"AAPL", 10, 640}, {"MSFT", 50, 3200}, {"GOOG", 0, 0}, {"AMZN", 50, 3200}};
+  auto top = largest_symbols(symbols, 3);
+  ASSERT_EQ(top.size(), 3u);
+  EXPECT_EQ(top[0].symbol, "AMZN");  // Ties by name
+  EXPECT_EQ(top[1].symbol, "MSFT");
+  EXPECT_EQ(top[2].symbol, "AAPL");
+  EXPECT_EQ(largest_symbols(symbols).size(), 4u);
+}
+
+TEST(MemoryAccountingTest, EstimatesMatchTheAllocator) {
+#if defined(MEMORY_TEST_SANITIZED)
+  GTEST_SKIP() << "The sanitizer allocator does not report through mallinfo2";
+#else
+  {
+    uint64_t before = heap_in_use();
+    std::map<float, uint64_t> levels;
+    for (int i = 0; i < 10000; ++i) {
+      levels.emplace(100.0f + i * 0.01f, i);
+    }
+    uint64_t actual = heap_in_use() - before;
+    EXPECT_NEAR(static_cast<double>(container_bytes(levels)), static_cast<double>(actual),
+                actual * 0.02);
+  }
+  {
+    uint64_t before = heap_in_use();
+    std::unordered_map<std::string, OrderBook> books;
+    for (int i = 0; i < 1000; ++i) {
+      books.emplace("S" + std::to_string(i), OrderBook());
+    }
+    uint64_t actual = heap_in_use() - before;
+    EXPECT_NEAR(static_cast<double>(container_bytes(books)), static_cast<double>(actual),
+                actual * 0.02);
+  }
+  {
+    uint64_t before = heap_in_use();
+    OrderBook book;
+    for (int i = 0; i < 500; ++i) {
+      book.apply_update(i % 2, 100.0f + i * 0.01f, 10);
+    }
+    uint64_t actual = heap_in_use() - before;  // The object itself is on the stack
+    EXPECT_EQ(book.level_count(), 500u);
+    EXPECT_NEAR(static_cast<double>(book_bytes(book) - sizeof(OrderBook)),
+                static_cast<double>(actual), actual * 0.02);
+  }
+#endif
+}
+
+TEST(MemoryAccountingTest, LatencySamplesAreAccountedAsTheyArrive) {
+  SPSCQueue<net::Tick> queue(1024);
+  std::atomic<bool> stop{false};
+  StageMonitor monitor;
+  net::TickProcessor processor(queue, stop, false, monitor);
+  MemoryAccount account;
+  processor.set_memory_account(&account);
+
+  EXPECT_EQ(account.usage().reserved, net::TickProcessor::LATENCY_RESERVE * sizeof(uint64_t));
+  EXPECT_EQ(account.usage().in_use, 0u);
+
+  net::Tick tick;
+  tick.recv_timestamp_ns = now_ns();
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(queue.push(tick));
+  }
+  stop = true;
+  processor.run();  // Drains the queue, then returns
+  EXPECT_EQ(account.usage().in_use, 10 * sizeof(uint64_t));
+
+  processor.reset_stats();
+  EXPECT_EQ(account.usage().in_use, 0u);
+}
+
+TEST(MemoryAccountingTest, HandlerReportsItsComponents) {
+  net::FeedConfig config;
+  config.port = 9;
+  config.queue_size = 1000;  // Rounds up to 1024 slots
+  net::BookUpdatingFeedHandler handler(config);
+
+  auto components = handler.handler().memory().snapshot();
+  const MemoryUsage* queue = find(components, "tick_queue");
+  ASSERT_NE(queue, nullptr);
+  EXPECT_EQ(queue->reserved, 1024 * sizeof(net::Tick));
+  EXPECT_EQ(queue->in_use, 0u);
+  const MemoryUsage* books = find(components, "books");
+  ASSERT_NE(books, nullptr);
+  EXPECT_GT(books->reserved, 0u);  // The preallocated bucket array
+  EXPECT_EQ(books->in_use, 0u);
+
+  // Components built on top register alongside
+  handler.memory().add("bars", []() { return MemoryUsage{4096, 4096}; });
+  EXPECT_NE(find(handler.handler().memory().snapshot(), "bars"), nullptr);
+}
+
+TEST(MemoryAccountingTest, BooksFromALiveFeedMatchThePlan) {
+  constexpr size_t SYMBOLS = 50;
+  constexpr size_t DEPTH = 10;  // Per side in the plan; every tick lands on the bid side
+
+  std::vector<std::string> names;
+  for (size_t s = 0; s < SYMBOLS; ++s) {
+    char name[5];
+    snprintf(name, sizeof(name), "S%03zu", s);
+    names.push_back(name);
+  }
+  std::string frames;
+  uint64_t sequence = 0;
+  for (size_t level = 0; level < 2 * DEPTH; ++level) {
+    for (const auto& name : names) {
+      ++sequence;
+      frames += serialize_tick(sequence, sequence, name.c_str(),
+                               100.0f + static_cast<float>(level), 100);
+    }
+  }
+
+  TickServer server;
+  server.serve(frames);
+  net::FeedConfig config;
+  config.port = server.port();
+  config.protocol = net::Protocol::BINARY;
+  config.queue_size = 1 << 16;
+  net::BookUpdatingFeedHandler handler(config);
+  ASSERT_TRUE(handler.start());
+  handler.wait();
+  ASSERT_EQ(handler.handler().messages_processed(), SYMBOLS * 2 * DEPTH);
+
+  auto symbols = handler.symbol_memory();
+  ASSERT_EQ(symbols.size(), SYMBOLS);
+  for (const auto& entry : symbols) {
+    EXPECT_EQ(entry.levels, 2 * DEPTH) << entry.symbol;
+  }
+
+  auto components = handler.handler().memory().snapshot();
+  const MemoryUsage* books = find(components, "books");
+  ASSERT_NE(books, nullptr);
+  EXPECT_GE(books->reserved, books->in_use);
+
+  auto plan = net::plan_memory(config, SYMBOLS, DEPTH);
+  const MemoryUsage* planned = find(plan, "books");
+  ASSERT_NE(planned, nullptr);
+  EXPECT_NEAR(static_cast<double>(planned->reserved), static_cast<double>(books->reserved),
+              books->reserved * 0.05);
+
+  // Queue and reader buffers are sized by config alone
+  EXPECT_EQ(find(plan, "tick_queue")->reserved, find(components, "tick_queue")->reserved);
+  EXPECT_EQ(find(plan, "reader_buffers")->reserved, find(components, "reader_buffers")->reserved);
+}
+
+TEST(MemoryAccountingTest, PlanFollowsTheConfig) {
+  net::FeedConfig config;
+  auto plan = net::plan_memory(config, 100, 10);
+  EXPECT_EQ(find(plan, "tick_queue")->reserved, SPSCQueue<net::Tick>::storage_bytes_for(1 << 20));
+  EXPECT_EQ(find(plan, "reader_buffers")->reserved, net::TextProtocolReader::BUFFER_BYTES);
+  EXPECT_EQ(find(plan, "distribution"), nullptr);
+  EXPECT_EQ(find(plan, "republisher"), nullptr);
+
+  config.distribution_path = "/tmp/feed.sock";
+  config.republish = true;
+  plan = net::plan_memory(config, 100, 10);
+  EXPECT_NE(find(plan, "distribution"), nullptr);
+  EXPECT_NE(find(plan, "republisher"), nullptr);
+
+  // Book memory scales with symbols times depth
+  uint64_t shallow = find(net::plan_memory(config, 1000, 5), "books")->reserved;
+  uint64_t deep = find(net::plan_memory(config, 1000, 50), "books")->reserved;
+  EXPECT_GT(deep, 5 * shallow);
+}
@@ -0,0 +1,157 @@
+/**
+ * Message View Tests
+ *
+ * Covers:
+ *   - TickView and BookUpdateView fields match deserialize_*() bit for bit
+ *   - Views work at any alignment and trim NUL-padded symbols
+ *   - net::Tick built from a view matches one built from a TickPayload
+ *   - SymbolBooks applies, buffers and rejects updates read through a view
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "message_views.hpp"
+#include "net/feed.hpp"
+#include "symbol_books.hpp"
+
+namespace {
+
+const char* payload_of(const std::string& message) {
+  return message.data() + MessageHeader::HEADER_SIZE;
+}
+
+} // namespace
+
+// =============================================================================
+// TickView
+// =============================================================================
+
+TEST(TickViewTest, MatchesDeserialize) {
+  std::mt19937_64 rng(9);
+  for (int i = 0; i < 1000; ++i) {
+    uint32_t price_bits = static_cast<uint32_t>(rng());
+    float price;
+    memcpy(&price, &price_bits, 4);
+    int32_t volume = static_cast<int32_t>(rng());
+    std::string message = serialize_tick(i, rng(), "MSFT", price, volume);
+
+    TickPayload expected = deserialize_tick_payload(payload_of(message));
+    TickView view(payload_of(message));
+    ASSERT_EQ(view.timestamp(), expected.timestamp);
+    ASSERT_EQ(memcmp(view.symbol_bytes(), expected.symbol, 4), 0);
+    float view_price = view.price();
+    ASSERT_EQ(memcmp(&view_price, &expected.price, 4), 0);  // NaN payloads too
+    ASSERT_EQ(view.volume(), expected.volume);
+
+    TickPayload decoded = view.decode();
+    ASSERT_EQ(decoded.timestamp, expected.timestamp);
+    ASSERT_EQ(memcmp(decoded.symbol, expected.symbol, 4), 0);
+    ASSERT_EQ(memcmp(&decoded.price, &expected.price, 4), 0);
+    ASSERT_EQ(decoded.volume, expected.volume);
+  }
+}
+
+TEST(TickViewTest, SymbolWithoutDecoding) {
+  std::string message = serialize_tick(1, 2, "AB\0\0", 3.5f, 4);
+  TickView view(payload_of(message));
+  EXPECT_EQ(view.symbol(), "AB");
+  EXPECT_EQ(std::string(view.symbol()), trim_symbol(view.symbol_bytes(), 4));
+
+  std::string other = serialize_tick(1, 2, "AB\0\0", 9.0f, 7);
+  EXPECT_EQ(view.symbol_key(), TickView(payload_of(other)).symbol_key());
+  EXPECT_NE(view.symbol_key(), TickView(payload_of(serialize_tick(1, 2, "ABC", 3.5f, 4))).symbol_key());
+  EXPECT_EQ(view.data(), payload_of(message));
+}
+
+TEST(TickViewTest, ReadsAtAnyAlignment) {
+  std::string message = serialize_tick(1, 0x0102030405060708ULL, "GOOG", -1.25f, -42);
+  for (size_t shift = 0; shift < 8; ++shift) {
+    std::string buffer = std::string(shift, 'x') + message;
+    TickView view(buffer.data() + shift + MessageHeader::HEADER_SIZE);
+    EXPECT_EQ(view.timestamp(), 0x0102030405060708ULL);
+    EXPECT_EQ(view.symbol(), "GOOG");
+    EXPECT_EQ(view.price(), -1.25f);
+    EXPECT_EQ(view.volume(), -42);
+  }
+}
+
+TEST(TickViewTest, NetTickFromViewMatchesPayload) {
+  std::string message = serialize_tick(5, 123456789, "TSLA", 251.75f, 300);
+  net::Tick from_payload(deserialize_tick_payload(payload_of(message)), 77);
+  net::Tick from_view(TickView(payload_of(message)), 77);
+
+  EXPECT_EQ(from_view.timestamp, from_payload.timestamp);
+  EXPECT_STREQ(from_view.symbol, from_payload.symbol);
+  EXPECT_EQ(from_view.price, from_payload.price);
+  EXPECT_EQ(from_view.volume, from_payload.volume);
+  EXPECT_EQ(from_view.recv_timestamp_ns, 77u);
+}
+
+// =============================================================================
+// BookUpdateView
+// =============================================================================
+
+TEST(BookUpdateViewTest, MatchesDeserialize) {
+  const int64_t quantities[] = {0, 1, -1, INT64_MAX, INT64_MIN, 1'000'000'007};
+  for (uint8_t side : {0, 1}) {
+    for (int64_t quantity : quantities) {
+      std::string message = serialize_order_book_update(3, "AAPL", side, 150.25f, quantity);
+      OrderBookUpdatePayload expected = deserialize_order_book_update(payload_of(message));
+      BookUpdateView view(payload_of(message));
+
+      EXPECT_EQ(view.symbol(), "AAPL");
+      EXPECT_EQ(view.side(), expected.side);
+      EXPECT_EQ(view.price(), expected.price);
+      EXPECT_EQ(view.quantity(), expected.quantity);
+
+      OrderBookUpdatePayload decoded = view.decode();
+      EXPECT_EQ(memcmp(decoded.symbol, expected.symbol, 4), 0);
+      EXPECT_EQ(decoded.side, expected.side);
+      EXPECT_EQ(decoded.price, expected.price);
+      EXPECT_EQ(decoded.quantity, expected.quantity);
+    }
+  }
+}
+
+TEST(BookUpdateViewTest, SymbolBooksAppliesFromView) {
+  SymbolBooks by_view, by_struct;
+  for (SymbolBooks* books : {&by_view, &by_struct}) {
+    books->add("AAPL").state = BookState::VALID;
+    books->add("MSFT");  // RECOVERING
+  }
+
+  const struct {
+    const char* symbol;
+    uint8_t side;
+    float price;
+    int64_t quantity;
+    SymbolBooks::UpdateResult result;
+  } updates[] = {
+      {"AAPL", 0, 100.0f, 50, SymbolBooks::UpdateResult::APPLIED},
+      {"AAPL", 1, 101.0f, 20, SymbolBooks::UpdateResult::APPLIED},
+      {"TSLA", 0, 1.0f, 1, SymbolBooks::UpdateResult::UNKNOWN_SYMBOL},
+      {"MSFT", 0, 300.0f, 5, SymbolBooks::UpdateResult::BUFFERED},
+      {"AAPL", 0, 100.0f, 0, SymbolBooks::UpdateResult::APPLIED},
+  };
+
+  uint64_t sequence = 10;
+  for (const auto& u : updates) {
+    std::string message = serialize_order_book_update(sequence, u.symbol, u.side, u.price, u.quantity);
+    EXPECT_EQ(by_view.apply_update(sequence, BookUpdateView(payload_of(message))), u.result) << u.symbol;
+    EXPECT_EQ(by_struct.apply_update(sequence, deserialize_order_book_update(payload_of(message))),
+              u.result);
+    sequence++;
+  }
+
+  EXPECT_EQ(by_view.find("AAPL")->book.checksum(), by_struct.find("AAPL")->book.checksum());
+  EXPECT_EQ(by_view.find("AAPL")->last_sequence, 14u);
+
+  const auto& pending = by_view.find("MSFT")->pending;
+  ASSERT_EQ(pending.size(), 1u);
+  EXPECT_EQ(pending[0].first, 13u);
+  EXPECT_EQ(pending[0].second.price, 300.0f);
+  EXPECT_EQ(pending[0].second.quantity, 5);
+}
@@ -0,0 +1,268 @@
+/**
+ * Pooled-Buffer Multi-Connection Client Tests
+ *
+ * Covers:
+ *   - Frames split at every byte boundary, reassembled through the carry
+ *   - Partial frames too large for the inline carry spill to the heap, and
+ *     the allocation is freed once the frame completes
+ *   - Many ready connections share a small pool (flushing when it runs dry)
+ *     and no buffer stays lent out between wakeups
+ *   - The epoll batch grows under load and shrinks back when idle
+ *   - Protocol errors, peer closes and close() from inside the callback
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "binary_protocol.hpp"
+#include "multi_client.hpp"
+
+namespace {
+
+// Connected stream socket pair; the client takes `local`, tests write `peer`
+struct Pipe {
+  int local = -1;
+  int peer = -1;
+
+  Pipe() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0) {
+      local = fds[0];
+      peer = fds[1];
+    }
+  }
+
+  ~Pipe() {
+    if (peer >= 0) close(peer);
+  }
+
+  void write_all(const std::string &bytes) const {
+    size_t sent = 0;
+    while (sent < bytes.size()) {
+      ssize_t n = send(peer, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) return;
+      sent += n;
+    }
+  }
+};
+
+// A frame of any type and payload size, as the exchange would send it
+std::string frame(MessageType type, uint64_t sequence, size_t payload_size) {
+  std::string bytes(MessageHeader::HEADER_SIZE + payload_size, '\0');
+  uint32_t length = htonl(static_cast<uint32_t>(payload_size));
+  std::memcpy(&bytes[0], &length, 4);
+  bytes[4] = static_cast<char>(type);
+  for (size_t i = 0; i < 8; ++i) {
+    bytes[5 + i] = static_cast<char>(sequence >> (56 - 8 * i));
+  }
+  for (size_t i = 0; i < payload_size; ++i) {
+    bytes[MessageHeader::HEADER_SIZE + i] = static_cast<char>(i * 7);
+  }
+  return bytes;
+}
+
+// Poll until `frames` have arrived or 200 empty polls in a row
+void poll_for(MultiClient &client, uint64_t frames) {
+  int idle = 0;
+  while (client.stats().frames < frames && idle < 200) {
+    idle = client.poll(10) == 0 ? idle + 1 : 0;
+  }
+}
+
+} // namespace
+
+TEST(MultiClientTest, FramesSplitAtEveryByteBoundary) {
+  MultiClient client;
+  std::vector<uint64_t> sequences;
+  client.set_frame_callback([&](MultiClient::ConnectionId, const MessageHeader &header,
+                                const char *payload) {
+    sequences.push_back(header.sequence);
+    EXPECT_EQ(std::memcmp(payload + 8, "AAPL", 4), 0);
+  });
+  Pipe pipe;
+  ASSERT_TRUE(client.add(pipe.local).ok());
+
+  std::string tick = serialize_tick(1, 1000, "AAPL", 150.25f, 100);
+  for (size_t split = 1; split < tick.size(); ++split) {
+    std::string next = serialize_tick(split, 1000, "AAPL", 150.25f, 100);
+    pipe.write_all(next.substr(0, split));
+    client.poll(100);
+    EXPECT_EQ(client.carried_bytes(), split);
+    pipe.write_all(next.substr(split) + next);  // The rest, then a whole frame
+    poll_for(client, 2 * split);
+    EXPECT_EQ(client.carried_bytes(), 0u);
+    EXPECT_EQ(client.buffers_in_use(), 0u);
+  }
+
+  ASSERT_EQ(sequences.size(), 2 * (tick.size() - 1));
+  for (size_t i = 0; i < sequences.size(); ++i) {
+    ASSERT_EQ(sequences[i], i / 2 + 1);
+  }
+  EXPECT_GE(client.stats().carries, tick.size() - 1);
+  EXPECT_EQ(client.stats().carry_spills, 0u);
+}
+
+TEST(MultiClientTest, LargePartialFrameSpillsAndIsFreed) {
+  MultiClient client;
+  size_t payload_bytes = 0;
+  client.set_frame_callback([&](MultiClient::ConnectionId, const MessageHeader &header,
+                                const char *payload) {
+    payload_bytes += header.length;
+    for (uint32_t i = 0; i < header.length; ++i) {
+      ASSERT_EQ(payload[i], static_cast<char>(i * 7));
+    }
+  });
+  Pipe pipe;
+  ASSERT_TRUE(client.add(pipe.local).ok());
+  pipe.write_all(frame(MessageType::HEARTBEAT, 1, 0));
+  poll_for(client, 1);
+  size_t baseline = client.footprint_bytes();
+
+  std::string chunk = frame(MessageType::SNAPSHOT_CHUNK, 2, 8000);
+  pipe.write_all(chunk.substr(0, 5000));
+  client.poll(100);
+  EXPECT_EQ(client.carried_bytes(), 5000u);
+  EXPECT_EQ(client.stats().carry_spills, 1u);
+  EXPECT_GE(client.footprint_bytes(), baseline + 5000);
+
+  pipe.write_all(chunk.substr(5000));
+  poll_for(client, 2);
+  EXPECT_EQ(payload_bytes, 8000u);
+  EXPECT_EQ(client.carried_bytes(), 0u);
+  EXPECT_EQ(client.footprint_bytes(), baseline);
+
+  // The largest legal frame still fits a pooled buffer behind its carry
+  std::string largest = frame(MessageType::SNAPSHOT_CHUNK, 3, MessageHeader::MAX_PAYLOAD_SIZE);
+  pipe.write_all(largest.substr(0, 100));
+  client.poll(100);
+  pipe.write_all(largest.substr(100));
+  poll_for(client, 3);
+  EXPECT_EQ(payload_bytes, 8000u + MessageHeader::MAX_PAYLOAD_SIZE);
+}
+
+TEST(MultiClientTest, ConnectionsShareASmallPool) {
+  MultiClientConfig config;
+  config.pool_buffers = 4;
+  MultiClient client(config);
+  std::vector<size_t> per_connection(300, 0);
+  std::vector<Pipe> pipes(300);
+  std::vector<MultiClient::ConnectionId> ids;
+  for (auto &pipe : pipes) {
+    auto id = client.add(pipe.local);
+    ASSERT_TRUE(id.ok());
+    ids.push_back(id.value());
+  }
+  client.set_frame_callback([&](MultiClient::ConnectionId id, const MessageHeader &, const char *) {
+    per_connection[std::find(ids.begin(), ids.end(), id) - ids.begin()]++;
+  });
+
+  for (int round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < pipes.size(); ++i) {
+      pipes[i].write_all(serialize_tick(round + 1, i, "MSFT", 300.0f, 10));
+    }
+    poll_for(client, (round + 1) * pipes.size());
+    EXPECT_EQ(client.buffers_in_use(), 0u);
+  }
+
+  for (size_t count : per_connection) {
+    ASSERT_EQ(count, 3u);
+  }
+  const auto &stats = client.stats();
+  EXPECT_EQ(stats.pool_high_water, 4u);
+  EXPECT_GT(stats.pool_flushes, 0u);
+  // Four buffers and a slot per connection, not a buffer per connection
+  EXPECT_LT(client.footprint_bytes(),
+            4 * config.buffer_bytes + 300 * (MultiClient::session_bytes() + 64) + 64 * 1024);
+}
+
+TEST(MultiClientTest, BatchAdaptsToReadyConnections) {
+  MultiClientConfig config;
+  config.min_batch = 8;
+  config.max_batch = 512;
+  MultiClient client(config);
+  std::vector<Pipe> pipes(400);
+  for (auto &pipe : pipes) {
+    ASSERT_TRUE(client.add(pipe.local).ok());
+  }
+  EXPECT_EQ(client.batch_limit(), 8u);
+
+  // Everyone ready: the batch doubles with each full wakeup
+  for (auto &pipe : pipes) {
+    pipe.write_all(serialize_tick(1, 0, "GOOG", 100.0f, 1));
+  }
+  size_t largest = 0;
+  while (client.stats().frames < pipes.size()) {
+    client.poll(100);
+    largest = std::max(largest, client.batch_limit());
+  }
+  EXPECT_GE(largest, 128u);
+
+  // One ready at a time: back down to the floor
+  for (int i = 0; i < 10; ++i) {
+    pipes[0].write_all(serialize_tick(2 + i, 0, "GOOG", 100.0f, 1));
+    client.poll(100);
+  }
+  EXPECT_EQ(client.batch_limit(), 8u);
+  EXPECT_EQ(client.stats().frames, pipes.size() + 10);
+}
+
+TEST(MultiClientTest, ProtocolErrorsAndCloses) {
+  MultiClient client;
+  std::vector<MultiClient::ConnectionId> closed;
+  client.set_close_callback([&](MultiClient::ConnectionId id) { closed.push_back(id); });
+  size_t from_quitter = 0, from_good = 0;
+  MultiClient::ConnectionId quitter = 0;
+  client.set_frame_callback([&](MultiClient::ConnectionId id, const MessageHeader &, const char *) {
+    if (id == quitter) {
+      ++from_quitter;
+      EXPECT_TRUE(client.close(id));  // The rest of its buffer is dropped
+    } else {
+      ++from_good;
+    }
+  });
+
+  Pipe bad, quitting, good;
+  auto *hangup = new Pipe;
+  auto bad_id = client.add(bad.local).value();
+  quitter = client.add(quitting.local).value();
+  auto good_id = client.add(good.local).value();
+  auto hangup_id = client.add(hangup->local).value();
+
+  std::string oversized = frame(MessageType::TICK, 1, 0);
+  uint32_t length = htonl(MessageHeader::MAX_PAYLOAD_SIZE + 1);
+  std::memcpy(&oversized[0], &length, 4);
+  bad.write_all(oversized);
+  quitting.write_all(serialize_tick(1, 0, "AMZN", 1.0f, 1) + serialize_tick(2, 0, "AMZN", 1.0f, 1));
+  good.write_all(serialize_tick(1, 0, "TSLA", 1.0f, 1));
+  delete hangup;
+
+  for (int i = 0; i < 20 && closed.size() < 3; ++i) {
+    client.poll(50);
+  }
+  EXPECT_EQ(from_quitter, 1u);
+  EXPECT_EQ(from_good, 1u);
+  ASSERT_EQ(closed.size(), 3u);
+  EXPECT_NE(std::find(closed.begin(), closed.end(), bad_id), closed.end());
+  EXPECT_NE(std::find(closed.begin(), closed.end(), quitter), closed.end());
+  EXPECT_NE(std::find(closed.begin(), closed.end(), hangup_id), closed.end());
+  EXPECT_EQ(client.stats().protocol_errors, 1u);
+  EXPECT_EQ(client.connections(), 1u);
+
+  // Stale ids stay dead even once their slot is reused
+  EXPECT_FALSE(client.close(quitter));
+  Pipe late;
+  auto late_id = client.add(late.local).value();
+  EXPECT_NE(late_id, bad_id);
+  EXPECT_NE(late_id, quitter);
+  EXPECT_FALSE(client.close(bad_id));
+  EXPECT_TRUE(client.close(good_id));
+  EXPECT_EQ(client.connections(), 1u);
+}
@@ -301,6 +301,68 @@ TEST_F(OrderBookTest, BidAskSpread) {
   EXPECT_NEAR(mid, 100.05f, 0.0001f);
 }
 
+// Checksum tests
+TEST_F(OrderBookTest, ChecksumEmptyBookIsZero) {
+  EXPECT_EQ(book_.checksum(), 0u);
+
+  book_.apply_update(0, 100.0f, 10);
+  book_.apply_update(1, 101.0f, 20);
+  EXPECT_NE(book_.checksum(), 0u);
+
+  book_.apply_update(0, 100.0f, 0);
+  book_.apply_update(1, 101.0f, 0);
+  EXPECT_EQ(book_.checksum(), 0u);
+}
+
+TEST_F(OrderBookTest, ChecksumIsOrderIndependent) {
+  OrderBook other;
+  book_.apply_update(0, 10.0f, 5);
+  book_.apply_update(1, 11.0f, 7);
+  book_.apply_update(0, 9.0f, 1);
+
+  other.apply_update(0, 9.0f, 1);
+  other.apply_update(1, 11.0f, 3);
+  other.apply_update(0, 10.0f, 5);
+  EXPECT_NE(book_.checksum(), other.checksum());
+
+  other.apply_update(1, 11.0f, 7);  // Same state, different history
+  EXPECT_EQ(book_.checksum(), other.checksum());
+}
+
+TEST_F(OrderBookTest, ChecksumCoversSidePriceAndQuantity) {
+  OrderBook bid, ask, qty;
+  book_.apply_update(0, 10.0f, 5);
+  bid.apply_update(0, 10.5f, 5);
+  ask.apply_update(1, 10.0f, 5);
+  qty.apply_update(0, 10.0f, 6);
+
+  EXPECT_NE(book_.checksum(), bid.checksum());
+  EXPECT_NE(book_.checksum(), ask.checksum());
+  EXPECT_NE(book_.checksum(), qty.checksum());
+}
+
+TEST_F(OrderBookTest, ChecksumMatchesSnapshotOfSameState) {
+  book_.apply_update(0, 100.0f, 10);
+  book_.apply_update(0, 99.0f, 20);
+  book_.apply_update(1, 101.0f, 30);
+  book_.apply_update(0, 98.0f, 40);
+  book_.apply_update(0, 98.0f, 0);
+  book_.apply_update(1, 101.0f, 35);
+
+  OrderBook snap;
+  snap.load_snapshot(book_.get_top_bids(10), book_.get_top_asks(10));
+  EXPECT_EQ(snap.checksum(), book_.checksum());
+
+  // Invalid and no-op updates leave it alone
+  uint64_t before = book_.checksum();
+  book_.apply_update(0, 50.0f, 0);
+  book_.apply_update(0, 100.0f, -5);
+  EXPECT_EQ(book_.checksum(), before);
+
+  book_.clear();
+  EXPECT_EQ(book_.checksum(), 0u);
+}
+
 // Performance test
 TEST_F(OrderBookTest, UpdateThroughput) {
   constexpr size_t NUM_UPDATES = 100000;
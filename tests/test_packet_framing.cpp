@@ -0,0 +1,170 @@
+/**
+ * Multi-Message Packet Framing Tests
+ *
+ * Covers:
+ *   - Packets round-trip, numbering messages from the packet header
+ *   - A packet closes when full or when the sequence jumps
+ *   - The max-latency timer marks a packet due
+ *   - Truncated or inconsistent packets deliver nothing
+ *   - Coalesced stream writes keep each message's own framing
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "packet_framing.hpp"
+
+namespace {
+
+std::string tick(uint64_t sequence, float price = 100.0f) {
+  return serialize_tick(sequence, 1000 + sequence, "AAPL", price, 10);
+}
+
+struct Decoded {
+  MessageHeader header;
+  TickPayload tick;
+};
+
+std::vector<Decoded> decode(std::string_view packet, bool* ok = nullptr) {
+  std::vector<Decoded> out;
+  bool result = decode_packet(packet.data(), packet.size(),
+                              [&](const MessageHeader& header, const char* payload) {
+                                out.push_back({header, deserialize_tick_payload(payload)});
+                              });
+  if (ok) *ok = result;
+  return out;
+}
+
+} // namespace
+
+TEST(PacketFramingTest, RoundTripNumbersFromPacketHeader) {
+  PacketBatcher batcher("SESSION1");
+  for (uint64_t seq = 41; seq <= 45; ++seq) {
+    ASSERT_TRUE(batcher.append(tick(seq, 100.0f + seq), 0));
+  }
+  std::string_view packet = batcher.packet();
+  EXPECT_EQ(packet.size(),
+            PacketHeader::HEADER_SIZE + 5 * (PacketHeader::BLOCK_HEADER_SIZE + TickPayload::PAYLOAD_SIZE));
+
+  PacketHeader header = deserialize_packet_header(packet.data());
+  EXPECT_EQ(std::string(header.session, 10), "SESSION1  ");
+  EXPECT_EQ(header.sequence, 41u);
+  EXPECT_EQ(header.count, 5u);
+
+  bool ok = false;
+  auto messages = decode(packet, &ok);
+  ASSERT_TRUE(ok);
+  ASSERT_EQ(messages.size(), 5u);
+  for (size_t i = 0; i < messages.size(); ++i) {
+    EXPECT_EQ(messages[i].header.type, MessageType::TICK);
+    EXPECT_EQ(messages[i].header.sequence, 41 + i);
+    EXPECT_EQ(messages[i].header.length, TickPayload::PAYLOAD_SIZE);
+    EXPECT_EQ(messages[i].tick.timestamp, 1041 + i);
+    EXPECT_FLOAT_EQ(messages[i].tick.price, 141.0f + i);
+  }
+}
+
+TEST(PacketFramingTest, FullPacketRefusesNextMessage) {
+  PacketBatcher batcher("S", MAX_PACKET_SIZE);
+  const size_t fits = (MAX_PACKET_SIZE - PacketHeader::HEADER_SIZE) /
+                      (PacketHeader::BLOCK_HEADER_SIZE + TickPayload::PAYLOAD_SIZE);
+  uint64_t seq = 1;
+  for (; seq <= fits; ++seq) {
+    ASSERT_TRUE(batcher.append(tick(seq), 0));
+  }
+  EXPECT_FALSE(batcher.append(tick(seq), 0));
+  EXPECT_EQ(batcher.count(), fits);
+  EXPECT_LE(batcher.packet().size(), MAX_PACKET_SIZE);
+
+  // The refused message starts the next packet
+  batcher.clear();
+  ASSERT_TRUE(batcher.append(tick(seq), 0));
+  EXPECT_EQ(deserialize_packet_header(batcher.packet().data()).sequence, seq);
+}
+
+TEST(PacketFramingTest, SequenceJumpStartsNewPacket) {
+  PacketBatcher batcher("S");
+  ASSERT_TRUE(batcher.append(tick(1), 0));
+  ASSERT_TRUE(batcher.append(tick(2), 0));
+  EXPECT_FALSE(batcher.append(tick(4), 0));  // Numbering is implicit: no holes
+  EXPECT_EQ(batcher.count(), 2u);
+}
+
+TEST(PacketFramingTest, DueAfterMaxLatency) {
+  PacketBatcher batcher("S", MAX_PACKET_SIZE, 50'000);
+  EXPECT_FALSE(batcher.due(1'000'000));  // Nothing pending
+  batcher.append(tick(1), 1'000'000);
+  batcher.append(tick(2), 1'040'000);
+  EXPECT_FALSE(batcher.due(1'049'999));
+  EXPECT_TRUE(batcher.due(1'050'000));   // Timed from the oldest message
+  EXPECT_EQ(batcher.deadline(), 1'050'000u);
+}
+
+TEST(PacketFramingTest, TruncatedPacketDeliversNothing) {
+  PacketBatcher batcher("S");
+  batcher.append(tick(1), 0);
+  batcher.append(tick(2), 0);
+  std::string packet(batcher.packet());
+
+  bool ok = true;
+  EXPECT_TRUE(decode(packet.substr(0, packet.size() - 1), &ok).empty());
+  EXPECT_FALSE(ok);
+  EXPECT_TRUE(decode(packet.substr(0, 10), &ok).empty());
+  EXPECT_FALSE(ok);
+
+  // Count says one more message than the packet holds
+  packet[19] = 3;
+  EXPECT_TRUE(decode(packet, &ok).empty());
+  EXPECT_FALSE(ok);
+
+  // Trailing bytes past the last counted block
+  packet[19] = 1;
+  EXPECT_TRUE(decode(packet, &ok).empty());
+  EXPECT_FALSE(ok);
+}
+
+TEST(PacketFramingTest, EmptyPacketIsValid) {
+  std::string packet;
+  serialize_packet_header(packet, "HEARTBEAT ", 77, 0);
+  bool ok = false;
+  EXPECT_TRUE(decode(packet, &ok).empty());
+  EXPECT_TRUE(ok);
+}
+
+TEST(PacketFramingTest, OversizedMessageGetsItsOwnPacket) {
+  PacketBatcher batcher("S", 64);  // Smaller than one snapshot response
+  std::vector<OrderBookLevel> levels(10, {100.0f, 5});
+  std::string big = serialize_snapshot_response(9, "AAPL", levels, levels);
+  ASSERT_TRUE(batcher.append(big, 0));
+  EXPECT_FALSE(batcher.append(tick(10), 0));
+
+  bool ok = false;
+  size_t seen = 0;
+  std::string_view packet = batcher.packet();
+  ok = decode_packet(packet.data(), packet.size(), [&](const MessageHeader& header, const char*) {
+    EXPECT_EQ(header.type, MessageType::SNAPSHOT_RESPONSE);
+    EXPECT_EQ(header.length + MessageHeader::HEADER_SIZE, big.size());
+    seen++;
+  });
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(seen, 1u);
+}
+
+TEST(PacketFramingTest, WriteBatcherKeepsMessageFraming) {
+  WriteBatcher batcher(100, 10'000);
+  std::string a = tick(1), b = tick(2), c = tick(3), d = tick(4);
+  ASSERT_TRUE(batcher.append(a, 5));
+  ASSERT_TRUE(batcher.append(b, 6));
+  ASSERT_TRUE(batcher.append(c, 7));
+  EXPECT_FALSE(batcher.append(d, 8));  // 4 x 33 bytes > 100
+  EXPECT_EQ(batcher.data(), a + b + c);
+  EXPECT_TRUE(batcher.due(10'005));
+  EXPECT_FALSE(batcher.due(10'004));
+
+  batcher.clear();
+  EXPECT_TRUE(batcher.empty());
+  ASSERT_TRUE(batcher.append(d, 20));
+  EXPECT_EQ(batcher.data(), d);
+}
@@ -0,0 +1,270 @@
+/**
+ * Parallel Snapshot Recovery Tests
+ *
+ * Covers:
+ *   - Every book arrives intact, split across connections and shards
+ *   - A single connection asks for "ALL"; several ask for partitions
+ *   - Bad snapshots are reported, not installed
+ *   - Chunks whose levels overrun the payload fail the book
+ *   - An impossible frame length ends the connection as an error
+ *   - Connect failure is an error, not a hang
+ */
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "parallel_recovery.hpp"
+
+namespace {
+
+OrderBook make_book(size_t i, size_t levels) {
+  OrderBook book;
+  for (size_t l = 1; l <= levels; ++l) {
+    book.apply_update(0, 100.0f + i - l * 0.01f, static_cast<int64_t>(10 * l + i));
+    book.apply_update(1, 100.0f + i + l * 0.01f, static_cast<int64_t>(20 * l + i));
+  }
+  return book;
+}
+
+std::string symbol_for(size_t i) {
+  char name[5];
+  snprintf(name, sizeof(name), "S%03zu", i);
+  return name;
+}
+
+// Minimal snapshot channel: each connection reads one request and sends the
+// matching books as chunked snapshots, then closes
+class SnapshotChannel {
+public:
+  SnapshotChannel(size_t symbols, size_t levels) {
+    for (size_t i = 0; i < symbols; ++i) {
+      books_[symbol_for(i)] = make_book(i, levels);
+    }
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    listen(fd_, 16);
+    getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+  }
+
+  ~SnapshotChannel() {
+    shutdown(fd_, SHUT_RDWR);
+    close(fd_);
+    if (acceptor_.joinable()) acceptor_.join();
+    for (auto &session : sessions_) session.join();
+  }
+
+  void serve(size_t connections) {
+    acceptor_ = std::thread([this, connections] {
+      for (size_t c = 0; c < connections; ++c) {
+        int client = accept(fd_, nullptr, nullptr);
+        if (client < 0) return;
+        sessions_.emplace_back([this, client] { serve_connection(client); });
+      }
+    });
+  }
+
+  void corrupt(const std::string &symbol) { corrupt_ = symbol; }
+  // The bid chunk claims one level more than it carries
+  void overrun_chunk(const std::string &symbol) { overrun_ = symbol; }
+  // A frame longer than MAX_PAYLOAD_SIZE goes out just before this symbol
+  void bad_frame_before(const std::string &symbol) { bad_frame_ = symbol; }
+  int port() const { return port_; }
+  const std::map<std::string, OrderBook> &books() const { return books_; }
+
+  std::vector<MessageType> requests() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return requests_;
+  }
+
+private:
+  void serve_connection(int client) {
+    char request[MessageHeader::HEADER_SIZE + 4];
+    if (recv(client, request, sizeof(request), MSG_WAITALL) != sizeof(request)) {
+      close(client);
+      return;
+    }
+    MessageHeader header = deserialize_header(request);
+    uint32_t partition = 0, partitions = 1;
+    if (header.type == MessageType::PARTITION_SNAPSHOT_REQUEST) {
+      auto p = deserialize_partition_snapshot_request(request + MessageHeader::HEADER_SIZE);
+      partition = p.partition;
+      partitions = p.partitions;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      requests_.push_back(header.type);
+    }
+
+    uint32_t id = 0;
+    for (const auto &[symbol, book] : books_) {
+      if (symbol_partition(symbol.data(), partitions) != partition) continue;
+      auto bids = book.get_top_bids(book.bid_depth());
+      auto asks = book.get_top_asks(book.ask_depth());
+      uint64_t checksum = book.checksum() + (symbol == corrupt_ ? 1 : 0);
+
+      std::string out;
+      if (symbol == bad_frame_) {
+        out = serialize_heartbeat(7, 0);
+        uint32_t length_net = htonl(MessageHeader::MAX_PAYLOAD_SIZE + 1);
+        memcpy(&out[0], &length_net, 4);
+      }
+      out += serialize_snapshot_begin(7, symbol.data(), ++id, bids.size(), asks.size());
+      std::string bid_chunk = serialize_snapshot_chunk(7, symbol.data(), id, 0, 0, bids.data(), bids.size());
+      if (symbol == overrun_) {
+        uint16_t count_net = htons(static_cast<uint16_t>(bids.size() + 1));
+        memcpy(&bid_chunk[MessageHeader::HEADER_SIZE + 13], &count_net, 2);
+      }
+      out += bid_chunk;
+      out += serialize_snapshot_chunk(7, symbol.data(), id, 1, 1, asks.data(), asks.size());
+      out += serialize_snapshot_end(7, symbol.data(), id, 2, checksum);
+      send(client, out.data(), out.size(), MSG_NOSIGNAL);
+    }
+    close(client);
+  }
+
+  std::map<std::string, OrderBook> books_;
+  std::string corrupt_;
+  std::string overrun_;
+  std::string bad_frame_;
+  int fd_ = -1;
+  int port_ = 0;
+  std::thread acceptor_;
+  std::vector<std::thread> sessions_;
+  std::mutex mutex_;
+  std::vector<MessageType> requests_;
+};
+
+// Run to completion, collecting every finished book
+std::map<std::string, RecoveredBook> recover_all(ParallelSnapshotRecovery &recovery) {
+  std::map<std::string, RecoveredBook> result;
+  bool finished = false;
+  while (!finished) {
+    finished = recovery.finished();
+    for (auto &book : recovery.take_completed()) {
+      result.emplace(book.symbol, std::move(book));
+    }
+  }
+  recovery.join();
+  return result;
+}
+
+} // namespace
+
+TEST(ParallelRecoveryTest, EveryBookRecoveredAcrossShards) {
+  SnapshotChannel channel(300, 5);
+  channel.serve(3);
+
+  ParallelSnapshotRecovery recovery(4, 3);
+  ASSERT_TRUE(recovery.start("127.0.0.1", channel.port()).ok());
+  auto recovered = recover_all(recovery);
+
+  ASSERT_EQ(recovered.size(), 300u);
+  for (const auto &[symbol, book] : channel.books()) {
+    ASSERT_EQ(recovered.count(symbol), 1u) << symbol;
+    EXPECT_EQ(recovered.at(symbol).book.checksum(), book.checksum()) << symbol;
+    EXPECT_EQ(recovered.at(symbol).sequence, 7u);
+  }
+  EXPECT_EQ(recovery.books_recovered(), 300u);
+  EXPECT_EQ(recovery.levels_recovered(), 300u * 10);
+  EXPECT_TRUE(recovery.take_failed().empty());
+
+  // Each shard loaded exactly the symbols hashed to it
+  size_t expected[4] = {};
+  for (const auto &[symbol, book] : channel.books()) {
+    expected[symbol_partition(symbol.data(), 4)]++;
+  }
+  for (size_t shard = 0; shard < 4; ++shard) {
+    EXPECT_EQ(recovery.books_on_shard(shard), expected[shard]) << "shard " << shard;
+  }
+
+  auto requests = channel.requests();
+  ASSERT_EQ(requests.size(), 3u);
+  for (auto type : requests) EXPECT_EQ(type, MessageType::PARTITION_SNAPSHOT_REQUEST);
+}
+
+TEST(ParallelRecoveryTest, SingleConnectionAsksForAll) {
+  SnapshotChannel channel(20, 3);
+  channel.serve(1);
+
+  ParallelSnapshotRecovery recovery(2, 1);
+  ASSERT_TRUE(recovery.start("127.0.0.1", channel.port()).ok());
+  EXPECT_EQ(recover_all(recovery).size(), 20u);
+
+  auto requests = channel.requests();
+  ASSERT_EQ(requests.size(), 1u);
+  EXPECT_EQ(requests[0], MessageType::SNAPSHOT_REQUEST);
+}
+
+TEST(ParallelRecoveryTest, BadChecksumReportedNotInstalled) {
+  SnapshotChannel channel(50, 3);
+  channel.corrupt("S017");
+  channel.serve(2);
+
+  ParallelSnapshotRecovery recovery(3, 2);
+  ASSERT_TRUE(recovery.start("127.0.0.1", channel.port()).ok());
+  auto recovered = recover_all(recovery);
+
+  EXPECT_EQ(recovered.size(), 49u);
+  EXPECT_EQ(recovered.count("S017"), 0u);
+  auto failed = recovery.take_failed();
+  ASSERT_EQ(failed.size(), 1u);
+  EXPECT_EQ(failed[0], "S017");
+}
+
+TEST(ParallelRecoveryTest, ConnectFailureIsAnError) {
+  int port;
+  {
+    SnapshotChannel closed(0, 0);  // Bound then closed: nothing listening
+    port = closed.port();
+  }
+  ParallelSnapshotRecovery recovery(2, 2);
+  auto result = recovery.start("127.0.0.1", port);
+  EXPECT_FALSE(result.ok());
+  EXPECT_NE(result.error().find("connect failed"), std::string::npos);
+}
+
+TEST(ParallelRecoveryTest, OverrunningChunkFailsTheBook) {
+  SnapshotChannel channel(50, 3);
+  channel.overrun_chunk("S023");
+  channel.serve(2);
+
+  ParallelSnapshotRecovery recovery(3, 2);
+  ASSERT_TRUE(recovery.start("127.0.0.1", channel.port()).ok());
+  auto recovered = recover_all(recovery);
+
+  EXPECT_EQ(recovered.size(), 49u);
+  EXPECT_EQ(recovered.count("S023"), 0u);
+  auto failed = recovery.take_failed();
+  ASSERT_EQ(failed.size(), 1u);
+  EXPECT_EQ(failed[0], "S023");
+}
+
+TEST(ParallelRecoveryTest, OversizedFrameEndsConnection) {
+  SnapshotChannel channel(20, 3);
+  channel.bad_frame_before("S010");
+  channel.serve(1);
+
+  ParallelSnapshotRecovery recovery(2, 1);
+  ASSERT_TRUE(recovery.start("127.0.0.1", channel.port()).ok());
+  auto recovered = recover_all(recovery);
+
+  // Everything before the bad frame loaded; nothing after it was trusted
+  EXPECT_EQ(recovered.size(), 10u);
+  EXPECT_EQ(recovered.count("S010"), 0u);
+  EXPECT_EQ(recovery.connection_errors(), 1u);
+}
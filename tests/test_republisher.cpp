@@ -0,0 +1,328 @@
+/**
+ * TCP Republisher Tests
+ *
+ * Covers:
+ *   - Every client receives every event as binary protocol frames with
+ *     consecutive sequences
+ *   - Frames are coalesced into few sends, and still go out within the
+ *     max-delay bound when traffic stops
+ *   - publish() never blocks: a full event queue counts overruns
+ *   - Slow clients: DISCONNECT closes only the slow client; DROP keeps it
+ *     connected with sequence gaps and intact frames
+ *   - An idle republisher sleeps rather than spins, and publish() wakes it
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <poll.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "message_views.hpp"
+#include "republisher.hpp"
+
+namespace {
+
+DistributionEvent tick_event(uint64_t timestamp, const char* symbol) {
+  DistributionEvent event;
+  memcpy(event.symbol, symbol, 4);
+  event.timestamp = timestamp;
+  event.price = 100.0f;
+  event.quantity = 10;
+  return event;
+}
+
+struct TestClient {
+  int fd = -1;
+  std::string buffer;
+  std::vector<uint64_t> sequences;
+  std::vector<std::string> frames;
+  bool closed = false;
+
+  explicit TestClient(int port, int recv_buffer = 0) {
+    SocketOptions opts;
+    opts.recv_buffer_size = recv_buffer;
+    auto connected = socket_connect("127.0.0.1", port, opts);
+    EXPECT_TRUE(connected.ok());
+    if (connected) fd = connected.value();
+  }
+
+  ~TestClient() {
+    if (fd >= 0) close(fd);
+  }
+
+  // Read what arrives within timeout_ms and split it into frames
+  void read(int timeout_ms) {
+    pollfd p{fd, POLLIN, 0};
+    if (closed || ::poll(&p, 1, timeout_ms) <= 0) return;
+    char chunk[65536];
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+      closed = true;
+      return;
+    }
+    buffer.append(chunk, n);
+    size_t offset = 0;
+    while (buffer.size() - offset >= MessageHeader::HEADER_SIZE) {
+      MessageHeader header = deserialize_header(buffer.data() + offset);
+      size_t size = MessageHeader::HEADER_SIZE + header.length;
+      if (buffer.size() - offset < size) break;
+      sequences.push_back(header.sequence);
+      frames.emplace_back(buffer, offset, size);
+      offset += size;
+    }
+    buffer.erase(0, offset);
+  }
+};
+
+uint64_t process_cpu_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + ts.tv_nsec;
+}
+
+template <typename Done>
+bool wait_for(Done&& done, int seconds = 5) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (done()) return true;
+    usleep(100);
+  }
+  return false;
+}
+
+} // namespace
+
+TEST(RepublisherTest, EveryClientGetsEveryFrame) {
+  TcpRepublisher republisher;
+  ASSERT_TRUE(republisher.start().ok());
+
+  TestClient a(republisher.port()), b(republisher.port());
+  ASSERT_TRUE(wait_for([&] { return republisher.clients() == 2; }));
+
+  const uint64_t total = 5000;
+  for (uint64_t i = 0; i < total; ++i) {
+    if (i % 10 == 9) {
+      DistributionEvent update;
+      update.type = MessageType::ORDER_BOOK_UPDATE;
+      memcpy(update.symbol, "MSFT", 4);
+      update.side = 1;
+      update.price = 411.0f;
+      update.quantity = -7;
+      while (!republisher.publish(update)) usleep(10);
+    } else {
+      while (!republisher.publish(tick_event(i, "AAPL"))) usleep(10);
+    }
+  }
+
+  for (TestClient* client : {&a, &b}) {
+    ASSERT_TRUE(wait_for([&] {
+      client->read(10);
+      return client->sequences.size() == total;
+    }));
+    for (uint64_t i = 0; i < total; ++i) {
+      ASSERT_EQ(client->sequences[i], i + 1);
+    }
+    EXPECT_EQ(client->frames[0], serialize_tick(1, 0, "AAPL", 100.0f, 10));
+    EXPECT_EQ(client->frames[9], serialize_order_book_update(10, "MSFT", 1, 411.0f, -7));
+  }
+  EXPECT_EQ(republisher.events_published(), total);
+  EXPECT_EQ(republisher.frames_sent(), 2 * total);
+  EXPECT_EQ(republisher.slow_disconnects(), 0u);
+}
+
+TEST(RepublisherTest, CoalescesUnderTheDelayBound) {
+  RepublisherConfig config;
+  config.max_delay_us = 20'000;
+  TcpRepublisher republisher(config);
+  ASSERT_TRUE(republisher.start().ok());
+
+  TestClient client(republisher.port());
+  ASSERT_TRUE(wait_for([&] { return republisher.clients() == 1; }));
+
+  // A burst well inside one delay window goes out in a handful of sends
+  const uint64_t start = now_ns();
+  for (uint64_t i = 0; i < 200; ++i) {
+    ASSERT_TRUE(republisher.publish(tick_event(i, "AAPL")));
+  }
+  ASSERT_TRUE(wait_for([&] {
+    client.read(10);
+    return client.sequences.size() == 200;
+  }));
+  const uint64_t elapsed = now_ns() - start;
+  EXPECT_LE(republisher.batches(), 5u);
+  EXPECT_LT(elapsed, 1'000'000'000ULL);  // Held for the delay, not indefinitely
+
+  // A lone event still goes out once it is max_delay old
+  ASSERT_TRUE(republisher.publish(tick_event(200, "AAPL")));
+  ASSERT_TRUE(wait_for([&] {
+    client.read(10);
+    return client.sequences.size() == 201;
+  }));
+}
+
+TEST(RepublisherTest, IdleThreadSleepsUntilPublished) {
+  RepublisherConfig config;
+  config.max_delay_us = 500;  // Sub-millisecond: slept on a timer, not epoll's ms
+  TcpRepublisher republisher(config);
+  ASSERT_TRUE(republisher.start().ok());
+
+  TestClient client(republisher.port());
+  ASSERT_TRUE(wait_for([&] { return republisher.clients() == 1; }));
+  ASSERT_TRUE(republisher.publish(tick_event(1, "AAPL")));
+  ASSERT_TRUE(wait_for([&] {
+    client.read(10);
+    return client.sequences.size() == 1;
+  }));
+
+  // Only the republisher thread runs while we sleep; spinning would use it all
+  const uint64_t cpu_start = process_cpu_ns();
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  EXPECT_LT(process_cpu_ns() - cpu_start, 60'000'000ULL);
+
+  // publish() wakes it well before the idle timeout
+  const uint64_t start = now_ns();
+  ASSERT_TRUE(republisher.publish(tick_event(2, "AAPL")));
+  ASSERT_TRUE(wait_for([&] {
+    client.read(1);
+    return client.sequences.size() == 2;
+  }));
+  EXPECT_LT(now_ns() - start, 50'000'000ULL);
+}
+
+TEST(RepublisherTest, BusyPollIsOptIn) {
+  RepublisherConfig config;
+  EXPECT_FALSE(config.busy_poll);
+  config.busy_poll = true;
+  TcpRepublisher republisher(config);
+  ASSERT_TRUE(republisher.start().ok());
+
+  TestClient client(republisher.port());
+  ASSERT_TRUE(wait_for([&] { return republisher.clients() == 1; }));
+  for (uint64_t i = 0; i < 10; ++i) {
+    ASSERT_TRUE(republisher.publish(tick_event(i, "AAPL")));
+  }
+  ASSERT_TRUE(wait_for([&] {
+    client.read(10);
+    return client.sequences.size() == 10;
+  }));
+}
+
+TEST(RepublisherTest, PublishNeverBlocks) {
+  RepublisherConfig config;
+  config.event_queue_size = 16;
+  TcpRepublisher republisher(config);  // Not started: nothing drains the queue
+
+  size_t accepted = 0;
+  for (int i = 0; i < 100; ++i) {
+    accepted += republisher.publish(tick_event(i, "AAPL"));
+  }
+  EXPECT_EQ(accepted, 15u);
+  EXPECT_EQ(republisher.overruns(), 85u);
+}
+
+TEST(RepublisherTest, DisconnectPolicyClosesOnlyTheSlowClient) {
+  RepublisherConfig config;
+  config.client_queue_bytes = 64 * 1024;
+  config.policy = SlowClientPolicy::DISCONNECT;
+  TcpRepublisher republisher(config);
+  ASSERT_TRUE(republisher.start().ok());
+
+  TestClient fast(republisher.port());
+  TestClient slow(republisher.port(), 4096);  // Never reads
+  ASSERT_TRUE(wait_for([&] { return republisher.clients() == 2; }));
+
+  // Far more than the slow client's socket buffers plus its queue
+  const uint64_t total = 300000;
+  uint64_t published = 0;
+  ASSERT_TRUE(wait_for([&] {
+    while (published < total && republisher.publish(tick_event(published, "AAPL"))) {
+      published++;
+    }
+    fast.read(0);
+    return fast.sequences.size() == total;
+  }, 20));
+
+  EXPECT_EQ(republisher.slow_disconnects(), 1u);
+  EXPECT_TRUE(wait_for([&] { return republisher.clients() == 1; }));
+  for (uint64_t i = 0; i < total; ++i) {
+    ASSERT_EQ(fast.sequences[i], i + 1);  // Nothing lost
+  }
+
+  // The slow client drains what the kernel held, then sees the close
+  while (!slow.closed) slow.read(1000);
+  EXPECT_GT(slow.sequences.size(), 0u);
+  EXPECT_LT(slow.sequences.size(), total);
+}
+
+TEST(RepublisherTest, DropPolicyKeepsTheSlowClientWithGaps) {
+  RepublisherConfig config;
+  config.client_queue_bytes = 64 * 1024;
+  config.log_bytes = 64 * 1024 * 1024;  // Room for the slow client's oldest frame
+  config.policy = SlowClientPolicy::DROP;
+  TcpRepublisher republisher(config);
+  ASSERT_TRUE(republisher.start().ok());
+
+  TestClient slow(republisher.port(), 4096);
+  ASSERT_TRUE(wait_for([&] { return republisher.clients() == 1; }));
+
+  const uint64_t total = 300000;
+  uint64_t published = 0;
+  ASSERT_TRUE(wait_for([&] {
+    while (published < total && republisher.publish(tick_event(published, "AAPL"))) {
+      published++;
+    }
+    return published == total && republisher.events_published() == total;
+  }, 20));
+  ASSERT_TRUE(wait_for([&] { return republisher.frames_dropped() > 0; }));
+
+  // Now it reads and catches up: what follows arrives whole, after a gap
+  // where frames were dropped
+  size_t seen;
+  do {
+    seen = slow.sequences.size();
+    for (int i = 0; i < 20; ++i) slow.read(10);
+  } while (slow.sequences.size() != seen);
+  const uint64_t more = 100;
+  for (uint64_t i = 0; i < more; ++i) {
+    ASSERT_TRUE(wait_for([&] { return republisher.publish(tick_event(total + i, "AAPL")); }));
+  }
+  ASSERT_TRUE(wait_for([&] {
+    slow.read(10);
+    return !slow.sequences.empty() && slow.sequences.back() == total + more;
+  }, 20));
+  EXPECT_EQ(republisher.slow_disconnects(), 0u);
+  EXPECT_EQ(republisher.clients(), 1u);
+  EXPECT_EQ(slow.sequences.size() + republisher.frames_dropped(), total + more);
+
+  bool gap = false;
+  for (size_t i = 1; i < slow.sequences.size(); ++i) {
+    ASSERT_GT(slow.sequences[i], slow.sequences[i - 1]);
+    gap |= slow.sequences[i] != slow.sequences[i - 1] + 1;
+  }
+  EXPECT_TRUE(gap);
+  for (const std::string& frame : slow.frames) {
+    ASSERT_EQ(TickView(frame.data() + MessageHeader::HEADER_SIZE).symbol(), "AAPL");
+  }
+}
+
+TEST(RepublisherTest, StopDrainsQueuedFramesThenCloses) {
+  RepublisherConfig config;
+  config.max_delay_us = 1'000'000;  // Only stop() would flush these
+  TcpRepublisher republisher(config);
+  ASSERT_TRUE(republisher.start().ok());
+
+  TestClient client(republisher.port());
+  ASSERT_TRUE(wait_for([&] { return republisher.clients() == 1; }));
+  for (uint64_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(republisher.publish(tick_event(i, "AAPL")));
+  }
+  republisher.stop();
+
+  while (!client.closed) client.read(1000);
+  EXPECT_EQ(client.sequences.size(), 100u);
+}
@@ -274,6 +274,17 @@ TEST_F(SequenceTrackerResetTest, MultipleResets) {
   EXPECT_EQ(tracker_.last_sequence().value(), 999);
 }
 
+TEST_F(SequenceTrackerResetTest, ResumeFromKnownPosition) {
+  tracker_.resume_from(41);
+
+  EXPECT_TRUE(tracker_.has_received_message());
+  EXPECT_TRUE(tracker_.process_sequence(42));
+
+  // A gap right after the resume point is still detected
+  tracker_.resume_from(100);
+  EXPECT_FALSE(tracker_.process_sequence(105));
+}
+
 // =============================================================================
 // Boundary Value Tests
 // =============================================================================
@@ -0,0 +1,304 @@
+/**
+ * Session Simulation Tests
+ *
+ * Covers:
+ *   - SimScheduler: time order, then scheduling order; run_until
+ *   - SimNetwork: byte order under jitter and segmentation, refused
+ *     connects, end of stream after data in flight, resets
+ *   - FeedSession in virtual time against SimExchange: exact recovery
+ *     time, books converging with the exchange, reconnect after dropped
+ *     connections, connect backoff while the exchange refuses, heartbeat
+ *     timeouts while it is quiet, resync after lost updates
+ *   - The same seeds give the same counters, run after run
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "session_sim.hpp"
+
+namespace {
+
+constexpr uint64_t MS = 1'000'000;
+constexpr uint64_t SEC = 1'000 * MS;
+
+const std::vector<std::string> SYMBOLS = {"AAPL", "MSFT", "GOOG", "AMZN"};
+
+SimExchangeConfig exchange_config() {
+  SimExchangeConfig config;
+  config.symbols = SYMBOLS;
+  return config;
+}
+
+FeedSessionConfig session_config() {
+  FeedSessionConfig config;
+  config.port = 9999;
+  config.symbols = SYMBOLS;
+  return config;
+}
+
+// Stop the market, let what is in flight arrive, compare every book
+void expect_books_match(Simulation &sim, SimExchange &exchange, const FeedSession &session) {
+  exchange.freeze_market(true);
+  sim.run_for(100 * MS);
+  ASSERT_TRUE(session.live());
+  for (const auto &symbol : SYMBOLS) {
+    const SymbolBook &entry = session.books().books().at(symbol);
+    EXPECT_EQ(entry.state, BookState::VALID) << symbol;
+    EXPECT_EQ(entry.book.checksum(), exchange.book(symbol).checksum()) << symbol;
+  }
+  exchange.freeze_market(false);
+}
+
+} // namespace
+
+TEST(SimSchedulerTest, RunsInTimeOrderThenSchedulingOrder) {
+  SimScheduler scheduler(0);
+  std::vector<int> order;
+  scheduler.at(30, [&] { order.push_back(3); });
+  scheduler.at(10, [&] { order.push_back(1); });
+  scheduler.at(10, [&] {
+    order.push_back(2);
+    scheduler.after(0, [&] { order.push_back(4); });  // Same instant, after everything queued
+  });
+  scheduler.at(10, [&] { order.push_back(5); });
+  scheduler.run_until(20);
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 5, 4}));
+  EXPECT_EQ(scheduler.now(), 20u);
+  scheduler.run_until(100);
+  EXPECT_EQ(order.back(), 3);
+  EXPECT_EQ(scheduler.now(), 100u);
+  EXPECT_EQ(scheduler.events_run(), 5u);
+}
+
+TEST(SimNetworkTest, StreamsStayOrderedUnderJitterAndSegments) {
+  SimScheduler scheduler(0);
+  SimNetworkConfig config;
+  config.latency_ns = 1000;
+  config.jitter_ns = 5000;
+  config.segment_bytes = 7;
+  SimNetwork network(scheduler, config);
+
+  // Nobody listening yet: refused after a round trip
+  int refused = network.connect("sim", 80);
+  EXPECT_FALSE(network.connect_done(refused));
+  scheduler.run_until(10'000);
+  EXPECT_TRUE(network.connect_done(refused));
+  EXPECT_EQ(network.connect_error(refused), ECONNREFUSED);
+  network.close(refused);
+
+  std::string received;
+  bool closed = false;
+  int server = -1;
+  network.listen(80, [&](int fd) {
+    server = fd;
+    network.set_handlers(
+        fd, [&](int, const char *data, size_t len) { received.append(data, len); },
+        [&](int) { closed = true; });
+  });
+  int client = network.connect("sim", 80);
+  scheduler.run_until(scheduler.now() + 2000);
+  ASSERT_TRUE(network.connect_done(client));
+  ASSERT_EQ(network.connect_error(client), 0);
+
+  std::string sent;
+  for (int i = 0; i < 500; ++i) {
+    std::string chunk = "frame-" + std::to_string(1000 + i) + ",";
+    sent += chunk;
+    ASSERT_EQ(network.send(client, chunk.data(), chunk.size()), static_cast<ssize_t>(chunk.size()));
+  }
+  network.close(client);  // End of stream reaches the server after the data
+  scheduler.run_until(scheduler.now() + 100'000);
+  EXPECT_EQ(received, sent);
+  EXPECT_TRUE(closed);
+  EXPECT_EQ(network.stats().segments, 1000u);  // 11 bytes each: 7 + 4
+
+  // The other way, read through the client side of SessionIo
+  int client2 = network.connect("sim", 80);
+  scheduler.run_until(scheduler.now() + 2000);
+  ASSERT_GE(server, 0);
+  network.set_handlers(server, nullptr, nullptr);
+  network.send(server, "hello", 5);
+  char buffer[16];
+  EXPECT_EQ(network.recv(client2, buffer, sizeof(buffer)), -1);
+  EXPECT_EQ(errno, EAGAIN);
+  scheduler.run_until(scheduler.now() + 10'000);
+  EXPECT_EQ(network.recv(client2, buffer, sizeof(buffer)), 5);
+  network.reset(server);
+  EXPECT_EQ(network.recv(client2, buffer, sizeof(buffer)), -1);
+  EXPECT_EQ(errno, ECONNRESET);
+  EXPECT_EQ(network.send(client2, "x", 1), -1);
+}
+
+TEST(SessionSimTest, GoesLiveInExactlyTwoRoundTripsAndTracksTheExchange) {
+  Simulation sim;  // 50 us one way
+  SimExchange &exchange = sim.add_exchange(exchange_config());
+  FeedSession session(sim.reactor(), session_config());
+  session.start();
+
+  sim.run_for(10 * SEC + MS);  // The heartbeat and checksums sent at 10 s arrive
+  // Handshake round trip, then requests out and snapshots back
+  EXPECT_EQ(session.stats().last_recovery_ns, 200'000u);
+  EXPECT_EQ(session.stats().connects, 1u);
+  EXPECT_EQ(session.stats().snapshots, SYMBOLS.size());
+  EXPECT_EQ(session.stats().gaps, 0u);
+  EXPECT_GT(session.stats().updates_applied, 9000u);
+  EXPECT_EQ(session.stats().heartbeats, 100u);
+  EXPECT_EQ(session.stats().checksums_verified, 20u * SYMBOLS.size());
+  EXPECT_EQ(session.stats().checksum_mismatches, 0u);
+  expect_books_match(sim, exchange, session);
+}
+
+TEST(SessionSimTest, ReconnectsAndResnapshotsAfterDroppedConnections) {
+  Simulation sim;
+  SimExchange &exchange = sim.add_exchange(exchange_config());
+  FeedSession session(sim.reactor(), session_config());
+  session.start();
+  for (uint64_t at : {2 * SEC, 4 * SEC, 6 * SEC}) {
+    sim.scheduler().after(at, [&] { exchange.drop_connections(); });
+  }
+
+  sim.run_for(8 * SEC);
+  EXPECT_EQ(session.stats().connects, 4u);
+  EXPECT_EQ(session.stats().disconnects, 3u);
+  EXPECT_EQ(session.stats().snapshots, 4 * SYMBOLS.size());
+  EXPECT_EQ(session.stats().connect_failures, 0u);
+  EXPECT_EQ(exchange.stats().connections, 4u);
+  EXPECT_EQ(exchange.connections(), 1u);
+  expect_books_match(sim, exchange, session);
+}
+
+TEST(SessionSimTest, BacksOffWhileTheExchangeRefusesConnects) {
+  Simulation sim;
+  SimExchange &exchange = sim.add_exchange(exchange_config());
+  exchange.set_accepting(false);
+  sim.scheduler().after(SEC, [&] { exchange.set_accepting(true); });
+  FeedSessionConfig config = session_config();
+  config.initial_backoff_ms = 100;
+  FeedSession session(sim.reactor(), config);
+  session.start();
+
+  // Attempts at 0, 0.1, 0.3, 0.7 s are refused; the one at 1.5 s gets in
+  sim.run_for(1400 * MS);
+  EXPECT_EQ(session.stats().connect_failures, 4u);
+  EXPECT_EQ(session.state(), FeedSession::State::BACKOFF);
+  sim.run_for(200 * MS);
+  EXPECT_EQ(session.stats().connect_failures, 4u);
+  EXPECT_EQ(session.stats().connects, 1u);
+  EXPECT_TRUE(session.live());
+  EXPECT_EQ(sim.network().stats().refused, 4u);
+}
+
+TEST(SessionSimTest, HeartbeatTimeoutsWhileTheExchangeIsQuiet) {
+  Simulation sim;
+  SimExchange &exchange = sim.add_exchange(exchange_config());
+  FeedSession session(sim.reactor(), session_config());  // 2 s heartbeat timeout
+  session.start();
+  sim.scheduler().after(SEC, [&] { exchange.go_quiet(5 * SEC); });
+
+  // Quiet from 1 s to 6 s: timeouts at ~3 s and ~5 s (that connection's
+  // snapshot requests wait for the exchange), live again at 6 s
+  sim.run_for(5900 * MS);
+  EXPECT_EQ(session.stats().heartbeat_timeouts, 2u);
+  EXPECT_EQ(session.state(), FeedSession::State::SNAPSHOT);
+  sim.run_for(200 * MS);
+  EXPECT_TRUE(session.live());
+  EXPECT_EQ(session.stats().connects, 3u);
+  EXPECT_GT(session.stats().last_recovery_ns, 900 * MS);
+  expect_books_match(sim, exchange, session);
+}
+
+TEST(SessionSimTest, LostUpdatesAreRepairedFromChecksums) {
+  Simulation sim;
+  // Updates set whole levels, so later ones soon cover lost ones up:
+  // checksums come often enough to catch the damage first
+  SimExchangeConfig config = exchange_config();
+  config.checksum_interval_ns = 20 * MS;
+  SimExchange &exchange = sim.add_exchange(config);
+  FeedSession session(sim.reactor(), session_config());
+  session.start();
+  sim.scheduler().after(2 * SEC, [&] { exchange.drop_updates(25); });
+
+  sim.run_for(4 * SEC);
+  EXPECT_EQ(exchange.stats().updates_dropped, 25u);
+  EXPECT_GE(session.stats().gaps, 1u);  // Checksum frames in between split the run
+  EXPECT_GE(session.stats().checksum_mismatches, 1u);
+  EXPECT_EQ(session.stats().symbol_resyncs, session.stats().checksum_mismatches);
+  EXPECT_EQ(session.stats().snapshots, SYMBOLS.size() + session.stats().symbol_resyncs);
+  EXPECT_EQ(session.stats().connects, 1u);  // Repaired on the same connection
+  expect_books_match(sim, exchange, session);
+}
+
+namespace {
+
+struct Outcome {
+  FeedSessionStats session;
+  SimExchangeStats exchange;
+  SimNetworkStats network;
+  uint64_t events = 0;
+  double wall_ms = 0;
+};
+
+// Every fault, with jitter and small segments, over a minute
+Outcome run_everything(uint64_t seed) {
+  SimNetworkConfig network;
+  network.latency_ns = 200'000;
+  network.jitter_ns = 300'000;
+  network.segment_bytes = 100;
+  network.seed = seed;
+  Simulation sim(network);
+  SimExchangeConfig config = exchange_config();
+  config.seed = seed;
+  SimExchange &exchange = sim.add_exchange(config);
+  FeedSession session(sim.reactor(), session_config());
+  session.start();
+  auto &scheduler = sim.scheduler();
+  for (int i = 0; i < 6; ++i) {
+    uint64_t base = i * 10 * SEC;
+    scheduler.after(base + 1 * SEC, [&] { exchange.drop_updates(10); });
+    scheduler.after(base + 3 * SEC, [&] { exchange.drop_connections(); });
+    scheduler.after(base + 4 * SEC, [&] { exchange.go_quiet(3 * SEC); });
+    scheduler.after(base + 8 * SEC, [&] { exchange.set_accepting(false); });
+    scheduler.after(base + 8 * SEC + 1, [&] { exchange.drop_connections(); });
+    scheduler.after(base + 9 * SEC, [&] { exchange.set_accepting(true); });
+  }
+  auto start = std::chrono::steady_clock::now();
+  sim.run_for(60 * SEC);
+  Outcome outcome;
+  outcome.wall_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  outcome.session = session.stats();
+  outcome.exchange = exchange.stats();
+  outcome.network = sim.network().stats();
+  outcome.events = scheduler.events_run();
+  return outcome;
+}
+
+} // namespace
+
+TEST(SessionSimTest, SameSeedsSameCounters) {
+  Outcome first = run_everything(7);
+  Outcome second = run_everything(7);
+  Outcome other = run_everything(8);
+
+  EXPECT_EQ(memcmp(&first.session, &second.session, sizeof(FeedSessionStats)), 0);
+  EXPECT_EQ(memcmp(&first.exchange, &second.exchange, sizeof(SimExchangeStats)), 0);
+  EXPECT_EQ(memcmp(&first.network, &second.network, sizeof(SimNetworkStats)), 0);
+  EXPECT_EQ(first.events, second.events);
+  EXPECT_NE(first.session.updates_applied, other.session.updates_applied);
+
+  // Every kind of recovery happened
+  EXPECT_GE(first.session.connects, 12u);
+  EXPECT_GE(first.session.connect_failures, 6u);
+  EXPECT_GE(first.session.heartbeat_timeouts, 6u);
+  EXPECT_GE(first.session.gaps, 6u);
+  EXPECT_GT(first.session.updates_applied, 30'000u);
+
+  // A minute of feed in far less than a minute
+  EXPECT_LT(first.wall_ms, 60'000.0 / 20);
+  printf("60 s simulated in %.0f ms (%.0fx), %lu events\n", first.wall_ms,
+         60'000.0 / first.wall_ms, first.events);
+}
@@ -10,6 +10,11 @@
  *   - Client transitions to incremental mode
  *   - Incremental updates modify the order book
  *   - Reconnection triggers new snapshot request
+ *   - Hot standby takes over the feed when the primary is killed
+ *   - A book checksum mismatch resyncs the symbol without reconnecting
+ *   - Other symbols keep updating while one is resynced
+ *   - Books deeper than 255 levels arrive as chunked snapshots
+ *   - "ALL" books are rebuilt in parallel over the snapshot channel
  */
 
 #include <gtest/gtest.h>
@@ -27,6 +32,7 @@
 #include <sys/wait.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 // Helper to get the build directory path
 static std::string get_build_dir() {
@@ -53,6 +59,7 @@ protected:
   // Process IDs for cleanup
   pid_t server_pid_ = -1;
   pid_t handler_pid_ = -1;
+  pid_t standby_pid_ = -1;
 
   void SetUp() override {
     build_dir_ = get_build_dir();
@@ -68,6 +75,7 @@ protected:
 
   void TearDown() override {
     // Clean up any running processes
+    stop_process(standby_pid_);
     stop_handler();
     stop_server();
 
@@ -78,7 +86,9 @@ protected:
   // Start the mock server on specified port
   // Returns true if server started successfully
   bool start_server(int port, int heartbeat_ms = 1000, int updates_per_sec = 5,
-                    const std::string &log_file = "") {
+                    const std::string &log_file = "", int checksum_ms = 1000,
+                    int corrupt_every = 0, int book_depth = 10, int universe = 3,
+                    int snapshot_port = 0) {
     server_pid_ = fork();
     if (server_pid_ == 0) {
       // Child process
@@ -94,7 +104,9 @@ protected:
 
       execl(server_path_.c_str(), "snapshot_mock_server",
             std::to_string(port).c_str(), std::to_string(heartbeat_ms).c_str(),
-            std::to_string(updates_per_sec).c_str(), nullptr);
+            std::to_string(updates_per_sec).c_str(), std::to_string(checksum_ms).c_str(),
+            std::to_string(corrupt_every).c_str(), std::to_string(book_depth).c_str(),
+            std::to_string(universe).c_str(), std::to_string(snapshot_port).c_str(), nullptr);
       _exit(1); // exec failed
     }
 
@@ -110,19 +122,41 @@ protected:
   // Start the feed handler, capturing output to log file
   // Returns true if handler started successfully
   bool start_handler(int port, const std::string &symbol,
-                     const std::string &log_file) {
-    handler_pid_ = fork();
-    if (handler_pid_ == 0) {
+                     const std::string &log_file,
+                     const std::vector<std::string> &extra_args = {}) {
+    handler_pid_ = spawn_handler(port, symbol, log_file, extra_args);
+    return handler_pid_ > 0;
+  }
+
+  pid_t spawn_handler(int port, const std::string &symbol,
+                      const std::string &log_file,
+                      const std::vector<std::string> &extra_args) {
+    std::vector<std::string> args = {"feed_handler_snapshot", std::to_string(port), symbol};
+    args.insert(args.end(), extra_args.begin(), extra_args.end());
+
+    pid_t pid = fork();
+    if (pid == 0) {
       // Child process - redirect output to log file
       freopen(log_file.c_str(), "w", stdout);
       freopen(log_file.c_str(), "a", stderr);
 
-      execl(handler_path_.c_str(), "feed_handler_snapshot",
-            std::to_string(port).c_str(), symbol.c_str(), nullptr);
+      std::vector<char *> argv;
+      for (auto &arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+      }
+      argv.push_back(nullptr);
+      execv(handler_path_.c_str(), argv.data());
       _exit(1); // exec failed
     }
+    return pid;
+  }
 
-    return handler_pid_ > 0;
+  void stop_process(pid_t &pid) {
+    if (pid > 0) {
+      kill(pid, SIGTERM);
+      waitpid(pid, nullptr, 0);
+      pid = -1;
+    }
   }
 
   void stop_server() {
@@ -454,3 +488,209 @@ int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
 }
+
+// =============================================================================
+// Test: Hot Standby Takeover
+// =============================================================================
+
+TEST_F(SnapshotRecoveryTest, StandbyTakesOverAfterPrimaryCrash) {
+  int port = get_test_port();
+  std::string primary_log = "/tmp/snapshot_test_primary.log";
+  std::string standby_log = "/tmp/snapshot_test_standby.log";
+  std::string repl_path = "/tmp/snapshot_test_repl_" + std::to_string(getpid());
+
+  ASSERT_TRUE(start_server(port, 100, 100))
+      << "Failed to start snapshot mock server";
+  ASSERT_TRUE(start_handler(port, "AAPL", primary_log, {"--replicate", repl_path}));
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  standby_pid_ = spawn_handler(port, "AAPL", standby_log, {"--standby", repl_path});
+  ASSERT_GT(standby_pid_, 0);
+
+  // Let the standby sync and mirror some updates
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  ASSERT_TRUE(pattern_exists_in_file(standby_log, "Connected to primary"));
+
+  // Crash the primary and time until the standby is live on the feed
+  auto killed_at = std::chrono::steady_clock::now();
+  kill(handler_pid_, SIGKILL);
+  waitpid(handler_pid_, nullptr, 0);
+  handler_pid_ = -1;
+
+  bool resumed = false;
+  while (std::chrono::steady_clock::now() - killed_at < std::chrono::seconds(5)) {
+    if (pattern_exists_in_file(standby_log, "Resumed incrementally")) {
+      resumed = true;
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto takeover_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - killed_at)
+                         .count();
+  std::cout << "  Takeover (kill -> first resumed message): " << takeover_ms << " ms"
+            << std::endl;
+
+  stop_process(standby_pid_);
+  stop_server();
+
+  EXPECT_TRUE(resumed) << read_file(standby_log);
+  EXPECT_TRUE(pattern_exists_in_file(standby_log, "Adopted AAPL book"));
+  EXPECT_TRUE(pattern_exists_in_file(standby_log, "Resuming from sequence"));
+  EXPECT_TRUE(pattern_exists_in_file(standby_log, "mismatches: 0"));
+  EXPECT_FALSE(pattern_exists_in_file(standby_log, "Sending snapshot request"))
+      << "Standby should resume, not rebuild from a snapshot";
+  // Bounded by the server's heartbeat/update cadence, not by book rebuilds
+  EXPECT_LT(takeover_ms, 1000);
+
+  unlink(primary_log.c_str());
+  unlink(standby_log.c_str());
+}
+
+// =============================================================================
+// Test: Checksum Mismatch Resyncs One Symbol
+// =============================================================================
+
+TEST_F(SnapshotRecoveryTest, ChecksumMismatchTriggersSymbolResync) {
+  int port = get_test_port();
+  std::string server_log = "/tmp/snapshot_test_server_checksum.log";
+  std::string handler_log = "/tmp/snapshot_test_handler_checksum.log";
+
+  // Checksums every 100ms; every 10th update is silently dropped
+  ASSERT_TRUE(start_server(port, 1000, 100, server_log, 100, 10))
+      << "Failed to start snapshot mock server";
+  ASSERT_TRUE(start_handler(port, "AAPL", handler_log))
+      << "Failed to start feed handler";
+
+  std::this_thread::sleep_for(std::chrono::seconds(4));
+
+  stop_handler();
+  stop_server();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  ASSERT_TRUE(pattern_exists_in_file(server_log, "Dropped AAPL update"))
+      << "No AAPL update was dropped; nothing to detect";
+  EXPECT_TRUE(pattern_exists_in_file(handler_log, "Checksum mismatch for AAPL"))
+      << read_file(handler_log);
+  EXPECT_GE(count_pattern_in_file(handler_log, "Resynced AAPL from snapshot"), 1);
+
+  // Resync happens over the live connection, without gaps or reconnects
+  EXPECT_EQ(count_pattern_in_file(server_log, "Client connected"), 1);
+  EXPECT_EQ(count_pattern_in_file(handler_log, "Sending snapshot request"), 1);
+  EXPECT_FALSE(pattern_exists_in_file(handler_log, "Gap detected"));
+  EXPECT_FALSE(pattern_exists_in_file(handler_log, "Reconnecting"));
+
+  unlink(server_log.c_str());
+  unlink(handler_log.c_str());
+}
+
+// =============================================================================
+// Test: Targeted Resync Across Several Symbols
+// =============================================================================
+
+TEST_F(SnapshotRecoveryTest, TargetedResyncKeepsOtherSymbolsLive) {
+  int port = get_test_port();
+  std::string server_log = "/tmp/snapshot_test_server_targeted.log";
+  std::string handler_log = "/tmp/snapshot_test_handler_targeted.log";
+
+  ASSERT_TRUE(start_server(port, 1000, 100, server_log, 100, 10))
+      << "Failed to start snapshot mock server";
+  ASSERT_TRUE(start_handler(port, "AAPL,MSFT,GOOG", handler_log))
+      << "Failed to start feed handler";
+
+  std::this_thread::sleep_for(std::chrono::seconds(4));
+
+  stop_handler();
+  stop_server();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  // One snapshot request per symbol up front, then only targeted ones
+  EXPECT_EQ(count_pattern_in_file(handler_log, "Sending snapshot request"), 3);
+  for (const char *symbol : {"AAPL", "MSFT", "GOOG"}) {
+    EXPECT_TRUE(pattern_exists_in_file(handler_log, std::string("Received snapshot for ") + symbol));
+  }
+  int resyncs = count_pattern_in_file(handler_log, "Resynced ");
+  EXPECT_GE(resyncs, 1) << read_file(handler_log);
+  // Every targeted request completes (one may be in flight at shutdown)
+  EXPECT_LE(count_pattern_in_file(handler_log, "to resync book") - resyncs, 1);
+
+  // All of it over one connection with unbroken sequencing
+  EXPECT_EQ(count_pattern_in_file(server_log, "Client connected"), 1);
+  EXPECT_FALSE(pattern_exists_in_file(handler_log, "Gap detected"));
+
+  unlink(server_log.c_str());
+  unlink(handler_log.c_str());
+}
+
+// =============================================================================
+// Test: Deep Books Stream as Chunked Snapshots
+// =============================================================================
+
+TEST_F(SnapshotRecoveryTest, DeepBookSnapshotStreamsInChunks) {
+  int port = get_test_port();
+  std::string server_log = "/tmp/snapshot_test_server_deep.log";
+  std::string handler_log = "/tmp/snapshot_test_handler_deep.log";
+
+  // 4000 levels per side, far past SNAPSHOT_RESPONSE's 255
+  ASSERT_TRUE(start_server(port, 1000, 50, server_log, 200, 0, 4000))
+      << "Failed to start snapshot mock server";
+  ASSERT_TRUE(start_handler(port, "AAPL", handler_log))
+      << "Failed to start feed handler";
+
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  stop_handler();
+  stop_server();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  EXPECT_TRUE(pattern_exists_in_file(server_log, "4000 bids, 4000 asks in 16 chunks"))
+      << read_file(server_log);
+  EXPECT_TRUE(pattern_exists_in_file(handler_log, "Bid levels: 4000")) << read_file(handler_log);
+  EXPECT_TRUE(pattern_exists_in_file(handler_log, "Ask levels: 4000"));
+  EXPECT_TRUE(pattern_exists_in_file(handler_log, "Streamed in 16 chunks"));
+
+  // Checksum carried by SNAPSHOT_END and the periodic ones both agree
+  EXPECT_FALSE(pattern_exists_in_file(handler_log, "Discarding"));
+  EXPECT_FALSE(pattern_exists_in_file(handler_log, "Checksum mismatch"));
+
+  unlink(server_log.c_str());
+  unlink(handler_log.c_str());
+}
+
+// =============================================================================
+// Test: Full-Universe Recovery over the Snapshot Channel
+// =============================================================================
+
+TEST_F(SnapshotRecoveryTest, ParallelRecoveryOfAllSymbols) {
+  int port = get_test_port();
+  int snapshot_port = port + 500;
+  std::string server_log = "/tmp/snapshot_test_server_parallel.log";
+  std::string handler_log = "/tmp/snapshot_test_handler_parallel.log";
+
+  ASSERT_TRUE(start_server(port, 1000, 100, server_log, 300, 0, 20, 1000, snapshot_port))
+      << "Failed to start snapshot mock server";
+  ASSERT_TRUE(start_handler(port, "ALL", handler_log,
+                            {"--recover-all", std::to_string(snapshot_port), "--shards", "4",
+                             "--snapshot-connections", "3"}))
+      << "Failed to start feed handler";
+
+  std::this_thread::sleep_for(std::chrono::seconds(3));
+
+  stop_handler();
+  stop_server();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  // Level count drifts with live updates; the book count doesn't
+  EXPECT_TRUE(pattern_exists_in_file(handler_log, "Recovered 1000 books ("))
+      << read_file(handler_log);
+  EXPECT_TRUE(pattern_exists_in_file(handler_log, "with 4 shard threads over 3 snapshot connections"));
+  EXPECT_TRUE(pattern_exists_in_file(server_log, "partition 2 of 3"));
+  EXPECT_TRUE(pattern_exists_in_file(handler_log, "State: INCREMENTAL"));
+
+  // Books installed from the channel agree with the live feed's checksums
+  EXPECT_FALSE(pattern_exists_in_file(handler_log, "Checksum mismatch"));
+  EXPECT_FALSE(pattern_exists_in_file(handler_log, "not recovered"));
+
+  unlink(server_log.c_str());
+  unlink(handler_log.c_str());
+}
@@ -94,6 +94,29 @@ TEST_F(SPSCQueueTest, WrapAround) {
   }
 }
 
+TEST_F(SPSCQueueTest, PeekBatchStopsAtWrapPoint) {
+  SPSCQueue<int> queue(8);
+  for (int i = 0; i < 6; ++i) queue.push(i);
+  for (int i = 0; i < 6; ++i) queue.pop();
+  for (int i = 0; i < 5; ++i) queue.push(100 + i);  // Slots 6, 7, 0, 1, 2
+
+  const int *first = nullptr;
+  ASSERT_EQ(queue.peek_batch(&first, 16), 2u);
+  EXPECT_EQ(first[0], 100);
+  EXPECT_EQ(first[1], 101);
+  EXPECT_EQ(queue.size(), 5u);  // Nothing released until consume()
+  queue.consume(2);
+
+  ASSERT_EQ(queue.peek_batch(&first, 2), 2u);  // Capped by max
+  EXPECT_EQ(first[0], 102);
+  queue.consume(2);
+  ASSERT_EQ(queue.peek_batch(&first, 16), 1u);
+  EXPECT_EQ(first[0], 104);
+  queue.consume(1);
+  EXPECT_EQ(queue.peek_batch(&first, 16), 0u);
+  EXPECT_TRUE(queue.empty());
+}
+
 TEST_F(SPSCQueueTest, MoveOnlyType) {
   SPSCQueue<std::unique_ptr<int>> queue(16);
 
@@ -0,0 +1,242 @@
+/**
+ * Per-Symbol Book State Tests
+ *
+ * Covers:
+ *   - New books start RECOVERING and buffer their updates
+ *   - Snapshot load replays only buffered updates newer than the snapshot
+ *   - Streamed (chunked) snapshots load level by level, and can be aborted
+ *   - Snapshots built on other threads install with the same replay
+ *   - Updates older than the book are skipped
+ *   - One symbol recovering doesn't stop the others updating
+ *   - Gaps mark books STALE; checksums confirm or reject them
+ *   - Buffer overflow past the snapshot forces another snapshot
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "symbol_books.hpp"
+
+namespace {
+
+OrderBookUpdatePayload make_update(const char *symbol, uint8_t side, float price, int64_t qty) {
+  OrderBookUpdatePayload update;
+  memset(update.symbol, 0, 4);
+  memcpy(update.symbol, symbol, strnlen(symbol, 4));
+  update.side = side;
+  update.price = price;
+  update.quantity = qty;
+  return update;
+}
+
+const std::vector<OrderBookLevel> kBids = {{100.0f, 10}, {99.0f, 20}};
+const std::vector<OrderBookLevel> kAsks = {{101.0f, 30}};
+
+class SymbolBooksTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    books_.add("AAPL");
+    books_.add("MSFT");
+  }
+
+  SymbolBook &aapl() { return *books_.find("AAPL"); }
+  SymbolBook &msft() { return *books_.find("MSFT"); }
+
+  SymbolBooks books_;
+};
+
+} // namespace
+
+// =============================================================================
+// Recovery
+// =============================================================================
+
+TEST_F(SymbolBooksTest, NewBooksBufferUntilSnapshot) {
+  EXPECT_EQ(books_.count(BookState::RECOVERING), 2u);
+  EXPECT_EQ(books_.apply_update(5, make_update("AAPL", 0, 100.0f, 50)),
+            SymbolBooks::UpdateResult::BUFFERED);
+  EXPECT_TRUE(aapl().book.empty());
+  EXPECT_EQ(aapl().pending.size(), 1u);
+
+  EXPECT_EQ(books_.apply_update(6, make_update("TSLA", 0, 1.0f, 1)),
+            SymbolBooks::UpdateResult::UNKNOWN_SYMBOL);
+}
+
+TEST_F(SymbolBooksTest, SnapshotReplaysOnlyNewerBufferedUpdates) {
+  books_.apply_update(8, make_update("AAPL", 0, 100.0f, 999)); // In the snapshot already
+  books_.apply_update(11, make_update("AAPL", 0, 100.0f, 15)); // After it
+  books_.apply_update(12, make_update("AAPL", 1, 102.0f, 5));
+
+  size_t replayed = 0;
+  ASSERT_TRUE(books_.load_snapshot("AAPL", 10, kBids, kAsks, &replayed));
+  EXPECT_EQ(replayed, 2u);
+  EXPECT_EQ(aapl().state, BookState::VALID);
+  EXPECT_EQ(aapl().last_sequence, 12u);
+  EXPECT_TRUE(aapl().pending.empty());
+
+  OrderBook expected;
+  expected.load_snapshot(kBids, kAsks);
+  expected.apply_update(0, 100.0f, 15);
+  expected.apply_update(1, 102.0f, 5);
+  EXPECT_EQ(aapl().book.checksum(), expected.checksum());
+}
+
+TEST_F(SymbolBooksTest, StreamedSnapshotMatchesWholeLoad) {
+  books_.apply_update(21, make_update("AAPL", 1, 101.0f, 0)); // Deletes after snapshot
+
+  books_.begin_snapshot(aapl(), 20, 500);
+  EXPECT_TRUE(aapl().snapshot.active);
+  EXPECT_EQ(aapl().snapshot.sequence, 20u);
+  EXPECT_EQ(aapl().pending.size(), 1u); // Kept across begin
+  for (int i = 0; i < 1000; ++i) {   // Deeper than one SNAPSHOT_RESPONSE allows
+    books_.add_snapshot_level(aapl(), 0, 100.0f - i * 0.01f, 10);
+    books_.add_snapshot_level(aapl(), 1, 101.0f + i * 0.01f, 10);
+  }
+  // Still recovering: updates keep buffering mid-snapshot
+  EXPECT_EQ(books_.apply_update(22, make_update("AAPL", 0, 100.0f, 5)),
+            SymbolBooks::UpdateResult::BUFFERED);
+
+  size_t replayed = 0;
+  ASSERT_TRUE(books_.finish_snapshot(aapl(), &replayed));
+  EXPECT_EQ(replayed, 2u);
+  EXPECT_FALSE(aapl().snapshot.active);
+  EXPECT_EQ(aapl().state, BookState::VALID);
+  EXPECT_EQ(aapl().book.bid_depth(), 1000u);
+  EXPECT_EQ(aapl().book.ask_depth(), 999u);
+  EXPECT_EQ(aapl().last_sequence, 22u);
+}
+
+TEST_F(SymbolBooksTest, AbortedSnapshotKeepsBuffering) {
+  books_.load_snapshot("AAPL", 1, kBids, kAsks);
+  books_.begin_snapshot(aapl(), 5, 0); // e.g. replayed snapshot on a VALID book
+  EXPECT_EQ(aapl().state, BookState::RECOVERING);
+  EXPECT_TRUE(aapl().snapshot.replaces_book);
+  books_.add_snapshot_level(aapl(), 0, 1.0f, 1);
+
+  books_.abort_snapshot(aapl());
+  EXPECT_FALSE(aapl().snapshot.active);
+  EXPECT_TRUE(aapl().book.empty());
+  EXPECT_EQ(books_.apply_update(6, make_update("AAPL", 0, 1.0f, 1)),
+            SymbolBooks::UpdateResult::BUFFERED);
+}
+
+TEST_F(SymbolBooksTest, InstalledSnapshotReplaysNewerUpdates) {
+  books_.apply_update(30, make_update("AAPL", 0, 100.0f, 1));  // Reflected in the snapshot
+  books_.apply_update(31, make_update("AAPL", 0, 98.0f, 7));
+
+  OrderBook built;
+  built.load_snapshot(kBids, kAsks);
+  size_t replayed = 0;
+  ASSERT_TRUE(books_.install_snapshot(aapl(), std::move(built), 30, &replayed));
+  EXPECT_EQ(replayed, 1u);
+  EXPECT_EQ(aapl().state, BookState::VALID);
+  EXPECT_EQ(aapl().book.bid_depth(), 3u);
+  EXPECT_EQ(aapl().last_sequence, 31u);
+}
+
+TEST_F(SymbolBooksTest, UpdatesOlderThanBookAreSkipped) {
+  // Snapshot from another connection arrived before updates it already covers
+  books_.load_snapshot("AAPL", 50, kBids, kAsks);
+  uint64_t checksum = aapl().book.checksum();
+
+  EXPECT_EQ(books_.apply_update(49, make_update("AAPL", 0, 100.0f, 0)),
+            SymbolBooks::UpdateResult::ALREADY_APPLIED);
+  EXPECT_EQ(aapl().book.checksum(), checksum);
+  EXPECT_EQ(books_.apply_update(51, make_update("AAPL", 0, 100.0f, 0)),
+            SymbolBooks::UpdateResult::APPLIED);
+}
+
+TEST_F(SymbolBooksTest, OtherSymbolsKeepUpdatingDuringRecovery) {
+  books_.load_snapshot("AAPL", 1, kBids, kAsks);
+  books_.load_snapshot("MSFT", 2, kBids, kAsks);
+
+  books_.begin_recovery(aapl(), 123);
+  EXPECT_EQ(aapl().recovery_started_ns, 123u);
+  EXPECT_EQ(books_.apply_update(3, make_update("AAPL", 0, 98.0f, 1)),
+            SymbolBooks::UpdateResult::BUFFERED);
+  EXPECT_EQ(books_.apply_update(4, make_update("MSFT", 0, 98.0f, 1)),
+            SymbolBooks::UpdateResult::APPLIED);
+
+  EXPECT_EQ(aapl().book.bid_depth(), 2u);
+  EXPECT_EQ(msft().book.bid_depth(), 3u);
+  EXPECT_EQ(msft().last_sequence, 4u);
+  EXPECT_EQ(books_.count(BookState::VALID), 1u);
+}
+
+TEST_F(SymbolBooksTest, AdoptedBookIsValid) {
+  OrderBook book;
+  book.load_snapshot(kBids, kAsks);
+  books_.adopt("AAPL", book, 77);
+
+  EXPECT_EQ(aapl().state, BookState::VALID);
+  EXPECT_EQ(aapl().last_sequence, 77u);
+  EXPECT_EQ(aapl().book.checksum(), book.checksum());
+}
+
+// =============================================================================
+// Staleness and Checksums
+// =============================================================================
+
+TEST_F(SymbolBooksTest, GapMarksValidBooksStale) {
+  books_.load_snapshot("AAPL", 1, kBids, kAsks);
+
+  EXPECT_EQ(books_.mark_all_stale(1000), 1u); // MSFT is still RECOVERING
+  EXPECT_EQ(aapl().state, BookState::STALE);
+  EXPECT_EQ(msft().state, BookState::RECOVERING);
+
+  // Stale books still apply updates
+  EXPECT_EQ(books_.apply_update(2, make_update("AAPL", 1, 103.0f, 1)),
+            SymbolBooks::UpdateResult::APPLIED);
+
+  EXPECT_TRUE(books_.stale_longer_than(1500, 1000).empty());
+  auto overdue = books_.stale_longer_than(2000, 1000);
+  ASSERT_EQ(overdue.size(), 1u);
+  EXPECT_EQ(overdue[0], "AAPL");
+}
+
+TEST_F(SymbolBooksTest, ChecksumConfirmsOrRejectsStaleBook) {
+  books_.load_snapshot("AAPL", 1, kBids, kAsks);
+  uint64_t good = aapl().book.checksum();
+  books_.mark_all_stale(0);
+
+  EXPECT_FALSE(books_.verify_checksum(aapl(), good + 1));
+  EXPECT_EQ(aapl().state, BookState::STALE); // Caller decides to resync
+
+  EXPECT_TRUE(books_.verify_checksum(aapl(), good));
+  EXPECT_EQ(aapl().state, BookState::VALID);
+
+  // Nothing to compare while recovering
+  EXPECT_TRUE(books_.verify_checksum(msft(), 12345));
+  EXPECT_EQ(msft().state, BookState::RECOVERING);
+}
+
+// =============================================================================
+// Buffer Limits
+// =============================================================================
+
+TEST_F(SymbolBooksTest, OverflowOlderThanSnapshotIsHarmless) {
+  uint64_t seq = 1;
+  for (size_t i = 0; i <= SymbolBooks::MAX_PENDING; ++i) {
+    books_.apply_update(seq++, make_update("AAPL", 0, 50.0f, 1));
+  }
+  EXPECT_EQ(aapl().pending.size(), 1u);
+
+  // Snapshot newer than everything dropped
+  EXPECT_TRUE(books_.load_snapshot("AAPL", seq, kBids, kAsks));
+  EXPECT_EQ(aapl().state, BookState::VALID);
+}
+
+TEST_F(SymbolBooksTest, OverflowNewerThanSnapshotNeedsAnother) {
+  uint64_t seq = 100;
+  for (size_t i = 0; i <= SymbolBooks::MAX_PENDING; ++i) {
+    books_.apply_update(seq++, make_update("AAPL", 0, 50.0f, 1));
+  }
+
+  // Snapshot from before updates that were thrown away
+  EXPECT_FALSE(books_.load_snapshot("AAPL", 50, kBids, kAsks));
+  EXPECT_EQ(aapl().state, BookState::RECOVERING);
+  EXPECT_TRUE(aapl().pending.empty());
+}
@@ -0,0 +1,226 @@
+/**
+ * Symbol Subscription Filter Tests
+ *
+ * Covers:
+ *   - Dense symbol ids: unique over the alphabet, -1 outside it
+ *   - Packed and bitset lookups agree with a reference set on both sides
+ *     of the size threshold
+ *   - Text symbols longer than 4 chars don't collide with their prefix
+ *   - RCU swap: old filters freed only after the reader is quiescent
+ *   - Binary and text readers drop unsubscribed ticks before queueing,
+ *     including while the subscription changes underneath them
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "compact_encoding.hpp"
+#include "net/feed.hpp"
+#include "symbol_filter.hpp"
+
+namespace {
+
+std::string random_symbol(std::mt19937& rng) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.";
+  std::string symbol(1 + rng() % 4, ' ');
+  for (auto& c : symbol) c = alphabet[rng() % (sizeof(alphabet) - 1)];
+  return symbol;
+}
+
+std::string ticks_for(const std::vector<std::string>& symbols, uint64_t first_sequence) {
+  std::string frames;
+  uint64_t seq = first_sequence;
+  for (const auto& symbol : symbols) {
+    char sym4[4] = {0, 0, 0, 0};
+    memcpy(sym4, symbol.data(), std::min<size_t>(symbol.size(), 4));
+    frames += serialize_tick(seq, seq * 10, sym4, 100.0f, 1);
+    seq++;
+  }
+  return frames;
+}
+
+struct ReaderFixture {
+  SPSCQueue<net::Tick> queue{1 << 16};
+  std::atomic<bool> stop{false};
+  StageMonitor monitor;
+  Subscription subscription;
+  net::BinaryProtocolReader binary{-1, queue, stop, false, monitor};
+  net::TextProtocolReader text{-1, queue, stop, false, monitor};
+
+  ReaderFixture() {
+    binary.set_subscription(&subscription);
+    text.set_subscription(&subscription);
+  }
+
+  std::vector<std::string> drain() {
+    std::vector<std::string> out;
+    while (auto t = queue.pop()) out.emplace_back(t->symbol);
+    return out;
+  }
+};
+
+} // namespace
+
+// =============================================================================
+// SymbolFilter
+// =============================================================================
+
+TEST(SymbolFilterTest, SymbolIdsAreDenseAndUnique) {
+  EXPECT_EQ(symbol_id(padded_symbol_key("")), 0);
+  EXPECT_EQ(symbol_id(padded_symbol_key("....")), symbol_filter_detail::ID_SPACE - 1);
+  EXPECT_EQ(symbol_id(padded_symbol_key("aapl")), -1);
+  EXPECT_EQ(symbol_id(padded_symbol_key("A-B")), -1);
+
+  std::mt19937 rng(1);
+  std::set<std::string> seen;
+  std::set<int32_t> ids;
+  for (int i = 0; i < 20000; ++i) {
+    std::string symbol = random_symbol(rng);
+    int32_t id = symbol_id(padded_symbol_key(symbol));
+    ASSERT_GE(id, 0) << symbol;
+    ASSERT_LT(id, symbol_filter_detail::ID_SPACE);
+    if (seen.insert(symbol).second) {
+      ASSERT_TRUE(ids.insert(id).second) << symbol << " collides";
+    }
+  }
+}
+
+TEST(SymbolFilterTest, LookupsMatchReferenceSet) {
+  std::mt19937 rng(2);
+  for (size_t count : {size_t{1}, size_t{3}, size_t{32}, size_t{33}, size_t{500}}) {
+    std::vector<std::string> symbols;
+    std::set<uint32_t> reference;
+    for (size_t i = 0; i < count; ++i) {
+      std::string symbol = (i % 7 == 6) ? "x" + std::to_string(i % 100) : random_symbol(rng);
+      symbols.push_back(symbol);
+      reference.insert(padded_symbol_key(symbol));
+    }
+    SymbolFilter filter(symbols);
+    EXPECT_EQ(filter.uses_bitset(), reference.size() > SymbolFilter::PACKED_MAX) << count;
+    EXPECT_EQ(filter.size(), reference.size());
+
+    for (const auto& symbol : symbols) {
+      ASSERT_TRUE(filter.matches(padded_symbol_key(symbol))) << symbol;  // Incl. off-alphabet
+    }
+    for (int i = 0; i < 20000; ++i) {
+      uint32_t key = (i % 2) ? padded_symbol_key(random_symbol(rng)) : static_cast<uint32_t>(rng());
+      ASSERT_EQ(filter.matches(key), reference.count(key) == 1) << count << " " << key;
+    }
+  }
+}
+
+TEST(SymbolFilterTest, LongTextSymbolsMatchWholeName) {
+  SymbolFilter filter({"GOOGL", "MSFT", "BRK.B"});
+  EXPECT_TRUE(filter.matches(std::string_view("GOOGL")));
+  EXPECT_FALSE(filter.matches(std::string_view("GOOG")));   // Prefix of GOOGL
+  EXPECT_FALSE(filter.matches(std::string_view("GOOGLE")));
+  EXPECT_TRUE(filter.matches(std::string_view("MSFT")));
+  EXPECT_TRUE(filter.matches(padded_symbol_key("MSFT")));   // Same key as the wire
+  EXPECT_TRUE(filter.matches(std::string_view("BRK.B")));
+  EXPECT_EQ(filter.size(), 3u);
+
+  SymbolFilter empty({});
+  EXPECT_FALSE(empty.matches(padded_symbol_key("AAPL")));
+}
+
+// =============================================================================
+// Subscription
+// =============================================================================
+
+TEST(SubscriptionTest, SwapFreesOldFilterAfterQuiescentState) {
+  Subscription subscription;
+  EXPECT_EQ(subscription.read(), nullptr);  // Everything
+
+  subscription.subscribe({"AAPL"});
+  const SymbolFilter* held = subscription.read();  // Reader mid-chunk
+  ASSERT_NE(held, nullptr);
+
+  subscription.subscribe({"MSFT"});
+  subscription.subscribe({"TSLA"});
+  EXPECT_EQ(subscription.retired(), 2u);  // Reader hasn't been quiescent
+  EXPECT_TRUE(held->matches(padded_symbol_key("AAPL")));  // Still valid
+
+  subscription.quiescent();
+  EXPECT_TRUE(subscription.read()->matches(padded_symbol_key("TSLA")));
+  subscription.subscribe_all();  // Reclaims the two, retires TSLA
+  EXPECT_EQ(subscription.retired(), 1u);
+  EXPECT_EQ(subscription.read(), nullptr);
+}
+
+// =============================================================================
+// Readers
+// =============================================================================
+
+TEST(SubscriptionTest, BinaryReaderDropsUnsubscribedTicks) {
+  ReaderFixture f;
+  f.subscription.subscribe({"AAPL", "TSLA"});
+
+  std::string frames = ticks_for({"AAPL", "MSFT", "TSLA", "GOOG", "AAPL"}, 1);
+  std::vector<TickPayload> batch(3);
+  memcpy(batch[0].symbol, "MSFT", 4);
+  memcpy(batch[1].symbol, "TSLA", 4);
+  memcpy(batch[2].symbol, "IBM\0", 4);
+  for (auto& t : batch) { t.timestamp = 1; t.price = 1.0f; t.volume = 1; }
+  CompactTickEncoder encoder;
+  frames += encoder.encode(6, batch.data(), batch.size());
+
+  EXPECT_EQ(f.binary.parse_frames(frames.data(), frames.size(), 0), frames.size());
+  EXPECT_EQ(f.binary.messages_parsed(), 4u);
+  EXPECT_EQ(f.binary.messages_filtered(), 4u);
+  EXPECT_EQ(f.drain(), (std::vector<std::string>{"AAPL", "TSLA", "AAPL", "TSLA"}));
+
+  f.subscription.subscribe_all();
+  f.binary.parse_frames(frames.data(), frames.size(), 0);  // The batch is a keyframe
+  EXPECT_EQ(f.binary.messages_parsed(), 12u);
+  EXPECT_EQ(f.binary.messages_filtered(), 4u);  // Unchanged: everything passes
+}
+
+TEST(SubscriptionTest, TextReaderDropsUnsubscribedTicks) {
+  ReaderFixture f;
+  f.subscription.subscribe({"GOOGL", "IBM"});
+  std::string lines = serialize_text_tick(1, "GOOG", 1.0f, 1) + serialize_text_tick(2, "GOOGL", 1.0f, 1) +
+                      serialize_text_tick(3, "IBM", 1.0f, 1) + serialize_text_tick(4, "MSFT", 1.0f, 1);
+
+  EXPECT_TRUE(f.text.parse_chunk(lines.data(), lines.size(), 0));
+  EXPECT_EQ(f.text.messages_parsed(), 2u);
+  EXPECT_EQ(f.text.messages_filtered(), 2u);
+  EXPECT_EQ(f.drain(), (std::vector<std::string>{"GOOGL", "IBM"}));
+}
+
+TEST(SubscriptionTest, ResubscribeWhileReaderRuns) {
+  ReaderFixture f;
+  std::vector<std::string> universe = {"AAPL", "MSFT", "TSLA", "GOOG"};
+  std::string frames = ticks_for(universe, 1);
+  f.subscription.subscribe({"AAPL", "MSFT"});
+
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (int i = 0; !done; ++i) {
+      f.subscription.subscribe({universe[i % universe.size()], universe[(i + 1) % universe.size()]});
+    }
+  });
+
+  const int chunks = 20000;
+  for (int i = 0; i < chunks; ++i) {
+    f.binary.parse_frames(frames.data(), frames.size(), 0);
+    while (f.queue.pop()) {
+    }
+  }
+  done = true;
+  writer.join();
+
+  // One filter per chunk, each with 2 of the 4 symbols: exactly half pass
+  EXPECT_EQ(f.binary.messages_parsed() + f.binary.messages_filtered(), chunks * universe.size());
+  EXPECT_EQ(f.binary.messages_parsed(), chunks * 2u);
+
+  // Swaps after the reader's last chunk are still retired; one more
+  // quiescent state lets the next swap free all of them
+  f.subscription.quiescent();
+  f.subscription.subscribe_all();
+  EXPECT_EQ(f.subscription.retired(), 1u);
+}
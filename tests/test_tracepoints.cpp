@@ -0,0 +1,182 @@
+/**
+ * Static Tracepoint Tests
+ *
+ * Covers:
+ *   - Each FEED_TRACE use leaves a stapsdt note in the binary that names
+ *     provider, probe and argument sizes the way <sys/sdt.h> does
+ *   - The probe site is a nop until a tracer attaches
+ *   - Arguments are evaluated once, like any other expression
+ *   - The gap and book_update probes come with the headers that use them
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sequence_tracker.hpp"
+#include "symbol_books.hpp"
+#include "tracepoints.hpp"
+
+#if FEED_TRACEPOINTS_ENABLED
+
+// Defined (hidden, once per object) by the first FEED_TRACE in this file
+extern "C" const char stapsdt_base[] __asm__("_.stapsdt.base");
+
+namespace {
+
+struct ProbeNote {
+  std::string provider;
+  std::string name;
+  std::string args;
+  uint64_t pc = 0;
+  uint64_t base = 0;
+};
+
+// The stapsdt notes of the running binary, read from its file
+std::vector<ProbeNote> read_probe_notes() {
+  std::ifstream file("/proc/self/exe", std::ios::binary);
+  std::string image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::vector<ProbeNote> notes;
+  if (image.size() < sizeof(Elf64_Ehdr)) {
+    return notes;
+  }
+  Elf64_Ehdr ehdr;
+  memcpy(&ehdr, image.data(), sizeof(ehdr));
+  std::vector<Elf64_Shdr> sections(ehdr.e_shnum);
+  memcpy(sections.data(), image.data() + ehdr.e_shoff, ehdr.e_shnum * sizeof(Elf64_Shdr));
+  const char *names = image.data() + sections[ehdr.e_shstrndx].sh_offset;
+
+  for (const auto &section : sections) {
+    if (section.sh_type != SHT_NOTE || strcmp(names + section.sh_name, ".note.stapsdt") != 0) {
+      continue;
+    }
+    const char *p = image.data() + section.sh_offset;
+    const char *end = p + section.sh_size;
+    while (p + sizeof(Elf64_Nhdr) <= end) {
+      Elf64_Nhdr nhdr;
+      memcpy(&nhdr, p, sizeof(nhdr));
+      const char *owner = p + sizeof(nhdr);
+      const char *desc = owner + ((nhdr.n_namesz + 3) & ~3u);
+      p = desc + ((nhdr.n_descsz + 3) & ~3u);
+      if (nhdr.n_type != 3 || strcmp(owner, "stapsdt") != 0) {
+        continue;
+      }
+      ProbeNote note;
+      memcpy(&note.pc, desc, 8);
+      memcpy(&note.base, desc + 8, 8);
+      const char *text = desc + 24;
+      note.provider = text;
+      text += note.provider.size() + 1;
+      note.name = text;
+      text += note.name.size() + 1;
+      note.args = text;
+      notes.push_back(note);
+    }
+  }
+  return notes;
+}
+
+std::vector<ProbeNote> find_probes(const std::string &name) {
+  std::vector<ProbeNote> found;
+  for (const auto &note : read_probe_notes()) {
+    if (note.provider == FEED_TRACE_PROVIDER && note.name == name) {
+      found.push_back(note);
+    }
+  }
+  return found;
+}
+
+// "8@%rsi -4@$3" -> {"8", "-4"}
+std::vector<std::string> arg_sizes(const std::string &args) {
+  std::vector<std::string> sizes;
+  std::istringstream in(args);
+  std::string arg;
+  while (in >> arg) {
+    sizes.push_back(arg.substr(0, arg.find('@')));
+  }
+  return sizes;
+}
+
+__attribute__((noinline)) void fire_test_probes(uint64_t count, int32_t delta, const char *symbol,
+                                                uint8_t side) {
+  FEED_TRACE(test_none);
+  FEED_TRACE(test_args, count, delta, symbol, side);
+}
+
+} // namespace
+
+TEST(TracepointTest, NotesDescribeEachProbeAndItsArguments) {
+  fire_test_probes(1, -1, "AAPL", 0);
+
+  auto none = find_probes("test_none");
+  ASSERT_EQ(none.size(), 1u);
+  EXPECT_EQ(none[0].args, "");
+
+  auto with_args = find_probes("test_args");
+  ASSERT_EQ(with_args.size(), 1u);
+  EXPECT_EQ(arg_sizes(with_args[0].args), (std::vector<std::string>{"8", "-4", "8", "1"}))
+      << with_args[0].args;
+}
+
+TEST(TracepointTest, ProbeSitesAreNopsUntilATracerAttaches) {
+  auto probes = find_probes("test_args");
+  ASSERT_EQ(probes.size(), 1u);
+  // Same relocation a tracer does: note address relative to the base
+  // symbol, which the note records at its link-time address
+  const auto *site = reinterpret_cast<const unsigned char *>(stapsdt_base) +
+                     (probes[0].pc - probes[0].base);
+#if defined(__x86_64__)
+  EXPECT_EQ(site[0], 0x90);
+#elif defined(__aarch64__)
+  uint32_t instruction;
+  memcpy(&instruction, site, sizeof(instruction));
+  EXPECT_EQ(instruction, 0xd503201fu);
+#endif
+}
+
+TEST(TracepointTest, ArgumentsAreEvaluatedOnce) {
+  uint64_t calls = 0;
+  auto next = [&] { return ++calls; };
+  for (int i = 0; i < 10; ++i) {
+    FEED_TRACE(test_once, next(), calls);
+  }
+  EXPECT_EQ(calls, 10u);
+}
+
+TEST(TracepointTest, HotPathHeadersCarryTheirProbes) {
+  SequenceTracker tracker;
+  tracker.process_sequence(1);
+  EXPECT_FALSE(tracker.process_sequence(5));
+
+  SymbolBooks books;
+  books.add("AAPL");
+  books.load_snapshot("AAPL", 1, {}, {});
+  OrderBookUpdatePayload update{};
+  memcpy(update.symbol, "AAPL", 4);
+  update.price = 100.0f;
+  update.quantity = 10;
+  EXPECT_EQ(books.apply_update(2, update), SymbolBooks::UpdateResult::APPLIED);
+
+  auto gaps = find_probes("gap");
+  ASSERT_FALSE(gaps.empty());
+  EXPECT_EQ(arg_sizes(gaps[0].args), (std::vector<std::string>{"8", "8"}));
+  auto updates = find_probes("book_update");
+  ASSERT_FALSE(updates.empty());
+  EXPECT_EQ(arg_sizes(updates[0].args), (std::vector<std::string>{"8", "8", "1", "-8"}));
+}
+
+#else
+
+TEST(TracepointTest, CompiledOut) {
+  uint64_t calls = 0;
+  FEED_TRACE(test_once, ++calls);
+  EXPECT_EQ(calls, 0u);  // Not evaluated
+}
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * Feed Transport Tests
+ *
+ * Covers:
+ *   - The same byte stream arrives intact over tcp, unix, unixgram and shm,
+ *     followed by end of stream when the server closes
+ *   - ShmRing wraps around its capacity, blocks a full writer until the
+ *     reader catches up, and close_reader() wakes a blocked read()
+ *   - A dead shm peer is noticed by the other side instead of hanging it
+ *   - FeedHandler reads binary ticks over each non-TCP transport
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "net/feed.hpp"
+#include "transport.hpp"
+
+namespace {
+
+Endpoint test_endpoint(Transport transport) {
+  Endpoint endpoint;
+  endpoint.transport = transport;
+  if (transport == Transport::SHM) {
+    endpoint.path = "/transport_test_" + std::to_string(getpid());
+  } else {
+    endpoint.path = "/tmp/transport_test_" + std::to_string(getpid()) + ".sock";
+  }
+  return endpoint;
+}
+
+// Listen on an ephemeral TCP port, or on the endpoint's path
+Endpoint listen_on(TransportListener*& listener, Transport transport) {
+  Endpoint endpoint = test_endpoint(transport);
+  if (transport == Transport::TCP) {
+    int probe = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    bind(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    getsockname(probe, reinterpret_cast<sockaddr*>(&addr), &len);
+    endpoint.port = ntohs(addr.sin_port);
+    close(probe);
+  }
+  listener = new TransportListener(endpoint, 64 * 1024);
+  EXPECT_TRUE(listener->listen().ok());
+  return endpoint;
+}
+
+std::vector<std::string> tick_frames(size_t count) {
+  std::vector<std::string> frames;
+  for (uint64_t i = 1; i <= count; ++i) {
+    frames.push_back(serialize_tick(i, i * 10, "AAPL", 100.0f + i, static_cast<int32_t>(i)));
+  }
+  return frames;
+}
+
+class TransportTest : public ::testing::TestWithParam<Transport> {};
+
+} // namespace
+
+TEST_P(TransportTest, StreamArrivesIntactThenEnds) {
+  TransportListener* raw = nullptr;
+  Endpoint endpoint = listen_on(raw, GetParam());
+  std::unique_ptr<TransportListener> listener(raw);
+
+  // Several times the shm ring, so it wraps and the writer waits on the reader
+  const auto frames = tick_frames(20000);
+  std::string expected;
+  for (const auto& f : frames) expected += f;
+
+  std::thread server([&]() {
+    auto channel = listener->accept(5000);
+    ASSERT_TRUE(channel.ok()) << channel.error();
+    // Whole frames per send, as the mock servers do (one datagram each on unixgram)
+    std::string batch;
+    for (const auto& f : frames) {
+      batch += f;
+      if (batch.size() >= 4096) {
+        ASSERT_TRUE(channel.value().send_all(batch));
+        batch.clear();
+      }
+    }
+    ASSERT_TRUE(channel.value().send_all(batch));
+    channel.value().close();
+  });
+
+  auto client = transport_connect(endpoint);
+  ASSERT_TRUE(client.ok()) << client.error();
+  std::string received;
+  char buffer[16 * 1024];
+  ssize_t n;
+  while ((n = client.value().read(buffer, sizeof(buffer))) > 0) {
+    received.append(buffer, n);
+  }
+  server.join();
+
+  EXPECT_EQ(n, 0);
+  EXPECT_EQ(received.size(), expected.size());
+  EXPECT_TRUE(received == expected);
+}
+
+TEST_P(TransportTest, FeedHandlerReadsTicks) {
+  if (GetParam() == Transport::TCP) {
+    GTEST_SKIP() << "TCP is covered by the feed handler tests";
+  }
+  TransportListener* raw = nullptr;
+  Endpoint endpoint = listen_on(raw, GetParam());
+  std::unique_ptr<TransportListener> listener(raw);
+
+  const auto frames = tick_frames(1000);
+  std::thread server([&]() {
+    auto channel = listener->accept(5000);
+    ASSERT_TRUE(channel.ok()) << channel.error();
+    for (const auto& f : frames) {
+      ASSERT_TRUE(channel.value().send_all(f));
+    }
+  });
+
+  net::FeedConfig config;
+  config.protocol = net::Protocol::BINARY;
+  config.queue_size = 4096;
+  config.transport = endpoint.transport;
+  config.transport_path = endpoint.path;
+  ASSERT_TRUE(config.is_valid());
+
+  net::FeedHandler handler(config);
+  std::vector<uint64_t> timestamps;
+  handler.set_tick_callback([&](const net::Tick& tick) { timestamps.push_back(tick.timestamp); });
+  ASSERT_TRUE(handler.start());
+  handler.wait();
+  server.join();
+
+  ASSERT_EQ(timestamps.size(), frames.size());
+  for (size_t i = 0; i < timestamps.size(); ++i) {
+    ASSERT_EQ(timestamps[i], (i + 1) * 10);
+  }
+  EXPECT_EQ(handler.parse_errors(), 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllTransports, TransportTest,
+                         ::testing::Values(Transport::TCP, Transport::UNIX_STREAM,
+                                           Transport::UNIX_DGRAM, Transport::SHM),
+                         [](const ::testing::TestParamInfo<Transport>& info) {
+                           return std::string(transport_name(info.param));
+                         });
+
+TEST(ShmRingTest, CloseReaderWakesBlockedRead) {
+  const std::string name = test_endpoint(Transport::SHM).path;
+  auto writer = ShmRing::create(name, 4096);
+  ASSERT_TRUE(writer.ok()) << writer.error();
+  auto reader = ShmRing::open(name, 1000);
+  ASSERT_TRUE(reader.ok()) << reader.error();
+  ASSERT_TRUE(writer.value()->wait_for_reader(0));
+
+  ssize_t result = -1;
+  std::thread blocked([&]() {
+    char buffer[64];
+    result = reader.value()->read(buffer, sizeof(buffer));
+  });
+  usleep(20000);
+  reader.value()->close_reader();
+  blocked.join();
+
+  EXPECT_EQ(result, 0);
+  // The writer sees the reader gone once the ring fills
+  std::string chunk(1024, 'x');
+  bool ok = true;
+  for (int i = 0; i < 8 && ok; ++i) ok = writer.value()->write(chunk.data(), chunk.size());
+  EXPECT_FALSE(ok);
+}
+
+TEST(ShmRingTest, SecondReaderIsRefusedAndNameIsReleased) {
+  const std::string name = test_endpoint(Transport::SHM).path;
+  auto writer = ShmRing::create(name, 4096);
+  ASSERT_TRUE(writer.ok());
+  auto first = ShmRing::open(name, 1000);
+  ASSERT_TRUE(first.ok());
+  EXPECT_FALSE(ShmRing::open(name, 20).ok());
+
+  // Once the writer has its reader the name is free for the next client
+  ASSERT_TRUE(writer.value()->wait_for_reader(0));
+  EXPECT_FALSE(ShmRing::open(name, 20).ok());
+  auto next = ShmRing::create(name, 4096);
+  EXPECT_TRUE(next.ok());
+}
+
+TEST(ShmRingTest, DeadWriterEndsTheStream) {
+  const std::string name = test_endpoint(Transport::SHM).path;
+  // The writer is a grandchild, reaped by init when it exits: a zombie
+  // child of ours would still look alive
+  pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    if (fork() != 0) _exit(0);
+    // Writes, then exits without close_writer()
+    auto writer = ShmRing::create(name, 4096);
+    if (!writer || !writer.value()->wait_for_reader(5000)) _exit(1);
+    writer.value()->write("hello", 5);
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+
+  auto reader = ShmRing::open(name, 5000);
+  ASSERT_TRUE(reader.ok()) << reader.error();
+  std::string received;
+  char buffer[64];
+  ssize_t n;
+  while ((n = reader.value()->read(buffer, sizeof(buffer))) > 0) {
+    received.append(buffer, n);
+  }
+  EXPECT_EQ(received, "hello");
+  EXPECT_EQ(n, 0);
+}
@@ -0,0 +1,230 @@
+/**
+ * Warm-up Tests
+ *
+ * Covers:
+ *   - prefault_memory on queue / ring buffer storage
+ *   - Reader parse entry points used by warm-up (binary frames, text chunks)
+ *   - FeedHandler warm-up: synthetic ticks reach the callback, are fenced
+ *     before the completion callback, and stats are reset afterwards
+ *   - BookUpdatingFeedHandler preallocates universe books and discards
+ *     warm-up state before live ticks are applied
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+
+#include "net/feed.hpp"
+#include "ring_buffer.hpp"
+#include "tick_server.hpp"
+
+namespace {
+
+net::FeedConfig warmup_config(uint16_t port) {
+  net::FeedConfig config;
+  config.port = port;
+  config.protocol = net::Protocol::BINARY;
+  config.queue_size = 4096;
+  config.warmup = true;
+  config.warmup_config.budget = std::chrono::milliseconds(200);
+  config.warmup_config.max_messages = 2048;
+  config.warmup_config.lock_memory = false;
+  return config;
+}
+
+} // namespace
+
+// =============================================================================
+// Prefaulting
+// =============================================================================
+
+TEST(PrefaultTest, QueueStorage) {
+  SPSCQueue<net::Tick> queue(1024);
+  EXPECT_EQ(queue.storage_bytes(), 1024 * sizeof(net::Tick));
+
+  auto result = prefault_memory(queue.storage(), queue.storage_bytes());
+  EXPECT_TRUE(result.ok()) << result.error();
+
+  // Contents survive (pages are rewritten with their own value)
+  ASSERT_TRUE(queue.push(net::Tick()));
+  EXPECT_TRUE(queue.pop().has_value());
+}
+
+TEST(PrefaultTest, RingBufferStorage) {
+  auto buffer = std::make_unique<RingBuffer>();
+  auto [ptr, space] = buffer->get_write_ptr();
+  memcpy(ptr, "abc", 3);
+  buffer->commit_write(3);
+
+  auto result = prefault_memory(buffer->storage(), buffer->storage_bytes());
+  EXPECT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ(buffer->peek(3), "abc");
+}
+
+TEST(PrefaultTest, EmptyRangeIsNoop) {
+  EXPECT_TRUE(prefault_memory(nullptr, 0, true).ok());
+}
+
+// =============================================================================
+// Reader Parse Entry Points
+// =============================================================================
+
+TEST(ReaderParseTest, BinaryFramesCarryPartialFrame) {
+  SPSCQueue<net::Tick> queue(64);
+  std::atomic<bool> stop{false};
+  StageMonitor monitor;
+  net::BinaryProtocolReader reader(-1, queue, stop, false, monitor);
+
+  std::string frames = serialize_tick(1, 100, "AAPL", 10.5f, 7) +
+                       serialize_tick(2, 200, "MSFT", 20.5f, 8);
+  size_t full = frames.size();
+  frames += serialize_tick(3, 300, "GOOG", 30.5f, 9).substr(0, 5);
+
+  EXPECT_EQ(reader.parse_frames(frames.data(), frames.size(), 42), full);
+  EXPECT_EQ(reader.messages_parsed(), 2u);
+
+  auto tick = queue.pop();
+  ASSERT_TRUE(tick.has_value());
+  EXPECT_STREQ(tick->symbol, "AAPL");
+  EXPECT_EQ(tick->volume, 7);
+  EXPECT_EQ(tick->recv_timestamp_ns, 42u);
+}
+
+TEST(ReaderParseTest, TextChunkSplitAcrossCalls) {
+  SPSCQueue<net::Tick> queue(64);
+  std::atomic<bool> stop{false};
+  StageMonitor monitor;
+  net::TextProtocolReader reader(-1, queue, stop, false, monitor);
+
+  EXPECT_TRUE(reader.parse_chunk("100 AAPL 1.50 10\n200 MS", 23, 1));
+  EXPECT_EQ(reader.messages_parsed(), 1u);
+  EXPECT_TRUE(reader.parse_chunk("FT 2.50 20\nbad\n", 15, 2));
+  EXPECT_EQ(reader.messages_parsed(), 2u);
+  EXPECT_EQ(reader.parse_errors(), 1u);
+
+  queue.pop();
+  auto tick = queue.pop();
+  ASSERT_TRUE(tick.has_value());
+  EXPECT_STREQ(tick->symbol, "MSFT");
+  EXPECT_EQ(tick->volume, 20);
+}
+
+// =============================================================================
+// FeedHandler Warm-up
+// =============================================================================
+
+TEST(FeedWarmupTest, SyntheticTrafficIsFencedAndStatsReset) {
+  TickServer server;
+  const uint64_t live = 10;
+  std::string frames;
+  for (uint64_t i = 1; i <= live; ++i) {
+    frames += serialize_tick(i, i, "LIVE", 1.0f, 1);
+  }
+  server.serve(frames);
+
+  net::FeedConfig config = warmup_config(server.port());
+  net::FeedHandler handler(config);
+
+  uint64_t seen = 0;
+  uint64_t seen_at_complete = 0;
+  handler.set_tick_callback([&](const net::Tick &) { seen++; });
+  handler.set_warmup_complete_callback([&]() { seen_at_complete = seen; });
+
+  ASSERT_TRUE(handler.start());
+  handler.wait();
+
+  const auto &report = handler.warmup_report();
+  EXPECT_GT(report.messages, 0u);
+  EXPECT_LE(report.messages, config.warmup_config.max_messages);
+  EXPECT_FALSE(report.memory_locked);
+
+  // Every synthetic tick reached the callback before completion fired
+  EXPECT_EQ(seen_at_complete, report.messages);
+  EXPECT_EQ(seen, report.messages + live);
+
+  // Processor stats describe live traffic only
+  EXPECT_EQ(handler.messages_processed(), live);
+  EXPECT_EQ(handler.processor()->latency_stats().count(), live);
+  EXPECT_EQ(handler.messages_parsed(), live);
+}
+
+TEST(FeedWarmupTest, RejectedSyntheticLinesDoNotStallStart) {
+  TickServer server;
+  server.serve(serialize_text_tick(1, "LIVE", 1.0, 1));
+
+  net::FeedConfig config = warmup_config(server.port());
+  config.protocol = net::Protocol::TEXT;
+  // The text parser rejects symbols over 7 characters: every other
+  // synthetic line is a parse error and never reaches the processor
+  config.warmup_config.symbols = {"AAPL", "TOOLONGSYM"};
+
+  net::FeedHandler handler(config);
+  uint64_t seen = 0;
+  handler.set_tick_callback([&](const net::Tick &) { seen++; });
+  ASSERT_TRUE(handler.start());
+  handler.wait();
+
+  const auto &report = handler.warmup_report();
+  EXPECT_GT(report.messages, 0u);
+  EXPECT_LE(report.messages, config.warmup_config.max_messages / 2);
+  EXPECT_EQ(seen, report.messages + 1);
+  EXPECT_EQ(handler.messages_processed(), 1u);
+}
+
+TEST(FeedWarmupTest, BudgetBoundsWarmup) {
+  TickServer server;
+  server.serve("");
+
+  net::FeedConfig config = warmup_config(server.port());
+  config.queue_size = 1 << 20;
+  config.warmup_config.budget = std::chrono::milliseconds(20);
+  config.warmup_config.max_messages = SIZE_MAX;
+
+  net::FeedHandler handler(config);
+  ASSERT_TRUE(handler.start());
+  handler.wait();
+
+  EXPECT_TRUE(handler.warmup_report().budget_exhausted);
+  // Generous bound: budget plus draining what was queued
+  EXPECT_LT(handler.warmup_report().duration_ns, 2'000'000'000ULL);
+}
+
+TEST(FeedWarmupTest, BookHandlerDiscardsWarmupBooks) {
+  TickServer server;
+  server.serve(serialize_tick(1, 1, "AAPL", 50.0f, 5));
+
+  net::FeedConfig config = warmup_config(server.port());
+  config.warmup_config.symbols = {"AAPL", "MSFT"};
+
+  net::BookUpdatingFeedHandler handler(config);
+  ASSERT_EQ(handler.books().size(), 2u);  // Preallocated universe
+
+  ASSERT_TRUE(handler.start());
+  handler.wait();
+
+  const auto &books = handler.books();
+  ASSERT_EQ(books.size(), 2u);
+
+  // Only the live tick survives; warm-up levels were thrown away
+  auto bids = books.at("AAPL").get_top_bids(10);
+  ASSERT_EQ(bids.size(), 1u);
+  EXPECT_FLOAT_EQ(bids[0].price, 50.0f);
+  EXPECT_EQ(bids[0].quantity, 5u);
+  EXPECT_TRUE(books.at("MSFT").get_top_bids(10).empty());
+}
+
+TEST(FeedWarmupTest, ConnectFailureAfterWarmupStopsProcessor) {
+  uint16_t port;
+  {
+    TickServer closed;
+    port = closed.port();
+  }
+
+  net::FeedHandler handler(warmup_config(port));
+  EXPECT_FALSE(handler.start());
+  EXPECT_FALSE(handler.is_running());
+}
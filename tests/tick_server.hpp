@@ -0,0 +1,60 @@
+#ifndef TESTS_TICK_SERVER_HPP
+#define TESTS_TICK_SERVER_HPP
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * Loopback feed server for tests: listens on an ephemeral port, accepts one
+ * client, sends it a prepared byte stream and closes.
+ */
+class TickServer {
+public:
+  TickServer() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    listen(listen_fd_, 1);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+  }
+
+  ~TickServer() {
+    if (thread_.joinable()) thread_.join();
+    close(listen_fd_);
+  }
+
+  TickServer(const TickServer &) = delete;
+  TickServer &operator=(const TickServer &) = delete;
+
+  // Accept one client, send the frames in one go, then close
+  void serve(std::string frames) {
+    thread_ = std::thread([this, frames = std::move(frames)]() {
+      int client = accept(listen_fd_, nullptr, nullptr);
+      if (client < 0) return;
+      size_t sent = 0;
+      while (sent < frames.size()) {
+        ssize_t n = send(client, frames.data() + sent, frames.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += n;
+      }
+      close(client);
+    });
+  }
+
+  uint16_t port() const { return port_; }
+
+private:
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  std::thread thread_;
+};
+
+#endif // TESTS_TICK_SERVER_HPP